@@ -240,6 +240,16 @@ unmap_device ${DEV} ${PID}
 DEV=
 rbd bench ${IMAGE} --io-type write --io-size=1024 --io-total=1024
 
+# multiple connections test
+DEV=`_sudo rbd device --device-type nbd --options try-netlink,connections=4 map ${POOL}/${IMAGE}`
+get_pid ${POOL}
+
+_sudo dd if=${DATA} of=${DEV} bs=1M oflag=direct
+[ "`dd if=${DATA} bs=1M | md5sum`" = "`_sudo dd if=${DEV} bs=1M iflag=direct | md5sum`" ]
+unmap_device ${DEV} ${PID}
+DEV=
+expect_false _sudo rbd device --device-type nbd --options connections=4 map ${POOL}/${IMAGE}
+
 # unmap by image name test
 DEV=`_sudo rbd device --device-type nbd map ${POOL}/${IMAGE}`
 get_pid ${POOL}
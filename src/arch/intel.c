@@ -23,6 +23,10 @@ int ceph_arch_intel_ssse3 = 0;
 int ceph_arch_intel_sse3 = 0;
 int ceph_arch_intel_sse2 = 0;
 int ceph_arch_intel_aesni = 0;
+int ceph_arch_intel_avx2 = 0;
+int ceph_arch_intel_avx512 = 0;
+int ceph_arch_intel_gfni = 0;
+int ceph_arch_intel_vpclmul = 0;
 
 #ifdef __x86_64__
 #include <cpuid.h>
@@ -36,6 +40,27 @@ int ceph_arch_intel_aesni = 0;
 #define CPUID_SSE3	(1)
 #define CPUID_SSE2	(1 << 26)
 #define CPUID_AESNI (1 << 25)
+#define CPUID_OSXSAVE	(1 << 27)
+
+/* leaf 7, subleaf 0 */
+#define CPUID7_AVX2	(1 << 5)
+#define CPUID7_AVX512F	(1 << 16)
+#define CPUID7_AVX512BW	(1 << 30)
+#define CPUID7_AVX512VL	(1U << 31)
+#define CPUID7_VPCLMUL	(1 << 10)
+#define CPUID7_GFNI	(1 << 8)
+
+/* XCR0: SSE and AVX state enabled by the OS */
+#define XCR0_AVX	0x06
+/* XCR0: SSE, AVX, opmask, ZMM_Hi256 and Hi16_ZMM state enabled by the OS */
+#define XCR0_AVX512	0xe6
+
+static unsigned long long ceph_arch_intel_xgetbv(void)
+{
+	unsigned int eax, edx;
+	__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return ((unsigned long long)edx << 32) | eax;
+}
 
 int ceph_arch_intel_probe(void)
 {
@@ -65,6 +90,29 @@ int ceph_arch_intel_probe(void)
   if ((ecx & CPUID_AESNI) != 0) {
           ceph_arch_intel_aesni = 1;
   }
+	if ((ecx & CPUID_OSXSAVE) != 0) {
+		unsigned long long xcr0 = ceph_arch_intel_xgetbv();
+		unsigned int ebx7 = 0, ecx7 = 0, edx7 = 0, eax7;
+		if ((xcr0 & XCR0_AVX) == XCR0_AVX &&
+		    __get_cpuid_count(7, 0, &eax7, &ebx7, &ecx7, &edx7)) {
+			const unsigned int avx512 =
+				CPUID7_AVX512F | CPUID7_AVX512BW | CPUID7_AVX512VL;
+			if ((ebx7 & CPUID7_AVX2) != 0) {
+				ceph_arch_intel_avx2 = 1;
+			}
+			if ((xcr0 & XCR0_AVX512) == XCR0_AVX512) {
+				if ((ebx7 & avx512) == avx512) {
+					ceph_arch_intel_avx512 = 1;
+				}
+				if ((ecx7 & CPUID7_VPCLMUL) != 0) {
+					ceph_arch_intel_vpclmul = 1;
+				}
+				if ((ecx7 & CPUID7_GFNI) != 0) {
+					ceph_arch_intel_gfni = 1;
+				}
+			}
+		}
+	}
 
 	return 0;
 }
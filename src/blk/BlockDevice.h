@@ -77,6 +77,12 @@ struct IOContext {
   enum {
     FLAG_DONT_CACHE = 1
   };
+  /// submission class; background ios may be throttled by the device
+  /// to leave queue depth to latency sensitive ones
+  enum io_class_t {
+    IO_CLASS_NORMAL = 0,
+    IO_CLASS_BACKGROUND,
+  };
 
 private:
   ceph::mutex lock = ceph::make_mutex("IOContext::lock");
@@ -100,6 +106,7 @@ public:
   std::atomic_int num_running = {0};
   bool allow_eio;
   uint32_t flags = 0;               // FLAG_*
+  io_class_t io_class = IO_CLASS_NORMAL;
 
   explicit IOContext(CephContext* cct, void *p, bool allow_eio = false)
     : cct(cct), priv(p), allow_eio(allow_eio)
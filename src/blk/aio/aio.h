@@ -103,6 +103,13 @@ struct io_queue_t {
   virtual int submit_batch(aio_iter begin, aio_iter end, uint16_t aios_size,
 			   void *priv, int *retries) = 0;
   virtual int get_next_completed(int timeout_ms, aio_t **paio, int max) = 0;
+
+  /// take a buffer that is pre-registered with the kernel, if the queue
+  /// keeps any; returns nullptr when unsupported or all are in use
+  virtual ceph::unique_leakable_ptr<ceph::buffer::raw>
+  try_create_registered(size_t len) {
+    return nullptr;
+  }
 };
 
 struct aio_queue_t final : public io_queue_t {
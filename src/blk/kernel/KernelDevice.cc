@@ -80,7 +80,12 @@ KernelDevice::KernelDevice(CephContext* cct, aio_callback_t cb, void *cbpriv, ai
   if (use_ioring && ioring_queue_t::supported()) {
     bool use_ioring_hipri = cct->_conf.get_val<bool>("bdev_ioring_hipri");
     bool use_ioring_sqthread_poll = cct->_conf.get_val<bool>("bdev_ioring_sqthread_poll");
-    io_queue = std::make_unique<ioring_queue_t>(iodepth, use_ioring_hipri, use_ioring_sqthread_poll);
+    auto registered_buffers =
+      cct->_conf.get_val<uint64_t>("bdev_ioring_registered_buffers");
+    auto registered_buffer_size =
+      cct->_conf.get_val<Option::size_t>("bdev_ioring_registered_buffer_size");
+    io_queue = std::make_unique<ioring_queue_t>(iodepth, use_ioring_hipri, use_ioring_sqthread_poll,
+                                                registered_buffers, registered_buffer_size);
   } else {
     static bool once;
     if (use_ioring && !once) {
@@ -596,6 +601,11 @@ void KernelDevice::_aio_thread()
       for (int i = 0; i < r; ++i) {
 	IOContext *ioc = static_cast<IOContext*>(aio[i]->priv);
 	_aio_log_finish(ioc, aio[i]->offset, aio[i]->length);
+	if (ioc->io_class == IOContext::IO_CLASS_BACKGROUND) {
+	  std::lock_guard l(background_lock);
+	  --background_in_flight;
+	  background_cond.notify_all();
+	}
 	if (aio[i]->queue_item.is_linked()) {
 	  std::lock_guard l(debug_queue_lock);
 	  debug_aio_unlink(*aio[i]);
@@ -843,6 +853,10 @@ void KernelDevice::aio_submit(IOContext *ioc)
     return;
   }
 
+  if (ioc->io_class == IOContext::IO_CLASS_BACKGROUND) {
+    _background_throttle(ioc->num_pending.load());
+  }
+
   // move these aside, and get our end iterator position now, as the
   // aios might complete as soon as they are submitted and queue more
   // wal aio's.
@@ -879,6 +893,27 @@ void KernelDevice::aio_submit(IOContext *ioc)
   }
 }
 
+void KernelDevice::_background_throttle(int n)
+{
+  // background ios wait for earlier ones to complete while they would
+  // exceed their budget, so that they cannot fill the whole queue depth
+  // ahead of latency sensitive ios; past the deadline they go anyway
+  uint64_t max = cct->_conf.get_val<uint64_t>("bdev_aio_background_max_in_flight");
+  std::unique_lock l(background_lock);
+  if (max) {
+    auto deadline = ceph::mono_clock::now() +
+      cct->_conf.get_val<std::chrono::milliseconds>("bdev_aio_background_max_wait");
+    while (background_in_flight > 0 && background_in_flight + n > max) {
+      if (background_cond.wait_until(l, deadline) == std::cv_status::timeout) {
+	dout(10) << __func__ << " deadline passed with " << background_in_flight
+		 << " in flight, submitting " << n << dendl;
+	break;
+      }
+    }
+  }
+  background_in_flight += n;
+}
+
 int KernelDevice::_sync_write(uint64_t off, bufferlist &bl, bool buffered, int write_hint)
 {
   uint64_t len = bl.length();
@@ -959,6 +994,19 @@ int KernelDevice::write(
     return 0;
   }
 
+  if (aio && dio && !buffered &&
+      (bl.get_num_buffers() > 1 ||
+       !bl.is_aligned_size_and_memory(block_size, block_size))) {
+    // the payload has to be copied anyway; prefer a buffer that is
+    // registered with the kernel so the write skips page pinning
+    if (auto raw = io_queue->try_create_registered(len); raw) {
+      bufferptr p(std::move(raw));
+      bl.begin().copy(len, p.c_str());
+      bl.clear();
+      bl.append(std::move(p));
+      dout(20) << __func__ << " copied into registered buffer" << dendl;
+    }
+  }
   if ((!buffered || bl.get_num_buffers() >= IOV_MAX) &&
       bl.rebuild_aligned_size_and_memory(block_size, block_size, IOV_MAX)) {
     dout(20) << __func__ << " rebuilding buffer to be aligned" << dendl;
@@ -1306,8 +1354,15 @@ int KernelDevice::aio_read(
     ioc->pending_aios.push_back(aio_t(ioc, fd_directs[WRITE_LIFE_NOT_SET]));
     ++ioc->num_pending;
     aio_t& aio = ioc->pending_aios.back();
-    aio.bl.push_back(
-      ceph::buffer::ptr_node::create(create_custom_aligned(len, ioc)));
+    auto raw = io_queue->try_create_registered(len);
+    if (raw) {
+      // there are only so many registered buffers; don't let the cache
+      // hold on to them
+      ioc->flags |= IOContext::FLAG_DONT_CACHE;
+    } else {
+      raw = create_custom_aligned(len, ioc);
+    }
+    aio.bl.push_back(ceph::buffer::ptr_node::create(std::move(raw)));
     aio.bl.prepare_iov(&aio.iov);
     aio.preadv(off, len);
     dout(30) << aio << dendl;
@@ -46,6 +46,10 @@ private:
   std::atomic<bool> io_since_flush = {false};
   ceph::mutex flush_mutex = ceph::make_mutex("KernelDevice::flush_mutex");
 
+  ceph::mutex background_lock = ceph::make_mutex("KernelDevice::background_lock");
+  ceph::condition_variable background_cond;
+  uint64_t background_in_flight = 0; ///< submitted IO_CLASS_BACKGROUND aios
+
   std::unique_ptr<io_queue_t> io_queue;
   aio_callback_t discard_callback;
   void *discard_callback_priv;
@@ -83,6 +87,7 @@ private:
   virtual void  _pre_close() { }  // hook for child implementations
 
   void _aio_thread();
+  void _background_throttle(int n);
   void _discard_thread();
   int _queue_discard(interval_set<uint64_t> &to_release);
   bool try_discard(interval_set<uint64_t> &to_release, bool async = true) override;
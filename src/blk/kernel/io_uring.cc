@@ -7,16 +7,113 @@
 
 #include "liburing.h"
 #include <sys/epoll.h>
+#include <sys/mman.h>
+
+#include "include/buffer_raw.h"
+#include "include/intarith.h"
 
 using std::list;
 using std::make_unique;
 
+/*
+ * Buffers registered with the ring (IORING_REGISTER_BUFFERS) so that the
+ * kernel doesn't have to pin and unpin user pages on every IO.  The raws
+ * handed out keep a reference to the pool, so the region stays mapped for
+ * as long as any of them is alive, even past shutdown().
+ */
+struct ioring_buffer_pool {
+  const size_t buffer_size;
+  const unsigned count;
+  char *region = nullptr;
+  std::mutex lock;
+  std::vector<unsigned> free_list;
+
+  ioring_buffer_pool(unsigned count_, size_t buffer_size_)
+    : buffer_size(p2roundup<size_t>(buffer_size_, CEPH_PAGE_SIZE)),
+      count(count_) {
+  }
+  ~ioring_buffer_pool() {
+    if (region) {
+      ::munmap(region, buffer_size * count);
+    }
+  }
+
+  int init() {
+    void *p = ::mmap(nullptr, buffer_size * count, PROT_READ | PROT_WRITE,
+		     MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (p == MAP_FAILED) {
+      return -errno;
+    }
+    region = static_cast<char*>(p);
+    free_list.reserve(count);
+    for (unsigned i = count; i > 0; --i) {
+      free_list.push_back(i - 1);
+    }
+    return 0;
+  }
+
+  std::vector<struct iovec> get_iovecs() const {
+    std::vector<struct iovec> iovs(count);
+    for (unsigned i = 0; i < count; ++i) {
+      iovs[i].iov_base = region + i * buffer_size;
+      iovs[i].iov_len = buffer_size;
+    }
+    return iovs;
+  }
+
+  /// index of the registered buffer fully containing [base, base+len),
+  /// or -1 if there is none
+  int find(const void *base, size_t len) const {
+    auto p = static_cast<const char*>(base);
+    if (p < region || p + len > region + buffer_size * count) {
+      return -1;
+    }
+    unsigned index = (p - region) / buffer_size;
+    if (p + len > region + (index + 1) * buffer_size) {
+      return -1;
+    }
+    return index;
+  }
+
+  bool get(unsigned *index) {
+    std::lock_guard l(lock);
+    if (free_list.empty()) {
+      return false;
+    }
+    *index = free_list.back();
+    free_list.pop_back();
+    return true;
+  }
+  void put(unsigned index) {
+    std::lock_guard l(lock);
+    free_list.push_back(index);
+  }
+};
+
+struct registered_buffer_raw : public ceph::buffer::raw {
+  std::shared_ptr<ioring_buffer_pool> pool;
+  const unsigned index;
+
+  registered_buffer_raw(std::shared_ptr<ioring_buffer_pool> p,
+			unsigned index, unsigned len)
+    : raw(p->region + index * p->buffer_size, len,
+	  mempool::mempool_bdev_ioring_buffers),
+      pool(std::move(p)),
+      index(index) {
+  }
+  ~registered_buffer_raw() override {
+    // don't free; recycle the slot instead
+    pool->put(index);
+  }
+};
+
 struct ioring_data {
   struct io_uring io_uring;
   pthread_mutex_t cq_mutex;
   pthread_mutex_t sq_mutex;
   int epoll_fd = -1;
   std::map<int, int> fixed_fds_map;
+  std::shared_ptr<ioring_buffer_pool> buffers;
 };
 
 static int ioring_get_cqe(struct ioring_data *d, unsigned int max,
@@ -57,13 +154,26 @@ static void init_sqe(struct ioring_data *d, struct io_uring_sqe *sqe,
 
   ceph_assert(fixed_fd != -1);
 
-  if (io->iocb.aio_lio_opcode == IO_CMD_PWRITEV)
-    io_uring_prep_writev(sqe, fixed_fd, &io->iov[0],
-			 io->iov.size(), io->offset);
-  else if (io->iocb.aio_lio_opcode == IO_CMD_PREADV)
-    io_uring_prep_readv(sqe, fixed_fd, &io->iov[0],
-			io->iov.size(), io->offset);
-  else
+  int buf_index = -1;
+  if (d->buffers && io->iov.size() == 1) {
+    buf_index = d->buffers->find(io->iov[0].iov_base, io->iov[0].iov_len);
+  }
+
+  if (io->iocb.aio_lio_opcode == IO_CMD_PWRITEV) {
+    if (buf_index >= 0)
+      io_uring_prep_write_fixed(sqe, fixed_fd, io->iov[0].iov_base,
+				io->iov[0].iov_len, io->offset, buf_index);
+    else
+      io_uring_prep_writev(sqe, fixed_fd, &io->iov[0],
+			   io->iov.size(), io->offset);
+  } else if (io->iocb.aio_lio_opcode == IO_CMD_PREADV) {
+    if (buf_index >= 0)
+      io_uring_prep_read_fixed(sqe, fixed_fd, io->iov[0].iov_base,
+			       io->iov[0].iov_len, io->offset, buf_index);
+    else
+      io_uring_prep_readv(sqe, fixed_fd, &io->iov[0],
+			  io->iov.size(), io->offset);
+  } else
     ceph_assert(0);
 
   io_uring_sqe_set_data(sqe, io);
@@ -106,11 +216,15 @@ static void build_fixed_fds_map(struct ioring_data *d,
   }
 }
 
-ioring_queue_t::ioring_queue_t(unsigned iodepth_, bool hipri_, bool sq_thread_) :
+ioring_queue_t::ioring_queue_t(unsigned iodepth_, bool hipri_, bool sq_thread_,
+			       unsigned registered_buffers_,
+			       size_t registered_buffer_size_) :
   d(make_unique<ioring_data>()),
   iodepth(iodepth_),
   hipri(hipri_),
-  sq_thread(sq_thread_)
+  sq_thread(sq_thread_),
+  registered_buffers(registered_buffers_),
+  registered_buffer_size(registered_buffer_size_)
 {
 }
 
@@ -143,6 +257,20 @@ int ioring_queue_t::init(std::vector<int> &fds)
 
   build_fixed_fds_map(d.get(), fds);
 
+  if (registered_buffers && registered_buffer_size) {
+    // best effort: if the buffers can't be allocated or registered (e.g.
+    // RLIMIT_MEMLOCK is too low) IOs simply go through the plain iovec path
+    auto pool = std::make_shared<ioring_buffer_pool>(registered_buffers,
+						     registered_buffer_size);
+    if (pool->init() == 0) {
+      auto iovs = pool->get_iovecs();
+      if (io_uring_register_buffers(&d->io_uring,
+				    iovs.data(), iovs.size()) == 0) {
+	d->buffers = std::move(pool);
+      }
+    }
+  }
+
   d->epoll_fd = epoll_create1(0);
   if (d->epoll_fd < 0) {
     ret = -errno;
@@ -170,6 +298,8 @@ close_ring_fd:
 void ioring_queue_t::shutdown()
 {
   d->fixed_fds_map.clear();
+  // outstanding raws keep the pool mapped until they are released
+  d->buffers.reset();
   close(d->epoll_fd);
   d->epoll_fd = -1;
   io_uring_queue_exit(&d->io_uring);
@@ -209,6 +339,18 @@ get_cqe:
   return events;
 }
 
+ceph::unique_leakable_ptr<ceph::buffer::raw>
+ioring_queue_t::try_create_registered(size_t len)
+{
+  auto& pool = d->buffers;
+  unsigned index;
+  if (!pool || len > pool->buffer_size || !pool->get(&index)) {
+    return nullptr;
+  }
+  return ceph::unique_leakable_ptr<ceph::buffer::raw>(
+    new registered_buffer_raw(pool, index, len));
+}
+
 bool ioring_queue_t::supported()
 {
   struct io_uring ring;
@@ -224,7 +366,9 @@ bool ioring_queue_t::supported()
 
 struct ioring_data {};
 
-ioring_queue_t::ioring_queue_t(unsigned iodepth_, bool hipri_, bool sq_thread_)
+ioring_queue_t::ioring_queue_t(unsigned iodepth_, bool hipri_, bool sq_thread_,
+			       unsigned registered_buffers_,
+			       size_t registered_buffer_size_)
 {
   ceph_assert(0);
 }
@@ -256,6 +400,12 @@ int ioring_queue_t::get_next_completed(int timeout_ms, aio_t **paio, int max)
   ceph_assert(0);
 }
 
+ceph::unique_leakable_ptr<ceph::buffer::raw>
+ioring_queue_t::try_create_registered(size_t len)
+{
+  ceph_assert(0);
+}
+
 bool ioring_queue_t::supported()
 {
   return false;
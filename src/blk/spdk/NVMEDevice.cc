@@ -171,7 +171,12 @@ class SharedDriverQueueData {
     // usable queue depth should minus 1 to avoid overflow.
     max_queue_depth = opts.io_queue_size - 1;
     qpair = spdk_nvme_ctrlr_alloc_io_qpair(ctrlr, &opts, sizeof(opts));
-    ceph_assert(qpair != NULL);
+    if (!qpair) {
+      // the controller has run out of io queues; the caller falls back to
+      // the device's shared queue
+      dout(1) << __func__ << " unable to allocate io qpair" << dendl;
+      return;
+    }
 
     // allocate spdk dma memory
     for (uint16_t i = 0; i < data_buffer_default_num; i++) {
@@ -184,6 +189,10 @@ class SharedDriverQueueData {
     }
   }
 
+  bool valid() const {
+    return qpair != nullptr;
+  }
+
   ~SharedDriverQueueData() {
     if (qpair) {
       spdk_nvme_ctrlr_free_io_qpair(qpair);
@@ -750,6 +759,9 @@ int NVMEDevice::open(const string& p)
   }
 
   driver->register_device(this);
+  // reserve a queue pair up front for threads that cannot get their own
+  shared_queue = new SharedDriverQueueData(this, driver);
+  ceph_assert(shared_queue->valid());
   block_size = driver->get_block_size();
   size = driver->get_size();
   name = trid.traddr;
@@ -773,6 +785,8 @@ void NVMEDevice::close()
   dout(1) << __func__ << dendl;
 
   name.clear();
+  delete shared_queue;
+  shared_queue = nullptr;
   driver->remove_device(this);
 
   dout(1) << __func__ << " end" << dendl;
@@ -810,8 +824,15 @@ void NVMEDevice::aio_submit(IOContext *ioc)
     // Only need to push the first entry
     ioc->nvme_task_first = ioc->nvme_task_last = nullptr;
 
+    // each submitting thread gets its own queue pair and polls for its own
+    // completions, so the common path takes no locks
     thread_local SharedDriverQueueData queue_t = SharedDriverQueueData(this, driver);
-    queue_t._aio_handle(t, ioc);
+    if (queue_t.valid()) {
+      queue_t._aio_handle(t, ioc);
+    } else {
+      std::lock_guard l(shared_queue_lock);
+      shared_queue->_aio_handle(t, ioc);
+    }
   }
 }
 
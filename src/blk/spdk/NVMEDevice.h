@@ -26,6 +26,7 @@
 
 
 #include "include/interval_set.h"
+#include "common/ceph_mutex.h"
 #include "common/ceph_time.h"
 #include "BlockDevice.h"
 
@@ -47,6 +48,12 @@ class NVMEDevice : public BlockDevice {
   SharedDriverData *driver;
   std::string name;
 
+  /// used by submitting threads once the controller has no io queue
+  /// pairs left to give them one of their own
+  SharedDriverQueueData *shared_queue = nullptr;
+  ceph::mutex shared_queue_lock =
+    ceph::make_mutex("NVMEDevice::shared_queue_lock");
+
  public:
   SharedDriverData *get_driver() { return driver; }
 
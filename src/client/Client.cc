@@ -53,6 +53,7 @@
 #include "mon/MonClient.h"
 
 #include "messages/MClientCaps.h"
+#include "messages/MClientCapsBatch.h"
 #include "messages/MClientLease.h"
 #include "messages/MClientQuota.h"
 #include "messages/MClientReclaim.h"
@@ -1454,6 +1455,45 @@ void Client::insert_readdir_results(MetaRequest *request, MetaSession *session,
   }
 }
 
+void Client::insert_lookupbatch_results(MetaRequest *request, MetaSession *session, Inode *diri)
+{
+  auto& reply = request->reply;
+  ConnectionRef con = request->reply->get_connection();
+  uint64_t features;
+  if(session->mds_features.test(CEPHFS_FEATURE_REPLY_ENCODING)) {
+    features = (uint64_t)-1;
+  }
+  else {
+    features = con->get_features();
+  }
+
+  auto p = reply->get_extra_bl().cbegin();
+  if (p.end())
+    return;
+
+  __u32 numdn;
+  decode(numdn, p);
+  ldout(cct, 10) << __func__ << " " << numdn << " lookupbatch items" << dendl;
+  if (!numdn)
+    return;
+
+  Dir *dir = diri->open_dir();
+  string dname;
+  LeaseStat dlease;
+  for (unsigned i = 0; i < numdn; i++) {
+    decode(dname, p);
+    dlease.decode(p, features);
+    InodeStat ist(p, features);
+
+    Inode *in = add_update_inode(&ist, request->sent_stamp, session,
+				 request->perms);
+    Dentry *dn = insert_dentry_inode(dir, dname, &dlease, in,
+				     request->sent_stamp, session);
+    dn->alternate_name = std::move(dlease.alternate_name);
+    ldout(cct, 15) << __func__ << "  '" << dname << "' -> " << in->ino << dendl;
+  }
+}
+
 /** insert_trace
  *
  * insert a trace from a MDS reply into the cache.
@@ -1611,6 +1651,8 @@ Inode* Client::insert_trace(MetaRequest *request, MetaSession *session)
     if (op == CEPH_MDS_OP_READDIR ||
 	op == CEPH_MDS_OP_LSSNAP) {
       insert_readdir_results(request, session, in);
+    } else if (op == CEPH_MDS_OP_LOOKUPBATCH) {
+      insert_lookupbatch_results(request, session, in);
     } else if (op == CEPH_MDS_OP_LOOKUPNAME) {
       // hack: return parent inode instead
       in = diri;
@@ -2918,6 +2960,9 @@ bool Client::ms_dispatch2(const MessageRef &m)
   case CEPH_MSG_CLIENT_CAPS:
     handle_caps(ref_cast<MClientCaps>(m));
     break;
+  case CEPH_MSG_CLIENT_CAPS_BATCH:
+    handle_caps_batch(ref_cast<MClientCapsBatch>(m));
+    break;
   case CEPH_MSG_CLIENT_LEASE:
     handle_lease(ref_cast<MClientLease>(m));
     break;
@@ -5229,6 +5274,16 @@ void Client::handle_quota(const MConstRef<MClientQuota>& m)
   }
 }
 
+void Client::handle_caps_batch(const MConstRef<MClientCapsBatch>& m)
+{
+  ldout(cct, 10) << __func__ << " " << *m << " from mds." << m->get_source().num() << dendl;
+  for (auto& c : m->caps) {
+    c->set_src(m->get_source());
+    c->set_connection(m->get_connection());
+    handle_caps(c);
+  }
+}
+
 void Client::handle_caps(const MConstRef<MClientCaps>& m)
 {
   mds_rank_t mds = mds_rank_t(m->get_source().num());
@@ -6999,6 +7054,33 @@ int Client::_do_lookup(Inode *dir, const string& name, int mask,
   return r;
 }
 
+/*
+ * Look up several names in dir with one MDS request.  The dentries and
+ * inodes the MDS returns are inserted into the cache with their leases,
+ * so that a following _lookup() of those names is a cache hit; names it
+ * does not return are left for _lookup() to ask about on their own.
+ */
+int Client::_lookup_batch(Inode *dir, const std::vector<std::string>& names,
+			  const UserPerm& perms)
+{
+  MetaRequest *req = new MetaRequest(CEPH_MDS_OP_LOOKUPBATCH);
+  filepath path;
+  dir->make_nosnap_relative_path(path);
+  req->set_filepath(path);
+  req->set_inode(dir);
+
+  bufferlist bl;
+  encode(names, bl);
+  req->set_data(bl);
+
+  ldout(cct, 10) << __func__ << " " << names.size() << " names on " << path << dendl;
+
+  int r = make_request(req, perms, nullptr, nullptr, -1, nullptr,
+		       CEPHFS_FEATURE_OP_LOOKUPBATCH);
+  ldout(cct, 10) << __func__ << " res is " << r << dendl;
+  return r;
+}
+
 bool Client::_dentry_valid(const Dentry *dn)
 {
   ceph_assert(ceph_mutex_is_locked_by_me(client_lock));
@@ -9041,6 +9123,10 @@ int Client::_readdir_get_frag(dir_result_t *dirp)
   req->set_inode(diri.get());
   req->head.args.readdir.frag = fg;
   req->head.args.readdir.flags = CEPH_READDIR_REPLY_BITFLAGS;
+  req->head.args.readdir.max_bytes =
+    cct->_conf.get_val<Option::size_t>("client_readdir_max_bytes");
+  req->head.args.readdir.max_entries =
+    cct->_conf.get_val<uint64_t>("client_readdir_max_entries");
   if (dirp->last_name.length()) {
     req->path2.set_path(dirp->last_name);
   } else if (dirp->hash_order()) {
@@ -12131,6 +12217,78 @@ int Client::ll_lookupx(Inode *parent, const char *name, Inode **out,
   return r;
 }
 
+int Client::ll_lookupx_batch(Inode *parent, int count, const char * const names[],
+			     Inode *out[], struct ceph_statx stx[], int results[],
+			     unsigned want, unsigned flags, const UserPerm& perms)
+{
+  RWRef_t mref_reader(mount_state, CLIENT_MOUNTING);
+  if (!mref_reader.is_state_satisfied())
+    return -CEPHFS_ENOTCONN;
+
+  vinodeno_t vparent = _get_vino(parent);
+  ldout(cct, 3) << __func__ << " " << vparent << " " << count << " names" << dendl;
+  tout(cct) << __func__ << std::endl;
+  tout(cct) << count << std::endl;
+
+  std::scoped_lock lock(client_lock);
+
+  int r = 0;
+  if (!fuse_default_permissions) {
+    r = may_lookup(parent, perms);
+    if (r < 0)
+      return r;
+  }
+
+  unsigned mask = statx_to_mask(flags, want);
+  unsigned batch = cct->_conf.get_val<uint64_t>("client_lookup_batch_size");
+
+  // ask the MDS about the names we have no usable dentry for, a batch
+  // at a time; _lookup() below picks the results up from the cache
+  if (batch > 1 && parent->is_dir() && parent->snapid == CEPH_NOSNAP) {
+    utime_t now = ceph_clock_now();
+    unsigned shared = mask & (CEPH_CAP_ANY_SHARED | CEPH_STAT_RSTAT);
+    std::vector<std::string> missing;
+    for (int i = 0; i < count; ++i) {
+      std::string_view name(names[i]);
+      if (name == "." || name == ".." || name.length() > NAME_MAX ||
+	  name == cct->_conf->client_snapdir)
+	continue;
+      if (parent->dir) {
+	auto it = parent->dir->dentries.find(std::string(name));
+	if (it != parent->dir->dentries.end()) {
+	  Dentry *dn = it->second;
+	  if (dn->lease_ttl > now &&
+	      (!dn->inode || dn->inode->caps_issued_mask(shared, true)))
+	    continue;
+	}
+      }
+      missing.emplace_back(name);
+    }
+    for (size_t i = 0; missing.size() > 1 && i < missing.size(); i += batch) {
+      std::vector<std::string> names_batch(
+	missing.begin() + i,
+	missing.begin() + std::min<size_t>(i + batch, missing.size()));
+      if (_lookup_batch(parent, names_batch, perms) == -CEPHFS_EOPNOTSUPP)
+	break;
+    }
+  }
+
+  for (int i = 0; i < count; ++i) {
+    InodeRef in;
+    results[i] = _lookup(parent, names[i], mask, &in, perms);
+    if (results[i] < 0) {
+      stx[i].stx_ino = 0;
+      stx[i].stx_mask = 0;
+    } else {
+      ceph_assert(in);
+      fill_statx(in, mask, &stx[i]);
+      _ll_get(in.get());
+    }
+    out[i] = in.get();
+  }
+  return 0;
+}
+
 int Client::ll_walk(const char* name, Inode **out, struct ceph_statx *stx,
 		    unsigned int want, unsigned int flags, const UserPerm& perms)
 {
@@ -565,6 +565,9 @@ public:
   int ll_lookupx(Inode *parent, const char *name, Inode **out,
 			struct ceph_statx *stx, unsigned want, unsigned flags,
 			const UserPerm& perms);
+  int ll_lookupx_batch(Inode *parent, int count, const char * const names[],
+		       Inode *out[], struct ceph_statx stx[], int results[],
+		       unsigned want, unsigned flags, const UserPerm& perms);
   bool ll_forget(Inode *in, uint64_t count);
   bool ll_put(Inode *in);
   int ll_get_snap_ref(snapid_t snap);
@@ -729,6 +732,7 @@ public:
   void handle_quota(const MConstRef<MClientQuota>& m);
   void handle_snap(const MConstRef<MClientSnap>& m);
   void handle_caps(const MConstRef<MClientCaps>& m);
+  void handle_caps_batch(const MConstRef<MClientCapsBatch>& m);
   void handle_cap_import(MetaSession *session, Inode *in, const MConstRef<MClientCaps>& m);
   void handle_cap_export(MetaSession *session, Inode *in, const MConstRef<MClientCaps>& m);
   void handle_cap_trunc(MetaSession *session, Inode *in, const MConstRef<MClientCaps>& m);
@@ -792,6 +796,7 @@ public:
 
   void clear_dir_complete_and_ordered(Inode *diri, bool complete);
   void insert_readdir_results(MetaRequest *request, MetaSession *session, Inode *diri);
+  void insert_lookupbatch_results(MetaRequest *request, MetaSession *session, Inode *diri);
   Inode* insert_trace(MetaRequest *request, MetaSession *session);
   void update_inode_file_size(Inode *in, int issued, uint64_t size,
 			      uint64_t truncate_seq, uint64_t truncate_size);
@@ -1323,6 +1328,8 @@ private:
 
   int _lookup(Inode *dir, const std::string& dname, int mask, InodeRef *target,
 	      const UserPerm& perm, std::string* alternate_name=nullptr);
+  int _lookup_batch(Inode *dir, const std::vector<std::string>& names,
+		    const UserPerm& perms);
 
   int _link(Inode *in, Inode *dir, const char *name, const UserPerm& perm, std::string alternate_name,
 	    InodeRef *inp = 0);
@@ -35,6 +35,7 @@
 #include "common/errno.h"
 #include "common/safe_io.h"
 #include "include/types.h"
+#include "include/stat.h"
 #include "Client.h"
 #include "Fh.h"
 #include "ioctl.h"
@@ -883,9 +884,8 @@ static void fuse_ll_read(fuse_req_t req, fuse_ino_t ino, size_t size, off_t off,
     size_t len;
     struct fuse_bufvec *bufv;
 
-    if (bl.get_num_buffers() > IOV_MAX)
-      bl.rebuild();
-
+    // hand the bufferlist segments to fuse as they are, so that they can
+    // be spliced to the kernel without being copied together first
     bl.prepare_iov(&iov);
     len = sizeof(struct fuse_bufvec) + sizeof(struct fuse_buf) * (iov.size() - 1);
     bufv = (struct fuse_bufvec *)calloc(1, len);
@@ -900,6 +900,13 @@ static void fuse_ll_read(fuse_req_t req, fuse_ino_t ino, size_t size, off_t off,
       free(bufv);
       return;
     }
+    // fuse_reply_iov() is limited to IOV_MAX segments (including the
+    // header), so only pay for the rebuild on this fallback path
+    if (bl.get_num_buffers() >= IOV_MAX) {
+      bl.rebuild();
+      iov.clear();
+      bl.prepare_iov(&iov);
+    }
     iov.insert(iov.begin(), {0}); // the first one is reserved for fuse_out_header
     fuse_reply_iov(req, &iov[0], iov.size());
   } else
@@ -1056,6 +1063,95 @@ static void fuse_ll_readdir(fuse_req_t req, fuse_ino_t ino, size_t size,
   delete[] rc.buf;
 }
 
+#if FUSE_VERSION >= FUSE_MAKE_VERSION(3, 0)
+/*
+ * Like fuse_ll_add_dirent(), but also hands the kernel the attributes
+ * that came back with the readdir reply, so that a following stat() of
+ * each entry does not need a round trip of its own.
+ *
+ * return 0 on success, -1 if out of space
+ */
+static int fuse_ll_add_dirent_plus(void *p, struct dirent *de,
+				   struct ceph_statx *stx, off_t next_off,
+				   Inode *in)
+{
+  struct readdir_context *c = (struct readdir_context *)p;
+  CephFuse::Handle *cfuse = (CephFuse::Handle *)fuse_req_userdata(c->req);
+  struct fuse_entry_param fe;
+
+  memset(&fe, 0, sizeof(fe));
+  fe.attr.st_ino = stx->stx_ino;
+  fe.attr.st_dev = c->snap;
+  fe.attr.st_mode = stx->stx_mode;
+  fe.attr.st_rdev = new_encode_dev(stx->stx_rdev);
+  fe.attr.st_nlink = stx->stx_nlink;
+  fe.attr.st_uid = stx->stx_uid;
+  fe.attr.st_gid = stx->stx_gid;
+  fe.attr.st_size = stx->stx_size;
+  fe.attr.st_blksize = stx->stx_blksize;
+  fe.attr.st_blocks = stx->stx_blocks;
+  stat_set_atime_sec(&fe.attr, stx->stx_atime.tv_sec);
+  stat_set_atime_nsec(&fe.attr, stx->stx_atime.tv_nsec);
+  stat_set_mtime_sec(&fe.attr, stx->stx_mtime.tv_sec);
+  stat_set_mtime_nsec(&fe.attr, stx->stx_mtime.tv_nsec);
+  stat_set_ctime_sec(&fe.attr, stx->stx_ctime.tv_sec);
+  stat_set_ctime_nsec(&fe.attr, stx->stx_ctime.tv_nsec);
+  fe.ino = cfuse->make_fake_ino(stx->stx_ino, c->snap);
+  fe.attr.st_ino = fe.ino;
+
+  // only let the kernel cache what our caps vouch for; otherwise it
+  // will come back with a getattr as it would after readdir
+  if (in->caps_issued_mask(CEPH_CAP_ANY_SHARED, true))
+    fuse_entry_param_init(&fe, cfuse);
+
+  size_t room = c->size - c->pos;
+  size_t entrysize = fuse_add_direntry_plus(c->req, c->buf + c->pos, room,
+					    de->d_name, &fe, next_off);
+  if (entrysize > room) {
+    cfuse->client->ll_put(in);
+    return -ENOSPC;
+  }
+
+  // FUSE takes a lookup reference on every entry except "." and "..",
+  // and drops it in a matching fuse_ll_forget()
+  if (!strcmp(de->d_name, ".") || !strcmp(de->d_name, ".."))
+    cfuse->client->ll_put(in);
+
+  /* success */
+  c->pos += entrysize;
+  return 0;
+}
+
+static void fuse_ll_readdirplus(fuse_req_t req, fuse_ino_t ino, size_t size,
+				off_t off, struct fuse_file_info *fi)
+{
+  CephFuse::Handle *cfuse = fuse_ll_req_prepare(req);
+
+  dir_result_t *dirp = reinterpret_cast<dir_result_t*>(fi->fh);
+  cfuse->client->seekdir(dirp, off);
+
+  struct readdir_context rc;
+  rc.req = req;
+  rc.snap = cfuse->fino_snap(ino);
+  if (rc.snap == CEPH_MAXSNAP) {
+    fuse_reply_err(req, get_sys_errno(CEPHFS_EINVAL));
+    return;
+  }
+  rc.buf = new char[size];
+  rc.size = size;
+  rc.pos = 0;
+
+  int r = cfuse->client->readdir_r_cb(dirp, fuse_ll_add_dirent_plus, &rc,
+				      CEPH_STATX_BASIC_STATS,
+				      AT_STATX_DONT_SYNC, true);
+  if (r == 0 || r == -CEPHFS_ENOSPC)  /* ignore ENOSPC from our callback */
+    fuse_reply_buf(req, rc.buf, rc.pos);
+  else
+    fuse_reply_err(req, get_sys_errno(-r));
+  delete[] rc.buf;
+}
+#endif
+
 static void fuse_ll_releasedir(fuse_req_t req, fuse_ino_t ino,
 			       struct fuse_file_info *fi)
 {
@@ -1310,6 +1406,17 @@ static void do_init(void *data, fuse_conn_info *conn)
     conn->want |= FUSE_CAP_EXPORT_SUPPORT;
 #endif
 
+#if FUSE_VERSION >= FUSE_MAKE_VERSION(3, 0)
+  if (client->cct->_conf.get_val<bool>("fuse_use_readdirplus") &&
+      (conn->capable & FUSE_CAP_READDIRPLUS)) {
+    conn->want |= FUSE_CAP_READDIRPLUS;
+    if (conn->capable & FUSE_CAP_READDIRPLUS_AUTO)
+      conn->want |= FUSE_CAP_READDIRPLUS_AUTO;
+  } else {
+    conn->want &= ~(FUSE_CAP_READDIRPLUS | FUSE_CAP_READDIRPLUS_AUTO);
+  }
+#endif
+
   if (cfuse->fd_on_success) {
     //cout << "fuse init signaling on fd " << fd_on_success << std::endl;
     // see Preforker::daemonize(), ceph-fuse's parent process expects a `-1`
@@ -1380,7 +1487,10 @@ const static struct fuse_lowlevel_ops fuse_ll_oper = {
  flock: fuse_ll_flock,
 #endif
 #if FUSE_VERSION >= FUSE_MAKE_VERSION(2, 9)
- fallocate: fuse_ll_fallocate
+ fallocate: fuse_ll_fallocate,
+#endif
+#if FUSE_VERSION >= FUSE_MAKE_VERSION(3, 0)
+ readdirplus: fuse_ll_readdirplus,
 #endif
 };
 
@@ -1437,7 +1547,7 @@ int CephFuse::Handle::init(int argc, const char *argv[])
 
   // set up fuse argc/argv
   int newargc = 0;
-  const char **newargv = (const char **) malloc((argc + 17) * sizeof(char *));
+  const char **newargv = (const char **) malloc((argc + 19) * sizeof(char *));
   if(!newargv)
     return ENOMEM;
 
@@ -1454,6 +1564,8 @@ int CephFuse::Handle::init(int argc, const char *argv[])
 #endif
   auto fuse_max_write = client->cct->_conf.get_val<Option::size_t>(
     "fuse_max_write");
+  auto fuse_max_read = client->cct->_conf.get_val<Option::size_t>(
+    "fuse_max_read");
   auto fuse_atomic_o_trunc = client->cct->_conf.get_val<bool>(
     "fuse_atomic_o_trunc");
   auto fuse_splice_read = client->cct->_conf.get_val<bool>(
@@ -1474,6 +1586,9 @@ int CephFuse::Handle::init(int argc, const char *argv[])
     newargv[newargc++] = "default_permissions";
   }
 #if defined(__linux__)
+  // must outlive newargv
+  char strsplice[65];
+  char strmaxread[65];
 #if FUSE_VERSION < FUSE_MAKE_VERSION(3, 0)
   if (fuse_big_writes) {
     newargv[newargc++] = "-o";
@@ -1481,11 +1596,15 @@ int CephFuse::Handle::init(int argc, const char *argv[])
   }
 #endif
   if (fuse_max_write > 0) {
-    char strsplice[65];
     newargv[newargc++] = "-o";
     sprintf(strsplice, "max_write=%zu", (size_t)fuse_max_write);
     newargv[newargc++] = strsplice;
   }
+  if (fuse_max_read > 0) {
+    newargv[newargc++] = "-o";
+    sprintf(strmaxread, "max_read=%zu", (size_t)fuse_max_read);
+    newargv[newargc++] = strmaxread;
+  }
   if (fuse_atomic_o_trunc) {
     newargv[newargc++] = "-o";
     newargv[newargc++] = "atomic_o_trunc";
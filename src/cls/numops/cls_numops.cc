@@ -23,6 +23,8 @@
 
 #include "objclass/objclass.h"
 #include <errno.h>
+#include <map>
+#include <set>
 #include <string>
 #include <sstream>
 #include <cstdio>
@@ -31,6 +33,8 @@
 #define DECIMAL_PRECISION 10
 
 using ceph::bufferlist;
+using std::map;
+using std::set;
 using std::string;
 using ceph::decode;
 using ceph::encode;
@@ -148,6 +152,84 @@ static int mul(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
   return cls_cxx_map_set_val(hctx, key, &new_value);
 }
 
+/*
+ * Apply op to many keys, with a single omap read and a single omap write
+ * rather than a lookup and an update per key.
+ *
+ * Input:
+ * @param operands map of key to the operand to apply to its value
+ */
+static int apply_many(cls_method_context_t hctx, bufferlist *in,
+                      const char *name, double (*op)(double, double))
+{
+  map<string, string> operands;
+
+  auto iter = in->cbegin();
+  try {
+    decode(operands, iter);
+  } catch (const ceph::buffer::error &err) {
+    CLS_LOG(20, "%s: invalid decode of input", name);
+    return -EINVAL;
+  }
+
+  set<string> keys;
+  for (const auto& [key, operand] : operands) {
+    keys.insert(keys.end(), key);
+  }
+
+  map<string, bufferlist> values;
+  int ret = cls_cxx_map_get_vals_by_keys(hctx, keys, &values);
+  if (ret < 0) {
+    CLS_ERR("%s: error reading omap keys: %d", name, ret);
+    return ret;
+  }
+
+  for (const auto& [key, operand] : operands) {
+    char *end_ptr = 0;
+    double difference = strtod(operand.c_str(), &end_ptr);
+
+    if (end_ptr && *end_ptr != '\0') {
+      CLS_ERR("%s: invalid input value: %s", name, operand.c_str());
+      return -EINVAL;
+    }
+
+    bufferlist& bl = values[key];
+    double value = 0;
+    if (bl.length() > 0) {
+      std::string stored_value(bl.c_str(), bl.length());
+      end_ptr = 0;
+      value = strtod(stored_value.c_str(), &end_ptr);
+
+      if (end_ptr && *end_ptr != '\0') {
+        CLS_ERR("%s: invalid stored value: %s", name, stored_value.c_str());
+        return -EBADMSG;
+      }
+    }
+
+    value = op(value, difference);
+
+    std::stringstream stream;
+    stream << std::setprecision(DECIMAL_PRECISION) << value;
+
+    bl.clear();
+    bl.append(stream.str());
+  }
+
+  return cls_cxx_map_set_vals(hctx, &values);
+}
+
+static int add_many(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
+{
+  return apply_many(hctx, in, "add_many",
+                    [](double value, double d) { return value + d; });
+}
+
+static int mul_many(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
+{
+  return apply_many(hctx, in, "mul_many",
+                    [](double value, double d) { return value * d; });
+}
+
 CLS_INIT(numops)
 {
   CLS_LOG(20, "loading cls_numops");
@@ -155,6 +237,8 @@ CLS_INIT(numops)
   cls_handle_t h_class;
   cls_method_handle_t h_add;
   cls_method_handle_t h_mul;
+  cls_method_handle_t h_add_many;
+  cls_method_handle_t h_mul_many;
 
   cls_register("numops", &h_class);
 
@@ -165,4 +249,12 @@ CLS_INIT(numops)
   cls_register_cxx_method(h_class, "mul",
                           CLS_METHOD_RD | CLS_METHOD_WR,
                           mul, &h_mul);
+
+  cls_register_cxx_method(h_class, "add_many",
+                          CLS_METHOD_RD | CLS_METHOD_WR,
+                          add_many, &h_add_many);
+
+  cls_register_cxx_method(h_class, "mul_many",
+                          CLS_METHOD_RD | CLS_METHOD_WR,
+                          mul_many, &h_mul_many);
 }
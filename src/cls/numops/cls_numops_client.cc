@@ -74,6 +74,38 @@ namespace rados {
         return mul(ioctx, oid, key, 1 / value_to_divide);
       }
 
+      static int exec_many(librados::IoCtx *ioctx,
+                           const std::string& oid,
+                           const char *method,
+                           const std::map<std::string, double>& values)
+      {
+        std::map<std::string, std::string> operands;
+        for (const auto& [key, value] : values) {
+          std::stringstream stream;
+          stream << value;
+          operands.emplace_hint(operands.end(), key, stream.str());
+        }
+
+        bufferlist in, out;
+        encode(operands, in);
+
+        return ioctx->exec(oid, "numops", method, in, out);
+      }
+
+      int add(librados::IoCtx *ioctx,
+              const std::string& oid,
+              const std::map<std::string, double>& values_to_add)
+      {
+        return exec_many(ioctx, oid, "add_many", values_to_add);
+      }
+
+      int mul(librados::IoCtx *ioctx,
+              const std::string& oid,
+              const std::map<std::string, double>& values_to_multiply)
+      {
+        return exec_many(ioctx, oid, "mul_many", values_to_multiply);
+      }
+
     } // namespace numops
   } // namespace cls
 } // namespace rados
@@ -16,6 +16,7 @@
 #define CEPH_LIBRBD_CLS_NUMOPS_CLIENT_H
 
 #include "include/rados/librados_fwd.hpp"
+#include <map>
 #include <string>
 
 namespace rados {
@@ -42,6 +43,16 @@ namespace rados {
                      const std::string& key,
                      double value_to_divide);
 
+      // apply to many keys of one object in a single call; the keys are
+      // read and written together, and all or none are updated
+      extern int add(librados::IoCtx *ioctx,
+                     const std::string& oid,
+                     const std::map<std::string, double>& values_to_add);
+
+      extern int mul(librados::IoCtx *ioctx,
+                     const std::string& oid,
+                     const std::map<std::string, double>& values_to_multiply);
+
     } // namespace numops
   } // namespace cls
 } // namespace rados
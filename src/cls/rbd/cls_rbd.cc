@@ -3347,6 +3347,70 @@ int object_map_read(cls_method_context_t hctx, BitVector<2> &object_map)
   return 0;
 }
 
+/**
+ * Write back the given CRC blocks of an object map, along with their
+ * data CRCs, instead of rewriting the whole object.
+ *
+ * @param dirty_blocks sorted indexes of the modified blocks
+ */
+static int object_map_write_blocks(cls_method_context_t hctx,
+                                   BitVector<2> &object_map,
+                                   const std::vector<uint64_t> &dirty_blocks)
+{
+  const uint64_t objects_per_block =
+    BitVector<2>::BLOCK_SIZE * 8 / BitVector<2>::BIT_COUNT;
+
+  auto it = dirty_blocks.begin();
+  while (it != dirty_blocks.end()) {
+    // coalesce runs of adjacent blocks into a single write
+    uint64_t start_block = *it;
+    uint64_t end_block = start_block + 1;
+    for (++it; it != dirty_blocks.end() && *it == end_block; ++it) {
+      ++end_block;
+    }
+
+    uint64_t start_object_no = start_block * objects_per_block;
+    uint64_t object_count = std::min(end_block * objects_per_block,
+                                     object_map.size()) - start_object_no;
+
+    uint64_t data_byte_offset;
+    uint64_t object_byte_offset;
+    uint64_t byte_length;
+    object_map.get_data_extents(start_object_no, object_count,
+                                &data_byte_offset, &object_byte_offset,
+                                &byte_length);
+
+    bufferlist data_bl;
+    object_map.encode_data(data_bl, data_byte_offset, byte_length);
+    int r = cls_cxx_write2(hctx, object_byte_offset, data_bl.length(),
+                           &data_bl, CEPH_OSD_OP_FLAG_FADVISE_WILLNEED);
+    if (r < 0) {
+      CLS_ERR("failed to write object map data: %s", cpp_strerror(r).c_str());
+      return r;
+    }
+
+    if (!object_map.is_crc_enabled()) {
+      continue;
+    }
+
+    object_map.get_data_crcs_extents(start_object_no, object_count,
+                                     &object_byte_offset, &byte_length);
+    bufferlist footer_bl;
+    object_map.encode_data_crcs(footer_bl, start_object_no, object_count);
+    r = cls_cxx_write2(hctx, object_byte_offset, footer_bl.length(),
+                       &footer_bl, CEPH_OSD_OP_FLAG_FADVISE_WILLNEED);
+    if (r < 0) {
+      CLS_ERR("failed to write object map footer: %s", cpp_strerror(r).c_str());
+      return r;
+    }
+  }
+
+  CLS_LOG(20, "object_map_write_blocks: wrote %zu of %" PRIu64 " blocks",
+          dirty_blocks.size(),
+          (object_map.size() + objects_per_block - 1) / objects_per_block);
+  return 0;
+}
+
 /**
  * Load an rbd image's object map
  *
@@ -3637,22 +3701,24 @@ int object_map_snap_add(cls_method_context_t hctx, bufferlist *in,
     return r;
   }
 
-  bool updated = false;
+  // only rewrite the blocks that change, so that a snapshot of a mostly
+  // clean image does not rewrite the whole object map
+  const uint64_t objects_per_block =
+    BitVector<2>::BLOCK_SIZE * 8 / BitVector<2>::BIT_COUNT;
+  std::vector<uint64_t> dirty_blocks;
   auto it = object_map.begin();
   auto end_it = object_map.end();
-  for (; it != end_it; ++it) {
+  for (uint64_t i = 0; it != end_it; ++it, ++i) {
     if (*it == OBJECT_EXISTS) {
       *it = OBJECT_EXISTS_CLEAN;
-      updated = true;
+      uint64_t block = i / objects_per_block;
+      if (dirty_blocks.empty() || dirty_blocks.back() != block) {
+        dirty_blocks.push_back(block);
+      }
     }
   }
 
-  if (updated) {
-    bufferlist bl;
-    encode(object_map, bl);
-    r = cls_cxx_write_full(hctx, &bl);
-  }
-  return r;
+  return object_map_write_blocks(hctx, object_map, dirty_blocks);
 }
 
 /**
@@ -3682,7 +3748,9 @@ int object_map_snap_remove(cls_method_context_t hctx, bufferlist *in,
     return r;
   }
 
-  bool updated = false;
+  const uint64_t objects_per_block =
+    BitVector<2>::BLOCK_SIZE * 8 / BitVector<2>::BIT_COUNT;
+  std::vector<uint64_t> dirty_blocks;
   auto src_it = src_object_map.begin();
   auto dst_it = dst_object_map.begin();
   auto dst_it_end = dst_object_map.end();
@@ -3691,19 +3759,17 @@ int object_map_snap_remove(cls_method_context_t hctx, bufferlist *in,
     if (*dst_it == OBJECT_EXISTS_CLEAN &&
         (i >= src_object_map.size() || *src_it == OBJECT_EXISTS)) {
       *dst_it = OBJECT_EXISTS;
-      updated = true;
+      uint64_t block = i / objects_per_block;
+      if (dirty_blocks.empty() || dirty_blocks.back() != block) {
+        dirty_blocks.push_back(block);
+      }
     }
     if (i < src_object_map.size())
       ++src_it;
     ++i;
   }
 
-  if (updated) {
-    bufferlist bl;
-    encode(dst_object_map, bl);
-    r = cls_cxx_write_full(hctx, &bl);
-  }
-  return r;
+  return object_map_write_blocks(hctx, dst_object_map, dirty_blocks);
 }
 
 static const string metadata_key_for_name(const string &name)
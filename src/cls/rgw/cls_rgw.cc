@@ -485,6 +485,14 @@ int rgw_bucket_list(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
   // wanting to slow down this op with too many omap reads
   constexpr int max_attempts = 8;
 
+  // when a read ends inside a common prefix, the next read just seeks
+  // past it. those are cheap, so they get their own budget rather than
+  // using up attempts, and they fetch only a few entries since the
+  // next prefix may be just as deep; that keeps a delimited listing
+  // over a deep hierarchy proportional to the number of prefixes
+  constexpr int max_prefix_seeks = 256;
+  constexpr uint32_t prefix_seek_entries = 16;
+
   auto iter = in->cbegin();
 
   rgw_cls_list_op op;
@@ -534,6 +542,8 @@ int rgw_bucket_list(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
   bool done = false;   // whether we need to keep calling get_obj_vals
   bool more = true;    // output parameter of get_obj_vals
   bool has_delimiter = !op.delimiter.empty();
+  bool seek_past_prefix = false; // last read ended inside a common prefix
+  int prefix_seeks = 0;
 
   if (has_delimiter &&
       start_after_omap_key > op.filter_prefix &&
@@ -548,15 +558,20 @@ int rgw_bucket_list(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
 	 more &&
 	 !done &&
 	 name_entry_map.size() < op.num_entries;
-       ++attempt) {
+       ) {
     std::map<std::string, bufferlist> keys;
 
+    uint32_t max_entries = op.num_entries - name_entry_map.size();
+    if (seek_past_prefix) {
+      max_entries = std::min(max_entries, prefix_seek_entries);
+    }
+    seek_past_prefix = false;
+
     // note: get_obj_vals skips past the "ugly namespace" (i.e.,
     // entries that start with the BI_PREFIX_CHAR), so no need to
     // check for such entries
     rc = get_obj_vals(hctx, start_after_omap_key, op.filter_prefix,
-		      op.num_entries - name_entry_map.size(),
-		      &keys, &more);
+		      max_entries, &keys, &more);
     if (rc < 0) {
       return rc;
     }
@@ -640,6 +655,7 @@ int rgw_bucket_list(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
 	  // advance past this subdirectory, but then back up one,
 	  // so the loop increment will put us in the right place
 	  kiter = keys.lower_bound(start_after_omap_key);
+	  seek_past_prefix = (kiter == keys.end());
 	  --kiter;
 
           continue;
@@ -658,6 +674,10 @@ int rgw_bucket_list(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
 		int(name_entry_map.size()));
       }
     } // for (auto kiter...
+
+    if (!seek_past_prefix || ++prefix_seeks > max_prefix_seeks) {
+      ++attempt;
+    }
   } // for (int attempt...
 
   ret.is_truncated = more && !done;
@@ -866,29 +886,10 @@ static std::string modify_op_str(uint8_t op) {
   return modify_op_str((RGWModifyOp) op);
 }
 
-int rgw_bucket_prepare_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
+// records one pending op in the index
+static int prepare_op(cls_method_context_t hctx, bool bitx_inst,
+		      const rgw_cls_obj_prepare_op& op)
 {
-  const ConfigProxy& conf = cls_get_config(hctx);
-  const object_info_t& oi = cls_get_object_info(hctx);
-
-  // bucket index transaction instrumentation
-  const bool bitx_inst =
-    conf->rgw_bucket_index_transaction_instrumentation;
-
-  CLS_LOG_BITX(bitx_inst, 10, "ENTERING %s for object oid=%s key=%s",
-	       __func__, oi.soid.oid.name.c_str(), oi.soid.get_key().c_str());
-
-  // decode request
-  rgw_cls_obj_prepare_op op;
-  auto iter = in->cbegin();
-  try {
-    decode(op, iter);
-  } catch (ceph::buffer::error& err) {
-    CLS_LOG_BITX(bitx_inst, 1,
-		 "ERROR: %s: failed to decode request", __func__);
-    return -EINVAL;
-  }
-
   if (op.tag.empty()) {
     CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: tag is empty", __func__);
     return -EINVAL;
@@ -946,10 +947,86 @@ int rgw_bucket_prepare_op(cls_method_context_t hctx, bufferlist *in, bufferlist
     return rc;
   }
 
+  return 0;
+}
+
+int rgw_bucket_prepare_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
+{
+  const ConfigProxy& conf = cls_get_config(hctx);
+  const object_info_t& oi = cls_get_object_info(hctx);
+
+  // bucket index transaction instrumentation
+  const bool bitx_inst =
+    conf->rgw_bucket_index_transaction_instrumentation;
+
+  CLS_LOG_BITX(bitx_inst, 10, "ENTERING %s for object oid=%s key=%s",
+	       __func__, oi.soid.oid.name.c_str(), oi.soid.get_key().c_str());
+
+  // decode request
+  rgw_cls_obj_prepare_op op;
+  auto iter = in->cbegin();
+  try {
+    decode(op, iter);
+  } catch (ceph::buffer::error& err) {
+    CLS_LOG_BITX(bitx_inst, 1,
+		 "ERROR: %s: failed to decode request", __func__);
+    return -EINVAL;
+  }
+
+  int rc = prepare_op(hctx, bitx_inst, op);
+  if (rc < 0) {
+    return rc;
+  }
+
   CLS_LOG_BITX(bitx_inst, 10, "EXITING %s, returning 0", __func__);
   return 0;
 } // rgw_bucket_prepare_op
 
+// prepare a batch of ops on one shard; see rgw_bucket_complete_ops()
+static int rgw_bucket_prepare_ops(cls_method_context_t hctx,
+				  bufferlist *in, bufferlist *out)
+{
+  const ConfigProxy& conf = cls_get_config(hctx);
+  const object_info_t& oi = cls_get_object_info(hctx);
+
+  // bucket index transaction instrumentation
+  const bool bitx_inst =
+    conf->rgw_bucket_index_transaction_instrumentation;
+
+  CLS_LOG_BITX(bitx_inst, 10, "ENTERING %s for object oid=%s key=%s",
+	       __func__, oi.soid.oid.name.c_str(), oi.soid.get_key().c_str());
+
+  // decode request
+  rgw_cls_obj_prepare_ops batch;
+  auto iter = in->cbegin();
+  try {
+    decode(batch, iter);
+  } catch (ceph::buffer::error& err) {
+    CLS_LOG_BITX(bitx_inst, 1,
+		 "ERROR: %s: failed to decode request", __func__);
+    return -EINVAL;
+  }
+
+  std::set<cls_rgw_obj_key> keys;
+  for (const auto& op : batch.ops) {
+    if (!keys.insert(op.key).second) {
+      CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: key %s appears more than once",
+		   __func__, escape_str(op.key.to_string()).c_str());
+      return -EINVAL;
+    }
+  }
+
+  for (const auto& op : batch.ops) {
+    int rc = prepare_op(hctx, bitx_inst, op);
+    if (rc < 0) {
+      return rc;
+    }
+  }
+
+  CLS_LOG_BITX(bitx_inst, 10, "EXITING %s, returning 0", __func__);
+  return 0;
+} // rgw_bucket_prepare_ops
+
 static void unaccount_entry(rgw_bucket_dir_header& header,
 			    rgw_bucket_dir_entry& entry)
 {
@@ -1080,28 +1157,12 @@ static int complete_remove_obj(cls_method_context_t hctx,
   return ret;
 }
 
-int rgw_bucket_complete_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
+// applies one completion to the index. the caller reads the header
+// before and writes it back after
+static int complete_op(cls_method_context_t hctx, bool bitx_inst,
+		       rgw_bucket_dir_header& header,
+		       rgw_cls_obj_complete_op& op)
 {
-  const ConfigProxy& conf = cls_get_config(hctx);
-  const object_info_t& oi = cls_get_object_info(hctx);
-
-  // bucket index transaction instrumentation
-  const bool bitx_inst =
-    conf->rgw_bucket_index_transaction_instrumentation;
-
-  CLS_LOG_BITX(bitx_inst, 10, "ENTERING %s for object oid=%s key=%s",
-	       __func__, oi.soid.oid.name.c_str(), oi.soid.get_key().c_str());
-
-  // decode request
-  rgw_cls_obj_complete_op op;
-  auto iter = in->cbegin();
-  try {
-    decode(op, iter);
-  } catch (ceph::buffer::error& err) {
-    CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: failed to decode request", __func__);
-    return -EINVAL;
-  }
-
   CLS_LOG_BITX(bitx_inst, 1,
 	       "INFO: %s: request: op=%s name=%s ver=%lu:%llu tag=%s",
 	       __func__,
@@ -1109,19 +1170,11 @@ int rgw_bucket_complete_op(cls_method_context_t hctx, bufferlist *in, bufferlist
 	       (unsigned long)op.ver.pool, (unsigned long long)op.ver.epoch,
 	       op.tag.c_str());
 
-  rgw_bucket_dir_header header;
-  int rc = read_bucket_header(hctx, &header);
-  if (rc < 0) {
-    CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: failed to read header, rc=%d",
-		 __func__, rc);
-    return -EINVAL;
-  }
-
   rgw_bucket_dir_entry entry;
   bool ondisk = true;
 
   std::string idx;
-  rc = read_key_entry(hctx, op.key, &idx, &entry);
+  int rc = read_key_entry(hctx, op.key, &idx, &entry);
   if (rc == -ENOENT) {
     entry.key = op.key;
     entry.ver = op.ver;
@@ -1303,6 +1356,44 @@ int rgw_bucket_complete_op(cls_method_context_t hctx, bufferlist *in, bufferlist
     }
   } // remove loop
 
+  return 0;
+}
+
+int rgw_bucket_complete_op(cls_method_context_t hctx, bufferlist *in, bufferlist *out)
+{
+  const ConfigProxy& conf = cls_get_config(hctx);
+  const object_info_t& oi = cls_get_object_info(hctx);
+
+  // bucket index transaction instrumentation
+  const bool bitx_inst =
+    conf->rgw_bucket_index_transaction_instrumentation;
+
+  CLS_LOG_BITX(bitx_inst, 10, "ENTERING %s for object oid=%s key=%s",
+	       __func__, oi.soid.oid.name.c_str(), oi.soid.get_key().c_str());
+
+  // decode request
+  rgw_cls_obj_complete_op op;
+  auto iter = in->cbegin();
+  try {
+    decode(op, iter);
+  } catch (ceph::buffer::error& err) {
+    CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: failed to decode request", __func__);
+    return -EINVAL;
+  }
+
+  rgw_bucket_dir_header header;
+  int rc = read_bucket_header(hctx, &header);
+  if (rc < 0) {
+    CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: failed to read header, rc=%d",
+		 __func__, rc);
+    return -EINVAL;
+  }
+
+  rc = complete_op(hctx, bitx_inst, header, op);
+  if (rc < 0) {
+    return rc;
+  }
+
   CLS_LOG_BITX(bitx_inst, 20,
 	       "INFO: %s: writing bucket header", __func__);
   rc = write_bucket_header(hctx, &header);
@@ -1317,6 +1408,83 @@ int rgw_bucket_complete_op(cls_method_context_t hctx, bufferlist *in, bufferlist
   return rc;
 } // rgw_bucket_complete_op
 
+/*
+ * complete a batch of ops on one shard, reading and writing the header
+ * only once. a cls call cannot read back its own omap writes, so a key
+ * may appear only once in the batch. any error fails the whole batch,
+ * leaving the index untouched; the caller can then retry the ops one by
+ * one with rgw_bucket_complete_op.
+ */
+static int rgw_bucket_complete_ops(cls_method_context_t hctx,
+				   bufferlist *in, bufferlist *out)
+{
+  const ConfigProxy& conf = cls_get_config(hctx);
+  const object_info_t& oi = cls_get_object_info(hctx);
+
+  // bucket index transaction instrumentation
+  const bool bitx_inst =
+    conf->rgw_bucket_index_transaction_instrumentation;
+
+  CLS_LOG_BITX(bitx_inst, 10, "ENTERING %s for object oid=%s key=%s",
+	       __func__, oi.soid.oid.name.c_str(), oi.soid.get_key().c_str());
+
+  // decode request
+  rgw_cls_obj_complete_ops batch;
+  auto iter = in->cbegin();
+  try {
+    decode(batch, iter);
+  } catch (ceph::buffer::error& err) {
+    CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: failed to decode request", __func__);
+    return -EINVAL;
+  }
+
+  std::set<cls_rgw_obj_key> keys;
+  for (const auto& op : batch.ops) {
+    bool dup = !keys.insert(op.key).second;
+    for (const auto& remove_key : op.remove_objs) {
+      dup |= !keys.insert(remove_key).second;
+    }
+    if (dup) {
+      CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: key %s appears more than once",
+		   __func__, escape_str(op.key.to_string()).c_str());
+      return -EINVAL;
+    }
+  }
+
+  rgw_bucket_dir_header header;
+  int rc = read_bucket_header(hctx, &header);
+  if (rc < 0) {
+    CLS_LOG_BITX(bitx_inst, 1, "ERROR: %s: failed to read header, rc=%d",
+		 __func__, rc);
+    return -EINVAL;
+  }
+
+  for (size_t i = 0; i < batch.ops.size(); ++i) {
+    if (i > 0) {
+      // each op gets its own index version, as it would with a header
+      // write in between
+      ++header.ver;
+    }
+    rc = complete_op(hctx, bitx_inst, header, batch.ops[i]);
+    if (rc < 0) {
+      return rc;
+    }
+  }
+
+  CLS_LOG_BITX(bitx_inst, 20,
+	       "INFO: %s: writing bucket header", __func__);
+  rc = write_bucket_header(hctx, &header);
+  if (rc < 0) {
+    CLS_LOG_BITX(bitx_inst, 0,
+		 "ERROR: %s: failed to write bucket header ret=%d",
+		 __func__, rc);
+  }
+
+  CLS_LOG_BITX(bitx_inst, 10,
+	       "EXITING %s: returning %d", __func__, rc);
+  return rc;
+} // rgw_bucket_complete_ops
+
 template <class T>
 static int write_entry(cls_method_context_t hctx, T& entry, const string& key)
 {
@@ -4635,6 +4803,8 @@ CLS_INIT(rgw)
   cls_method_handle_t h_rgw_bucket_update_stats;
   cls_method_handle_t h_rgw_bucket_prepare_op;
   cls_method_handle_t h_rgw_bucket_complete_op;
+  cls_method_handle_t h_rgw_bucket_prepare_ops;
+  cls_method_handle_t h_rgw_bucket_complete_ops;
   cls_method_handle_t h_rgw_bucket_link_olh;
   cls_method_handle_t h_rgw_bucket_unlink_instance_op;
   cls_method_handle_t h_rgw_bucket_read_olh_log;
@@ -4686,6 +4856,8 @@ CLS_INIT(rgw)
   cls_register_cxx_method(h_class, RGW_BUCKET_UPDATE_STATS, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_update_stats, &h_rgw_bucket_update_stats);
   cls_register_cxx_method(h_class, RGW_BUCKET_PREPARE_OP, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_prepare_op, &h_rgw_bucket_prepare_op);
   cls_register_cxx_method(h_class, RGW_BUCKET_COMPLETE_OP, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_complete_op, &h_rgw_bucket_complete_op);
+  cls_register_cxx_method(h_class, RGW_BUCKET_PREPARE_OPS, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_prepare_ops, &h_rgw_bucket_prepare_ops);
+  cls_register_cxx_method(h_class, RGW_BUCKET_COMPLETE_OPS, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_complete_ops, &h_rgw_bucket_complete_ops);
   cls_register_cxx_method(h_class, RGW_BUCKET_LINK_OLH, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_link_olh, &h_rgw_bucket_link_olh);
   cls_register_cxx_method(h_class, RGW_BUCKET_UNLINK_INSTANCE, CLS_METHOD_RD | CLS_METHOD_WR, rgw_bucket_unlink_instance, &h_rgw_bucket_unlink_instance_op);
   cls_register_cxx_method(h_class, RGW_BUCKET_READ_OLH_LOG, CLS_METHOD_RD, rgw_bucket_read_olh_log, &h_rgw_bucket_read_olh_log);
@@ -307,6 +307,26 @@ void cls_rgw_bucket_complete_op(ObjectWriteOperation& o, RGWModifyOp op, const s
   o.exec(RGW_CLASS, RGW_BUCKET_COMPLETE_OP, in);
 }
 
+void cls_rgw_bucket_prepare_ops(ObjectWriteOperation& o,
+                                const vector<rgw_cls_obj_prepare_op>& ops)
+{
+  rgw_cls_obj_prepare_ops call;
+  call.ops = ops;
+  bufferlist in;
+  encode(call, in);
+  o.exec(RGW_CLASS, RGW_BUCKET_PREPARE_OPS, in);
+}
+
+void cls_rgw_bucket_complete_ops(ObjectWriteOperation& o,
+                                 const vector<rgw_cls_obj_complete_op>& ops)
+{
+  rgw_cls_obj_complete_ops call;
+  call.ops = ops;
+  bufferlist in;
+  encode(call, in);
+  o.exec(RGW_CLASS, RGW_BUCKET_COMPLETE_OPS, in);
+}
+
 void cls_rgw_bucket_list_op(librados::ObjectReadOperation& op,
                             const cls_rgw_obj_key& start_obj,
                             const std::string& filter_prefix,
@@ -168,6 +168,42 @@ void rgw_cls_obj_complete_op::dump(Formatter *f) const
   encode_json("zones_trace", zones_trace, f);
 }
 
+void rgw_cls_obj_prepare_ops::generate_test_instances(list<rgw_cls_obj_prepare_ops*>& o)
+{
+  list<rgw_cls_obj_prepare_op*> l;
+  rgw_cls_obj_prepare_op::generate_test_instances(l);
+  auto op = new rgw_cls_obj_prepare_ops;
+  for (auto i : l) {
+    op->ops.push_back(*i);
+    delete i;
+  }
+  o.push_back(op);
+  o.push_back(new rgw_cls_obj_prepare_ops);
+}
+
+void rgw_cls_obj_prepare_ops::dump(Formatter *f) const
+{
+  encode_json("ops", ops, f);
+}
+
+void rgw_cls_obj_complete_ops::generate_test_instances(list<rgw_cls_obj_complete_ops*>& o)
+{
+  list<rgw_cls_obj_complete_op*> l;
+  rgw_cls_obj_complete_op::generate_test_instances(l);
+  auto op = new rgw_cls_obj_complete_ops;
+  for (auto i : l) {
+    op->ops.push_back(*i);
+    delete i;
+  }
+  o.push_back(op);
+  o.push_back(new rgw_cls_obj_complete_ops);
+}
+
+void rgw_cls_obj_complete_ops::dump(Formatter *f) const
+{
+  encode_json("ops", ops, f);
+}
+
 void rgw_cls_link_olh_op::generate_test_instances(list<rgw_cls_link_olh_op*>& o)
 {
   rgw_cls_link_olh_op *op = new rgw_cls_link_olh_op;
@@ -25,6 +25,11 @@
  * Memory usage is linear with the number of items queued and
  * linear with respect to the total number of priorities used
  * over all time.
+ *
+ * Requests may name an owner (e.g. the OSD asking for a remote slot).
+ * With set_spread_owners(true), among requests of the same priority
+ * the first one whose owner holds no slot yet is granted ahead of
+ * the others.
  */
 template <typename T, typename F>
 class AsyncReserver {
@@ -32,6 +37,7 @@ class AsyncReserver {
   F *f;
   unsigned max_allowed;
   unsigned min_priority;
+  bool spread_owners = false;
   ceph::mutex lock = ceph::make_mutex("AsyncReserver::lock");
 
   struct Reservation {
@@ -39,13 +45,17 @@ class AsyncReserver {
     unsigned prio = 0;
     Context *grant = 0;
     Context *preempt = 0;
+    int owner = -1;
     Reservation() {}
-    Reservation(T i, unsigned pr, Context *g, Context *p = 0)
-      : item(i), prio(pr), grant(g), preempt(p) {}
+    Reservation(T i, unsigned pr, Context *g, Context *p = 0, int o = -1)
+      : item(i), prio(pr), grant(g), preempt(p), owner(o) {}
     void dump(ceph::Formatter *f) const {
       f->dump_stream("item") << item;
       f->dump_unsigned("prio", prio);
       f->dump_bool("can_preempt", !!preempt);
+      if (owner >= 0) {
+	f->dump_int("owner", owner);
+      }
     }
     friend std::ostream& operator<<(std::ostream& out, const Reservation& r) {
       return out << r.item << "(prio " << r.prio << " grant " << r.grant
@@ -57,6 +67,30 @@ class AsyncReserver {
   std::map<T, std::pair<unsigned, typename std::list<Reservation>::iterator>> queue_pointers;
   std::map<T,Reservation> in_progress;
   std::set<std::pair<unsigned,T>> preempt_by_prio;  ///< in_progress that can be preempted
+  std::map<int, unsigned> owner_in_progress;  ///< owner -> in_progress count
+
+  void _erase_in_progress(typename std::map<T,Reservation>::iterator p) {
+    if (p->second.owner >= 0) {
+      auto o = owner_in_progress.find(p->second.owner);
+      ceph_assert(o != owner_in_progress.end());
+      if (--o->second == 0) {
+	owner_in_progress.erase(o);
+      }
+    }
+    in_progress.erase(p);
+  }
+
+  /// the entry of a priority queue to grant next
+  typename std::list<Reservation>::iterator _pick(std::list<Reservation>& q) {
+    if (spread_owners) {
+      for (auto i = q.begin(); i != q.end(); ++i) {
+	if (i->owner < 0 || !owner_in_progress.count(i->owner)) {
+	  return i;
+	}
+      }
+    }
+    return q.begin();
+  }
 
   void preempt_one() {
     ceph_assert(!preempt_by_prio.empty());
@@ -66,7 +100,7 @@ class AsyncReserver {
     rdout(10) << __func__ << " preempt " << victim << dendl;
     f->queue(victim.preempt);
     victim.preempt = nullptr;
-    in_progress.erase(q);
+    _erase_in_progress(q);
     preempt_by_prio.erase(preempt_by_prio.begin());
   }
 
@@ -103,16 +137,20 @@ class AsyncReserver {
 	break; // no room
       }
       // grant
-      Reservation p = it->second.front();
+      auto next = _pick(it->second);
+      Reservation p = *next;
       rdout(10) << __func__ << " grant " << p << dendl;
       queue_pointers.erase(p.item);
-      it->second.pop_front();
+      it->second.erase(next);
       if (it->second.empty()) {
 	queues.erase(it);
       }
       f->queue(p.grant);
       p.grant = nullptr;
       in_progress[p.item] = p;
+      if (p.owner >= 0) {
+	++owner_in_progress[p.owner];
+      }
       if (p.preempt) {
 	preempt_by_prio.insert(std::make_pair(p.prio, p.item));
       }
@@ -141,6 +179,12 @@ public:
     do_queues();
   }
 
+  void set_spread_owners(bool spread) {
+    std::lock_guard l(lock);
+    spread_owners = spread;
+    do_queues();
+  }
+
   /**
    * Update the priority of a reservation
    *
@@ -220,6 +264,7 @@ public:
   void _dump(ceph::Formatter *f) {
     f->dump_unsigned("max_allowed", max_allowed);
     f->dump_unsigned("min_priority", min_priority);
+    f->dump_bool("spread_owners", spread_owners);
     f->open_array_section("queues");
     for (auto& p : queues) {
       f->open_object_section("queue");
@@ -251,10 +296,11 @@ public:
     T item,                   ///< [in] reservation key
     Context *on_reserved,     ///< [in] callback to be called on reservation
     unsigned prio,            ///< [in] priority
-    Context *on_preempt = 0   ///< [in] callback to be called if we are preempted (optional)
+    Context *on_preempt = 0,  ///< [in] callback to be called if we are preempted (optional)
+    int owner = -1            ///< [in] who is asking, for set_spread_owners (optional)
     ) {
     std::lock_guard l(lock);
-    Reservation r(item, prio, on_reserved, on_preempt);
+    Reservation r(item, prio, on_reserved, on_preempt, owner);
     rdout(10) << __func__ << " queue " << r << dendl;
     ceph_assert(!queue_pointers.count(item) &&
 	   !in_progress.count(item));
@@ -296,7 +342,7 @@ public:
 	  preempt_by_prio.erase(std::make_pair(p->second.prio, p->second.item));
 	  delete p->second.preempt;
 	}
-	in_progress.erase(p);
+	_erase_in_progress(p);
       } else {
 	rdout(10) << __func__ << " cancel " << item << " (not found)" << dendl;
       }
@@ -4,9 +4,12 @@
 #ifndef CEPH_OS_BLUESTORE_CHECKSUMMER
 #define CEPH_OS_BLUESTORE_CHECKSUMMER
 
+#include <algorithm>
+
 #include "include/buffer.h"
 #include "include/byteorder.h"
 #include "include/ceph_assert.h"
+#include "include/crc32c.h"
 
 #include "xxHash/xxhash.h"
 
@@ -73,6 +76,8 @@ public:
 
   struct crc32c {
     typedef uint32_t init_value_t;
+    // blocks may be checksummed in batches with ceph_crc32c_multi()
+    static constexpr uint32_t multi_mask = 0xffffffff;
     typedef ceph_le32 value_t;
 
     // we have no execution context/state.
@@ -94,6 +99,8 @@ public:
 
   struct crc32c_16 {
     typedef uint32_t init_value_t;
+    // blocks may be checksummed in batches with ceph_crc32c_multi()
+    static constexpr uint32_t multi_mask = 0xffff;
     typedef ceph_le16 value_t;
 
     // we have no execution context/state.
@@ -115,6 +122,8 @@ public:
 
   struct crc32c_8 {
     typedef uint32_t init_value_t;
+    // blocks may be checksummed in batches with ceph_crc32c_multi()
+    static constexpr uint32_t multi_mask = 0xff;
     typedef __u8 value_t;
 
     // we have no execution context/state.
@@ -225,6 +234,9 @@ public:
     typename Alg::value_t *pv =
       reinterpret_cast<typename Alg::value_t*>(csum_data->c_str());
     pv += offset / csum_block_size;
+    if constexpr (requires { Alg::multi_mask; }) {
+      calculate_crc32c_multi<Alg>(init_value, csum_block_size, blocks, p, pv);
+    }
     while (blocks--) {
       *pv = Alg::calc(state, init_value, csum_block_size, p);
       ++pv;
@@ -233,6 +245,41 @@ public:
     return 0;
   }
 
+  // checksum the blocks that lie in contiguous memory, one batch per
+  // bufferptr, and leave the rest to the caller's per-block loop.
+  template<class Alg>
+  static void calculate_crc32c_multi(
+      uint32_t init_value,
+      size_t csum_block_size,
+      size_t& blocks,
+      ceph::buffer::list::const_iterator& p,
+      typename Alg::value_t*& pv) {
+    static constexpr size_t batch = 64;
+    const unsigned char* data[batch];
+    uint32_t crcs[batch];
+    while (blocks > 1) {
+      auto cur = p.get_current_ptr();
+      size_t n = std::min<size_t>({blocks, batch, cur.length() / csum_block_size});
+      if (n < 2) {
+	// too little of this bufferptr left, or a block straddles two
+	*pv++ = Alg::calc(0, init_value, csum_block_size, p);
+	--blocks;
+	continue;
+      }
+      auto base = reinterpret_cast<const unsigned char*>(cur.c_str());
+      for (size_t i = 0; i < n; ++i) {
+	data[i] = base + i * csum_block_size;
+	crcs[i] = init_value;
+      }
+      ceph_crc32c_multi(crcs, data, csum_block_size, n);
+      for (size_t i = 0; i < n; ++i) {
+	*pv++ = crcs[i] & Alg::multi_mask;
+      }
+      p += n * csum_block_size;
+      blocks -= n;
+    }
+  }
+
   template<class Alg>
   static int verify(
     size_t csum_block_size,
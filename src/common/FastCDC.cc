@@ -86,15 +86,54 @@ static inline bool _scan(
       *pp = (*p)->c_str();
       *pe = *pp + (*p)->length();
     }
-    const char *te = std::min(*pe, *pp + max - pos);
-    for (; *pp < te; ++(*pp), ++pos) {
-      if ((fp & mask) == mask) {
-	return false;
+    // Work on local copies: fp and pos are references the compiler
+    // cannot keep in registers across the table loads.  The mask is
+    // checked before each byte is rolled in, exactly as the one byte
+    // at a time loop would, so the cut points do not change.
+    const unsigned char *q = (const unsigned char *)*pp;
+    size_t n = std::min<size_t>(*pe - *pp, max - pos);
+    uint64_t f = fp;
+    size_t i = 0;
+    bool hit = false;
+    for (; i + 4 <= n; i += 4) {
+      if ((f & mask) == mask) {
+	hit = true;
+	break;
+      }
+      f = (f << 1) ^ table[q[i]];
+      if ((f & mask) == mask) {
+	i += 1;
+	hit = true;
+	break;
+      }
+      f = (f << 1) ^ table[q[i + 1]];
+      if ((f & mask) == mask) {
+	i += 2;
+	hit = true;
+	break;
+      }
+      f = (f << 1) ^ table[q[i + 2]];
+      if ((f & mask) == mask) {
+	i += 3;
+	hit = true;
+	break;
+      }
+      f = (f << 1) ^ table[q[i + 3]];
+    }
+    if (!hit) {
+      for (; i < n; ++i) {
+	if ((f & mask) == mask) {
+	  hit = true;
+	  break;
+	}
+	f = (f << 1) ^ table[q[i]];
       }
-      fp = (fp << 1) ^ table[*(unsigned char*)*pp];
     }
-    if (pos >= max) {
-      return true;
+    *pp += i;
+    pos += i;
+    fp = f;
+    if (hit) {
+      return false;
     }
   }
   return true;
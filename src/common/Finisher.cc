@@ -53,12 +53,14 @@ void *Finisher::finisher_thread_entry()
       // while we are working.
       in_progress_queue.swap(finisher_queue);
       finisher_running = true;
+      utime_t queued = queue_stamp;
       ul.unlock();
       ldout(cct, 10) << "finisher_thread doing " << in_progress_queue << dendl;
 
       if (logger) {
 	start = ceph_clock_now();
 	count = in_progress_queue.size();
+	logger->tinc(l_finisher_queue_lat, start - queued);
       }
 
       // Now actually process the contexts.
@@ -94,3 +96,38 @@ void *Finisher::finisher_thread_entry()
   return 0;
 }
 
+
+ShardedFinisher::ShardedFinisher(CephContext *cct, std::string name,
+				 std::string tn, unsigned num_lanes)
+{
+  ceph_assert(num_lanes > 0);
+  if (num_lanes == 1) {
+    lanes.emplace_back(std::make_unique<Finisher>(cct, name, tn));
+    return;
+  }
+  for (unsigned i = 0; i < num_lanes; ++i) {
+    lanes.emplace_back(std::make_unique<Finisher>(
+      cct, name + "-" + std::to_string(i), tn + std::to_string(i)));
+  }
+}
+
+void ShardedFinisher::start()
+{
+  for (auto& f : lanes) {
+    f->start();
+  }
+}
+
+void ShardedFinisher::stop()
+{
+  for (auto& f : lanes) {
+    f->stop();
+  }
+}
+
+void ShardedFinisher::wait_for_empty()
+{
+  for (auto& f : lanes) {
+    f->wait_for_empty();
+  }
+}
@@ -15,8 +15,11 @@
 #ifndef CEPH_FINISHER_H
 #define CEPH_FINISHER_H
 
+#include <memory>
+
 #include "include/Context.h"
 #include "include/common_fwd.h"
+#include "common/Clock.h"
 #include "common/Thread.h"
 #include "common/ceph_mutex.h"
 #include "common/perf_counters.h"
@@ -28,6 +31,7 @@ enum {
   l_finisher_first = 997082,
   l_finisher_queue_len,
   l_finisher_complete_lat,
+  l_finisher_queue_lat,
   l_finisher_last
 };
 
@@ -48,6 +52,9 @@ class Finisher {
   /// Queue for contexts for which complete(0) will be called.
   std::vector<std::pair<Context*,int>> finisher_queue;
   std::vector<std::pair<Context*,int>> in_progress_queue;
+  /// When finisher_queue last went from empty to non-empty; only
+  /// maintained for named finishers.
+  utime_t queue_stamp;
 
   std::string thread_name;
 
@@ -72,8 +79,11 @@ class Finisher {
     if (was_empty) {
       finisher_cond.notify_one();
     }
-    if (logger)
+    if (logger) {
+      if (was_empty)
+	queue_stamp = ceph_clock_now();
       logger->inc(l_finisher_queue_len);
+    }
   }
 
   void queue(std::list<Context*>& ls) {
@@ -81,6 +91,8 @@ class Finisher {
       std::unique_lock ul(finisher_lock);
       if (finisher_queue.empty()) {
 	finisher_cond.notify_all();
+	if (logger)
+	  queue_stamp = ceph_clock_now();
       }
       for (auto i : ls) {
 	finisher_queue.push_back(std::make_pair(i, 0));
@@ -95,6 +107,8 @@ class Finisher {
       std::unique_lock ul(finisher_lock);
       if (finisher_queue.empty()) {
 	finisher_cond.notify_all();
+	if (logger)
+	  queue_stamp = ceph_clock_now();
       }
       for (auto i : ls) {
 	finisher_queue.push_back(std::make_pair(i, 0));
@@ -109,6 +123,8 @@ class Finisher {
       std::unique_lock ul(finisher_lock);
       if (finisher_queue.empty()) {
 	finisher_cond.notify_all();
+	if (logger)
+	  queue_stamp = ceph_clock_now();
       }
       for (auto i : ls) {
 	finisher_queue.push_back(std::make_pair(i, 0));
@@ -153,10 +169,13 @@ class Finisher {
 			  l_finisher_first, l_finisher_last);
     b.add_u64(l_finisher_queue_len, "queue_len");
     b.add_time_avg(l_finisher_complete_lat, "complete_latency");
+    b.add_time_avg(l_finisher_queue_lat, "queue_latency",
+		   "Time a batch of contexts waited before being completed");
     logger = b.create_perf_counters();
     cct->get_perfcounters_collection()->add(logger);
     logger->set(l_finisher_queue_len, 0);
     logger->set(l_finisher_complete_lat, 0);
+    logger->set(l_finisher_queue_lat, 0);
   }
 
   ~Finisher() {
@@ -167,6 +186,40 @@ class Finisher {
   }
 };
 
+/** @brief Several Finishers, or lanes, behind one interface.
+ * Contexts queued with the same key complete on the same lane, in the
+ * order they were queued; contexts with different keys may complete
+ * concurrently.  With more than one lane, each lane is a named
+ * Finisher "<name>-<i>" with its own thread and perf counters.
+ */
+class ShardedFinisher {
+  std::vector<std::unique_ptr<Finisher>> lanes;
+
+public:
+  ShardedFinisher(CephContext *cct, std::string name, std::string tn,
+		  unsigned num_lanes);
+
+  unsigned get_num_lanes() const {
+    return lanes.size();
+  }
+  Finisher& get_lane(uint64_t key) {
+    // keys are often pointers or small sequential ids; spread both
+    return *lanes[((key * 0x9e3779b97f4a7c15ull) >> 32) % lanes.size()];
+  }
+
+  void queue(uint64_t key, Context *c, int r = 0) {
+    get_lane(key).queue(c, r);
+  }
+  template <typename T>
+  void queue(uint64_t key, T& ls) {
+    get_lane(key).queue(ls);
+  }
+
+  void start();
+  void stop();
+  void wait_for_empty();
+};
+
 /// Context that is completed asynchronously on the supplied finisher.
 class C_OnFinisher : public Context {
   Context *con;
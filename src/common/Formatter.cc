@@ -20,6 +20,7 @@
 
 #include <fmt/format.h>
 #include <algorithm>
+#include <charconv>
 #include <set>
 #include <limits>
 
@@ -157,44 +158,56 @@ JSONFormatter::JSONFormatter(bool p)
 void JSONFormatter::flush(std::ostream& os)
 {
   finish_pending_string();
-  os << m_ss.str();
+  os << m_ss;
   if (m_line_break_enabled)
     os << "\n";
   m_ss.clear();
-  m_ss.str("");
+}
+
+void JSONFormatter::flush(bufferlist &bl)
+{
+  finish_pending_string();
+  if (m_line_break_enabled)
+    m_ss += '\n';
+  bl.append(m_ss);
+  m_ss.clear();
 }
 
 void JSONFormatter::reset()
 {
   m_stack.clear();
   m_ss.clear();
-  m_ss.str("");
   m_pending_string.clear();
   m_pending_string.str("");
 }
 
+void JSONFormatter::print_indent(unsigned levels)
+{
+  m_ss.append(levels * 4, ' ');
+}
+
 void JSONFormatter::print_comma(json_formatter_stack_entry_d& entry)
 {
   if (entry.size) {
     if (m_pretty) {
-      m_ss << ",\n";
-      for (unsigned i = 1; i < m_stack.size(); i++)
-        m_ss << "    ";
+      m_ss += ",\n";
+      print_indent(m_stack.size() - 1);
     } else {
-      m_ss << ",";
+      m_ss += ',';
     }
   } else if (m_pretty) {
-    m_ss << "\n";
-    for (unsigned i = 1; i < m_stack.size(); i++)
-      m_ss << "    ";
+    m_ss += '\n';
+    print_indent(m_stack.size() - 1);
   }
   if (m_pretty && entry.is_array)
-    m_ss << "    ";
+    print_indent(1);
 }
 
 void JSONFormatter::print_quoted_string(std::string_view s)
 {
-  m_ss << '\"' << json_stream_escaper(s) << '\"';
+  m_ss += '\"';
+  escape_json_append(s, m_ss);
+  m_ss += '\"';
 }
 
 void JSONFormatter::print_name(std::string_view name)
@@ -206,13 +219,15 @@ void JSONFormatter::print_name(std::string_view name)
   print_comma(entry);
   if (!entry.is_array) {
     if (m_pretty) {
-      m_ss << "    ";
+      print_indent(1);
     }
-    m_ss << "\"" << name << "\"";
+    m_ss += '\"';
+    m_ss += name;
+    m_ss += '\"';
     if (m_pretty)
-      m_ss << ": ";
+      m_ss += ": ";
     else
-      m_ss << ':';
+      m_ss += ':';
   }
   ++entry.size;
 }
@@ -230,9 +245,9 @@ void JSONFormatter::open_section(std::string_view name, const char *ns, bool is_
     print_name(name);
   }
   if (is_array)
-    m_ss << '[';
+    m_ss += '[';
   else
-    m_ss << '{';
+    m_ss += '{';
 
   json_formatter_stack_entry_d n;
   n.is_array = is_array;
@@ -270,14 +285,13 @@ void JSONFormatter::close_section()
 
   struct json_formatter_stack_entry_d& entry = m_stack.back();
   if (m_pretty && entry.size) {
-    m_ss << "\n";
-    for (unsigned i = 1; i < m_stack.size(); i++)
-      m_ss << "    ";
+    m_ss += '\n';
+    print_indent(m_stack.size() - 1);
   }
-  m_ss << (entry.is_array ? ']' : '}');
+  m_ss += (entry.is_array ? ']' : '}');
   m_stack.pop_back();
   if (m_pretty && m_stack.empty())
-    m_ss << "\n";
+    m_ss += '\n';
 }
 
 void JSONFormatter::finish_pending_string()
@@ -292,10 +306,20 @@ void JSONFormatter::finish_pending_string()
 template <class T>
 void JSONFormatter::add_value(std::string_view name, T val)
 {
-  std::stringstream ss;
-  ss.precision(std::numeric_limits<T>::max_digits10);
-  ss << val;
-  add_value(name, ss.str(), false);
+  char buf[32];
+  auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), val);
+  ceph_assert(ec == std::errc());
+  add_value(name, std::string_view(buf, end - buf), false);
+}
+
+template <>
+void JSONFormatter::add_value(std::string_view name, double val)
+{
+  // same as an ostream with precision(max_digits10)
+  char buf[64];
+  auto end = fmt::format_to_n(buf, sizeof(buf), "{:.{}g}", val,
+			      std::numeric_limits<double>::max_digits10).out;
+  add_value(name, std::string_view(buf, end - buf), false);
 }
 
 void JSONFormatter::add_value(std::string_view name, std::string_view val, bool quoted)
@@ -305,7 +329,7 @@ void JSONFormatter::add_value(std::string_view name, std::string_view val, bool
   }
   print_name(name);
   if (!quoted) {
-    m_ss << val;
+    m_ss += val;
   } else {
     print_quoted_string(val);
   }
@@ -349,12 +373,12 @@ void JSONFormatter::dump_format_va(std::string_view name, const char *ns, bool q
 
 int JSONFormatter::get_len() const
 {
-  return m_ss.str().size();
+  return m_ss.size();
 }
 
 void JSONFormatter::write_raw_data(const char *data)
 {
-  m_ss << data;
+  m_ss += data;
 }
 
 const char *XMLFormatter::XML_1_DTD =
@@ -75,7 +75,7 @@ namespace ceph {
 
     virtual void enable_line_break() = 0;
     virtual void flush(std::ostream& os) = 0;
-    void flush(bufferlist &bl);
+    virtual void flush(bufferlist &bl);
     virtual void reset() = 0;
 
     virtual void set_status(int status, const char* status_name) = 0;
@@ -149,7 +149,7 @@ namespace ceph {
     void output_footer() override {};
     void enable_line_break() override { m_line_break_enabled = true; }
     void flush(std::ostream& os) override;
-    using Formatter::flush; // don't hide Formatter::flush(bufferlist &bl)
+    void flush(bufferlist &bl) override;
     void reset() override;
     void open_array_section(std::string_view name) override;
     void open_array_section_in_ns(std::string_view name, const char *ns) override;
@@ -193,13 +193,16 @@ namespace ceph {
     void print_quoted_string(std::string_view s);
     void print_name(std::string_view name);
     void print_comma(json_formatter_stack_entry_d& entry);
+    void print_indent(unsigned levels);
     void finish_pending_string();
 
     template <class T>
     void add_value(std::string_view name, T val);
     void add_value(std::string_view name, std::string_view val, bool quoted);
 
-    copyable_sstream m_ss;
+    // the output so far; appended to directly, since going through a
+    // stringstream dominated the cost of large dumps
+    std::string m_ss;
     copyable_sstream m_pending_string;
     std::string m_pending_name;
     std::list<json_formatter_stack_entry_d> m_stack;
@@ -221,7 +224,7 @@ namespace ceph {
 
     void enable_line_break() override { m_line_break_enabled = true; }
     void flush(std::ostream& os) override;
-    using Formatter::flush; // don't hide Formatter::flush(bufferlist &bl)
+    void flush(bufferlist &bl) override;
     void reset() override;
     void open_array_section(std::string_view name) override;
     void open_array_section_in_ns(std::string_view name, const char *ns) override;
@@ -11,12 +11,11 @@ Readahead::Readahead()
     m_readahead_min_bytes(0),
     m_readahead_max_bytes(NO_LIMIT),
     m_alignments(),
-    m_nr_consec_read(0),
-    m_consec_read_bytes(0),
-    m_last_pos(0),
-    m_readahead_pos(0),
-    m_readahead_trigger_pos(0),
-    m_readahead_size(0),
+    m_readahead_adaptive_max_bytes(0),
+    m_stride_detection(false),
+    m_streams(1),
+    m_current_stream(0),
+    m_tick(0),
     m_pending(0) {
 }
 
@@ -28,7 +27,8 @@ Readahead::extent_t Readahead::update(const vector<extent_t>& extents, uint64_t
   for (vector<extent_t>::const_iterator p = extents.begin(); p != extents.end(); ++p) {
     _observe_read(p->first, p->second);
   }
-  if (m_readahead_pos >= limit|| m_last_pos >= limit) {
+  auto& stream = m_streams[m_current_stream];
+  if (stream.readahead_pos >= limit || stream.last_pos >= limit) {
     m_lock.unlock();
     return extent_t(0, 0);
   }
@@ -40,7 +40,8 @@ Readahead::extent_t Readahead::update(const vector<extent_t>& extents, uint64_t
 Readahead::extent_t Readahead::update(uint64_t offset, uint64_t length, uint64_t limit) {
   m_lock.lock();
   _observe_read(offset, length);
-  if (m_readahead_pos >= limit || m_last_pos >= limit) {
+  auto& stream = m_streams[m_current_stream];
+  if (stream.readahead_pos >= limit || stream.last_pos >= limit) {
     m_lock.unlock();
     return extent_t(0, 0);
   }
@@ -50,41 +51,83 @@ Readahead::extent_t Readahead::update(uint64_t offset, uint64_t length, uint64_t
 }
 
 void Readahead::_observe_read(uint64_t offset, uint64_t length) {
-  if (offset == m_last_pos) {
-    m_nr_consec_read++;
-    m_consec_read_bytes += length;
+  ++m_tick;
+
+  // continue the stream this read follows on from, if any
+  size_t index = 0;
+  for (; index < m_streams.size(); ++index) {
+    auto& stream = m_streams[index];
+    if (offset == stream.last_pos + stream.stride) {
+      break;
+    }
+  }
+
+  if (index == m_streams.size() && m_stride_detection) {
+    // a stream with a single read may turn out to be strided
+    for (index = 0; index < m_streams.size(); ++index) {
+      auto& stream = m_streams[index];
+      if (stream.last_tick != 0 && stream.nr_consec_read == 0 &&
+	  offset > stream.last_pos && offset - stream.last_pos <= length) {
+	stream.stride = offset - stream.last_pos;
+	break;
+      }
+    }
+  }
+
+  if (index < m_streams.size()) {
+    auto& stream = m_streams[index];
+    stream.nr_consec_read++;
+    stream.consec_read_bytes += length;
   } else {
-    m_nr_consec_read = 0;
-    m_consec_read_bytes = 0;
-    m_readahead_trigger_pos = 0;
-    m_readahead_size = 0;
-    m_readahead_pos = 0;
+    // start a new stream in place of the least recently used one
+    index = 0;
+    for (size_t i = 1; i < m_streams.size(); ++i) {
+      if (m_streams[i].last_tick < m_streams[index].last_tick) {
+	index = i;
+      }
+    }
+    m_streams[index] = Stream();
   }
-  m_last_pos = offset + length;
+
+  auto& stream = m_streams[index];
+  stream.last_pos = offset + length;
+  stream.last_tick = m_tick;
+  m_current_stream = index;
 }
 
 Readahead::extent_t Readahead::_compute_readahead(uint64_t limit) {
+  auto& stream = m_streams[m_current_stream];
   uint64_t readahead_offset = 0;
   uint64_t readahead_length = 0;
-  if (m_nr_consec_read >= m_trigger_requests) {
+  if (stream.nr_consec_read >= m_trigger_requests) {
     // currently reading sequentially
-    if (m_last_pos >= m_readahead_trigger_pos) {
+    if (stream.last_pos >= stream.readahead_trigger_pos) {
       // need to read ahead
-      if (m_readahead_size == 0) {
+      if (stream.readahead_size == 0) {
 	// initial readahead trigger
-	m_readahead_size = m_consec_read_bytes;
-	m_readahead_pos = m_last_pos;
+	stream.readahead_size = stream.consec_read_bytes;
+	stream.readahead_pos = stream.last_pos;
       } else {
 	// continuing readahead trigger
-	m_readahead_size *= 2;
-	if (m_last_pos > m_readahead_pos) {
-	  m_readahead_pos = m_last_pos;
+	stream.readahead_size *= 2;
+	if (stream.last_pos > stream.readahead_pos) {
+	  stream.readahead_pos = stream.last_pos;
 	}
       }
-      m_readahead_size = std::max(m_readahead_size, m_readahead_min_bytes);
-      m_readahead_size = std::min(m_readahead_size, m_readahead_max_bytes);
-      readahead_offset = m_readahead_pos;
-      readahead_length = m_readahead_size;
+
+      // let streams that keep consuming maximum sized readahead grow further
+      uint64_t max_bytes = m_readahead_max_bytes;
+      if (max_bytes > 0 && stream.nr_max_readahead >= 2) {
+	max_bytes = std::max(max_bytes, m_readahead_adaptive_max_bytes);
+      }
+      stream.readahead_size = std::max(stream.readahead_size, m_readahead_min_bytes);
+      stream.readahead_size = std::min(stream.readahead_size, max_bytes);
+      if (m_readahead_max_bytes > 0 &&
+	  stream.readahead_size >= m_readahead_max_bytes) {
+	stream.nr_max_readahead++;
+      }
+      readahead_offset = stream.readahead_pos;
+      readahead_length = stream.readahead_size;
 
       // Snap to the first alignment possible
       uint64_t readahead_end = readahead_offset + readahead_length;
@@ -106,15 +149,15 @@ Readahead::extent_t Readahead::_compute_readahead(uint64_t limit) {
 	  readahead_length = align_next - readahead_offset;
 	  break;
 	}
-	// Note that m_readahead_size should remain unadjusted.
+	// Note that stream.readahead_size should remain unadjusted.
       }
 
-      if (m_readahead_pos + readahead_length > limit) {
-	readahead_length = limit - m_readahead_pos;
+      if (stream.readahead_pos + readahead_length > limit) {
+	readahead_length = limit - stream.readahead_pos;
       }
 
-      m_readahead_trigger_pos = m_readahead_pos + readahead_length / 2;
-      m_readahead_pos += readahead_length;
+      stream.readahead_trigger_pos = stream.readahead_pos + readahead_length / 2;
+      stream.readahead_pos += readahead_length;
     }
   }
   return extent_t(readahead_offset, readahead_length);
@@ -194,3 +237,23 @@ void Readahead::set_alignments(const vector<uint64_t> &alignments) {
   m_alignments = alignments;
   m_lock.unlock();
 }
+
+void Readahead::set_max_streams(size_t max_streams) {
+  ceph_assert(max_streams > 0);
+  m_lock.lock();
+  m_streams.assign(max_streams, Stream());
+  m_current_stream = 0;
+  m_lock.unlock();
+}
+
+void Readahead::set_stride_detection(bool enabled) {
+  m_lock.lock();
+  m_stride_detection = enabled;
+  m_lock.unlock();
+}
+
+void Readahead::set_adaptive_max_readahead_size(uint64_t adaptive_max_readahead_size) {
+  m_lock.lock();
+  m_readahead_adaptive_max_bytes = adaptive_max_readahead_size;
+  m_lock.unlock();
+}
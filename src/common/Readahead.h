@@ -108,7 +108,57 @@ public:
    */
   void set_alignments(const std::vector<uint64_t> &alignments);
 
+  /**
+     Sets the number of concurrent read streams that are tracked.
+     A read that does not continue any tracked stream starts a new one,
+     replacing the least recently used stream.  Resets all streams.
+   */
+  void set_max_streams(size_t max_streams);
+
+  /**
+     Enables detection of strided streams, where each read skips a fixed
+     gap past the end of the previous read.  Only gaps no larger than the
+     read itself are considered, since the readahead also covers the gaps.
+   */
+  void set_stride_detection(bool enabled);
+
+  /**
+     Sets the size, in bytes, up to which the readahead of a stream may grow
+     beyond the maximum readahead size once the stream has consistently been
+     reading ahead at the maximum size.  Zero disables the adaptive growth.
+   */
+  void set_adaptive_max_readahead_size(uint64_t adaptive_max_readahead_size);
+
 private:
+  struct Stream {
+    /// Number of consecutive read requests in the stream
+    int nr_consec_read = 0;
+
+    /// Number of bytes read in the stream
+    uint64_t consec_read_bytes = 0;
+
+    /// Position of the read stream
+    uint64_t last_pos = 0;
+
+    /// Gap between the end of a read and the start of the next one
+    uint64_t stride = 0;
+
+    /// Position of the readahead stream
+    uint64_t readahead_pos = 0;
+
+    /// When readahead is already triggered and the read stream crosses this point, readahead is continued
+    uint64_t readahead_trigger_pos = 0;
+
+    /// Size of the next readahead request (barring changes due to alignment, etc.)
+    uint64_t readahead_size = 0;
+
+    /// Number of readahead requests issued at (or above) the maximum size
+    uint64_t nr_max_readahead = 0;
+
+    /// Value of m_tick when the stream was last read
+    uint64_t last_tick = 0;
+  };
+
   /**
      Records that a read request has been received.
      m_lock must be held while calling.
@@ -136,23 +186,20 @@ private:
   /// Held while reading/modifying any state except m_pending
   ceph::mutex m_lock = ceph::make_mutex("Readahead::m_lock");
 
-  /// Number of consecutive read requests in the current sequential stream
-  int m_nr_consec_read;
-
-  /// Number of bytes read in the current sequenial stream
-  uint64_t m_consec_read_bytes;
+  /// Maximum readahead size for streams that keep reading ahead at the maximum
+  uint64_t m_readahead_adaptive_max_bytes;
 
-  /// Position of the read stream
-  uint64_t m_last_pos;
+  /// Whether a new stream may latch on to a fixed gap between reads
+  bool m_stride_detection;
 
-  /// Position of the readahead stream
-  uint64_t m_readahead_pos;
+  /// Tracked read streams, bounded by set_max_streams()
+  std::vector<Stream> m_streams;
 
-  /// When readahead is already triggered and the read stream crosses this point, readahead is continued
-  uint64_t m_readahead_trigger_pos;
+  /// Stream that observed the most recent read
+  size_t m_current_stream;
 
-  /// Size of the next readahead request (barring changes due to alignment, etc.)
-  uint64_t m_readahead_size;
+  /// Incremented on every observed read, used to find the LRU stream
+  uint64_t m_tick;
 
   /// Number of pending readahead requests, as determined by inc_pending() and dec_pending()
   int m_pending;
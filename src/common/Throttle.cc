@@ -90,23 +90,43 @@ void Throttle::_reset_max(int64_t m)
   max = m;
 }
 
-bool Throttle::_wait(int64_t c, std::unique_lock<std::mutex>& l)
+bool Throttle::_try_take(int64_t c)
+{
+  int64_t cur = count;
+  while (!_should_wait(cur, c)) {
+    if (count.compare_exchange_weak(cur, cur + c)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Throttle::_wait(int64_t c, std::unique_lock<std::mutex>& l, bool take)
 {
   mono_time start;
   bool waited = false;
-  if (_should_wait(c) || !conds.empty()) { // always wait behind other waiters.
+  // when taking, check and add in one step: _get_fast() may add to count
+  // without the lock, so a separate check under the lock is not enough
+  auto ready = [this, c, take]() {
+    return take ? _try_take(c) : !_should_wait(c);
+  };
+  if (!conds.empty() || !ready()) { // always wait behind other waiters.
     {
       auto cv = conds.emplace(conds.end());
+      // must be visible before we check count again in cv->wait(); pairs
+      // with the check of waiters after the decrement in put()
+      ++waiters;
       auto w = make_scope_guard([this, cv]() {
 	  conds.erase(cv);
+	  --waiters;
 	});
       waited = true;
       ldout(cct, 2) << "_wait waiting..." << dendl;
       if (logger)
 	start = mono_clock::now();
 
-      cv->wait(l, [this, c, cv]() { return (!_should_wait(c) &&
-					    cv == conds.begin()); });
+      cv->wait(l, [this, cv, &ready]() { return (cv == conds.begin() &&
+						 ready()); });
       ldout(cct, 2) << "_wait finished waiting" << dendl;
       if (logger) {
 	logger->tinc(l_throttle_wait, mono_clock::now() - start);
@@ -131,7 +151,7 @@ bool Throttle::wait(int64_t m)
     _reset_max(m);
   }
   ldout(cct, 10) << "wait" << dendl;
-  return _wait(0, l);
+  return _wait(0, l, false);
 }
 
 int64_t Throttle::take(int64_t c)
@@ -150,6 +170,11 @@ int64_t Throttle::take(int64_t c)
   return count;
 }
 
+bool Throttle::_get_fast(int64_t c)
+{
+  return !waiters && _try_take(c);
+}
+
 bool Throttle::get(int64_t c, int64_t m)
 {
   if (0 == max && 0 == m) {
@@ -163,14 +188,13 @@ bool Throttle::get(int64_t c, int64_t m)
     logger->inc(l_throttle_get_started);
   }
   bool waited = false;
-  {
+  if (m || !_get_fast(c)) {
     std::unique_lock l(lock);
     if (m) {
       ceph_assert(m > 0);
       _reset_max(m);
     }
-    waited = _wait(c, l);
-    count += c;
+    waited = _wait(c, l, true);
   }
   if (logger) {
     logger->inc(l_throttle_get);
@@ -191,18 +215,12 @@ bool Throttle::get_or_fail(int64_t c)
   }
 
   assert (c >= 0);
-  bool result = false;
-  {
-    std::lock_guard l(lock);
-    if (_should_wait(c) || !conds.empty()) {
-      ldout(cct, 10) << "get_or_fail " << c << " failed" << dendl;
-      result = false;
-    } else {
-      ldout(cct, 10) << "get_or_fail " << c << " success (" << count.load()
-	<< " -> " << (count.load() + c) << ")" << dendl;
-      count += c;
-      result = true;
-    }
+  bool result = _get_fast(c);
+  if (result) {
+    ldout(cct, 10) << "get_or_fail " << c << " success (" << count.load() - c
+		   << " -> " << count.load() << ")" << dendl;
+  } else {
+    ldout(cct, 10) << "get_or_fail " << c << " failed" << dendl;
   }
 
   if (logger) {
@@ -228,16 +246,15 @@ int64_t Throttle::put(int64_t c)
   ceph_assert(c >= 0);
   ldout(cct, 10) << "put " << c << " (" << count.load() << " -> "
 		 << (count.load()-c) << ")" << dendl;
-  int64_t new_count;
-  {
-    std::lock_guard l(lock);
-    new_count = count;
-    if (c) {
+  int64_t new_count = count;
+  if (c) {
+    new_count = count -= c;
+    // if count goes negative, we failed somewhere!
+    ceph_assert(new_count >= 0);
+    if (waiters) {
+      std::lock_guard l(lock);
       if (!conds.empty())
 	conds.front().notify_one();
-      // if count goes negative, we failed somewhere!
-      ceph_assert(count >= c);
-      new_count = count -= c;
     }
   }
   if (logger) {
@@ -36,6 +36,9 @@ class Throttle final : public ThrottleInterface {
   std::atomic<int64_t> count = { 0 }, max = { 0 };
   std::mutex lock;
   std::list<std::condition_variable> conds;
+  /// conds.size(), readable without the lock so that get() and put()
+  /// can skip it when nobody waits
+  std::atomic<int64_t> waiters = { 0 };
   const bool use_perf;
 
 public:
@@ -44,16 +47,22 @@ public:
 
 private:
   void _reset_max(int64_t m);
-  bool _should_wait(int64_t c) const {
+  bool _should_wait(int64_t cur, int64_t c) const {
     int64_t m = max;
-    int64_t cur = count;
     return
       m &&
       ((c <= m && cur + c > m) || // normally stay under max
        (c >= m && cur > m));     // except for large c
   }
+  bool _should_wait(int64_t c) const {
+    return _should_wait(count, c);
+  }
 
-  bool _wait(int64_t c, std::unique_lock<std::mutex>& l);
+  /// add c to count unless that would have to wait
+  bool _try_take(int64_t c);
+  /// wait until c fits under max; if take, also add c to count
+  bool _wait(int64_t c, std::unique_lock<std::mutex>& l, bool take);
+  bool _get_fast(int64_t c);
 
 public:
   /**
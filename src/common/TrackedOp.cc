@@ -233,6 +233,22 @@ bool OpTracker::dump_historic_slow_ops(Formatter *f, set<string> filters)
   return true;
 }
 
+uint64_t OpTracker::get_num_ops_in_flight()
+{
+  if (!tracking_enabled)
+    return 0;
+
+  std::shared_lock l{lock};
+  uint64_t total_ops_in_flight = 0;
+  for (uint32_t i = 0; i < num_optracker_shards; i++) {
+    ShardedTrackingData* sdata = sharded_in_flight_list[i];
+    ceph_assert(NULL != sdata);
+    std::lock_guard locker(sdata->ops_in_flight_lock_sharded);
+    total_ops_in_flight += sdata->ops_in_flight_sharded.size();
+  }
+  return total_ops_in_flight;
+}
+
 bool OpTracker::dump_ops_in_flight(Formatter *f, bool print_only_blocked, set<string> filters, bool count_only)
 {
   if (!tracking_enabled)
@@ -295,6 +311,8 @@ bool OpTracker::register_inflight_op(TrackedOp *i)
     std::lock_guard locker(sdata->ops_in_flight_lock_sharded);
     sdata->ops_in_flight_sharded.push_back(*i);
     i->seq = current_seq;
+    uint32_t rate = sample_rate;
+    i->sampled = rate <= 1 || current_seq % rate == 0;
   }
   return true;
 }
@@ -314,6 +332,14 @@ void OpTracker::unregister_inflight_op(TrackedOp* const i)
   }
 }
 
+bool OpTracker::wants_history(const TrackedOp& i) const
+{
+  if (i.sampled) {
+    return true;
+  }
+  return i.get_duration() >= history.get_slow_op_threshold();
+}
+
 void OpTracker::record_history_op(TrackedOpRef&& i)
 {
   std::shared_lock l{lock};
@@ -486,7 +512,18 @@ void TrackedOp::mark_event(std::string_view event, utime_t stamp)
 
   {
     std::lock_guard l(lock);
-    events.emplace_back(stamp, event);
+    if (!sampled &&
+	stamp - initiated_at >= tracker->get_slow_op_threshold()) {
+      // a slow op keeps all of its events from here on
+      sampled = true;
+    }
+    if (sampled || events.size() < 2) {
+      events.emplace_back(stamp, event);
+    } else {
+      // keep "initiated" and the latest event, reusing its string
+      events.back().stamp = stamp;
+      events.back().str.assign(event);
+    }
   }
   dout(6) << " seq: " << seq
 	  << ", time: " << stamp
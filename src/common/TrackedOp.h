@@ -114,6 +114,9 @@ public:
     history_slow_op_size = new_size;
     history_slow_op_threshold = new_threshold;
   }
+  uint32_t get_slow_op_threshold() const {
+    return history_slow_op_threshold;
+  }
 };
 
 struct ShardedTrackingData;
@@ -126,6 +129,7 @@ class OpTracker {
   float complaint_time;
   int log_threshold;
   std::atomic<bool> tracking_enabled;
+  std::atomic<uint32_t> sample_rate = {1};
   ceph::shared_mutex lock = ceph::make_shared_mutex("OpTracker::lock");
 
 public:
@@ -148,11 +152,22 @@ public:
   void set_tracking(bool enable) {
     tracking_enabled = enable;
   }
+  /// record every event of one op in n, and of every slow op; the others
+  /// only keep their latest event, and only go to the history if slow
+  void set_sample_rate(uint32_t n) {
+    sample_rate = n;
+  }
+  uint32_t get_slow_op_threshold() const {
+    return history.get_slow_op_threshold();
+  }
   bool dump_ops_in_flight(ceph::Formatter *f, bool print_only_blocked = false, std::set<std::string> filters = {""}, bool count_only = false);
+  /// the number of ops currently tracked (0 if tracking is disabled)
+  uint64_t get_num_ops_in_flight();
   bool dump_historic_ops(ceph::Formatter *f, bool by_duration = false, std::set<std::string> filters = {""});
   bool dump_historic_slow_ops(ceph::Formatter *f, std::set<std::string> filters = {""});
   bool register_inflight_op(TrackedOp *i);
   void unregister_inflight_op(TrackedOp *i);
+  bool wants_history(const TrackedOp& i) const;
   void record_history_op(TrackedOpRef&& i);
 
   void get_age_ms_histogram(pow2_hist_t *h);
@@ -268,6 +283,7 @@ protected:
   std::vector<Event> events;    ///< std::list of events and their times
   mutable ceph::mutex lock = ceph::make_mutex("TrackedOp::lock"); ///< to protect the events list
   uint64_t seq = 0;        ///< a unique value std::set by the OpTracker
+  bool sampled = true;     ///< keeps every event, not just the latest; protected by lock
 
   uint32_t warn_interval_multiplier = 1; //< limits output of a given op warning
 
@@ -285,9 +301,7 @@ protected:
   TrackedOp(OpTracker *_tracker, const utime_t& initiated) :
     tracker(_tracker),
     initiated_at(initiated)
-  {
-    events.reserve(OPTRACKER_PREALLOC_EVENTS);
-  }
+  {}
 
   /// output any type-specific data you want to get when dump() is called
   virtual void _dump(ceph::Formatter *f) const {}
@@ -325,7 +339,7 @@ public:
 	mark_event("done");
 	tracker->unregister_inflight_op(this);
 	_unregistered();
-	if (!tracker->is_tracking()) {
+	if (!tracker->is_tracking() || !tracker->wants_history(*this)) {
 	  delete this;
 	} else {
 	  state = TrackedOp::STATE_HISTORY;
@@ -393,6 +407,7 @@ public:
 
   void tracking_start() {
     if (tracker->register_inflight_op(this)) {
+      events.reserve(sampled ? OPTRACKER_PREALLOC_EVENTS : 2);
       events.emplace_back(initiated_at, "initiated");
       state = STATE_LIVE;
     }
@@ -178,6 +178,9 @@ public:
   void set_crc_enabled(bool enabled) {
     m_crc_enabled = enabled;
   }
+  bool is_crc_enabled() const {
+    return m_crc_enabled;
+  }
   void clear();
 
   void resize(uint64_t elements);
@@ -143,3 +143,125 @@ void compressible_bloom_filter::generate_test_instances(std::list<compressible_b
   ls.back()->compress(20);
   ls.back()->insert("boogggg");
 }
+
+
+blocked_bloom_filter::blocked_bloom_filter(
+  std::size_t predicted_inserted_element_count,
+  double false_positive_probability,
+  uint64_t random_seed)
+  : target_element_count_(predicted_inserted_element_count),
+    random_seed_(random_seed)
+{
+  ceph_assert(false_positive_probability > 0.0);
+  // bits per insert for the target fpp with one probe per word, plus
+  // 10% for the uneven load across blocks
+  double bits = -(double)words_per_block * predicted_inserted_element_count /
+    std::log(1.0 - std::pow(false_positive_probability,
+			    1.0 / words_per_block)) * 1.1;
+  allocate(std::max<std::size_t>(
+	     1, std::ceil(bits / (words_per_block * 64))));
+}
+
+void blocked_bloom_filter::allocate(std::size_t block_count)
+{
+  // the allocator only aligns to 16 bytes; over-allocate and start the
+  // blocks at the first cache line boundary
+  block_count_ = block_count;
+  std::size_t words = block_count * words_per_block;
+  table_.assign(words ? words + words_per_block - 1 : 0, 0);
+  auto addr = reinterpret_cast<uintptr_t>(table_.data());
+  offset_ = ((64 - (addr & 63)) & 63) / sizeof(uint64_t);
+}
+
+blocked_bloom_filter& blocked_bloom_filter::operator=(
+  const blocked_bloom_filter& o)
+{
+  if (this != &o) {
+    allocate(o.block_count_);
+    std::copy_n(o.table_.begin() + o.offset_,
+		block_count_ * words_per_block,
+		table_.begin() + offset_);
+    insert_count_ = o.insert_count_;
+    target_element_count_ = o.target_element_count_;
+    random_seed_ = o.random_seed_;
+  }
+  return *this;
+}
+
+double blocked_bloom_filter::density() const
+{
+  if (!block_count_) {
+    return 0;
+  }
+  unsigned set = std::accumulate(
+    table_.begin() + offset_,
+    table_.begin() + offset_ + block_count_ * words_per_block,
+    0u, [](unsigned set, uint64_t word) {
+      return set + std::popcount(word);
+    });
+  return (double)set / size();
+}
+
+double blocked_bloom_filter::approx_unique_element_count() const
+{
+  // each insert sets words_per_block bits at random
+  double d = density();
+  if (d >= 1.0) {
+    return insert_count_;
+  }
+  return -(double)size() / words_per_block * std::log(1.0 - d);
+}
+
+void blocked_bloom_filter::encode(bufferlist& bl) const
+{
+  ENCODE_START(1, 1, bl);
+  encode((uint64_t)insert_count_, bl);
+  encode((uint64_t)target_element_count_, bl);
+  encode(random_seed_, bl);
+  encode((uint64_t)block_count_, bl);
+  for (std::size_t i = 0; i < block_count_ * words_per_block; ++i) {
+    encode(table_[offset_ + i], bl);
+  }
+  ENCODE_FINISH(bl);
+}
+
+void blocked_bloom_filter::decode(bufferlist::const_iterator& p)
+{
+  DECODE_START(1, p);
+  uint64_t v;
+  decode(v, p);
+  insert_count_ = v;
+  decode(v, p);
+  target_element_count_ = v;
+  decode(random_seed_, p);
+  decode(v, p);
+  allocate(v);
+  for (std::size_t i = 0; i < block_count_ * words_per_block; ++i) {
+    decode(table_[offset_ + i], p);
+  }
+  DECODE_FINISH(p);
+}
+
+void blocked_bloom_filter::dump(Formatter *f) const
+{
+  f->dump_unsigned("block_count", block_count_);
+  f->dump_unsigned("insert_count", insert_count_);
+  f->dump_unsigned("target_element_count", target_element_count_);
+  f->dump_unsigned("random_seed", random_seed_);
+  f->dump_float("density", density());
+}
+
+void blocked_bloom_filter::generate_test_instances(
+  std::list<blocked_bloom_filter*>& ls)
+{
+  ls.push_back(new blocked_bloom_filter);
+  ls.push_back(new blocked_bloom_filter(10, .5, 1));
+  ls.back()->insert("foo");
+  ls.back()->insert("bar");
+  ls.push_back(new blocked_bloom_filter(50, .01, 1));
+  ls.back()->insert("foo");
+  ls.back()->insert("bar");
+  ls.back()->insert("baz");
+  ls.back()->insert("boof");
+  ls.back()->insert("boogggg");
+}
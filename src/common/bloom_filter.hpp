@@ -23,7 +23,10 @@
 #define COMMON_BLOOM_FILTER_HPP
 
 #include <cmath>
+#include <string_view>
+#include <utility>
 
+#include "include/ceph_hash.h"
 #include "include/encoding.h"
 #include "include/mempool.h"
 
@@ -569,6 +572,129 @@ public:
 };
 WRITE_CLASS_ENCODER(compressible_bloom_filter)
 
+
+/**
+ * A bloom filter whose probes for a key all fall in one 64-byte block,
+ * so that a lookup touches a single cache line instead of one line per
+ * hash.  A key sets one bit in each of the block's eight 64-bit words;
+ * contains() tests all eight without branching, which compilers turn
+ * into a few vector instructions.  For the same false positive
+ * probability it needs about 10% more bits than bloom_filter.
+ */
+class blocked_bloom_filter
+{
+  static constexpr std::size_t words_per_block = 8;
+  using table_type = mempool::bloom_filter::vector<uint64_t>;
+
+  table_type  table_;          ///< blocks, plus slack to align the first
+  std::size_t offset_ = 0;     ///< index in table_ of the first block
+  std::size_t block_count_ = 0;
+  std::size_t insert_count_ = 0;
+  std::size_t target_element_count_ = 0;
+  uint64_t    random_seed_ = 0;
+
+public:
+  blocked_bloom_filter() {}
+  blocked_bloom_filter(std::size_t predicted_inserted_element_count,
+		       double false_positive_probability,
+		       uint64_t random_seed);
+  blocked_bloom_filter(const blocked_bloom_filter& o) {
+    *this = o;
+  }
+  blocked_bloom_filter& operator=(const blocked_bloom_filter& o);
+
+  bool operator!() const {
+    return block_count_ == 0;
+  }
+
+  void clear() {
+    std::fill(table_.begin(), table_.end(), 0);
+    insert_count_ = 0;
+  }
+
+  /**
+   * insert a u32 into the set
+   *
+   * The value is mixed with the seed before use, so consecutive values
+   * are fine here.
+   */
+  void insert(uint32_t val) {
+    uint64_t h = hash(val);
+    uint64_t *b = block(h);
+    for (std::size_t i = 0; i < words_per_block; ++i) {
+      b[i] |= probe(h, i);
+    }
+    ++insert_count_;
+  }
+  void insert(std::string_view key) {
+    insert(ceph_str_hash_rjenkins(key.data(), key.size()));
+  }
+
+  /// @returns true if val is (probably) in the set, false if it definitely is not
+  bool contains(uint32_t val) const {
+    if (block_count_ == 0) {
+      return false;
+    }
+    uint64_t h = hash(val);
+    const uint64_t *b = block(h);
+    uint64_t missing = 0;
+    for (std::size_t i = 0; i < words_per_block; ++i) {
+      missing |= probe(h, i) & ~b[i];
+    }
+    return missing == 0;
+  }
+  bool contains(std::string_view key) const {
+    return contains(ceph_str_hash_rjenkins(key.data(), key.size()));
+  }
+
+  /// size in bits
+  std::size_t size() const {
+    return block_count_ * words_per_block * 64;
+  }
+  std::size_t element_count() const {
+    return insert_count_;
+  }
+  bool is_full() const {
+    return insert_count_ >= target_element_count_;
+  }
+
+  /// fraction of bits set
+  double density() const;
+  double approx_unique_element_count() const;
+
+private:
+  // splitmix64's finalizer: the upper half picks the block, the lower
+  // half the bits
+  uint64_t hash(uint32_t val) const {
+    uint64_t x = val + random_seed_ * 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+  }
+  static uint64_t probe(uint64_t h, std::size_t i) {
+    static constexpr uint32_t salt[words_per_block] = {
+      0x47b6137b, 0x44974d91, 0x8824ad5b, 0xa2b7289d,
+      0x705495c7, 0x2df1424b, 0x9efc4947, 0x5c6bfb31
+    };
+    return 1ull << ((static_cast<uint32_t>(h) * salt[i]) >> 26);
+  }
+  const uint64_t *block(uint64_t h) const {
+    std::size_t i = ((h >> 32) * block_count_) >> 32;
+    return table_.data() + offset_ + i * words_per_block;
+  }
+  uint64_t *block(uint64_t h) {
+    return const_cast<uint64_t*>(std::as_const(*this).block(h));
+  }
+  void allocate(std::size_t block_count);
+
+public:
+  void encode(ceph::buffer::list& bl) const;
+  void decode(ceph::buffer::list::const_iterator& bl);
+  void dump(ceph::Formatter *f) const;
+  static void generate_test_instances(std::list<blocked_bloom_filter*>& ls);
+};
+WRITE_CLASS_ENCODER(blocked_bloom_filter)
+
 #endif
 
 
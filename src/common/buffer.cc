@@ -2181,6 +2181,76 @@ buffer::list buffer::list::static_from_string(string& s) {
 #define BUF_OFFSETOF(type, field)					\
   (reinterpret_cast<std::uintptr_t>(&(((type*)1024)->field)) - 1024u)
 
+namespace {
+// Per-thread free list of ptr_node-sized blocks. The state is trivially
+// destructible so that nodes freed by other thread_local destructors
+// after the reaper below has run still see a valid (disabled) cache.
+struct ptr_node_cache_t {
+  static constexpr unsigned max_cached = 1024;
+  void* head;
+  unsigned count;
+  bool disabled;
+  uint64_t heap_allocs;
+  uint64_t cached_allocs;
+};
+thread_local ptr_node_cache_t ptr_node_cache;
+
+struct ptr_node_cache_reaper_t {
+  bool armed = false;
+  ~ptr_node_cache_reaper_t() {
+    ptr_node_cache.disabled = true;
+    while (ptr_node_cache.head) {
+      void* next = *static_cast<void**>(ptr_node_cache.head);
+      ::operator delete(ptr_node_cache.head);
+      ptr_node_cache.head = next;
+    }
+    ptr_node_cache.count = 0;
+  }
+};
+thread_local ptr_node_cache_reaper_t ptr_node_cache_reaper;
+}
+
+void* buffer::ptr_node::operator new(size_t size)
+{
+  auto& cache = ptr_node_cache;
+  if (size == sizeof(ptr_node) && cache.head) {
+    void* p = cache.head;
+    cache.head = *static_cast<void**>(p);
+    --cache.count;
+    ++cache.cached_allocs;
+    return p;
+  }
+  ++cache.heap_allocs;
+  return ::operator new(size);
+}
+
+void buffer::ptr_node::operator delete(void* p, size_t size) noexcept
+{
+  auto& cache = ptr_node_cache;
+  if (size == sizeof(ptr_node) && !cache.disabled &&
+      cache.count < ptr_node_cache_t::max_cached) {
+    if (!ptr_node_cache_reaper.armed) {
+      // first use on this thread registers the reaper's destructor
+      ptr_node_cache_reaper.armed = true;
+    }
+    *static_cast<void**>(p) = cache.head;
+    cache.head = p;
+    ++cache.count;
+    return;
+  }
+  ::operator delete(p);
+}
+
+uint64_t buffer::get_ptr_node_heap_allocs()
+{
+  return ptr_node_cache.heap_allocs;
+}
+
+uint64_t buffer::get_ptr_node_cached_allocs()
+{
+  return ptr_node_cache.cached_allocs;
+}
+
 bool buffer::ptr_node::dispose_if_hypercombined(
   buffer::ptr_node* const delete_this)
 {
@@ -152,10 +152,12 @@ public:
   explicit MempoolObs(CephContext *cct)
     : cct(cct), lock(ceph::make_mutex("mem_pool_obs")) {
     cct->_conf.add_observer(this);
+    mempool::set_profile_rate(
+      cct->_conf.get_val<uint64_t>("mempool_profile_rate"));
     int r = cct->get_admin_socket()->register_command(
-      "dump_mempools",
+      "dump_mempools name=profile,type=CephBool,req=false",
       this,
-      "get mempool stats");
+      "get mempool stats, and optionally the allocation profile");
     ceph_assert(r == 0);
   }
   ~MempoolObs() override {
@@ -167,6 +169,7 @@ public:
   const char** get_tracked_conf_keys() const override {
     static const char *KEYS[] = {
       "mempool_debug",
+      "mempool_profile_rate",
       NULL
     };
     return KEYS;
@@ -178,6 +181,10 @@ public:
     if (changed.count("mempool_debug")) {
       mempool::set_debug_mode(cct->_conf->mempool_debug);
     }
+    if (changed.count("mempool_profile_rate")) {
+      mempool::set_profile_rate(
+	cct->_conf.get_val<uint64_t>("mempool_profile_rate"));
+    }
   }
 
   // AdminSocketHook
@@ -187,8 +194,13 @@ public:
 	   std::ostream& errss,
 	   bufferlist& out) override {
     if (command == "dump_mempools") {
+      bool profile = false;
+      cmd_getval(cmdmap, "profile", profile);
       f->open_object_section("mempools");
       mempool::dump(f);
+      if (profile) {
+	mempool::dump_profile(f);
+      }
       f->close_section();
       return 0;
     }
@@ -283,6 +295,7 @@ public:
       "log_file",
       "log_max_new",
       "log_max_recent",
+      "log_thread_buffer_size",
       "log_to_file",
       "log_to_syslog",
       "err_to_syslog",
@@ -342,6 +355,11 @@ public:
       log->set_max_recent(conf->log_max_recent);
     }
 
+    if (changed.count("log_thread_buffer_size")) {
+      log->set_thread_buffer_size(
+	conf.get_val<uint64_t>("log_thread_buffer_size"));
+    }
+
     // graylog
     if (changed.count("log_to_graylog") || changed.count("err_to_graylog")) {
       int l = conf->log_to_graylog ? 99 : (conf->err_to_graylog ? -1 : -2);
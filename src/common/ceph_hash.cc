@@ -1,6 +1,8 @@
 
 #include "include/types.h"
 
+#include <string.h>
+
 /*
  * Robert Jenkin's hash function.
  * http://burtleburtle.net/bob/hash/evahash.html
@@ -77,6 +79,193 @@ unsigned ceph_str_hash_rjenkins(const char *str, unsigned length)
 	return c;
 }
 
+/*
+ * batch rjenkins: hash several names side by side in vector lanes.
+ * each lane runs the scalar steps above, one 12-byte block per round,
+ * then a round for the tail and length.  lanes whose name has fewer
+ * blocks add nothing and keep their state once they are done, so the
+ * results are bit-identical to ceph_str_hash_rjenkins().
+ */
+static inline __u32 rjenkins_le32(const unsigned char *k)
+{
+	return k[0] + ((__u32)k[1] << 8) + ((__u32)k[2] << 16) +
+		((__u32)k[3] << 24);
+}
+
+/*
+ * what a name adds to a, b and c in the given round.  returns false if
+ * the name was finished in an earlier round.
+ */
+static bool rjenkins_round(const char *str, unsigned length, unsigned round,
+			   __u32 *wa, __u32 *wb, __u32 *wc)
+{
+	unsigned nblocks = length / 12;
+	const unsigned char *k = (const unsigned char *)str + round * 12;
+	unsigned char tail[12] = {0};
+
+	if (round > nblocks) {
+		*wa = *wb = *wc = 0;
+		return false;
+	}
+	if (round < nblocks) {
+		*wa = rjenkins_le32(k);
+		*wb = rjenkins_le32(k + 4);
+		*wc = rjenkins_le32(k + 8);
+		return true;
+	}
+	/* the first byte of c is reserved for the length */
+	memcpy(tail, k, length - nblocks * 12);
+	*wa = rjenkins_le32(tail);
+	*wb = rjenkins_le32(tail + 4);
+	*wc = length + (rjenkins_le32(tail + 8) << 8);
+	return true;
+}
+
+static unsigned rjenkins_rounds(const unsigned *lens, unsigned lanes)
+{
+	unsigned rounds = 0, l;
+	for (l = 0; l < lanes; l++)
+		if (lens[l] / 12 + 1 > rounds)
+			rounds = lens[l] / 12 + 1;
+	return rounds;
+}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define CEPH_HASH_HAVE_AVX2 1
+
+#define mix_avx2(a, b, c)						\
+	do {								\
+		a = _mm256_sub_epi32(_mm256_sub_epi32(a, b), c);	\
+		a = _mm256_xor_si256(a, _mm256_srli_epi32(c, 13));	\
+		b = _mm256_sub_epi32(_mm256_sub_epi32(b, c), a);	\
+		b = _mm256_xor_si256(b, _mm256_slli_epi32(a, 8));	\
+		c = _mm256_sub_epi32(_mm256_sub_epi32(c, a), b);	\
+		c = _mm256_xor_si256(c, _mm256_srli_epi32(b, 13));	\
+		a = _mm256_sub_epi32(_mm256_sub_epi32(a, b), c);	\
+		a = _mm256_xor_si256(a, _mm256_srli_epi32(c, 12));	\
+		b = _mm256_sub_epi32(_mm256_sub_epi32(b, c), a);	\
+		b = _mm256_xor_si256(b, _mm256_slli_epi32(a, 16));	\
+		c = _mm256_sub_epi32(_mm256_sub_epi32(c, a), b);	\
+		c = _mm256_xor_si256(c, _mm256_srli_epi32(b, 5));	\
+		a = _mm256_sub_epi32(_mm256_sub_epi32(a, b), c);	\
+		a = _mm256_xor_si256(a, _mm256_srli_epi32(c, 3));	\
+		b = _mm256_sub_epi32(_mm256_sub_epi32(b, c), a);	\
+		b = _mm256_xor_si256(b, _mm256_slli_epi32(a, 10));	\
+		c = _mm256_sub_epi32(_mm256_sub_epi32(c, a), b);	\
+		c = _mm256_xor_si256(c, _mm256_srli_epi32(b, 15));	\
+	} while (0)
+
+__attribute__((target("avx2")))
+static unsigned ceph_str_hash_rjenkins_avx2(const char * const *strs,
+					    const unsigned *lens,
+					    unsigned n, unsigned *out)
+{
+	unsigned i, r, l;
+	for (i = 0; i + 8 <= n; i += 8) {
+		unsigned rounds = rjenkins_rounds(lens + i, 8);
+		__m256i a = _mm256_set1_epi32(0x9e3779b9);
+		__m256i b = a;
+		__m256i c = _mm256_setzero_si256();
+		for (r = 0; r < rounds; r++) {
+			__u32 wa[8], wb[8], wc[8], live[8];
+			for (l = 0; l < 8; l++)
+				live[l] = rjenkins_round(strs[i + l], lens[i + l], r,
+							 &wa[l], &wb[l], &wc[l]) ? ~0u : 0;
+			__m256i m = _mm256_loadu_si256((const __m256i *)live);
+			__m256i na = _mm256_add_epi32(a, _mm256_loadu_si256((const __m256i *)wa));
+			__m256i nb = _mm256_add_epi32(b, _mm256_loadu_si256((const __m256i *)wb));
+			__m256i nc = _mm256_add_epi32(c, _mm256_loadu_si256((const __m256i *)wc));
+			mix_avx2(na, nb, nc);
+			a = _mm256_blendv_epi8(a, na, m);
+			b = _mm256_blendv_epi8(b, nb, m);
+			c = _mm256_blendv_epi8(c, nc, m);
+		}
+		_mm256_storeu_si256((__m256i *)(out + i), c);
+	}
+	return i;
+}
+
+static int ceph_hash_avx2_supported(void)
+{
+	static int supported = -1;
+	if (supported < 0)
+		supported = __builtin_cpu_supports("avx2") ? 1 : 0;
+	return supported;
+}
+#endif
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define CEPH_HASH_HAVE_NEON 1
+
+#define mix_neon(a, b, c)						\
+	do {								\
+		a = vsubq_u32(vsubq_u32(a, b), c);			\
+		a = veorq_u32(a, vshrq_n_u32(c, 13));			\
+		b = vsubq_u32(vsubq_u32(b, c), a);			\
+		b = veorq_u32(b, vshlq_n_u32(a, 8));			\
+		c = vsubq_u32(vsubq_u32(c, a), b);			\
+		c = veorq_u32(c, vshrq_n_u32(b, 13));			\
+		a = vsubq_u32(vsubq_u32(a, b), c);			\
+		a = veorq_u32(a, vshrq_n_u32(c, 12));			\
+		b = vsubq_u32(vsubq_u32(b, c), a);			\
+		b = veorq_u32(b, vshlq_n_u32(a, 16));			\
+		c = vsubq_u32(vsubq_u32(c, a), b);			\
+		c = veorq_u32(c, vshrq_n_u32(b, 5));			\
+		a = vsubq_u32(vsubq_u32(a, b), c);			\
+		a = veorq_u32(a, vshrq_n_u32(c, 3));			\
+		b = vsubq_u32(vsubq_u32(b, c), a);			\
+		b = veorq_u32(b, vshlq_n_u32(a, 10));			\
+		c = vsubq_u32(vsubq_u32(c, a), b);			\
+		c = veorq_u32(c, vshrq_n_u32(b, 15));			\
+	} while (0)
+
+static unsigned ceph_str_hash_rjenkins_neon(const char * const *strs,
+					    const unsigned *lens,
+					    unsigned n, unsigned *out)
+{
+	unsigned i, r, l;
+	for (i = 0; i + 4 <= n; i += 4) {
+		unsigned rounds = rjenkins_rounds(lens + i, 4);
+		uint32x4_t a = vdupq_n_u32(0x9e3779b9);
+		uint32x4_t b = a;
+		uint32x4_t c = vdupq_n_u32(0);
+		for (r = 0; r < rounds; r++) {
+			__u32 wa[4], wb[4], wc[4], live[4];
+			for (l = 0; l < 4; l++)
+				live[l] = rjenkins_round(strs[i + l], lens[i + l], r,
+							 &wa[l], &wb[l], &wc[l]) ? ~0u : 0;
+			uint32x4_t m = vld1q_u32(live);
+			uint32x4_t na = vaddq_u32(a, vld1q_u32(wa));
+			uint32x4_t nb = vaddq_u32(b, vld1q_u32(wb));
+			uint32x4_t nc = vaddq_u32(c, vld1q_u32(wc));
+			mix_neon(na, nb, nc);
+			a = vbslq_u32(m, na, a);
+			b = vbslq_u32(m, nb, b);
+			c = vbslq_u32(m, nc, c);
+		}
+		vst1q_u32(out + i, c);
+	}
+	return i;
+}
+#endif
+
+void ceph_str_hash_rjenkins_batch(const char * const *strs,
+				  const unsigned *lens,
+				  unsigned n, unsigned *out)
+{
+	unsigned i = 0;
+#if defined(CEPH_HASH_HAVE_AVX2)
+	if (ceph_hash_avx2_supported())
+		i = ceph_str_hash_rjenkins_avx2(strs, lens, n, out);
+#elif defined(CEPH_HASH_HAVE_NEON)
+	i = ceph_str_hash_rjenkins_neon(strs, lens, n, out);
+#endif
+	for (; i < n; i++)
+		out[i] = ceph_str_hash_rjenkins(strs[i], lens[i]);
+}
+
 /*
  * linux dcache hash
  */
@@ -104,6 +293,20 @@ unsigned ceph_str_hash(int type, const char *s, unsigned len)
 	}
 }
 
+void ceph_str_hash_batch(int type, const char * const *strs,
+			 const unsigned *lens, unsigned n, unsigned *out)
+{
+	unsigned i;
+	switch (type) {
+	case CEPH_STR_HASH_RJENKINS:
+		ceph_str_hash_rjenkins_batch(strs, lens, n, out);
+		break;
+	default:
+		for (i = 0; i < n; i++)
+			out[i] = ceph_str_hash(type, strs[i], lens[i]);
+	}
+}
+
 const char *ceph_str_hash_name(int type)
 {
 	switch (type) {
@@ -8,6 +8,7 @@
 #include "arch/ppc.h"
 #include "common/sctp_crc32.h"
 #include "common/crc32c_intel_fast.h"
+#include "common/crc32c_intel_avx512.h"
 #include "common/crc32c_aarch64.h"
 #include "common/crc32c_ppc.h"
 
@@ -23,6 +24,10 @@ ceph_crc32c_func_t ceph_choose_crc32(void)
   // if the CPU supports it, *and* the fast version is compiled in,
   // use that.
 #if defined(__i386__) || defined(__x86_64__)
+  if (ceph_arch_intel_avx512 && ceph_arch_intel_vpclmul &&
+      ceph_arch_intel_sse42 && ceph_crc32c_intel_avx512_exists()) {
+    return ceph_crc32c_intel_avx512;
+  }
   if (ceph_arch_intel_sse42 && ceph_crc32c_intel_fast_exists()) {
     return ceph_crc32c_intel_fast;
   }
@@ -52,6 +57,19 @@ ceph_crc32c_func_t ceph_choose_crc32(void)
  */
 ceph_crc32c_func_t ceph_crc32c_func = ceph_choose_crc32();
 
+void ceph_crc32c_multi(uint32_t *crcs, unsigned char const * const *data,
+		       unsigned length, unsigned n)
+{
+  // the folding kernels are bound by memory bandwidth rather than by
+  // instruction latency, so stream the buffers one after the other
+  // through the chosen implementation; callers get one dispatch for a
+  // whole batch of blocks instead of one per block.
+  const ceph_crc32c_func_t f = ceph_crc32c_func;
+  for (unsigned i = 0; i < n; ++i) {
+    crcs[i] = f(crcs[i], data[i], length);
+  }
+}
+
 
 /*
  * Look: http://crcutil.googlecode.com/files/crc-doc.1.0.pdf
@@ -0,0 +1,149 @@
+/*
+ * CRC32C using VPCLMULQDQ folding over 512-bit registers.
+ *
+ * The buffer is folded 256 bytes at a time into four zmm accumulators
+ * (sixteen independent 128-bit lanes), the accumulators are folded into
+ * one 128-bit remainder, and that remainder plus any tail shorter than
+ * 64 bytes is finished with the SSE4.2 crc32 instruction.
+ *
+ * Folding a 128-bit lane X = Xh*x^64 + Xl (Xh is the first qword in the
+ * stream) forward by d bits is X*x^d = Xh*x^(d+64) + Xl*x^d mod P.  The
+ * carry-less product of two bit-reflected operands comes out shifted by
+ * one bit, so the constants below are x^(d+63) mod P and x^(d-1) mod P,
+ * bit-reflected into the high half of a qword.
+ */
+
+#include "acconfig.h"
+#include "common/crc32c_intel_avx512.h"
+#include "common/crc32c_intel_baseline.h"
+
+#ifdef CEPH_CRC32C_HAVE_AVX512
+
+#include <immintrin.h>
+
+#define TARGET_AVX512 \
+  __attribute__((target("avx512f,avx512vl,avx512bw,vpclmulqdq,pclmul,sse4.2")))
+
+/* { x^(d+63) mod P, x^(d-1) mod P } for a fold distance of d bits */
+#define K_2048_LO 0xe9a5d8be00000000ULL
+#define K_2048_HI 0x1426a81500000000ULL
+#define K_512_LO  0x1c19243b00000000ULL
+#define K_512_HI  0x75bba45b00000000ULL
+#define K_384_LO  0xa46ef4aa00000000ULL
+#define K_384_HI  0x6051243f00000000ULL
+#define K_256_LO  0x33ccbbbc00000000ULL
+#define K_256_HI  0xa2158b3400000000ULL
+#define K_128_LO  0x3743f7bd00000000ULL
+#define K_128_HI  0x3171d43000000000ULL
+
+TARGET_AVX512
+static inline __m512i fold512(__m512i x, __m512i k)
+{
+  return _mm512_ternarylogic_epi64(_mm512_clmulepi64_epi128(x, k, 0x00),
+				   _mm512_clmulepi64_epi128(x, k, 0x11),
+				   _mm512_setzero_si512(), 0x96);
+}
+
+TARGET_AVX512
+static inline __m128i fold128(__m128i x, uint64_t klo, uint64_t khi)
+{
+  __m128i k = _mm_set_epi64x(khi, klo);
+  return _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00),
+		       _mm_clmulepi64_si128(x, k, 0x11));
+}
+
+TARGET_AVX512
+static uint32_t crc32c_tail(uint32_t crc, unsigned char const *p, unsigned len)
+{
+  uint64_t crc64 = crc;
+  while (len >= 8) {
+    uint64_t v;
+    __builtin_memcpy(&v, p, 8);
+    crc64 = _mm_crc32_u64(crc64, v);
+    p += 8;
+    len -= 8;
+  }
+  crc = (uint32_t)crc64;
+  while (len--) {
+    crc = _mm_crc32_u8(crc, *p++);
+  }
+  return crc;
+}
+
+TARGET_AVX512
+uint32_t ceph_crc32c_intel_avx512(uint32_t crc, unsigned char const *buffer,
+				  unsigned len)
+{
+  if (!buffer) {
+    return ceph_crc32c_intel_baseline(crc, buffer, len);
+  }
+  if (len < 256) {
+    return crc32c_tail(crc, buffer, len);
+  }
+
+  const __m512i k2048 = _mm512_broadcast_i32x4(
+    _mm_set_epi64x(K_2048_HI, K_2048_LO));
+  const __m512i k512 = _mm512_broadcast_i32x4(
+    _mm_set_epi64x(K_512_HI, K_512_LO));
+
+  __m512i z0 = _mm512_loadu_si512(buffer);
+  __m512i z1 = _mm512_loadu_si512(buffer + 64);
+  __m512i z2 = _mm512_loadu_si512(buffer + 128);
+  __m512i z3 = _mm512_loadu_si512(buffer + 192);
+  /* crc(c, M) == crc(0, M ^ c) with c in the first four bytes */
+  z0 = _mm512_xor_si512(z0, _mm512_zextsi128_si512(_mm_cvtsi32_si128(crc)));
+  buffer += 256;
+  len -= 256;
+
+  while (len >= 256) {
+    z0 = _mm512_xor_si512(fold512(z0, k2048), _mm512_loadu_si512(buffer));
+    z1 = _mm512_xor_si512(fold512(z1, k2048), _mm512_loadu_si512(buffer + 64));
+    z2 = _mm512_xor_si512(fold512(z2, k2048), _mm512_loadu_si512(buffer + 128));
+    z3 = _mm512_xor_si512(fold512(z3, k2048), _mm512_loadu_si512(buffer + 192));
+    buffer += 256;
+    len -= 256;
+  }
+
+  z1 = _mm512_xor_si512(fold512(z0, k512), z1);
+  z2 = _mm512_xor_si512(fold512(z1, k512), z2);
+  z3 = _mm512_xor_si512(fold512(z2, k512), z3);
+  while (len >= 64) {
+    z3 = _mm512_xor_si512(fold512(z3, k512), _mm512_loadu_si512(buffer));
+    buffer += 64;
+    len -= 64;
+  }
+
+  /* fold the four 128-bit lanes of z3 into the last one */
+  __m128i x = _mm512_extracti32x4_epi32(z3, 3);
+  x = _mm_xor_si128(x, fold128(_mm512_extracti32x4_epi32(z3, 0),
+			       K_384_LO, K_384_HI));
+  x = _mm_xor_si128(x, fold128(_mm512_extracti32x4_epi32(z3, 1),
+			       K_256_LO, K_256_HI));
+  x = _mm_xor_si128(x, fold128(_mm512_extracti32x4_epi32(z3, 2),
+			       K_128_LO, K_128_HI));
+
+  /* x is congruent to everything consumed so far; crc it as 16 bytes */
+  uint64_t c = _mm_crc32_u64(0, (uint64_t)_mm_cvtsi128_si64(x));
+  c = _mm_crc32_u64(c, (uint64_t)_mm_extract_epi64(x, 1));
+  return crc32c_tail((uint32_t)c, buffer, len);
+}
+
+int ceph_crc32c_intel_avx512_exists(void)
+{
+  return 1;
+}
+
+#else
+
+int ceph_crc32c_intel_avx512_exists(void)
+{
+  return 0;
+}
+
+uint32_t ceph_crc32c_intel_avx512(uint32_t crc, unsigned char const *buffer,
+				  unsigned len)
+{
+  return 0;
+}
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef CEPH_COMMON_CRC32C_INTEL_AVX512_H
+#define CEPH_COMMON_CRC32C_INTEL_AVX512_H
+
+#include "include/int_types.h"
+
+#if defined(__x86_64__) && \
+  ((defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 8) || \
+   (defined(__clang__) && __clang_major__ >= 6))
+#define CEPH_CRC32C_HAVE_AVX512 1
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* is the VPCLMULQDQ version compiled in */
+extern int ceph_crc32c_intel_avx512_exists(void);
+
+extern uint32_t ceph_crc32c_intel_avx512(uint32_t crc, unsigned char const *buffer, unsigned len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -141,6 +141,13 @@ struct is_dynamic<dynamic_marker_t<T>> : public std::true_type {};
                   "{}", _out.str().c_str());    \
     }                                           \
   } while (0)
+#define dout_fmt_impl(cct, sub, v, ...)                                 \
+  do {                                                                  \
+    if (crimson::common::local_conf()->subsys.should_gather(sub, v)) {  \
+      crimson::get_logger(sub).log(crimson::to_log_level(v),            \
+                                   __VA_ARGS__);                        \
+    }                                                                   \
+  } while (0)
 #else
 #define dout_impl(cct, sub, v)						\
   do {									\
@@ -168,12 +175,41 @@ struct is_dynamic<dynamic_marker_t<T>> : public std::true_type {};
     _dout_cct->_log->submit_entry(std::move(_dout_e));                  \
   }                                                                     \
   } while (0)
+
+/* Like dout_impl, but takes an fmt format string and its arguments.
+ * Numbers and strings are captured as they are and formatted only if
+ * the entry is written out or dumped, so entries that are only gathered
+ * in memory are cheap.  There is no dout_prefix; put any prefix in the
+ * format string.
+ */
+#define dout_fmt_impl(cct, sub, v, ...)					\
+  do {									\
+  const bool should_gather = [&](const auto cctX) {			\
+    if constexpr (ceph::dout::is_dynamic<decltype(sub)>::value ||	\
+		  ceph::dout::is_dynamic<decltype(v)>::value) {		\
+      return cctX->_conf->subsys.should_gather(sub, v);			\
+    } else {								\
+      return (cctX->_conf->subsys.template should_gather<sub, v>());	\
+    }									\
+  }(cct);								\
+									\
+  if (should_gather) {							\
+    ceph::logging::DeferredEntry _dout_e(v, sub, __VA_ARGS__);		\
+    auto _dout_cct = cct;						\
+    _dout_cct->_log->submit_entry(std::move(_dout_e));			\
+  }									\
+  } while (0)
 #endif	// WITH_SEASTAR
 
 #define lsubdout(cct, sub, v)  dout_impl(cct, ceph_subsys_##sub, v) dout_prefix
 #define ldout(cct, v)  dout_impl(cct, dout_subsys, v) dout_prefix
 #define lderr(cct) dout_impl(cct, ceph_subsys_, -1) dout_prefix
 
+#define lsubdout_fmt(cct, sub, v, ...) \
+  dout_fmt_impl(cct, ceph_subsys_##sub, v, __VA_ARGS__)
+#define ldout_fmt(cct, v, ...) dout_fmt_impl(cct, dout_subsys, v, __VA_ARGS__)
+#define lderr_fmt(cct, ...) dout_fmt_impl(cct, ceph_subsys_, -1, __VA_ARGS__)
+
 #define ldpp_subdout(dpp, sub, v) 						\
   if (decltype(auto) pdpp = (dpp); pdpp) /* workaround -Wnonnull-compare for 'this' */ \
     dout_impl(pdpp->get_cct(), ceph_subsys_##sub, v) \
@@ -14,6 +14,7 @@
 
 #include "common/escape.h"
 
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <iomanip>
@@ -284,3 +285,66 @@ std::ostream& operator<<(std::ostream& out, const json_stream_escaper& e)
   }
   return out;
 }
+
+/* Returns the length of the prefix of 'buf' that needs no JSON escaping.
+ * Tests eight bytes at a time for '"', '\\', control characters and DEL,
+ * since most strings we dump have none of them.
+ */
+static size_t json_plain_prefix_len(const char *buf, size_t len)
+{
+  constexpr uint64_t ones = 0x0101010101010101ull;
+  constexpr uint64_t highs = ones * 0x80;
+  // nonzero iff some byte of x is zero
+  auto has_zero = [](uint64_t x) { return (x - ones) & ~x & highs; };
+  size_t i = 0;
+  for (; i + 8 <= len; i += 8) {
+    uint64_t v;
+    memcpy(&v, buf + i, 8);
+    if (((v - ones * 0x20) & ~v & highs) ||  // some byte < 0x20
+	has_zero(v ^ (ones * '"')) ||
+	has_zero(v ^ (ones * '\\')) ||
+	has_zero(v ^ (ones * 0x7f))) {
+      break;
+    }
+  }
+  for (; i < len; ++i) {
+    unsigned char c = buf[i];
+    if (c < 0x20 || c == '"' || c == '\\' || c == 0x7f) {
+      break;
+    }
+  }
+  return i;
+}
+
+void escape_json_append(std::string_view in, std::string& out)
+{
+  while (!in.empty()) {
+    size_t n = json_plain_prefix_len(in.data(), in.size());
+    out.append(in.data(), n);
+    if (n == in.size()) {
+      break;
+    }
+    unsigned char c = in[n];
+    switch (c) {
+    case '"':
+      out.append(DBL_QUOTE_JESCAPE, SSTRL(DBL_QUOTE_JESCAPE));
+      break;
+    case '\\':
+      out.append(BACKSLASH_JESCAPE, SSTRL(BACKSLASH_JESCAPE));
+      break;
+    case '\t':
+      out.append(TAB_JESCAPE, SSTRL(TAB_JESCAPE));
+      break;
+    case '\n':
+      out.append(NEWLINE_JESCAPE, SSTRL(NEWLINE_JESCAPE));
+      break;
+    default:
+      // Escape control characters.
+      char hex[7];
+      snprintf(hex, sizeof(hex), "\\u%04x", c);
+      out.append(hex, 6);
+      break;
+    }
+    in.remove_prefix(n + 1);
+  }
+}
@@ -16,6 +16,7 @@
 #define CEPH_RGW_ESCAPE_H
 
 #include <ostream>
+#include <string>
 #include <string_view>
 
 /* Returns the length of a buffer that would be needed to escape 'buf'
@@ -61,4 +62,10 @@ struct json_stream_escaper {
 };
 std::ostream& operator<<(std::ostream& out, const json_stream_escaper& e);
 
+/* Appends 'in' to 'out', escaped as the contents of a JSON string. Produces
+ * the same output as json_stream_escaper, but copies runs of characters that
+ * need no escaping in bulk.
+ */
+void escape_json_append(std::string_view in, std::string& out);
+
 #endif
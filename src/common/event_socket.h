@@ -29,7 +29,7 @@ class EventSocket {
 
  public:
   EventSocket(): socket(-1), type(EVENT_SOCKET_TYPE_NONE) {}
-  bool is_valid() const { return socket != -1; }
+  bool is_valid() const { return type != EVENT_SOCKET_TYPE_NONE; }
   int init(int fd, int t) {
     switch (t) {
       case EVENT_SOCKET_TYPE_PIPE:
@@ -37,16 +37,30 @@ class EventSocket {
       case EVENT_SOCKET_TYPE_EVENTFD:
 #endif
       {
+        if (fd < 0)
+          return -EINVAL;
         socket = fd;
         type = t;
         return 0;
       }
+      case EVENT_SOCKET_TYPE_POLL:
+      {
+        // no descriptor: the owner polls for events itself
+        socket = -1;
+        type = t;
+        return 0;
+      }
     }
     return -EINVAL;
   }
   int notify() {
     int ret;
     switch (type) {
+      case EVENT_SOCKET_TYPE_POLL:
+      {
+        ret = 0;
+        break;
+      }
       case EVENT_SOCKET_TYPE_PIPE:
       {
         char buf[1];
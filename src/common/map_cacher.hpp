@@ -15,6 +15,8 @@
 #ifndef MAPCACHER_H
 #define MAPCACHER_H
 
+#include <vector>
+
 #include "include/Context.h"
 #include "common/sharedptr_registry.hpp"
 
@@ -60,6 +62,27 @@ public:
     std::pair<K, V> *next    ///< [out] first key after key
     ) = 0; ///< @return 0 on success, -ENOENT if there is no next
 
+  /// Fetch up to max consecutive entries after key
+  virtual int get_next_n(
+    const K &key,                       ///< [in] key after which to start
+    unsigned max,                       ///< [in] maximum number of entries
+    std::vector<std::pair<K, V>> *out   ///< [out] entries, in key order
+    ) {
+    K pos = key;
+    while (out->size() < max) {
+      std::pair<K, V> next;
+      int r = get_next(pos, &next);
+      if (r == -ENOENT) {
+	break;
+      } else if (r < 0) {
+	return r;
+      }
+      pos = next.first;
+      out->push_back(std::move(next));
+    }
+    return out->empty() ? -ENOENT : 0;
+  } ///< @return 0 on success, -ENOENT if there is no next
+
   virtual ~StoreDriver() {}
 };
 
@@ -121,6 +144,68 @@ public:
     return -EINVAL;
   } ///< @return error value, 0 on success, -ENOENT if no more entries
 
+  /// Fetch up to max consecutive key/value pairs after key
+  int get_next_n(
+    K key,                              ///< [in] key after which to start
+    unsigned max,                       ///< [in] maximum number of entries
+    std::vector<std::pair<K, V>> *out   ///< [out] entries, in key order
+    ) {
+    while (out->size() < max) {
+      const unsigned want = max - out->size();
+
+      // As in get_next(), look at in progress writes before the store: an
+      // entry that drops out of in_progress has already been applied.
+      std::vector<std::pair<K, boost::optional<V>>> cached;
+      unsigned cached_live = 0;
+      {
+	K pos = key;
+	std::pair<K, boost::optional<V>> next;
+	while (cached_live < want && in_progress.get_next(pos, &next)) {
+	  pos = next.first;
+	  if (next.second)
+	    ++cached_live;
+	  cached.push_back(std::move(next));
+	}
+      }
+      std::vector<std::pair<K, V>> store;
+      int r = driver->get_next_n(key, want, &store);
+      if (r < 0 && r != -ENOENT)
+	return r;
+
+      // Past the last entry of a source that hit 'want' there may be more
+      // we have not looked at; merge up to there and read again from it.
+      boost::optional<K> bound;
+      if (cached_live == want)
+	bound = cached.back().first;
+      if (store.size() == want && (!bound || store.back().first < *bound))
+	bound = store.back().first;
+
+      auto ci = cached.begin();
+      auto si = store.begin();
+      while (out->size() < max) {
+	bool got_cached = ci != cached.end() && (!bound || ci->first <= *bound);
+	bool got_store = si != store.end() && (!bound || si->first <= *bound);
+	if (!got_cached && !got_store) {
+	  break;
+	} else if (got_cached && (!got_store || si->first >= ci->first)) {
+	  if (got_store && si->first == ci->first)
+	    ++si; // superseded by the in progress write
+	  key = ci->first;
+	  if (ci->second)
+	    out->emplace_back(ci->first, ci->second.get());
+	  ++ci;
+	} else {
+	  key = si->first;
+	  out->push_back(std::move(*si));
+	  ++si;
+	}
+      }
+      if (!bound)
+	break; // both sources exhausted
+    }
+    return out->empty() ? -ENOENT : 0;
+  } ///< @return error value, 0 on success, -ENOENT if no more entries
+
   /// Adds operation setting keys to Transaction
   void set_keys(
     const std::map<K, V> &keys,  ///< [in] keys/values to std::set
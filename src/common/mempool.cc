@@ -12,6 +12,15 @@
  *
  */
 
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <tuple>
+
+#include "acconfig.h"
+#ifdef HAVE_EXECINFO_H
+#include <execinfo.h>
+#endif
 #include "include/mempool.h"
 #include "include/demangle.h"
 
@@ -22,6 +31,13 @@ static thread_local size_t thread_shard_index = mempool::num_shards;
 // default to debug_mode off
 bool mempool::debug_mode = false;
 
+// default to the profiler off
+std::atomic<unsigned> mempool::profile_rate = {0};
+std::atomic<size_t> mempool::profile_live = {0};
+
+// allocations left on this thread before the next sample
+static thread_local unsigned profile_countdown = 0;
+
 // --------------------------------------------------------------
 
 mempool::pool_t& mempool::get_pool(mempool::pool_index_t ix)
@@ -138,3 +154,148 @@ void mempool::pool_t::dump(ceph::Formatter *f, stats_t *ptotal) const
     f->close_section();
   }
 }
+
+// --------------------------------------------------------------
+// profiler
+
+namespace {
+
+// frames kept per sample, after skipping profile_alloc() and the
+// allocator itself
+constexpr int profile_depth = 8;
+constexpr int profile_skip = 2;
+
+struct profile_sample_t {
+  mempool::pool_index_t pool;
+  const char *type;
+  size_t bytes;
+  unsigned weight;  // profile_rate when sampled
+  int depth = 0;
+  std::array<void*, profile_depth> frames{};
+};
+
+// samples are sharded by address so that frees from different threads
+// rarely contend
+struct profile_shard_t {
+  std::mutex lock;
+  std::unordered_map<void*, profile_sample_t> samples;
+};
+
+profile_shard_t *get_profile_shards()
+{
+  static profile_shard_t shards[mempool::num_shards];
+  return shards;
+}
+
+profile_shard_t& get_profile_shard(void *p)
+{
+  uint64_t h = (reinterpret_cast<uintptr_t>(p) >> 4) * 0x9E3779B97F4A7C15ull;
+  return get_profile_shards()[h >> (64 - mempool::num_shard_bits)];
+}
+
+} // anonymous namespace
+
+void mempool::set_profile_rate(unsigned rate)
+{
+  profile_rate = rate;
+}
+
+void mempool::profile_alloc(pool_index_t ix, const char *type,
+			    void *p, size_t bytes)
+{
+  unsigned rate = profile_rate.load(std::memory_order_relaxed);
+  if (rate == 0) {
+    return;
+  }
+  if (profile_countdown == 0 || profile_countdown > rate) {
+    // start each thread at a different phase, so that threads running
+    // the same loop do not all sample the same allocation in it
+    profile_countdown = 1 + pool_t::pick_a_shard_int() * 7919 % rate;
+  }
+  if (--profile_countdown > 0) {
+    return;
+  }
+  profile_countdown = rate;
+
+  profile_sample_t sample{ix, type, bytes, rate};
+#ifdef HAVE_EXECINFO_H
+  void *frames[profile_depth + profile_skip];
+  int n = backtrace(frames, profile_depth + profile_skip);
+  sample.depth = std::max(n - profile_skip, 0);
+  std::copy_n(frames + profile_skip, sample.depth, sample.frames.begin());
+#endif
+
+  auto& shard = get_profile_shard(p);
+  std::lock_guard l(shard.lock);
+  if (shard.samples.insert_or_assign(p, sample).second) {
+    ++profile_live;
+  }
+}
+
+void mempool::profile_free(void *p)
+{
+  auto& shard = get_profile_shard(p);
+  std::lock_guard l(shard.lock);
+  if (shard.samples.erase(p)) {
+    --profile_live;
+  }
+}
+
+void mempool::dump_profile(ceph::Formatter *f)
+{
+  // aggregate the live samples by pool, type and backtrace.  each
+  // sample stands for weight allocations of its size.
+  struct site_t {
+    size_t samples = 0;
+    size_t items = 0;
+    size_t bytes = 0;
+  };
+  using key_t = std::tuple<int, const char*, std::vector<void*>>;
+  std::map<key_t, site_t> sites;
+  for (size_t i = 0; i < num_shards; ++i) {
+    auto& shard = get_profile_shards()[i];
+    std::lock_guard l(shard.lock);
+    for (auto& [p, s] : shard.samples) {
+      auto& site = sites[key_t{s.pool, s.type,
+			       {s.frames.begin(), s.frames.begin() + s.depth}}];
+      site.samples++;
+      site.items += s.weight;
+      site.bytes += s.bytes * s.weight;
+    }
+  }
+
+  std::vector<std::pair<const key_t*, const site_t*>> by_bytes;
+  by_bytes.reserve(sites.size());
+  for (auto& [key, site] : sites) {
+    by_bytes.emplace_back(&key, &site);
+  }
+  std::sort(by_bytes.begin(), by_bytes.end(), [](auto& a, auto& b) {
+    return a.second->bytes > b.second->bytes;
+  });
+
+  f->open_object_section("profile");
+  f->dump_unsigned("rate", profile_rate);
+  f->dump_unsigned("live_samples", profile_live);
+  f->open_array_section("sites");
+  for (auto& [key, site] : by_bytes) {
+    auto& [pool, type, frames] = *key;
+    f->open_object_section("site");
+    f->dump_string("pool", get_pool_name(pool_index_t(pool)));
+    f->dump_string("type", ceph_demangle(type));
+    f->dump_unsigned("samples", site->samples);
+    f->dump_unsigned("est_items", site->items);
+    f->dump_unsigned("est_bytes", site->bytes);
+    f->open_array_section("backtrace");
+#ifdef HAVE_EXECINFO_H
+    char **symbols = backtrace_symbols(frames.data(), frames.size());
+    for (size_t i = 0; symbols && i < frames.size(); ++i) {
+      f->dump_string("frame", symbols[i]);
+    }
+    free(symbols);
+#endif
+    f->close_section();
+    f->close_section();
+  }
+  f->close_section();
+  f->close_section();
+}
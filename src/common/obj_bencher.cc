@@ -16,7 +16,9 @@
  * it will just loop forever.
  */
 #include "include/compat.h"
+#include <deque>
 #include <pthread.h>
+#include <random>
 #include "common/ceph_mutex.h"
 #include "common/Clock.h"
 #include "obj_bencher.h"
@@ -98,6 +100,26 @@ ostream& ObjBencher::out(ostream& os)
   return out(os, cur_time);
 }
 
+void ObjBencher::note_latency()
+{
+  ceph_assert(ceph_mutex_is_locked(lock));
+  data.lat_hist.add(data.cur_latency.count());
+  data.interval_lat_hist.add(data.cur_latency.count());
+}
+
+void ObjBencher::dump_latency_percentiles(const bench_latency_histogram& h)
+{
+  if (!formatter) {
+    out(cout) << "Latency p50(s):         " << h.percentile(.5) << std::endl
+	      << "Latency p99(s):         " << h.percentile(.99) << std::endl
+	      << "Latency p99.9(s):       " << h.percentile(.999) << std::endl;
+  } else {
+    formatter->dump_float("p50_latency", h.percentile(.5));
+    formatter->dump_float("p99_latency", h.percentile(.99));
+    formatter->dump_float("p999_latency", h.percentile(.999));
+  }
+}
+
 void *ObjBencher::status_printer(void *_bencher) {
   ObjBencher *bencher = static_cast<ObjBencher *>(_bencher);
   bench_data& data = bencher->data;
@@ -122,7 +144,8 @@ void *ObjBencher::status_printer(void *_bencher) {
         t.localtime(cout)
           << " min lat: " << data.min_latency
           << " max lat: " << data.max_latency
-          << " avg lat: " << data.avg_latency << std::endl;
+          << " avg lat: " << data.avg_latency
+          << " p99 lat: " << data.lat_hist.percentile(.99) << std::endl;
       //I'm naughty and don't reset the fill
       bencher->out(cout, t) << setfill(' ')
           << setw(5) << "sec"
@@ -202,7 +225,12 @@ void *ObjBencher::status_printer(void *_bencher) {
         formatter->dump_format("cur_bw", "%f", bandwidth);
         formatter->dump_format("last_lat", "%f", (double)data.cur_latency.count());
         formatter->dump_format("avg_lat", "%f", data.avg_latency);
+        // over the completions since the previous line
+        formatter->dump_float("p50_lat", data.interval_lat_hist.percentile(.5));
+        formatter->dump_float("p99_lat", data.interval_lat_hist.percentile(.99));
+        formatter->dump_float("p999_lat", data.interval_lat_hist.percentile(.999));
       }
+      data.interval_lat_hist.clear();
     }
     else {
       if (!formatter) {
@@ -295,6 +323,8 @@ int ObjBencher::aio_bench(
   data.max_latency = 0;
   data.avg_latency = 0;
   data.latency_diff_sum = 0;
+  data.lat_hist.clear();
+  data.interval_lat_hist.clear();
   data.object_contents = contentsChars;
   lock.unlock();
 
@@ -417,6 +447,13 @@ int ObjBencher::write_bench(int secondsToRun,
     formatter->dump_format("seconds_to_run", "%d", secondsToRun);
     formatter->dump_format("max_objects", "%d", max_objects);
   }
+  if (target_rate > 0) {
+    if (!formatter)
+      out(cout) << "Open loop: " << target_rate
+		<< " writes/sec with random (Poisson) arrivals" << std::endl;
+    else
+      formatter->dump_float("target_rate", target_rate);
+  }
   bufferlist* newContents = 0;
 
   std::string prefix = prev_pid ? generate_object_prefix(prev_pid) : generate_object_prefix();
@@ -427,7 +464,7 @@ int ObjBencher::write_bench(int secondsToRun,
 
   std::vector<string> name(concurrentios);
   std::string newName;
-  unique_ptr<bufferlist> contents[concurrentios];
+  std::vector<unique_ptr<bufferlist>> contents(concurrentios);
   int r = 0;
   bufferlist b_write;
   lock_cond lc(&lock);
@@ -440,6 +477,49 @@ int ObjBencher::write_bench(int secondsToRun,
   if (data.op_size)
     writes_per_object = data.object_size / data.op_size;
 
+  // In open-loop mode (target_rate > 0) writes arrive at exponentially
+  // distributed intervals whatever the completion rate, and concurrentios
+  // only bounds how many may be outstanding.  Latency is measured from
+  // the scheduled arrival, so a backlog on our side is not hidden.
+  std::vector<bool> busy(concurrentios);
+  std::deque<int> idle;
+  std::mt19937 rng(getpid());
+  std::exponential_distribution<double> arrival_gap(
+    target_rate > 0 ? target_rate : 1);
+  mono_time next_arrival;
+  auto more_writes = [&]() {
+    if (!secondsToRun || mono_clock::now() >= stopTime) {
+      return false;
+    }
+    if (data.op_size && max_objects &&
+        data.started >=
+            (int)((data.object_size * max_objects + data.op_size - 1) /
+                  data.op_size)) {
+      return false;
+    }
+    return true;
+  };
+  auto issue_write = [&](int slot, mono_time start) {
+    //create new contents and name on the heap, and fill them
+    newName = generate_object_name_fast(data.started / writes_per_object);
+    newContents = contents[slot].get();
+    snprintf(newContents->c_str(), data.op_size, "I'm the %16dth op!", data.started);
+    // we wrote to buffer, going around internal crc cache, so invalidate it now.
+    newContents->invalidate_crc();
+
+    start_times[slot] = start;
+    int r = create_completion(slot, _aio_cb, &lc);
+    if (r < 0)
+      return r;
+    r = aio_write(newName, slot, *newContents, data.op_size,
+		  data.op_size * (data.started % writes_per_object));
+    if (r < 0)
+      return r;
+    name[slot] = newName;
+    busy[slot] = true;
+    return 0;
+  };
+
   r = completions_init(concurrentios);
 
   //set up writes so I can start them together
@@ -458,7 +538,11 @@ int ObjBencher::write_bench(int secondsToRun,
   data.finished = 0;
   data.start_time = mono_clock::now();
   locker.unlock();
-  for (int i = 0; i<concurrentios; ++i) {
+  next_arrival = data.start_time;
+  for (int i = 0; target_rate > 0 && i < concurrentios; ++i) {
+    idle.push_back(i);
+  }
+  for (int i = 0; !(target_rate > 0) && i<concurrentios; ++i) {
     start_times[i] = mono_clock::now();
     r = create_completion(i, _aio_cb, (void *)&lc);
     if (r < 0)
@@ -468,6 +552,7 @@ int ObjBencher::write_bench(int secondsToRun,
     if (r < 0) {
       goto ERR;
     }
+    busy[i] = true;
     locker.lock();
     ++data.started;
     ++data.in_flight;
@@ -482,12 +567,13 @@ int ObjBencher::write_bench(int secondsToRun,
   stopTime = data.start_time + std::chrono::seconds(secondsToRun);
   slot = 0;
   locker.lock();
-  while (data.finished < data.started) {
+  while (data.finished < data.started ||
+	 (target_rate > 0 && more_writes())) {
     bool found = false;
     while (1) {
       int old_slot = slot;
       do {
-        if (completion_is_done(slot)) {
+        if (busy[slot] && completion_is_done(slot)) {
             found = true;
             break;
         }
@@ -498,7 +584,36 @@ int ObjBencher::write_bench(int secondsToRun,
       } while (slot != old_slot);
       if (found)
         break;
-      lc.cond.wait(locker);
+      if (target_rate > 0 && !idle.empty() && more_writes()) {
+	if (mono_clock::now() >= next_arrival)
+	  break;
+	lc.cond.wait_until(locker, next_arrival);
+      } else if (data.finished == data.started) {
+	// open loop ran out of time with nothing in flight
+	break;
+      } else {
+	lc.cond.wait(locker);
+      }
+    }
+
+    if (!found) {
+      // open loop: the next write is due and a slot is free
+      locker.unlock();
+      if (more_writes()) {
+	int islot = idle.front();
+	idle.pop_front();
+	r = issue_write(islot, next_arrival);
+	if (r < 0)
+	  goto ERR;
+	next_arrival += std::chrono::duration_cast<mono_clock::duration>(
+	  std::chrono::duration<double>(arrival_gap(rng)));
+	locker.lock();
+	++data.started;
+	++data.in_flight;
+      } else {
+	locker.lock();
+      }
+      continue;
     }
     locker.unlock();
 
@@ -519,42 +634,27 @@ int ObjBencher::write_bench(int secondsToRun,
     double delta = data.cur_latency.count() - data.avg_latency;
     data.avg_latency = total_latency / data.finished;
     data.latency_diff_sum += delta * (data.cur_latency.count() - data.avg_latency);
+    note_latency();
     --data.in_flight;
     locker.unlock();
     release_completion(slot);
+    busy[slot] = false;
 
-    if (!secondsToRun || mono_clock::now() >= stopTime) {
+    if (target_rate > 0) {
+      idle.push_back(slot);
       locker.lock();
       continue;
     }
 
-    if (data.op_size && max_objects &&
-        data.started >=
-            (int)((data.object_size * max_objects + data.op_size - 1) /
-                  data.op_size)) {
+    if (!more_writes()) {
       locker.lock();
       continue;
     }
 
     //write new stuff to backend
-
-    //create new contents and name on the heap, and fill them
-    newName = generate_object_name_fast(data.started / writes_per_object);
-    newContents = contents[slot].get();
-    snprintf(newContents->c_str(), data.op_size, "I'm the %16dth op!", data.started);
-    // we wrote to buffer, going around internal crc cache, so invalidate it now.
-    newContents->invalidate_crc();
-
-    start_times[slot] = mono_clock::now();
-    r = create_completion(slot, _aio_cb, &lc);
+    r = issue_write(slot, mono_clock::now());
     if (r < 0)
       goto ERR;
-    r = aio_write(newName, slot, *newContents, data.op_size,
-		  data.op_size * (data.started % writes_per_object));
-    if (r < 0) {
-      goto ERR;
-    }
-    name[slot] = newName;
     locker.lock();
     ++data.started;
     ++data.in_flight;
@@ -609,6 +709,7 @@ int ObjBencher::write_bench(int secondsToRun,
        << "Stddev Latency(s):      " << latency_stddev << std::endl
        << "Max latency(s):         " << data.max_latency << std::endl
        << "Min latency(s):         " << data.min_latency << std::endl;
+    dump_latency_percentiles(data.lat_hist);
   } else {
     formatter->dump_format("total_time_run", "%f", timePassed.count());
     formatter->dump_format("total_writes_made", "%d", data.finished);
@@ -626,6 +727,7 @@ int ObjBencher::write_bench(int secondsToRun,
     formatter->dump_format("stddev_latency", "%f", latency_stddev);
     formatter->dump_format("max_latency", "%f", data.max_latency);
     formatter->dump_format("min_latency", "%f", data.min_latency);
+    dump_latency_percentiles(data.lat_hist);
   }
   //write object size/number data for read benchmarks
   encode(data.object_size, b_write);
@@ -778,6 +880,7 @@ int ObjBencher::seq_read_bench(
       data.min_latency = data.cur_latency.count();
     ++data.finished;
     data.avg_latency = total_latency / data.finished;
+    note_latency();
     --data.in_flight;
     locker.unlock();
     release_completion(slot);
@@ -831,6 +934,7 @@ int ObjBencher::seq_read_bench(
        << "Average Latency(s):   " << data.avg_latency << std::endl
        << "Max latency(s):       " << data.max_latency << std::endl
        << "Min latency(s):       " << data.min_latency << std::endl;
+    dump_latency_percentiles(data.lat_hist);
   } else {
     formatter->dump_format("total_time_run", "%f", timePassed.count());
     formatter->dump_format("total_reads_made", "%d", data.finished);
@@ -844,6 +948,7 @@ int ObjBencher::seq_read_bench(
     formatter->dump_format("average_latency", "%f", data.avg_latency);
     formatter->dump_format("max_latency", "%f", data.max_latency);
     formatter->dump_format("min_latency", "%f", data.min_latency);
+    dump_latency_percentiles(data.lat_hist);
   }
 
   completions_done();
@@ -973,6 +1078,7 @@ int ObjBencher::rand_read_bench(
       data.min_latency = data.cur_latency.count();
     ++data.finished;
     data.avg_latency = total_latency / data.finished;
+    note_latency();
     --data.in_flight;
 
     if (!no_verify) {
@@ -1044,6 +1150,7 @@ int ObjBencher::rand_read_bench(
        << "Average Latency(s):   " << data.avg_latency << std::endl
        << "Max latency(s):       " << data.max_latency << std::endl
        << "Min latency(s):       " << data.min_latency << std::endl;
+    dump_latency_percentiles(data.lat_hist);
   } else {
     formatter->dump_format("total_time_run", "%f", timePassed.count());
     formatter->dump_format("total_reads_made", "%d", data.finished);
@@ -1057,6 +1164,7 @@ int ObjBencher::rand_read_bench(
     formatter->dump_format("average_latency", "%f", data.avg_latency);
     formatter->dump_format("max_latency", "%f", data.max_latency);
     formatter->dump_format("min_latency", "%f", data.min_latency);
+    dump_latency_percentiles(data.lat_hist);
   }
   completions_done();
 
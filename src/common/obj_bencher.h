@@ -18,10 +18,66 @@
 #include "common/ceph_context.h"
 #include "common/Formatter.h"
 #include "ceph_time.h"
+#include <array>
+#include <bit>
 #include <cfloat>
 
 using ceph::mono_clock;
 
+// Log-linear latency histogram in microseconds: 32 sub-buckets per power
+// of two, so reported percentiles are within ~3% of the true value.
+struct bench_latency_histogram {
+  static constexpr unsigned sub_bits = 5;
+  static constexpr unsigned sub_count = 1 << sub_bits;
+  static constexpr unsigned max_bits = 40;  // ~12 days
+  std::array<uint64_t, (max_bits - sub_bits + 1) * sub_count> buckets = {};
+  uint64_t total = 0;
+
+  static unsigned index(uint64_t us) {
+    if (us < sub_count * 2) {
+      return us;
+    }
+    unsigned msb = std::bit_width(us) - 1;
+    if (msb >= max_bits) {
+      return (max_bits - sub_bits + 1) * sub_count - 1;
+    }
+    unsigned shift = msb - sub_bits;
+    return (shift + 1) * sub_count + ((us >> shift) & (sub_count - 1));
+  }
+  static uint64_t upper_bound(unsigned idx) {
+    if (idx < sub_count * 2) {
+      return idx;
+    }
+    unsigned shift = idx / sub_count - 1;
+    uint64_t base = (sub_count + idx % sub_count) << shift;
+    return base + (1ull << shift) - 1;
+  }
+
+  void add(double seconds) {
+    ++buckets[index(seconds * 1000000)];
+    ++total;
+  }
+  void clear() {
+    buckets.fill(0);
+    total = 0;
+  }
+  /// latency in seconds below which a fraction q of the samples fall
+  double percentile(double q) const {
+    if (!total) {
+      return 0;
+    }
+    uint64_t want = std::max<uint64_t>(1, q * total + 0.5);
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < buckets.size(); ++i) {
+      seen += buckets[i];
+      if (seen >= want) {
+	return upper_bound(i) / 1000000.0;
+      }
+    }
+    return upper_bound(buckets.size() - 1) / 1000000.0;
+  }
+};
+
 struct bench_interval_data {
   double min_bandwidth = DBL_MAX;
   double max_bandwidth = 0;
@@ -50,6 +106,8 @@ struct bench_data {
   struct bench_interval_data idata; // data that is updated by time intervals and not by events
   double latency_diff_sum;
   std::chrono::duration<double> cur_latency; //latency of last completed transaction - in seconds by default
+  bench_latency_histogram lat_hist;          // whole run
+  bench_latency_histogram interval_lat_hist; // since the last status line
   mono_time start_time; //start time for benchmark - use the monotonic clock as we'll measure the passage of time
   char *object_contents; //pointer to the contents written to each object
 };
@@ -63,6 +121,7 @@ typedef std::pair<std::string, std::string> Object;
 
 class ObjBencher {
   bool show_time;
+  double target_rate = 0;  ///< ops/sec for open-loop writes, 0 for closed loop
   Formatter *formatter = NULL;
   std::ostream *outstream = NULL;
 public:
@@ -82,6 +141,8 @@ protected:
   int rand_read_bench(int secondsToRun, int num_ops, int num_objects, int concurrentios, int writePid, bool no_verify=false);
 
   int clean_up(int num_objects, int prevPid, int concurrentios);
+  void note_latency();
+  void dump_latency_percentiles(const bench_latency_histogram& h);
   bool more_objects_matching_prefix(const std::string& prefix, std::list<Object>* name);
 
   virtual int completions_init(int concurrentios) = 0;
@@ -118,6 +179,9 @@ public:
   void set_show_time(bool dt) {
     show_time = dt;
   }
+  void set_target_rate(double rate) {
+    target_rate = rate;
+  }
   void set_formatter(Formatter *f) {
     formatter = f;
   }
@@ -156,6 +156,13 @@ PerfCounters::~PerfCounters()
 {
 }
 
+unsigned PerfCounters::get_thread_shard()
+{
+  static std::atomic<unsigned> next_shard = { 0 };
+  static thread_local unsigned shard = next_shard++;
+  return shard;
+}
+
 void PerfCounters::inc(int idx, uint64_t amt)
 {
 #ifndef WITH_SEASTAR
@@ -169,11 +176,9 @@ void PerfCounters::inc(int idx, uint64_t amt)
   if (!(data.type & PERFCOUNTER_U64))
     return;
   if (data.type & PERFCOUNTER_LONGRUNAVG) {
-    data.avgcount++;
-    data.u64 += amt;
-    data.avgcount2++;
+    data.add_avg(amt);
   } else {
-    data.u64 += amt;
+    data.add(amt);
   }
 }
 
@@ -190,7 +195,7 @@ void PerfCounters::dec(int idx, uint64_t amt)
   ceph_assert(!(data.type & PERFCOUNTER_LONGRUNAVG));
   if (!(data.type & PERFCOUNTER_U64))
     return;
-  data.u64 -= amt;
+  data.sub(amt);
 }
 
 void PerfCounters::set(int idx, uint64_t amt)
@@ -215,6 +220,7 @@ void PerfCounters::set(int idx, uint64_t amt)
   } else {
     data.u64 = amt;
   }
+  data.reset_shards();
 }
 
 uint64_t PerfCounters::get(int idx) const
@@ -229,7 +235,7 @@ uint64_t PerfCounters::get(int idx) const
   const perf_counter_data_any_d& data(m_data[idx - m_lower_bound - 1]);
   if (!(data.type & PERFCOUNTER_U64))
     return 0;
-  return data.u64;
+  return data.read_u64();
 }
 
 void PerfCounters::tinc(int idx, utime_t amt)
@@ -245,11 +251,11 @@ void PerfCounters::tinc(int idx, utime_t amt)
   if (!(data.type & PERFCOUNTER_TIME))
     return;
   if (data.type & PERFCOUNTER_LONGRUNAVG) {
-    data.avgcount++;
-    data.u64 += amt.to_nsec();
-    data.avgcount2++;
+    data.add_avg(amt.to_nsec());
+    if (data.hdr_histogram)
+      data.hdr_histogram->inc(amt.to_nsec());
   } else {
-    data.u64 += amt.to_nsec();
+    data.add(amt.to_nsec());
   }
 }
 
@@ -266,11 +272,11 @@ void PerfCounters::tinc(int idx, ceph::timespan amt)
   if (!(data.type & PERFCOUNTER_TIME))
     return;
   if (data.type & PERFCOUNTER_LONGRUNAVG) {
-    data.avgcount++;
-    data.u64 += amt.count();
-    data.avgcount2++;
+    data.add_avg(amt.count());
+    if (data.hdr_histogram)
+      data.hdr_histogram->inc(amt.count());
   } else {
-    data.u64 += amt.count();
+    data.add(amt.count());
   }
 }
 
@@ -287,6 +293,7 @@ void PerfCounters::tset(int idx, utime_t amt)
   if (!(data.type & PERFCOUNTER_TIME))
     return;
   data.u64 = amt.to_nsec();
+  data.reset_shards();
   if (data.type & PERFCOUNTER_LONGRUNAVG)
     ceph_abort();
 }
@@ -303,7 +310,7 @@ utime_t PerfCounters::tget(int idx) const
   const perf_counter_data_any_d& data(m_data[idx - m_lower_bound - 1]);
   if (!(data.type & PERFCOUNTER_TIME))
     return utime_t();
-  uint64_t v = data.u64;
+  uint64_t v = data.read_u64();
   return utime_t(v / 1000000000ull, v % 1000000000ull);
 }
 
@@ -342,6 +349,21 @@ pair<uint64_t, uint64_t> PerfCounters::get_tavg_ns(int idx) const
   return make_pair(a.second, a.first);
 }
 
+uint64_t PerfCounters::get_tquantile_ns(int idx, double q) const
+{
+#ifndef WITH_SEASTAR
+  if (!m_cct->_conf->perf)
+    return 0;
+#endif
+
+  ceph_assert(idx > m_lower_bound);
+  ceph_assert(idx < m_upper_bound);
+  const perf_counter_data_any_d& data(m_data[idx - m_lower_bound - 1]);
+  if (!data.hdr_histogram)
+    return 0;
+  return data.hdr_histogram->get_quantile(q);
+}
+
 void PerfCounters::reset()
 {
   perf_counter_data_vec_t::iterator d = m_data.begin();
@@ -440,6 +462,9 @@ void PerfCounters::dump_formatted_generic(Formatter *f, bool schema,
           } else {
             f->dump_format_unquoted("avgtime", "%" PRId64 ".%09" PRId64, 0, 0);
           }
+          if (d->hdr_histogram) {
+            d->hdr_histogram->dump_formatted(f);
+          }
 	} else {
 	  ceph_abort();
 	}
@@ -451,7 +476,7 @@ void PerfCounters::dump_formatted_generic(Formatter *f, bool schema,
         d->histogram->dump_formatted(f);
         f->close_section();
       } else {
-	uint64_t v = d->u64;
+	uint64_t v = d->read_u64();
 	if (d->type & PERFCOUNTER_U64) {
 	  f->dump_unsigned(d->name, v);
 	} else if (d->type & PERFCOUNTER_TIME) {
@@ -538,6 +563,17 @@ void PerfCountersBuilder::add_time_avg(
 	   PERFCOUNTER_TIME | PERFCOUNTER_LONGRUNAVG);
 }
 
+void PerfCountersBuilder::add_time_avg_hist(
+  int idx, const char *name,
+  const char *description, const char *nick, int prio)
+{
+  add_impl(idx, name, description, nick, prio,
+	   PERFCOUNTER_TIME | PERFCOUNTER_LONGRUNAVG | PERFCOUNTER_HDR_HISTOGRAM);
+  PerfCounters::perf_counter_data_any_d
+    &data(m_perf_counters->m_data[idx - m_perf_counters->m_lower_bound - 1]);
+  data.hdr_histogram.reset(new PerfHdrHistogram);
+}
+
 void PerfCountersBuilder::add_u64_counter_histogram(
   int idx, const char *name,
   PerfHistogramCommon::axis_config_d x_axis_config,
@@ -549,6 +585,14 @@ void PerfCountersBuilder::add_u64_counter_histogram(
            std::unique_ptr<PerfHistogram<>>{new PerfHistogram<>{x_axis_config, y_axis_config}});
 }
 
+// gauges are mostly set(), so only counters and averages are worth
+// spreading over shards
+bool PerfCountersBuilder::is_shardable(int type)
+{
+  return (type & (PERFCOUNTER_COUNTER | PERFCOUNTER_LONGRUNAVG)) &&
+    !(type & PERFCOUNTER_HISTOGRAM);
+}
+
 void PerfCountersBuilder::add_impl(
   int idx, const char *name,
   const char *description, const char *nick, int prio, int ty, int unit,
@@ -577,11 +621,32 @@ PerfCounters *PerfCountersBuilder::create_perf_counters()
 {
   PerfCounters::perf_counter_data_vec_t::const_iterator d = m_perf_counters->m_data.begin();
   PerfCounters::perf_counter_data_vec_t::const_iterator d_end = m_perf_counters->m_data.end();
+  unsigned num_sharded = 0;
   for (; d != d_end; ++d) {
     ceph_assert(d->type != PERFCOUNTER_NONE);
     ceph_assert(d->type & (PERFCOUNTER_U64 | PERFCOUNTER_TIME));
+    if (is_shardable(d->type))
+      ++num_sharded;
   }
 
+#ifndef WITH_SEASTAR
+  // seastar reactors each have their own counters already
+  unsigned num_shards =
+    m_perf_counters->m_cct->_conf.get_val<uint64_t>("perf_counters_shards");
+  if (num_shards > 1 && num_sharded) {
+    auto& pc = *m_perf_counters;
+    pc.m_shards.reset(new PerfCounters::perf_counter_shard_d[num_shards * num_sharded]);
+    unsigned i = 0;
+    for (auto& data : pc.m_data) {
+      if (!is_shardable(data.type))
+	continue;
+      data.shards = &pc.m_shards[i++];
+      data.num_shards = num_shards;
+      data.shard_stride = num_sharded;
+    }
+  }
+#endif
+
   PerfCounters *ret = m_perf_counters;
   m_perf_counters = NULL;
   return ret;
@@ -43,6 +43,7 @@ enum perfcounter_type_d : uint8_t
   PERFCOUNTER_LONGRUNAVG = 0x4, // paired counter + sum (time)
   PERFCOUNTER_COUNTER = 0x8,    // counter (vs gauge)
   PERFCOUNTER_HISTOGRAM = 0x10, // histogram (vector) of values
+  PERFCOUNTER_HDR_HISTOGRAM = 0x20, // log-linear histogram of a LONGRUNAVG
 };
 
 enum unit_t : uint8_t
@@ -100,6 +101,12 @@ public:
 		    const char *description=NULL,
 		    const char *nick = NULL,
 		    int prio=0);
+  // a time average that also keeps a PerfHdrHistogram of the values, so
+  // that quantiles can be derived from it
+  void add_time_avg_hist(int key, const char *name,
+			 const char *description=NULL,
+			 const char *nick = NULL,
+			 int prio=0);
   void add_u64_counter_histogram(
     int key, const char* name,
     PerfHistogramCommon::axis_config_d x_axis_config,
@@ -120,6 +127,7 @@ private:
   void add_impl(int idx, const char *name,
                 const char *description, const char *nick, int prio, int ty, int unit=UNIT_NONE,
                 std::unique_ptr<PerfHistogram<>> histogram = nullptr);
+  static bool is_shardable(int type);
 
   PerfCounters *m_perf_counters;
 
@@ -154,6 +162,20 @@ private:
 class PerfCounters
 {
 public:
+  /// small per-thread number used to pick a counter shard
+  static unsigned get_thread_shard();
+
+  /**
+   * One thread's share of a sharded counter.  Each sits on its own cache
+   * line, so threads updating the same counter through different shards
+   * do not contend.
+   */
+  struct alignas(64) perf_counter_shard_d {
+    std::atomic<uint64_t> u64 = { 0 };
+    std::atomic<uint64_t> avgcount = { 0 };
+    std::atomic<uint64_t> avgcount2 = { 0 };
+  };
+
   /** Represents a PerfCounters data element. */
   struct perf_counter_data_any_d {
     perf_counter_data_any_d()
@@ -169,7 +191,7 @@ public:
         nick(other.nick),
 	 type(other.type),
 	 unit(other.unit),
-	 u64(other.u64.load()) {
+	 u64(other.read_u64()) {
       auto a = other.read_avg();
       u64 = a.first;
       avgcount = a.second;
@@ -177,6 +199,9 @@ public:
       if (other.histogram) {
         histogram.reset(new PerfHistogram<>(*other.histogram));
       }
+      if (other.hdr_histogram) {
+        hdr_histogram.reset(new PerfHdrHistogram(*other.hdr_histogram));
+      }
     }
 
     const char *name;
@@ -189,6 +214,14 @@ public:
     std::atomic<uint64_t> avgcount = { 0 };
     std::atomic<uint64_t> avgcount2 = { 0 };
     std::unique_ptr<PerfHistogram<>> histogram;
+    std::unique_ptr<PerfHdrHistogram> hdr_histogram;
+
+    // if sharded (see perf_counters_shards), increments go to
+    // shards[n * shard_stride] for the calling thread's shard n, and
+    // the fields above only hold what was set directly
+    perf_counter_shard_d *shards = nullptr;
+    unsigned num_shards = 0;
+    unsigned shard_stride = 0;
 
     void reset()
     {
@@ -196,21 +229,85 @@ public:
 	    u64 = 0;
 	    avgcount = 0;
 	    avgcount2 = 0;
+	    reset_shards();
       }
       if (histogram) {
         histogram->reset();
       }
+      if (hdr_histogram) {
+        hdr_histogram->reset();
+      }
+    }
+
+    void reset_shards()
+    {
+      for (unsigned i = 0; i < num_shards; ++i) {
+	auto& s = shards[i * shard_stride];
+	s.u64 = 0;
+	s.avgcount = 0;
+	s.avgcount2 = 0;
+      }
+    }
+
+    perf_counter_shard_d *get_shard() {
+      if (!shards)
+	return nullptr;
+      return &shards[(get_thread_shard() % num_shards) * shard_stride];
+    }
+
+    void add(uint64_t v) {
+      if (auto s = get_shard())
+	s->u64.fetch_add(v, std::memory_order_relaxed);
+      else
+	u64 += v;
+    }
+
+    void sub(uint64_t v) {
+      if (auto s = get_shard())
+	s->u64.fetch_sub(v, std::memory_order_relaxed);
+      else
+	u64 -= v;
+    }
+
+    void add_avg(uint64_t v) {
+      if (auto s = get_shard()) {
+	s->avgcount++;
+	s->u64 += v;
+	s->avgcount2++;
+      } else {
+	avgcount++;
+	u64 += v;
+	avgcount2++;
+      }
+    }
+
+    uint64_t read_u64() const {
+      uint64_t v = u64;
+      for (unsigned i = 0; i < num_shards; ++i)
+	v += shards[i * shard_stride].u64.load(std::memory_order_relaxed);
+      return v;
     }
 
     // read <sum, count> safely by making sure the post- and pre-count
     // are identical; in other words the whole loop needs to be run
-    // without any intervening calls to inc, set, or tinc.
+    // without any intervening calls to inc, set, or tinc.  shards are
+    // read the same way, one at a time, and added up.
     std::pair<uint64_t,uint64_t> read_avg() const {
       uint64_t sum, count;
       do {
 	count = avgcount2;
 	sum = u64;
       } while (avgcount != count);
+      for (unsigned i = 0; i < num_shards; ++i) {
+	auto& s = shards[i * shard_stride];
+	uint64_t ssum, scount;
+	do {
+	  scount = s.avgcount2;
+	  ssum = s.u64;
+	} while (s.avgcount != scount);
+	sum += ssum;
+	count += scount;
+      }
       return { sum, count };
     }
   };
@@ -255,6 +352,8 @@ public:
     dump_formatted_generic(f, schema, true, counter);
   }
   std::pair<uint64_t, uint64_t> get_tavg_ns(int idx) const;
+  /// for add_time_avg_hist() counters, see PerfHdrHistogram::get_quantile()
+  uint64_t get_tquantile_ns(int idx, double q) const;
 
   const std::string& get_name() const;
   void set_name(std::string s) {
@@ -296,6 +395,7 @@ private:
 #endif
 
   perf_counter_data_vec_t m_data;
+  std::unique_ptr<perf_counter_shard_d[]> m_shards;
 
   friend class PerfCountersBuilder;
   friend class PerfCountersCollectionImpl;
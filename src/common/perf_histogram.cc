@@ -14,6 +14,7 @@
 
 #include "common/perf_histogram.h"
 
+#include <cmath>
 #include <limits>
 
 void PerfHistogramCommon::dump_formatted_axis(
@@ -119,3 +120,80 @@ PerfHistogramCommon::get_axis_bucket_ranges(
   ret.back().second = std::numeric_limits<int64_t>::max();
   return ret;
 }
+
+unsigned PerfHdrHistogram::get_bucket(uint64_t value) {
+  if (value < (1ull << SUB_BUCKET_BITS)) {
+    return value;
+  }
+  unsigned msb = 63 - __builtin_clzll(value);
+  if (msb >= MAX_VALUE_BITS) {
+    return NUM_BUCKETS - 1;
+  }
+  unsigned shift = msb - SUB_BUCKET_BITS;
+  unsigned sub = (value >> shift) & ((1u << SUB_BUCKET_BITS) - 1);
+  return ((shift + 1) << SUB_BUCKET_BITS) + sub;
+}
+
+uint64_t PerfHdrHistogram::get_bucket_max(unsigned bucket) {
+  if (bucket >= NUM_BUCKETS - 1) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  if (bucket < (1u << SUB_BUCKET_BITS)) {
+    return bucket;
+  }
+  unsigned shift = (bucket >> SUB_BUCKET_BITS) - 1;
+  uint64_t sub = bucket & ((1u << SUB_BUCKET_BITS) - 1);
+  uint64_t min = ((1ull << SUB_BUCKET_BITS) + sub) << shift;
+  return min + (1ull << shift) - 1;
+}
+
+uint64_t PerfHdrHistogram::get_count() const {
+  uint64_t count = 0;
+  for (unsigned i = 0; i < NUM_BUCKETS; ++i) {
+    count += read_bucket(i);
+  }
+  return count;
+}
+
+uint64_t PerfHdrHistogram::get_quantile(double q) const {
+  uint64_t counts[NUM_BUCKETS];
+  uint64_t total = 0;
+  for (unsigned i = 0; i < NUM_BUCKETS; ++i) {
+    counts[i] = read_bucket(i);
+    total += counts[i];
+  }
+  if (!total) {
+    return 0;
+  }
+  uint64_t want = std::max<uint64_t>(1, std::ceil(q * total));
+  uint64_t seen = 0;
+  for (unsigned i = 0; i < NUM_BUCKETS; ++i) {
+    seen += counts[i];
+    if (seen >= want) {
+      return get_bucket_max(i);
+    }
+  }
+  return get_bucket_max(NUM_BUCKETS - 1);
+}
+
+std::vector<std::pair<uint32_t, uint64_t>>
+PerfHdrHistogram::get_nonempty_buckets() const {
+  std::vector<std::pair<uint32_t, uint64_t>> ret;
+  for (unsigned i = 0; i < NUM_BUCKETS; ++i) {
+    if (uint64_t count = read_bucket(i); count) {
+      ret.emplace_back(i, count);
+    }
+  }
+  return ret;
+}
+
+void PerfHdrHistogram::dump_formatted(ceph::Formatter *f) const {
+  f->open_array_section("buckets");
+  for (auto [bucket, count] : get_nonempty_buckets()) {
+    f->open_object_section("bucket");
+    f->dump_unsigned("max", get_bucket_max(bucket));
+    f->dump_unsigned("count", count);
+    f->close_section();
+  }
+  f->close_section();
+}
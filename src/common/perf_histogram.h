@@ -18,6 +18,7 @@
 #include <array>
 #include <atomic>
 #include <memory>
+#include <vector>
 
 #include "common/Formatter.h"
 #include "include/int_types.h"
@@ -224,4 +225,63 @@ protected:
   }
 };
 
+/// PerfHdrHistogram traces a distribution of non-negative values, such as
+/// latencies in nanoseconds, in log-linear buckets: every power of two is
+/// split into 2^SUB_BUCKET_BITS buckets of equal width, so a value is known
+/// to within 1/2^SUB_BUCKET_BITS of itself whatever its magnitude.  Values
+/// of 2^MAX_VALUE_BITS and above all land in the last bucket.  The buckets
+/// are the same for every histogram, so histograms can be merged by adding
+/// up their buckets.
+class PerfHdrHistogram {
+public:
+  static constexpr unsigned SUB_BUCKET_BITS = 3;
+  static constexpr unsigned MAX_VALUE_BITS = 40;
+  static constexpr unsigned NUM_BUCKETS =
+    (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS;
+
+  PerfHdrHistogram() = default;
+  PerfHdrHistogram(const PerfHdrHistogram &other) {
+    merge(other);
+  }
+
+  static unsigned get_bucket(uint64_t value);
+  /// Largest value that lands in the given bucket
+  static uint64_t get_bucket_max(unsigned bucket);
+
+  void inc(uint64_t value) {
+    m_buckets[get_bucket(value)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  uint64_t read_bucket(unsigned bucket) const {
+    return m_buckets[bucket].load(std::memory_order_relaxed);
+  }
+
+  void reset() {
+    for (auto &b : m_buckets) {
+      b = 0;
+    }
+  }
+
+  void merge(const PerfHdrHistogram &other) {
+    for (unsigned i = 0; i < NUM_BUCKETS; ++i) {
+      m_buckets[i] += other.read_bucket(i);
+    }
+  }
+
+  uint64_t get_count() const;
+
+  /// Smallest bucket bound that at least a fraction q of the values are
+  /// known to be below or at
+  uint64_t get_quantile(double q) const;
+
+  /// <bucket, count> of every non-empty bucket
+  std::vector<std::pair<uint32_t, uint64_t>> get_nonempty_buckets() const;
+
+  /// Dump non-empty buckets, with the largest value of each, to a Formatter
+  void dump_formatted(ceph::Formatter *f) const;
+
+private:
+  std::array<std::atomic<uint64_t>, NUM_BUCKETS> m_buckets = {};
+};
+
 #endif
@@ -15,10 +15,12 @@
 #ifndef CEPH_COMPRESSOR_H
 #define CEPH_COMPRESSOR_H
 
+#include <cerrno>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 #include "include/ceph_assert.h"    // boost clobbers this
 #include "include/common_fwd.h"
 #include "include/buffer.h"
@@ -96,6 +98,59 @@ public:
   // alignment with decode methods
   virtual int decompress(ceph::bufferlist::const_iterator &p, size_t compressed_len, ceph::bufferlist &out, std::optional<int32_t> compressor_message) = 0;
 
+  /**
+   * A compression context that keeps its history across calls, so that
+   * each buffer can back-reference the data that preceded it.  Buffers
+   * must be decompressed by the peer context in exactly the order they
+   * were compressed; a context is used for one direction only.
+   */
+  class StreamContext {
+  public:
+    virtual ~StreamContext() {}
+    virtual int compress(const ceph::bufferlist &in, ceph::bufferlist &out) = 0;
+    virtual int decompress(const ceph::bufferlist &in, ceph::bufferlist &out) = 0;
+  };
+  using StreamContextRef = std::unique_ptr<StreamContext>;
+
+  /**
+   * @param window bytes of history a buffer may reference
+   * @returns nullptr if the algorithm has no streaming mode
+   */
+  virtual StreamContextRef create_stream_context(size_t window) {
+    return nullptr;
+  }
+
+  /**
+   * A compression context primed with a dictionary, for buffers too
+   * small to find much redundancy on their own.  The context is
+   * immutable once created, and may be shared between threads.
+   */
+  class DictionaryContext {
+  public:
+    virtual ~DictionaryContext() {}
+    virtual int compress(const ceph::bufferlist &in, ceph::bufferlist &out) const = 0;
+    virtual int decompress(const ceph::bufferlist &in, ceph::bufferlist &out) const = 0;
+  };
+  using DictionaryContextRef = std::shared_ptr<const DictionaryContext>;
+
+  /**
+   * @param samples buffers representative of the data to compress
+   * @param max_size upper bound on the size of the dictionary
+   * @returns -EOPNOTSUPP if the algorithm has no dictionary mode
+   */
+  virtual int train_dictionary(const std::vector<ceph::bufferlist> &samples,
+			       size_t max_size, ceph::bufferlist &dict) {
+    return -EOPNOTSUPP;
+  }
+
+  /**
+   * @returns nullptr if the algorithm has no dictionary mode, or the
+   * dictionary is not usable
+   */
+  virtual DictionaryContextRef create_dictionary_context(const ceph::bufferlist &dict) {
+    return nullptr;
+  }
+
   static CompressorRef create(CephContext *cct, const std::string &type);
   static CompressorRef create(CephContext *cct, int alg);
 
@@ -15,7 +15,11 @@
 #ifndef CEPH_LZ4COMPRESSOR_H
 #define CEPH_LZ4COMPRESSOR_H
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
 #include <optional>
+#include <vector>
 #include <lz4.h>
 
 #include "compressor/Compressor.h"
@@ -24,6 +28,93 @@
 #include "common/config.h"
 
 
+// LZ4 keeps at most 64 KiB of history.  Both directions copy the
+// plaintext into a buffer of twice the window so that every block is
+// compressed (and decompressed) right behind the history it may
+// reference; when the buffer fills, the last window is slid to the
+// front.  A buffer is encoded as its length followed by one
+// (compressed length, data) pair per window-sized block.
+class LZ4StreamContext : public Compressor::StreamContext {
+ public:
+  explicit LZ4StreamContext(size_t window)
+    : window(std::clamp<size_t>(window, 4 << 10, 64 << 10)),
+      history(2 * this->window) {}
+
+  int compress(const ceph::buffer::list &src, ceph::buffer::list &dst) override {
+    using ceph::encode;
+    if (!stream) {
+      stream = std::make_unique<LZ4_stream_t>();
+      LZ4_resetStream(stream.get());
+    }
+    encode((uint32_t)src.length(), dst);
+    ceph::buffer::ptr outptr = ceph::buffer::create_small_page_aligned(
+      LZ4_compressBound(window));
+    auto p = src.begin();
+    for (size_t left = src.length(); left > 0; ) {
+      const size_t len = std::min(left, window);
+      if (pos + len > history.size()) {
+	// must slide exactly as the decompressing side does
+	const size_t keep = std::min(pos, window);
+	LZ4_saveDict(stream.get(), history.data(), keep);
+	pos = keep;
+      }
+      p.copy(len, history.data() + pos);
+      int compressed_len = LZ4_compress_fast_continue(
+	stream.get(), history.data() + pos, outptr.c_str(), len,
+	outptr.length(), 1);
+      if (compressed_len <= 0) {
+	return -1;
+      }
+      pos += len;
+      left -= len;
+      encode((uint32_t)compressed_len, dst);
+      dst.append(outptr.c_str(), compressed_len);
+    }
+    return 0;
+  }
+
+  int decompress(const ceph::buffer::list &src, ceph::buffer::list &dst) override {
+    using ceph::decode;
+    auto p = src.cbegin();
+    uint32_t total;
+    decode(total, p);
+    ceph::buffer::ptr dstptr(total);
+    std::vector<char> in;
+    for (size_t off = 0; off < total; ) {
+      const size_t len = std::min<size_t>(total - off, window);
+      uint32_t compressed_len;
+      decode(compressed_len, p);
+      in.resize(compressed_len);
+      p.copy(compressed_len, in.data());
+      if (pos + len > history.size()) {
+	const size_t keep = std::min(pos, window);
+	std::memmove(history.data(), history.data() + pos - keep, keep);
+	pos = keep;
+      }
+      int r = LZ4_decompress_safe_usingDict(
+	in.data(), history.data() + pos, compressed_len, len,
+	history.data(), pos);
+      if (r != (int)len) {
+	return -1;
+      }
+      std::memcpy(dstptr.c_str() + off, history.data() + pos, len);
+      pos += len;
+      off += len;
+    }
+    if (!p.end()) {
+      return -1;
+    }
+    dst.push_back(std::move(dstptr));
+    return 0;
+  }
+
+ private:
+  const size_t window;
+  std::vector<char> history;
+  size_t pos = 0;
+  std::unique_ptr<LZ4_stream_t> stream;
+};
+
 class LZ4Compressor : public Compressor {
  public:
   LZ4Compressor(CephContext* cct) : Compressor(COMP_ALG_LZ4, "lz4") {
@@ -142,6 +233,10 @@ class LZ4Compressor : public Compressor {
     dst.push_back(std::move(dstptr));
     return 0;
   }
+
+  StreamContextRef create_stream_context(size_t window) override {
+    return std::make_unique<LZ4StreamContext>(window);
+  }
 };
 
 #endif
@@ -15,13 +15,219 @@
 #ifndef CEPH_ZSTDCOMPRESSOR_H
 #define CEPH_ZSTDCOMPRESSOR_H
 
+#include <algorithm>
+#include <bit>
+
 #define ZSTD_STATIC_LINKING_ONLY
 #include "zstd/lib/zstd.h"
+#include "zstd/lib/zdict.h"
 
 #include "include/buffer.h"
 #include "include/encoding.h"
 #include "compressor/Compressor.h"
 
+// A single never-ending zstd frame per direction.  Each buffer is
+// flushed at a block boundary so the peer can decode it on arrival,
+// while matches may still reach back into earlier buffers.
+class ZstdStreamContext : public Compressor::StreamContext {
+ public:
+  ZstdStreamContext(int level, size_t window)
+    : level(level),
+      window_log(std::clamp<int>(std::bit_width(std::max<size_t>(window, 1) - 1),
+				 ZSTD_WINDOWLOG_MIN, ZSTD_WINDOWLOG_MAX)) {}
+  ~ZstdStreamContext() override {
+    ZSTD_freeCCtx(cctx);
+    ZSTD_freeDCtx(dctx);
+  }
+
+  int compress(const ceph::buffer::list &src, ceph::buffer::list &dst) override {
+    if (!cctx) {
+      cctx = ZSTD_createCCtx();
+      if (!cctx) {
+	return -ENOMEM;
+      }
+      ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level);
+      ZSTD_CCtx_setParameter(cctx, ZSTD_c_windowLog, window_log);
+    }
+
+    // prefix with decompressed length
+    ceph::encode((uint32_t)src.length(), dst);
+
+    ceph::buffer::ptr outptr = ceph::buffer::create_small_page_aligned(
+      ZSTD_compressBound(src.length()));
+    ZSTD_outBuffer_s outbuf{outptr.c_str(), outptr.length(), 0};
+    auto drain = [&] {
+      dst.append(outptr, 0, outbuf.pos);
+      outptr = ceph::buffer::create_small_page_aligned(ZSTD_CStreamOutSize());
+      outbuf = {outptr.c_str(), outptr.length(), 0};
+    };
+
+    for (const auto& bp : src.buffers()) {
+      ZSTD_inBuffer_s inbuf{bp.c_str(), bp.length(), 0};
+      while (inbuf.pos < inbuf.size) {
+	size_t r = ZSTD_compressStream2(cctx, &outbuf, &inbuf, ZSTD_e_continue);
+	if (ZSTD_isError(r)) {
+	  return -EINVAL;
+	}
+	if (outbuf.pos == outbuf.size) {
+	  drain();
+	}
+      }
+    }
+    ZSTD_inBuffer_s empty{nullptr, 0, 0};
+    for (;;) {
+      size_t r = ZSTD_compressStream2(cctx, &outbuf, &empty, ZSTD_e_flush);
+      if (ZSTD_isError(r)) {
+	return -EINVAL;
+      }
+      if (r == 0) {
+	break;
+      }
+      drain();
+    }
+    dst.append(outptr, 0, outbuf.pos);
+    return 0;
+  }
+
+  int decompress(const ceph::buffer::list &src, ceph::buffer::list &dst) override {
+    if (!dctx) {
+      dctx = ZSTD_createDCtx();
+      if (!dctx) {
+	return -ENOMEM;
+      }
+      ZSTD_DCtx_setParameter(dctx, ZSTD_d_windowLogMax, window_log);
+    }
+    if (src.length() < sizeof(uint32_t)) {
+      return -1;
+    }
+    auto p = src.cbegin();
+    uint32_t dst_len;
+    ceph::decode(dst_len, p);
+
+    ceph::buffer::ptr dstptr(dst_len);
+    ZSTD_outBuffer_s outbuf{dstptr.c_str(), dstptr.length(), 0};
+    size_t left = src.length() - sizeof(uint32_t);
+    while (left > 0) {
+      ZSTD_inBuffer_s inbuf{nullptr, 0, 0};
+      inbuf.size = p.get_ptr_and_advance(left, (const char**)&inbuf.src);
+      left -= inbuf.size;
+      while (inbuf.pos < inbuf.size) {
+	const size_t consumed = inbuf.pos;
+	size_t r = ZSTD_decompressStream(dctx, &outbuf, &inbuf);
+	if (ZSTD_isError(r) ||
+	    (inbuf.pos == consumed && outbuf.pos == outbuf.size)) {
+	  // corrupt, or more data than the length prefix announced
+	  return -1;
+	}
+      }
+    }
+    if (outbuf.pos != dst_len) {
+      return -1;
+    }
+    dst.append(std::move(dstptr));
+    return 0;
+  }
+
+ private:
+  const int level;
+  const int window_log;
+  ZSTD_CCtx *cctx = nullptr;
+  ZSTD_DCtx *dctx = nullptr;
+};
+
+// A trained dictionary, digested once for each direction.  Every call
+// gets its own context, so one instance serves any number of threads.
+class ZstdDictionaryContext : public Compressor::DictionaryContext {
+ public:
+  ZstdDictionaryContext(ZSTD_CDict *cdict, ZSTD_DDict *ddict)
+    : cdict(cdict), ddict(ddict) {}
+  ~ZstdDictionaryContext() override {
+    ZSTD_freeCDict(cdict);
+    ZSTD_freeDDict(ddict);
+  }
+
+  int compress(const ceph::buffer::list &src, ceph::buffer::list &dst) const override {
+    ZSTD_CCtx *cctx = ZSTD_createCCtx();
+    if (!cctx) {
+      return -ENOMEM;
+    }
+    ZSTD_CCtx_refCDict(cctx, cdict);
+    ZSTD_CCtx_setPledgedSrcSize(cctx, src.length());
+
+    ceph::buffer::ptr outptr = ceph::buffer::create_small_page_aligned(
+      ZSTD_compressBound(src.length()));
+    ZSTD_outBuffer_s outbuf{outptr.c_str(), outptr.length(), 0};
+    auto p = src.cbegin();
+    size_t left = src.length();
+    int ret = 0;
+    do {
+      ZSTD_inBuffer_s inbuf{nullptr, 0, 0};
+      inbuf.size = p.get_ptr_and_advance(left, (const char**)&inbuf.src);
+      left -= inbuf.size;
+      ZSTD_EndDirective const zed = (left==0) ? ZSTD_e_end : ZSTD_e_continue;
+      size_t r = ZSTD_compressStream2(cctx, &outbuf, &inbuf, zed);
+      if (ZSTD_isError(r)) {
+	ret = -EINVAL;
+	break;
+      }
+    } while (left);
+    ZSTD_freeCCtx(cctx);
+    if (ret < 0) {
+      return ret;
+    }
+
+    // prefix with decompressed length
+    ceph::encode((uint32_t)src.length(), dst);
+    dst.append(outptr, 0, outbuf.pos);
+    return 0;
+  }
+
+  int decompress(const ceph::buffer::list &src, ceph::buffer::list &dst) const override {
+    if (src.length() < sizeof(uint32_t)) {
+      return -1;
+    }
+    auto p = src.cbegin();
+    uint32_t dst_len;
+    ceph::decode(dst_len, p);
+
+    ZSTD_DCtx *dctx = ZSTD_createDCtx();
+    if (!dctx) {
+      return -ENOMEM;
+    }
+    ZSTD_DCtx_refDDict(dctx, ddict);
+
+    ceph::buffer::ptr dstptr(dst_len);
+    ZSTD_outBuffer_s outbuf{dstptr.c_str(), dstptr.length(), 0};
+    size_t left = src.length() - sizeof(uint32_t);
+    int ret = 0;
+    while (left > 0 && ret == 0) {
+      ZSTD_inBuffer_s inbuf{nullptr, 0, 0};
+      inbuf.size = p.get_ptr_and_advance(left, (const char**)&inbuf.src);
+      left -= inbuf.size;
+      while (inbuf.pos < inbuf.size) {
+	const size_t consumed = inbuf.pos;
+	size_t r = ZSTD_decompressStream(dctx, &outbuf, &inbuf);
+	if (ZSTD_isError(r) ||
+	    (inbuf.pos == consumed && outbuf.pos == outbuf.size)) {
+	  // corrupt, or more data than the length prefix announced
+	  ret = -1;
+	  break;
+	}
+      }
+    }
+    ZSTD_freeDCtx(dctx);
+    if (ret < 0 || outbuf.pos != dst_len) {
+      return -1;
+    }
+    dst.append(std::move(dstptr));
+    return 0;
+  }
+
+ private:
+  ZSTD_CDict *const cdict;
+  ZSTD_DDict *const ddict;
+};
+
 class ZstdCompressor : public Compressor {
  public:
   ZstdCompressor(CephContext *cct) : Compressor(COMP_ALG_ZSTD, "zstd"), cct(cct) {}
@@ -100,6 +306,49 @@ class ZstdCompressor : public Compressor {
     dst.append(dstptr, 0, outbuf.pos);
     return 0;
   }
+
+  StreamContextRef create_stream_context(size_t window) override {
+    return std::make_unique<ZstdStreamContext>(
+      cct->_conf->compressor_zstd_level, window);
+  }
+
+  int train_dictionary(const std::vector<ceph::buffer::list> &samples,
+		       size_t max_size, ceph::buffer::list &dict) override {
+    // the trainer wants the samples back to back, with their sizes
+    ceph::buffer::list all;
+    std::vector<size_t> sizes;
+    sizes.reserve(samples.size());
+    for (const auto& sample : samples) {
+      if (sample.length() > 0) {
+	all.append(sample);
+	sizes.push_back(sample.length());
+      }
+    }
+    if (sizes.empty()) {
+      return -EINVAL;
+    }
+    ceph::buffer::ptr dictptr(max_size);
+    size_t r = ZDICT_trainFromBuffer(dictptr.c_str(), dictptr.length(),
+				     all.c_str(), sizes.data(), sizes.size());
+    if (ZDICT_isError(r)) {
+      return -EINVAL;
+    }
+    dict.append(dictptr, 0, r);
+    return 0;
+  }
+
+  DictionaryContextRef create_dictionary_context(const ceph::buffer::list &dict) override {
+    ceph::buffer::list flat = dict;
+    ZSTD_CDict *cdict = ZSTD_createCDict(flat.c_str(), flat.length(),
+					 cct->_conf->compressor_zstd_level);
+    ZSTD_DDict *ddict = ZSTD_createDDict(flat.c_str(), flat.length());
+    if (!cdict || !ddict) {
+      ZSTD_freeCDict(cdict);
+      ZSTD_freeDDict(ddict);
+      return nullptr;
+    }
+    return std::make_shared<ZstdDictionaryContext>(cdict, ddict);
+  }
  private:
   CephContext *const cct;
 };
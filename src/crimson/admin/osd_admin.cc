@@ -490,6 +490,42 @@ private:
 template std::unique_ptr<AdminSocketHook>
 make_asok_hook<DumpInFlightOpsHook>(const crimson::osd::PGShardManager &);
 
+/**
+ * An OSD admin hook: dump how long ops waited to enter each pipeline
+ * stage, per core
+ */
+class DumpPipelineLatencyHook : public AdminSocketHook {
+public:
+  explicit DumpPipelineLatencyHook(const crimson::osd::PGShardManager &pg_shard_manager) :
+    AdminSocketHook{"dump_pipeline_latency", "",
+                    "show the latency of entering op pipeline stages"},
+    pg_shard_manager(pg_shard_manager)
+  {}
+  seastar::future<tell_result_t> call(const cmdmap_t&,
+				      std::string_view format,
+				      ceph::bufferlist&& input) const final
+  {
+    unique_ptr<Formatter> fref{
+      Formatter::create(format, "json-pretty", "json-pretty")};
+    auto *f = fref.get();
+    f->open_array_section("pipeline_latency");
+    return pg_shard_manager.invoke_on_each_shard_seq([f](const auto &) {
+      f->open_object_section("shard");
+      f->dump_unsigned("core", seastar::this_shard_id());
+      crimson::PipelineStageLatency::local().dump(f);
+      f->close_section();
+      return seastar::now();
+    }).then([fref=std::move(fref)]() mutable {
+      fref->close_section();
+      return seastar::make_ready_future<tell_result_t>(std::move(fref));
+    });
+  }
+private:
+  const crimson::osd::PGShardManager &pg_shard_manager;
+};
+template std::unique_ptr<AdminSocketHook>
+make_asok_hook<DumpPipelineLatencyHook>(const crimson::osd::PGShardManager &);
+
 
 class DumpHistoricOpsHook : public AdminSocketHook {
 public:
@@ -18,6 +18,7 @@ class InjectMDataErrorHook;
 class OsdStatusHook;
 class SendBeaconHook;
 class DumpInFlightOpsHook;
+class DumpPipelineLatencyHook;
 class DumpHistoricOpsHook;
 class DumpSlowestHistoricOpsHook;
 class DumpRecoveryReservationsHook;
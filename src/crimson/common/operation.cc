@@ -45,6 +45,77 @@ void Blocker::dump(ceph::Formatter* f) const
   f->close_section();
 }
 
+PipelineStageLatency& PipelineStageLatency::local()
+{
+  static thread_local PipelineStageLatency instance;
+  return instance;
+}
+
+void PipelineStageLatency::record(const char *stage, clock_t::duration wait)
+{
+  auto [it, inserted] = stages.try_emplace(stage);
+  auto &stats = it->second;
+  if (unlikely(inserted)) {
+    register_metrics(stage, stats);
+  }
+  uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+    wait).count();
+  stats.count++;
+  stats.sum_us += us;
+  size_t bucket = us <= 1 ? 0 : 64 - __builtin_clzll(us - 1);
+  stats.buckets[std::min(bucket, NUM_BUCKETS - 1)]++;
+}
+
+void PipelineStageLatency::register_metrics(
+  const char *stage,
+  const stage_stats_t &stats)
+{
+  namespace sm = seastar::metrics;
+  metrics.add_group("pipeline_stage", {
+    sm::make_histogram(
+      "enter_latency_us",
+      [&stats] {
+        seastar::metrics::histogram h;
+        h.sample_count = stats.count;
+        h.sample_sum = stats.sum_us;
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < NUM_BUCKETS - 1; ++i) {
+          cumulative += stats.buckets[i];
+          h.buckets.push_back({cumulative, double(1ull << i)});
+        }
+        return h;
+      },
+      sm::description("time ops waited to enter the pipeline stage, "
+                       "in microseconds"),
+      {sm::label_instance("stage", stage)}),
+  });
+}
+
+void PipelineStageLatency::dump(ceph::Formatter *f) const
+{
+  f->open_array_section("stages");
+  for (auto &[stage, stats] : stages) {
+    f->open_object_section("stage");
+    f->dump_string("name", stage);
+    f->dump_unsigned("count", stats.count);
+    f->dump_unsigned("sum_us", stats.sum_us);
+    f->open_array_section("buckets");
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+      if (stats.buckets[i]) {
+        f->open_object_section("bucket");
+        if (i < NUM_BUCKETS - 1) {
+          f->dump_unsigned("le_us", 1ull << i);
+        }
+        f->dump_unsigned("count", stats.buckets[i]);
+        f->close_section();
+      }
+    }
+    f->close_section();
+    f->close_section();
+  }
+  f->close_section();
+}
+
 namespace detail {
 void dump_time_event(const char* name,
 		     const utime_t& timestamp,
@@ -170,6 +170,21 @@ FrameAssemblerV2::read_exactly(std::size_t bytes)
   };
 }
 
+seastar::future<ceph::bufferptr>
+FrameAssemblerV2::read_exactly_aligned(std::size_t bytes, std::size_t align)
+{
+  assert(has_socket());
+  if (unlikely(record_io)) {
+    return socket->read_exactly_aligned(bytes, align
+    ).then([this](auto bp) {
+      rxbuf.append(bp);
+      return bp;
+    });
+  } else {
+    return socket->read_exactly_aligned(bytes, align);
+  }
+}
+
 seastar::future<ceph::bufferlist>
 FrameAssemblerV2::read(std::size_t bytes)
 {
@@ -241,15 +256,21 @@ FrameAssemblerV2::read_frame_payload()
       return rx_frame_asm.get_num_segments() == rx_segments_data.size();
     },
     [this] {
-      // TODO: create aligned and contiguous buffer from socket
       const size_t seg_idx = rx_segments_data.size();
+      uint32_t onwire_len = rx_frame_asm.get_segment_onwire_len(seg_idx);
       if (uint16_t alignment = rx_frame_asm.get_segment_align(seg_idx);
-          alignment != segment_t::DEFAULT_ALIGNMENT) {
-        logger().trace("{} cannot allocate {} aligned buffer at segment desc index {}",
-                       conn, alignment, rx_segments_data.size());
+          alignment != segment_t::DEFAULT_ALIGNMENT && onwire_len > 0) {
+        // the data segment: land it in a buffer the objectstore can write
+        // from as is, instead of realigning it later
+        return read_exactly_aligned(onwire_len, alignment
+        ).then([this](auto bp) {
+          logger().trace("{} RECV({}) aligned frame segment[{}]",
+                         conn, bp.length(), rx_segments_data.size());
+          bufferlist segment;
+          segment.append(std::move(bp));
+          rx_segments_data.emplace_back(std::move(segment));
+        });
       }
-      uint32_t onwire_len = rx_frame_asm.get_segment_onwire_len(seg_idx);
-      // TODO: create aligned and contiguous buffer from socket
       return read_exactly(onwire_len
       ).then([this](auto tmp_bl) {
         logger().trace("{} RECV({}) frame segment[{}]",
@@ -82,6 +82,9 @@ public:
 
   seastar::future<Socket::tmp_buf> read_exactly(std::size_t bytes);
 
+  seastar::future<ceph::bufferptr> read_exactly_aligned(
+    std::size_t bytes, std::size_t align);
+
   seastar::future<ceph::bufferlist> read(std::size_t bytes);
 
   seastar::future<> write(ceph::bufferlist &&);
@@ -3,6 +3,8 @@
 
 #include "Socket.h"
 
+#include <cstring>
+
 #include <seastar/core/sleep.hh>
 #include <seastar/core/when_all.hh>
 
@@ -59,6 +61,34 @@ struct bufferlist_consumer {
   };
 };
 
+// an input_stream consumer that copies buffer segments into a preallocated
+// buffer until it is full
+struct bufferptr_consumer {
+  bufferptr& bp;
+  size_t& filled;
+
+  bufferptr_consumer(bufferptr& bp, size_t& filled)
+    : bp(bp), filled(filled) {}
+
+  using tmp_buf = seastar::temporary_buffer<char>;
+  using consumption_result_type = typename seastar::input_stream<char>::consumption_result_type;
+
+  seastar::future<consumption_result_type> operator()(tmp_buf&& data) {
+    size_t n = std::min(data.size(), bp.length() - filled);
+    std::memcpy(bp.c_str() + filled, data.get(), n);
+    filled += n;
+    data.trim_front(n);
+    if (filled < bp.length()) {
+      // return none to request more segments
+      return seastar::make_ready_future<consumption_result_type>(
+          seastar::continue_consuming{});
+    }
+    // give the rest back to signal that we're done
+    return seastar::make_ready_future<consumption_result_type>(
+        consumption_result_type::stop_consuming_type{std::move(data)});
+  }
+};
+
 } // anonymous namespace
 
 seastar::future<bufferlist> Socket::read(size_t bytes)
@@ -118,6 +148,38 @@ Socket::read_exactly(size_t bytes) {
 #endif
 }
 
+seastar::future<ceph::bufferptr>
+Socket::read_exactly_aligned(size_t bytes, size_t align) {
+#ifdef UNIT_TESTS_BUILT
+  return try_trap_pre(next_trap_read).then([bytes, align, this] {
+#endif
+    if (bytes == 0) {
+      return seastar::make_ready_future<ceph::bufferptr>();
+    }
+    return seastar::do_with(
+      ceph::bufferptr(buffer::create_aligned(bytes, align)), size_t{0},
+      [this](auto& bp, auto& filled) {
+      return in.consume(bufferptr_consumer{bp, filled}
+      ).then([&bp, &filled] {
+        if (filled < bp.length()) { // throw on short reads
+          throw std::system_error(make_error_code(error::read_eof));
+        }
+        inject_failure();
+        return inject_delay().then([&bp] {
+          return seastar::make_ready_future<ceph::bufferptr>(std::move(bp));
+        });
+      });
+    });
+#ifdef UNIT_TESTS_BUILT
+  }).then([this] (auto bp) {
+    return try_trap_post(next_trap_read
+    ).then([bp = std::move(bp)] () mutable {
+      return std::move(bp);
+    });
+  });
+#endif
+}
+
 void Socket::shutdown() {
   socket_is_shutdown = true;
   socket.shutdown_input();
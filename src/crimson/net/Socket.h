@@ -71,6 +71,10 @@ class Socket
   using tmp_buf = seastar::temporary_buffer<char>;
   using packet = seastar::net::packet;
   seastar::future<tmp_buf> read_exactly(size_t bytes);
+  /// read the requested number of bytes into a new contiguous buffer
+  /// starting at the given alignment
+  seastar::future<ceph::bufferptr> read_exactly_aligned(
+    size_t bytes, size_t align);
 
   seastar::future<> write(packet&& buf) {
 #ifdef UNIT_TESTS_BUILT
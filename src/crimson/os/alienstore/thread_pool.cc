@@ -13,6 +13,25 @@ using crimson::common::local_conf;
 
 namespace crimson::os {
 
+SubmitQueue::SubmitQueue(size_t num_free_slots)
+  : free_slots(num_free_slots)
+{
+  namespace sm = seastar::metrics;
+  metrics.add_group("alienstore_thread_pool", {
+    sm::make_counter("tasks", stats.tasks,
+                     sm::description("tasks completed by the alien threads")),
+    sm::make_counter("queue_wait_us", stats.queue_wait_us,
+                     sm::description("total time tasks waited for an alien "
+                                     "thread to pick them up, in microseconds")),
+    sm::make_counter("exec_us", stats.exec_us,
+                     sm::description("total time alien threads spent running "
+                                     "tasks, in microseconds")),
+    sm::make_counter("completion_wait_us", stats.completion_wait_us,
+                     sm::description("total time from a task finishing until "
+                                     "the reactor resumed it, in microseconds")),
+  });
+}
+
 ThreadPool::ThreadPool(size_t n_threads,
                        size_t queue_sz,
                        const std::optional<seastar::resource::cpuset>& cpus)
@@ -3,13 +3,16 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <tuple>
 #include <type_traits>
 #include <boost/lockfree/queue.hpp>
 #include <boost/optional.hpp>
+#include <seastar/core/alien.hh>
 #include <seastar/core/future.hh>
 #include <seastar/core/gate.hh>
+#include <seastar/core/metrics.hh>
 #include <seastar/core/reactor.hh>
 #include <seastar/core/resource.hh>
 #include <seastar/core/semaphore.hh>
@@ -39,11 +42,15 @@ struct Task final : WorkItem {
                        seastar::internal::future_stored_type_t<>,
                        seastar::internal::future_stored_type_t<T>>;
   using futurator_t = seastar::futurize<T>;
+  using clock_t = std::chrono::steady_clock;
 public:
   explicit Task(Func&& f)
-    : func(std::move(f))
+    : func(std::move(f)),
+      alien(seastar::engine().alien()),
+      shard(seastar::this_shard_id())
   {}
   void process() override {
+    started = clock_t::now();
     try {
       if constexpr (std::is_void_v<T>) {
         func();
@@ -54,10 +61,15 @@ public:
     } catch (...) {
       state.set_exception(std::current_exception());
     }
-    on_done.write_side().signal(1);
+    finished = clock_t::now();
+    // the reactor drains its alien queue in batches when it polls, so
+    // this costs neither a syscall nor a wakeup per task when it is busy
+    seastar::alien::run_on(alien, shard, [this]() noexcept {
+      on_done.set_value();
+    });
   }
   typename futurator_t::type get_future() {
-    return on_done.wait().then([this](size_t) {
+    return on_done.get_future().then([this] {
       if (state.failed()) {
         return futurator_t::make_exception_future(state.get_exception());
       } else {
@@ -65,21 +77,46 @@ public:
       }
     });
   }
+  const clock_t::time_point queued = clock_t::now();
+  clock_t::time_point started;
+  clock_t::time_point finished;
 private:
   Func func;
   seastar::future_state<future_stored_type_t> state;
-  seastar::readable_eventfd on_done;
+  seastar::promise<> on_done;
+  seastar::alien::instance& alien;
+  const unsigned shard;
 };
 
 struct SubmitQueue {
   seastar::semaphore free_slots;
   seastar::gate pending_tasks;
-  explicit SubmitQueue(size_t num_free_slots)
-    : free_slots(num_free_slots)
-  {}
+  explicit SubmitQueue(size_t num_free_slots);
   seastar::future<> stop() {
     return pending_tasks.close();
   }
+  template<typename TaskT>
+  void account(const TaskT& task) {
+    using namespace std::chrono;
+    auto now = TaskT::clock_t::now();
+    stats.tasks++;
+    stats.queue_wait_us +=
+      duration_cast<microseconds>(task.started - task.queued).count();
+    stats.exec_us +=
+      duration_cast<microseconds>(task.finished - task.started).count();
+    stats.completion_wait_us +=
+      duration_cast<microseconds>(now - task.finished).count();
+  }
+private:
+  struct {
+    uint64_t tasks = 0;
+    // time spent waiting for a worker to pick the task up
+    uint64_t queue_wait_us = 0;
+    uint64_t exec_us = 0;
+    // time from the worker finishing until the reactor saw it
+    uint64_t completion_wait_us = 0;
+  } stats;
+  seastar::metrics::metric_group metrics;
 };
 
 struct ShardedWorkQueue {
@@ -147,6 +184,7 @@ public:
             auto fut = task->get_future();
             pending_queues[shard].push_back(task);
             return fut.finally([task, this] {
+              submit_queue.local().account(*task);
               local_free_slots().signal();
               delete task;
             });
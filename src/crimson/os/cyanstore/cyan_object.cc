@@ -1,76 +1,130 @@
 #include "cyan_object.h"
+
+#include <algorithm>
+
 #include "include/encoding.h"
 
 namespace crimson::os {
 
 size_t Object::get_size() const {
-  return data.length();
+  return size;
 }
 
-ceph::bufferlist Object::read(uint64_t offset, uint64_t len)
+void Object::punch_hole(uint64_t offset, uint64_t len)
 {
-  bufferlist ret;
-  ret.substr_of(data, offset, len);
-  return ret;
+  const uint64_t end = offset + len;
+  auto p = extents.lower_bound(offset);
+  if (p != extents.begin()) {
+    auto prev = std::prev(p);
+    const uint64_t prev_end = prev->first + prev->second.length();
+    if (prev_end > offset) {
+      // keep the head of the extent starting before the hole
+      if (prev_end > end) {
+        bufferlist tail;
+        tail.substr_of(prev->second, end - prev->first, prev_end - end);
+        extents.emplace(end, std::move(tail));
+      }
+      bufferlist head;
+      head.substr_of(prev->second, 0, offset - prev->first);
+      prev->second = std::move(head);
+    }
+  }
+  while (p != extents.end() && p->first < end) {
+    const uint64_t p_end = p->first + p->second.length();
+    if (p_end > end) {
+      // keep the tail of the extent ending after the hole
+      bufferlist tail;
+      tail.substr_of(p->second, end - p->first, p_end - end);
+      extents.emplace(end, std::move(tail));
+    }
+    p = extents.erase(p);
+  }
 }
 
-int Object::write(uint64_t offset, const bufferlist &src)
+ceph::bufferlist Object::read(uint64_t offset, uint64_t len) const
 {
-  unsigned len = src.length();
-  // before
-  bufferlist newdata;
-  if (get_size() >= offset) {
-    newdata.substr_of(data, 0, offset);
-  } else {
-    if (get_size()) {
-      newdata.substr_of(data, 0, get_size());
+  bufferlist ret;
+  const uint64_t end = offset + len;
+  uint64_t pos = offset;
+  auto p = extents.upper_bound(offset);
+  if (p != extents.begin()) {
+    --p;
+  }
+  for (; p != extents.end() && p->first < end; ++p) {
+    const uint64_t p_end = p->first + p->second.length();
+    if (p_end <= pos) {
+      continue;
+    }
+    if (p->first > pos) {
+      ret.append_zero(p->first - pos);
+      pos = p->first;
     }
-    newdata.append_zero(offset - get_size());
+    const uint64_t n = std::min(p_end, end) - pos;
+    bufferlist bl;
+    bl.substr_of(p->second, pos - p->first, n);
+    ret.claim_append(bl);
+    pos += n;
   }
-
-  newdata.append(src);
-
-  // after
-  if (get_size() > offset + len) {
-    bufferlist tail;
-    tail.substr_of(data, offset + len, get_size() - (offset + len));
-    newdata.append(tail);
+  if (pos < end) {
+    ret.append_zero(end - pos);
   }
+  return ret;
+}
 
-  data = std::move(newdata);
+int Object::write(uint64_t offset, const bufferlist &src)
+{
+  const uint64_t len = src.length();
+  if (len == 0) {
+    return 0;
+  }
+  punch_hole(offset, len);
+  extents.emplace(offset, src);
+  size = std::max(size, offset + len);
   return 0;
 }
 
 int Object::clone(Object *src, uint64_t srcoff, uint64_t len,
                   uint64_t dstoff)
 {
-  bufferlist bl;
   if (srcoff == dstoff && len == src->get_size()) {
-    data = src->data;
+    extents = src->extents;
+    size = src->size;
     return 0;
   }
-  bl.substr_of(src->data, srcoff, len);
-  return write(dstoff, bl);
-
+  return write(dstoff, src->read(srcoff, len));
 }
 
-int Object::truncate(uint64_t size)
+int Object::truncate(uint64_t new_size)
 {
-  if (get_size() > size) {
-    bufferlist bl;
-    bl.substr_of(data, 0, size);
-    data = std::move(bl);
-  } else if (get_size() == size) {
-    // do nothing
-  } else {
-    data.append_zero(size - get_size());
+  if (size > new_size) {
+    punch_hole(new_size, size - new_size);
   }
+  size = new_size;
   return 0;
 }
 
+std::map<uint64_t, uint64_t> Object::fiemap(uint64_t offset,
+                                            uint64_t len) const
+{
+  std::map<uint64_t, uint64_t> m;
+  const uint64_t end = std::min<uint64_t>(offset + len, size);
+  auto p = extents.upper_bound(offset);
+  if (p != extents.begin()) {
+    --p;
+  }
+  for (; p != extents.end() && p->first < end; ++p) {
+    const uint64_t start = std::max(p->first, offset);
+    const uint64_t p_end = std::min(p->first + p->second.length(), end);
+    if (p_end > start) {
+      m.emplace(start, p_end - start);
+    }
+  }
+  return m;
+}
+
 void Object::encode(bufferlist& bl) const {
   ENCODE_START(1, 1, bl);
-  encode(data, bl);
+  encode(read(0, size), bl);
   encode(xattr, bl);
   encode(omap_header, bl);
   encode(omap, bl);
@@ -79,7 +133,13 @@ void Object::encode(bufferlist& bl) const {
 
 void Object::decode(bufferlist::const_iterator& p) {
   DECODE_START(1, p);
+  bufferlist data;
   decode(data, p);
+  extents.clear();
+  size = data.length();
+  if (size) {
+    extents.emplace(0, std::move(data));
+  }
   decode(xattr, p);
   decode(omap_header, p);
   decode(omap, p);
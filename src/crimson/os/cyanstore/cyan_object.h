@@ -18,7 +18,11 @@ struct Object : public boost::intrusive_ref_counter<
 {
   using bufferlist = ceph::bufferlist;
 
-  bufferlist data;
+  // object data as non-overlapping extents keyed by their offset; the
+  // gaps between them read as zeros.  overwrites only touch the extents
+  // they overlap instead of rebuilding the whole object.
+  std::map<uint64_t, bufferlist> extents;
+  uint64_t size = 0;
   // use transparent comparator for better performance, see
   // https://en.cppreference.com/w/cpp/utility/functional/less_void
   std::map<std::string,bufferlist,std::less<>> xattr;
@@ -31,14 +35,19 @@ struct Object : public boost::intrusive_ref_counter<
 
   // interface for object data
   size_t get_size() const;
-  ceph::bufferlist read(uint64_t offset, uint64_t len);
+  ceph::bufferlist read(uint64_t offset, uint64_t len) const;
   int write(uint64_t offset, const bufferlist &bl);
   int clone(Object *src, uint64_t srcoff, uint64_t len,
 	     uint64_t dstoff);
   int truncate(uint64_t offset);
+  std::map<uint64_t, uint64_t> fiemap(uint64_t offset, uint64_t len) const;
 
   void encode(bufferlist& bl) const;
   void decode(bufferlist::const_iterator& p);
+private:
+  // drop the data in [offset, offset + len), splitting the extents that
+  // straddle either end
+  void punch_hole(uint64_t offset, uint64_t len);
 };
 using ObjectRef = boost::intrusive_ptr<Object>;
 
@@ -928,8 +928,8 @@ CyanStore::ShardStores::fiemap(
   if (!o) {
     throw std::runtime_error(fmt::format("object does not exist: {}", oid));
   }
-  std::map<uint64_t, uint64_t> m{{0, o->get_size()}};
-  return seastar::make_ready_future<std::map<uint64_t, uint64_t>>(std::move(m));
+  return seastar::make_ready_future<std::map<uint64_t, uint64_t>>(
+    o->fiemap(off, len));
 }
 
 seastar::future<struct stat>
@@ -20,13 +20,7 @@ FuturizedStore::create(const std::string& type,
     return seastar::make_ready_future<std::unique_ptr<FuturizedStore>>(
       std::make_unique<CyanStore>(data));
   } else if (type == "seastore") {
-    return crimson::os::seastore::make_seastore(
-      data, values
-    ).then([] (auto seastore) {
-      return seastar::make_ready_future<std::unique_ptr<FuturizedStore>>(
-	std::make_unique<ShardedStoreProxy<seastore::SeaStore>>(
-	  seastore.release()));
-    });
+    return crimson::os::seastore::make_sharded_seastore(data, values);
   } else {
     using crimson::os::AlienStore;
 #ifdef WITH_BLUESTORE
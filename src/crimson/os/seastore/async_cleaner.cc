@@ -941,6 +941,10 @@ void SegmentCleaner::register_metrics()
     sm::make_gauge("reclaim_ratio",
                    [this] { return get_reclaim_ratio(); },
                    sm::description("ratio of reclaimable space to unavailable space")),
+    sm::make_gauge("write_amplification",
+                   [this] { return get_write_amplification(); },
+                   sm::description("ratio of bytes written to closed segments to "
+                                   "bytes not rewritten by reclaim")),
 
     sm::make_histogram("segment_utilization_distribution",
 		       [this]() -> seastar::metrics::histogram& {
@@ -948,6 +952,18 @@ void SegmentCleaner::register_metrics()
 		       },
 		       sm::description("utilization distribution of all segments"))
   });
+
+  for (rewrite_gen_t gen = MIN_REWRITE_GENERATION;
+       gen <= MAX_REWRITE_GENERATION;
+       ++gen) {
+    metrics.add_group("segment_cleaner", {
+      sm::make_counter("reclaimed_bytes_by_generation",
+                       stats.reclaimed_bytes_by_gen[gen],
+                       sm::description("rewritten bytes due to reclaim, by the "
+                                       "generation rewritten to"),
+                       {sm::label_instance("generation", std::to_string(gen))})
+    });
+  }
 }
 
 segment_id_t SegmentCleaner::allocate_segment(
@@ -1211,6 +1227,9 @@ SegmentCleaner::clean_space_ret SegmentCleaner::clean_space()
                segment_to_release,
                stats.reclaiming_bytes/(double)segments.get_segment_size());
           stats.reclaimed_bytes += stats.reclaiming_bytes;
+          stats.reclaimed_bytes_by_gen[std::min(
+            reclaim_state->target_generation,
+            MAX_REWRITE_GENERATION)] += stats.reclaiming_bytes;
           stats.reclaimed_segment_bytes += segments.get_segment_size();
           stats.reclaiming_bytes = 0;
           reclaim_state.reset();
@@ -1479,6 +1479,13 @@ private:
   double get_alive_ratio() const {
     return stats.used_bytes / (double)segments.get_total_bytes();
   }
+  /// bytes written to closed segments per byte not written by reclaim
+  double get_write_amplification() const {
+    auto written = stats.closed_journal_total_bytes +
+                   stats.closed_ool_total_bytes;
+    if (written <= stats.reclaimed_bytes) return 1;
+    return (double)written / (double)(written - stats.reclaimed_bytes);
+  }
 
   /*
    * Space calculations (projected)
@@ -1560,6 +1567,8 @@ private:
     uint64_t reclaiming_bytes = 0;
     uint64_t reclaimed_bytes = 0;
     uint64_t reclaimed_segment_bytes = 0;
+    /// rewritten bytes due to reclaim, by the generation rewritten to
+    std::array<uint64_t, REWRITE_GENERATIONS> reclaimed_bytes_by_gen = {};
 
     seastar::metrics::histogram segment_util;
   } stats;
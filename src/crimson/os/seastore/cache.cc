@@ -41,7 +41,9 @@ Cache::Cache(
   ExtentPlacementManager &epm)
   : epm(epm),
     lru(crimson::common::get_conf<Option::size_t>(
-	  "seastore_cache_lru_size"))
+	  "seastore_cache_lru_size"),
+	crimson::common::get_conf<double>(
+	  "seastore_cache_metadata_max_ratio"))
 {
   LOG_PREFIX(Cache::Cache);
   INFO("created, lru_size={}", lru.get_capacity());
@@ -198,6 +200,29 @@ void Cache::register_metrics()
     );
   }
 
+  for (auto& [ext, ext_label] : labels_by_ext) {
+    if (ext == extent_types_t::RETIRED_PLACEHOLDER) {
+      continue;
+    }
+    metrics.add_group(
+      "cache",
+      {
+        sm::make_counter(
+          "cache_access_by_ext",
+          get_by_ext(stats.cache_query_by_ext, ext).access,
+          sm::description("total number of cache accesses by extent type"),
+          {ext_label}
+        ),
+        sm::make_counter(
+          "cache_hit_by_ext",
+          get_by_ext(stats.cache_query_by_ext, ext).hit,
+          sm::description("total number of cache hits by extent type"),
+          {ext_label}
+        ),
+      }
+    );
+  }
+
   {
     /*
      * efforts discarded/committed
@@ -492,6 +517,20 @@ void Cache::register_metrics()
 	},
 	sm::description("total extents pinned by the lru")
       ),
+      sm::make_counter(
+	"cache_lru_metadata_bytes",
+	[this] {
+	  return lru.get_current_metadata_bytes();
+	},
+	sm::description("total bytes of metadata extents pinned by the lru")
+      ),
+      sm::make_counter(
+	"cache_lru_protected_bytes",
+	[this] {
+	  return lru.get_current_protected_bytes();
+	},
+	sm::description("total bytes of data extents hit again while in the lru")
+      ),
     }
   );
 
@@ -1025,19 +1025,99 @@ private:
    *
    * holds references to recently used extents
    */
+  /**
+   * LRU
+   *
+   * Keeps clean extents in memory within a byte budget, in three lists:
+   *
+   * - metadata: every non-data extent, most importantly the tree nodes.
+   *   They are evicted only once the data lists are empty, or once they
+   *   take more than metadata_max_ratio of the budget, so that a large
+   *   read does not push the trees out of memory.
+   * - data probation: data extents accessed once since they were
+   *   admitted.  Evicted first, so a scan only cycles through here.
+   * - data protected: data extents accessed again while on probation.
+   *   Limited to PROTECTED_RATIO of the data in the lru; extents that
+   *   overflow are moved back to probation.
+   */
   class LRU {
+    static constexpr double PROTECTED_RATIO = 0.75;
+
     // max size (bytes)
     const size_t capacity = 0;
+    // max size of the metadata list (bytes)
+    const size_t metadata_capacity = 0;
 
     // current size (bytes)
     size_t contents = 0;
+    size_t metadata_contents = 0;
+    size_t protected_contents = 0;
+
+    CachedExtent::list metadata_lru;
+    CachedExtent::list probation_lru;
+    CachedExtent::list protected_lru;
+
+    static bool is_data(const CachedExtent &extent) {
+      return get_extent_category(extent.get_type()) == data_category_t::DATA;
+    }
+
+    CachedExtent::list &get_list(const CachedExtent &extent) {
+      if (!is_data(extent)) {
+	return metadata_lru;
+      } else if (extent.lru_protected) {
+	return protected_lru;
+      } else {
+	return probation_lru;
+      }
+    }
+
+    void link(CachedExtent &extent) {
+      get_list(extent).push_back(extent);
+      contents += extent.get_length();
+      if (!is_data(extent)) {
+	metadata_contents += extent.get_length();
+      } else if (extent.lru_protected) {
+	protected_contents += extent.get_length();
+      }
+    }
 
-    CachedExtent::list lru;
+    void unlink(CachedExtent &extent) {
+      assert(extent.primary_ref_list_hook.is_linked());
+      auto &list = get_list(extent);
+      list.erase(list.s_iterator_to(extent));
+      assert(contents >= extent.get_length());
+      contents -= extent.get_length();
+      if (!is_data(extent)) {
+	assert(metadata_contents >= extent.get_length());
+	metadata_contents -= extent.get_length();
+      } else if (extent.lru_protected) {
+	assert(protected_contents >= extent.get_length());
+	protected_contents -= extent.get_length();
+      }
+    }
+
+    void trim_protected() {
+      auto limit = (contents - metadata_contents) * PROTECTED_RATIO;
+      while (protected_contents > limit) {
+	auto &extent = protected_lru.front();
+	unlink(extent);
+	extent.lru_protected = false;
+	link(extent);
+      }
+    }
 
     void trim_to_capacity() {
       while (contents > capacity) {
-	assert(lru.size() > 0);
-	remove_from_lru(lru.front());
+	if (metadata_contents > metadata_capacity ||
+	    contents == metadata_contents) {
+	  assert(metadata_lru.size() > 0);
+	  remove_from_lru(metadata_lru.front());
+	} else if (probation_lru.size() > 0) {
+	  remove_from_lru(probation_lru.front());
+	} else {
+	  assert(protected_lru.size() > 0);
+	  remove_from_lru(protected_lru.front());
+	}
       }
     }
 
@@ -1045,15 +1125,17 @@ private:
       assert(extent.is_clean() && !extent.is_placeholder());
       
       if (!extent.primary_ref_list_hook.is_linked()) {
-	contents += extent.get_length();
+	extent.lru_protected = false;
 	intrusive_ptr_add_ref(&extent);
-	lru.push_back(extent);
+	link(extent);
       }
       trim_to_capacity();
     }
 
   public:
-    LRU(size_t capacity) : capacity(capacity) {}
+    LRU(size_t capacity, double metadata_max_ratio)
+      : capacity(capacity),
+	metadata_capacity(capacity * metadata_max_ratio) {}
 
     size_t get_capacity() const {
       return capacity;
@@ -1064,16 +1146,23 @@ private:
     }
 
     size_t get_current_contents_extents() const {
-      return lru.size();
+      return metadata_lru.size() + probation_lru.size() + protected_lru.size();
+    }
+
+    size_t get_current_metadata_bytes() const {
+      return metadata_contents;
+    }
+
+    size_t get_current_protected_bytes() const {
+      return protected_contents;
     }
 
     void remove_from_lru(CachedExtent &extent) {
       assert(extent.is_clean() && !extent.is_placeholder());
 
       if (extent.primary_ref_list_hook.is_linked()) {
-	lru.erase(lru.s_iterator_to(extent));
-	assert(contents >= extent.get_length());
-	contents -= extent.get_length();
+	unlink(extent);
+	extent.lru_protected = false;
 	intrusive_ptr_release(&extent);
       }
     }
@@ -1081,20 +1170,26 @@ private:
     void move_to_top(CachedExtent &extent) {
       assert(extent.is_clean() && !extent.is_placeholder());
 
-      if (extent.primary_ref_list_hook.is_linked()) {
-	lru.erase(lru.s_iterator_to(extent));
-	intrusive_ptr_release(&extent);
-	assert(contents >= extent.get_length());
-	contents -= extent.get_length();
+      if (!extent.primary_ref_list_hook.is_linked()) {
+	add_to_lru(extent);
+	return;
+      }
+      unlink(extent);
+      if (is_data(extent)) {
+	// a second access while cached promotes out of probation
+	extent.lru_protected = true;
       }
-      add_to_lru(extent);
+      link(extent);
+      trim_protected();
     }
 
     void clear() {
       LOG_PREFIX(Cache::LRU::clear);
-      for (auto iter = lru.begin(); iter != lru.end();) {
-	SUBDEBUG(seastore_cache, "clearing {}", *iter);
-	remove_from_lru(*(iter++));
+      for (auto list : {&metadata_lru, &probation_lru, &protected_lru}) {
+	for (auto iter = list->begin(); iter != list->end();) {
+	  SUBDEBUG(seastore_cache, "clearing {}", *iter);
+	  remove_from_lru(*(iter++));
+	}
       }
     }
 
@@ -1166,6 +1261,7 @@ private:
     counter_by_src_t<commit_trans_efforts_t> committed_efforts_by_src;
     counter_by_src_t<invalid_trans_efforts_t> invalidated_efforts_by_src;
     counter_by_src_t<query_counters_t> cache_query_by_src;
+    counter_by_extent_t<query_counters_t> cache_query_by_ext;
     success_read_trans_efforts_t success_read_efforts;
     uint64_t dirty_bytes = 0;
 
@@ -1333,9 +1429,13 @@ private:
       paddr_t offset,
       const src_ext_t* p_metric_key) {
     query_counters_t* p_counters = nullptr;
+    query_counters_t* p_ext_counters = nullptr;
     if (p_metric_key) {
       p_counters = &get_by_src(stats.cache_query_by_src, p_metric_key->first);
       ++p_counters->access;
+      p_ext_counters = &get_by_ext(
+        stats.cache_query_by_ext, p_metric_key->second);
+      ++p_ext_counters->access;
     }
     if (auto iter = extents.find_offset(offset);
         iter != extents.end()) {
@@ -1343,6 +1443,7 @@ private:
           // retired_placeholder is not really cached yet
           iter->get_type() != extent_types_t::RETIRED_PLACEHOLDER) {
         ++p_counters->hit;
+        ++p_ext_counters->hit;
       }
       return CachedExtentRef(&*iter);
     } else {
@@ -461,6 +461,9 @@ private:
     CachedExtent,
     primary_ref_list_member_options>;
 
+  /// set while a data extent is in the protected part of the lru
+  bool lru_protected = false;
+
   /**
    * dirty_from_or_retired_at
    *
@@ -583,7 +583,9 @@ RandomBlockOolWriter::do_write(
   assert(!extents.empty());
   DEBUGT("start with {} allocated extents",
          t, extents.size());
-  return trans_intr::do_for_each(extents,
+  // the extents are independent of each other, keep them all in flight
+  // so that the device sees the whole batch instead of one at a time
+  return trans_intr::parallel_for_each(extents,
     [this, &t, FNAME](auto& ex) {
     auto paddr = ex->get_paddr();
     assert(paddr.is_absolute());
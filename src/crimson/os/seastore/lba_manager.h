@@ -49,6 +49,9 @@ public:
   /**
    * Fetches mappings for a list of laddr_t in range [offset, offset + len)
    *
+   * The ranges must not overlap.  They are resolved in address order,
+   * and so are the returned pins.
+   *
    * Future will not resolve until all pins have resolved (set_paddr called)
    */
   virtual get_mappings_ret get_mappings(
@@ -95,20 +95,64 @@ BtreeLBAManager::get_mappings(
 {
   LOG_PREFIX(BtreeLBAManager::get_mappings);
   TRACET("{}", t, list);
-  auto l = std::make_unique<laddr_list_t>(std::move(list));
-  auto retptr = std::make_unique<lba_pin_list_t>();
-  auto &ret = *retptr;
-  return trans_intr::do_for_each(
-    l->begin(),
-    l->end(),
-    [this, &t, &ret](const auto &p) {
-      return get_mappings(t, p.first, p.second).si_then(
-	[&ret](auto res) {
-	  ret.splice(ret.end(), res, res.begin(), res.end());
-	  return get_mappings_iertr::now();
+  // Resolve the ranges left to right with a single iterator.  A range
+  // starting within the leaf the iterator is on is reached by stepping
+  // through that leaf; only ranges further away are looked up from the
+  // root.
+  list.sort();
+  auto c = get_context(t);
+  return with_btree_state<LBABtree, lba_pin_list_t>(
+    cache,
+    c,
+    [c, FNAME, list=std::move(list)](auto &btree, auto &ret) mutable {
+      return seastar::do_with(
+	std::move(list),
+	std::optional<LBABtree::iterator>(),
+	[c, FNAME, &btree, &ret](auto &list, auto &pos) {
+	  return trans_intr::do_for_each(
+	    list,
+	    [c, FNAME, &btree, &ret, &pos](const auto &range) {
+	      auto [offset, length] = range;
+	      auto fut = [&]() -> LBABtree::iterator_fut {
+		if (pos && !pos->is_end() &&
+		    pos->get_leaf_node()->get_node_meta().end > offset) {
+		  // the mapping before pos, collected for the previous
+		  // range, may reach into this one
+		  if (!ret.empty() &&
+		      ret.back()->get_key() + ret.back()->get_length() > offset) {
+		    ret.push_back(ret.back()->duplicate());
+		  }
+		  return LBABtree::iterator_fut(
+		    interruptible::ready_future_marker{},
+		    *pos);
+		}
+		return btree.upper_bound_right(c, offset);
+	      }();
+	      return std::move(fut).si_then([c, FNAME, &ret, &pos, offset, length](auto iter) {
+		pos = std::move(iter);
+		return trans_intr::repeat([c, FNAME, &ret, &pos, offset, length] {
+		  if (pos->is_end() || pos->get_key() >= (offset + length)) {
+		    TRACET("{}~{} done with {} results",
+			   c.trans, offset, length, ret.size());
+		    return LBABtree::iterate_repeat_ret_inner(
+		      interruptible::ready_future_marker{},
+		      seastar::stop_iteration::yes);
+		  }
+		  if ((pos->get_key() + pos->get_val().len) > offset) {
+		    TRACET("{}~{} got {}, {}, repeat ...",
+			   c.trans, offset, length, pos->get_key(), pos->get_val());
+		    ret.push_back(pos->get_pin());
+		  }
+		  return pos->next(c).si_then([&pos](auto next) {
+		    pos = std::move(next);
+		    return LBABtree::iterate_repeat_ret_inner(
+		      interruptible::ready_future_marker{},
+		      seastar::stop_iteration::no);
+		  });
+		});
+	      });
+	    });
 	});
-    }).si_then([l=std::move(l), retptr=std::move(retptr)]() mutable {
-      return std::move(*retptr);
     });
 }
 
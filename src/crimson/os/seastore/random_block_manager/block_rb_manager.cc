@@ -140,20 +140,11 @@ BlockRBManager::write_ertr::future<> BlockRBManager::write(
   rbm_abs_addr addr,
   bufferlist &bl)
 {
-  LOG_PREFIX(BlockRBManager::write);
   ceph_assert(device);
-  bufferptr bptr;
-  try {
-    bptr = bufferptr(ceph::buffer::create_page_aligned(bl.length()));
-    auto iter = bl.cbegin();
-    iter.copy(bl.length(), bptr.c_str());
-  } catch (const std::exception &e) {
-    DEBUG("write: exception creating aligned buffer {}", e);
-    ceph_assert(0 == "unhandled exception");
-  }
-  return device->write(
+  // writev() only copies the buffers that are not already block aligned
+  return device->writev(
     addr,
-    bptr);
+    bl);
 }
 
 std::ostream &operator<<(std::ostream &out, const rbm_metadata_header_t &header)
@@ -6,11 +6,13 @@
 #include <algorithm>
 
 #include <boost/algorithm/string/trim.hpp>
+#include <boost/range/irange.hpp>
 #include <fmt/format.h>
 #include <fmt/ostream.h>
 
 #include <seastar/core/file.hh>
 #include <seastar/core/fstream.hh>
+#include <seastar/core/future-util.hh>
 #include <seastar/core/metrics.hh>
 #include <seastar/core/shared_mutex.hh>
 
@@ -1903,4 +1905,387 @@ std::unique_ptr<SeaStore> make_test_seastore(
     true);
 }
 
+ShardedSeaStore::ShardedSeaStore(
+  const std::string& root,
+  unsigned num_shards)
+  : root(root),
+    num_shards(num_shards)
+{
+  ceph_assert(num_shards > 0);
+}
+
+ShardedSeaStore::~ShardedSeaStore() = default;
+
+std::string ShardedSeaStore::get_shard_root(core_id_t core) const
+{
+  if (core == 0) {
+    return root;
+  }
+  return fmt::format("{}/shard{}", root, core);
+}
+
+seastar::future<> ShardedSeaStore::start()
+{
+  return shards.start(
+  ).then([this] {
+    return shards.invoke_on_all([this](auto &local) {
+      auto core = seastar::this_shard_id();
+      if (core >= num_shards) {
+	return seastar::now();
+      }
+      return make_seastore(
+	get_shard_root(core),
+	local_conf().get_config_values()
+      ).then([&local](auto store) {
+	local.store = std::move(store);
+	return local.store->start();
+      });
+    });
+  });
+}
+
+seastar::future<> ShardedSeaStore::stop()
+{
+  return shards.stop();
+}
+
+ShardedSeaStore::mount_ertr::future<> ShardedSeaStore::mount()
+{
+  LOG_PREFIX(ShardedSeaStore::mount);
+  if (num_shards > seastar::smp::count) {
+    ERROR("store has {} shards, but only {} reactors are running",
+	  num_shards, seastar::smp::count);
+    return crimson::stateful_ec{
+      std::make_error_code(std::errc::invalid_argument)};
+  }
+  auto cores = boost::irange<core_id_t>(0, num_shards);
+  auto ret = seastar::parallel_for_each(cores, [this](core_id_t core) {
+    return with_store(core, [this, core](SeaStore &store) {
+      return store.mount().safe_then([this, core, &store] {
+	if (core == 0) {
+	  fsid = store.get_fsid();
+	  max_attr = store.get_max_attr_name_length();
+	}
+      }).to_base();
+    });
+  });
+  return mount_ertr::future<>(std::move(ret));
+}
+
+seastar::future<> ShardedSeaStore::umount()
+{
+  auto cores = boost::irange<core_id_t>(0, num_shards);
+  return seastar::parallel_for_each(cores, [this](core_id_t core) {
+    return with_store(core, [](SeaStore &store) {
+      return store.umount();
+    });
+  });
+}
+
+ShardedSeaStore::mkfs_ertr::future<> ShardedSeaStore::mkfs(
+  uuid_d new_osd_fsid)
+{
+  // record the shard count first, so that an interrupted mkfs is
+  // retried with the same layout
+  auto ret = seastar::do_with(
+    FileMDStore(root),
+    [this](auto &mdstore) {
+      return mdstore.write_meta(
+	"seastore_shards", std::to_string(num_shards));
+  }).handle_error(
+    crimson::ct_error::assert_all{
+      "Invalid error in ShardedSeaStore::mkfs"
+    }
+  ).then([this, new_osd_fsid] {
+    auto cores = boost::irange<core_id_t>(0, num_shards);
+    return seastar::parallel_for_each(
+      cores,
+      [this, new_osd_fsid](core_id_t core) {
+	return seastar::recursive_touch_directory(
+	  get_shard_root(core)
+	).then([this, core, new_osd_fsid] {
+	  return with_store(core, [new_osd_fsid](SeaStore &store) {
+	    return store.mkfs(new_osd_fsid).to_base();
+	  });
+	});
+    });
+  });
+  return mkfs_ertr::future<>(std::move(ret));
+}
+
+seastar::future<store_statfs_t> ShardedSeaStore::stat() const
+{
+  auto cores = boost::irange<core_id_t>(0, num_shards);
+  return seastar::map_reduce(
+    cores.begin(), cores.end(),
+    [this](core_id_t core) {
+      return with_store(core, [](SeaStore &store) {
+	return store.stat();
+      });
+    },
+    store_statfs_t(),
+    [](store_statfs_t total, const store_statfs_t &st) {
+      total.total += st.total;
+      total.available += st.available;
+      total.internally_reserved += st.internally_reserved;
+      total.allocated += st.allocated;
+      total.data_stored += st.data_stored;
+      total.data_compressed += st.data_compressed;
+      total.data_compressed_allocated += st.data_compressed_allocated;
+      total.data_compressed_original += st.data_compressed_original;
+      total.omap_allocated += st.omap_allocated;
+      total.internal_metadata += st.internal_metadata;
+      return total;
+    });
+}
+
+ShardedSeaStore::read_errorator::future<ceph::bufferlist>
+ShardedSeaStore::read(
+  CollectionRef c,
+  const ghobject_t& oid,
+  uint64_t offset,
+  size_t len,
+  uint32_t op_flags)
+{
+  return with_store(
+    get_store_core(),
+    [c=std::move(c), oid, offset, len, op_flags](SeaStore &store) {
+      return store.read(c, oid, offset, len, op_flags);
+    });
+}
+
+ShardedSeaStore::read_errorator::future<ceph::bufferlist>
+ShardedSeaStore::readv(
+  CollectionRef c,
+  const ghobject_t& oid,
+  interval_set<uint64_t>& m,
+  uint32_t op_flags)
+{
+  return with_store(
+    get_store_core(),
+    [c=std::move(c), oid, m, op_flags](SeaStore &store) mutable {
+      return store.readv(c, oid, m, op_flags);
+    });
+}
+
+ShardedSeaStore::get_attr_errorator::future<ceph::bufferlist>
+ShardedSeaStore::get_attr(
+  CollectionRef c,
+  const ghobject_t& oid,
+  std::string_view name) const
+{
+  return with_store(
+    get_store_core(),
+    [c=std::move(c), oid, name=std::string(name)](SeaStore &store) {
+      return store.get_attr(c, oid, name);
+    });
+}
+
+ShardedSeaStore::get_attrs_ertr::future<ShardedSeaStore::attrs_t>
+ShardedSeaStore::get_attrs(
+  CollectionRef c,
+  const ghobject_t& oid)
+{
+  return with_store(
+    get_store_core(),
+    [c=std::move(c), oid](SeaStore &store) {
+      return store.get_attrs(c, oid);
+    });
+}
+
+seastar::future<struct stat> ShardedSeaStore::stat(
+  CollectionRef c,
+  const ghobject_t& oid)
+{
+  return with_store(
+    get_store_core(),
+    [c=std::move(c), oid](SeaStore &store) {
+      return store.stat(c, oid);
+    });
+}
+
+ShardedSeaStore::read_errorator::future<ShardedSeaStore::omap_values_t>
+ShardedSeaStore::omap_get_values(
+  CollectionRef c,
+  const ghobject_t& oid,
+  const omap_keys_t& keys)
+{
+  return with_store(
+    get_store_core(),
+    [c=std::move(c), oid, keys](SeaStore &store) {
+      return store.omap_get_values(c, oid, keys);
+    });
+}
+
+ShardedSeaStore::read_errorator::future<
+  std::tuple<bool, ShardedSeaStore::omap_values_t>>
+ShardedSeaStore::omap_get_values(
+  CollectionRef c,
+  const ghobject_t &oid,
+  const std::optional<std::string> &start)
+{
+  return with_store(
+    get_store_core(),
+    [c=std::move(c), oid, start](SeaStore &store) {
+      return store.omap_get_values(c, oid, start);
+    });
+}
+
+ShardedSeaStore::get_attr_errorator::future<bufferlist>
+ShardedSeaStore::omap_get_header(
+  CollectionRef c,
+  const ghobject_t& oid)
+{
+  return with_store(
+    get_store_core(),
+    [c=std::move(c), oid](SeaStore &store) {
+      return store.omap_get_header(c, oid);
+    });
+}
+
+seastar::future<std::tuple<std::vector<ghobject_t>, ghobject_t>>
+ShardedSeaStore::list_objects(
+  CollectionRef c,
+  const ghobject_t& start,
+  const ghobject_t& end,
+  uint64_t limit) const
+{
+  return with_store(
+    get_store_core(),
+    [c=std::move(c), start, end, limit](SeaStore &store) {
+      return store.list_objects(c, start, end, limit);
+    });
+}
+
+seastar::future<ShardedSeaStore::CollectionRef>
+ShardedSeaStore::create_new_collection(const coll_t& cid)
+{
+  return with_store(get_store_core(), [cid](SeaStore &store) {
+    return store.create_new_collection(cid);
+  });
+}
+
+seastar::future<ShardedSeaStore::CollectionRef>
+ShardedSeaStore::open_collection(const coll_t& cid)
+{
+  return with_store(get_store_core(), [cid](SeaStore &store) {
+    return store.open_collection(cid);
+  });
+}
+
+seastar::future<std::vector<coll_core_t>>
+ShardedSeaStore::list_collections()
+{
+  auto cores = boost::irange<core_id_t>(0, num_shards);
+  return seastar::map_reduce(
+    cores.begin(), cores.end(),
+    [this](core_id_t core) {
+      return with_store(core, [core](SeaStore &store) {
+	return store.list_collections(
+	).then([core](auto colls) {
+	  for (auto &coll_core : colls) {
+	    coll_core.second = core;
+	  }
+	  return colls;
+	});
+      });
+    },
+    std::vector<coll_core_t>(),
+    [](auto all, auto colls) {
+      all.insert(all.end(), colls.begin(), colls.end());
+      return all;
+    });
+}
+
+seastar::future<> ShardedSeaStore::do_transaction_no_callbacks(
+  CollectionRef ch,
+  ceph::os::Transaction&& txn)
+{
+  return with_store(
+    get_store_core(),
+    [ch=std::move(ch), txn=std::move(txn)](SeaStore &store) mutable {
+      return store.do_transaction_no_callbacks(ch, std::move(txn));
+    });
+}
+
+seastar::future<> ShardedSeaStore::flush(CollectionRef ch)
+{
+  return with_store(get_store_core(), [ch=std::move(ch)](SeaStore &store) {
+    return store.flush(ch);
+  });
+}
+
+ShardedSeaStore::read_errorator::future<std::map<uint64_t, uint64_t>>
+ShardedSeaStore::fiemap(
+  CollectionRef ch,
+  const ghobject_t& oid,
+  uint64_t off,
+  uint64_t len)
+{
+  return with_store(
+    get_store_core(),
+    [ch=std::move(ch), oid, off, len](SeaStore &store) {
+      return store.fiemap(ch, oid, off, len);
+    });
+}
+
+seastar::future<> ShardedSeaStore::write_meta(
+  const std::string& key,
+  const std::string& value)
+{
+  return with_store(0, [key, value](SeaStore &store) {
+    return store.write_meta(key, value);
+  });
+}
+
+seastar::future<std::tuple<int, std::string>>
+ShardedSeaStore::read_meta(const std::string& key)
+{
+  return with_store(0, [key](SeaStore &store) {
+    return store.read_meta(key);
+  });
+}
+
+seastar::future<std::unique_ptr<FuturizedStore>> make_sharded_seastore(
+  const std::string &root,
+  const ConfigValues &config)
+{
+  return seastar::do_with(
+    FileMDStore(root),
+    [](auto &mdstore) {
+      return mdstore.read_meta("mkfs_done"
+      ).safe_then([&mdstore](auto mkfs_done) {
+	return mdstore.read_meta("seastore_shards"
+	).safe_then([mkfs_done](auto shards) -> unsigned {
+	  if (shards) {
+	    return std::stoul(*shards);
+	  } else if (mkfs_done) {
+	    // created before stores could be sharded
+	    return 1;
+	  }
+	  auto n = get_conf<uint64_t>("seastore_shards");
+	  if (n == 0 || n > seastar::smp::count) {
+	    n = seastar::smp::count;
+	  }
+	  return n;
+	});
+      });
+  }).handle_error(
+    crimson::ct_error::assert_all{
+      "Invalid error in make_sharded_seastore"
+    }
+  ).then([root, &config](unsigned num_shards) {
+    if (num_shards == 1) {
+      return make_seastore(
+	root, config
+      ).then([](auto store) -> std::unique_ptr<FuturizedStore> {
+	return std::make_unique<ShardedStoreProxy<SeaStore>>(
+	  store.release());
+      });
+    }
+    return seastar::make_ready_future<std::unique_ptr<FuturizedStore>>(
+      std::make_unique<ShardedSeaStore>(root, num_shards));
+  });
+}
+
 }
@@ -12,6 +12,7 @@
 #include <optional>
 #include <seastar/core/future.hh>
 #include <seastar/core/metrics_types.hh>
+#include <seastar/core/sharded.hh>
 
 #include "include/uuid.h"
 
@@ -441,10 +442,146 @@ private:
   seastar::future<> _mkfs(uuid_d new_osd_fsid);
 };
 
+/**
+ * ShardedSeaStore
+ *
+ * Runs an independent SeaStore, with its own device, journal, cache
+ * and trees, on each of the first num_shards reactors.  Requests made
+ * on reactor c are served by the store on reactor c % num_shards, so a
+ * PG's collection lives in the store shard of the reactor the PG runs
+ * on, and list_collections() reports each collection on its store's
+ * reactor so that PGShardManager loads the PG there again.
+ *
+ * Shard 0 lives in the osd data directory, laid out exactly like an
+ * unsharded SeaStore, and holds the OSD meta.  Shard n > 0 lives in
+ * <root>/shard<n>.  The number of shards is fixed at mkfs.
+ */
+class ShardedSeaStore final : public FuturizedStore {
+public:
+  ShardedSeaStore(const std::string& root, unsigned num_shards);
+  ~ShardedSeaStore() final;
+
+  seastar::future<> start() final;
+  seastar::future<> stop() final;
+  mount_ertr::future<> mount() final;
+  seastar::future<> umount() final;
+
+  mkfs_ertr::future<> mkfs(uuid_d new_osd_fsid) final;
+  seastar::future<store_statfs_t> stat() const final;
+
+  read_errorator::future<ceph::bufferlist> read(
+    CollectionRef c,
+    const ghobject_t& oid,
+    uint64_t offset,
+    size_t len,
+    uint32_t op_flags = 0) final;
+  read_errorator::future<ceph::bufferlist> readv(
+    CollectionRef c,
+    const ghobject_t& oid,
+    interval_set<uint64_t>& m,
+    uint32_t op_flags = 0) final;
+  get_attr_errorator::future<ceph::bufferlist> get_attr(
+    CollectionRef c,
+    const ghobject_t& oid,
+    std::string_view name) const final;
+  get_attrs_ertr::future<attrs_t> get_attrs(
+    CollectionRef c,
+    const ghobject_t& oid) final;
+
+  seastar::future<struct stat> stat(
+    CollectionRef c,
+    const ghobject_t& oid) final;
+
+  read_errorator::future<omap_values_t> omap_get_values(
+    CollectionRef c,
+    const ghobject_t& oid,
+    const omap_keys_t& keys) final;
+  read_errorator::future<std::tuple<bool, omap_values_t>> omap_get_values(
+    CollectionRef c,
+    const ghobject_t &oid,
+    const std::optional<std::string> &start) final;
+
+  get_attr_errorator::future<bufferlist> omap_get_header(
+    CollectionRef c,
+    const ghobject_t& oid) final;
+
+  seastar::future<std::tuple<std::vector<ghobject_t>, ghobject_t>> list_objects(
+    CollectionRef c,
+    const ghobject_t& start,
+    const ghobject_t& end,
+    uint64_t limit) const final;
+
+  seastar::future<CollectionRef> create_new_collection(const coll_t& cid) final;
+  seastar::future<CollectionRef> open_collection(const coll_t& cid) final;
+  seastar::future<std::vector<coll_core_t>> list_collections() final;
+
+  seastar::future<> do_transaction_no_callbacks(
+    CollectionRef ch,
+    ceph::os::Transaction&& txn) final;
+  seastar::future<> flush(CollectionRef ch) final;
+
+  read_errorator::future<std::map<uint64_t, uint64_t>> fiemap(
+    CollectionRef ch,
+    const ghobject_t& oid,
+    uint64_t off,
+    uint64_t len) final;
+
+  seastar::future<> write_meta(const std::string& key,
+		  const std::string& value) final;
+  seastar::future<std::tuple<int, std::string>> read_meta(const std::string& key) final;
+  uuid_d get_fsid() const final {
+    return fsid;
+  }
+  unsigned get_max_attr_name_length() const final {
+    return max_attr;
+  }
+
+private:
+  struct LocalStore {
+    std::unique_ptr<SeaStore> store;
+
+    seastar::future<> stop() {
+      return store ? store->stop() : seastar::now();
+    }
+  };
+
+  /// reactor whose store serves requests made on this reactor
+  core_id_t get_store_core() const {
+    return seastar::this_shard_id() % num_shards;
+  }
+  std::string get_shard_root(core_id_t core) const;
+
+  template <typename Func>
+  auto with_store(core_id_t core, Func &&f) const {
+    return crimson::submit_to(
+      core,
+      [this, f=std::forward<Func>(f)]() mutable {
+	return std::invoke(f, *shards.local().store);
+      });
+  }
+
+  const std::string root;
+  const unsigned num_shards;
+  uuid_d fsid;
+  unsigned max_attr = 0;
+  seastar::sharded<LocalStore> shards;
+};
+
 seastar::future<std::unique_ptr<SeaStore>> make_seastore(
   const std::string &device,
   const ConfigValues &config);
 
+/**
+ * make_sharded_seastore
+ *
+ * Returns a ShardedSeaStore if the store at root was created with more
+ * than one shard (or, for a new store, if seastore_shards asks for
+ * more than one), otherwise a single SeaStore proxied to this reactor.
+ */
+seastar::future<std::unique_ptr<FuturizedStore>> make_sharded_seastore(
+  const std::string &root,
+  const ConfigValues &config);
+
 std::unique_ptr<SeaStore> make_test_seastore(
   DeviceRef device,
   SeaStore::MDStoreRef mdstore);
@@ -21,6 +21,7 @@
 #include "messages/MOSDMap.h"
 #include "messages/MOSDMarkMeDown.h"
 #include "messages/MOSDOp.h"
+#include "messages/MOSDOpBatch.h"
 #include "messages/MOSDPeeringOp.h"
 #include "messages/MOSDPGCreate2.h"
 #include "messages/MOSDPGUpdateLogMissing.h"
@@ -609,6 +610,9 @@ seastar::future<> OSD::start_asok_admin()
     asok->register_command(
       make_asok_hook<DumpInFlightOpsHook>(
 	std::as_const(pg_shard_manager)));
+    asok->register_command(
+      make_asok_hook<DumpPipelineLatencyHook>(
+	std::as_const(pg_shard_manager)));
     asok->register_command(
       make_asok_hook<DumpHistoricOpsHook>(
 	std::as_const(get_shard_services().get_registry())));
@@ -696,6 +700,9 @@ OSD::ms_dispatch(crimson::net::ConnectionRef conn, MessageRef m)
       return handle_osd_map(conn, boost::static_pointer_cast<MOSDMap>(m));
     case CEPH_MSG_OSD_OP:
       return handle_osd_op(conn, boost::static_pointer_cast<MOSDOp>(m));
+    case CEPH_MSG_OSD_OP_BATCH:
+      return handle_osd_op_batch(
+        conn, boost::static_pointer_cast<MOSDOpBatch>(m));
     case MSG_OSD_PG_CREATE2:
       return handle_pg_create(
 	conn, boost::static_pointer_cast<MOSDPGCreate2>(m));
@@ -1006,6 +1013,16 @@ seastar::future<> OSD::handle_osd_op(crimson::net::ConnectionRef conn,
   return seastar::now();
 }
 
+seastar::future<> OSD::handle_osd_op_batch(crimson::net::ConnectionRef conn,
+                                           Ref<MOSDOpBatch> m)
+{
+  for (auto& op : m->ops) {
+    op->set_connection(conn);
+    std::ignore = handle_osd_op(conn, std::move(op));
+  }
+  return seastar::now();
+}
+
 seastar::future<> OSD::handle_pg_create(crimson::net::ConnectionRef conn,
 					Ref<MOSDPGCreate2> m)
 {
@@ -9,6 +9,7 @@
 
 #include "crimson/osd/shard_services.h"
 #include "crimson/osd/pg_map.h"
+#include "osd/osd_perf_counters.h"
 
 namespace crimson::osd {
 
@@ -137,6 +138,13 @@ public:
 
   seastar::future<> set_up_epoch(epoch_t e);
 
+  /// account for an op about to be handed to the core owning its pg
+  void count_op_dispatch(core_id_t core) {
+    get_local_state().perf->inc(
+      core == seastar::this_shard_id() ?
+      l_osd_op_local_core : l_osd_op_remote_core);
+  }
+
   template <typename F>
   auto with_remote_shard_state(core_id_t core, F &&f) {
     ceph_assert(seastar::this_shard_id() == PRIMARY_CORE);
@@ -162,6 +170,7 @@ public:
     auto core = get_osd_singleton_state().pg_to_shard_mapping.maybe_create_pg(
       op->get_pgid());
 
+    count_op_dispatch(core);
     get_local_state().registry.remove_from_registry(*op);
     return with_remote_shard_state(
       core,
@@ -206,6 +215,7 @@ public:
      auto core = get_osd_singleton_state().pg_to_shard_mapping.maybe_create_pg(
       op->get_pgid());
 
+    count_op_dispatch(core);
     get_local_state().registry.remove_from_registry(*op);
     return with_remote_shard_state(
       core,
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <cstdlib>
 #include <iostream>
+#include <thread>
 
 #include <boost/lexical_cast.hpp>
 #include <boost/icl/interval_map.hpp>
@@ -570,6 +571,21 @@ int CrushTester::test(CephContext* cct)
         // create a vector to hold placement results temporarily 
         vector<int> temporary_per ( per.size() );
 
+        // map the whole batch in one pass over the rule
+        vector<vector<int>> batch_out;
+        if (use_crush) {
+          vector<int> xs;
+          xs.reserve(batch_max - batch_min + 1);
+          for (int x = batch_min; x <= batch_max; x++) {
+            uint32_t real_x = x;
+            if (pool_id != -1) {
+              real_x = crush_hash32_2(CRUSH_HASH_RJENKINS1, x, (uint32_t)pool_id);
+            }
+            xs.push_back(real_x);
+          }
+          map_inputs(r, xs, batch_out, nr, weight);
+        }
+
         for (int x = batch_min; x <= batch_max; x++) {
           // create a vector to hold the results of a CRUSH placement or RNG simulation
           vector<int> out;
@@ -577,11 +593,7 @@ int CrushTester::test(CephContext* cct)
           if (use_crush) {
             if (output_mappings)
 	      err << "CRUSH"; // prepend CRUSH to placement output
-            uint32_t real_x = x;
-            if (pool_id != -1) {
-              real_x = crush_hash32_2(CRUSH_HASH_RJENKINS1, x, (uint32_t)pool_id);
-            }
-            crush.do_rule(r, real_x, out, nr, weight, 0);
+            out.swap(batch_out[x - batch_min]);
           } else {
             if (output_mappings)
 	      err << "RNG"; // prepend RNG to placement output to denote simulation
@@ -646,6 +658,9 @@ int CrushTester::test(CephContext* cct)
           }
         }
 
+      if (output_utilization_histogram)
+        write_utilization_histogram(r, nr, per, num_objects_expected);
+
       ldout(cct, 20) << "output statistics created" << dendl;
 
       if (output_data_file)
@@ -695,6 +710,59 @@ int CrushTester::test(CephContext* cct)
   return 0;
 }
 
+void CrushTester::map_inputs(int r, const vector<int>& xs,
+                             vector<vector<int>>& out, int nr,
+                             const vector<__u32>& weight)
+{
+  // the choose_tries profile is a plain counter array in the map
+  unsigned threads = output_choose_tries ? 1 : std::max(num_threads, 1);
+  threads = std::min<size_t>(threads, xs.size());
+  if (threads <= 1) {
+    crush.do_rule_batch(r, xs, out, nr, weight, 0);
+    return;
+  }
+  size_t per_thread = (xs.size() + threads - 1) / threads;
+  vector<vector<vector<int>>> parts(threads);
+  vector<std::thread> workers;
+  for (unsigned t = 0; t < threads; t++) {
+    workers.emplace_back([&, t] {
+      auto first = xs.begin() + std::min(xs.size(), t * per_thread);
+      auto last = xs.begin() + std::min(xs.size(), (t + 1) * per_thread);
+      crush.do_rule_batch(r, vector<int>(first, last), parts[t], nr, weight, 0);
+    });
+  }
+  for (auto& w : workers)
+    w.join();
+  out.clear();
+  out.reserve(xs.size());
+  for (auto& part : parts)
+    std::move(part.begin(), part.end(), std::back_inserter(out));
+}
+
+void CrushTester::write_utilization_histogram(int r, int nr,
+                                              const vector<int>& per,
+                                              const vector<float>& expected)
+{
+  // buckets of 5% of the expected number of objects
+  map<int, int> histogram;
+  for (unsigned i = 0; i < per.size(); i++) {
+    if (expected[i] <= 0)
+      continue;
+    histogram[(int)(per[i] / expected[i] * 20)]++;
+  }
+  auto flags = err.flags();
+  auto precision = err.precision();
+  err << "rule " << r << " (" << crush.get_rule_name(r) << ") num_rep " << nr
+      << " utilization histogram (stored / expected):" << std::endl;
+  for (auto [bucket, devices] : histogram) {
+    err << "  " << std::fixed << std::setprecision(2)
+        << bucket / 20.0 << " - " << (bucket + 1) / 20.0 << ":\t"
+        << devices << std::endl;
+  }
+  err.flags(flags);
+  err.precision(precision);
+}
+
 int CrushTester::compare(CrushWrapper& crush2)
 {
   if (min_rule < 0 || max_rule < 0) {
@@ -20,6 +20,7 @@ class CrushTester {
   int64_t pool_id;
 
   int num_batches;
+  int num_threads;
   bool use_crush;
 
   float mark_down_device_ratio;
@@ -27,6 +28,7 @@ class CrushTester {
 
   bool output_utilization;
   bool output_utilization_all;
+  bool output_utilization_histogram;
   bool output_statistics;
   bool output_mappings;
   bool output_bad_mappings;
@@ -43,6 +45,20 @@ class CrushTester {
  */
   void adjust_weights(std::vector<__u32>& weight);
 
+  /*
+   * map xs through rule r, splitting them over num_threads threads
+   */
+  void map_inputs(int r, const std::vector<int>& xs,
+                  std::vector<std::vector<int>>& out, int nr,
+                  const std::vector<__u32>& weight);
+
+  /*
+   * print how many devices stored a given fraction of their expected load
+   */
+  void write_utilization_histogram(int r, int nr,
+                                   const std::vector<int>& per,
+                                   const std::vector<float>& expected);
+
   /*
    * Get the maximum number of devices that could be selected to satisfy ruleno.
    */
@@ -173,11 +189,13 @@ public:
       min_rep(-1), max_rep(-1),
       pool_id(-1),
       num_batches(1),
+      num_threads(1),
       use_crush(true),
       mark_down_device_ratio(0.0),
       mark_down_bucket_ratio(1.0),
       output_utilization(false),
       output_utilization_all(false),
+      output_utilization_histogram(false),
       output_statistics(false),
       output_mappings(false),
       output_bad_mappings(false),
@@ -223,6 +241,13 @@ public:
     return output_utilization_all;
   }
 
+  void set_output_utilization_histogram(bool b) {
+    output_utilization_histogram = b;
+  }
+  bool get_output_utilization_histogram() const {
+    return output_utilization_histogram;
+  }
+
   void set_output_statistics(bool b) {
     output_statistics = b;
   }
@@ -258,6 +283,13 @@ public:
     return num_batches;
   }
 
+  void set_threads(int t) {
+    num_threads = t;
+  }
+  int get_threads() const {
+    return num_threads;
+  }
+
   void set_random_placement() {
     use_crush = false;
   }
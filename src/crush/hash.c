@@ -140,6 +140,140 @@ __u32 crush_hash32_5(int type, __u32 a, __u32 b, __u32 c, __u32 d, __u32 e)
 	}
 }
 
+/*
+ * hash many b values against the same a and c.  straw2 hashes every
+ * item of a bucket with the same (x, r), so the items can be mixed
+ * side by side in vector lanes.  the lanes run exactly the scalar
+ * crush_hashmix steps, so the results are bit-identical.
+ */
+#if !defined(__KERNEL__) && defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define CRUSH_HASH_HAVE_AVX2 1
+
+#define crush_hashmix_avx2(a, b, c) do {				\
+		a = _mm256_sub_epi32(_mm256_sub_epi32(a, b), c);	\
+		a = _mm256_xor_si256(a, _mm256_srli_epi32(c, 13));	\
+		b = _mm256_sub_epi32(_mm256_sub_epi32(b, c), a);	\
+		b = _mm256_xor_si256(b, _mm256_slli_epi32(a, 8));	\
+		c = _mm256_sub_epi32(_mm256_sub_epi32(c, a), b);	\
+		c = _mm256_xor_si256(c, _mm256_srli_epi32(b, 13));	\
+		a = _mm256_sub_epi32(_mm256_sub_epi32(a, b), c);	\
+		a = _mm256_xor_si256(a, _mm256_srli_epi32(c, 12));	\
+		b = _mm256_sub_epi32(_mm256_sub_epi32(b, c), a);	\
+		b = _mm256_xor_si256(b, _mm256_slli_epi32(a, 16));	\
+		c = _mm256_sub_epi32(_mm256_sub_epi32(c, a), b);	\
+		c = _mm256_xor_si256(c, _mm256_srli_epi32(b, 5));	\
+		a = _mm256_sub_epi32(_mm256_sub_epi32(a, b), c);	\
+		a = _mm256_xor_si256(a, _mm256_srli_epi32(c, 3));	\
+		b = _mm256_sub_epi32(_mm256_sub_epi32(b, c), a);	\
+		b = _mm256_xor_si256(b, _mm256_slli_epi32(a, 10));	\
+		c = _mm256_sub_epi32(_mm256_sub_epi32(c, a), b);	\
+		c = _mm256_xor_si256(c, _mm256_srli_epi32(b, 15));	\
+	} while (0)
+
+__attribute__((target("avx2")))
+static unsigned crush_hash32_rjenkins1_3_avx2(__u32 a0, const __u32 *bv,
+					      __u32 c0, __u32 *out,
+					      unsigned n)
+{
+	unsigned i;
+	for (i = 0; i + 8 <= n; i += 8) {
+		__m256i a = _mm256_set1_epi32(a0);
+		__m256i b = _mm256_loadu_si256((const __m256i *)(bv + i));
+		__m256i c = _mm256_set1_epi32(c0);
+		__m256i x = _mm256_set1_epi32(231232);
+		__m256i y = _mm256_set1_epi32(1232);
+		__m256i hash = _mm256_xor_si256(
+			_mm256_set1_epi32(crush_hash_seed ^ a0 ^ c0), b);
+		crush_hashmix_avx2(a, b, hash);
+		crush_hashmix_avx2(c, x, hash);
+		crush_hashmix_avx2(y, a, hash);
+		crush_hashmix_avx2(b, x, hash);
+		crush_hashmix_avx2(y, c, hash);
+		_mm256_storeu_si256((__m256i *)(out + i), hash);
+	}
+	return i;
+}
+
+static int crush_hash_avx2_supported(void)
+{
+	static int supported = -1;
+	if (supported < 0)
+		supported = __builtin_cpu_supports("avx2") ? 1 : 0;
+	return supported;
+}
+#endif
+
+#if !defined(__KERNEL__) && defined(__aarch64__)
+#include <arm_neon.h>
+#define CRUSH_HASH_HAVE_NEON 1
+
+#define crush_hashmix_neon(a, b, c) do {				\
+		a = vsubq_u32(vsubq_u32(a, b), c);			\
+		a = veorq_u32(a, vshrq_n_u32(c, 13));			\
+		b = vsubq_u32(vsubq_u32(b, c), a);			\
+		b = veorq_u32(b, vshlq_n_u32(a, 8));			\
+		c = vsubq_u32(vsubq_u32(c, a), b);			\
+		c = veorq_u32(c, vshrq_n_u32(b, 13));			\
+		a = vsubq_u32(vsubq_u32(a, b), c);			\
+		a = veorq_u32(a, vshrq_n_u32(c, 12));			\
+		b = vsubq_u32(vsubq_u32(b, c), a);			\
+		b = veorq_u32(b, vshlq_n_u32(a, 16));			\
+		c = vsubq_u32(vsubq_u32(c, a), b);			\
+		c = veorq_u32(c, vshrq_n_u32(b, 5));			\
+		a = vsubq_u32(vsubq_u32(a, b), c);			\
+		a = veorq_u32(a, vshrq_n_u32(c, 3));			\
+		b = vsubq_u32(vsubq_u32(b, c), a);			\
+		b = veorq_u32(b, vshlq_n_u32(a, 10));			\
+		c = vsubq_u32(vsubq_u32(c, a), b);			\
+		c = veorq_u32(c, vshrq_n_u32(b, 15));			\
+	} while (0)
+
+static unsigned crush_hash32_rjenkins1_3_neon(__u32 a0, const __u32 *bv,
+					      __u32 c0, __u32 *out,
+					      unsigned n)
+{
+	unsigned i;
+	for (i = 0; i + 4 <= n; i += 4) {
+		uint32x4_t a = vdupq_n_u32(a0);
+		uint32x4_t b = vld1q_u32(bv + i);
+		uint32x4_t c = vdupq_n_u32(c0);
+		uint32x4_t x = vdupq_n_u32(231232);
+		uint32x4_t y = vdupq_n_u32(1232);
+		uint32x4_t hash = veorq_u32(
+			vdupq_n_u32(crush_hash_seed ^ a0 ^ c0), b);
+		crush_hashmix_neon(a, b, hash);
+		crush_hashmix_neon(c, x, hash);
+		crush_hashmix_neon(y, a, hash);
+		crush_hashmix_neon(b, x, hash);
+		crush_hashmix_neon(y, c, hash);
+		vst1q_u32(out + i, hash);
+	}
+	return i;
+}
+#endif
+
+void crush_hash32_3_multi(int type, __u32 a, const __u32 *b, __u32 c,
+			  __u32 *out, unsigned n)
+{
+	unsigned i = 0;
+
+	if (type != CRUSH_HASH_RJENKINS1) {
+		for (; i < n; i++)
+			out[i] = 0;
+		return;
+	}
+#ifdef CRUSH_HASH_HAVE_AVX2
+	if (n >= 8 && crush_hash_avx2_supported())
+		i = crush_hash32_rjenkins1_3_avx2(a, b, c, out, n);
+#endif
+#ifdef CRUSH_HASH_HAVE_NEON
+	i = crush_hash32_rjenkins1_3_neon(a, b, c, out, n);
+#endif
+	for (; i < n; i++)
+		out[i] = crush_hash32_rjenkins1_3(a, b[i], c);
+}
+
 const char *crush_hash_name(int type)
 {
 	switch (type) {
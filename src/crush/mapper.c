@@ -309,10 +309,8 @@ static inline __s32 *get_choose_arg_ids(const struct crush_bucket_straw2 *bucket
  * for reference, see the exponential distribution example at:  
  * https://en.wikipedia.org/wiki/Inverse_transform_sampling#Examples
  */
-static inline __s64 generate_exponential_distribution(int type, int x, int y, int z, 
-                                                      int weight)
+static inline __s64 crush_straw2_draw(unsigned int u, int weight)
 {
-	unsigned int u = crush_hash32_3(type, x, y, z);
 	u &= 0xffff;
 
 	/*
@@ -336,6 +334,54 @@ static inline __s64 generate_exponential_distribution(int type, int x, int y, in
 	return div64_s64(ln, weight);
 }
 
+static inline __s64 generate_exponential_distribution(int type, int x, int y, int z, 
+                                                      int weight)
+{
+	return crush_straw2_draw(crush_hash32_3(type, x, y, z), weight);
+}
+
+#ifndef __KERNEL__
+/*
+ * every item of the bucket is hashed with the same (x, r), so hash a
+ * run of items at once with crush_hash32_3_multi(), which mixes them in
+ * vector lanes where the cpu allows it.  the log and the division stay
+ * scalar, so the draws are identical to the one-at-a-time loop.
+ */
+#define CRUSH_STRAW2_HASH_BATCH 64
+
+static int bucket_straw2_choose(const struct crush_bucket_straw2 *bucket,
+				int x, int r, const struct crush_choose_arg *arg,
+                                int position)
+{
+	unsigned int i, j, n, high = 0;
+	__s64 draw, high_draw = 0;
+	__u32 u[CRUSH_STRAW2_HASH_BATCH];
+        __u32 *weights = get_choose_arg_weights(bucket, arg, position);
+        __s32 *ids = get_choose_arg_ids(bucket, arg);
+	for (i = 0; i < bucket->h.size; i += n) {
+		n = bucket->h.size - i;
+		if (n > CRUSH_STRAW2_HASH_BATCH)
+			n = CRUSH_STRAW2_HASH_BATCH;
+		crush_hash32_3_multi(bucket->h.hash, x, (const __u32 *)ids + i,
+				     r, u, n);
+		for (j = 0; j < n; j++) {
+			dprintk("weight 0x%x item %d\n", weights[i + j], ids[i + j]);
+			if (weights[i + j]) {
+				draw = crush_straw2_draw(u[j], weights[i + j]);
+			} else {
+				draw = S64_MIN;
+			}
+
+			if (i + j == 0 || draw > high_draw) {
+				high = i + j;
+				high_draw = draw;
+			}
+		}
+	}
+
+	return bucket->h.items[high];
+}
+#else
 static int bucket_straw2_choose(const struct crush_bucket_straw2 *bucket,
 				int x, int r, const struct crush_choose_arg *arg,
                                 int position)
@@ -360,6 +406,7 @@ static int bucket_straw2_choose(const struct crush_bucket_straw2 *bucket,
 
 	return bucket->h.items[high];
 }
+#endif
 
 
 static int crush_bucket_choose(const struct crush_bucket *in,
@@ -1081,3 +1128,36 @@ int crush_do_rule(const struct crush_map *map,
 
 	return result_len;
 }
+
+/**
+ * crush_do_rule_batch - map many inputs through the same rule
+ * @map: the crush_map
+ * @ruleno: the rule id
+ * @xs: the nx inputs to map
+ * @nx: number of inputs
+ * @results: nx * result_max items; the mapping of xs[i] starts at
+ *           results + i * result_max
+ * @result_lens: nx lengths, as crush_do_rule() would return them
+ * @result_max: maximum result size of each mapping
+ * @weight: weight vector (for map leaves)
+ * @weight_max: size of weight vector
+ * @cwin: workspace from crush_init_workspace(), sized for result_max
+ *
+ * The rule, the weights and the workspace are shared by all inputs,
+ * so this saves the per-call setup a caller looping over
+ * crush_do_rule() would otherwise repeat.
+ */
+void crush_do_rule_batch(const struct crush_map *map,
+			 int ruleno, const int *xs, int nx,
+			 int *results, int *result_lens, int result_max,
+			 const __u32 *weight, int weight_max,
+			 void *cwin, const struct crush_choose_arg *choose_args)
+{
+	int i;
+
+	for (i = 0; i < nx; i++)
+		result_lens[i] = crush_do_rule(map, ruleno, xs[i],
+					       results + i * result_max,
+					       result_max, weight, weight_max,
+					       cwin, choose_args);
+}
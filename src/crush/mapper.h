@@ -77,6 +77,20 @@ extern int crush_do_rule(const struct crush_map *map,
 			 const __u32 *weights, int weight_max,
 			 void *cwin, const struct crush_choose_arg *choose_args);
 
+/** @ingroup API
+ *
+ * Map each of the __nx__ values in __xs__ as crush_do_rule() would,
+ * reusing one __cwin__ workspace. The mapping of __xs[i]__ is stored
+ * in __results[i * result_max, (i + 1) * result_max[__ and its length
+ * in __result_lens[i]__.
+ */
+extern void crush_do_rule_batch(const struct crush_map *map,
+				int ruleno, const int *xs, int nx,
+				int *results, int *result_lens, int result_max,
+				const __u32 *weights, int weight_max,
+				void *cwin,
+				const struct crush_choose_arg *choose_args);
+
 /* Returns the exact amount of workspace that will need to be used
    for a given combination of crush_map and result_max. The caller can
    then allocate this much on its own, either on the stack, in a
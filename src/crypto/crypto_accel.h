@@ -14,6 +14,7 @@
 
 #ifndef CRYPTO_ACCEL_H
 #define CRYPTO_ACCEL_H
+#include <algorithm>
 #include <cstddef>
 #include "include/Context.h"
 
@@ -33,5 +34,37 @@ class CryptoAccel {
   virtual bool cbc_decrypt(unsigned char* out, const unsigned char* in, size_t size,
                    const unsigned char (&iv)[AES_256_IVSIZE],
                    const unsigned char (&key)[AES_256_KEYSIZE]) = 0;
+
+  /**
+   * Transform @p size bytes as a run of independent CBC chunks of
+   * @p chunk_size bytes, all under the same key; the last chunk may be
+   * shorter. Implementations may set up the key once for the run, or
+   * process several chunks in parallel.
+   * @param iv one IV per chunk
+   */
+  virtual bool cbc_encrypt_chunks(unsigned char* out, const unsigned char* in,
+                   size_t size, size_t chunk_size,
+                   const unsigned char (*iv)[AES_256_IVSIZE],
+                   const unsigned char (&key)[AES_256_KEYSIZE]) {
+    for (size_t offset = 0; offset < size; offset += chunk_size, ++iv) {
+      size_t process_size = std::min(chunk_size, size - offset);
+      if (!cbc_encrypt(out + offset, in + offset, process_size, *iv, key)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  virtual bool cbc_decrypt_chunks(unsigned char* out, const unsigned char* in,
+                   size_t size, size_t chunk_size,
+                   const unsigned char (*iv)[AES_256_IVSIZE],
+                   const unsigned char (&key)[AES_256_KEYSIZE]) {
+    for (size_t offset = 0; offset < size; offset += chunk_size, ++iv) {
+      size_t process_size = std::min(chunk_size, size - offset);
+      if (!cbc_decrypt(out + offset, in + offset, process_size, *iv, key)) {
+        return false;
+      }
+    }
+    return true;
+  }
 };
 #endif
@@ -41,3 +41,40 @@ bool ISALCryptoAccel::cbc_decrypt(unsigned char* out, const unsigned char* in, s
   aes_cbc_dec_256(const_cast<unsigned char*>(in), const_cast<unsigned char*>(&iv[0]), keys_blk.dec_keys, out, size);
   return true;
 }
+bool ISALCryptoAccel::cbc_encrypt_chunks(unsigned char* out, const unsigned char* in,
+                             size_t size, size_t chunk_size,
+                             const unsigned char (*iv)[AES_256_IVSIZE],
+                             const unsigned char (&key)[AES_256_KEYSIZE])
+{
+  if ((size % AES_256_IVSIZE) != 0 || (chunk_size % AES_256_IVSIZE) != 0) {
+    return false;
+  }
+  // expand the key once for the whole run
+  alignas(16) struct cbc_key_data keys_blk;
+  aes_cbc_precomp(const_cast<unsigned char*>(&key[0]), AES_256_KEYSIZE, &keys_blk);
+  for (size_t offset = 0; offset < size; offset += chunk_size, ++iv) {
+    size_t process_size = std::min(chunk_size, size - offset);
+    aes_cbc_enc_256(const_cast<unsigned char*>(in + offset),
+                    const_cast<unsigned char*>(&(*iv)[0]), keys_blk.enc_keys,
+                    out + offset, process_size);
+  }
+  return true;
+}
+bool ISALCryptoAccel::cbc_decrypt_chunks(unsigned char* out, const unsigned char* in,
+                             size_t size, size_t chunk_size,
+                             const unsigned char (*iv)[AES_256_IVSIZE],
+                             const unsigned char (&key)[AES_256_KEYSIZE])
+{
+  if ((size % AES_256_IVSIZE) != 0 || (chunk_size % AES_256_IVSIZE) != 0) {
+    return false;
+  }
+  alignas(16) struct cbc_key_data keys_blk;
+  aes_cbc_precomp(const_cast<unsigned char*>(&key[0]), AES_256_KEYSIZE, &keys_blk);
+  for (size_t offset = 0; offset < size; offset += chunk_size, ++iv) {
+    size_t process_size = std::min(chunk_size, size - offset);
+    aes_cbc_dec_256(const_cast<unsigned char*>(in + offset),
+                    const_cast<unsigned char*>(&(*iv)[0]), keys_blk.dec_keys,
+                    out + offset, process_size);
+  }
+  return true;
+}
@@ -178,6 +178,12 @@ int ErasureCode::encode_prepare(const bufferlist &raw,
   }
   for (unsigned int i = k; i < k + m; i++) {
     bufferlist &chunk = encoded[chunk_index(i)];
+    if (chunk.length() == blocksize && chunk.is_contiguous() &&
+	chunk.is_aligned(SIMD_ALIGN)) {
+      // the caller provided the buffer to encode into
+      continue;
+    }
+    chunk.clear();
     chunk.push_back(buffer::create_aligned(blocksize, SIMD_ALIGN));
   }
 
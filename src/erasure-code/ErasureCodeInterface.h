@@ -334,7 +334,9 @@ namespace ceph {
      * indexes found in the **want_to_encode** set.
      *
      * The **encoded** map is expected to be a pointer to an empty
-     * map.
+     * map, or to a map holding contiguous, aligned buffers of the
+     * chunk size for some of the coding chunks. The coding chunks are
+     * then written into those buffers instead of newly allocated ones.
      *
      * Assuming the **in** parameter is **length** bytes long, 
      * the concatenation of the first **length** bytes of the
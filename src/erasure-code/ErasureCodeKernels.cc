@@ -0,0 +1,340 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph distributed storage system
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+#include <atomic>
+#include <cstring>
+
+#include "ErasureCodeKernels.h"
+#include "arch/probe.h"
+#include "arch/intel.h"
+#include "arch/arm.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace ceph {
+namespace ec_kernel {
+
+namespace {
+
+struct gf_tables_t {
+  uint8_t exp[512];
+  uint8_t log[256];
+  gf_tables_t() {
+    unsigned x = 1;
+    for (unsigned i = 0; i < 255; i++) {
+      exp[i] = exp[i + 255] = x;
+      log[x] = i;
+      x <<= 1;
+      if (x & 0x100)
+	x ^= 0x11d;
+    }
+    exp[510] = exp[0];
+    exp[511] = exp[1];
+    log[0] = 0;
+  }
+};
+
+const gf_tables_t &gf_tables()
+{
+  static const gf_tables_t tables;
+  return tables;
+}
+
+/// c * x and c * (x << 4) for every nibble x, for the shuffle kernels
+void nibble_tables(uint8_t c, uint8_t lo[16], uint8_t hi[16])
+{
+  for (unsigned x = 0; x < 16; x++) {
+    lo[x] = gf_mul(c, x);
+    hi[x] = gf_mul(c, x << 4);
+  }
+}
+
+void generic_xor(const uint8_t *src, uint8_t *dst, size_t len)
+{
+  for (; len >= 8; len -= 8, src += 8, dst += 8) {
+    uint64_t s, d;
+    memcpy(&s, src, 8);
+    memcpy(&d, dst, 8);
+    d ^= s;
+    memcpy(dst, &d, 8);
+  }
+  for (; len; len--) {
+    *dst++ ^= *src++;
+  }
+}
+
+void generic_mul_xor(uint8_t c, const uint8_t *src, uint8_t *dst, size_t len)
+{
+  if (c == 0)
+    return;
+  if (c == 1) {
+    generic_xor(src, dst, len);
+    return;
+  }
+  uint8_t row[256];
+  for (unsigned x = 0; x < 256; x++) {
+    row[x] = gf_mul(c, x);
+  }
+  for (; len; len--) {
+    *dst++ ^= row[*src++];
+  }
+}
+
+const kernel_t generic_kernel = {
+  "generic", generic_xor, generic_mul_xor
+};
+
+#if defined(__x86_64__)
+
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#define TARGET_GFNI __attribute__((target("avx512f,avx512bw,gfni")))
+
+TARGET_AVX2
+void avx2_xor(const uint8_t *src, uint8_t *dst, size_t len)
+{
+  for (; len >= 32; len -= 32, src += 32, dst += 32) {
+    __m256i s = _mm256_loadu_si256((const __m256i *)src);
+    __m256i d = _mm256_loadu_si256((const __m256i *)dst);
+    _mm256_storeu_si256((__m256i *)dst, _mm256_xor_si256(s, d));
+  }
+  generic_xor(src, dst, len);
+}
+
+TARGET_AVX2
+void avx2_mul_xor(uint8_t c, const uint8_t *src, uint8_t *dst, size_t len)
+{
+  if (c <= 1 || len < 32) {
+    if (c == 1)
+      avx2_xor(src, dst, len);
+    else
+      generic_mul_xor(c, src, dst, len);
+    return;
+  }
+  uint8_t lo[16], hi[16];
+  nibble_tables(c, lo, hi);
+  const __m256i tlo =
+    _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)lo));
+  const __m256i thi =
+    _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)hi));
+  const __m256i mask = _mm256_set1_epi8(0x0f);
+  for (; len >= 32; len -= 32, src += 32, dst += 32) {
+    __m256i s = _mm256_loadu_si256((const __m256i *)src);
+    __m256i l = _mm256_and_si256(s, mask);
+    __m256i h = _mm256_and_si256(_mm256_srli_epi64(s, 4), mask);
+    __m256i p = _mm256_xor_si256(_mm256_shuffle_epi8(tlo, l),
+				 _mm256_shuffle_epi8(thi, h));
+    __m256i d = _mm256_loadu_si256((const __m256i *)dst);
+    _mm256_storeu_si256((__m256i *)dst, _mm256_xor_si256(p, d));
+  }
+  generic_mul_xor(c, src, dst, len);
+}
+
+TARGET_AVX512
+void avx512_xor(const uint8_t *src, uint8_t *dst, size_t len)
+{
+  for (; len >= 64; len -= 64, src += 64, dst += 64) {
+    __m512i s = _mm512_loadu_si512(src);
+    __m512i d = _mm512_loadu_si512(dst);
+    _mm512_storeu_si512(dst, _mm512_xor_si512(s, d));
+  }
+  generic_xor(src, dst, len);
+}
+
+TARGET_AVX512
+void avx512_mul_xor(uint8_t c, const uint8_t *src, uint8_t *dst, size_t len)
+{
+  if (c <= 1 || len < 64) {
+    if (c == 1)
+      avx512_xor(src, dst, len);
+    else
+      generic_mul_xor(c, src, dst, len);
+    return;
+  }
+  uint8_t lo[16], hi[16];
+  nibble_tables(c, lo, hi);
+  const __m512i tlo = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)lo));
+  const __m512i thi = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)hi));
+  const __m512i mask = _mm512_set1_epi8(0x0f);
+  for (; len >= 64; len -= 64, src += 64, dst += 64) {
+    __m512i s = _mm512_loadu_si512(src);
+    __m512i l = _mm512_and_si512(s, mask);
+    __m512i h = _mm512_and_si512(_mm512_srli_epi64(s, 4), mask);
+    __m512i p = _mm512_xor_si512(_mm512_shuffle_epi8(tlo, l),
+				 _mm512_shuffle_epi8(thi, h));
+    __m512i d = _mm512_loadu_si512(dst);
+    _mm512_storeu_si512(dst, _mm512_xor_si512(p, d));
+  }
+  generic_mul_xor(c, src, dst, len);
+}
+
+/**
+ * Multiplication by c is linear over GF(2), so it is an 8x8 bit matrix
+ * that gf2p8affineqb applies to every byte whatever the field polynomial.
+ * Output bit i is the parity of x and byte 7 - i of the matrix.
+ */
+uint64_t gfni_matrix(uint8_t c)
+{
+  uint64_t matrix = 0;
+  for (unsigned i = 0; i < 8; i++) {
+    uint8_t row = 0;
+    for (unsigned j = 0; j < 8; j++) {
+      if ((gf_mul(c, 1 << j) >> i) & 1)
+	row |= 1 << j;
+    }
+    matrix |= (uint64_t)row << (8 * (7 - i));
+  }
+  return matrix;
+}
+
+TARGET_GFNI
+void gfni_mul_xor(uint8_t c, const uint8_t *src, uint8_t *dst, size_t len)
+{
+  if (c <= 1 || len < 64) {
+    if (c == 1)
+      avx512_xor(src, dst, len);
+    else
+      generic_mul_xor(c, src, dst, len);
+    return;
+  }
+  const __m512i matrix = _mm512_set1_epi64(gfni_matrix(c));
+  for (; len >= 64; len -= 64, src += 64, dst += 64) {
+    __m512i s = _mm512_loadu_si512(src);
+    __m512i p = _mm512_gf2p8affine_epi64_epi8(s, matrix, 0);
+    __m512i d = _mm512_loadu_si512(dst);
+    _mm512_storeu_si512(dst, _mm512_xor_si512(p, d));
+  }
+  generic_mul_xor(c, src, dst, len);
+}
+
+const kernel_t avx2_kernel = {
+  "avx2", avx2_xor, avx2_mul_xor
+};
+const kernel_t avx512_kernel = {
+  "avx512", avx512_xor, avx512_mul_xor
+};
+const kernel_t gfni_kernel = {
+  "gfni", avx512_xor, gfni_mul_xor
+};
+
+#elif defined(__aarch64__)
+
+void neon_xor(const uint8_t *src, uint8_t *dst, size_t len)
+{
+  for (; len >= 16; len -= 16, src += 16, dst += 16) {
+    vst1q_u8(dst, veorq_u8(vld1q_u8(src), vld1q_u8(dst)));
+  }
+  generic_xor(src, dst, len);
+}
+
+void neon_mul_xor(uint8_t c, const uint8_t *src, uint8_t *dst, size_t len)
+{
+  if (c <= 1 || len < 16) {
+    if (c == 1)
+      neon_xor(src, dst, len);
+    else
+      generic_mul_xor(c, src, dst, len);
+    return;
+  }
+  uint8_t lo[16], hi[16];
+  nibble_tables(c, lo, hi);
+  const uint8x16_t tlo = vld1q_u8(lo);
+  const uint8x16_t thi = vld1q_u8(hi);
+  const uint8x16_t mask = vdupq_n_u8(0x0f);
+  for (; len >= 16; len -= 16, src += 16, dst += 16) {
+    uint8x16_t s = vld1q_u8(src);
+    uint8x16_t p = veorq_u8(vqtbl1q_u8(tlo, vandq_u8(s, mask)),
+			    vqtbl1q_u8(thi, vshrq_n_u8(s, 4)));
+    vst1q_u8(dst, veorq_u8(p, vld1q_u8(dst)));
+  }
+  generic_mul_xor(c, src, dst, len);
+}
+
+const kernel_t neon_kernel = {
+  "neon", neon_xor, neon_mul_xor
+};
+
+#endif
+
+const kernel_t *choose()
+{
+  ceph_arch_probe();
+  auto supported = get_supported();
+  return supported.back();
+}
+
+std::atomic<const kernel_t*> &current()
+{
+  static std::atomic<const kernel_t*> kernel{choose()};
+  return kernel;
+}
+
+} // anonymous namespace
+
+uint8_t gf_mul(uint8_t a, uint8_t b)
+{
+  if (a == 0 || b == 0)
+    return 0;
+  const gf_tables_t &t = gf_tables();
+  return t.exp[t.log[a] + t.log[b]];
+}
+
+std::vector<const kernel_t*> get_supported()
+{
+  ceph_arch_probe();
+  std::vector<const kernel_t*> supported = { &generic_kernel };
+#if defined(__x86_64__)
+  if (ceph_arch_intel_avx2)
+    supported.push_back(&avx2_kernel);
+  if (ceph_arch_intel_avx512)
+    supported.push_back(&avx512_kernel);
+  if (ceph_arch_intel_avx512 && ceph_arch_intel_gfni)
+    supported.push_back(&gfni_kernel);
+#elif defined(__aarch64__)
+  if (ceph_arch_neon)
+    supported.push_back(&neon_kernel);
+#endif
+  return supported;
+}
+
+const kernel_t &get()
+{
+  return *current().load(std::memory_order_relaxed);
+}
+
+bool select(const std::string &name)
+{
+  for (auto kernel : get_supported()) {
+    if (name == kernel->name) {
+      current().store(kernel);
+      return true;
+    }
+  }
+  return false;
+}
+
+void region_dot_prod(const int *coeffs, const uint8_t * const *src, int n,
+		     uint8_t *dst, size_t len)
+{
+  const kernel_t &kernel = get();
+  memset(dst, 0, len);
+  for (int i = 0; i < n; i++) {
+    kernel.region_mul_xor(coeffs[i], src[i], dst, len);
+  }
+}
+
+}
+}
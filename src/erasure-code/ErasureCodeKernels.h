@@ -0,0 +1,66 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph distributed storage system
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+#ifndef CEPH_ERASURE_CODE_KERNELS_H
+#define CEPH_ERASURE_CODE_KERNELS_H
+
+/*! @file ErasureCodeKernels.h
+    @brief Region kernels over GF(2^8) shared by the erasure code plugins
+
+    The field is the one used by jerasure (w=8) and isa-l, generated by
+    x^8 + x^4 + x^3 + x^2 + 1 (0x11d).  The best implementation the CPU
+    supports is picked once at load time, in the same way as crc32c.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ceph {
+namespace ec_kernel {
+
+  struct kernel_t {
+    const char *name;
+    /// dst ^= src
+    void (*region_xor)(const uint8_t *src, uint8_t *dst, size_t len);
+    /// dst ^= c * src
+    void (*region_mul_xor)(uint8_t c, const uint8_t *src, uint8_t *dst,
+			   size_t len);
+  };
+
+  /// the kernel used by the plugins
+  const kernel_t &get();
+
+  /// every kernel compiled in and supported by this CPU, generic first
+  std::vector<const kernel_t*> get_supported();
+
+  /**
+   * Use the supported kernel called name instead of the default one,
+   * for benchmarking.  Returns false if there is no such kernel.
+   */
+  bool select(const std::string &name);
+
+  /// product of two field elements
+  uint8_t gf_mul(uint8_t a, uint8_t b);
+
+  /**
+   * dst = coeffs[0] * src[0] + ... + coeffs[n - 1] * src[n - 1], the
+   * computation behind a row of a Reed-Solomon generator matrix.
+   */
+  void region_dot_prod(const int *coeffs, const uint8_t * const *src, int n,
+		       uint8_t *dst, size_t len);
+
+}
+}
+
+#endif
@@ -106,6 +106,50 @@ int ErasureCodeClay::minimum_to_decode(const set<int> &want_to_read,
   }
 }
 
+int ErasureCodeClay::minimum_to_decode_with_cost(const set<int> &want_to_read,
+						 const map<int, int> &available,
+						 set<int> *minimum)
+{
+  set<int> available_chunks;
+  for (auto &[chunk, cost] : available) {
+    available_chunks.insert(chunk);
+  }
+  if (!is_repair(want_to_read, available_chunks)) {
+    return ErasureCode::minimum_to_decode_with_cost(want_to_read, available,
+						    minimum);
+  }
+
+  int i = *want_to_read.begin();
+  int lost_node_index = (i < k) ? i : i+nu;
+  for (int j = 0; j < q; j++) {
+    int node = (lost_node_index/q)*q+j;
+    if (node == lost_node_index) {
+      continue;
+    }
+    if (node < k) {
+      minimum->insert(node);
+    } else if (node >= k+nu) {
+      minimum->insert(node-nu);
+    }
+  }
+
+  vector<pair<int, int>> by_cost;
+  for (auto &[chunk, cost] : available) {
+    if (!minimum->count(chunk)) {
+      by_cost.emplace_back(cost, chunk);
+    }
+  }
+  sort(by_cost.begin(), by_cost.end());
+  for (auto &[cost, chunk] : by_cost) {
+    if (minimum->size() >= (unsigned)d) {
+      break;
+    }
+    minimum->insert(chunk);
+  }
+  ceph_assert(minimum->size() == (unsigned)d);
+  return 0;
+}
+
 int ErasureCodeClay::decode(const set<int> &want_to_read,
 			    const map<int, bufferlist> &chunks,
 			    map<int, bufferlist> *decoded, int chunk_size)
@@ -64,6 +64,16 @@ public:
 			const std::set<int> &available,
 			std::map<int, std::vector<std::pair<int, int>>> *minimum) override;
 
+  /**
+   * For a single lost chunk, pick the d repair helpers so that the
+   * lost chunk's y-section peers are always included and the remaining
+   * helpers are the cheapest ones in **available**.  Anything that is
+   * not a repair falls back to ErasureCode::minimum_to_decode_with_cost.
+   */
+  int minimum_to_decode_with_cost(const std::set<int> &want_to_read,
+				  const std::map<int, int> &available,
+				  std::set<int> *minimum) override;
+
   int decode(const std::set<int> &want_to_read,
              const std::map<int, ceph::bufferlist> &chunks,
              std::map<int, ceph::bufferlist> *decoded, int chunk_size) override;
@@ -17,6 +17,7 @@
 
 #include "common/debug.h"
 #include "ErasureCodeJerasure.h"
+#include "erasure-code/ErasureCodeKernels.h"
 
 
 extern "C" {
@@ -159,6 +160,14 @@ void ErasureCodeJerasureReedSolomonVandermonde::jerasure_encode(char **data,
                                                                 char **coding,
                                                                 int blocksize)
 {
+  if (w == 8) {
+    // same field as galois_w08_region_multiply, with runtime chosen SIMD
+    for (int i = 0; i < m; i++) {
+      ceph::ec_kernel::region_dot_prod(matrix + i * k, (const uint8_t **)data, k,
+				 (uint8_t *)coding[i], blocksize);
+    }
+    return;
+  }
   jerasure_matrix_encode(k, m, w, matrix, data, coding, blocksize);
 }
 
@@ -210,6 +219,13 @@ void ErasureCodeJerasureReedSolomonRAID6::jerasure_encode(char **data,
                                                                 char **coding,
                                                                 int blocksize)
 {
+  if (w == 8) {
+    for (int i = 0; i < m; i++) {
+      ceph::ec_kernel::region_dot_prod(matrix + i * k, (const uint8_t **)data, k,
+				 (uint8_t *)coding[i], blocksize);
+    }
+    return;
+  }
   reed_sol_r6_encode(k, w, data, coding, blocksize);
 }
 
@@ -733,6 +733,48 @@ int ErasureCodeLrc::_minimum_to_decode(const set<int> &want_to_read,
   return -EIO;
 }
 
+int ErasureCodeLrc::minimum_to_decode_with_cost(const set<int> &want_to_read,
+						const map<int, int> &available,
+						set<int> *minimum)
+{
+  set<int> available_chunks;
+  for (auto &[chunk, cost] : available) {
+    available_chunks.insert(chunk);
+  }
+  int r = _minimum_to_decode(want_to_read, available_chunks, minimum);
+  if (r < 0)
+    return r;
+
+  auto total_cost = [&available](const set<int> &chunks) {
+    int64_t total = 0;
+    for (auto chunk : chunks) {
+      total += available.at(chunk);
+    }
+    return total;
+  };
+  vector<pair<int, int>> by_cost;
+  for (auto &[chunk, cost] : available) {
+    by_cost.emplace_back(cost, chunk);
+  }
+  sort(by_cost.rbegin(), by_cost.rend());
+
+  int64_t best = total_cost(*minimum);
+  for (auto &[cost, chunk] : by_cost) {
+    set<int> without = available_chunks;
+    without.erase(chunk);
+    set<int> candidate;
+    if (_minimum_to_decode(want_to_read, without, &candidate) == 0 &&
+	total_cost(candidate) < best) {
+      best = total_cost(candidate);
+      available_chunks.swap(without);
+      minimum->swap(candidate);
+    }
+  }
+  dout(20) << __func__ << " minimum = " << *minimum << " cost " << best
+	   << dendl;
+  return 0;
+}
+
 int ErasureCodeLrc::encode_chunks(const set<int> &want_to_encode,
 				  map<int, bufferlist> *encoded)
 {
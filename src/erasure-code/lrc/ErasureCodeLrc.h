@@ -91,6 +91,16 @@ public:
 			 const std::set<int> &available,
 			 std::set<int> *minimum) override;
 
+  /**
+   * Start from _minimum_to_decode and drop the most expensive chunks
+   * from **available** for as long as the layers can still decode
+   * **want_to_read** from what is left at a lower total cost, so that
+   * a local layer repair is preferred over reading across localities.
+   */
+  int minimum_to_decode_with_cost(const std::set<int> &want_to_read,
+				  const std::map<int, int> &available,
+				  std::set<int> *minimum) override;
+
   int create_rule(const std::string &name,
 			     CrushWrapper &crush,
 			     std::ostream *ss) const override;
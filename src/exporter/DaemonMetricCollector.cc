@@ -3,6 +3,7 @@
 #include <boost/json/src.hpp>
 #include <chrono>
 #include <filesystem>
+#include <iomanip>
 #include <iostream>
 #include <map>
 #include <memory>
@@ -48,7 +49,7 @@ void DaemonMetricCollector::main() {
   io.run();
 }
 
-std::string DaemonMetricCollector::get_metrics() {
+std::shared_ptr<const std::string> DaemonMetricCollector::get_metrics() {
   const std::lock_guard<std::mutex> lock(metrics_mutex);
   return metrics;
 }
@@ -56,8 +57,9 @@ std::string DaemonMetricCollector::get_metrics() {
 template <class T>
 void add_metric(std::unique_ptr<MetricsBuilder> &builder, T value,
                 std::string name, std::string description, std::string mtype,
-                labels_t labels) {
-  builder->add(std::to_string(value), name, description, mtype, labels);
+                labels_t labels, std::string suffix = "") {
+  builder->add(std::to_string(value), name, description, mtype, labels,
+               suffix);
 }
 
 void add_double_or_int_metric(std::unique_ptr<MetricsBuilder> &builder,
@@ -109,31 +111,46 @@ void DaemonMetricCollector::dump_asok_metrics() {
       failures++;
       continue;
     }
-    std::string perf_schema_response =
-        asok_request(sock_client, "perf schema", daemon_name);
-    if (perf_schema_response.size() == 0) {
-      failures++;
-      continue;
-    }
-    std::string config_show =
-        asok_request(sock_client, "config show", daemon_name);
-    if (config_show.size() == 0) {
-      failures++;
-      continue;
+    // The schema and the pid file only change when the daemon restarts,
+    // so they are fetched and parsed again only when its pid changes.
+    daemon_cache_t &cache = daemon_cache[daemon_name];
+    std::string pid_str;
+    if (!cache.schema.empty()) {
+      pid_str = read_file_to_string(cache.pid_path);
+      if (pid_str != cache.pid) {
+        dout(10) << daemon_name << " restarted, refreshing its schema" << dendl;
+        cache.schema.clear();
+      }
     }
-    json_object pid_file_json = boost::json::parse(config_show).as_object();
-    std::string pid_path =
-        boost_string_to_std(pid_file_json["pid_file"].as_string());
-    std::string pid_str = read_file_to_string(pid_path);
-    if (!pid_path.size()) {
-      dout(1) << "pid path is empty; process metrics won't be fetched for: "
-              << daemon_name << dendl;
+    if (cache.schema.empty()) {
+      std::string perf_schema_response =
+          asok_request(sock_client, "perf schema", daemon_name);
+      if (perf_schema_response.size() == 0) {
+        failures++;
+        continue;
+      }
+      std::string config_show =
+          asok_request(sock_client, "config show", daemon_name);
+      if (config_show.size() == 0) {
+        failures++;
+        continue;
+      }
+      json_object pid_file_json = boost::json::parse(config_show).as_object();
+      cache.pid_path =
+          boost_string_to_std(pid_file_json["pid_file"].as_string());
+      if (!cache.pid_path.size()) {
+        dout(1) << "pid path is empty; process metrics won't be fetched for: "
+                << daemon_name << dendl;
+      }
+      pid_str = read_file_to_string(cache.pid_path);
+      cache.pid = pid_str;
+      cache.schema = boost::json::parse(perf_schema_response).as_object();
     }
     if (!pid_str.empty()) {
       daemon_pids.push_back({daemon_name, std::stoi(pid_str)});
     }
     json_object dump = boost::json::parse(perf_dump_response).as_object();
-    json_object schema = boost::json::parse(perf_schema_response).as_object();
+    json_object &schema = cache.schema;
     for (auto &perf : schema) {
       std::string perf_group = {perf.key().begin(), perf.key().end()};
       json_object perf_group_object = perf.value().as_object();
@@ -157,6 +174,17 @@ void DaemonMetricCollector::dump_asok_metrics() {
         dump_asok_metric(perf_info, perf_values, name, labels);
       }
     }
+    if (dump.size() != schema.size()) {
+      // counters were added or removed at runtime; refresh next time
+      schema.clear();
+    }
+  }
+  for (auto it = daemon_cache.begin(); it != daemon_cache.end();) {
+    if (clients.count(it->first)) {
+      ++it;
+    } else {
+      it = daemon_cache.erase(it);
+    }
   }
   dout(10) << "Perf counters retrieved for " << clients.size() - failures << "/"
            << clients.size() << " daemons." << dendl;
@@ -175,7 +203,9 @@ void DaemonMetricCollector::dump_asok_metrics() {
   if (daemon_pids.size() != 0) {
     get_process_metrics(daemon_pids);
   }
-  metrics = builder->dump();
+  // readers keep serving the previous rendering until they are done
+  // with it; nothing is copied per scrape
+  metrics = std::make_shared<const std::string>(builder->dump());
 }
 
 std::vector<std::string> read_proc_stat_file(std::string path) {
@@ -304,7 +334,10 @@ void DaemonMetricCollector::dump_asok_metric(json_object perf_info,
   std::string description =
       boost_string_to_std(perf_info["description"].as_string());
 
-  if (type & PERFCOUNTER_LONGRUNAVG) {
+  if ((type & PERFCOUNTER_HDR_HISTOGRAM) &&
+      perf_values.as_object().contains("buckets")) {
+    dump_hdr_histogram(perf_values, name, description, labels);
+  } else if (type & PERFCOUNTER_LONGRUNAVG) {
     int64_t count = perf_values.as_object()["avgcount"].as_int64();
     add_metric(builder, count, name + "_count", description, metric_type,
                labels);
@@ -325,6 +358,57 @@ void DaemonMetricCollector::dump_asok_metric(json_object perf_info,
   }
 }
 
+/*
+A PerfHdrHistogram is dumped as its non-empty buckets with the largest
+nanosecond value of each.  Its buckets split every power of two, so they
+are summed up into a native histogram with a bucket per power of two
+nanoseconds, which keeps the set of series fixed.
+ */
+void DaemonMetricCollector::dump_hdr_histogram(json_value perf_values,
+                                               std::string name,
+                                               std::string description,
+                                               labels_t labels) {
+  constexpr unsigned min_bits = 10;  // ~1us
+  constexpr unsigned max_bits = 40;  // ~18m
+  std::vector<uint64_t> counts(max_bits - min_bits + 1, 0);
+  json_object &values = perf_values.as_object();
+  for (auto &b : values["buckets"].as_array()) {
+    json_object &bucket = b.as_object();
+    uint64_t max = bucket["max"].to_number<uint64_t>();
+    uint64_t count = bucket["count"].to_number<uint64_t>();
+    // first power of two the bucket lies entirely below
+    unsigned bits = max ? 64 - __builtin_clzll(max) : 0;
+    if (bits <= max_bits) {
+      counts[std::max(bits, min_bits) - min_bits] += count;
+    }
+  }
+
+  uint64_t cumulative = 0;
+  for (unsigned i = 0; i < counts.size(); ++i) {
+    cumulative += counts[i];
+    std::ostringstream le;
+    le << std::setprecision(9) << (double)(1ull << (min_bits + i)) / 1000000000.0;
+    labels_t bucket_labels = labels;
+    bucket_labels["le"] = quote(le.str());
+    add_metric(builder, cumulative, name, description, "histogram",
+               bucket_labels, "_bucket");
+  }
+  int64_t count = values["avgcount"].as_int64();
+  labels_t inf_labels = labels;
+  inf_labels["le"] = quote("+Inf");
+  add_metric(builder, count, name, description, "histogram", inf_labels,
+             "_bucket");
+  add_metric(builder, count, name, description, "histogram", labels, "_count");
+  json_value sum_value = values["sum"];
+  if (sum_value.is_double()) {
+    add_metric(builder, sum_value.as_double(), name, description, "histogram",
+               labels, "_sum");
+  } else if (sum_value.is_int64()) {
+    add_metric(builder, sum_value.as_int64(), name, description, "histogram",
+               labels, "_sum");
+  }
+}
+
 void DaemonMetricCollector::update_sockets() {
   std::string sock_dir = g_conf().get_val<std::string>("exporter_sock_dir");
   clients.clear();
@@ -350,13 +434,13 @@ void DaemonMetricCollector::update_sockets() {
 
 void OrderedMetricsBuilder::add(std::string value, std::string name,
                                 std::string description, std::string mtype,
-                                labels_t labels) {
+                                labels_t labels, std::string suffix) {
   if (metrics.find(name) == metrics.end()) {
     Metric metric(name, mtype, description);
     metrics[name] = std::move(metric);
   }
   Metric &metric = metrics[name];
-  metric.add(labels, value);
+  metric.add(labels, value, suffix);
 }
 
 std::string OrderedMetricsBuilder::dump() {
@@ -368,18 +452,19 @@ std::string OrderedMetricsBuilder::dump() {
 
 void UnorderedMetricsBuilder::add(std::string value, std::string name,
                                   std::string description, std::string mtype,
-                                  labels_t labels) {
+                                  labels_t labels, std::string suffix) {
   Metric metric(name, mtype, description);
-  metric.add(labels, value);
+  metric.add(labels, value, suffix);
   out += metric.dump() + "\n\n";
 }
 
 std::string UnorderedMetricsBuilder::dump() { return out; }
 
-void Metric::add(labels_t labels, std::string value) {
+void Metric::add(labels_t labels, std::string value, std::string suffix) {
   metric_entry entry;
   entry.labels = labels;
   entry.value = value;
+  entry.suffix = suffix;
   entries.push_back(entry);
 }
 
@@ -397,7 +482,8 @@ std::string Metric::dump() {
       }
       i++;
     }
-    metric_ss << name << "{" << labels_ss.str() << "} " << entry.value;
+    metric_ss << name << entry.suffix << "{" << labels_ss.str() << "} "
+              << entry.value;
     if (&entry != &entries.back()) {
       metric_ss << "\n";
     }
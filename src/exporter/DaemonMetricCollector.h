@@ -9,6 +9,8 @@
 #include <boost/json/object.hpp>
 #include <filesystem>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -33,11 +35,19 @@ typedef std::map<std::string, std::string> labels_t;
 class DaemonMetricCollector {
 public:
   void main();
-  std::string get_metrics();
+  std::shared_ptr<const std::string> get_metrics();
 
 private:
+  // per-daemon state that only changes when the daemon restarts
+  struct daemon_cache_t {
+    std::string pid_path;
+    std::string pid;
+    boost::json::object schema;
+  };
   std::map<std::string, AdminSocketClient> clients;
-  std::string metrics;
+  std::map<std::string, daemon_cache_t> daemon_cache;
+  std::shared_ptr<const std::string> metrics =
+    std::make_shared<const std::string>();
   std::mutex metrics_mutex;
   std::unique_ptr<MetricsBuilder> builder;
   void update_sockets();
@@ -49,6 +59,8 @@ private:
                         labels_t labels);
   std::pair<labels_t, std::string>
   get_labels_and_metric_name(std::string daemon_name, std::string metric_name);
+  void dump_hdr_histogram(json_value perf_values, std::string name,
+                          std::string description, labels_t labels);
   void get_process_metrics(std::vector<std::pair<std::string, int>> daemon_pids);
   std::string asok_request(AdminSocketClient &asok, std::string command, std::string daemon_name);
 };
@@ -58,6 +70,7 @@ private:
   struct metric_entry {
     labels_t labels;
     std::string value;
+    std::string suffix;  // e.g. "_bucket" for the samples of a histogram
   };
   std::string name;
   std::string mtype;
@@ -69,7 +82,7 @@ public:
       : name(name), mtype(mtype), description(description) {}
   Metric(const Metric &) = default;
   Metric() = default;
-  void add(labels_t labels, std::string value);
+  void add(labels_t labels, std::string value, std::string suffix = "");
   std::string dump();
 };
 
@@ -78,7 +91,8 @@ public:
   virtual ~MetricsBuilder() = default;
   virtual std::string dump() = 0;
   virtual void add(std::string value, std::string name, std::string description,
-                   std::string mtype, labels_t labels) = 0;
+                   std::string mtype, labels_t labels,
+                   std::string suffix = "") = 0;
 
 protected:
   std::string out;
@@ -91,14 +105,14 @@ private:
 public:
   std::string dump();
   void add(std::string value, std::string name, std::string description,
-           std::string mtype, labels_t labels);
+           std::string mtype, labels_t labels, std::string suffix = "");
 };
 
 class UnorderedMetricsBuilder : public MetricsBuilder {
 public:
   std::string dump();
   void add(std::string value, std::string name, std::string description,
-           std::string mtype, labels_t labels);
+           std::string mtype, labels_t labels, std::string suffix = "");
 };
 
 DaemonMetricCollector &collector_instance();
@@ -8,6 +8,7 @@
 #include <boost/asio.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
+#include <boost/beast/http/span_body.hpp>
 #include <boost/beast/version.hpp>
 #include <boost/thread/thread.hpp>
 #include <chrono>
@@ -40,7 +41,10 @@ private:
   tcp::socket socket_;
   beast::flat_buffer buffer_{8192};
   http::request<http::dynamic_body> request_;
-  http::response<http::string_body> response_;
+  // the body is a view of body_, which may be the collector's rendering
+  // shared with other connections
+  http::response<http::span_body<char const>> response_;
+  std::shared_ptr<const std::string> body_;
 
   net::steady_timer deadline_{socket_.get_executor(), std::chrono::seconds(60)};
 
@@ -61,6 +65,15 @@ private:
                      });
   }
 
+  void set_body(std::shared_ptr<const std::string> body) {
+    body_ = std::move(body);
+    response_.body() = {body_->data(), body_->size()};
+  }
+
+  void set_body(std::string body) {
+    set_body(std::make_shared<const std::string>(std::move(body)));
+  }
+
   // Determine what needs to be done with the request message.
   void process_request() {
     response_.version(request_.version());
@@ -79,7 +92,7 @@ private:
       response_.set(http::field::content_type, "text/plain");
       std::string body("Invalid request-method '" +
                        std::string(request_.method_string()) + "'");
-      response_.body() = body;
+      set_body(std::move(body));
       break;
     }
 
@@ -97,16 +110,15 @@ private:
                        "<p><a href='/metrics'>Metrics</a></p>"
                        "</body>\n"
                        "</html>\n");
-      response_.body() = body;
+      set_body(std::move(body));
     } else if (request_.target() == "/metrics") {
       response_.set(http::field::content_type, "text/plain; charset=utf-8");
       DaemonMetricCollector &collector = collector_instance();
-      std::string metrics = collector.get_metrics();
-      response_.body() = metrics;
+      set_body(collector.get_metrics());
     } else {
       response_.result(http::status::method_not_allowed);
       response_.set(http::field::content_type, "text/plain");
-      response_.body() = "File not found \n";
+      set_body(std::string("File not found \n"));
     }
   }
 
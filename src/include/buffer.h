@@ -118,6 +118,10 @@ struct error_code;
   int get_missed_crc();
   /// enable/disable tracking of cached crcs
   void track_cached_crc(bool b);
+  /// count of ptr_node allocations that went to the heap on this thread
+  uint64_t get_ptr_node_heap_allocs();
+  /// count of ptr_node allocations served by this thread's node cache
+  uint64_t get_ptr_node_cached_allocs();
 
   /*
    * an abstract raw buffer.  with a reference count.
@@ -370,6 +374,11 @@ struct error_code;
 
     ~ptr_node() = default;
 
+    // nodes are recycled through a small per-thread free list, so the
+    // many tiny ptr_nodes of encode/decode don't each hit malloc
+    static void* operator new(size_t size);
+    static void operator delete(void* p, size_t size) noexcept;
+
     static std::unique_ptr<ptr_node, disposer>
     create(ceph::unique_leakable_ptr<raw> r) {
       return create_hypercombined(std::move(r));
@@ -146,7 +146,7 @@ DEFINE_CEPH_FEATURE(41, 1, OSD_PRIMARY_AFFINITY) // overlap
 DEFINE_CEPH_FEATURE(42, 1, MSGR_KEEPALIVE2)  // 4.3 (for consistency)
 DEFINE_CEPH_FEATURE(43, 1, OSD_POOLRESEND)   // 4.13
 DEFINE_CEPH_FEATURE_RETIRED(44, 1, ERASURE_CODE_PLUGINS_V2, MIMIC, OCTOPUS)
-// available
+DEFINE_CEPH_FEATURE(44, 3, OSD_OP_BATCH)
 DEFINE_CEPH_FEATURE_RETIRED(45, 1, OSD_SET_ALLOC_HINT, JEWEL, LUMINOUS)
 // available
 DEFINE_CEPH_FEATURE(46, 1, OSD_FADVISE_FLAGS)
@@ -252,6 +252,7 @@ DEFINE_CEPH_FEATURE_RETIRED(63, 1, RESERVED_BROKEN, LUMINOUS, QUINCY) // client-
 	 CEPH_FEATUREMASK_SERVER_QUINCY | \
 	 CEPH_FEATURE_RANGE_BLOCKLIST | \
 	 CEPH_FEATUREMASK_SERVER_REEF | \
+	 CEPH_FEATUREMASK_OSD_OP_BATCH | \
 	 0ULL)
 
 #define CEPH_FEATURES_SUPPORTED_DEFAULT  CEPH_FEATURES_ALL
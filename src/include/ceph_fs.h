@@ -163,6 +163,7 @@ extern const char *ceph_con_mode_name(int con_mode);
 #define CEPH_MSG_CLIENT_SNAP            0x312
 #define CEPH_MSG_CLIENT_CAPRELEASE      0x313
 #define CEPH_MSG_CLIENT_QUOTA           0x314
+#define CEPH_MSG_CLIENT_CAPS_BATCH      0x315
 
 /* pool ops */
 #define CEPH_MSG_POOLOP_REPLY           48
@@ -175,6 +176,7 @@ extern const char *ceph_con_mode_name(int con_mode);
 #define CEPH_MSG_OSD_OPREPLY            43
 #define CEPH_MSG_WATCH_NOTIFY           44
 #define CEPH_MSG_OSD_BACKOFF            61
+#define CEPH_MSG_OSD_OP_BATCH           55
 
 /* FSMap subscribers (see all MDS clusters at once) */
 #define CEPH_MSG_FS_MAP                 45
@@ -389,6 +391,7 @@ enum {
 	CEPH_MDS_OP_LOOKUPNAME = 0x00105,
 	CEPH_MDS_OP_GETVXATTR  = 0x00106,
 	CEPH_MDS_OP_DUMMY = 0x00107,
+	CEPH_MDS_OP_LOOKUPBATCH = 0x00108,
 
 	CEPH_MDS_OP_SETXATTR   = 0x01105,
 	CEPH_MDS_OP_RMXATTR    = 0x01106,
@@ -8,6 +8,18 @@ extern unsigned ceph_str_hash_linux(const char *s, unsigned len);
 extern unsigned ceph_str_hash_rjenkins(const char *s, unsigned len);
 
 extern unsigned ceph_str_hash(int type, const char *s, unsigned len);
+
+/*
+ * hash n strings at once; out[i] is the hash of strs[i], lens[i].
+ * rjenkins hashes several strings side by side in vector lanes where
+ * the cpu supports it.
+ */
+extern void ceph_str_hash_rjenkins_batch(const char * const *strs,
+					 const unsigned *lens,
+					 unsigned n, unsigned *out);
+extern void ceph_str_hash_batch(int type, const char * const *strs,
+				const unsigned *lens, unsigned n,
+				unsigned *out);
 extern const char *ceph_str_hash_name(int type);
 extern bool ceph_str_hash_valid(int type);
 
@@ -40,7 +40,7 @@ extern "C" {
 
 #define LIBCEPHFS_VER_MAJOR 10
 #define LIBCEPHFS_VER_MINOR 0
-#define LIBCEPHFS_VER_EXTRA 3
+#define LIBCEPHFS_VER_EXTRA 5
 
 #define LIBCEPHFS_VERSION(maj, min, extra) ((maj << 16) + (min << 8) + extra)
 #define LIBCEPHFS_VERSION_CODE LIBCEPHFS_VERSION(LIBCEPHFS_VER_MAJOR, LIBCEPHFS_VER_MINOR, LIBCEPHFS_VER_EXTRA)
@@ -1850,6 +1850,31 @@ int ceph_ll_lookup_root(struct ceph_mount_info *cmount,
 int ceph_ll_lookup(struct ceph_mount_info *cmount, Inode *parent,
 		   const char *name, Inode **out, struct ceph_statx *stx,
 		   unsigned want, unsigned flags, const UserPerm *perms);
+
+/**
+ * Look up several names in one directory.
+ *
+ * Names without a usable cached dentry are sent to the MDS together,
+ * rather than one request per name.  Each entry is then filled in as
+ * ceph_ll_lookup() would, and each inode found must be released with
+ * ceph_ll_put().
+ *
+ * @param cmount the ceph mount handle to use.
+ * @param parent the directory to look in.
+ * @param count number of names.
+ * @param names the names to look up.
+ * @param out where to store the inode of each name, or NULL.
+ * @param stx where to store the attributes of each name.
+ * @param results where to store the result of each lookup.
+ * @param want mask of statx fields wanted.
+ * @param flags AT_* flags for the lookups.
+ * @param perms the credentials to use.
+ * @returns 0 once every name has a result, or a negative error code.
+ */
+int ceph_ll_lookup_batch(struct ceph_mount_info *cmount, Inode *parent,
+			 int count, const char * const names[], Inode *out[],
+			 struct ceph_statx stx[], int results[],
+			 unsigned want, unsigned flags, const UserPerm *perms);
 int ceph_ll_put(struct ceph_mount_info *cmount, struct Inode *in);
 int ceph_ll_forget(struct ceph_mount_info *cmount, struct Inode *in,
 		   int count);
@@ -2139,6 +2164,83 @@ int ceph_get_snap_info(struct ceph_mount_info *cmount,
  * @param snap_info snapshot info struct (fetched via call to ceph_get_snap_info()).
  */
 void ceph_free_snap_info_buffer(struct snap_info *snap_info);
+
+/*
+ * Asynchronous low-level operations.
+ *
+ * Operations are described by a struct ceph_ll_io, submitted to a
+ * completion queue, and run in the background by the queue's worker
+ * threads.  Finished operations are reaped from the queue with
+ * ceph_ll_cq_wait(); until then the caller must keep the ceph_ll_io
+ * and any buffers it points to alive.
+ */
+struct ceph_ll_cq;
+
+enum {
+  CEPH_LL_IO_OPEN = 1,     /* in, flags, perms -> fh */
+  CEPH_LL_IO_READ = 2,     /* fh, offset, iov, iovcnt */
+  CEPH_LL_IO_WRITE = 3,    /* fh, offset, iov, iovcnt */
+  CEPH_LL_IO_FSYNC = 4,    /* fh, flags (non-zero: data only) */
+  CEPH_LL_IO_GETATTR = 5,  /* in, stx, want, flags, perms */
+};
+
+struct ceph_ll_io {
+  int op;                  /* CEPH_LL_IO_* */
+  struct Inode *in;
+  struct Fh *fh;
+  int64_t offset;
+  const struct iovec *iov;
+  int iovcnt;
+  struct ceph_statx *stx;
+  unsigned int want;
+  int flags;
+  const UserPerm *perms;
+
+  int64_t result;          /* set on completion, as for the sync call */
+  void *priv;              /* for the caller */
+};
+
+/**
+ * Create a completion queue.
+ *
+ * @param cmount the ceph mount handle to use.
+ * @param nthreads number of worker threads running submitted operations.
+ * @param cq where to store the new queue.
+ * @returns 0 on success or a negative error code.
+ */
+int ceph_ll_cq_create(struct ceph_mount_info *cmount, unsigned int nthreads,
+		      struct ceph_ll_cq **cq);
+
+/**
+ * Destroy a completion queue, after the operations submitted to it
+ * have finished.  Completions that have not been reaped are dropped.
+ *
+ * @param cq the queue to destroy.
+ */
+void ceph_ll_cq_destroy(struct ceph_ll_cq *cq);
+
+/**
+ * Submit operations to a completion queue.
+ *
+ * @param cq the queue to submit to.
+ * @param ios the operations.
+ * @param nr number of operations in ios.
+ * @returns the number of operations submitted or a negative error code.
+ */
+int ceph_ll_submit(struct ceph_ll_cq *cq, struct ceph_ll_io **ios, int nr);
+
+/**
+ * Reap completed operations.
+ *
+ * @param cq the queue to reap from.
+ * @param ios where to store the completed operations.
+ * @param min_nr wait until at least this many have completed...
+ * @param max_nr ...and return at most this many.
+ * @param timeout_ms give up waiting after this long; negative waits forever.
+ * @returns the number of operations stored in ios.
+ */
+int ceph_ll_cq_wait(struct ceph_ll_cq *cq, struct ceph_ll_io **ios,
+		    int min_nr, int max_nr, int64_t timeout_ms);
 #ifdef __cplusplus
 }
 #endif
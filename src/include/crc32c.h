@@ -50,6 +50,17 @@ static inline uint32_t ceph_crc32c(uint32_t crc, unsigned char const *data, unsi
   return ceph_crc32c_func(crc, data, length);
 }
 
+/**
+ * calculate crc32c of several independent buffers of the same length
+ *
+ * @param crcs in: initial value for each buffer, out: its crc
+ * @param data n pointers to data buffers (must not be NULL)
+ * @param length length of each buffer
+ * @param n number of buffers
+ */
+void ceph_crc32c_multi(uint32_t *crcs, unsigned char const * const *data,
+		       unsigned length, unsigned n);
+
 #ifdef __cplusplus
 }
 #endif
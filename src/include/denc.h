@@ -404,6 +404,33 @@ struct denc_traits<T>
   }
 };
 
+// memcpy-able types
+//
+// A type is memcpy-able if its encoding is byte-for-byte its in-memory
+// representation, so that a contiguous run of them (e.g., a std::vector)
+// can be encoded and decoded with a single memcpy instead of an element
+// loop.  The raw little-endian types always qualify; the native integer
+// types only on little-endian hosts.  (bool does not: decoding an
+// arbitrary byte into a bool is not a copy.)  Fixed-size structs opt in
+// with WRITE_CLASS_DENC_MEMCPY().
+template<typename T>
+struct denc_memcpy_traits {
+  static constexpr bool value = false;
+};
+
+namespace _denc {
+template<typename T>
+inline constexpr bool is_memcpy_v =
+  is_any_of<T, ceph_le64, ceph_le32, ceph_le16, uint8_t
+#ifndef _CHAR_IS_SIGNED
+	    , int8_t
+#endif
+	    > ||
+  (std::endian::native == std::endian::little &&
+   is_any_of<T, int16_t, uint16_t, int32_t, uint32_t, int64_t, uint64_t>) ||
+  denc_memcpy_traits<T>::value;
+} // namespace _denc
+
 // varint
 //
 // high bit of each byte indicates another byte follows.
@@ -437,6 +464,30 @@ inline void denc_varint(T& v, ceph::buffer::ptr::const_iterator& p) {
   }
 }
 
+// decode n consecutive varints.  runs of single-byte values (the
+// common case for small counters) are picked off eight at a time.
+template<typename T>
+inline void denc_varint_n(T* v, size_t n, ceph::buffer::ptr::const_iterator& p) {
+  while (n >= 8 && p.get_end() - p.get_pos() >= 8) {
+    uint64_t word;
+    std::memcpy(&word, p.get_pos(), sizeof(word));
+    if (word & 0x8080808080808080ull) {
+      denc_varint(*v++, p);
+      --n;
+      continue;
+    }
+    auto b = reinterpret_cast<const uint8_t*>(p.get_pos_add(8));
+    for (unsigned i = 0; i < 8; ++i) {
+      v[i] = b[i];
+    }
+    v += 8;
+    n -= 8;
+  }
+  while (n--) {
+    denc_varint(*v++, p);
+  }
+}
+
 
 // signed varint encoding
 //
@@ -929,6 +980,15 @@ namespace _denc {
     static constexpr bool bounded = false;
     static constexpr bool need_contiguous = traits::need_contiguous;
 
+  private:
+    // contiguous containers of memcpy-able elements move in one copy
+    static constexpr bool bulk_copy = is_memcpy_v<T> &&
+      requires (container& c) {
+        { c.data() } -> std::same_as<T*>;
+        c.resize(size_t{});
+      };
+
+  public:
     template<typename U=T>
     static void bound_encode(const container& s, size_t& p, uint64_t f = 0) {
       p += sizeof(uint32_t);
@@ -992,6 +1052,10 @@ namespace _denc {
     // nohead
     static void encode_nohead(const container& s, ceph::buffer::list::contiguous_appender& p,
 			      uint64_t f = 0) {
+      if constexpr (bulk_copy) {
+        p.append(reinterpret_cast<const char*>(s.data()), s.size() * sizeof(T));
+        return;
+      }
       for (const T& e : s) {
         if constexpr (traits::featured) {
           denc(e, p, f);
@@ -1003,6 +1067,13 @@ namespace _denc {
     static void decode_nohead(size_t num, container& s,
 			      ceph::buffer::ptr::const_iterator& p,
 			      uint64_t f=0) {
+      if constexpr (bulk_copy) {
+        // bounds-check before sizing the container off an untrusted count
+        const auto src = p.get_pos_add(num * sizeof(T));
+        s.resize(num);
+        std::memcpy(s.data(), src, num * sizeof(T));
+        return;
+      }
       s.clear();
       Details::reserve(s, num);
       while (num--) {
@@ -1015,6 +1086,14 @@ namespace _denc {
     static std::enable_if_t<!!sizeof(U) && !need_contiguous>
     decode_nohead(size_t num, container& s,
 		  ceph::buffer::list::const_iterator& p) {
+      if constexpr (bulk_copy) {
+        if (num * sizeof(T) > p.get_remaining()) {
+          throw ceph::buffer::end_of_buffer();
+        }
+        s.resize(num);
+        p.copy(num * sizeof(T), reinterpret_cast<char*>(s.data()));
+        return;
+      }
       s.clear();
       Details::reserve(s, num);
       while (num--) {
@@ -1629,6 +1708,22 @@ struct denc_traits<std::nullopt_t> {
     }									\
   };
 
+// Mark a class whose encoding is exactly its in-memory layout (e.g., a
+// struct of ceph_le* fields with no DENC_START header) as memcpy-able, so
+// that vectors of it encode and decode with a single copy.  Must follow
+// the class's WRITE_CLASS_DENC_BOUNDED().
+
+#define WRITE_CLASS_DENC_MEMCPY(T)					\
+  static_assert(std::is_trivially_copyable_v<T>,			\
+		#T " must be trivially copyable to be memcpy-able");	\
+  static_assert(std::has_unique_object_representations_v<T>,		\
+		#T " must not contain padding to be memcpy-able");	\
+  static_assert(denc_traits<T>::bounded && !denc_traits<T>::featured,	\
+		#T " must be bounded and unfeatured to be memcpy-able"); \
+  template<> struct denc_memcpy_traits<T> {				\
+    static constexpr bool value = true;					\
+  };
+
 // ----------------------------------------------------------------------
 // encoded_sizeof_wrapper
 
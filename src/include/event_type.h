@@ -20,5 +20,6 @@
 #define EVENT_SOCKET_TYPE_NONE 0
 #define EVENT_SOCKET_TYPE_PIPE 1
 #define EVENT_SOCKET_TYPE_EVENTFD 2
+#define EVENT_SOCKET_TYPE_POLL 3
 
 #endif
@@ -15,6 +15,7 @@
 #ifndef _CEPH_INCLUDE_MEMPOOL_H
 #define _CEPH_INCLUDE_MEMPOOL_H
 
+#include <atomic>
 #include <cstddef>
 #include <map>
 #include <unordered_map>
@@ -28,6 +29,7 @@
 
 #include "common/Formatter.h"
 #include "common/ceph_atomic.h"
+#include "common/likely.h"
 #include "include/ceph_assert.h"
 #include "include/compact_map.h"
 #include "include/compact_set.h"
@@ -147,6 +149,7 @@ namespace mempool {
 // define memory pools
 
 #define DEFINE_MEMORY_POOLS_HELPER(f) \
+  f(bdev_ioring_buffers)	      \
   f(bloom_filter)		      \
   f(bluestore_alloc)		      \
   f(bluestore_cache_data)	      \
@@ -189,6 +192,18 @@ enum pool_index_t {
 extern bool debug_mode;
 extern void set_debug_mode(bool d);
 
+// Sampling allocation profiler.  With a nonzero profile_rate N, about
+// one in N allocations made through a pool_allocator records its pool,
+// type and a short backtrace until it is freed, so that dump_profile()
+// can attribute a pool's growth to the code that allocated it.  While
+// disabled, the allocator only loads profile_rate and profile_live.
+extern std::atomic<unsigned> profile_rate;
+extern std::atomic<size_t> profile_live;  // sampled allocations not yet freed
+extern void set_profile_rate(unsigned rate);
+void profile_alloc(pool_index_t ix, const char *type, void *p, size_t bytes);
+void profile_free(void *p);
+void dump_profile(ceph::Formatter *f);
+
 // --------------------------------------------------------------
 class pool_t;
 
@@ -346,6 +361,9 @@ public:
       type->items += n;
     }
     T* r = reinterpret_cast<T*>(new char[total]);
+    if (unlikely(profile_rate.load(std::memory_order_relaxed))) {
+      profile_alloc(pool_ix, typeid(T).name(), r, total);
+    }
     return r;
   }
 
@@ -357,6 +375,9 @@ public:
     if (type) {
       type->items -= n;
     }
+    if (unlikely(profile_live.load(std::memory_order_relaxed))) {
+      profile_free(p);
+    }
     delete[] reinterpret_cast<char*>(p);
   }
 
@@ -373,6 +394,9 @@ public:
     if (rc)
       throw std::bad_alloc();
     T* r = reinterpret_cast<T*>(ptr);
+    if (unlikely(profile_rate.load(std::memory_order_relaxed))) {
+      profile_alloc(pool_ix, typeid(T).name(), r, total);
+    }
     return r;
   }
 
@@ -384,6 +408,9 @@ public:
     if (type) {
       type->items -= n;
     }
+    if (unlikely(profile_live.load(std::memory_order_relaxed))) {
+      profile_free(p);
+    }
     aligned_free(p);
   }
 
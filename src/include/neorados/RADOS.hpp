@@ -549,29 +549,38 @@ public:
   executor_type get_executor() const;
   boost::asio::io_context& get_io_context();
 
+  // The execute() family initiates through async_initiate, so any
+  // completion token works, including boost::asio::use_awaitable and
+  // deferred tokens.  The completion is allocated with the handler's
+  // associated allocator and dispatched on its associated executor; a
+  // coroutine gets the per-thread recycling allocator and is resumed on
+  // its own executor.  With a lazy token the operation starts when it
+  // is awaited, so `o` and `ioc` must live until then.
+
   template<typename CompletionToken>
   auto execute(const Object& o, const IOContext& ioc, ReadOp&& op,
 	       ceph::buffer::list* bl,
 	       CompletionToken&& token, uint64_t* objver = nullptr,
 	       const blkin_trace_info* trace_info = nullptr) {
-    boost::asio::async_completion<CompletionToken, Op::Signature> init(token);
-    execute(o, ioc, std::move(op), bl,
-	    ReadOp::Completion::create(get_executor(),
-				       std::move(init.completion_handler)),
-	    objver, trace_info);
-    return init.result.get();
+    return boost::asio::async_initiate<CompletionToken, Op::Signature>(
+      [this, &o, &ioc, bl, objver, trace_info](auto&& handler, ReadOp&& op) {
+	execute(o, ioc, std::move(op), bl,
+		ReadOp::Completion::create(get_executor(),
+					   std::move(handler)),
+		objver, trace_info);
+      }, token, std::move(op));
   }
 
   template<typename CompletionToken>
   auto execute(const Object& o, const IOContext& ioc, WriteOp&& op,
 	       CompletionToken&& token, uint64_t* objver = nullptr,
 	       const blkin_trace_info* trace_info = nullptr) {
-    boost::asio::async_completion<CompletionToken, Op::Signature> init(token);
-    execute(o, ioc, std::move(op),
-	    Op::Completion::create(get_executor(),
-				   std::move(init.completion_handler)),
-	    objver, trace_info);
-    return init.result.get();
+    return boost::asio::async_initiate<CompletionToken, Op::Signature>(
+      [this, &o, &ioc, objver, trace_info](auto&& handler, WriteOp&& op) {
+	execute(o, ioc, std::move(op),
+		Op::Completion::create(get_executor(), std::move(handler)),
+		objver, trace_info);
+      }, token, std::move(op));
   }
 
   template<typename CompletionToken>
@@ -582,12 +591,13 @@ public:
 	       std::optional<std::string_view> ns = {},
 	       std::optional<std::string_view> key = {},
 	       uint64_t* objver = nullptr) {
-    boost::asio::async_completion<CompletionToken, Op::Signature> init(token);
-    execute(o, pool, std::move(op), bl,
-	    ReadOp::Completion::create(get_executor(),
-				       std::move(init.completion_handler)),
-	    ns, key, objver);
-    return init.result.get();
+    return boost::asio::async_initiate<CompletionToken, Op::Signature>(
+      [this, &o, pool, bl, ns, key, objver](auto&& handler, ReadOp&& op) {
+	execute(o, pool, std::move(op), bl,
+		ReadOp::Completion::create(get_executor(),
+					   std::move(handler)),
+		ns, key, objver);
+      }, token, std::move(op));
   }
 
   template<typename CompletionToken>
@@ -596,12 +606,12 @@ public:
 	       std::optional<std::string_view> ns = {},
 	       std::optional<std::string_view> key = {},
 	       uint64_t* objver = nullptr) {
-    boost::asio::async_completion<CompletionToken, Op::Signature> init(token);
-    execute(o, pool, std::move(op),
-	    Op::Completion::create(get_executor(),
-				   std::move(init.completion_handler)),
-	    ns, key, objver);
-    return init.result.get();
+    return boost::asio::async_initiate<CompletionToken, Op::Signature>(
+      [this, &o, pool, ns, key, objver](auto&& handler, WriteOp&& op) {
+	execute(o, pool, std::move(op),
+		Op::Completion::create(get_executor(), std::move(handler)),
+		ns, key, objver);
+      }, token, std::move(op));
   }
 
   boost::uuids::uuid get_fsid() const noexcept;
@@ -1213,6 +1213,29 @@ inline namespace v14_2_0 {
         ObjectReadOperation *op, int flags,
         bufferlist *pbl, const blkin_trace_info *trace_info);
 
+    /**
+     * Schedule operations on several objects with one completion
+     *
+     * Each operation is submitted as if by its own aio_operate(), back
+     * to back, so that operations bound for the same OSD may be sent
+     * together.  The completion fires once all of them are done and
+     * returns 0; the result of each operation is stored in the matching
+     * entry of results.  Read output goes to the out parameters given
+     * to each ObjectReadOperation.
+     *
+     * @param c what to do when all operations are complete
+     * @param ops pairs of object name and operation to perform on it
+     * @param flags flags applied to every operation
+     * @param results resized to ops.size() and filled in, may be NULL
+     * @returns 0 on success, negative error code on failure
+     */
+    int aio_operate_batch(AioCompletion *c,
+        const std::vector<std::pair<std::string, ObjectReadOperation*>>& ops,
+        int flags, std::vector<int> *results);
+    int aio_operate_batch(AioCompletion *c,
+        const std::vector<std::pair<std::string, ObjectWriteOperation*>>& ops,
+        int flags, std::vector<int> *results);
+
     // watch/notify
     int watch2(const std::string& o, uint64_t *handle,
 	       librados::WatchCtx2 *ctx);
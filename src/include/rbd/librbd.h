@@ -131,10 +131,15 @@ typedef struct {
 /**
  * These types used to in set_image_notification to indicate the type of event
  * socket passed in.
+ *
+ * EVENT_TYPE_POLL takes no descriptor: completed I/Os are queued for
+ * rbd_poll_io_events() without writing to a pipe or eventfd, for
+ * applications that busy-poll for completions from their own thread.
  */
 enum {
   EVENT_TYPE_PIPE = 1,
-  EVENT_TYPE_EVENTFD = 2
+  EVENT_TYPE_EVENTFD = 2,
+  EVENT_TYPE_POLL = 3
 };
 
 typedef struct {
@@ -623,14 +623,44 @@ bool JournalPlayer::remove_empty_object_player(const ceph::ref_t<ObjectPlayer> &
 void JournalPlayer::fetch(uint64_t object_num) {
   ceph_assert(ceph_mutex_is_locked(m_lock));
 
-  auto object_player = ceph::make_ref<ObjectPlayer>(
-    m_ioctx, m_object_oid_prefix, object_num, m_journal_metadata->get_timer(),
-    m_journal_metadata->get_timer_lock(), m_journal_metadata->get_order(),
-    m_max_fetch_bytes);
-
   auto splay_width = m_journal_metadata->get_splay_width();
-  m_object_players[object_num % splay_width] = object_player;
-  fetch(object_player);
+  auto ahead_it = m_fetch_ahead_players.find(object_num);
+  if (ahead_it != m_fetch_ahead_players.end()) {
+    // claim the object player that was already read ahead
+    auto object_player = ahead_it->second;
+    m_fetch_ahead_players.erase(ahead_it);
+    m_object_players[object_num % splay_width] = object_player;
+
+    ceph_assert(m_fetch_object_numbers.count(object_num) == 0);
+    m_fetch_object_numbers.insert(object_num);
+
+    auto result_it = m_fetch_ahead_results.find(object_num);
+    if (result_it != m_fetch_ahead_results.end()) {
+      ldout(m_cct, 10) << __func__ << ": "
+                       << utils::get_object_name(m_object_oid_prefix,
+                                                 object_num)
+                       << ": already fetched" << dendl;
+      int r = result_it->second;
+      m_fetch_ahead_results.erase(result_it);
+      m_journal_metadata->queue(new C_Fetch(this, object_num), r);
+    } else {
+      // in-flight read will be handled as a regular fetch upon completion
+      ldout(m_cct, 10) << __func__ << ": "
+                       << utils::get_object_name(m_object_oid_prefix,
+                                                 object_num)
+                       << ": waiting for fetch ahead" << dendl;
+    }
+  } else {
+    auto object_player = ceph::make_ref<ObjectPlayer>(
+      m_ioctx, m_object_oid_prefix, object_num,
+      m_journal_metadata->get_timer(), m_journal_metadata->get_timer_lock(),
+      m_journal_metadata->get_order(), m_max_fetch_bytes);
+
+    m_object_players[object_num % splay_width] = object_player;
+    fetch(object_player);
+  }
+
+  fetch_ahead(object_num);
 }
 
 void JournalPlayer::fetch(const ceph::ref_t<ObjectPlayer> &object_player) {
@@ -667,6 +697,60 @@ void JournalPlayer::handle_fetched(uint64_t object_num, int r) {
   process_state(object_num, r);
 }
 
+void JournalPlayer::fetch_ahead(uint64_t object_num) {
+  ceph_assert(ceph_mutex_is_locked(m_lock));
+
+  auto fetch_ahead_objects =
+    m_journal_metadata->get_settings().fetch_ahead_objects;
+  if (fetch_ahead_objects == 0) {
+    return;
+  }
+
+  // only objects from closed object sets are read ahead since the
+  // active set might still be receiving appends
+  uint8_t splay_width = m_journal_metadata->get_splay_width();
+  uint64_t active_set = m_journal_metadata->get_active_set();
+  for (uint32_t i = 1; i <= fetch_ahead_objects; ++i) {
+    uint64_t ahead_object_num = object_num + i * splay_width;
+    if (ahead_object_num / splay_width >= active_set) {
+      break;
+    } else if (m_fetch_ahead_players.count(ahead_object_num) != 0) {
+      continue;
+    }
+
+    ldout(m_cct, 10) << __func__ << ": "
+                     << utils::get_object_name(m_object_oid_prefix,
+                                               ahead_object_num)
+                     << dendl;
+    auto object_player = ceph::make_ref<ObjectPlayer>(
+      m_ioctx, m_object_oid_prefix, ahead_object_num,
+      m_journal_metadata->get_timer(), m_journal_metadata->get_timer_lock(),
+      m_journal_metadata->get_order(), m_max_fetch_bytes);
+    m_fetch_ahead_players[ahead_object_num] = object_player;
+    object_player->fetch(new C_FetchAhead(this, ahead_object_num));
+  }
+}
+
+void JournalPlayer::handle_fetched_ahead(uint64_t object_num, int r) {
+  ldout(m_cct, 10) << __func__ << ": "
+                   << utils::get_object_name(m_object_oid_prefix, object_num)
+                   << ": r=" << r << dendl;
+
+  {
+    std::lock_guard locker{m_lock};
+    if (m_fetch_object_numbers.count(object_num) == 0) {
+      // playback hasn't reached this object yet
+      if (!m_shut_down && m_fetch_ahead_players.count(object_num) != 0) {
+        m_fetch_ahead_results[object_num] = r;
+      }
+      return;
+    }
+  }
+
+  // object was claimed by playback while the read was in-flight
+  handle_fetched(object_num, r);
+}
+
 void JournalPlayer::refetch(bool immediate) {
   ldout(m_cct, 10) << __func__ << dendl;
   ceph_assert(ceph_mutex_is_locked(m_lock));
@@ -865,6 +949,9 @@ void JournalPlayer::handle_cache_rebalanced(uint64_t new_cache_bytes) {
   for (auto &pair : m_object_players) {
     pair.second->set_max_fetch_bytes(m_max_fetch_bytes);
   }
+  for (auto &pair : m_fetch_ahead_players) {
+    pair.second->set_max_fetch_bytes(m_max_fetch_bytes);
+  }
 }
 
 
@@ -45,6 +45,8 @@ private:
   typedef std::set<uint8_t> PrefetchSplayOffsets;
   typedef std::map<uint8_t, ceph::ref_t<ObjectPlayer>> SplayedObjectPlayers;
   typedef std::map<uint8_t, ObjectPosition> SplayedObjectPositions;
+  typedef std::map<uint64_t, ceph::ref_t<ObjectPlayer>> FetchAheadObjectPlayers;
+  typedef std::map<uint64_t, int> FetchAheadResults;
   typedef std::set<uint64_t> ObjectNumbers;
 
   enum State {
@@ -75,6 +77,20 @@ private:
     }
   };
 
+  struct C_FetchAhead : public Context {
+    JournalPlayer *player;
+    uint64_t object_num;
+    C_FetchAhead(JournalPlayer *p, uint64_t o) : player(p), object_num(o) {
+      player->m_async_op_tracker.start_op();
+    }
+    ~C_FetchAhead() override {
+      player->m_async_op_tracker.finish_op();
+    }
+    void finish(int r) override {
+      player->handle_fetched_ahead(object_num, r);
+    }
+  };
+
   struct C_Watch : public Context {
     JournalPlayer *player;
     uint64_t object_num;
@@ -133,6 +149,10 @@ private:
   PrefetchSplayOffsets m_prefetch_splay_offsets;
   SplayedObjectPlayers m_object_players;
 
+  // objects from closed object sets read before playback reaches them
+  FetchAheadObjectPlayers m_fetch_ahead_players;
+  FetchAheadResults m_fetch_ahead_results;
+
   bool m_commit_position_valid = false;
   ObjectPosition m_commit_position;
   SplayedObjectPositions m_commit_positions;
@@ -159,6 +179,8 @@ private:
   void fetch(uint64_t object_num);
   void fetch(const ceph::ref_t<ObjectPlayer> &object_player);
   void handle_fetched(uint64_t object_num, int r);
+  void fetch_ahead(uint64_t object_num);
+  void handle_fetched_ahead(uint64_t object_num, int r);
   void refetch(bool immediate);
 
   void schedule_watch(bool immediate);
@@ -319,6 +319,8 @@ ceph::ref_t<ObjectRecorder> JournalRecorder::create_object_recorder(
     m_max_in_flight_appends);
   object_recorder->set_append_batch_options(m_flush_interval, m_flush_bytes,
                                             m_flush_age);
+  object_recorder->set_group_commit(
+    m_journal_metadata->get_settings().group_commit);
   return object_recorder;
 }
 
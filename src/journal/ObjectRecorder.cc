@@ -65,6 +65,13 @@ void ObjectRecorder::set_append_batch_options(int flush_interval,
   m_flush_age = flush_age;
 }
 
+void ObjectRecorder::set_group_commit(bool group_commit) {
+  ldout(m_cct, 5) << "group_commit=" << group_commit << dendl;
+
+  ceph_assert(ceph_mutex_is_locked(*m_lock));
+  m_group_commit = group_commit;
+}
+
 bool ObjectRecorder::append(AppendBuffers &&append_buffers) {
   ldout(m_cct, 20) << "count=" << append_buffers.size() << dendl;
 
@@ -227,9 +234,12 @@ void ObjectRecorder::handle_append_flushed(uint64_t tid, int r) {
     append_buffer.first->safe(r);
   }
 
-  // attempt to kick off more appends to the object
+  // attempt to kick off more appends to the object -- any flush that was
+  // deferred behind the in-flight appends is sent as a single group commit
   locker.lock();
-  if (!m_object_closed && !m_overflowed && send_appends(false, {})) {
+  bool force = false;
+  std::swap(force, m_flush_deferred);
+  if (!m_object_closed && !m_overflowed && send_appends(force, {})) {
     notify_overflowed = true;
   }
 
@@ -308,6 +318,17 @@ bool ObjectRecorder::send_appends(bool force, ceph::ref_t<FutureImpl> flush_futu
     return false;
   }
 
+  // hold back appends and flushes that arrive while appends are in-flight
+  // so that they are all committed by the next append op (a close is never
+  // held back since no further appends will be sent once closed)
+  if (m_group_commit && (!force || flush_future) &&
+      static_cast<int32_t>(m_in_flight_tids.size()) >=
+        std::max<int32_t>(max_in_flight_appends, 1)) {
+    ldout(m_cct, 20) << "deferring appends for group commit" << dendl;
+    m_flush_deferred = true;
+    return false;
+  }
+
   librados::ObjectWriteOperation op;
   if (m_compat_mode) {
     client::guard_append(&op, m_soft_max_size);
@@ -36,6 +36,7 @@ public:
 
   void set_append_batch_options(int flush_interval, uint64_t flush_bytes,
                                 double flush_age);
+  void set_group_commit(bool group_commit);
 
   inline uint64_t get_object_number() const {
     return m_object_number;
@@ -110,6 +111,7 @@ private:
   uint64_t m_flush_bytes = 0;
   double m_flush_age = 0;
   int32_t m_max_in_flight_appends;
+  bool m_group_commit = false;
 
   bool m_compat_mode;
 
@@ -136,6 +138,7 @@ private:
   uint64_t m_object_bytes = 0;
 
   bool m_overflowed = false;
+  bool m_flush_deferred = false;
 
   bool m_object_closed = false;
   bool m_object_closed_notify = false;
@@ -12,6 +12,8 @@ struct Settings {
   double commit_interval = 5;         ///< commit position throttle (in secs)
   uint64_t max_payload_bytes = 0;     ///< 0 implies object size limit
   int max_concurrent_object_sets = 0; ///< 0 implies no limit
+  bool group_commit = false;          ///< coalesce flushes behind in-flight appends
+  uint32_t fetch_ahead_objects = 0;   ///< closed objects to pre-read during replay
   std::set<std::string> ignored_laggy_clients;
                                       ///< clients that mustn't be disconnected
 };
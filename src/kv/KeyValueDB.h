@@ -325,6 +325,8 @@ private:
 public:
   typedef uint32_t IteratorOpts;
   static const uint32_t ITERATOR_NOCACHE = 1;
+  /// expect a long forward scan; the backend may read ahead
+  static const uint32_t ITERATOR_SCAN = 2;
 
   struct IteratorBounds {
     std::optional<std::string> lower_bound;
@@ -367,6 +369,16 @@ public:
     return nullptr;
   }
 
+  /// lookup hit/miss counts of the default cache, or of the one dedicated to prefix
+  virtual int get_cache_hit_stats(uint64_t *hits, uint64_t *misses) const {
+    return -EOPNOTSUPP;
+  }
+
+  virtual int get_cache_hit_stats(std::string prefix,
+                                  uint64_t *hits, uint64_t *misses) const {
+    return -EOPNOTSUPP;
+  }
+
 
 
   virtual ~KeyValueDB() {}
@@ -6,6 +6,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <thread>
 #include <errno.h>
 #include <unistd.h>
 #include <sys/types.h>
@@ -475,6 +476,34 @@ std::shared_ptr<rocksdb::Cache> RocksDBStore::create_block_cache(
   return cache;
 }
 
+static int get_block_cache_hit_stats(const std::shared_ptr<rocksdb::Cache>& cache,
+                                     uint64_t *hits, uint64_t *misses)
+{
+  auto binned = std::dynamic_pointer_cast<rocksdb_cache::BinnedLRUCache>(cache);
+  if (!binned) {
+    return -EOPNOTSUPP;
+  }
+  binned->get_hit_stats(hits, misses);
+  return 0;
+}
+
+int RocksDBStore::get_cache_hit_stats(uint64_t *hits, uint64_t *misses) const
+{
+  return get_block_cache_hit_stats(bbt_opts.block_cache, hits, misses);
+}
+
+int RocksDBStore::get_cache_hit_stats(std::string prefix,
+                                      uint64_t *hits, uint64_t *misses) const
+{
+  auto it = cf_bbt_opts.find(prefix);
+  if (it == cf_bbt_opts.end() ||
+      !it->second.block_cache ||
+      it->second.block_cache == bbt_opts.block_cache) {
+    return -ENOENT;
+  }
+  return get_block_cache_hit_stats(it->second.block_cache, hits, misses);
+}
+
 int RocksDBStore::load_rocksdb_options(bool create_if_missing, rocksdb::Options& opt)
 {
   rocksdb::Status status;
@@ -1973,6 +2002,8 @@ void RocksDBStore::compact()
 {
   logger->inc(l_rocksdb_compact);
   rocksdb::CompactRangeOptions options;
+  options.max_subcompactions =
+    cct->_conf.get_val<uint64_t>("rocksdb_compact_subcompactions");
   db->CompactRange(options, default_cf, nullptr, nullptr);
   for (auto cf : cf_handles) {
     for (auto shard_cf : cf.second.handles) {
@@ -2065,6 +2096,8 @@ bool RocksDBStore::check_omap_dir(string &omap_dir)
 void RocksDBStore::compact_range(const string& start, const string& end)
 {
   rocksdb::CompactRangeOptions options;
+  options.max_subcompactions =
+    cct->_conf.get_val<uint64_t>("rocksdb_compact_subcompactions");
   rocksdb::Slice cstart(start);
   rocksdb::Slice cend(end);
   string prefix_start, key_start;
@@ -2246,12 +2279,13 @@ public:
   explicit CFIteratorImpl(const RocksDBStore* db,
                           const std::string& p,
                           rocksdb::ColumnFamilyHandle* cf,
+                          KeyValueDB::IteratorOpts opts,
                           KeyValueDB::IteratorBounds bounds_)
     : prefix(p), bounds(std::move(bounds_)),
       iterate_lower_bound(make_slice(bounds.lower_bound)),
       iterate_upper_bound(make_slice(bounds.upper_bound))
       {
-      auto options = rocksdb::ReadOptions();
+      auto options = db->get_iterator_options(opts);
       if (db->cct->_conf->osd_rocksdb_iterator_bounds_enabled) {
         if (bounds.lower_bound) {
           options.iterate_lower_bound = &iterate_lower_bound;
@@ -2801,13 +2835,14 @@ public:
   explicit ShardMergeIteratorImpl(const RocksDBStore* db,
 				  const std::string& prefix,
 				  const std::vector<rocksdb::ColumnFamilyHandle*>& shards,
+                  KeyValueDB::IteratorOpts opts,
                   KeyValueDB::IteratorBounds bounds_)
     : db(db), keyless(db->comparator), prefix(prefix), bounds(std::move(bounds_)),
       iterate_lower_bound(make_slice(bounds.lower_bound)),
       iterate_upper_bound(make_slice(bounds.upper_bound))
   {
     iters.reserve(shards.size());
-    auto options = rocksdb::ReadOptions();
+    auto options = db->get_iterator_options(opts);
     if (db->cct->_conf->osd_rocksdb_iterator_bounds_enabled) {
       if (bounds.lower_bound) {
         options.iterate_lower_bound = &iterate_lower_bound;
@@ -3003,12 +3038,14 @@ KeyValueDB::Iterator RocksDBStore::get_iterator(const std::string& prefix, Itera
               this,
               prefix,
               cf,
+              opts,
               std::move(bounds));
     } else {
       return std::make_shared<ShardMergeIteratorImpl>(
         this,
         prefix,
         cf_it->second.handles,
+        opts,
         std::move(bounds));
     }
   } else {
@@ -3036,6 +3073,22 @@ RocksDBStore::WholeSpaceIterator RocksDBStore::get_default_cf_iterator()
   return std::make_shared<RocksDBWholeSpaceIteratorImpl>(this, default_cf, 0);
 }
 
+rocksdb::ReadOptions RocksDBStore::get_iterator_options(IteratorOpts opts) const
+{
+  rocksdb::ReadOptions options;
+  if (opts & ITERATOR_NOCACHE) {
+    options.fill_cache = false;
+  }
+  if (opts & ITERATOR_SCAN) {
+    // read whole runs of blocks up front instead of waiting for
+    // rocksdb's implicit readahead to ramp up from a single block
+    options.readahead_size =
+      cct->_conf.get_val<Option::size_t>("rocksdb_scan_readahead_size");
+    options.adaptive_readahead = true;
+  }
+  return options;
+}
+
 int RocksDBStore::prepare_for_reshard(const std::string& new_sharding,
 				      RocksDBStore::columns_t& to_process_columns)
 {
@@ -3291,10 +3344,22 @@ int RocksDBStore::reshard(const std::string& new_sharding, const RocksDBStore::r
   size_t keys_per_iterator = 0;
   size_t keys_processed = 0;
   size_t keys_moved = 0;
+  auto throttle_start = ceph::mono_clock::now();
+  uint64_t throttle_bytes = 0;
 
   auto flush_batch = [&](rocksdb::WriteBatch* batch) {
     dout(10) << "flushing batch, " << keys_in_batch << " keys, for "
              << bytes_in_batch << " bytes" << dendl;
+    if (ctrl.bytes_per_sec > 0) {
+      // hold the moved bytes to bytes_per_sec on average, so that the
+      // device keeps some bandwidth for whatever else shares it
+      throttle_bytes += bytes_in_batch;
+      auto due = throttle_start + ceph::make_timespan(
+	(double)throttle_bytes / ctrl.bytes_per_sec);
+      if (auto now = ceph::mono_clock::now(); due > now) {
+	std::this_thread::sleep_for(due - now);
+      }
+    }
     rocksdb::WriteOptions woptions;
     woptions.sync = true;
     rocksdb::Status s = db->Write(woptions, batch);
@@ -358,10 +358,7 @@ public:
                                            rocksdb::ColumnFamilyHandle* cf,
                                            const KeyValueDB::IteratorOpts opts)
       {
-        rocksdb::ReadOptions options = rocksdb::ReadOptions();
-        if (opts & ITERATOR_NOCACHE)
-          options.fill_cache=false;
-        dbiter = db->db->NewIterator(options, cf);
+        dbiter = db->db->NewIterator(db->get_iterator_options(opts), cf);
     }
     ~RocksDBWholeSpaceIteratorImpl() override;
 
@@ -510,16 +507,24 @@ err:
   virtual std::shared_ptr<PriorityCache::PriCache>
       get_priority_cache(std::string prefix) const override {
     auto it = cf_bbt_opts.find(prefix);
-    if (it != cf_bbt_opts.end()) {
+    // a column family that only tweaks table options keeps sharing the
+    // default block cache; don't hand it out twice for balancing
+    if (it != cf_bbt_opts.end() &&
+        it->second.block_cache != bbt_opts.block_cache) {
       return std::dynamic_pointer_cast<PriorityCache::PriCache>(
           it->second.block_cache);
     }
     return nullptr;
   }
 
+  int get_cache_hit_stats(uint64_t *hits, uint64_t *misses) const override;
+  int get_cache_hit_stats(std::string prefix,
+                          uint64_t *hits, uint64_t *misses) const override;
+
   WholeSpaceIterator get_wholespace_iterator(IteratorOpts opts = 0) override;
 private:
   WholeSpaceIterator get_default_cf_iterator();
+  rocksdb::ReadOptions get_iterator_options(IteratorOpts opts) const;
 
   using cf_deleter_t = std::function<void(rocksdb::ColumnFamilyHandle*)>;
   using columns_t = std::map<std::string,
@@ -534,6 +539,7 @@ public:
     size_t keys_per_iterator =  10000;
     size_t bytes_per_batch =    1000000;  /// amount of data before submitting batch
     size_t keys_per_batch =     1000;
+    size_t bytes_per_sec =      0;        /// limit on data moved per second, 0 = unlimited
     bool   unittest_fail_after_first_batch = false;
     bool   unittest_fail_after_processing_column = false;
     bool   unittest_fail_after_successful_processing = false;
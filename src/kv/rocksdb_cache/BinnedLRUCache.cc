@@ -314,6 +314,9 @@ rocksdb::Cache::Handle* BinnedLRUCacheShard::Lookup(const rocksdb::Slice& key, u
     }
     e->refs++;
     e->SetHit();
+    ++hits_;
+  } else {
+    ++misses_;
   }
   return reinterpret_cast<rocksdb::Cache::Handle*>(e);
 }
@@ -477,6 +480,12 @@ size_t BinnedLRUCacheShard::GetUsage() const {
   return usage_;
 }
 
+void BinnedLRUCacheShard::add_hit_stats(uint64_t *hits, uint64_t *misses) const {
+  std::lock_guard<std::mutex> l(mutex_);
+  *hits += hits_;
+  *misses += misses_;
+}
+
 size_t BinnedLRUCacheShard::GetPinnedUsage() const {
   std::lock_guard<std::mutex> l(mutex_);
   ceph_assert(usage_ >= lru_usage_);
@@ -608,6 +617,14 @@ size_t BinnedLRUCache::GetHighPriPoolUsage() const {
   return usage;
 }
 
+void BinnedLRUCache::get_hit_stats(uint64_t *hits, uint64_t *misses) const {
+  *hits = 0;
+  *misses = 0;
+  for (int s = 0; s < num_shards_; s++) {
+    shards_[s].add_hit_stats(hits, misses);
+  }
+}
+
 // PriCache
 
 int64_t BinnedLRUCache::request_cache_bytes(PriorityCache::Priority pri, uint64_t total_cache) const
@@ -244,6 +244,9 @@ class alignas(CACHE_LINE_SIZE) BinnedLRUCacheShard : public CacheShard {
   // Get the byte counts for a range of age bins
   uint64_t sum_bins(uint32_t start, uint32_t end) const;
 
+  // Add lookup hit/miss counts of this shard to the given totals
+  void add_hit_stats(uint64_t *hits, uint64_t *misses) const;
+
  private:
   CephContext *cct;
   void LRU_Remove(BinnedLRUHandle* e);
@@ -306,6 +309,10 @@ class alignas(CACHE_LINE_SIZE) BinnedLRUCacheShard : public CacheShard {
   // Memory size for entries residing only in the LRU list
   size_t lru_usage_;
 
+  // Lookup hit/miss counts
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+
   // mutex_ protects the following state.
   // We don't count mutex_ as the cache's internal state so semantically we
   // don't mind mutex_ invoking the non-const actions.
@@ -338,6 +345,8 @@ class BinnedLRUCache : public ShardedCache {
   double GetHighPriPoolRatio() const;
   // Retrieves high pri pool usage
   size_t GetHighPriPoolUsage() const;
+  // Retrieves lookup hit/miss counts summed over all shards
+  void get_hit_stats(uint64_t *hits, uint64_t *misses) const;
 
   // PriorityCache
   virtual int64_t request_cache_bytes(
@@ -13,6 +13,8 @@
  */
 
 #include <fcntl.h>
+#include <deque>
+#include <thread>
 #include <iostream>
 #include <string.h>
 #include <string>
@@ -22,6 +24,7 @@
 #include "librados/RadosClient.h"
 #include "common/async/context_pool.h"
 #include "common/ceph_argparse.h"
+#include "common/Thread.h"
 #include "common/common_init.h"
 #include "common/config.h"
 #include "common/version.h"
@@ -1761,6 +1764,22 @@ extern "C" int ceph_ll_lookup(struct ceph_mount_info *cmount,
 					    flags, *perms);
 }
 
+extern "C" int ceph_ll_lookup_batch(struct ceph_mount_info *cmount,
+				    Inode *parent, int count,
+				    const char * const names[], Inode *out[],
+				    struct ceph_statx stx[], int results[],
+				    unsigned want, unsigned flags,
+				    const UserPerm *perms)
+{
+  if (flags & ~CEPH_REQ_FLAG_MASK)
+    return -CEPHFS_EINVAL;
+  if (count < 0)
+    return -CEPHFS_EINVAL;
+  return (cmount->get_client())->ll_lookupx_batch(parent, count, names, out,
+						  stx, results, want, flags,
+						  *perms);
+}
+
 extern "C" int ceph_ll_put(class ceph_mount_info *cmount, Inode *in)
 {
   return (cmount->get_client()->ll_put(in));
@@ -2232,3 +2251,123 @@ extern "C" void ceph_free_snap_info_buffer(struct snap_info *snap_info) {
   }
   free(snap_info->snap_metadata);
 }
+
+struct ceph_ll_cq {
+  ceph_mount_info *cmount;
+  ceph::mutex lock = ceph::make_mutex("ceph_ll_cq::lock");
+  ceph::condition_variable submit_cond;
+  ceph::condition_variable complete_cond;
+  std::deque<ceph_ll_io*> submitted;
+  std::deque<ceph_ll_io*> completed;
+  std::vector<std::thread> workers;
+  bool stopping = false;
+
+  explicit ceph_ll_cq(ceph_mount_info *c) : cmount(c) {}
+
+  void run_io(ceph_ll_io *io) {
+    Client *client = cmount->get_client();
+    switch (io->op) {
+    case CEPH_LL_IO_OPEN:
+      io->result = client->ll_open(io->in, io->flags, &io->fh, *io->perms);
+      break;
+    case CEPH_LL_IO_READ:
+      io->result = client->ll_readv(io->fh, io->iov, io->iovcnt, io->offset);
+      break;
+    case CEPH_LL_IO_WRITE:
+      io->result = client->ll_writev(io->fh, io->iov, io->iovcnt, io->offset);
+      break;
+    case CEPH_LL_IO_FSYNC:
+      io->result = client->ll_fsync(io->fh, io->flags != 0);
+      break;
+    case CEPH_LL_IO_GETATTR:
+      if (io->flags & ~CEPH_REQ_FLAG_MASK)
+	io->result = -CEPHFS_EINVAL;
+      else
+	io->result = client->ll_getattrx(io->in, io->stx, io->want, io->flags,
+					 *io->perms);
+      break;
+    default:
+      io->result = -CEPHFS_EINVAL;
+    }
+  }
+
+  void worker() {
+    std::unique_lock l{lock};
+    while (true) {
+      submit_cond.wait(l, [this] { return stopping || !submitted.empty(); });
+      if (submitted.empty())
+	break;  // stopping, and nothing left to run
+      ceph_ll_io *io = submitted.front();
+      submitted.pop_front();
+      l.unlock();
+      run_io(io);
+      l.lock();
+      completed.push_back(io);
+      complete_cond.notify_all();
+    }
+  }
+};
+
+extern "C" int ceph_ll_cq_create(struct ceph_mount_info *cmount,
+				 unsigned int nthreads, struct ceph_ll_cq **cq)
+{
+  if (!cmount->is_mounted())
+    return -CEPHFS_ENOTCONN;
+  if (nthreads == 0)
+    return -CEPHFS_EINVAL;
+
+  auto q = new ceph_ll_cq(cmount);
+  for (unsigned i = 0; i < nthreads; ++i)
+    q->workers.push_back(make_named_thread("ll_cq", &ceph_ll_cq::worker, q));
+  *cq = q;
+  return 0;
+}
+
+extern "C" void ceph_ll_cq_destroy(struct ceph_ll_cq *cq)
+{
+  {
+    std::lock_guard l{cq->lock};
+    cq->stopping = true;
+  }
+  cq->submit_cond.notify_all();
+  for (auto& t : cq->workers)
+    t.join();
+  delete cq;
+}
+
+extern "C" int ceph_ll_submit(struct ceph_ll_cq *cq, struct ceph_ll_io **ios,
+			      int nr)
+{
+  if (nr < 0)
+    return -CEPHFS_EINVAL;
+
+  std::lock_guard l{cq->lock};
+  for (int i = 0; i < nr; ++i)
+    cq->submitted.push_back(ios[i]);
+  if (nr == 1)
+    cq->submit_cond.notify_one();
+  else
+    cq->submit_cond.notify_all();
+  return nr;
+}
+
+extern "C" int ceph_ll_cq_wait(struct ceph_ll_cq *cq, struct ceph_ll_io **ios,
+			       int min_nr, int max_nr, int64_t timeout_ms)
+{
+  if (max_nr <= 0 || min_nr > max_nr)
+    return -CEPHFS_EINVAL;
+
+  std::unique_lock l{cq->lock};
+  auto enough = [cq, min_nr] { return cq->completed.size() >= (size_t)min_nr; };
+  if (timeout_ms < 0)
+    cq->complete_cond.wait(l, enough);
+  else
+    cq->complete_cond.wait_for(l, std::chrono::milliseconds(timeout_ms), enough);
+
+  int n = 0;
+  while (n < max_nr && !cq->completed.empty()) {
+    ios[n++] = cq->completed.front();
+    cq->completed.pop_front();
+  }
+  return n;
+}
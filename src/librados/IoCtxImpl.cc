@@ -785,6 +785,74 @@ int librados::IoCtxImpl::aio_operate(const object_t& oid,
   return 0;
 }
 
+namespace {
+// completes one op of a batch; the last one to finish completes the
+// batch as a whole
+struct C_aio_batch_item : public Context {
+  struct batch_t {
+    std::atomic<size_t> pending;
+    std::vector<int> *results;
+    Context *oncomplete;
+  };
+  batch_t *batch;
+  size_t i;
+  C_aio_batch_item(batch_t *b, size_t i) : batch(b), i(i) {}
+  void finish(int r) override {
+    if (batch->results) {
+      (*batch->results)[i] = r;
+    }
+    if (--batch->pending == 0) {
+      batch->oncomplete->complete(0);
+      delete batch;
+    }
+  }
+};
+}
+
+int librados::IoCtxImpl::aio_operate_batch(
+  const std::vector<std::pair<object_t, ::ObjectOperation*>>& ops,
+  AioCompletionImpl *c, bool is_read, int flags,
+  std::vector<int> *results)
+{
+  FUNCTRACE(client->cct);
+  if (!is_read && snap_seq != CEPH_NOSNAP)
+    return -EROFS;
+
+  Context *oncomplete = new C_aio_Complete(c);
+  c->is_read = is_read;
+  c->io = this;
+  if (!is_read)
+    queue_aio_write(c);
+  if (results)
+    results->assign(ops.size(), 0);
+  if (ops.empty()) {
+    oncomplete->complete(0);
+    return 0;
+  }
+
+  // submit back to back so that ops bound for the same OSD can share a
+  // message when objecter_op_batch_max allows it
+  auto batch = new C_aio_batch_item::batch_t{{ops.size()}, results,
+					      oncomplete};
+  auto ut = ceph::real_clock::now();
+  for (size_t i = 0; i < ops.size(); ++i) {
+    auto& [oid, o] = ops[i];
+    Context *onitem = new C_aio_batch_item(batch, i);
+    Objecter::Op *op;
+    if (is_read) {
+      op = objecter->prepare_read_op(
+	oid, oloc, *o, snap_seq, nullptr, flags | extra_op_flags,
+	onitem, nullptr);
+    } else {
+      op = objecter->prepare_mutate_op(
+	oid, oloc, *o, snapc, ut, flags | extra_op_flags,
+	onitem, nullptr);
+    }
+    objecter->op_submit(op);
+  }
+  return 0;
+}
+
 int librados::IoCtxImpl::aio_read(const object_t oid, AioCompletionImpl *c,
 				  bufferlist *pbl, size_t len, uint64_t off,
 				  uint64_t snapid, const blkin_trace_info *info)
@@ -1676,6 +1676,38 @@ int librados::IoCtx::aio_operate(const std::string& oid, AioCompletion *c,
                translate_flags(flags), pbl, trace_info);
 }
 
+int librados::IoCtx::aio_operate_batch(
+  AioCompletion *c,
+  const std::vector<std::pair<std::string, ObjectReadOperation*>>& ops,
+  int flags, std::vector<int> *results)
+{
+  std::vector<std::pair<object_t, ::ObjectOperation*>> v;
+  v.reserve(ops.size());
+  for (auto& [oid, o] : ops) {
+    if (unlikely(!o->impl))
+      return -EINVAL;
+    v.emplace_back(oid, &o->impl->o);
+  }
+  return io_ctx_impl->aio_operate_batch(v, c->pc, true,
+					translate_flags(flags), results);
+}
+
+int librados::IoCtx::aio_operate_batch(
+  AioCompletion *c,
+  const std::vector<std::pair<std::string, ObjectWriteOperation*>>& ops,
+  int flags, std::vector<int> *results)
+{
+  std::vector<std::pair<object_t, ::ObjectOperation*>> v;
+  v.reserve(ops.size());
+  for (auto& [oid, o] : ops) {
+    if (unlikely(!o->impl))
+      return -EINVAL;
+    v.emplace_back(oid, &o->impl->o);
+  }
+  return io_ctx_impl->aio_operate_batch(v, c->pc, false,
+					translate_flags(flags), results);
+}
+
 void librados::IoCtx::snap_set_read(snap_t seq)
 {
   io_ctx_impl->set_snap_read(seq);
@@ -638,11 +638,18 @@ static void rados_read_aio_unlock_complete(rados_striper_multi_completion_t c, v
 static void striper_read_aio_req_complete(rados_striper_multi_completion_t c, void *arg)
 {
   auto cdata = static_cast<ReadCompletionData*>(arg);
+  libradosstriper::MultiAioCompletionImpl *comp =
+    reinterpret_cast<libradosstriper::MultiAioCompletionImpl*>(c);
+  if (cdata->m_lockCookie.empty()) {
+    // lockless read, nothing to unlock. We own the reference taken in aio_read
+    auto ref = ceph::ref_t<ReadCompletionData>(cdata, false);
+    cdata->complete_read(comp->rval);
+    cdata->complete_unlock(0);
+    return;
+  }
   // launch the async unlocking of the object
   cdata->m_striper->aio_unlockObject(cdata->m_soid, cdata->m_lockCookie, cdata->m_unlockCompletion);
   // complete the read part in parallel
-  libradosstriper::MultiAioCompletionImpl *comp =
-    reinterpret_cast<libradosstriper::MultiAioCompletionImpl*>(c);
   cdata->complete_read(comp->rval);
 }
 
@@ -716,14 +723,19 @@ int libradosstriper::RadosStriperImpl::aio_read(const std::string& soid,
   auto cdata = ceph::make_ref<ReadCompletionData>(this, soid, lockCookie, c, bl, extents, resultbl);
   c->is_read = true;
   c->io = m_ioCtxImpl;
-  // create a completion for the unlocking of the striped object at the end of the read
-  librados::AioCompletion *unlock_completion =
-    librados::Rados::aio_create_completion(cdata->get() /* create ref! */, rados_read_aio_unlock_complete);
-  cdata->m_unlockCompletion = unlock_completion;
   // create the multiCompletion object handling the reads
   MultiAioCompletionImplPtr nc{new libradosstriper::MultiAioCompletionImpl,
 			       false};
-  nc->set_complete_callback(cdata.get(), striper_read_aio_req_complete);
+  if (lockCookie.empty()) {
+    // lockless read, the read completion holds the only extra reference
+    nc->set_complete_callback(cdata->get() /* create ref! */, striper_read_aio_req_complete);
+  } else {
+    // create a completion for the unlocking of the striped object at the end of the read
+    librados::AioCompletion *unlock_completion =
+      librados::Rados::aio_create_completion(cdata->get() /* create ref! */, rados_read_aio_unlock_complete);
+    cdata->m_unlockCompletion = unlock_completion;
+    nc->set_complete_callback(cdata.get(), striper_read_aio_req_complete);
+  }
   // go through the extents
   int r = 0, i = 0;
   for (vector<ObjectExtent>::iterator p = extents->begin(); p != extents->end(); ++p) {
@@ -1340,6 +1352,12 @@ int libradosstriper::RadosStriperImpl::openStripedObjectForRead(
   uint64_t *size,
   std::string *lockCookie)
 {
+  std::string firstObjOid = getObjectId(soid, 0);
+  if (cct()->_conf.get_val<bool>("rados_striper_lockless_reads")) {
+    // no lock, an empty cookie tells the completion there is nothing to unlock
+    lockCookie->clear();
+    return internal_get_layout_and_size(firstObjOid, layout, size);
+  }
   // take a lock the first rados object, if it exists and gets its size
   // check, lock and size reading must be atomic and are thus done within a single operation
   librados::ObjectWriteOperation op;
@@ -1347,7 +1365,6 @@ int libradosstriper::RadosStriperImpl::openStripedObjectForRead(
   *lockCookie = getUUID();
   utime_t dur = utime_t();
   rados::cls::lock::lock(&op, RADOS_LOCK_NAME, ClsLockType::SHARED, *lockCookie, "Tag", "", dur, 0);
-  std::string firstObjOid = getObjectId(soid, 0);
   int rc = m_ioCtx.operate(firstObjOid, &op);
   if (rc) {
     // error case (including -ENOENT)
@@ -1402,6 +1419,12 @@ int libradosstriper::RadosStriperImpl::openStripedObjectForWrite(const std::stri
   // atomically update object size, only if smaller than current one
   if (!isFileSizeAbsolute)
     *size += curSize;
+  if (*size <= curSize) {
+    // overwrite within the current size. Our shared lock keeps truncate away,
+    // so the size can only grow under us and there is nothing to update
+    *size = curSize;
+    return 0;
+  }
   librados::ObjectWriteOperation writeOp;
   writeOp.cmpxattr(XATTR_SIZE, LIBRADOS_CMPXATTR_OP_GT, *size);
   std::ostringstream oss;
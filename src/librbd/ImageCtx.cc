@@ -922,6 +922,16 @@ librados::IoCtx duplicate_io_ctx(librados::IoCtx& io_ctx) {
       config.get_val<uint64_t>("rbd_qos_write_bps_limit"),
       config.get_val<uint64_t>("rbd_qos_write_bps_burst"),
       config.get_val<uint64_t>("rbd_qos_write_bps_burst_seconds"));
+    io_image_dispatcher->apply_qos_limit(
+      io::IMAGE_DISPATCH_FLAG_QOS_NAMESPACE_IOPS_THROTTLE,
+      config.get_val<uint64_t>("rbd_qos_namespace_iops_limit"),
+      config.get_val<uint64_t>("rbd_qos_namespace_iops_burst"),
+      config.get_val<uint64_t>("rbd_qos_namespace_iops_burst_seconds"));
+    io_image_dispatcher->apply_qos_limit(
+      io::IMAGE_DISPATCH_FLAG_QOS_NAMESPACE_BPS_THROTTLE,
+      config.get_val<uint64_t>("rbd_qos_namespace_bps_limit"),
+      config.get_val<uint64_t>("rbd_qos_namespace_bps_burst"),
+      config.get_val<uint64_t>("rbd_qos_namespace_bps_burst_seconds"));
     io_image_dispatcher->apply_qos_exclude_ops(
       librbd::io::rbd_io_operations_from_string(
         config.get_val<std::string>("rbd_qos_exclude_ops"), nullptr));
@@ -1161,6 +1161,8 @@ void Journal<I>::create_journaler() {
     m_image_ctx.config.template get_val<Option::size_t>("rbd_journal_max_payload_bytes");
   settings.max_concurrent_object_sets =
     m_image_ctx.config.template get_val<uint64_t>("rbd_journal_max_concurrent_object_sets");
+  settings.group_commit =
+    m_image_ctx.config.template get_val<bool>("rbd_journal_object_group_commit");
   // TODO: a configurable filter to exclude certain peers from being
   // disconnected.
   settings.ignored_laggy_clients = {IMAGE_CLIENT_ID};
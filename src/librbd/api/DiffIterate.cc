@@ -17,6 +17,7 @@
 #include "common/Throttle.h"
 #include "osdc/Striper.h"
 #include <boost/tuple/tuple.hpp>
+#include <algorithm>
 #include <list>
 #include <map>
 #include <vector>
@@ -244,9 +245,10 @@ int DiffIterate<I>::execute() {
 
   int r;
   bool fast_diff_enabled = false;
+  bool object_diff_valid = false;
   BitVector<2> object_diff_state;
   interval_set<uint64_t> parent_diff;
-  if (m_whole_object) {
+  {
     C_SaferCond ctx;
     auto req = object_map::DiffRequest<I>::create(&m_image_ctx, from_snap_id,
                                                   end_snap_id,
@@ -256,6 +258,11 @@ int DiffIterate<I>::execute() {
     r = ctx.wait();
     if (r < 0) {
       ldout(cct, 5) << "fast diff disabled" << dendl;
+    } else if (!m_whole_object) {
+      // list_snaps is still needed for exact extents, but only for the
+      // objects that the object map says have changed
+      ldout(cct, 5) << "fast diff enabled for object selection" << dendl;
+      object_diff_valid = true;
     } else {
       ldout(cct, 5) << "fast diff enabled" << dendl;
       fast_diff_enabled = true;
@@ -287,6 +294,10 @@ int DiffIterate<I>::execute() {
                            m_whole_object, m_include_parent, from_snap_id,
                            end_snap_id);
 
+  // objects without a parent to fall back to have nothing to report
+  // for an unchanged hole
+  const bool skip_holes = (!m_include_parent || from_snap_id != 0);
+
   uint64_t period = m_image_ctx.get_stripe_period();
   uint64_t off = m_offset;
   uint64_t left = m_length;
@@ -351,13 +362,34 @@ int DiffIterate<I>::execute() {
         }
       }
     } else {
-      auto diff_object = new C_DiffObject<I>(m_image_ctx, diff_context, off,
-                                             read_len);
-      diff_object->send();
+      bool unchanged = false;
+      if (object_diff_valid) {
+        std::map<object_t,std::vector<ObjectExtent> > object_extents;
+        Striper::file_to_extents(cct, m_image_ctx.format_string,
+                                 &m_image_ctx.layout, off, read_len, 0,
+                                 object_extents, 0);
+        unchanged = std::all_of(
+          object_extents.begin(), object_extents.end(),
+          [&](const auto& object_extent) {
+            const uint64_t object_no = object_extent.second.front().objectno;
+            uint8_t diff_state = object_diff_state[object_no];
+            return (diff_state == object_map::DIFF_STATE_DATA ||
+                    (diff_state == object_map::DIFF_STATE_HOLE && skip_holes));
+          });
+      }
 
-      if (diff_context.throttle.pending_error()) {
-        r = diff_context.throttle.wait_for_ret();
-        return r;
+      if (unchanged) {
+        ldout(cct, 20) << "image extent " << off << "~" << read_len
+                       << ": unchanged, skipping list_snaps" << dendl;
+      } else {
+        auto diff_object = new C_DiffObject<I>(m_image_ctx, diff_context, off,
+                                               read_len);
+        diff_object->send();
+
+        if (diff_context.throttle.pending_error()) {
+          r = diff_context.throttle.wait_for_ret();
+          return r;
+        }
       }
     }
 
@@ -205,6 +205,9 @@ private:
 
   int m_flush_ops_in_flight = 0;
   int m_flush_bytes_in_flight = 0;
+  /* Writeback limits, from rbd_persistent_cache_writeback_max_* */
+  uint64_t m_flush_ops_limit;
+  uint64_t m_flush_bytes_limit;
   uint64_t m_lowest_flushing_sync_gen = 0;
 
   /* Writes that have left the block guard, but are waiting for resources */
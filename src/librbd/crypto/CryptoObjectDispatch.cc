@@ -5,6 +5,7 @@
 #include "include/ceph_assert.h"
 #include "include/neorados/RADOS.hpp"
 #include "common/dout.h"
+#include "common/WorkQueue.h"
 #include "osdc/Striper.h"
 #include "librbd/ImageCtx.h"
 #include "librbd/Utils.h"
@@ -26,6 +27,31 @@ namespace crypto {
 using librbd::util::create_context_callback;
 using librbd::util::data_object_name;
 
+namespace {
+
+class ThreadPoolSingleton : public ThreadPool {
+public:
+  ContextWQ *work_queue;
+
+  explicit ThreadPoolSingleton(CephContext *cct)
+    : ThreadPool(cct, "librbd::crypto", "tp_librbd_crypt",
+                 cct->_conf.get_val<uint64_t>("rbd_crypto_threads")),
+      work_queue(new ContextWQ("librbd::crypto::work_queue",
+                               ceph::make_timespan(
+                                 cct->_conf.get_val<uint64_t>("rbd_op_thread_timeout")),
+                               this)) {
+    start();
+  }
+  ~ThreadPoolSingleton() override {
+    work_queue->drain();
+    delete work_queue;
+
+    stop();
+  }
+};
+
+} // anonymous namespace
+
 template <typename I>
 uint64_t get_file_offset(I* image_ctx, uint64_t object_no,
                          uint64_t object_off) {
@@ -46,6 +72,7 @@ struct C_AlignedObjectReadRequest : public Context {
     const ZTracer::Trace parent_trace;
     uint64_t* version;
     Context* on_finish;
+    ContextWQ* work_queue;
     io::ObjectDispatchSpec* req;
     bool disable_read_from_parent;
 
@@ -54,11 +81,11 @@ struct C_AlignedObjectReadRequest : public Context {
             uint64_t object_no, io::ReadExtents* extents, IOContext io_context,
             int op_flags, int read_flags, const ZTracer::Trace &parent_trace,
             uint64_t* version, int* object_dispatch_flags,
-            Context* on_dispatched
+            Context* on_dispatched, ContextWQ* work_queue
             ) : image_ctx(image_ctx), crypto(crypto), object_no(object_no),
                 extents(extents), io_context(io_context),
                 parent_trace(parent_trace), version(version),
-                on_finish(on_dispatched) {
+                on_finish(on_dispatched), work_queue(work_queue) {
       disable_read_from_parent =
               ((read_flags & io::READ_FLAG_DISABLE_READ_FROM_PARENT) != 0);
       read_flags |= io::READ_FLAG_DISABLE_READ_FROM_PARENT;
@@ -85,6 +112,18 @@ struct C_AlignedObjectReadRequest : public Context {
     void handle_read(int r) {
       auto cct = image_ctx->cct;
       ldout(cct, 20) << "aligned read r=" << r << dendl;
+      if (r >= 0 && work_queue != nullptr) {
+        // decrypt off the I/O completion path
+        work_queue->queue(new LambdaContext([this](int r) {
+            handle_decrypt(r);
+          }), r);
+        return;
+      }
+
+      handle_decrypt(r);
+    }
+
+    void handle_decrypt(int r) {
       if (r >= 0) {
         r = 0;
         for (auto& extent: *extents) {
@@ -442,6 +481,14 @@ CryptoObjectDispatch<I>::CryptoObjectDispatch(
   : m_image_ctx(image_ctx), m_crypto(crypto) {
   m_data_offset_object_no = Striper::get_num_objects(image_ctx->layout,
                                                      crypto->get_data_offset());
+
+  auto cct = m_image_ctx->cct;
+  if (cct->_conf.template get_val<uint64_t>("rbd_crypto_threads") > 0) {
+    auto thread_pool_singleton =
+      &cct->lookup_or_create_singleton_object<ThreadPoolSingleton>(
+        "librbd::crypto::thread_pool", false, cct);
+    m_work_queue = thread_pool_singleton->work_queue;
+  }
 }
 
 template <typename I>
@@ -470,7 +517,7 @@ bool CryptoObjectDispatch<I>::read(
     auto req = new C_AlignedObjectReadRequest<I>(
             m_image_ctx, m_crypto, object_no, extents, io_context,
             op_flags, read_flags, parent_trace, version, object_dispatch_flags,
-            on_dispatched);
+            on_dispatched, m_work_queue);
     req->send();
   } else {
     auto req = new C_UnalignedObjectReadRequest<I>(
@@ -501,8 +548,22 @@ bool CryptoObjectDispatch<I>::write(
   ceph_assert(m_crypto != nullptr);
 
   if (m_crypto->is_aligned(object_off, data.length())) {
-    auto r = m_crypto->encrypt(
-        &data, get_file_offset(m_image_ctx, object_no, object_off));
+    auto image_offset = get_file_offset(m_image_ctx, object_no, object_off);
+    if (m_work_queue != nullptr) {
+      // encrypt off the I/O dispatch path -- the data buffer is owned by
+      // the dispatch spec until it has been dispatched
+      m_work_queue->queue(new LambdaContext(
+        [crypto=m_crypto, data=&data, image_offset, dispatch_result,
+         on_dispatched](int) {
+          auto r = crypto->encrypt(data, image_offset);
+          *dispatch_result = r == 0 ? io::DISPATCH_RESULT_CONTINUE
+                                    : io::DISPATCH_RESULT_COMPLETE;
+          on_dispatched->complete(r);
+        }), 0);
+      return true;
+    }
+
+    auto r = m_crypto->encrypt(&data, image_offset);
     *dispatch_result = r == 0 ? io::DISPATCH_RESULT_CONTINUE
                               : io::DISPATCH_RESULT_COMPLETE;
     on_dispatched->complete(r);
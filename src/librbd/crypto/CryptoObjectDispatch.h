@@ -8,6 +8,8 @@
 #include "librbd/io/Types.h"
 #include "librbd/io/ObjectDispatchInterface.h"
 
+class ContextWQ;
+
 namespace librbd {
 
 struct ImageCtx;
@@ -105,6 +107,7 @@ private:
   ImageCtxT* m_image_ctx;
   CryptoInterface* m_crypto;
   uint64_t m_data_offset_object_no;
+  ContextWQ* m_work_queue = nullptr;
 };
 
 } // namespace crypto
@@ -142,12 +142,20 @@ void ImageCopyRequest<I>::send_object_copies() {
   bool complete;
   {
     std::lock_guard locker{m_lock};
-    auto max_ops = m_src_image_ctx->config.template get_val<uint64_t>(
+    auto& config = m_src_image_ctx->config;
+    m_min_ops = config.template get_val<uint64_t>(
       "rbd_concurrent_management_ops");
-
-    // attempt to schedule at least 'max_ops' initial requests where
+    m_max_ops = std::max(m_min_ops, config.template get_val<uint64_t>(
+      "rbd_deep_copy_max_concurrent_ops"));
+    m_window_ops = m_min_ops;
+    m_latency_target = ceph::make_timespan(config.template get_val<double>(
+      "rbd_deep_copy_object_latency_target"));
+    m_start_time = ceph::mono_clock::now();
+    m_last_stats_time = m_start_time;
+
+    // attempt to schedule at least 'm_window_ops' initial requests where
     // some objects might be skipped if fast-diff notes no change
-    for (uint64_t i = 0; i < max_ops; i++) {
+    for (uint64_t i = 0; i < m_window_ops; i++) {
       send_next_object_copy();
     }
 
@@ -173,41 +181,34 @@ void ImageCopyRequest<I>::send_next_object_copy() {
   }
 
   uint64_t ono = m_object_no++;
-  Context *ctx = new LambdaContext(
-    [this, ono](int r) {
-      handle_object_copy(ono, r);
-    });
-
   ldout(m_cct, 20) << "object_num=" << ono << dendl;
   ++m_current_ops;
 
-  uint8_t object_diff_state = object_map::DIFF_STATE_HOLE;
-  if (m_object_diff_state.size() > 0) {
-    std::set<uint64_t> src_objects;
-    map_src_objects(ono, &src_objects);
-
-    for (auto src_ono : src_objects) {
-      if (src_ono >= m_object_diff_state.size()) {
-        object_diff_state = object_map::DIFF_STATE_DATA_UPDATED;
-      } else {
-        auto state = m_object_diff_state[src_ono];
-        if ((state == object_map::DIFF_STATE_HOLE_UPDATED &&
-             object_diff_state != object_map::DIFF_STATE_DATA_UPDATED) ||
-            (state == object_map::DIFF_STATE_DATA &&
-             object_diff_state == object_map::DIFF_STATE_HOLE) ||
-            (state == object_map::DIFF_STATE_DATA_UPDATED)) {
-          object_diff_state = state;
-        }
-      }
+  auto object_diff_state = get_object_diff_state(ono);
+  if (object_diff_state == object_map::DIFF_STATE_HOLE) {
+    // skip the whole run of unchanged objects with a single completion
+    // instead of a context switch per object -- incremental syncs of large
+    // images are otherwise dominated by walking objects that didn't change
+    while (m_object_no < m_end_object_no &&
+           get_object_diff_state(m_object_no) == object_map::DIFF_STATE_HOLE) {
+      ++m_object_no;
     }
 
-    if (object_diff_state == object_map::DIFF_STATE_HOLE) {
-      ldout(m_cct, 20) << "skipping non-existent object " << ono << dendl;
-      create_async_context_callback(*m_src_image_ctx, ctx)->complete(0);
-      return;
-    }
+    ldout(m_cct, 20) << "skipping non-existent objects " << ono << "~"
+                     << (m_object_no - ono) << dendl;
+    Context *ctx = new LambdaContext(
+      [this, ono, end_ono=m_object_no](int r) {
+        handle_object_copy(ono, end_ono, r);
+      });
+    create_async_context_callback(*m_src_image_ctx, ctx)->complete(0);
+    return;
   }
 
+  Context *ctx = new LambdaContext(
+    [this, ono](int r) {
+      handle_object_copy(ono, ono + 1, r);
+    });
+
   uint32_t flags = 0;
   if (m_flatten) {
     flags |= OBJECT_COPY_REQUEST_FLAG_FLATTEN;
@@ -217,21 +218,54 @@ void ImageCopyRequest<I>::send_next_object_copy() {
     flags |= OBJECT_COPY_REQUEST_FLAG_EXISTS_CLEAN;
   }
 
+  m_object_start_times[ono] = ceph::mono_clock::now();
   auto req = ObjectCopyRequest<I>::create(
     m_src_image_ctx, m_dst_image_ctx, m_src_snap_id_start, m_dst_snap_id_start,
-    m_snap_map, ono, flags, m_handler, ctx);
+    m_snap_map, ono, flags, &m_read_handler, ctx);
   req->send();
 }
 
 template <typename I>
-void ImageCopyRequest<I>::handle_object_copy(uint64_t object_no, int r) {
-  ldout(m_cct, 20) << "object_no=" << object_no << ", r=" << r << dendl;
+uint8_t ImageCopyRequest<I>::get_object_diff_state(uint64_t object_no) {
+  if (m_object_diff_state.size() == 0) {
+    // fast-diff not available -- treat as possibly updated
+    return object_map::DIFF_STATE_DATA_UPDATED;
+  }
+
+  std::set<uint64_t> src_objects;
+  map_src_objects(object_no, &src_objects);
+
+  uint8_t object_diff_state = object_map::DIFF_STATE_HOLE;
+  for (auto src_ono : src_objects) {
+    if (src_ono >= m_object_diff_state.size()) {
+      object_diff_state = object_map::DIFF_STATE_DATA_UPDATED;
+    } else {
+      auto state = m_object_diff_state[src_ono];
+      if ((state == object_map::DIFF_STATE_HOLE_UPDATED &&
+           object_diff_state != object_map::DIFF_STATE_DATA_UPDATED) ||
+          (state == object_map::DIFF_STATE_DATA &&
+           object_diff_state == object_map::DIFF_STATE_HOLE) ||
+          (state == object_map::DIFF_STATE_DATA_UPDATED)) {
+        object_diff_state = state;
+      }
+    }
+  }
+  return object_diff_state;
+}
+
+template <typename I>
+void ImageCopyRequest<I>::handle_object_copy(uint64_t object_no,
+                                             uint64_t end_object_no, int r) {
+  ldout(m_cct, 20) << "object_no=" << object_no << ", "
+                   << "end_object_no=" << end_object_no << ", r=" << r
+                   << dendl;
 
   bool complete;
   {
     std::lock_guard locker{m_lock};
     ceph_assert(m_current_ops > 0);
     --m_current_ops;
+    update_window(object_no);
 
     if (r < 0 && r != -ENOENT) {
       lderr(m_cct) << "object copy failed: " << cpp_strerror(r) << dendl;
@@ -239,7 +273,9 @@ void ImageCopyRequest<I>::handle_object_copy(uint64_t object_no, int r) {
         m_ret_val = r;
       }
     } else {
-      m_copied_objects.push(object_no);
+      for (auto ono = object_no; ono < end_object_no; ++ono) {
+        m_copied_objects.push(ono);
+      }
       while (!m_updating_progress && !m_copied_objects.empty() &&
              m_copied_objects.top() ==
                (m_object_number ? *m_object_number + 1 : 0)) {
@@ -255,8 +291,12 @@ void ImageCopyRequest<I>::handle_object_copy(uint64_t object_no, int r) {
       }
     }
 
-    send_next_object_copy();
+    while (m_current_ops < m_window_ops && m_ret_val == 0 &&
+           m_object_no < m_end_object_no) {
+      send_next_object_copy();
+    }
     complete = (m_current_ops == 0) && !m_updating_progress;
+    dump_stats(complete);
   }
 
   if (complete) {
@@ -264,6 +304,63 @@ void ImageCopyRequest<I>::handle_object_copy(uint64_t object_no, int r) {
   }
 }
 
+template <typename I>
+void ImageCopyRequest<I>::update_window(uint64_t object_no) {
+  ceph_assert(ceph_mutex_is_locked(m_lock));
+
+  auto it = m_object_start_times.find(object_no);
+  if (it == m_object_start_times.end()) {
+    // object was skipped
+    return;
+  }
+  auto latency = ceph::mono_clock::now() - it->second;
+  m_object_start_times.erase(it);
+
+  if (m_max_ops <= m_min_ops) {
+    return;
+  }
+
+  if (latency > m_latency_target) {
+    // back off at most once for each window of objects sent so that the
+    // objects already in-flight do not shrink the window repeatedly
+    if (object_no >= m_backoff_object_no) {
+      m_window_ops = std::max(m_min_ops, m_window_ops / 2);
+      m_window_credits = 0;
+      m_backoff_object_no = m_object_no;
+      ldout(m_cct, 10) << "object_no=" << object_no << ", "
+                       << "latency=" << latency << ", "
+                       << "window_ops=" << m_window_ops << dendl;
+    }
+  } else if (++m_window_credits >= m_window_ops) {
+    m_window_credits = 0;
+    if (m_window_ops < m_max_ops) {
+      ++m_window_ops;
+      ldout(m_cct, 20) << "window_ops=" << m_window_ops << dendl;
+    }
+  }
+}
+
+template <typename I>
+void ImageCopyRequest<I>::dump_stats(bool force) {
+  ceph_assert(ceph_mutex_is_locked(m_lock));
+
+  auto now = ceph::mono_clock::now();
+  if (!force && now - m_last_stats_time < std::chrono::seconds(30)) {
+    return;
+  }
+  m_last_stats_time = now;
+
+  auto elapsed = std::chrono::duration<double>(now - m_start_time).count();
+  uint64_t bytes_read = m_bytes_read;
+  double throughput = (elapsed > 0 ? bytes_read / elapsed : 0);
+  ldout(m_cct, 5) << "copied_objects="
+                  << (m_object_number ? *m_object_number + 1 : 0) << "/"
+                  << m_end_object_no << ", "
+                  << "bytes_read=" << bytes_read << ", "
+                  << "throughput=" << throughput / (1 << 20) << " MiB/s, "
+                  << "window_ops=" << m_window_ops << dendl;
+}
+
 template <typename I>
 void ImageCopyRequest<I>::finish(int r) {
   ldout(m_cct, 20) << "r=" << r << dendl;
@@ -8,9 +8,12 @@
 #include "include/rados/librados.hpp"
 #include "common/bit_vector.hpp"
 #include "common/ceph_mutex.h"
+#include "common/ceph_time.h"
 #include "common/RefCountedObj.h"
 #include "librbd/Types.h"
+#include "librbd/deep_copy/Handler.h"
 #include "librbd/deep_copy/Types.h"
+#include <atomic>
 #include <functional>
 #include <map>
 #include <queue>
@@ -26,8 +29,6 @@ class ImageCtx;
 
 namespace deep_copy {
 
-class Handler;
-
 template <typename ImageCtxT = ImageCtx>
 class ImageCopyRequest : public RefCountedObject {
 public:
@@ -68,8 +69,8 @@ private:
    *    |
    *    |      . . . . .
    *    |      .       .  (parallel execution of
-   *    v      v       .   multiple objects at once)
-   * COPY_OBJECT . . . .
+   *    v      v       .   multiple objects at once,
+   * COPY_OBJECT . . . .   adjusted to object latency)
    *    |
    *    v
    * <finish>
@@ -77,6 +78,26 @@ private:
    * @endverbatim
    */
 
+  /// accounts for the bytes read by object copies before forwarding
+  struct ReadHandler : public Handler {
+    ImageCopyRequest *image_copy_request;
+
+    ReadHandler(ImageCopyRequest *image_copy_request)
+      : image_copy_request(image_copy_request) {
+    }
+
+    void handle_read(uint64_t bytes_read) override {
+      image_copy_request->m_bytes_read += bytes_read;
+      image_copy_request->m_handler->handle_read(bytes_read);
+    }
+
+    int update_progress(uint64_t object_number,
+                        uint64_t object_count) override {
+      return image_copy_request->m_handler->update_progress(object_number,
+                                                            object_count);
+    }
+  };
+
   ImageCtxT *m_src_image_ctx;
   ImageCtxT *m_dst_image_ctx;
   librados::snap_t m_src_snap_id_start;
@@ -103,6 +124,19 @@ private:
 
   BitVector<2> m_object_diff_state;
 
+  ReadHandler m_read_handler{this};
+  std::atomic<uint64_t> m_bytes_read = 0;
+  ceph::mono_time m_start_time;
+  ceph::mono_time m_last_stats_time;
+
+  uint64_t m_min_ops = 0;
+  uint64_t m_max_ops = 0;
+  uint64_t m_window_ops = 0;
+  uint64_t m_window_credits = 0;
+  uint64_t m_backoff_object_no = 0;
+  ceph::timespan m_latency_target;
+  std::map<uint64_t, ceph::mono_time> m_object_start_times;
+
   void map_src_objects(uint64_t dst_object, std::set<uint64_t> *src_objects);
 
   void compute_diff();
@@ -110,7 +144,11 @@ private:
 
   void send_object_copies();
   void send_next_object_copy();
-  void handle_object_copy(uint64_t object_no, int r);
+  uint8_t get_object_diff_state(uint64_t object_no);
+  void handle_object_copy(uint64_t object_no, uint64_t end_object_no, int r);
+
+  void update_window(uint64_t object_no);
+  void dump_stats(bool force);
 
   void finish(int r);
 };
@@ -130,7 +130,16 @@ void ObjectCopyRequest<I>::handle_list_snaps(int r) {
 
 template <typename I>
 void ObjectCopyRequest<I>::send_read() {
-  if (m_read_snaps.empty()) {
+  // snapshots with nothing written to this object (must be trunc/remove)
+  // do not require a read
+  std::vector<WriteReadSnapIds> read_snaps;
+  for (auto& index : m_read_snaps) {
+    if (!m_read_ops[index].image_interval.empty()) {
+      read_snaps.push_back(index);
+    }
+  }
+
+  if (read_snaps.empty()) {
     // all snapshots have been read
     merge_write_ops();
     compute_zero_ops();
@@ -139,66 +148,86 @@ void ObjectCopyRequest<I>::send_read() {
     return;
   }
 
-  auto index = *m_read_snaps.begin();
-  auto& read_op = m_read_ops[index];
-  if (read_op.image_interval.empty()) {
-    // nothing written to this object for this snapshot (must be trunc/remove)
-    handle_read(0);
-    return;
+  ldout(m_cct, 20) << "reading " << read_snaps.size() << " snapshot(s)"
+                   << dendl;
+
+  // the reads for all snapshots are independent so issue them at once
+  // instead of paying a round-trip per snapshot
+  {
+    std::lock_guard locker{m_lock};
+    m_pending_reads = read_snaps.size();
   }
 
-  auto io_context = m_src_image_ctx->duplicate_data_io_context();
-  io_context->read_snap(index.second);
+  for (auto& index : read_snaps) {
+    auto& read_op = m_read_ops[index];
 
-  io::Extents image_extents{read_op.image_interval.begin(),
-                            read_op.image_interval.end()};
-  io::ReadResult read_result{&read_op.image_extent_map,
-                             &read_op.out_bl};
+    auto io_context = m_src_image_ctx->duplicate_data_io_context();
+    io_context->read_snap(index.second);
 
-  ldout(m_cct, 20) << "read: src_snap_seq=" << index.second << ", "
-                   << "image_extents=" << image_extents << dendl;
+    io::Extents image_extents{read_op.image_interval.begin(),
+                              read_op.image_interval.end()};
+    io::ReadResult read_result{&read_op.image_extent_map,
+                               &read_op.out_bl};
 
-  int op_flags = (LIBRADOS_OP_FLAG_FADVISE_SEQUENTIAL |
-                  LIBRADOS_OP_FLAG_FADVISE_NOCACHE);
+    ldout(m_cct, 20) << "read: src_snap_seq=" << index.second << ", "
+                     << "image_extents=" << image_extents << dendl;
 
-  int read_flags = 0;
-  if (index.second != m_src_image_ctx->snap_id) {
-    read_flags |= io::READ_FLAG_DISABLE_CLIPPING;
-  }
+    int op_flags = (LIBRADOS_OP_FLAG_FADVISE_SEQUENTIAL |
+                    LIBRADOS_OP_FLAG_FADVISE_NOCACHE);
 
-  auto ctx = create_context_callback<
-    ObjectCopyRequest<I>, &ObjectCopyRequest<I>::handle_read>(this);
-  auto aio_comp = io::AioCompletion::create_and_start(
-    ctx, get_image_ctx(m_src_image_ctx), io::AIO_TYPE_READ);
+    int read_flags = 0;
+    if (index.second != m_src_image_ctx->snap_id) {
+      read_flags |= io::READ_FLAG_DISABLE_CLIPPING;
+    }
 
-  auto req = io::ImageDispatchSpec::create_read(
-    *m_src_image_ctx, io::IMAGE_DISPATCH_LAYER_INTERNAL_START, aio_comp,
-    std::move(image_extents), m_image_area, std::move(read_result),
-    io_context, op_flags, read_flags, {});
-  req->send();
+    auto ctx = new LambdaContext([this, index](int r) {
+        handle_read(index, r);
+      });
+    auto aio_comp = io::AioCompletion::create_and_start(
+      ctx, get_image_ctx(m_src_image_ctx), io::AIO_TYPE_READ);
+
+    auto req = io::ImageDispatchSpec::create_read(
+      *m_src_image_ctx, io::IMAGE_DISPATCH_LAYER_INTERNAL_START, aio_comp,
+      std::move(image_extents), m_image_area, std::move(read_result),
+      io_context, op_flags, read_flags, {});
+    req->send();
+  }
 }
 
 template <typename I>
-void ObjectCopyRequest<I>::handle_read(int r) {
-  ldout(m_cct, 20) << "r=" << r << dendl;
+void ObjectCopyRequest<I>::handle_read(const WriteReadSnapIds& index, int r) {
+  ldout(m_cct, 20) << "src_snap_seq=" << index.second << ", r=" << r << dendl;
+
+  {
+    std::lock_guard locker{m_lock};
+    if (r < 0) {
+      lderr(m_cct) << "failed to read from source object: "
+                   << cpp_strerror(r) << dendl;
+      if (m_read_ret_val == 0) {
+        m_read_ret_val = r;
+      }
+    } else if (m_handler != nullptr) {
+      m_handler->handle_read(m_read_ops[index].out_bl.length());
+    }
+
+    ceph_assert(m_pending_reads > 0);
+    if (--m_pending_reads > 0) {
+      return;
+    }
+    r = m_read_ret_val;
+  }
 
   if (r < 0) {
-    lderr(m_cct) << "failed to read from source object: " << cpp_strerror(r)
-                 << dendl;
     finish(r);
     return;
   }
 
-  if (m_handler != nullptr) {
-    auto index = *m_read_snaps.begin();
-    auto& read_op = m_read_ops[index];
-    m_handler->handle_read(read_op.out_bl.length());
-  }
+  m_read_snaps.clear();
 
-  ceph_assert(!m_read_snaps.empty());
-  m_read_snaps.erase(m_read_snaps.begin());
+  merge_write_ops();
+  compute_zero_ops();
 
-  send_read();
+  send_update_object_map();
 }
 
 template <typename I>
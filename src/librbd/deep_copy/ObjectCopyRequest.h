@@ -7,6 +7,7 @@
 #include "include/int_types.h"
 #include "include/interval_set.h"
 #include "include/rados/librados.hpp"
+#include "common/ceph_mutex.h"
 #include "common/snap_types.h"
 #include "librbd/ImageCtx.h"
 #include "librbd/deep_copy/Types.h"
@@ -14,6 +15,7 @@
 #include <list>
 #include <map>
 #include <string>
+#include <vector>
 
 class Context;
 class RWLock;
@@ -66,10 +68,8 @@ private:
    *    v
    * LIST_SNAPS
    *    |
-   *    |/---------\
-   *    |          | (repeat for each snapshot)
-   *    v          |
-   * READ ---------/
+   *    v
+   * READ (concurrently for each snapshot)
    *    |
    *    |     /-----------\
    *    |     |           | (repeat for each snapshot)
@@ -122,6 +122,10 @@ private:
 
   std::map<WriteReadSnapIds, ReadOp> m_read_ops;
   std::list<WriteReadSnapIds> m_read_snaps;
+  ceph::mutex m_lock = ceph::make_mutex(
+    "librbd::deep_copy::ObjectCopyRequest::m_lock");
+  size_t m_pending_reads = 0;
+  int m_read_ret_val = 0;
   io::SnapshotSparseBufferlist m_snapshot_sparse_bufferlist;
 
   std::map<librados::snap_t, interval_set<uint64_t>> m_dst_data_interval;
@@ -135,7 +139,7 @@ private:
   void handle_list_snaps(int r);
 
   void send_read();
-  void handle_read(int r);
+  void handle_read(const WriteReadSnapIds& index, int r);
 
   void send_update_object_map();
   void handle_update_object_map(int r);
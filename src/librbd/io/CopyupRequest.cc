@@ -2,6 +2,7 @@
 // vim: ts=8 sw=2 smarttab
 
 #include "librbd/io/CopyupRequest.h"
+#include "include/intarith.h"
 #include "include/neorados/RADOS.hpp"
 #include "common/ceph_context.h"
 #include "common/ceph_mutex.h"
@@ -112,6 +113,35 @@ private:
   size_t m_snap_id_idx;
 };
 
+// granularity at which zeroed parent data is dropped from a sparse copyup
+constexpr uint64_t ZERO_DETECT_BLOCK_SIZE = 4096;
+
+void append_non_zero_extents(uint64_t object_offset, const bufferlist& bl,
+                             Extents* extents, bufferlist* data) {
+  uint64_t length = bl.length();
+  uint64_t pos = 0;
+  while (pos < length) {
+    uint64_t block_end = p2roundup<uint64_t>(object_offset + pos + 1,
+                                             ZERO_DETECT_BLOCK_SIZE) -
+      object_offset;
+    uint64_t block_length = std::min(block_end, length) - pos;
+
+    bufferlist block_bl;
+    block_bl.substr_of(bl, pos, block_length);
+    if (!block_bl.is_zero()) {
+      if (!extents->empty() &&
+          extents->back().first + extents->back().second ==
+            object_offset + pos) {
+        extents->back().second += block_length;
+      } else {
+        extents->emplace_back(object_offset + pos, block_length);
+      }
+      data->claim_append(block_bl);
+    }
+    pos += block_length;
+  }
+}
+
 } // anonymous namespace
 
 template <typename I>
@@ -758,7 +788,16 @@ int CopyupRequest<I>::prepare_copyup_data() {
   m_copyup_extent_map.reserve(sparse_bufferlist.ext_count());
   for (auto& extent : sparse_bufferlist) {
     auto& sbe = extent.get_val();
-    if (sbe.state == SPARSE_EXTENT_STATE_DATA) {
+    if (sbe.state != SPARSE_EXTENT_STATE_DATA) {
+      continue;
+    }
+
+    if (m_image_ctx->enable_sparse_copyup) {
+      // a thick parent still returns zeroed blocks as data -- skip them so
+      // that the child object is only populated where the parent has data
+      append_non_zero_extents(extent.get_off(), sbe.bl, &m_copyup_extent_map,
+                              &m_copyup_data);
+    } else {
       m_copyup_extent_map.emplace_back(extent.get_off(), extent.get_len());
       m_copyup_data.append(sbe.bl);
     }
@@ -110,7 +110,9 @@ public:
 private:
   ImageCtxT* m_image_ctx;
 
-  std::list<std::pair<uint64_t, TokenBucketThrottle*> > m_throttles;
+  // namespace throttles are shared with the other images of the namespace
+  std::list<std::pair<uint64_t, std::shared_ptr<TokenBucketThrottle>>>
+    m_throttles;
   uint64_t m_qos_enabled_flag = 0;
   uint64_t m_qos_exclude_ops = 0;
 
@@ -14,10 +14,9 @@
 #include "librbd/io/ObjectDispatcher.h"
 #include "librbd/io/Utils.h"
 
-#include <boost/accumulators/accumulators.hpp>
-#include <boost/accumulators/statistics/rolling_count.hpp>
-#include <boost/accumulators/statistics/rolling_sum.hpp>
-#include <boost/accumulators/statistics/stats.hpp>
+#include <algorithm>
+#include <deque>
+#include <vector>
 
 #define dout_subsys ceph_subsys_rbd
 #undef dout_prefix
@@ -27,7 +26,6 @@
 namespace librbd {
 namespace io {
 
-using namespace boost::accumulators;
 using ceph::operator<<;
 using librbd::util::data_object_name;
 
@@ -35,28 +33,35 @@ static const int LATENCY_STATS_WINDOW_SIZE = 10;
 
 class LatencyStats {
 private:
-  accumulator_set<uint64_t, stats<tag::rolling_count, tag::rolling_sum>> m_acc;
+  uint64_t m_percentile;
+  std::deque<uint64_t> m_samples;
 
 public:
-  LatencyStats()
-    : m_acc(tag::rolling_window::window_size = LATENCY_STATS_WINDOW_SIZE) {
+  LatencyStats(uint64_t percentile) : m_percentile(percentile) {
   }
 
   bool is_ready() const {
-    return rolling_count(m_acc) == LATENCY_STATS_WINDOW_SIZE;
+    return m_samples.size() == LATENCY_STATS_WINDOW_SIZE;
   }
 
   void add(uint64_t latency) {
-    m_acc(latency);
+    if (m_samples.size() == LATENCY_STATS_WINDOW_SIZE) {
+      m_samples.pop_front();
+    }
+    m_samples.push_back(latency);
   }
 
-  uint64_t avg() const {
-    auto count = rolling_count(m_acc);
-
-    if (count > 0) {
-      return rolling_sum(m_acc);
+  uint64_t percentile() const {
+    if (m_samples.empty()) {
+      return 0;
     }
-    return 0;
+
+    // a single slow OSD op shouldn't inflate the delay of every write
+    std::vector<uint64_t> samples(m_samples.begin(), m_samples.end());
+    auto idx = std::min<size_t>(samples.size() * m_percentile / 100,
+                                samples.size() - 1);
+    std::nth_element(samples.begin(), samples.begin() + idx, samples.end());
+    return samples[idx];
   }
 };
 
@@ -190,7 +195,9 @@ SimpleSchedulerObjectDispatch<I>::SimpleSchedulerObjectDispatch(
   I::get_timer_instance(cct, &m_timer, &m_timer_lock);
 
   if (m_max_delay == 0) {
-    m_latency_stats = std::make_unique<LatencyStats>();
+    m_latency_stats = std::make_unique<LatencyStats>(
+      image_ctx->config.template get_val<uint64_t>(
+        "rbd_io_scheduler_simple_latency_percentile"));
   }
 }
 
@@ -401,7 +408,8 @@ bool SimpleSchedulerObjectDispatch<I>::try_delay_write(
   if (delayed && !object_requests->is_scheduled_dispatch()) {
     auto dispatch_time = ceph::real_clock::now();
     if (m_latency_stats) {
-      dispatch_time += std::chrono::nanoseconds(m_latency_stats->avg() / 2);
+      dispatch_time += std::chrono::nanoseconds(
+        m_latency_stats->percentile() / 2);
     } else {
       dispatch_time += std::chrono::milliseconds(m_max_delay);
     }
@@ -505,6 +513,28 @@ void SimpleSchedulerObjectDispatch<I>::dispatch_delayed_requests(
   }
 }
 
+template <typename I>
+void SimpleSchedulerObjectDispatch<I>::dispatch_expired_delayed_requests() {
+  ceph_assert(ceph_mutex_is_locked(m_lock));
+  auto cct = m_image_ctx->cct;
+
+  // writes interleaved across objects tend to expire together -- dispatch
+  // them all in one pass instead of re-arming the timer for each object
+  auto now = ceph::real_clock::now();
+  std::vector<uint64_t> object_nos;
+  for (auto& object_requests : m_dispatch_queue) {
+    if (object_requests->is_scheduled_dispatch() &&
+        (object_nos.empty() || object_requests->get_dispatch_time() <= now)) {
+      object_nos.push_back(object_requests->get_object_no());
+    }
+  }
+
+  ldout(cct, 20) << object_nos.size() << " expired objects" << dendl;
+  for (auto object_no : object_nos) {
+    dispatch_delayed_requests(object_no);
+  }
+}
+
 template <typename I>
 void SimpleSchedulerObjectDispatch<I>::schedule_dispatch_delayed_requests() {
   ceph_assert(ceph_mutex_is_locked(m_lock));
@@ -539,16 +569,16 @@ void SimpleSchedulerObjectDispatch<I>::schedule_dispatch_delayed_requests() {
   }
 
   m_timer_task = new LambdaContext(
-    [this, object_no=object_requests->get_object_no()](int r) {
+    [this](int r) {
       ceph_assert(ceph_mutex_is_locked(*m_timer_lock));
       auto cct = m_image_ctx->cct;
       ldout(cct, 20) << "running timer task " << m_timer_task << dendl;
 
       m_timer_task = nullptr;
       m_image_ctx->asio_engine->post(
-        [this, object_no]() {
+        [this]() {
           std::lock_guard locker{m_lock};
-          dispatch_delayed_requests(object_no);
+          dispatch_expired_delayed_requests();
         });
     });
 
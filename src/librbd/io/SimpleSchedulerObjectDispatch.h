@@ -213,6 +213,7 @@ private:
   void dispatch_all_delayed_requests();
   void dispatch_delayed_requests(uint64_t object_no);
   void dispatch_delayed_requests(ObjectRequestsRef object_requests);
+  void dispatch_expired_delayed_requests();
   void register_in_flight_request(uint64_t object_no, const utime_t &start_time,
                                   Context** on_finish);
 
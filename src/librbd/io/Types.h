@@ -78,14 +78,19 @@ enum {
   IMAGE_DISPATCH_FLAG_QOS_WRITE_IOPS_THROTTLE = 1 << 3,
   IMAGE_DISPATCH_FLAG_QOS_READ_BPS_THROTTLE   = 1 << 4,
   IMAGE_DISPATCH_FLAG_QOS_WRITE_BPS_THROTTLE  = 1 << 5,
+  // limits shared by all images of a pool namespace within the process
+  IMAGE_DISPATCH_FLAG_QOS_NAMESPACE_IOPS_THROTTLE = 1 << 7,
+  IMAGE_DISPATCH_FLAG_QOS_NAMESPACE_BPS_THROTTLE  = 1 << 8,
   IMAGE_DISPATCH_FLAG_QOS_BPS_MASK            = (
     IMAGE_DISPATCH_FLAG_QOS_BPS_THROTTLE |
     IMAGE_DISPATCH_FLAG_QOS_READ_BPS_THROTTLE |
-    IMAGE_DISPATCH_FLAG_QOS_WRITE_BPS_THROTTLE),
+    IMAGE_DISPATCH_FLAG_QOS_WRITE_BPS_THROTTLE |
+    IMAGE_DISPATCH_FLAG_QOS_NAMESPACE_BPS_THROTTLE),
   IMAGE_DISPATCH_FLAG_QOS_IOPS_MASK           = (
     IMAGE_DISPATCH_FLAG_QOS_IOPS_THROTTLE |
     IMAGE_DISPATCH_FLAG_QOS_READ_IOPS_THROTTLE |
-    IMAGE_DISPATCH_FLAG_QOS_WRITE_IOPS_THROTTLE),
+    IMAGE_DISPATCH_FLAG_QOS_WRITE_IOPS_THROTTLE |
+    IMAGE_DISPATCH_FLAG_QOS_NAMESPACE_IOPS_THROTTLE),
   IMAGE_DISPATCH_FLAG_QOS_READ_MASK           = (
     IMAGE_DISPATCH_FLAG_QOS_READ_IOPS_THROTTLE |
     IMAGE_DISPATCH_FLAG_QOS_READ_BPS_THROTTLE),
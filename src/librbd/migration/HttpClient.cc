@@ -4,6 +4,7 @@
 #include "librbd/migration/HttpClient.h"
 #include "common/dout.h"
 #include "common/errno.h"
+#include "common/Throttle.h"
 #include "librbd/AsioEngine.h"
 #include "librbd/ImageCtx.h"
 #include "librbd/Utils.h"
@@ -110,6 +111,7 @@ public:
     ldout(cct, 20) << "work=" << work.get() << dendl;
 
     ++m_in_flight_requests;
+    work->http_session = this;
     (*work)(derived().stream());
   }
 
@@ -177,6 +179,10 @@ public:
     }
   }
 
+  uint64_t get_queue_depth() const override {
+    return m_issue_queue.size() + m_receive_queue.size();
+  }
+
 protected:
   HttpClient* m_http_client;
 
@@ -768,7 +774,22 @@ HttpClient<I>::HttpClient(I* image_ctx, const std::string& url)
     m_asio_engine(image_ctx->asio_engine), m_url(url),
     m_strand(boost::asio::make_strand(*m_asio_engine)),
     m_ssl_context(boost::asio::ssl::context::sslv23_client) {
-    m_ssl_context.set_default_verify_paths();
+  m_ssl_context.set_default_verify_paths();
+
+  auto bps_limit = m_image_ctx->config.template get_val<uint64_t>(
+    "rbd_migration_http_bps_limit");
+  if (bps_limit > 0) {
+    SafeTimer* timer;
+    ceph::mutex* timer_lock;
+    ImageCtx::get_timer_instance(m_cct, &timer, &timer_lock);
+    m_throttle = std::make_unique<TokenBucketThrottle>(
+      m_cct, "rbd_migration_http_bps", 0, 0, timer, timer_lock);
+    m_throttle->set_limit(bps_limit, 0, 1);
+  }
+}
+
+template <typename I>
+HttpClient<I>::~HttpClient() {
 }
 
 template <typename I>
@@ -784,13 +805,13 @@ void HttpClient<I>::open(Context* on_finish) {
   }
 
   boost::asio::post(m_strand, [this, on_finish]() mutable {
-    create_http_session(on_finish); });
+    init_http_sessions(on_finish); });
 }
 
 template <typename I>
 void HttpClient<I>::close(Context* on_finish) {
   boost::asio::post(m_strand, [this, on_finish]() mutable {
-    shut_down_http_session(on_finish); });
+    shut_down_http_sessions(on_finish); });
 }
 
 template <typename I>
@@ -863,16 +884,36 @@ void HttpClient<I>::read(io::Extents&& byte_extents, bufferlist* data,
     range << "bytes=" << byte_offset << "-" << (byte_offset + byte_length - 1);
     req.set(boost::beast::http::field::range, range.str());
 
-    issue(
-      std::move(req),
-      [this, byte_offset=byte_offset, byte_length=byte_length, ctx]
-      (int r, Response&& response) {
-        handle_read(r, std::move(response), byte_offset, byte_length, &ctx->bl,
-                    ctx);
-     });
+    auto issue_ctx = new LambdaContext(
+      [this, req=std::move(req), byte_offset=byte_offset,
+       byte_length=byte_length, ctx](int) mutable {
+        issue(
+          std::move(req),
+          [this, byte_offset, byte_length, ctx](int r, Response&& response) {
+            handle_read(r, std::move(response), byte_offset, byte_length,
+                        &ctx->bl, ctx);
+         });
+      });
+
+    if (m_throttle &&
+        m_throttle->get(byte_length, this, &HttpClient<I>::handle_throttle_ready,
+                        issue_ctx, 0)) {
+      ldout(m_cct, 20) << "throttled: bytes=" << byte_offset << "~"
+                       << byte_length << dendl;
+      continue;
+    }
+    issue_ctx->complete(0);
   }
 }
 
+template <typename I>
+void HttpClient<I>::handle_throttle_ready(Context* on_ready, uint64_t flag) {
+  ldout(m_cct, 20) << dendl;
+
+  // timer_lock is held -- so issue from outside the timer thread
+  boost::asio::post(m_strand, [on_ready]() { on_ready->complete(0); });
+}
+
 template <typename I>
 void HttpClient<I>::handle_read(int r, Response&& response,
                                 uint64_t byte_offset, uint64_t byte_length,
@@ -906,39 +947,68 @@ void HttpClient<I>::handle_read(int r, Response&& response,
 template <typename I>
 void HttpClient<I>::issue(std::shared_ptr<Work>&& work) {
   boost::asio::post(m_strand, [this, work=std::move(work)]() mutable {
-    m_http_session->issue(std::move(work)); });
+    // dispatch to the least busy session, favoring the front of the pool so
+    // that additional connections are only opened under concurrent load
+    auto http_session = m_http_sessions.front().get();
+    auto queue_depth = http_session->get_queue_depth();
+    for (auto& session : m_http_sessions) {
+      if (queue_depth == 0) {
+        break;
+      }
+
+      auto session_queue_depth = session->get_queue_depth();
+      if (session_queue_depth < queue_depth) {
+        http_session = session.get();
+        queue_depth = session_queue_depth;
+      }
+    }
+
+    http_session->issue(std::move(work)); });
 }
 
 template <typename I>
-void HttpClient<I>::create_http_session(Context* on_finish) {
-  ldout(m_cct, 15) << dendl;
-
-  ceph_assert(m_http_session == nullptr);
+std::unique_ptr<typename HttpClient<I>::HttpSessionInterface>
+HttpClient<I>::create_http_session() {
   switch (m_url_spec.scheme) {
   case URL_SCHEME_HTTP:
-    m_http_session = std::make_unique<PlainHttpSession>(this);
-    break;
+    return std::make_unique<PlainHttpSession>(this);
   case URL_SCHEME_HTTPS:
-    m_http_session = std::make_unique<SslHttpSession>(this);
-    break;
+    return std::make_unique<SslHttpSession>(this);
   default:
     ceph_assert(false);
-    break;
+    return nullptr;
   }
+}
+
+template <typename I>
+void HttpClient<I>::init_http_sessions(Context* on_finish) {
+  auto connections = std::max<uint64_t>(
+    1U, m_image_ctx->config.template get_val<uint64_t>(
+      "rbd_migration_http_connections"));
+  ldout(m_cct, 15) << "connections=" << connections << dendl;
 
-  m_http_session->init(on_finish);
+  ceph_assert(m_http_sessions.empty());
+  for (uint64_t i = 0; i < connections; ++i) {
+    m_http_sessions.push_back(create_http_session());
+  }
+
+  m_http_sessions.front()->init(on_finish);
 }
 
 template <typename I>
-void HttpClient<I>::shut_down_http_session(Context* on_finish) {
+void HttpClient<I>::shut_down_http_sessions(Context* on_finish) {
   ldout(m_cct, 15) << dendl;
 
-  if (m_http_session == nullptr) {
+  if (m_http_sessions.empty()) {
     on_finish->complete(0);
     return;
   }
 
-  m_http_session->shut_down(on_finish);
+  auto gather_ctx = new C_Gather(m_cct, on_finish);
+  for (auto& http_session : m_http_sessions) {
+    http_session->shut_down(gather_ctx->new_sub());
+  }
+  gather_ctx->activate();
 }
 
 } // namespace migration
@@ -24,8 +24,10 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 struct Context;
+class TokenBucketThrottle;
 
 namespace librbd {
 
@@ -49,6 +51,7 @@ public:
   }
 
   HttpClient(ImageCtxT* image_ctx, const std::string& url);
+  ~HttpClient();
   HttpClient(const HttpClient&) = delete;
   HttpClient& operator=(const HttpClient&) = delete;
 
@@ -102,7 +105,7 @@ public:
 
         boost::beast::http::async_write(
           stream, request,
-          [http_session=http_client->m_http_session.get(),
+          [http_session=this->http_session,
            work=this->shared_from_this()]
           (boost::beast::error_code ec, std::size_t) mutable {
             http_session->handle_issue(ec, std::move(work));
@@ -115,7 +118,7 @@ public:
 
         boost::beast::http::async_write(
           stream, request,
-          [http_session=http_client->m_http_session.get(),
+          [http_session=this->http_session,
            work=this->shared_from_this()]
           (boost::beast::error_code ec, std::size_t) mutable {
             http_session->handle_issue(ec, std::move(work));
@@ -145,9 +148,14 @@ private:
     virtual void issue(std::shared_ptr<Work>&& work) = 0;
     virtual void handle_issue(boost::system::error_code ec,
                               std::shared_ptr<Work>&& work) = 0;
+
+    virtual uint64_t get_queue_depth() const = 0;
   };
 
   struct Work : public std::enable_shared_from_this<Work> {
+    // session that the request was most recently written to
+    HttpSessionInterface* http_session = nullptr;
+
     virtual ~Work() {}
     virtual bool need_eof() const = 0;
     virtual bool header_only() const = 0;
@@ -175,7 +183,12 @@ private:
   boost::asio::strand<boost::asio::io_context::executor_type> m_strand;
 
   boost::asio::ssl::context m_ssl_context;
-  std::unique_ptr<HttpSessionInterface> m_http_session;
+
+  // connection pool: the first session is connected when the client is
+  // opened, the remainder are lazily connected when requests back up
+  std::vector<std::unique_ptr<HttpSessionInterface>> m_http_sessions;
+
+  std::unique_ptr<TokenBucketThrottle> m_throttle;
 
   template <typename Fields>
   void initialize_default_fields(Fields& fields) const {
@@ -191,10 +204,13 @@ private:
   void handle_read(int r, Response&& response, uint64_t byte_offset,
                    uint64_t byte_length, bufferlist* data, Context* on_finish);
 
+  void handle_throttle_ready(Context* on_ready, uint64_t flag);
+
   void issue(std::shared_ptr<Work>&& work);
 
-  void create_http_session(Context* on_finish);
-  void shut_down_http_session(Context* on_finish);
+  std::unique_ptr<HttpSessionInterface> create_http_session();
+  void init_http_sessions(Context* on_finish);
+  void shut_down_http_sessions(Context* on_finish);
 };
 
 } // namespace migration
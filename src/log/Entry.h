@@ -10,9 +10,15 @@
 
 #include "boost/container/small_vector.hpp"
 
+#include <fmt/format.h>
+
 #include <pthread.h>
 
+#include <cstring>
+#include <string>
 #include <string_view>
+#include <tuple>
+#include <type_traits>
 
 namespace ceph {
 namespace logging {
@@ -37,6 +43,11 @@ public:
   virtual std::string_view strv() const = 0;
   virtual std::size_t size() const = 0;
 
+  /// true if this is a DeferredEntry whose text has not been formatted
+  virtual bool is_deferred() const {
+    return false;
+  }
+
   time m_stamp;
   pthread_t m_thread;
   short m_prio, m_subsys;
@@ -75,38 +86,204 @@ private:
   CachedStackStringStream cos;
 };
 
+namespace detail {
+
+/* How a DeferredEntry captures each argument: numbers and enums are
+ * copied as they are, strings are copied along with their length.
+ * Anything else has to be formatted by the caller.
+ */
+template <typename T, typename = void>
+struct deferred_arg;
+
+template <typename T>
+struct deferred_arg<T, std::enable_if_t<std::is_arithmetic_v<T>>> {
+  using stored_type = T;
+  static std::size_t size(T) {
+    return sizeof(T);
+  }
+  static char* put(char* p, T v) {
+    std::memcpy(p, &v, sizeof(v));
+    return p + sizeof(v);
+  }
+  static T get(const char*& p) {
+    T v;
+    std::memcpy(&v, p, sizeof(v));
+    p += sizeof(v);
+    return v;
+  }
+};
+
+template <typename T>
+struct deferred_arg<T, std::enable_if_t<std::is_enum_v<T>>>
+  : deferred_arg<std::underlying_type_t<T>> {
+  using base = deferred_arg<std::underlying_type_t<T>>;
+  static std::size_t size(T v) {
+    return base::size(static_cast<std::underlying_type_t<T>>(v));
+  }
+  static char* put(char* p, T v) {
+    return base::put(p, static_cast<std::underlying_type_t<T>>(v));
+  }
+};
+
+template <>
+struct deferred_arg<std::string_view> {
+  using stored_type = std::string_view;
+  static std::size_t size(std::string_view v) {
+    return sizeof(std::size_t) + v.size();
+  }
+  static char* put(char* p, std::string_view v) {
+    std::size_t len = v.size();
+    std::memcpy(p, &len, sizeof(len));
+    std::memcpy(p + sizeof(len), v.data(), len);
+    return p + sizeof(len) + len;
+  }
+  static std::string_view get(const char*& p) {
+    std::size_t len;
+    std::memcpy(&len, p, sizeof(len));
+    std::string_view v(p + sizeof(len), len);
+    p += sizeof(len) + len;
+    return v;
+  }
+};
+template <>
+struct deferred_arg<std::string> : deferred_arg<std::string_view> {};
+template <>
+struct deferred_arg<const char*> : deferred_arg<std::string_view> {};
+template <>
+struct deferred_arg<char*> : deferred_arg<std::string_view> {};
+
+template <typename T>
+using deferred_t = typename deferred_arg<std::decay_t<T>>::stored_type;
+
+using deferred_buffer = boost::container::small_vector<char, 1024>;
+using deferred_render_t = void (*)(std::string_view fmt, const char* args,
+                                   deferred_buffer& out);
+
+template <typename... Args>
+void render_deferred(std::string_view f, const char* args,
+                     deferred_buffer& out)
+{
+  // braced initialization reads the arguments back left to right
+  std::tuple<deferred_t<Args>...> values{
+    deferred_arg<std::decay_t<Args>>::get(args)...};
+  std::apply([&](const auto&... v) {
+    fmt::vformat_to(std::back_inserter(out), f,
+                    fmt::make_format_args(v...));
+  }, values);
+}
+
+} // namespace detail
+
+/* An entry whose arguments are captured in binary form, and formatted
+ * only if the entry is written out or dumped.  Entries that are only
+ * gathered in memory are never formatted at all.  Like MutableEntry,
+ * this should only live on the stack.
+ */
+class DeferredEntry : public Entry {
+public:
+  template <typename... Args>
+  DeferredEntry(short pr, short sub,
+                fmt::format_string<detail::deferred_t<Args>...> f,
+                const Args&... args)
+    : Entry(pr, sub),
+      m_fmt(static_cast<fmt::string_view>(f).data(),
+            static_cast<fmt::string_view>(f).size()),
+      m_render(&detail::render_deferred<Args...>)
+  {
+    m_args.resize((detail::deferred_arg<std::decay_t<Args>>::size(args) + ... + 0));
+    [[maybe_unused]] char* p = m_args.data();
+    ((p = detail::deferred_arg<std::decay_t<Args>>::put(p, args)), ...);
+  }
+  DeferredEntry(const DeferredEntry&) = delete;
+  DeferredEntry& operator=(const DeferredEntry&) = delete;
+  DeferredEntry(DeferredEntry&&) = delete;
+  DeferredEntry& operator=(DeferredEntry&&) = delete;
+  ~DeferredEntry() override = default;
+
+  std::string_view strv() const override {
+    if (!m_rendered) {
+      m_render(m_fmt, m_args.data(), m_str);
+      m_rendered = true;
+    }
+    return std::string_view(m_str.data(), m_str.size());
+  }
+  std::size_t size() const override {
+    return strv().size();
+  }
+  bool is_deferred() const override {
+    return true;
+  }
+
+private:
+  friend class ConcreteEntry;
+
+  std::string_view m_fmt;  ///< must point to a string literal
+  detail::deferred_render_t m_render;
+  boost::container::small_vector<char, 256> m_args;
+  mutable detail::deferred_buffer m_str;
+  mutable bool m_rendered = false;
+};
+
 class ConcreteEntry : public Entry {
 public:
   ConcreteEntry() = delete;
   ConcreteEntry(const Entry& e) : Entry(e) {
-    auto strv = e.strv();
-    str.reserve(strv.size());
-    str.insert(str.end(), strv.begin(), strv.end());
+    assign(e);
   }
   ConcreteEntry& operator=(const Entry& e) {
     Entry::operator=(e);
-    auto strv = e.strv();
-    str.reserve(strv.size());
-    str.assign(strv.begin(), strv.end());
+    assign(e);
     return *this;
   }
-  ConcreteEntry(ConcreteEntry&& e) noexcept : Entry(e), str(std::move(e.str)) {}
+  ConcreteEntry(ConcreteEntry&& e) noexcept
+    : Entry(e), str(std::move(e.str)), deferred_fmt(e.deferred_fmt),
+      deferred_render(e.deferred_render) {
+    e.deferred_render = nullptr;
+  }
   ConcreteEntry& operator=(ConcreteEntry&& e) {
     Entry::operator=(e);
     str = std::move(e.str);
+    deferred_fmt = e.deferred_fmt;
+    deferred_render = e.deferred_render;
+    e.deferred_render = nullptr;
     return *this;
   }
   ~ConcreteEntry() override = default;
 
   std::string_view strv() const override {
+    if (deferred_render) {
+      // str holds the captured arguments until the entry is first read
+      detail::deferred_buffer args;
+      args.swap(str);
+      deferred_render(deferred_fmt, args.data(), str);
+      deferred_render = nullptr;
+    }
     return std::string_view(str.data(), str.size());
   }
   std::size_t size() const override {
-    return str.size();
+    return strv().size();
   }
 
 private:
-  boost::container::small_vector<char, 1024> str;
+  void assign(const Entry& e) {
+    if (e.is_deferred()) {
+      auto& d = static_cast<const DeferredEntry&>(e);
+      if (!d.m_rendered) {
+        str.assign(d.m_args.begin(), d.m_args.end());
+        deferred_fmt = d.m_fmt;
+        deferred_render = d.m_render;
+        return;
+      }
+    }
+    deferred_render = nullptr;
+    auto strv = e.strv();
+    str.reserve(strv.size());
+    str.assign(strv.begin(), strv.end());
+  }
+
+  mutable detail::deferred_buffer str;
+  std::string_view deferred_fmt;
+  mutable detail::deferred_render_t deferred_render = nullptr;
 };
 
 }
@@ -39,6 +39,21 @@ namespace logging {
 
 static OnExitManager exit_callbacks;
 
+static std::atomic<uint64_t> next_log_id = 1;
+
+/// A thread's handle on its buffer; the buffer itself is shared with the
+/// Log so that it can still be collected after the thread exits.
+struct Log::ThreadBufferRef {
+  uint64_t log_id = 0;
+  std::shared_ptr<ThreadBuffer> buffer;
+
+  ~ThreadBufferRef() {
+    if (buffer) {
+      buffer->orphaned = true;
+    }
+  }
+};
+
 static void log_on_exit(void *p)
 {
   Log *l = *(Log **)p;
@@ -50,6 +65,7 @@ static void log_on_exit(void *p)
 Log::Log(const SubsystemMap *s)
   : m_indirect_this(nullptr),
     m_subs(s),
+    m_id(next_log_id++),
     m_recent(DEFAULT_MAX_RECENT)
 {
   m_log_buf.reserve(MAX_LOG_BUF);
@@ -138,6 +154,13 @@ void Log::set_max_recent(std::size_t n)
   m_recent.set_capacity(n);
 }
 
+void Log::set_thread_buffer_size(std::size_t n)
+{
+  // only buffers created from now on get the new size; 0 sends every
+  // entry through m_new
+  m_thread_buffer_size = n;
+}
+
 void Log::set_log_file(std::string_view fn)
 {
   std::scoped_lock lock(m_flush_mutex);
@@ -247,18 +270,115 @@ void Log::stop_journald_logger()
   m_journald.reset();
 }
 
-void Log::submit_entry(Entry&& e)
+Log::ThreadBuffer *Log::_get_thread_buffer()
 {
-  std::unique_lock lock(m_queue_mutex);
-  m_queue_mutex_holder = pthread_self();
+  if (m_thread_buffer_size.load(std::memory_order_relaxed) == 0) {
+    return nullptr;
+  }
+  thread_local ThreadBufferRef ref;
+  if (unlikely(ref.log_id != m_id)) {
+    if (ref.buffer) {
+      ref.buffer->orphaned = true;
+    }
+    ref.buffer = std::make_shared<ThreadBuffer>(m_thread_buffer_size);
+    ref.log_id = m_id;
+    std::scoped_lock lock(m_queue_mutex);
+    m_thread_buffers.push_back(ref.buffer);
+  }
+  return ref.buffer.get();
+}
 
+bool Log::_push_thread_buffer(ThreadBuffer& tb, const Entry& e)
+{
+  uint64_t head = tb.head.load(std::memory_order_relaxed);
+  uint64_t tail = tb.tail.load(std::memory_order_acquire);
+  if (head - tail >= tb.slots.size()) {
+    return false;
+  }
+  // reuses the slot's storage once it has been filled the first time
+  tb.slots[head % tb.slots.size()] = e;
+  tb.head.store(head + 1, std::memory_order_release);
+  if (head == tail) {
+    m_cond_flusher.notify_one();
+  }
+  return true;
+}
+
+bool Log::_thread_buffers_empty() const
+{
+  for (auto& tb : m_thread_buffers) {
+    if (tb->head.load(std::memory_order_acquire) !=
+	tb->tail.load(std::memory_order_relaxed)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Log::_collect_new()
+{
+  assert(m_flush.empty());
+  m_flush.swap(m_new);
+  const std::size_t unbuffered = m_flush.size();
+
+  bool buffered = false;
+  for (auto i = m_thread_buffers.begin(); i != m_thread_buffers.end(); ) {
+    auto& tb = **i;
+    // check orphaned first: an exited thread will not add anything after
+    // the head we read below
+    bool orphaned = tb.orphaned.load(std::memory_order_acquire);
+    uint64_t head = tb.head.load(std::memory_order_acquire);
+    uint64_t tail = tb.tail.load(std::memory_order_relaxed);
+    for (; tail != head; ++tail) {
+      m_flush.emplace_back(std::move(*tb.slots[tail % tb.slots.size()]));
+      buffered = true;
+    }
+    tb.tail.store(tail, std::memory_order_release);
+    if (orphaned) {
+      i = m_thread_buffers.erase(i);
+    } else {
+      ++i;
+    }
+  }
+
+  // entries from different threads were collected one thread at a time.
+  // a thread only bypasses its buffer when the buffer is full, so what
+  // it put in m_new comes after what is buffered
+  if (buffered) {
+    std::rotate(m_flush.begin(), m_flush.begin() + unbuffered, m_flush.end());
+    std::stable_sort(m_flush.begin(), m_flush.end(),
+		     [](const ConcreteEntry& a, const ConcreteEntry& b) {
+		       return a.m_stamp < b.m_stamp;
+		     });
+  }
+}
+
+void Log::submit_entry(Entry&& e)
+{
   if (unlikely(m_inject_segv))
     *(volatile int *)(0) = 0xdead;
 
-  // wait for flush to catch up
-  while (is_started() &&
-	 m_new.size() > m_max_new) {
+  ThreadBuffer *tb = _get_thread_buffer();
+  if (tb && _push_thread_buffer(*tb, e)) {
+    return;
+  }
+
+  std::unique_lock lock(m_queue_mutex);
+  m_queue_mutex_holder = pthread_self();
+
+  // wait for flush to catch up.  a thread with a buffer keeps using it,
+  // so that its entries are collected in the order they were submitted
+  while (is_started()) {
     if (m_stop) break; // force addition
+    if (tb) {
+      if (_push_thread_buffer(*tb, e)) {
+	m_queue_mutex_holder = 0;
+	return;
+      }
+      m_cond_flusher.notify_all();
+    } else if (m_new.size() <= m_max_new) {
+      break;
+    }
     m_cond_loggers.wait(lock);
   }
 
@@ -275,8 +395,7 @@ void Log::flush()
   {
     std::scoped_lock lock2(m_queue_mutex);
     m_queue_mutex_holder = pthread_self();
-    assert(m_flush.empty());
-    m_flush.swap(m_new);
+    _collect_new();
     m_cond_loggers.notify_all();
     m_queue_mutex_holder = 0;
   }
@@ -485,8 +604,7 @@ void Log::dump_recent()
   {
     std::scoped_lock lock2(m_queue_mutex);
     m_queue_mutex_holder = pthread_self();
-    assert(m_flush.empty());
-    m_flush.swap(m_new);
+    _collect_new();
     m_queue_mutex_holder = 0;
   }
 
@@ -527,6 +645,8 @@ void Log::dump_recent()
 
   _log_message(fmt::format("  max_recent {:9}", m_recent.capacity()), true);
   _log_message(fmt::format("  max_new    {:9}", m_max_new), true);
+  _log_message(fmt::format("  thread_buffer_size {:3}",
+			   m_thread_buffer_size.load()), true);
   _log_message(fmt::format("  log_file {}", m_log_file), true);
 
   _log_message("--- end dump of recent events ---", true);
@@ -566,7 +686,7 @@ void *Log::entry()
     std::unique_lock lock(m_queue_mutex);
     m_queue_mutex_holder = pthread_self();
     while (!m_stop) {
-      if (!m_new.empty()) {
+      if (!m_new.empty() || !_thread_buffers_empty()) {
         m_queue_mutex_holder = 0;
         lock.unlock();
         flush();
@@ -575,7 +695,13 @@ void *Log::entry()
         continue;
       }
 
-      m_cond_flusher.wait(lock);
+      if (m_thread_buffers.empty()) {
+        m_cond_flusher.wait(lock);
+      } else {
+        // threads notify without m_queue_mutex, so a wakeup can slip in
+        // between the check above and this wait
+        m_cond_flusher.wait_for(lock, std::chrono::milliseconds(100));
+      }
     }
     m_queue_mutex_holder = 0;
   }
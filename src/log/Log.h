@@ -6,12 +6,15 @@
 
 #include <boost/circular_buffer.hpp>
 
+#include <atomic>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <queue>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "common/Thread.h"
 #include "common/likely.h"
@@ -42,6 +45,7 @@ public:
   void set_coarse_timestamps(bool coarse);
   void set_max_new(std::size_t n);
   void set_max_recent(std::size_t n);
+  void set_thread_buffer_size(std::size_t n);
   void set_log_file(std::string_view fn);
   void reopen_log_file();
   void chown_log_file(uid_t uid, gid_t gid);
@@ -87,8 +91,22 @@ protected:
 private:
   using EntryRing = boost::circular_buffer<ConcreteEntry>;
 
+  /// Entries submitted by one thread and not yet collected by the
+  /// flusher.  The owning thread is the only writer of head, and the
+  /// flusher, under m_queue_mutex, the only writer of tail, so neither
+  /// side takes a lock.
+  struct ThreadBuffer {
+    explicit ThreadBuffer(std::size_t n) : slots(n) {}
+    std::vector<std::optional<ConcreteEntry>> slots;
+    std::atomic<uint64_t> head = 0;  ///< next slot to fill
+    std::atomic<uint64_t> tail = 0;  ///< next slot to collect
+    std::atomic<bool> orphaned = false;  ///< owning thread has exited
+  };
+  struct ThreadBufferRef;
+
   static const std::size_t DEFAULT_MAX_NEW = 100;
   static const std::size_t DEFAULT_MAX_RECENT = 10000;
+  static const std::size_t DEFAULT_THREAD_BUFFER_SIZE = 64;
 
   Log **m_indirect_this;
 
@@ -102,6 +120,10 @@ private:
   pthread_t m_queue_mutex_holder;
   pthread_t m_flush_mutex_holder;
 
+  const uint64_t m_id;  ///< tells thread buffers of different Logs apart
+  std::atomic<std::size_t> m_thread_buffer_size = DEFAULT_THREAD_BUFFER_SIZE;
+  std::vector<std::shared_ptr<ThreadBuffer>> m_thread_buffers;
+
   EntryVector m_new;    ///< new entries
   EntryRing m_recent; ///< recent (less new) entries we've already written at low detail
   EntryVector m_flush; ///< entries to be flushed (here to optimize heap allocations)
@@ -136,6 +158,11 @@ private:
 
   void *entry() override;
 
+  ThreadBuffer *_get_thread_buffer();
+  bool _push_thread_buffer(ThreadBuffer& tb, const Entry& e);
+  bool _thread_buffers_empty() const;
+  void _collect_new();
+
   void _log_safe_write(std::string_view sv);
   void _flush_logbuf();
   void _log_message(std::string_view s, bool crash);
@@ -14,6 +14,9 @@
 
 #include <limits.h>
 
+#include <fstream>
+#include <thread>
+
 using namespace std;
 using namespace ceph::logging;
 
@@ -490,6 +493,92 @@ TEST(Log, GarbleRecovery)
   ASSERT_GT(file_status.st_size, 2000);
 }
 
+TEST(Log, Deferred)
+{
+  static const char* test_file="log_deferred";
+
+  Log* saved = g_ceph_context->_log;
+  Log log(&g_ceph_context->_conf->subsys);
+  log.start();
+  unlink(test_file);
+  log.set_log_file(test_file);
+  log.reopen_log_file();
+  g_ceph_context->_log = &log;
+
+  g_ceph_context->_conf->subsys.set_gather_level(ceph_subsys_context, 20);
+  g_ceph_context->_conf->subsys.set_log_level(ceph_subsys_context, 1);
+  std::string name = "obj";
+  ldout_fmt(g_ceph_context, 1, "written {} {} {:#x} {{}}", name, 1.5, 255);
+  ldout_fmt(g_ceph_context, 20, "gathered {} {}", "only", 42);
+
+  g_ceph_context->_log = saved;
+  log.flush();
+
+  std::ifstream in(test_file);
+  std::string contents((std::istreambuf_iterator<char>(in)),
+		       std::istreambuf_iterator<char>());
+  ASSERT_NE(contents.find("written obj 1.5 0xff {}"), std::string::npos);
+  ASSERT_EQ(contents.find("gathered"), std::string::npos);
+
+  log.dump_recent();
+  log.stop();
+  in.close();
+  in.open(test_file);
+  contents.assign(std::istreambuf_iterator<char>(in),
+		  std::istreambuf_iterator<char>());
+  ASSERT_NE(contents.find("gathered only 42"), std::string::npos);
+}
+
+TEST(Log, ThreadBuffers)
+{
+  static const char* test_file="log_thread_buffers";
+  SubsystemMap subs;
+  subs.set_log_level(1, 20);
+  subs.set_gather_level(1, 20);
+
+  for (std::size_t buffer_size : {0, 1, 64}) {
+    Log log(&subs);
+    log.set_thread_buffer_size(buffer_size);
+    log.start();
+    unlink(test_file);
+    log.set_log_file(test_file);
+    log.reopen_log_file();
+
+    const int num_threads = 4;
+    const int num_entries = 10000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+      threads.emplace_back([&log, t] {
+	for (int i = 0; i < num_entries; i++) {
+	  DeferredEntry e(1, 1, "thread {} entry {}", t, i);
+	  log.submit_entry(std::move(e));
+	}
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    log.flush();
+    log.stop();
+
+    // each thread's entries are written in the order they were submitted
+    std::ifstream in(test_file);
+    std::vector<int> next(num_threads, 0);
+    std::string line;
+    while (std::getline(in, line)) {
+      int t, i;
+      auto pos = line.find("thread ");
+      ASSERT_NE(pos, std::string::npos);
+      ASSERT_EQ(2, sscanf(line.c_str() + pos, "thread %d entry %d", &t, &i));
+      ASSERT_EQ(next[t], i);
+      next[t]++;
+    }
+    for (int t = 0; t < num_threads; t++) {
+      ASSERT_EQ(num_entries, next[t]);
+    }
+  }
+}
+
 int main(int argc, char **argv)
 {
   auto args = argv_to_vec(argc, argv);
@@ -379,7 +379,7 @@ public:
   LocalLockC versionlock; // FIXME referenced containers not in mempool
 
   mempool::mds_co::map<client_t,ClientLease*> client_lease_map;
-  std::map<int, std::unique_ptr<BatchOp>> batch_ops;
+  compact_map<int, std::unique_ptr<BatchOp>> batch_ops;
 
 
 protected:
@@ -1558,10 +1558,22 @@ void CDir::fetch(std::string_view dname, snapid_t last,
 
   // FIXME: to fetch a snap dentry, we need to get omap key in range
   //       [(name, last), (name, CEPH_NOSNAP))
-  if (!dname.empty() && last == CEPH_NOSNAP && !g_conf().get_val<bool>("mds_dir_prefetch")) {
-    dentry_key_t key(last, dname, inode->hash_dentry_name(dname));
-    fetch_keys({key}, c);
-    return;
+  if (!dname.empty() && last == CEPH_NOSNAP) {
+    bool prefetch = g_conf().get_val<bool>("mds_dir_prefetch");
+    // loading a huge dirfrag for one lookup takes too long and fills the
+    // cache; the parent's dirstat tells us roughly how big it is.
+    uint64_t max_entries = g_conf().get_val<uint64_t>("mds_dir_prefetch_max_entries");
+    uint64_t est_entries = std::max<int64_t>(inode->get_inode()->dirstat.size(), 0) >> frag.bits();
+    if (prefetch && max_entries && est_entries > max_entries) {
+      dout(10) << "fetch ~" << est_entries << " entries > " << max_entries
+	       << ", fetching key only" << dendl;
+      prefetch = false;
+    }
+    if (!prefetch) {
+      dentry_key_t key(last, dname, inode->hash_dentry_name(dname));
+      fetch_keys({key}, c);
+      return;
+    }
   }
 
   if (c)
@@ -27,6 +27,7 @@
 #include "include/elist.h"
 #include "include/types.h"
 #include "include/lru.h"
+#include "include/compact_map.h"
 #include "include/compact_set.h"
 
 #include "MDSCacheObject.h"
@@ -418,7 +419,7 @@ class CInode : public MDSCacheObject, public InodeStoreBase, public Counter<CIno
     ceph_assert(batch_ops.empty());
   }
 
-  std::map<int, std::unique_ptr<BatchOp>> batch_ops;
+  compact_map<int, std::unique_ptr<BatchOp>> batch_ops;
 
   std::string_view pin_name(int p) const override;
 
@@ -1068,7 +1069,7 @@ class CInode : public MDSCacheObject, public InodeStoreBase, public Counter<CIno
   // list item node for when we have unpropagated rstat data
   elist<CInode*>::item dirty_rstat_item;
 
-  mempool::mds_co::set<client_t> client_snap_caps;
+  mempool::mds_co::compact_set<client_t> client_snap_caps;
   mempool::mds_co::compact_map<snapid_t, mempool::mds_co::set<client_t> > client_need_snapflush;
 
   // LogSegment lists i (may) belong to
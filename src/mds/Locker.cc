@@ -2388,7 +2388,7 @@ int Locker::issue_caps(CInode *in, Capability *only_cap)
 					   mds->get_osd_epoch_barrier());
 	in->encode_cap_message(m, cap);
 
-	mds->send_message_client_counted(m, cap->get_session());
+	send_cap_message(m, cap->get_session());
       }
     }
 
@@ -2436,7 +2436,7 @@ int Locker::issue_caps(CInode *in, Capability *only_cap)
 					 mds->get_osd_epoch_barrier());
       in->encode_cap_message(m, cap);
 
-      mds->send_message_client_counted(m, cap->get_session());
+      send_cap_message(m, cap->get_session());
     }
 
     if (only_cap)
@@ -2446,6 +2446,64 @@ int Locker::issue_caps(CInode *in, Capability *only_cap)
   return nissued;
 }
 
+class C_Locker_FlushBatchedCaps : public LockerContext {
+public:
+  explicit C_Locker_FlushBatchedCaps(Locker *l) : LockerContext(l) {}
+  void finish(int r) override {
+    locker->flush_batched_caps();
+  }
+};
+
+void Locker::send_cap_message(const ref_t<MClientCaps>& m, Session *session)
+{
+  uint64_t batch_max = g_conf().get_val<uint64_t>("mds_cap_batch_max_messages");
+  if (batch_max <= 1 || !session->info.has_feature(CEPHFS_FEATURE_CAP_BATCH)) {
+    mds->send_message_client_counted(m, session);
+    return;
+  }
+
+  // flush once the messages queued ahead of us have been dispatched
+  if (batched_caps.empty())
+    mds->queue_waiter(new C_Locker_FlushBatchedCaps(this));
+
+  auto em = batched_caps.emplace(std::piecewise_construct,
+				 std::forward_as_tuple(session),
+				 std::forward_as_tuple());
+  if (em.second)
+    session->get();
+  auto& ls = em.first->second;
+  ls.push_back(m);
+  if (ls.size() >= batch_max)
+    flush_batched_caps(session);
+}
+
+void Locker::flush_batched_caps(Session *session)
+{
+  auto it = batched_caps.find(session);
+  if (it == batched_caps.end())
+    return;
+
+  auto ls = std::move(it->second);
+  batched_caps.erase(it);
+
+  if (ls.size() == 1) {
+    mds->send_message_client_counted(ls.front(), session);
+  } else {
+    dout(10) << __func__ << " " << ls.size() << " cap messages to "
+	     << session->info.inst.name << dendl;
+    for (size_t i = 0; i < ls.size(); ++i)
+      session->inc_push_seq();
+    mds->send_message_client(make_message<MClientCapsBatch>(std::move(ls)), session);
+  }
+  session->put();
+}
+
+void Locker::flush_batched_caps()
+{
+  while (!batched_caps.empty())
+    flush_batched_caps(batched_caps.begin()->first);
+}
+
 void Locker::issue_truncate(CInode *in)
 {
   dout(7) << "issue_truncate on " << *in << dendl;
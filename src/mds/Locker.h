@@ -18,6 +18,7 @@
 #include "include/types.h"
 
 #include "messages/MClientCaps.h"
+#include "messages/MClientCapsBatch.h"
 #include "messages/MClientCapRelease.h"
 #include "messages/MClientLease.h"
 #include "messages/MLock.h"
@@ -169,6 +170,9 @@ public:
   int issue_caps(CInode *in, Capability *only_cap=0);
   void issue_caps_set(std::set<CInode*>& inset);
   void issue_truncate(CInode *in);
+  void send_cap_message(const ref_t<MClientCaps>& m, Session *session);
+  void flush_batched_caps(Session *session);
+  void flush_batched_caps();
   void revoke_stale_cap(CInode *in, client_t client);
   bool revoke_stale_caps(Session *session);
   void resume_stale_caps(Session *session);
@@ -250,12 +254,17 @@ protected:
 
   elist<CInode*> need_snapflush_inodes;
 
+  // cap messages held back until the end of the dispatch cycle, per session
+  // (each holding a session ref)
+  std::map<Session*, std::vector<ref_t<MClientCaps>>> batched_caps;
+
 private:
   friend class C_MDL_CheckMaxSize;
   friend class C_MDL_RequestInodeFileCaps;
   friend class C_Locker_FileUpdate_finish;
   friend class C_Locker_RetryCapRelease;
   friend class C_Locker_Eval;
+  friend class C_Locker_FlushBatchedCaps;
   friend class C_Locker_ScatterWB;
   friend class LockerContext;
   friend class LockerLogContext;
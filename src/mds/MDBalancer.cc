@@ -289,6 +289,12 @@ double mds_load_t::mds_load() const
   case 2:
     return cpu_load_avg;
 
+  case 3:
+    return req_rate + 10.0*queue_len +
+      g_conf().get_val<double>("mds_bal_cpu_weight") * cpu_load_avg +
+      g_conf().get_val<double>("mds_bal_journal_weight") * journal_rate / (1 << 20) +
+      g_conf().get_val<double>("mds_bal_cache_weight") * cache_usage;
+
   }
   ceph_abort();
   return 0;
@@ -335,6 +341,12 @@ mds_load_t MDBalancer::get_load()
 
   load.queue_len = messenger->get_dispatch_queue_len();
 
+  uint64_t journal_pos = 0;
+  if (mds->mdlog->get_journaler())
+    journal_pos = mds->mdlog->get_write_pos();
+  if (uint64_t limit = mds->mdcache->cache_limit_memory(); limit > 0)
+    load.cache_usage = (double)mds->mdcache->cache_size() / limit;
+
   bool update_last = true;
   if (last_get_load != clock::zero() &&
       now > last_get_load) {
@@ -346,15 +358,19 @@ mds_load_t MDBalancer::get_load()
 	load.cpu_load_avg = (cpu_time - last_cpu_time) / el;
       if (num_traverse > last_num_traverse && num_traverse_hit > last_num_traverse_hit)
         load.cache_hit_rate = (double)(num_traverse_hit - last_num_traverse_hit) / (num_traverse - last_num_traverse);
+      if (journal_pos > last_journal_pos)
+	load.journal_rate = (journal_pos - last_journal_pos) / el;
     } else {
       auto p = mds_load.find(mds->get_nodeid());
       if (p != mds_load.end()) {
 	load.req_rate = p->second.req_rate;
 	load.cpu_load_avg = p->second.cpu_load_avg;
 	load.cache_hit_rate = p->second.cache_hit_rate;
+	load.journal_rate = p->second.journal_rate;
       }
       if (num_requests >= last_num_requests && cpu_time >= last_cpu_time &&
-          num_traverse >= last_num_traverse && num_traverse_hit >= last_num_traverse_hit)
+          num_traverse >= last_num_traverse && num_traverse_hit >= last_num_traverse_hit &&
+          journal_pos >= last_journal_pos)
 	update_last = false;
     }
   }
@@ -365,6 +381,7 @@ mds_load_t MDBalancer::get_load()
     last_get_load = now;
     last_num_traverse = num_traverse;
     last_num_traverse_hit = num_traverse_hit;
+    last_journal_pos = journal_pos;
   }
 
   dout(15) << load << dendl;
@@ -724,12 +741,22 @@ void MDBalancer::prep_rebalance(int beat)
 
     mds_meta_load.clear();
 
+    // extrapolate from the previous beat so that we don't export from a rank
+    // whose load is already falling (or to one whose load is rising)
+    double trend_factor = g_conf().get_val<double>("mds_bal_trend_factor");
+
     double total_load = 0.0;
     multimap<double,mds_rank_t> load_map;
     for (mds_rank_t i=mds_rank_t(0); i < mds_rank_t(cluster_size); i++) {
       mds_load_t& load = mds_load.at(i);
 
       double l = load.mds_load() * load_fac;
+      double last = l;
+      if (auto p = mds_last_meta_load.find(i); p != mds_last_meta_load.end())
+	last = p->second;
+      mds_last_meta_load[i] = l;
+      if (trend_factor > 0)
+	l = std::max(0.0, l + trend_factor * (l - last));
       mds_meta_load[i] = l;
 
       if (whoami == 0)
@@ -890,7 +917,9 @@ int MDBalancer::mantle_prep_rebalance()
                   {"all.meta_load", load.all.meta_load()},
                   {"req_rate", load.req_rate},
                   {"queue_len", load.queue_len},
-                  {"cpu_load_avg", load.cpu_load_avg}};
+                  {"cpu_load_avg", load.cpu_load_avg},
+                  {"journal_rate", load.journal_rate},
+                  {"cache_usage", load.cache_usage}};
   }
 
   /* execute the balancer */
@@ -918,6 +947,28 @@ void MDBalancer::try_rebalance(balance_state_t& state)
     return;
   }
 
+  auto now = clock::now();
+  auto cooldown = clock::duration(
+    g_conf().get_val<std::chrono::seconds>("mds_bal_reexport_cooldown"));
+  for (auto p = import_stamps.begin(); p != import_stamps.end(); ) {
+    if (now - p->second >= cooldown)
+      p = import_stamps.erase(p);
+    else
+      ++p;
+  }
+
+  uint64_t max_exports = g_conf().get_val<uint64_t>("mds_bal_max_exports");
+  uint64_t num_exports = 0;
+  auto export_dir = [&](CDir *dir, mds_rank_t target) {
+    if (max_exports && num_exports >= max_exports) {
+      dout(5) << " reached mds_bal_max_exports, not exporting " << *dir << dendl;
+      return false;
+    }
+    num_exports++;
+    mds->mdcache->migrator->export_dir_nicely(dir, target);
+    return true;
+  };
+
   // make a sorted list of my imports
   multimap<double, CDir*> import_pop_map;
   multimap<mds_rank_t, pair<CDir*, double> > import_from_map;
@@ -930,6 +981,10 @@ void MDBalancer::try_rebalance(balance_state_t& state)
       continue;
     if (dir->is_freezing() || dir->is_frozen())
       continue;  // export pbly already in progress
+    if (import_stamps.count(dir->dirfrag())) {
+      dout(15) << "  imported too recently: " << *dir << dendl;
+      continue;
+    }
 
     mds_rank_t from = diri->authority().first;
     double pop = dir->pop_auth_subtree.meta_load();
@@ -939,7 +994,7 @@ void MDBalancer::try_rebalance(balance_state_t& state)
 	from != mds->get_nodeid()) {
       dout(5) << " exporting idle (" << pop << ") import " << *dir
 	      << " back to mds." << from << dendl;
-      mds->mdcache->migrator->export_dir_nicely(dir, from);
+      export_dir(dir, from);
       continue;
     }
 
@@ -986,9 +1041,10 @@ void MDBalancer::try_rebalance(balance_state_t& state)
 	ceph_assert(dir->inode->authority().first == target);  // cuz that's how i put it in the map, dummy
 
 	if (pop <= amount-have) {
+	  if (!export_dir(dir, target))
+	    break;
 	  dout(7) << "reexporting " << *dir << " pop " << pop
 		  << " back to mds." << target << dendl;
-	  mds->mdcache->migrator->export_dir_nicely(dir, target);
 	  have += pop;
 	  import_from_map.erase(plast);
 	  for (auto q = import_pop_map.equal_range(pop);
@@ -1029,10 +1085,11 @@ void MDBalancer::try_rebalance(balance_state_t& state)
 
       double pop = p->first;
       if (pop <= amount-have && pop > MIN_REEXPORT) {
+	if (!export_dir(dir, target))
+	  break;
 	dout(5) << "reexporting " << *dir << " pop " << pop
 		<< " to mds." << target << dendl;
 	have += pop;
-	mds->mdcache->migrator->export_dir_nicely(dir, target);
 	import_pop_map.erase(p++);
       } else {
 	++p;
@@ -1053,6 +1110,8 @@ void MDBalancer::try_rebalance(balance_state_t& state)
     double& have = export_pop_map[target];
     if (amount-have < MIN_OFFLOAD)
       continue;
+    if (max_exports && num_exports >= max_exports)
+      break;
 
     // okay, search for fragments of my workload
     std::vector<CDir*> exports;
@@ -1068,10 +1127,11 @@ void MDBalancer::try_rebalance(balance_state_t& state)
     //fudge = amount - have;
 
     for (const auto& dir : exports) {
+      if (!export_dir(dir, target))
+	break;
       dout(5) << "   - exporting " << dir->pop_auth_subtree
 	      << " " << dir->pop_auth_subtree.meta_load()
 	      << " to mds." << target << " " << *dir << dendl;
-      mds->mdcache->migrator->export_dir_nicely(dir, target);
     }
   }
 
@@ -1347,6 +1407,8 @@ void MDBalancer::subtract_export(CDir *dir)
 {
   dirfrag_load_vec_t subload = dir->pop_auth_subtree;
 
+  import_stamps.erase(dir->dirfrag());
+
   while (true) {
     dir = dir->inode->get_parent_dir();
     if (!dir) break;
@@ -1361,6 +1423,9 @@ void MDBalancer::add_import(CDir *dir)
 {
   dirfrag_load_vec_t subload = dir->pop_auth_subtree;
 
+  if (g_conf().get_val<std::chrono::seconds>("mds_bal_reexport_cooldown").count() > 0)
+    import_stamps[dir->dirfrag()] = clock::now();
+
   while (true) {
     dir = dir->inode->get_parent_dir();
     if (!dir) break;
@@ -1407,6 +1472,7 @@ void MDBalancer::handle_mds_failure(mds_rank_t who)
   if (0 == who) {
     mds_last_epoch_under_map.clear();
   }
+  mds_last_meta_load.erase(who);
 }
 
 int MDBalancer::dump_loads(Formatter *f, int64_t depth) const
@@ -140,6 +140,7 @@ private:
   uint64_t last_cpu_time = 0;
   uint64_t last_num_traverse = 0;
   uint64_t last_num_traverse_hit = 0;
+  uint64_t last_journal_pos = 0;
 
   // Dirfrags which are marked to be passed on to MDCache::[split|merge]_dir
   // just as soon as a delayed context comes back and triggers it.
@@ -147,9 +148,13 @@ private:
   // dirfrags that already have one in flight.
   std::set<dirfrag_t> split_pending, merge_pending;
 
+  // when each of our recent imports arrived, for mds_bal_reexport_cooldown
+  std::map<dirfrag_t, time> import_stamps;
+
   // per-epoch scatter/gathered info
   std::map<mds_rank_t, mds_load_t> mds_load;
   std::map<mds_rank_t, double> mds_meta_load;
+  std::map<mds_rank_t, double> mds_last_meta_load;
   std::map<mds_rank_t, std::map<mds_rank_t, float> > mds_import_map;
   std::map<mds_rank_t, int> mds_last_epoch_under_map;
 
@@ -1509,8 +1509,8 @@ CInode *MDCache::cow_inode(CInode *in, snapid_t last)
       }
     }
     if (!ret.second) {
-      auto client_snap_caps = std::move(in->client_snap_caps);
-      in->client_snap_caps.clear();
+      decltype(in->client_snap_caps) client_snap_caps;
+      client_snap_caps.swap(in->client_snap_caps);
       in->item_open_file.remove_myself();
       in->item_caps.remove_myself();
 
@@ -12761,10 +12761,16 @@ void MDCache::cache_status(Formatter *f)
 {
   f->open_object_section("cache");
 
+  auto& pool = mempool::get_pool(mempool::mds_co::id);
   f->open_object_section("pool");
-  mempool::get_pool(mempool::mds_co::id).dump(f);
+  pool.dump(f);
   f->close_section();
 
+  uint64_t num_inodes = inode_map.size() + snap_inode_map.size();
+  f->dump_unsigned("inodes", num_inodes);
+  f->dump_unsigned("bytes_per_inode",
+                   num_inodes ? pool.allocated_bytes() / num_inodes : 0);
+
   f->close_section();
 }
 
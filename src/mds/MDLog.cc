@@ -74,6 +74,8 @@ void MDLog::create_logger()
   plb.add_u64_counter(l_mdl_segadd, "segadd", "Segments added");
   plb.add_u64_counter(l_mdl_segex, "segex", "Total expired segments");
   plb.add_u64_counter(l_mdl_segtrm, "segtrm", "Trimmed segments");
+  plb.add_u64_counter(l_mdl_flush_coalesced, "flush_coalesced",
+                      "Journal flushes merged into a later write");
 
   plb.set_prio_default(PerfCountersBuilder::PRIO_DEBUGONLY);
   plb.add_u64(l_mdl_expos, "expos", "Journaler xpire position");
@@ -358,13 +360,32 @@ void MDLog::_submit_thread()
 
   std::unique_lock locker{submit_mutex};
 
+  // events appended since the last journal flush, and whether one of them
+  // asked for a flush that was deferred to batch it with later events
+  uint64_t batched_events = 0;
+  bool flush_deferred = false;
+
   while (!mds->is_daemon_stopping()) {
+    map<uint64_t,list<PendingEvent> >::iterator it = pending_events.begin();
+    if (flush_deferred &&
+        (g_conf()->mds_log_pause || it == pending_events.end())) {
+      // caught up with the submitters -- write out the batch
+      dout(10) << "_submit_thread flushing " << batched_events
+               << " batched events" << dendl;
+      flush_deferred = false;
+      batched_events = 0;
+      locker.unlock();
+      journaler->flush();
+      locker.lock();
+      unflushed = 0;
+      continue;
+    }
+
     if (g_conf()->mds_log_pause) {
       submit_cond.wait(locker);
       continue;
     }
 
-    map<uint64_t,list<PendingEvent> >::iterator it = pending_events.begin();
     if (it == pending_events.end()) {
       submit_cond.wait(locker);
       continue;
@@ -379,6 +400,27 @@ void MDLog::_submit_thread()
     PendingEvent data = it->second.front();
     it->second.pop_front();
 
+    // group commit: if more events are already queued behind this flush,
+    // append them first so that the whole batch goes out in one journal
+    // write. The batch grows with the submit rate and adds no latency when
+    // the log is idle.
+    bool flush = data.flush;
+    auto max_batch = g_conf().get_val<uint64_t>(
+      "mds_log_group_commit_max_events");
+    if (flush && batched_events < max_batch &&
+        (!it->second.empty() || std::next(it) != pending_events.end())) {
+      flush = false;
+      flush_deferred = true;
+      if (logger)
+        logger->inc(l_mdl_flush_coalesced);
+    }
+    if (data.le)
+      batched_events++;
+    if (flush) {
+      flush_deferred = false;
+      batched_events = 0;
+    }
+
     locker.unlock();
 
     if (data.le) {
@@ -412,7 +454,7 @@ void MDLog::_submit_thread()
 
       journaler->wait_for_flush(fin);
 
-      if (data.flush)
+      if (flush)
 	journaler->flush();
 
       if (logger)
@@ -428,12 +470,12 @@ void MDLog::_submit_thread()
 	fin2->set_write_pos(journaler->get_write_pos());
 	journaler->wait_for_flush(fin2);
       }
-      if (data.flush)
+      if (flush)
 	journaler->flush();
     }
 
     locker.lock();
-    if (data.flush)
+    if (flush)
       unflushed = 0;
     else if (data.le)
       unflushed++;
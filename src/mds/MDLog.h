@@ -36,6 +36,7 @@ enum {
   l_mdl_rdpos,
   l_mdl_jlat,
   l_mdl_replayed,
+  l_mdl_flush_coalesced,
   l_mdl_last,
 };
 
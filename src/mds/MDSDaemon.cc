@@ -915,7 +915,9 @@ void MDSDaemon::respawn()
 
 bool MDSDaemon::ms_dispatch2(const ref_t<Message> &m)
 {
+  auto lock_start = ceph::mono_clock::now();
   std::lock_guard l(mds_lock);
+  auto dispatch_start = ceph::mono_clock::now();
   if (stopping) {
     return false;
   }
@@ -934,7 +936,17 @@ bool MDSDaemon::ms_dispatch2(const ref_t<Message> &m)
 
   // Not core, try it as a rank message
   if (mds_rank) {
-    return mds_rank->ms_dispatch(m);
+    bool handled = mds_rank->ms_dispatch(m);
+
+    // all rank messages are serialized by mds_lock: track how long they
+    // queue for it and how long each one holds it
+    if (mds_rank && mds_rank->logger) {
+      auto now = ceph::mono_clock::now();
+      mds_rank->logger->tinc(l_mds_lock_wait_latency,
+                             dispatch_start - lock_start);
+      mds_rank->logger->tinc(l_mds_lock_hold_latency, now - dispatch_start);
+    }
+    return handled;
   } else {
     return false;
   }
@@ -773,6 +773,7 @@ void MDSRankDispatcher::tick()
 
     if (whoami == 0)
       scrubstack->advance_scrub_status();
+    scrubstack->update_throttle();
   }
 
   if (is_active() || is_stopping()) {
@@ -1510,6 +1511,9 @@ void MDSRank::send_message_client_counted(const ref_t<Message>& m, const Connect
 
 void MDSRank::send_message_client_counted(const ref_t<Message>& m, Session* session)
 {
+  // anything still batched for this session must reach it first
+  locker->flush_batched_caps(session);
+
   version_t seq = session->inc_push_seq();
   dout(10) << "send_message_client_counted " << session->info.inst.name << " seq "
 	   << seq << " " << *m << dendl;
@@ -1522,6 +1526,8 @@ void MDSRank::send_message_client_counted(const ref_t<Message>& m, Session* sess
 
 void MDSRank::send_message_client(const ref_t<Message>& m, Session* session)
 {
+  locker->flush_batched_caps(session);
+
   dout(10) << "send_message_client " << session->info.inst << " " << *m << dendl;
   if (session->get_connection()) {
     session->get_connection()->send_message2(m);
@@ -3409,6 +3415,10 @@ void MDSRank::create_logger()
     mds_plb.add_u64(l_mds_load_cent, "load_cent", "Load per cent");
     mds_plb.add_u64_counter(l_mds_openino_dir_fetch, "openino_dir_fetch",
                             "OpenIno incomplete directory fetchings");
+    mds_plb.add_time_avg(l_mds_lock_wait_latency, "mds_lock_wait_latency",
+                         "Time messages waited for mds_lock before dispatch");
+    mds_plb.add_time_avg(l_mds_lock_hold_latency, "mds_lock_hold_latency",
+                         "Time mds_lock was held dispatching a message");
 
     // low prio stats
     mds_plb.set_prio_default(PerfCountersBuilder::PRIO_DEBUGONLY);
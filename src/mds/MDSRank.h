@@ -96,6 +96,8 @@ enum {
   l_mds_scrub_dir_base_inodes,
   l_mds_scrub_dirfrag_rstats,
   l_mds_scrub_file_inodes,
+  l_mds_lock_wait_latency,
+  l_mds_lock_hold_latency,
   l_mdss_handle_inode_file_caps,
   l_mdss_ceph_cap_op_revoke,
   l_mdss_ceph_cap_op_grant,
@@ -1032,8 +1032,8 @@ void OpenFileTable::_open_ino_finish(inodeno_t ino, int r)
 	prefetch_state = DIRFRAGS;
 	_prefetch_dirfrags();
       } else {
-	prefetch_state = FILE_INODES;
-	_prefetch_inodes();
+	prefetch_state = FILE_DENTRIES;
+	_prefetch_file_dentries();
       }
     } else if (prefetch_state == FILE_INODES) {
       prefetch_state = DONE;
@@ -1102,6 +1102,66 @@ void OpenFileTable::_prefetch_dirfrags()
       mds->heartbeat_reset();
   }
 
+  auto finish_func = [this](int r) {
+    prefetch_state = FILE_DENTRIES;
+    _prefetch_file_dentries();
+  };
+  if (gather.has_subs()) {
+    gather.set_finisher(
+	new MDSInternalContextWrapper(mds,
+	  new LambdaContext(std::move(finish_func))));
+    gather.activate();
+  } else {
+    finish_func(0);
+  }
+}
+
+/*
+ * Load the dentries of open files whose parent directory is already in
+ * cache, with one omap read per dirfrag, so that most file inodes are in
+ * cache before _prefetch_inodes() opens them one by one.
+ */
+void OpenFileTable::_prefetch_file_dentries()
+{
+  dout(10) << __func__ << dendl;
+  ceph_assert(prefetch_state == FILE_DENTRIES);
+
+  MDCache *mdcache = mds->mdcache;
+  std::map<CDir*, std::vector<dentry_key_t> > fetch_map;
+
+  if (g_conf().get_val<bool>("mds_oft_prefetch_file_dentries")) {
+    for (auto& [ino, anchor] : loaded_anchor_map) {
+      if (anchor.d_type == DT_DIR || anchor.dirino == inodeno_t(0))
+	continue;
+      if (destroyed_inos_set.count(ino) || mdcache->get_inode(ino))
+	continue;
+
+      CInode *diri = mdcache->get_inode(anchor.dirino);
+      if (!diri || !diri->is_dir() || !diri->is_auth() ||
+	  diri->state_test(CInode::STATE_REJOINUNDEF))
+	continue;
+
+      CDir *dir = diri->get_or_open_dirfrag(mdcache, diri->pick_dirfrag(anchor.d_name));
+      if (!dir->is_auth() || dir->is_complete() ||
+	  dir->state_test(CDir::STATE_REJOINUNDEF) ||
+	  dir->lookup(anchor.d_name))
+	continue;
+
+      fetch_map[dir].emplace_back(CEPH_NOSNAP, anchor.d_name);
+    }
+  }
+
+  MDSGatherBuilder gather(g_ceph_context);
+  int num_fetching = 0;
+  for (auto& [dir, keys] : fetch_map) {
+    dir->fetch_keys(keys, gather.new_sub());
+
+    if (!(++num_fetching % mds->heartbeat_reset_grace()))
+      mds->heartbeat_reset();
+  }
+  dout(10) << __func__ << " fetching dentries from " << num_fetching
+	   << " dirfrags" << dendl;
+
   auto finish_func = [this](int r) {
     prefetch_state = FILE_INODES;
     _prefetch_inodes();
@@ -104,6 +104,7 @@ protected:
   void _open_ino_finish(inodeno_t ino, int r);
   void _prefetch_inodes();
   void _prefetch_dirfrags();
+  void _prefetch_file_dentries();
 
   void _get_ancestors(const Anchor& parent,
 		      std::vector<inode_backpointer_t>& ancestors,
@@ -138,8 +139,9 @@ protected:
   enum {
     DIR_INODES = 1,
     DIRFRAGS = 2,
-    FILE_INODES = 3,
-    DONE = 4,
+    FILE_DENTRIES = 3,
+    FILE_INODES = 4,
+    DONE = 5,
   };
   unsigned prefetch_state = 0;
   unsigned num_opening_inodes = 0;
@@ -376,7 +376,7 @@ uint32_t PurgeQueue::_calculate_ops(const PurgeItem &item) const
     const uint64_t num = (item.size > 0) ?
       Striper::get_num_objects(item.layout, item.size) : 1;
 
-    ops_required = num;
+    ops_required = _calculate_range_ops(num);
 
     // Account for deletions for old pools
     if (item.action != PurgeItem::TRUNCATE_FILE) {
@@ -387,6 +387,36 @@ uint32_t PurgeQueue::_calculate_ops(const PurgeItem &item) const
   return ops_required;
 }
 
+uint64_t PurgeQueue::_calculate_range_ops(uint64_t num_obj) const
+{
+  // Only count the deletes that will actually be outstanding at once, so
+  // that one huge file doesn't hold the whole ops budget while it is
+  // deleted a few objects at a time.
+  const uint64_t per_file = g_conf().get_val<uint64_t>("mds_max_purge_ops_per_file");
+  if (per_file == 0)
+    return num_obj;
+  return std::min(num_obj, per_file);
+}
+
+void PurgeQueue::_add_range_ops(const PurgeItem &item, uint64_t first_obj,
+                                uint64_t num_obj,
+                                std::vector<PurgeItemCommitOp> &ops_vec) const
+{
+  // Filer::purge_range() keeps at most filer_max_purge_ops deletes in
+  // flight, so cut a large range into slices that are purged concurrently.
+  const uint64_t filer_ops = std::max<uint64_t>(1, cct->_conf->filer_max_purge_ops);
+  const uint64_t slices = std::max<uint64_t>(
+    1, (_calculate_range_ops(num_obj) + filer_ops - 1) / filer_ops);
+  const uint64_t per_slice = (num_obj + slices - 1) / slices;
+
+  while (num_obj > 0) {
+    uint64_t n = std::min(per_slice, num_obj);
+    ops_vec.emplace_back(item, PurgeItemCommitOp::PURGE_OP_RANGE, 0, first_obj, n);
+    first_obj += n;
+    num_obj -= n;
+  }
+}
+
 bool PurgeQueue::_can_consume()
 {
   if (readonly) {
@@ -498,21 +528,25 @@ bool PurgeQueue::_consume()
 
 class C_IO_PurgeItem_Commit : public Context {
 public:
-  C_IO_PurgeItem_Commit(PurgeQueue *pq, std::vector<PurgeItemCommitOp> ops, uint64_t expire_to)
-    : purge_queue(pq), ops_vec(std::move(ops)), expire_to(expire_to) {
+  C_IO_PurgeItem_Commit(PurgeQueue *pq, std::vector<PurgeItemCommitOp> ops,
+                        uint64_t expire_to, uint32_t num_ops)
+    : purge_queue(pq), ops_vec(std::move(ops)), expire_to(expire_to),
+      num_ops(num_ops) {
   }
 
   void finish(int r) override {
-    purge_queue->_commit_ops(r, ops_vec, expire_to);
+    purge_queue->_commit_ops(r, ops_vec, expire_to, num_ops);
   }
 
 private:
   PurgeQueue *purge_queue;
   std::vector<PurgeItemCommitOp> ops_vec;
   uint64_t expire_to;
+  uint32_t num_ops;
 };
 
-void PurgeQueue::_commit_ops(int r, const std::vector<PurgeItemCommitOp>& ops_vec, uint64_t expire_to)
+void PurgeQueue::_commit_ops(int r, const std::vector<PurgeItemCommitOp>& ops_vec,
+                             uint64_t expire_to, uint32_t ops)
 {
   if (r < 0) {
     derr << " r = " << r << dendl;
@@ -525,20 +559,8 @@ void PurgeQueue::_commit_ops(int r, const std::vector<PurgeItemCommitOp>& ops_ve
   for (auto &op : ops_vec) {
     dout(10) << op.item.get_type_str() << dendl;
     if (op.type == PurgeItemCommitOp::PURGE_OP_RANGE) {
-      uint64_t first_obj = 0, num_obj = 0;
-      uint64_t num = Striper::get_num_objects(op.item.layout, op.item.size);
-      num_obj = num;
-
-      if (op.item.action == PurgeItem::TRUNCATE_FILE) {
-        first_obj = 1;
-        if (num > 1)
-          num_obj = num - 1;
-        else
-          continue;
-      }
-
       filer.purge_range(op.item.ino, &op.item.layout, op.item.snapc,
-                        first_obj, num_obj, ceph::real_clock::now(), op.flags,
+                        op.first_obj, op.num_obj, ceph::real_clock::now(), op.flags,
                         gather.new_sub());
     } else if (op.type == PurgeItemCommitOp::PURGE_OP_REMOVE) {
       if (op.item.action == PurgeItem::PURGE_DIR) {
@@ -563,7 +585,7 @@ void PurgeQueue::_commit_ops(int r, const std::vector<PurgeItemCommitOp>& ops_ve
   ceph_assert(gather.has_subs());
 
   gather.set_finisher(new C_OnFinisher(
-	              new LambdaContext([this, expire_to](int r) {
+	              new LambdaContext([this, expire_to, ops](int r) {
     std::lock_guard l(lock);
 
     if (r == -CEPHFS_EBLOCKLISTED) {
@@ -572,7 +594,7 @@ void PurgeQueue::_commit_ops(int r, const std::vector<PurgeItemCommitOp>& ops_ve
       return;
     }
 
-    _execute_item_complete(expire_to);
+    _execute_item_complete(expire_to, ops);
     _consume();
 
     // Have we gone idle?  If so, do an extra write_head now instead of
@@ -608,7 +630,7 @@ void PurgeQueue::_execute_item(
 
   std::vector<PurgeItemCommitOp> ops_vec;
   auto submit_ops = [&]() {
-    finisher.queue(new C_IO_PurgeItem_Commit(this, std::move(ops_vec), expire_to));
+    finisher.queue(new C_IO_PurgeItem_Commit(this, std::move(ops_vec), expire_to, ops));
   };
 
   if (item.action == PurgeItem::PURGE_FILE) {
@@ -616,7 +638,7 @@ void PurgeQueue::_execute_item(
       uint64_t num = Striper::get_num_objects(item.layout, item.size);
       dout(10) << " 0~" << item.size << " objects 0~" << num
                << " snapc " << item.snapc << " on " << item.ino << dendl;
-      ops_vec.emplace_back(item, PurgeItemCommitOp::PURGE_OP_RANGE, 0);
+      _add_range_ops(item, 0, num, ops_vec);
     }
 
     // remove the backtrace object if it was not purged
@@ -653,7 +675,7 @@ void PurgeQueue::_execute_item(
 
     // keep backtrace object
     if (num > 1) {
-      ops_vec.emplace_back(item, PurgeItemCommitOp::PURGE_OP_RANGE, 0);
+      _add_range_ops(item, 1, num - 1, ops_vec);
     }
     ops_vec.emplace_back(item, PurgeItemCommitOp::PURGE_OP_ZERO, 0);
   } else {
@@ -675,7 +697,7 @@ void PurgeQueue::_execute_item(
 }
 
 void PurgeQueue::_execute_item_complete(
-    uint64_t expire_to)
+    uint64_t expire_to, uint32_t ops)
 {
   ceph_assert(ceph_mutex_is_locked_by_me(lock));
   dout(10) << "complete at 0x" << std::hex << expire_to << std::dec << dendl;
@@ -710,7 +732,7 @@ void PurgeQueue::_execute_item_complete(
     pending_expire.insert(expire_to);
   }
 
-  ops_in_flight -= _calculate_ops(iter->second);
+  ops_in_flight -= ops;
   logger->set(l_pq_executing_ops, ops_in_flight);
   ops_high_water = std::max(ops_high_water, ops_in_flight);
   logger->set(l_pq_executing_ops_high_water, ops_high_water);
@@ -109,11 +109,19 @@ public:
                     object_t _oid, object_locator_t _oloc)
     : item(_item), type(_type), flags(_flags), oid(_oid), oloc(_oloc) {}
 
+  PurgeItemCommitOp(PurgeItem _item, PurgeType _type, int _flags,
+                    uint64_t _first_obj, uint64_t _num_obj)
+    : item(_item), type(_type), flags(_flags),
+      first_obj(_first_obj), num_obj(_num_obj) {}
+
   PurgeItem item;
   PurgeType type;
   int flags;
   object_t oid;
   object_locator_t oloc;
+  // objects covered by a PURGE_OP_RANGE
+  uint64_t first_obj = 0;
+  uint64_t num_obj = 0;
 };
 
 /**
@@ -153,7 +161,8 @@ public:
   // to the queue (there is no callback for when it is executed)
   void push(const PurgeItem &pi, Context *completion);
 
-  void _commit_ops(int r, const std::vector<PurgeItemCommitOp>& ops_vec, uint64_t expire_to);
+  void _commit_ops(int r, const std::vector<PurgeItemCommitOp>& ops_vec,
+                   uint64_t expire_to, uint32_t ops);
 
   // If the on-disk queue is empty and we are not currently processing
   // anything.
@@ -181,6 +190,9 @@ public:
 
 private:
   uint32_t _calculate_ops(const PurgeItem &item) const;
+  uint64_t _calculate_range_ops(uint64_t num_obj) const;
+  void _add_range_ops(const PurgeItem &item, uint64_t first_obj, uint64_t num_obj,
+                      std::vector<PurgeItemCommitOp> &ops_vec) const;
 
   bool _can_consume();
 
@@ -194,7 +206,7 @@ private:
   bool _consume();
 
   void _execute_item(const PurgeItem &item, uint64_t expire_to);
-  void _execute_item_complete(uint64_t expire_to);
+  void _execute_item_complete(uint64_t expire_to, uint32_t ops);
 
   void _go_readonly(int r);
 
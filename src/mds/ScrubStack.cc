@@ -181,7 +181,7 @@ void ScrubStack::kick_off_scrubs()
   dout(20) << __func__ << " entering with " << scrubs_in_progress << " in "
               "progress and " << stack_size << " in the stack" << dendl;
   elist<MDSCacheObject*>::iterator it = scrub_stack.begin();
-  while (g_conf()->mds_max_scrub_ops_in_progress > scrubs_in_progress) {
+  while (get_max_scrub_ops() > scrubs_in_progress) {
     if (it.end()) {
       if (scrubs_in_progress == 0) {
         set_state(STATE_IDLE);
@@ -236,6 +236,47 @@ void ScrubStack::kick_off_scrubs()
   }
 }
 
+int ScrubStack::get_max_scrub_ops() const
+{
+  int max_ops = g_conf()->mds_max_scrub_ops_in_progress;
+  if (scrub_ops_limit > 0 && scrub_ops_limit < max_ops)
+    return scrub_ops_limit;
+  return max_ops;
+}
+
+void ScrubStack::update_throttle()
+{
+  MDSRank *mds = mdcache->mds;
+  if (!mds->logger)
+    return;
+  client_latency_ns.consume_next(mds->logger->get_tavg_ns(l_mds_reply_latency));
+
+  int max_ops = g_conf()->mds_max_scrub_ops_in_progress;
+  double target = g_conf().get_val<double>("mds_scrub_target_client_latency");
+  if (target <= 0 || !is_scrubbing()) {
+    scrub_ops_limit = max_ops;
+    return;
+  }
+
+  // halve on overshoot, grow by one otherwise
+  int limit = get_max_scrub_ops();
+  double latency = client_latency_ns.current_avg() / 1000000000.0;
+  if (latency > target)
+    limit = std::max(1, limit / 2);
+  else if (limit < max_ops)
+    ++limit;
+
+  if (limit != scrub_ops_limit) {
+    dout(10) << __func__ << " client latency " << latency << "s, target "
+	     << target << "s, " << scrub_ops_limit << " -> " << limit
+	     << " scrub ops" << dendl;
+  }
+  bool grew = limit > scrub_ops_limit;
+  scrub_ops_limit = limit;
+  if (grew && state == STATE_RUNNING)
+    kick_off_scrubs();
+}
+
 bool ScrubStack::validate_inode_auth(CInode *in)
 {
   if (in->is_auth()) {
@@ -22,6 +22,7 @@
 #include "ScrubHeader.h"
 
 #include "common/LogClient.h"
+#include "common/perf_counters.h"
 #include "include/elist.h"
 #include "messages/MMDSScrub.h"
 #include "messages/MMDSScrubStats.h"
@@ -97,6 +98,13 @@ public:
 
   void advance_scrub_status();
 
+  /**
+   * Adjust the number of scrub operations allowed in flight, backing
+   * off while client requests take longer than
+   * mds_scrub_target_client_latency. Called from the MDS tick.
+   */
+  void update_throttle();
+
   void handle_mds_failure(mds_rank_t mds);
 
   void dispatch(const cref_t<Message> &m);
@@ -117,6 +125,9 @@ protected:
   /// current number of dentries we're actually scrubbing
   int scrubs_in_progress = 0;
   int stack_size = 0;
+  /// scrub operations allowed in flight, at most mds_max_scrub_ops_in_progress
+  int scrub_ops_limit = 0;
+  PerfCounters::avg_tracker<uint64_t> client_latency_ns;
 
   struct scrub_remote_t {
     std::string tag;
@@ -164,6 +175,7 @@ private:
    * state of the stack.
    */
   void kick_off_scrubs();
+  int get_max_scrub_ops() const;
 
   /**
    * Move the inode/dirfrag that can't be scrubbed immediately
@@ -211,6 +211,8 @@ void Server::create_logger()
                    "Request type remove extended attribute latency");
   plb.add_time_avg(l_mdss_req_readdir_latency, "req_readdir_latency",
                    "Request type read directory latency");
+  plb.add_time_avg(l_mdss_req_lookupbatch_latency, "req_lookupbatch_latency",
+                   "Request type batched lookup latency");
   plb.add_time_avg(l_mdss_req_setfilelock_latency, "req_setfilelock_latency",
                    "Request type set file lock latency");
   plb.add_time_avg(l_mdss_req_getfilelock_latency, "req_getfilelock_latency",
@@ -2050,6 +2052,9 @@ void Server::perf_gather_op_latency(const cref_t<MClientRequest> &req, utime_t l
   case CEPH_MDS_OP_READDIR:
     code = l_mdss_req_readdir_latency;
     break;
+  case CEPH_MDS_OP_LOOKUPBATCH:
+    code = l_mdss_req_lookupbatch_latency;
+    break;
   case CEPH_MDS_OP_SETFILELOCK:
     code = l_mdss_req_setfilelock_latency;
     break;
@@ -2629,6 +2634,9 @@ void Server::dispatch_client_request(MDRequestRef& mdr)
   case CEPH_MDS_OP_READDIR:
     handle_client_readdir(mdr);
     break;
+  case CEPH_MDS_OP_LOOKUPBATCH:
+    handle_client_lookupbatch(mdr);
+    break;
 
   case CEPH_MDS_OP_SETFILELOCK:
     handle_client_file_setlock(mdr);
@@ -4899,6 +4907,194 @@ void Server::handle_client_readdir(MDRequestRef& mdr)
   respond_to_request(mdr, 0);
 }
 
+/*
+ * Look up a list of names in one directory and return the dentry lease
+ * and inode stat of each that exists, in the same per-entry layout as a
+ * readdir reply.  Names that are not returned (missing, in a dirfrag
+ * another rank is auth for, behind an unopened remote link, or past the
+ * reply size limit) must be looked up individually by the client.
+ */
+void Server::handle_client_lookupbatch(MDRequestRef& mdr)
+{
+  const cref_t<MClientRequest> &req = mdr->client_request;
+  Session *session = mds->get_session(req);
+  client_t client = req->get_source().num();
+  MutationImpl::LockOpVec lov;
+  CInode *diri = rdlock_path_pin_ref(mdr, false, true);
+  if (!diri) return;
+
+  if (!diri->is_dir()) {
+    dout(10) << "reply to " << *req << " lookupbatch -CEPHFS_ENOTDIR" << dendl;
+    respond_to_request(mdr, -CEPHFS_ENOTDIR);
+    return;
+  }
+
+  std::vector<std::string> names;
+  try {
+    auto p = req->get_data().cbegin();
+    decode(names, p);
+  } catch (const ceph::buffer::error &e) {
+    dout(10) << "reply to " << *req << " lookupbatch bad names: " << e.what() << dendl;
+    respond_to_request(mdr, -CEPHFS_EINVAL);
+    return;
+  }
+
+  auto num_caps = session->get_num_caps();
+  auto session_cap_acquisition = session->get_cap_acquisition();
+
+  if (num_caps > static_cast<uint64_t>(max_caps_per_client * max_caps_throttle_ratio) && session_cap_acquisition >= cap_acquisition_throttle) {
+      dout(20) << "lookupbatch throttled. max_caps_per_client: " << max_caps_per_client << " num_caps: " << num_caps
+	       << " session_cap_acquistion: " << session_cap_acquisition << " cap_acquisition_throttle: " << cap_acquisition_throttle << dendl;
+      if (logger)
+          logger->inc(l_mdss_cap_acquisition_throttle);
+
+      mds->timer.add_event_after(caps_throttle_retry_request_timeout, new C_MDS_RetryRequest(mdcache, mdr));
+      return;
+  }
+
+  lov.add_rdlock(&diri->filelock);
+  lov.add_rdlock(&diri->dirfragtreelock);
+
+  if (!mds->locker->acquire_locks(mdr, lov))
+    return;
+
+  if (!check_access(mdr, diri, MAY_EXEC))
+    return;
+
+  snapid_t snapid = mdr->snapid;
+  dout(10) << "handle_client_lookupbatch " << names.size() << " names in "
+	   << *diri << " snapid " << snapid << dendl;
+
+  // find the dentries, noting the ones that still need to be read in
+  std::vector<CDentry*> dns(names.size(), nullptr);
+  std::map<CDir*, std::vector<dentry_key_t>> to_fetch;
+  for (size_t i = 0; i < names.size(); ++i) {
+    const std::string& name = names[i];
+    frag_t fg = diri->pick_dirfrag(name);
+    CDir *dir = diri->get_dirfrag(fg);
+    if (!dir) {
+      dir = try_open_auth_dirfrag(diri, fg, mdr);
+      if (!dir) return;
+    } else if (!dir->is_auth()) {
+      dout(20) << " not auth for " << *dir << ", skipping '" << name << "'" << dendl;
+      continue;
+    }
+
+    CDentry *dn = dir->lookup(name, snapid);
+    if (dn) {
+      dns[i] = dn;
+      continue;
+    }
+    if (dir->is_complete() ||
+	(snapid == CEPH_NOSNAP && dir->has_bloom() && !dir->is_in_bloom(name)))
+      continue;  // does not exist
+    if (mds->damage_table.is_dirfrag_damaged(dir)) {
+      dout(4) << " damaged dirfrag " << *dir << ", skipping '" << name << "'" << dendl;
+      continue;
+    }
+    to_fetch[dir].emplace_back(snapid, name, 0);
+  }
+
+  if (!to_fetch.empty()) {
+    for (auto& p : to_fetch) {
+      if (p.first->is_frozen()) {
+	dout(7) << "dir is frozen " << *p.first << dendl;
+	mds->locker->drop_locks(mdr.get());
+	mdr->drop_local_auth_pins();
+	p.first->add_waiter(CDir::WAIT_UNFREEZE, new C_MDS_RetryRequest(mdcache, mdr));
+	return;
+      }
+    }
+    MDSGatherBuilder gather(g_ceph_context);
+    for (auto& [dir, keys] : to_fetch) {
+      dout(10) << " fetching " << keys.size() << " names from " << *dir << dendl;
+      if (snapid == CEPH_NOSNAP)
+	dir->fetch_keys(keys, gather.new_sub());
+      else
+	dir->fetch(gather.new_sub(), true);
+    }
+    gather.set_finisher(new C_MDS_RetryRequest(mdcache, mdr));
+    gather.activate();
+    return;
+  }
+
+  utime_t now = ceph_clock_now();
+  mdr->set_mds_stamp(now);
+
+  SnapRealm *realm = diri->find_snaprealm();
+
+  // same budget as a readdir reply
+  int bytes_left = (512 << 10) + g_conf()->mds_max_xattr_pairs_size;
+  bytes_left -= sizeof(__u32) + realm->get_snap_trace().length();
+
+  bufferlist dnbl;
+  __u32 numfiles = 0;
+  for (CDentry *dn : dns) {
+    if (!dn || dn->state_test(CDentry::STATE_PURGING))
+      continue;
+
+    bool dnp = dn->use_projected(client, mdr);
+    CDentry::linkage_t *dnl = dnp ? dn->get_projected_linkage() : dn->get_linkage();
+    if (dnl->is_null())
+      continue;
+
+    CInode *in = dnl->get_inode();
+    if (in && in->ino() == CEPH_INO_CEPH)
+      continue;
+
+    if (dnl->is_remote() && !in) {
+      in = mdcache->get_inode(dnl->get_remote_ino());
+      if (in) {
+	dn->link_remote(dnl, in);
+      } else {
+	// let the client's own lookup wait for it
+	if (!dn->state_test(CDentry::STATE_BADREMOTEINO))
+	  mdcache->open_remote_dentry(dn, dnp, new C_MDSInternalNoop);
+	continue;
+      }
+    }
+    ceph_assert(in);
+
+    if ((int)(dnbl.length() + dn->get_name().length() + sizeof(__u32) + sizeof(LeaseStat)) > bytes_left) {
+      dout(10) << " ran out of room, stopping at " << dnbl.length() << " < " << bytes_left << dendl;
+      break;
+    }
+
+    unsigned start_len = dnbl.length();
+
+    dout(12) << "including    dn " << *dn << dendl;
+    encode(dn->get_name(), dnbl);
+    mds->locker->issue_client_lease(dn, in, mdr, now, dnbl);
+
+    dout(12) << "including inode " << *in << dendl;
+    int r = in->encode_inodestat(dnbl, mdr->session, realm, snapid, bytes_left - (int)dnbl.length());
+    if (r < 0) {
+      dout(10) << " ran out of room, stopping at " << start_len << " < " << bytes_left << dendl;
+      bufferlist keep;
+      keep.substr_of(dnbl, 0, start_len);
+      dnbl.swap(keep);
+      break;
+    }
+    numfiles++;
+
+    mdcache->lru.lru_touch(dn);
+    mds->balancer->hit_inode(in, META_POP_IRD);
+  }
+
+  session->touch_readdir_cap(numfiles);
+
+  bufferlist bl;
+  encode(numfiles, bl);
+  bl.claim_append(dnbl);
+
+  dout(10) << "reply to " << *req << " lookupbatch num=" << numfiles
+	   << " of " << names.size() << " bytes=" << bl.length() << dendl;
+  mdr->reply_extra_bl = bl;
+
+  mdr->tracei = diri;
+  respond_to_request(mdr, 0);
+}
+
 
 
 // ===============================================================================
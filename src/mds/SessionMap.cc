@@ -66,6 +66,17 @@ void SessionMap::register_perfcounters()
   plb.add_u64(l_mdssm_avg_load, "average_load", "Average Load");
   plb.add_u64(l_mdssm_avg_session_uptime, "avg_session_uptime",
                "Average session uptime");
+  plb.add_u64_counter(l_mdssm_save, "save",
+                      "Sessionmap saves");
+  plb.add_u64_counter(l_mdssm_save_keys, "save_keys",
+                      "Sessions written by saves");
+  plb.add_u64_counter(l_mdssm_save_skipped, "save_skipped",
+                      "Dirty sessions not written as unchanged");
+  plb.add_u64_counter(l_mdssm_save_bytes, "save_bytes",
+                      "Bytes of session data written by saves",
+                      NULL, 0, unit_t(UNIT_BYTES));
+  plb.add_time_avg(l_mdssm_save_latency, "save_latency",
+                   "Sessionmap save latency");
 
   logger = plb.create_perf_counters();
   g_ceph_context->get_perfcounters_collection()->add(logger);
@@ -360,13 +371,15 @@ void SessionMap::_load_legacy_finish(int r, bufferlist &bl)
 namespace {
 class C_IO_SM_Save : public SessionMapIOContext {
   version_t version;
+  ceph::coarse_mono_time start;
 public:
-  C_IO_SM_Save(SessionMap *cm, version_t v) : SessionMapIOContext(cm), version(v) {}
+  C_IO_SM_Save(SessionMap *cm, version_t v)
+    : SessionMapIOContext(cm), version(v), start(ceph::coarse_mono_clock::now()) {}
   void finish(int r) override {
     if (r != 0) {
       get_mds()->handle_write_error(r);
     } else {
-      sessionmap->_save_finish(version);
+      sessionmap->_save_finish(version, start);
     }
   }
   void print(ostream& out) const override {
@@ -408,6 +421,15 @@ void SessionMap::save(MDSContext *onsave, version_t needv)
     loaded_legacy = false;  // only need to truncate once.
   }
 
+  // sessions are written in ops of at most mds_sessionmap_keys_per_op
+  // keys; the header (carrying the version) goes in the last one, which
+  // the objecter keeps ordered after the others
+  C_GatherBuilder gather(g_ceph_context,
+			 new C_OnFinisher(new C_IO_SM_Save(this, version),
+					  mds->finisher));
+  const uint32_t kpo = g_conf()->mds_sessionmap_keys_per_op;
+  uint64_t keys = 0, skipped = 0, bytes = 0;
+
   dout(20) << " updating keys:" << dendl;
   map<string, bufferlist> to_set;
   for(std::set<entity_name_t>::iterator i = dirty_sessions.begin();
@@ -419,19 +441,37 @@ void SessionMap::save(MDSContext *onsave, version_t needv)
 	session->is_closing() ||
 	session->is_stale() ||
 	session->is_killing()) {
+      // Serialize V
+      bufferlist bl;
+      session->info.encode(bl, mds->mdsmap->get_up_features());
+      session->clear_dirty_completed_requests();
+
+      uint32_t crc = bl.crc32c(-1);
+      if (crc == session->get_persisted_crc()) {
+	dout(20) << "  " << name << " (unchanged)" << dendl;
+	++skipped;
+	continue;
+      }
       dout(20) << "  " << name << dendl;
+      session->set_persisted_crc(crc);
+
       // Serialize K
       CachedStackStringStream css;
       *css << name;
 
-      // Serialize V
-      bufferlist bl;
-      session->info.encode(bl, mds->mdsmap->get_up_features());
-
       // Add to RADOS op
-      to_set[std::string(css->strv())] = bl;
-
-      session->clear_dirty_completed_requests();
+      bytes += bl.length();
+      to_set[std::string(css->strv())] = std::move(bl);
+      ++keys;
+
+      if (to_set.size() >= kpo) {
+	ObjectOperation kop;
+	kop.omap_set(to_set);
+	to_set.clear();
+	mds->objecter->mutate(oid, oloc, kop, snapc,
+			      ceph::real_clock::now(), 0,
+			      gather.new_sub());
+      }
     } else {
       dout(20) << "  " << name << " (ignoring)" << dendl;
     }
@@ -459,14 +499,20 @@ void SessionMap::save(MDSContext *onsave, version_t needv)
   mds->objecter->mutate(oid, oloc, op, snapc,
 			ceph::real_clock::now(),
 			0,
-			new C_OnFinisher(new C_IO_SM_Save(this, version),
-					 mds->finisher));
+			gather.new_sub());
+  gather.activate();
+
+  logger->inc(l_mdssm_save);
+  logger->inc(l_mdssm_save_keys, keys);
+  logger->inc(l_mdssm_save_skipped, skipped);
+  logger->inc(l_mdssm_save_bytes, bytes + header_bl.length());
 }
 
-void SessionMap::_save_finish(version_t v)
+void SessionMap::_save_finish(version_t v, ceph::coarse_mono_time start)
 {
   dout(10) << "_save_finish v" << v << dendl;
   committed = v;
+  logger->tinc(l_mdssm_save_latency, ceph::coarse_mono_clock::now() - start);
 
   finish_contexts(g_ceph_context, commit_waiters[v]);
   commit_waiters.erase(v);
@@ -874,6 +920,7 @@ void SessionMap::save_if_dirty(const std::set<entity_name_t> &tgt_sessions,
     // Serialize V
     bufferlist bl;
     session->info.encode(bl, mds->mdsmap->get_up_features());
+    session->set_persisted_crc(bl.crc32c(-1));
 
     // Add to RADOS op
     to_set[css->str()] = bl;
@@ -45,6 +45,11 @@ enum {
   l_mdssm_total_load,
   l_mdssm_avg_load,
   l_mdssm_avg_session_uptime,
+  l_mdssm_save,
+  l_mdssm_save_keys,
+  l_mdssm_save_skipped,
+  l_mdssm_save_bytes,
+  l_mdssm_save_latency,
   l_mdssm_last,
 };
 
@@ -380,6 +385,11 @@ public:
     completed_requests_dirty = false;
   }
 
+  // crc of the encoding last written to the sessionmap object, so an
+  // unchanged session need not be rewritten
+  uint32_t get_persisted_crc() const { return persisted_crc; }
+  void set_persisted_crc(uint32_t crc) { persisted_crc = crc; }
+
   int check_access(CInode *in, unsigned mask, int caller_uid, int caller_gid,
 		   const std::vector<uint64_t> *gid_list, int new_uid, int new_gid);
 
@@ -489,6 +499,7 @@ private:
   // Has completed_requests been modified since the last time we
   // wrote this session out?
   bool completed_requests_dirty = false;
+  uint32_t persisted_crc = 0;
 
   unsigned num_trim_flushes_warnings = 0;
   unsigned num_trim_requests_warnings = 0;
@@ -738,7 +749,7 @@ public:
   void _load_legacy_finish(int r, ceph::buffer::list &bl);
 
   void save(MDSContext *onsave, version_t needv=0);
-  void _save_finish(version_t v);
+  void _save_finish(version_t v, ceph::coarse_mono_time start);
 
   /**
    * Advance the version, and mark this session
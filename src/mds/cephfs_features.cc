@@ -29,6 +29,8 @@ static const std::array feature_names
   "alternate_name",
   "notify_session_state",
   "op_getvxattr",
+  "cap_batch",
+  "op_lookupbatch",
 };
 static_assert(feature_names.size() == CEPHFS_FEATURE_MAX + 1);
 
@@ -45,7 +45,9 @@ namespace ceph {
 #define CEPHFS_FEATURE_ALTERNATE_NAME       15
 #define CEPHFS_FEATURE_NOTIFY_SESSION_STATE 16
 #define CEPHFS_FEATURE_OP_GETVXATTR         17
-#define CEPHFS_FEATURE_MAX                  17
+#define CEPHFS_FEATURE_CAP_BATCH            18
+#define CEPHFS_FEATURE_OP_LOOKUPBATCH       19
+#define CEPHFS_FEATURE_MAX                  19
 
 #define CEPHFS_FEATURES_ALL {		\
   0, 1, 2, 3, 4,			\
@@ -64,6 +66,8 @@ namespace ceph {
   CEPHFS_FEATURE_ALTERNATE_NAME,        \
   CEPHFS_FEATURE_NOTIFY_SESSION_STATE,  \
   CEPHFS_FEATURE_OP_GETVXATTR,          \
+  CEPHFS_FEATURE_CAP_BATCH,             \
+  CEPHFS_FEATURE_OP_LOOKUPBATCH,        \
 }
 
 #define CEPHFS_METRIC_FEATURES_ALL {		\
@@ -838,24 +838,30 @@ void dirfrag_load_vec_t::generate_test_instances(std::list<dirfrag_load_vec_t*>&
  * mds_load_t
  */
 void mds_load_t::encode(bufferlist &bl) const {
-  ENCODE_START(2, 2, bl);
+  ENCODE_START(3, 2, bl);
   encode(auth, bl);
   encode(all, bl);
   encode(req_rate, bl);
   encode(cache_hit_rate, bl);
   encode(queue_len, bl);
   encode(cpu_load_avg, bl);
+  encode(journal_rate, bl);
+  encode(cache_usage, bl);
   ENCODE_FINISH(bl);
 }
 
 void mds_load_t::decode(bufferlist::const_iterator &bl) {
-  DECODE_START_LEGACY_COMPAT_LEN(2, 2, 2, bl);
+  DECODE_START_LEGACY_COMPAT_LEN(3, 2, 2, bl);
   decode(auth, bl);
   decode(all, bl);
   decode(req_rate, bl);
   decode(cache_hit_rate, bl);
   decode(queue_len, bl);
   decode(cpu_load_avg, bl);
+  if (struct_v >= 3) {
+    decode(journal_rate, bl);
+    decode(cache_usage, bl);
+  }
   DECODE_FINISH(bl);
 }
 
@@ -865,6 +871,8 @@ void mds_load_t::dump(Formatter *f) const
   f->dump_float("cache hit rate", cache_hit_rate);
   f->dump_float("queue length", queue_len);
   f->dump_float("cpu load", cpu_load_avg);
+  f->dump_float("journal rate", journal_rate);
+  f->dump_float("cache usage", cache_usage);
   f->open_object_section("auth dirfrag");
   auth.dump(f);
   f->close_section();
@@ -955,6 +955,8 @@ struct mds_load_t {
   double queue_len = 0.0;
 
   double cpu_load_avg = 0.0;
+  double journal_rate = 0.0;  // bytes journaled per second
+  double cache_usage = 0.0;   // fraction of mds_cache_memory_limit in use
 
   double mds_load() const;  // defiend in MDBalancer.cc
   void encode(ceph::buffer::list& bl) const;
@@ -976,6 +978,8 @@ inline std::ostream& operator<<(std::ostream& out, const mds_load_t& load)
              << ", hr " << load.cache_hit_rate
              << ", qlen " << load.queue_len
 	     << ", cpu " << load.cpu_load_avg
+	     << ", journal " << load.journal_rate
+	     << ", cache " << load.cache_usage
              << ">";
 }
 
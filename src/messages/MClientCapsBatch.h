@@ -0,0 +1,87 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#ifndef CEPH_MCLIENTCAPSBATCH_H
+#define CEPH_MCLIENTCAPSBATCH_H
+
+#include <vector>
+
+#include "msg/Message.h"
+#include "MClientCaps.h"
+
+/**
+ * Several MClientCaps for the same session, sent as one message.  Each
+ * entry is encoded exactly as it would be on its own, so the receiver
+ * handles them one by one, in order.
+ */
+class MClientCapsBatch final : public SafeMessage {
+private:
+  static constexpr int HEAD_VERSION = 1;
+  static constexpr int COMPAT_VERSION = 1;
+
+public:
+  std::vector<ceph::ref_t<MClientCaps>> caps;
+
+protected:
+  MClientCapsBatch()
+    : SafeMessage{CEPH_MSG_CLIENT_CAPS_BATCH, HEAD_VERSION, COMPAT_VERSION} {}
+  MClientCapsBatch(std::vector<ceph::ref_t<MClientCaps>>&& c)
+    : SafeMessage{CEPH_MSG_CLIENT_CAPS_BATCH, HEAD_VERSION, COMPAT_VERSION},
+      caps(std::move(c)) {}
+  ~MClientCapsBatch() final {}
+
+public:
+  std::string_view get_type_name() const override { return "client_caps_batch"; }
+  void print(std::ostream& out) const override {
+    out << "client_caps_batch(" << caps.size() << " caps)";
+  }
+
+  void encode_payload(uint64_t features) override {
+    using ceph::encode;
+    encode(static_cast<uint32_t>(caps.size()), payload);
+    for (auto& m : caps) {
+      m->clear_payload();
+      m->encode_payload(features);
+      encode(static_cast<uint16_t>(m->get_header().version), payload);
+      encode(m->get_payload(), payload);
+      encode(m->get_middle(), payload);
+    }
+  }
+  void decode_payload() override {
+    using ceph::decode;
+    auto p = payload.cbegin();
+    uint32_t n;
+    decode(n, p);
+    caps.clear();
+    caps.reserve(n);
+    while (n--) {
+      auto m = ceph::make_message<MClientCaps>();
+      uint16_t version;
+      decode(version, p);
+      m->get_header().version = version;
+      ceph::buffer::list front, middle;
+      decode(front, p);
+      decode(middle, p);
+      m->set_payload(front);
+      m->set_middle(middle);
+      m->decode_payload();
+      caps.push_back(std::move(m));
+    }
+  }
+private:
+  template<class T, typename... Args>
+  friend boost::intrusive_ptr<T> ceph::make_message(Args&&... args);
+  template<class T, typename... Args>
+  friend MURef<T> crimson::make_message(Args&&... args);
+};
+
+#endif
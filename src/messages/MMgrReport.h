@@ -79,7 +79,7 @@ WRITE_CLASS_ENCODER(PerfCounterType)
 
 class MMgrReport : public Message {
 private:
-  static constexpr int HEAD_VERSION = 9;
+  static constexpr int HEAD_VERSION = 10;
   static constexpr int COMPAT_VERSION = 1;
 
 public:
@@ -115,6 +115,10 @@ public:
 
   boost::optional<MetricReportMessage> metric_report_message;
 
+  // non-empty <bucket, count> of each PERFCOUNTER_HDR_HISTOGRAM counter
+  // in packed, by path (see PerfHdrHistogram)
+  std::map<std::string, std::vector<std::pair<uint32_t, uint64_t>>> hdr_histograms;
+
   void decode_payload() override
   {
     using ceph::decode;
@@ -143,6 +147,9 @@ public:
     if (header.version >= 9) {
       decode(metric_report_message, p);
     }
+    if (header.version >= 10) {
+      decode(hdr_histograms, p);
+    }
   }
 
   void encode_payload(uint64_t features) override {
@@ -163,6 +170,7 @@ public:
       boost::optional<MetricReportMessage> empty;
       encode(empty, payload);
     }
+    encode(hdr_histograms, payload);
   }
 
   std::string_view get_type_name() const override { return "mgrreport"; }
@@ -0,0 +1,107 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#ifndef CEPH_MOSDOPBATCH_H
+#define CEPH_MOSDOPBATCH_H
+
+#include <vector>
+
+#include "msg/Message.h"
+#include "MOSDOp.h"
+
+/**
+ * Several MOSDOps from one client to one OSD, sent as one message.  Each
+ * entry is encoded exactly as it would be on its own, so the OSD splits
+ * the batch and handles the ops one by one, in order.
+ */
+class MOSDOpBatch final : public Message {
+private:
+  static constexpr int HEAD_VERSION = 1;
+  static constexpr int COMPAT_VERSION = 1;
+
+public:
+  std::vector<ceph::ref_t<MOSDOp>> ops;
+
+protected:
+  MOSDOpBatch()
+    : Message{CEPH_MSG_OSD_OP_BATCH, HEAD_VERSION, COMPAT_VERSION} {}
+  MOSDOpBatch(std::vector<ceph::ref_t<MOSDOp>>&& o)
+    : Message{CEPH_MSG_OSD_OP_BATCH, HEAD_VERSION, COMPAT_VERSION},
+      ops(std::move(o)) {}
+  ~MOSDOpBatch() final {}
+
+public:
+  std::string_view get_type_name() const override { return "osd_op_batch"; }
+  void print(std::ostream& out) const override {
+    out << "osd_op_batch(" << ops.size() << " ops)";
+  }
+
+  void encode_payload(uint64_t features) override {
+    using ceph::encode;
+    encode(static_cast<uint32_t>(ops.size()), payload);
+    for (auto& m : ops) {
+      m->clear_payload();
+      m->encode_payload(features);
+      const auto& h = m->get_header();
+      encode(static_cast<uint16_t>(h.version), payload);
+      encode(static_cast<uint64_t>(h.tid), payload);
+      encode(static_cast<uint16_t>(h.priority), payload);
+      encode(static_cast<uint16_t>(h.data_off), payload);
+      encode(m->get_payload(), payload);
+      encode(m->get_middle(), payload);
+      encode(m->get_data(), payload);
+    }
+  }
+  void decode_payload() override {
+    using ceph::decode;
+    auto p = payload.cbegin();
+    uint32_t n;
+    decode(n, p);
+    ops.clear();
+    ops.reserve(n);
+    while (n--) {
+      auto m = ceph::make_message<MOSDOp>();
+      auto& h = m->get_header();
+      h = header;
+      h.type = CEPH_MSG_OSD_OP;
+      uint16_t version, priority, data_off;
+      uint64_t tid;
+      decode(version, p);
+      decode(tid, p);
+      decode(priority, p);
+      decode(data_off, p);
+      h.version = version;
+      h.tid = tid;
+      h.priority = priority;
+      h.data_off = data_off;
+      ceph::buffer::list front, middle, data;
+      decode(front, p);
+      decode(middle, p);
+      decode(data, p);
+      h.front_len = front.length();
+      h.middle_len = middle.length();
+      h.data_len = data.length();
+      m->set_payload(front);
+      m->set_middle(middle);
+      m->set_data(data);
+      m->decode_payload();
+      ops.push_back(std::move(m));
+    }
+  }
+private:
+  template<class T, typename... Args>
+  friend boost::intrusive_ptr<T> ceph::make_message(Args&&... args);
+  template<class T, typename... Args>
+  friend MURef<T> crimson::make_message(Args&&... args);
+};
+
+#endif
@@ -24,6 +24,7 @@
 #include "mgr/DaemonHealthMetricCollector.h"
 #include "mgr/OSDPerfMetricCollector.h"
 #include "mgr/MDSPerfMetricCollector.h"
+#include "mgr/mgr_perf_counters.h"
 #include "mon/MonCommand.h"
 
 #include "messages/MMgrOpen.h"
@@ -2587,7 +2588,15 @@ void DaemonServer::send_report()
       cluster_state.with_osdmap([&](const OSDMap& osdmap) {
 	  // FIXME: no easy way to get mon features here.  this will do for
 	  // now, though, as long as we don't make a backward-incompat change.
-	  pg_map.encode_digest(osdmap, m->get_data(), CEPH_FEATURES_ALL);
+	  auto start = ceph::mono_clock::now();
+	  bool full = pg_map.encode_digest(
+	    osdmap, m->get_data(), CEPH_FEATURES_ALL,
+	    g_conf().get_val<uint64_t>("mgr_pgmap_digest_full_interval"));
+	  perfcounter->tinc(l_mgr_pgmap_digest_lat,
+			    ceph::mono_clock::now() - start);
+	  if (full) {
+	    perfcounter->inc(l_mgr_pgmap_digest_full);
+	  }
 	  dout(10) << pg_map << dendl;
 
 	  pg_map.get_health_checks(g_ceph_context, osdmap,
@@ -392,34 +392,54 @@ void DaemonPerfCounters::update(const MMgrReport& report)
     session->declared_types.erase(t);
   }
 
+  if (session != layout_session ||
+      !report.declare_types.empty() ||
+      !report.undeclare_types.empty()) {
+    rebuild_layout(session);
+  }
+
   const auto now = ceph_clock_now();
 
   // Parse packed data according to declared set of types
   auto p = report.packed.cbegin();
   DECODE_START(1, p);
-  for (const auto &t_path : session->declared_types) {
-    const auto &t = types.at(t_path);
-    auto instances_it = instances.find(t_path);
-    // Always check the instance exists, as we don't prevent yet
-    // multiple sessions from daemons with the same name, and one
-    // session clearing stats created by another on open.
-    if (instances_it == instances.end()) {
-      instances_it = instances.insert({t_path, t.type}).first;
-    }
+  for (const auto& [t, instance] : layout) {
     uint64_t val = 0;
     uint64_t avgcount = 0;
     uint64_t avgcount2 = 0;
 
     decode(val, p);
-    if (t.type & PERFCOUNTER_LONGRUNAVG) {
+    if (t->type & PERFCOUNTER_LONGRUNAVG) {
       decode(avgcount, p);
       decode(avgcount2, p);
-      instances_it->second.push_avg(now, val, avgcount);
+      instance->push_avg(now, val, avgcount);
     } else {
-      instances_it->second.push(now, val);
+      instance->push(now, val);
     }
   }
   DECODE_FINISH(p);
+
+  hdr_histograms = report.hdr_histograms;
+}
+
+void DaemonPerfCounters::rebuild_layout(const MgrSession *session)
+{
+  dout(20) << "resolving " << session->declared_types.size()
+	   << " declared types" << dendl;
+  layout.clear();
+  layout.reserve(session->declared_types.size());
+  for (const auto &t_path : session->declared_types) {
+    const auto &t = types.at(t_path);
+    // Always check the instance exists, as we don't prevent yet
+    // multiple sessions from daemons with the same name, and one
+    // session clearing stats created by another on open.
+    auto instances_it = instances.find(t_path);
+    if (instances_it == instances.end()) {
+      instances_it = instances.insert({t_path, t.type}).first;
+    }
+    layout.emplace_back(&t, &instances_it->second);
+  }
+  layout_session = session;
 }
 
 void PerfCounterInstance::push(utime_t t, uint64_t const &v)
@@ -28,6 +28,8 @@
 #include "messages/MMgrReport.h"
 #include "DaemonKey.h"
 
+struct MgrSession;
+
 namespace ceph {
   class Formatter;
 }
@@ -107,12 +109,28 @@ class DaemonPerfCounters
 
   std::map<std::string, PerfCounterInstance> instances;
 
+  // latest buckets of the PERFCOUNTER_HDR_HISTOGRAM counters, by path
+  std::map<std::string, std::vector<std::pair<uint32_t, uint64_t>>> hdr_histograms;
+
   void update(const MMgrReport& report);
 
   void clear()
   {
     instances.clear();
+    hdr_histograms.clear();
+    layout.clear();
+    layout_session = nullptr;
   }
+
+  private:
+  // The declared types of layout_session, resolved in the order their
+  // values appear in MMgrReport::packed.  Rebuilt only when the session
+  // or its declared set changes, so that a report is decoded without
+  // looking each counter up by path.
+  std::vector<std::pair<const PerfCounterType*, PerfCounterInstance*>> layout;
+  const MgrSession *layout_session = nullptr;
+
+  void rebuild_layout(const MgrSession *session);
 };
 
 // The state that we store about one daemon
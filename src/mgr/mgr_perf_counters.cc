@@ -15,6 +15,11 @@ int mgr_perf_start(CephContext *cct)
   plb.add_u64_counter(l_mgr_cache_hit, "cache_hit", "Cache hits");
   plb.add_u64_counter(l_mgr_cache_miss, "cache_miss", "Cache miss");
 
+  plb.add_time_avg(l_mgr_pgmap_digest_lat, "pgmap_digest_lat",
+                   "Time to build the PGMap digest sent to the monitors");
+  plb.add_u64_counter(l_mgr_pgmap_digest_full, "pgmap_digest_full",
+                      "PGMap digests rebuilt from scratch");
+
   perfcounter = plb.create_perf_counters();
   cct->get_perfcounters_collection()->add(perfcounter);
   return 0;
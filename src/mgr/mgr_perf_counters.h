@@ -15,6 +15,9 @@ enum {
   l_mgr_cache_hit,
   l_mgr_cache_miss,
 
+  l_mgr_pgmap_digest_lat,
+  l_mgr_pgmap_digest_full,
+
   l_mgr_last,
 };
 
@@ -584,6 +584,7 @@ bool HealthMonitor::check_member_health()
   map<string,uint64_t> extra;
   uint64_t store_size = mon.store->get_estimated_size(extra);
   ceph_assert(store_size > 0);
+  mon.logger->set(l_mon_store_bytes, store_size);
   stats.store_stats.bytes_total = store_size;
   stats.store_stats.bytes_sst = extra["sst"];
   stats.store_stats.bytes_log = extra["log"];
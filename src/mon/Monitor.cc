@@ -745,6 +745,14 @@ int Monitor::preinit()
         "ewon", PerfCountersBuilder::PRIO_INTERESTING);
     pcb.add_u64_counter(l_mon_election_lose, "election_lose", "Elections lost",
         "elst", PerfCountersBuilder::PRIO_INTERESTING);
+    pcb.add_u64_counter(l_mon_trim_versions, "trim_versions",
+        "Service states trimmed from the store");
+    pcb.add_u64_counter(l_mon_trim_range, "trim_range",
+        "Trims done with range deletes");
+    pcb.add_time_avg(l_mon_trim_lat, "trim_lat",
+        "Latency of building a trim transaction");
+    pcb.add_u64(l_mon_store_bytes, "store_bytes",
+        "Estimated size of the monitor store", NULL, 0, unit_t(UNIT_BYTES));
     logger = pcb.create_perf_counters();
     cct->get_perfcounters_collection()->add(logger);
   }
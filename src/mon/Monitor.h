@@ -96,6 +96,10 @@ enum {
   l_mon_election_call,
   l_mon_election_win,
   l_mon_election_lose,
+  l_mon_trim_versions,
+  l_mon_trim_range,
+  l_mon_trim_lat,
+  l_mon_store_bytes,
   l_mon_last,
 };
 
@@ -731,6 +731,12 @@ void OSDMonitor::update_from_paxos(bool *need_bootstrap)
 	      << mapping_job.get() << " did not complete, "
 	      << mapping_job->shards << " left, canceling" << dendl;
       mapping_job->abort();
+      // keep gathering on top of the current delta: rerunning it fixes up
+      // whatever the aborted job left half done
+    } else if (mapping.get_epoch() == osdmap.get_epoch()) {
+      mapping_delta_pgs.clear();
+      mapping_delta_pools.clear();
+      mapping_delta_valid = g_conf().get_val<bool>("mon_osd_mapping_incremental");
     }
     mapping_job.reset();
   }
@@ -788,6 +794,7 @@ void OSDMonitor::update_from_paxos(bool *need_bootstrap)
     dout(7) << __func__ << " loading latest full map e" << latest_full << dendl;
     osdmap = OSDMap();
     osdmap.decode(latest_bl);
+    mapping_delta_valid = false;
   }
 
   bufferlist bl;
@@ -828,6 +835,13 @@ void OSDMonitor::update_from_paxos(bool *need_bootstrap)
     OSDMap::Incremental inc(inc_bl);
     err = osdmap.apply_incremental(inc);
     ceph_assert(err == 0);
+    if (mapping_delta_valid &&
+	!mapping.get_affected_pgs(osdmap, inc, &mapping_delta_pgs,
+				  &mapping_delta_pools)) {
+      dout(10) << __func__ << " e" << osdmap.get_epoch()
+	       << " needs a full pg mapping update" << dendl;
+      mapping_delta_valid = false;
+    }
 
     if (!t)
       t.reset(new MonitorDBStore::Transaction);
@@ -1071,8 +1085,17 @@ void OSDMonitor::start_mapping()
   }
   if (!osdmap.get_pools().empty()) {
     auto fin = new C_UpdateCreatingPGs(this, osdmap.get_epoch());
-    mapping_job = mapping.start_update(osdmap, mapper,
-				       g_conf()->mon_osd_mapping_pgs_per_chunk);
+    if (mapping_delta_valid) {
+      dout(10) << __func__ << " remapping " << mapping_delta_pgs.size()
+	       << " pgs and " << mapping_delta_pools.size() << " pools since e"
+	       << mapping.get_epoch() << dendl;
+      mapping_job = mapping.start_update(
+	osdmap, mapper, g_conf()->mon_osd_mapping_pgs_per_chunk,
+	mapping_delta_pgs, mapping_delta_pools);
+    } else {
+      mapping_job = mapping.start_update(
+	osdmap, mapper, g_conf()->mon_osd_mapping_pgs_per_chunk);
+    }
     dout(10) << __func__ << " started mapping job " << mapping_job.get()
 	     << " at " << fin->start << dendl;
     mapping_job->set_finish_event(fin);
@@ -5417,7 +5440,8 @@ namespace {
     CSUM_TYPE, CSUM_MAX_BLOCK, CSUM_MIN_BLOCK, FINGERPRINT_ALGORITHM,
     PG_AUTOSCALE_MODE, PG_NUM_MIN, TARGET_SIZE_BYTES, TARGET_SIZE_RATIO,
     PG_AUTOSCALE_BIAS, DEDUP_TIER, DEDUP_CHUNK_ALGORITHM, 
-    DEDUP_CDC_CHUNK_SIZE, POOL_EIO, BULK, PG_NUM_MAX };
+    DEDUP_CDC_CHUNK_SIZE, POOL_EIO, BULK, PG_NUM_MAX,
+    MCLOCK_RES, MCLOCK_WGT, MCLOCK_LIM };
 
   std::set<osd_pool_get_choices>
     subtract_second_from_first(const std::set<osd_pool_get_choices>& first,
@@ -6167,7 +6191,10 @@ bool OSDMonitor::preprocess_command(MonOpRequestRef op)
       {"dedup_tier", DEDUP_TIER},
       {"dedup_chunk_algorithm", DEDUP_CHUNK_ALGORITHM},
       {"dedup_cdc_chunk_size", DEDUP_CDC_CHUNK_SIZE},
-      {"bulk", BULK}
+      {"bulk", BULK},
+      {"mclock_res", MCLOCK_RES},
+      {"mclock_wgt", MCLOCK_WGT},
+      {"mclock_lim", MCLOCK_LIM}
     };
 
     typedef std::set<osd_pool_get_choices> choices_set_t;
@@ -6306,7 +6333,7 @@ bool OSDMonitor::preprocess_command(MonOpRequestRef op)
 	    break;
 	  case HIT_SET_FPP:
 	    {
-	      if (p->hit_set_params.get_type() == HitSet::TYPE_BLOOM) {
+	      if (HitSet::is_bloom_type(p->hit_set_params.get_type())) {
 		BloomHitSet::Params *bloomp =
 		  static_cast<BloomHitSet::Params*>(p->hit_set_params.impl.get());
 		f->dump_float("hit_set_fpp", bloomp->get_fpp());
@@ -6397,6 +6424,9 @@ bool OSDMonitor::preprocess_command(MonOpRequestRef op)
 	  case DEDUP_TIER:
 	  case DEDUP_CHUNK_ALGORITHM:
 	  case DEDUP_CDC_CHUNK_SIZE:
+	  case MCLOCK_RES:
+	  case MCLOCK_WGT:
+	  case MCLOCK_LIM:
             pool_opts_t::key_t key = pool_opts_t::get_opt_desc(i->first).key;
             if (p->opts.is_set(key)) {
               if(*it == CSUM_TYPE) {
@@ -6453,7 +6483,7 @@ bool OSDMonitor::preprocess_command(MonOpRequestRef op)
 	    break;
 	  case HIT_SET_FPP:
 	    {
-	      if (p->hit_set_params.get_type() == HitSet::TYPE_BLOOM) {
+	      if (HitSet::is_bloom_type(p->hit_set_params.get_type())) {
 		BloomHitSet::Params *bloomp =
 		  static_cast<BloomHitSet::Params*>(p->hit_set_params.impl.get());
 		ss << "hit_set_fpp: " << bloomp->get_fpp() << "\n";
@@ -6560,6 +6590,9 @@ bool OSDMonitor::preprocess_command(MonOpRequestRef op)
 	  case DEDUP_TIER:
 	  case DEDUP_CHUNK_ALGORITHM:
 	  case DEDUP_CDC_CHUNK_SIZE:
+	  case MCLOCK_RES:
+	  case MCLOCK_WGT:
+	  case MCLOCK_LIM:
 	    for (i = ALL_CHOICES.begin(); i != ALL_CHOICES.end(); ++i) {
 	      if (i->second == *it)
 		break;
@@ -8605,6 +8638,14 @@ int OSDMonitor::prepare_command_pool_set(const cmdmap_t& cmdmap,
 	BloomHitSet::Params *bsp = new BloomHitSet::Params;
 	bsp->set_fpp(g_conf().get_val<double>("osd_pool_default_hit_set_bloom_fpp"));
 	p.hit_set_params = HitSet::Params(bsp);
+      } else if (val == "blocked_bloom") {
+	if (osdmap.require_osd_release < ceph_release_t::reef) {
+	  ss << "hit_set_type blocked_bloom requires require_osd_release >= reef";
+	  return -EPERM;
+	}
+	BloomHitSet::Params *bsp = new BlockedBloomHitSet::Params;
+	bsp->set_fpp(g_conf().get_val<double>("osd_pool_default_hit_set_bloom_fpp"));
+	p.hit_set_params = HitSet::Params(bsp);
       } else if (val == "explicit_hash")
 	p.hit_set_params = HitSet::Params(new ExplicitHashHitSet::Params);
       else if (val == "explicit_object")
@@ -8640,7 +8681,7 @@ int OSDMonitor::prepare_command_pool_set(const cmdmap_t& cmdmap,
       ss << "hit_set_fpp should be in the range 0..1";
       return -EINVAL;
     }
-    if (p.hit_set_params.get_type() != HitSet::TYPE_BLOOM) {
+    if (!HitSet::is_bloom_type(p.hit_set_params.get_type())) {
       ss << "hit set is not of type Bloom; invalid to set a false positive rate!";
       return -EINVAL;
     }
@@ -8911,6 +8952,16 @@ int OSDMonitor::prepare_command_pool_set(const cmdmap_t& cmdmap,
         ss << "error parsing int value '" << val << "': " << interr;
         return -EINVAL;
       }
+    } else if (var == "mclock_res" || var == "mclock_wgt" ||
+	       var == "mclock_lim") {
+      if (interr.length()) {
+        ss << "error parsing int value '" << val << "': " << interr;
+        return -EINVAL;
+      }
+      if (n < 0) {
+	ss << var << " cannot be negative";
+	return -EINVAL;
+      }
     }
 
     pool_opts_t::opt_desc_t desc = pool_opts_t::get_opt_desc(var);
@@ -13728,10 +13779,16 @@ bool OSDMonitor::prepare_command_impl(MonOpRequestRef op,
     HitSet::Params hsp;
     auto& cache_hit_set_type =
       g_conf().get_val<string>("osd_tier_default_cache_hit_set_type");
-    if (cache_hit_set_type == "bloom") {
+    if (cache_hit_set_type == "bloom" ||
+	(cache_hit_set_type == "blocked_bloom" &&
+	 osdmap.require_osd_release < ceph_release_t::reef)) {
       BloomHitSet::Params *bsp = new BloomHitSet::Params;
       bsp->set_fpp(g_conf().get_val<double>("osd_pool_default_hit_set_bloom_fpp"));
       hsp = HitSet::Params(bsp);
+    } else if (cache_hit_set_type == "blocked_bloom") {
+      BloomHitSet::Params *bsp = new BlockedBloomHitSet::Params;
+      bsp->set_fpp(g_conf().get_val<double>("osd_pool_default_hit_set_bloom_fpp"));
+      hsp = HitSet::Params(bsp);
     } else if (cache_hit_set_type == "explicit_hash") {
       hsp = HitSet::Params(new ExplicitHashHitSet::Params);
     } else if (cache_hit_set_type == "explicit_object") {
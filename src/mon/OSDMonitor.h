@@ -385,6 +385,11 @@ private:
   ParallelPGMapper mapper;                        ///< for background pg work
   OSDMapMapping mapping;                          ///< pg <-> osd mappings
   std::unique_ptr<ParallelPGMapper::Job> mapping_job;  ///< background mapping job
+  /// PGs and pools the incrementals since mapping's epoch can have moved;
+  /// only meaningful while mapping_delta_valid
+  std::set<pg_t> mapping_delta_pgs;
+  std::set<int64_t> mapping_delta_pools;
+  bool mapping_delta_valid = false;
   void start_mapping();
 
   void update_logger();
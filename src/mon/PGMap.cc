@@ -1136,7 +1136,12 @@ void PGMap::apply_incremental(CephContext *cct, const Incremental& inc)
     pool_stat_t &pool_sum_ref = pg_pool_sum[update_pool];
     if (pg_stat_iter == pg_stat.end()) {
       pg_stat.insert(make_pair(update_pg, update_stat));
+      purged_snaps_dirty.insert(update_pool);
     } else {
+      if ((pg_stat_iter->second.state == 0) != (update_stat.state == 0) ||
+	  pg_stat_iter->second.purged_snaps != update_stat.purged_snaps) {
+	purged_snaps_dirty.insert(update_pool);
+      }
       stat_pg_sub(update_pg, pg_stat_iter->second);
       pool_sum_ref.sub(pg_stat_iter->second);
       pg_stat_iter->second = update_stat;
@@ -1198,6 +1203,7 @@ void PGMap::apply_incremental(CephContext *cct, const Incremental& inc)
       }
 
       pg_stat.erase(s);
+      purged_snaps_dirty.insert(removed_pg.pool());
       if (pool_erased) {
         deleted_pools.insert(removed_pg.pool());
       }
@@ -1267,6 +1273,9 @@ void PGMap::calc_stats()
   pg_sum = pool_stat_t();
   osd_sum = osd_stat_t();
   osd_sum_by_class.clear();
+  osd_class.clear();
+  purged_snaps_dirty.clear();
+  digest_valid = false;
   num_pg_by_state.clear();
   num_pg_by_pool_state.clear();
   num_pg_by_osd.clear();
@@ -1447,13 +1456,43 @@ void PGMap::calc_purged_snaps()
   }
 }
 
+void PGMap::calc_purged_snaps(const std::set<int64_t>& pools)
+{
+  // same as above, for the given pools only
+  for (auto pool : pools) {
+    purged_snaps.erase(pool);
+  }
+  set<int64_t> unknown;
+  for (auto& i : pg_stat) {
+    auto pool = i.first.pool();
+    if (!pools.count(pool)) {
+      continue;
+    }
+    if (i.second.state == 0) {
+      unknown.insert(pool);
+      purged_snaps.erase(pool);
+      continue;
+    } else if (unknown.count(pool)) {
+      continue;
+    }
+    auto j = purged_snaps.find(pool);
+    if (j == purged_snaps.end()) {
+      purged_snaps[pool] = i.second.purged_snaps;
+    } else {
+      j->second.intersection_of(i.second.purged_snaps);
+    }
+  }
+}
+
 void PGMap::calc_osd_sum_by_class(const OSDMap& osdmap)
 {
   osd_sum_by_class.clear();
+  osd_class.clear();
   for (auto& i : osd_stat) {
     const char *class_name = osdmap.crush->get_item_class(i.first);
     if (class_name) {
       osd_sum_by_class[class_name].add(i.second);
+      osd_class[i.first] = class_name;
     }
   }
 }
@@ -1462,6 +1501,9 @@ void PGMap::stat_osd_add(int osd, const osd_stat_t &s)
 {
   num_osd++;
   osd_sum.add(s);
+  if (auto c = osd_class.find(osd); c != osd_class.end()) {
+    osd_sum_by_class[c->second].add(s);
+  }
   if (osd >= (int)osd_last_seq.size()) {
     osd_last_seq.resize(osd + 1);
   }
@@ -1472,17 +1514,35 @@ void PGMap::stat_osd_sub(int osd, const osd_stat_t &s)
 {
   num_osd--;
   osd_sum.sub(s);
+  if (auto c = osd_class.find(osd); c != osd_class.end()) {
+    osd_sum_by_class[c->second].sub(s);
+  }
   ceph_assert(osd < (int)osd_last_seq.size());
   osd_last_seq[osd] = 0;
 }
 
-void PGMap::encode_digest(const OSDMap& osdmap,
-			  bufferlist& bl, uint64_t features)
+bool PGMap::encode_digest(const OSDMap& osdmap,
+			  bufferlist& bl, uint64_t features,
+			  unsigned full_interval)
 {
   get_rules_avail(osdmap, &avail_space_by_rule);
-  calc_osd_sum_by_class(osdmap);
-  calc_purged_snaps();
+  // the device classes come from the osdmap; everything else follows
+  // from the incrementals applied since the last full pass
+  bool full = !digest_valid ||
+    digest_osdmap_epoch != osdmap.get_epoch() ||
+    ++digests_since_full >= full_interval;
+  if (full) {
+    calc_osd_sum_by_class(osdmap);
+    calc_purged_snaps();
+    digest_valid = true;
+    digest_osdmap_epoch = osdmap.get_epoch();
+    digests_since_full = 0;
+  } else if (!purged_snaps_dirty.empty()) {
+    calc_purged_snaps(purged_snaps_dirty);
+  }
+  purged_snaps_dirty.clear();
   PGMapDigest::encode(bl, features);
+  return full;
 }
 
 void PGMap::encode(bufferlist &bl, uint64_t features) const
@@ -309,6 +309,14 @@ public:
 
   utime_t stamp;
 
+  // digest state (soft state), kept current by apply_incremental between
+  // the full recomputations done by encode_digest()
+  bool digest_valid = false;
+  epoch_t digest_osdmap_epoch = 0;
+  unsigned digests_since_full = 0;
+  mempool::pgmap::unordered_map<int32_t,std::string> osd_class;
+  std::set<int64_t> purged_snaps_dirty;
+
   void update_pool_deltas(
     CephContext *cct,
     const utime_t ts,
@@ -425,6 +433,7 @@ public:
   bool stat_pg_sub(const pg_t &pgid, const pg_stat_t &s,
 		   bool sameosds=false);
   void calc_purged_snaps();
+  void calc_purged_snaps(const std::set<int64_t>& pools);
   void calc_osd_sum_by_class(const OSDMap& osdmap);
   void stat_osd_add(int osd, const osd_stat_t &s);
   void stat_osd_sub(int osd, const osd_stat_t &s);
@@ -433,8 +442,13 @@ public:
   void decode(ceph::buffer::list::const_iterator &bl);
 
   /// encode subset of our data to a PGMapDigest
-  void encode_digest(const OSDMap& osdmap,
-		     ceph::buffer::list& bl, uint64_t features);
+  ///
+  /// The digest state is rebuilt from scratch when the osdmap changed and
+  /// on every full_interval'th call, otherwise the state apply_incremental
+  /// maintained is used.  Returns true if it was rebuilt.
+  bool encode_digest(const OSDMap& osdmap,
+		     ceph::buffer::list& bl, uint64_t features,
+		     unsigned full_interval = 1);
 
   int64_t get_rule_avail(const OSDMap& osdmap, int ruleno) const;
   void get_rules_avail(const OSDMap& osdmap,
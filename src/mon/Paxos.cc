@@ -132,6 +132,7 @@ void Paxos::init_logger()
   pcb.add_u64_avg(l_paxos_share_state_bytes, "share_state_bytes", "Data in shared state", NULL, 0, unit_t(UNIT_BYTES));
   pcb.add_u64_counter(l_paxos_new_pn, "new_pn", "New proposal number queries");
   pcb.add_time_avg(l_paxos_new_pn_latency, "new_pn_latency", "New proposal number getting latency");
+  pcb.add_u64_avg(l_paxos_begin_proposals, "begin_proposals", "Service proposals merged into a begin");
   logger = pcb.create_perf_counters();
   g_ceph_context->get_perfcounters_collection()->add(logger);
 }
@@ -1317,6 +1318,10 @@ void Paxos::cancel_events()
     mon.timer.cancel_event(lease_timeout_event);
     lease_timeout_event = 0;
   }
+  if (propose_batch_event) {
+    mon.timer.cancel_event(propose_batch_event);
+    propose_batch_event = 0;
+  }
 }
 
 void Paxos::shutdown()
@@ -1547,6 +1552,7 @@ void Paxos::propose_pending()
 
   pending_proposal.reset();
 
+  logger->inc(l_paxos_begin_proposals, pending_finishers.size());
   committing_finishers.swap(pending_finishers);
   state = STATE_UPDATING;
   begin(bl);
@@ -1575,8 +1581,27 @@ bool Paxos::trigger_propose()
     dout(10) << __func__ << " plugged, not proposing now" << dendl;
     return false;
   } else if (is_active()) {
-    dout(10) << __func__ << " active, proposing now" << dendl;
-    propose_pending();
+    double window = g_conf().get_val<double>("paxos_propose_batch_window");
+    if (window <= 0) {
+      dout(10) << __func__ << " active, proposing now" << dendl;
+      propose_pending();
+      return true;
+    }
+    // the proposal is already in pending_proposal; services that trigger
+    // within the window add to the same transaction, in trigger order
+    if (!propose_batch_event) {
+      dout(10) << __func__ << " active, proposing in " << window << "s"
+	       << dendl;
+      propose_batch_event = mon.timer.add_event_after(
+	window,
+	new C_MonContext{&mon, [this](int r) {
+	    propose_batch_event = 0;
+	    if (r == -ECANCELED)
+	      return;
+	    if (!plugged && is_active() && pending_proposal)
+	      propose_pending();
+	}});
+    }
     return true;
   } else {
     dout(10) << __func__ << " not active, will propose later" << dendl;
@@ -156,6 +156,7 @@ enum {
   l_paxos_share_state_bytes,
   l_paxos_new_pn,
   l_paxos_new_pn_latency,
+  l_paxos_begin_proposals,
   l_paxos_last,
 };
 
@@ -527,6 +528,13 @@ private:
    * @}
    */
 
+  /**
+   * Callback to propose the pending transaction once the batch window
+   * (paxos_propose_batch_window) after the first trigger_propose() has
+   * passed, so proposals of other services can join the same round.
+   */
+  Context    *propose_batch_event = nullptr;
+
   // updating (paxos phase 2)
   /**
    * @defgroup Paxos_h_leader_updating Leader-specific Updating-related vars
@@ -434,17 +434,37 @@ void PaxosService::trim(MonitorDBStore::TransactionRef t,
 {
   dout(10) << __func__ << " from " << from << " to " << to << dendl;
   ceph_assert(from != to);
-
-  for (version_t v = from; v < to; ++v) {
-    dout(20) << __func__ << " " << v << dendl;
-    t->erase(get_service_name(), v);
-
-    string full_key = mon.store->combine_strings("full", v);
-    if (mon.store->exists(get_service_name(), full_key)) {
-      dout(20) << __func__ << " " << full_key << dendl;
-      t->erase(get_service_name(), full_key);
+  const auto start = ceph::coarse_mono_clock::now();
+
+  // Versions are unpadded decimal keys.  If every version still in the
+  // store has as many digits as the first one we trim, then [from, to)
+  // is also a contiguous lexicographic range: shorter keys are already
+  // gone and there are no longer ones yet.
+  const string from_key = stringify(from);
+  const string to_key = stringify(to);
+  if (g_conf().get_val<bool>("mon_trim_range_delete") &&
+      from_key.size() == to_key.size() &&
+      from_key.size() == stringify(get_last_committed()).size()) {
+    dout(20) << __func__ << " range " << from << "~" << to << dendl;
+    t->erase_range(get_service_name(), from_key, to_key);
+    t->erase_range(get_service_name(),
+		   mon.store->combine_strings("full", from),
+		   mon.store->combine_strings("full", to));
+    mon.logger->inc(l_mon_trim_range);
+  } else {
+    for (version_t v = from; v < to; ++v) {
+      dout(20) << __func__ << " " << v << dendl;
+      t->erase(get_service_name(), v);
+
+      string full_key = mon.store->combine_strings("full", v);
+      if (mon.store->exists(get_service_name(), full_key)) {
+	dout(20) << __func__ << " " << full_key << dendl;
+	t->erase(get_service_name(), full_key);
+      }
     }
   }
+  mon.logger->inc(l_mon_trim_versions, to - from);
+  mon.logger->tinc(l_mon_trim_lat, ceph::coarse_mono_clock::now() - start);
   if (g_conf()->mon_compact_on_trim) {
     dout(20) << " compacting prefix " << get_service_name() << dendl;
     t->compact_range(get_service_name(), stringify(from - 1), stringify(to));
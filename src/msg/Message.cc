@@ -68,6 +68,7 @@
 #include "messages/MOSDFull.h"
 #include "messages/MOSDPing.h"
 #include "messages/MOSDOp.h"
+#include "messages/MOSDOpBatch.h"
 #include "messages/MOSDOpReply.h"
 #include "messages/MOSDRepOp.h"
 #include "messages/MOSDRepOpReply.h"
@@ -124,6 +125,7 @@
 #include "messages/MClientReclaim.h"
 #include "messages/MClientReclaimReply.h"
 #include "messages/MClientCaps.h"
+#include "messages/MClientCapsBatch.h"
 #include "messages/MClientCapRelease.h"
 #include "messages/MClientLease.h"
 #include "messages/MClientSnap.h"
@@ -513,6 +515,9 @@ Message *decode_message(CephContext *cct,
   case CEPH_MSG_OSD_OP:
     m = make_message<MOSDOp>();
     break;
+  case CEPH_MSG_OSD_OP_BATCH:
+    m = make_message<MOSDOpBatch>();
+    break;
   case CEPH_MSG_OSD_OPREPLY:
     m = make_message<MOSDOpReply>();
     break;
@@ -680,6 +685,9 @@ Message *decode_message(CephContext *cct,
   case CEPH_MSG_CLIENT_CAPS:
     m = make_message<MClientCaps>();
     break;
+  case CEPH_MSG_CLIENT_CAPS_BATCH:
+    m = make_message<MClientCapsBatch>();
+    break;
   case CEPH_MSG_CLIENT_CAPRELEASE:
     m = make_message<MClientCapRelease>();
     break;
@@ -37,6 +37,7 @@ class MBackfillReserve;
 class MCacheExpire;
 class MClientCapRelease;
 class MClientCaps;
+class MClientCapsBatch;
 class MClientLease;
 class MClientQuota;
 class MClientReclaim;
@@ -138,6 +139,7 @@ class MOSDForceRecovery;
 class MOSDFull;
 class MOSDMap;
 class MOSDMarkMeDown;
+class MOSDOpBatch;
 class MOSDPeeringOp;
 class MOSDPGBackfill;
 class MOSDPGBackfillRemove;
@@ -149,6 +149,8 @@ int EventCenter::init(int nevent, unsigned center_id, const std::string &type)
 
   file_events.resize(nevent);
   this->nevent = nevent;
+  busy_poll_max_us = busy_poll_us =
+    cct->_conf.get_val<uint64_t>("ms_async_busy_poll_us");
 
   if (!driver->need_wakeup())
     return 0;
@@ -385,7 +387,9 @@ int EventCenter::process_time_events()
   return processed;
 }
 
-int EventCenter::process_events(unsigned timeout_microseconds,  ceph::timespan *working_dur)
+int EventCenter::process_events(unsigned timeout_microseconds,
+                                ceph::timespan *working_dur,
+                                poll_stats_t *stats)
 {
   struct timeval tv;
   int numevents;
@@ -413,7 +417,50 @@ int EventCenter::process_events(unsigned timeout_microseconds,  ceph::timespan *
 
   ldout(cct, 30) << __func__ << " wait second " << tv.tv_sec << " usec " << tv.tv_usec << dendl;
   std::vector<FiredFileEvent> fired_events;
-  numevents = driver->event_wait(fired_events, &tv);
+  numevents = 0;
+  if (blocking && busy_poll_max_us && timeout_microseconds) {
+    // spin on a non-blocking wait first: at low queue depth the wakeup
+    // through a blocking epoll_wait costs far more than the spin.
+    const auto spin_start = ceph::mono_clock::now();
+    const auto spin_end = spin_start + std::chrono::microseconds(
+      std::min(busy_poll_us, timeout_microseconds));
+    struct timeval zero_tv = {0, 0};
+    auto spin_now = spin_start;
+    while (spin_now < spin_end) {
+      numevents = driver->event_wait(fired_events, &zero_tv);
+      spin_now = ceph::mono_clock::now();
+      if (numevents != 0 || external_num_events.load()) {
+        break;
+      }
+    }
+    const bool hit = numevents > 0 || external_num_events.load();
+    if (stats) {
+      stats->busy_poll = spin_now - spin_start;
+      stats->busy_poll_hit = hit;
+    }
+    if (hit) {
+      busy_poll_us = std::min(std::max(busy_poll_us * 2, 1u),
+                              busy_poll_max_us);
+    } else {
+      // idle: back off, then block for whatever is left of the timeout
+      busy_poll_us /= 2;
+      const unsigned spun = std::chrono::duration_cast<
+        std::chrono::microseconds>(spin_now - spin_start).count();
+      const unsigned left = timeout_microseconds > spun ?
+        timeout_microseconds - spun : 0;
+      tv.tv_sec = left / 1000000;
+      tv.tv_usec = left % 1000000;
+      numevents = driver->event_wait(fired_events, &tv);
+      if (numevents > 0 && ceph::mono_clock::now() - spin_now <
+	  std::chrono::microseconds(busy_poll_max_us)) {
+        // spinning would have caught this one; spin again next time
+        busy_poll_us = std::min(std::max(busy_poll_us * 2, 1u),
+                                busy_poll_max_us);
+      }
+    }
+  } else {
+    numevents = driver->event_wait(fired_events, &tv);
+  }
   auto working_start = ceph::mono_clock::now();
   for (int event_id = 0; event_id < numevents; event_id++) {
     int rfired = 0;
@@ -449,6 +496,9 @@ int EventCenter::process_events(unsigned timeout_microseconds,  ceph::timespan *
     std::deque<EventCallbackRef> cur_process;
     cur_process.swap(external_events);
     external_num_events.store(0);
+    if (stats) {
+      stats->wakeup_lat = ceph::mono_clock::now() - external_queued;
+    }
     external_lock.unlock();
     numevents += cur_process.size();
     while (!cur_process.empty()) {
@@ -479,6 +529,9 @@ void EventCenter::dispatch_event_external(EventCallbackRef e)
     }
     external_events.push_back(e);
     num = ++external_num_events;
+    if (num == 1) {
+      external_queued = ceph::mono_clock::now();
+    }
   }
   if (num == 1 && !in_thread())
     wakeup();
@@ -179,6 +179,11 @@ class EventCenter {
   EventCallbackRef notify_handler;
   unsigned center_id;
   AssociatedCenters *global_centers = nullptr;
+  // adaptive busy-poll: spin for up to busy_poll_us before blocking in
+  // the driver; grown while events keep arriving, halved when idle
+  unsigned busy_poll_max_us = 0;
+  unsigned busy_poll_us = 0;
+  ceph::mono_clock::time_point external_queued;
 
   int process_time_events();
   FileEvent *_get_file_event(int fd) {
@@ -208,7 +213,15 @@ class EventCenter {
   uint64_t create_time_event(uint64_t milliseconds, EventCallbackRef ctxt);
   void delete_file_event(int fd, int mask);
   void delete_time_event(uint64_t id);
-  int process_events(unsigned timeout_microseconds, ceph::timespan *working_dur = nullptr);
+  /// what the last process_events() call spent waiting, for worker counters
+  struct poll_stats_t {
+    ceph::timespan busy_poll = ceph::timespan::zero(); ///< time spent spinning
+    bool busy_poll_hit = false;   ///< spinning found an event
+    ceph::timespan wakeup_lat = ceph::timespan::zero(); ///< external dispatch to run
+  };
+  int process_events(unsigned timeout_microseconds,
+                     ceph::timespan *working_dur = nullptr,
+                     poll_stats_t *stats = nullptr);
   void wakeup();
 
   // Used by external thread
@@ -21,6 +21,14 @@
 #include <errno.h>
 
 #include <algorithm>
+#include <deque>
+
+#if defined(__linux__)
+#include <linux/errqueue.h>
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY) && defined(SO_EE_ORIGIN_ZEROCOPY)
+#define HAVE_MSG_ZEROCOPY
+#endif
+#endif
 
 #include "PosixStack.h"
 
@@ -43,10 +51,78 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
   entity_addr_t sa;
   bool connected;
 
+#ifdef HAVE_MSG_ZEROCOPY
+  // MSG_ZEROCOPY send state.  The kernel numbers every successful zerocopy
+  // sendmsg() on the socket and references the user pages until it reports
+  // that id as completed on the socket error queue, so the sent buffers
+  // are parked here until then.
+  bool zerocopy = false;
+  size_t zerocopy_threshold = 0;
+  uint32_t zerocopy_next_id = 0;
+  std::deque<std::pair<uint32_t, ceph::buffer::list>> zerocopy_pending;
+
+  void maybe_enable_zerocopy(CephContext *cct) {
+    if (!cct->_conf.get_val<bool>("ms_tcp_zerocopy_send")) {
+      return;
+    }
+    int one = 1;
+    if (::setsockopt(_fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) < 0) {
+      int r = ceph_sock_errno();
+      ldout(cct, 5) << __func__ << " SO_ZEROCOPY not supported: "
+		    << cpp_strerror(r) << dendl;
+      return;
+    }
+    zerocopy = true;
+    zerocopy_threshold =
+      cct->_conf.get_val<Option::size_t>("ms_tcp_zerocopy_send_threshold");
+  }
+
+  // release buffers of zerocopy sends the kernel is done with
+  void reap_zerocopy() {
+    while (!zerocopy_pending.empty()) {
+      char control[128];
+      struct msghdr msg;
+      memset(&msg, 0, sizeof(msg));
+      msg.msg_control = control;
+      msg.msg_controllen = sizeof(control);
+      if (::recvmsg(_fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+	break;  // nothing completed yet
+      }
+      for (struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm;
+	   cm = CMSG_NXTHDR(&msg, cm)) {
+	if (!((cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+	      (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR))) {
+	  continue;
+	}
+	auto serr = reinterpret_cast<struct sock_extended_err*>(CMSG_DATA(cm));
+	if (serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+	  continue;
+	}
+	if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+	  // the kernel had to copy anyway (e.g. loopback); stop paying for
+	  // the completion tracking on this socket
+	  zerocopy = false;
+	}
+	// completions cover the id range [ee_info, ee_data] and arrive in
+	// order for TCP
+	uint32_t hi = serr->ee_data;
+	while (!zerocopy_pending.empty() &&
+	       static_cast<int32_t>(zerocopy_pending.front().first - hi) <= 0) {
+	  zerocopy_pending.pop_front();
+	}
+      }
+    }
+  }
+#endif
+
  public:
-  explicit PosixConnectedSocketImpl(ceph::NetHandler &h, const entity_addr_t &sa,
-				    int f, bool connected)
-      : handler(h), _fd(f), sa(sa), connected(connected) {}
+  explicit PosixConnectedSocketImpl(CephContext *cct, ceph::NetHandler &h,
+				    const entity_addr_t &sa, int f, bool connected)
+      : handler(h), _fd(f), sa(sa), connected(connected) {
+#ifdef HAVE_MSG_ZEROCOPY
+    maybe_enable_zerocopy(cct);
+#endif
+  }
 
   int is_connected() override {
     if (connected)
@@ -64,6 +140,9 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
   }
 
   ssize_t read(char *buf, size_t len) override {
+    #ifdef HAVE_MSG_ZEROCOPY
+    reap_zerocopy();
+    #endif
     #ifdef _WIN32
     ssize_t r = ::recv(_fd, buf, len, 0);
     #else
@@ -77,22 +156,32 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
   // return the sent length
   // < 0 means error occurred
   #ifndef _WIN32
-  static ssize_t do_sendmsg(int fd, struct msghdr &msg, unsigned len, bool more)
+  // zc_flags/zc_calls: extra sendmsg flags (MSG_ZEROCOPY) and the number
+  // of successful calls made with them
+  static ssize_t do_sendmsg(int fd, struct msghdr &msg, unsigned len, bool more,
+			    int zc_flags = 0, unsigned *zc_calls = nullptr)
   {
     size_t sent = 0;
     while (1) {
       MSGR_SIGPIPE_STOPPER;
       ssize_t r;
-      r = ::sendmsg(fd, &msg, MSG_NOSIGNAL | (more ? MSG_MORE : 0));
+      r = ::sendmsg(fd, &msg, MSG_NOSIGNAL | (more ? MSG_MORE : 0) | zc_flags);
       if (r < 0) {
         int err = ceph_sock_errno();
         if (err == EINTR) {
           continue;
         } else if (err == EAGAIN) {
           break;
+        } else if (err == ENOBUFS && zc_flags) {
+          // out of optmem for zerocopy notifications; fall back to copying
+          zc_flags = 0;
+          continue;
         }
         return -err;
       }
+      if (zc_flags && zc_calls) {
+        ++*zc_calls;
+      }
 
       sent += r;
       if (len == sent) break;
@@ -115,6 +204,12 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
 
   ssize_t send(ceph::buffer::list &bl, bool more) override {
     size_t sent_bytes = 0;
+    unsigned zc_calls = 0;
+#ifdef HAVE_MSG_ZEROCOPY
+    if (!zerocopy_pending.empty()) {
+      reap_zerocopy();
+    }
+#endif
     auto pb = std::cbegin(bl.buffers());
     uint64_t left_pbrs = bl.get_num_buffers();
     while (left_pbrs) {
@@ -133,7 +228,14 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
 	msglen += pb->length();
 	++pb;
       }
-      ssize_t r = do_sendmsg(_fd, msg, msglen, left_pbrs || more);
+      int zc_flags = 0;
+#ifdef HAVE_MSG_ZEROCOPY
+      if (zerocopy && msglen >= zerocopy_threshold) {
+        zc_flags = MSG_ZEROCOPY;
+      }
+#endif
+      ssize_t r = do_sendmsg(_fd, msg, msglen, left_pbrs || more,
+                             zc_flags, &zc_calls);
       if (r < 0)
         return r;
 
@@ -150,8 +252,15 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
         bl.splice(sent_bytes, bl.length()-sent_bytes, &swapped);
         bl.swap(swapped);
       } else {
-        bl.clear();
+        swapped.swap(bl);
+      }
+#ifdef HAVE_MSG_ZEROCOPY
+      // swapped now holds what was sent
+      if (zc_calls) {
+        zerocopy_next_id += zc_calls;
+        zerocopy_pending.emplace_back(zerocopy_next_id - 1, std::move(swapped));
       }
+#endif
     }
 
     return static_cast<ssize_t>(sent_bytes);
@@ -204,6 +313,13 @@ class PosixConnectedSocketImpl final : public ConnectedSocketImpl {
     ::shutdown(_fd, SHUT_RDWR);
   }
   void close() override {
+#ifdef HAVE_MSG_ZEROCOPY
+    // Anything still pending belongs to a connection being torn down.  The
+    // kernel keeps its own page references, and a frame altered by buffer
+    // reuse would fail the peer's crc/auth checks.
+    reap_zerocopy();
+    zerocopy_pending.clear();
+#endif
     compat_closesocket(_fd);
   }
   void set_priority(int sd, int prio, int domain) override {
@@ -262,7 +378,7 @@ int PosixServerSocketImpl::accept(ConnectedSocket *sock, const SocketOptions &op
   out->set_sockaddr((sockaddr*)&ss);
   handler.set_priority(sd, opt.priority, out->get_family());
 
-  std::unique_ptr<PosixConnectedSocketImpl> csi(new PosixConnectedSocketImpl(handler, *out, sd, true));
+  std::unique_ptr<PosixConnectedSocketImpl> csi(new PosixConnectedSocketImpl(w->cct, handler, *out, sd, true));
   *sock = ConnectedSocket(std::move(csi));
   return 0;
 }
@@ -331,7 +447,7 @@ int PosixWorker::connect(const entity_addr_t &addr, const SocketOptions &opts, C
 
   net.set_priority(sd, opts.priority, addr.get_family());
   *socket = ConnectedSocket(
-      std::unique_ptr<PosixConnectedSocketImpl>(new PosixConnectedSocketImpl(net, addr, sd, !opts.nonblock)));
+      std::unique_ptr<PosixConnectedSocketImpl>(new PosixConnectedSocketImpl(cct, net, addr, sd, !opts.nonblock)));
   return 0;
 }
 
@@ -517,7 +517,7 @@ ProtocolV2::out_queue_entry_t ProtocolV2::_get_next_outgoing() {
   return out_entry;
 }
 
-ssize_t ProtocolV2::write_message(Message *m, bool more) {
+ssize_t ProtocolV2::write_message(Message *m, bool more, uint64_t batch_bytes) {
   FUNCTRACE(cct);
   ceph_assert(connection->center->in_thread());
   m->set_seq(++out_seq);
@@ -557,6 +557,17 @@ ssize_t ProtocolV2::write_message(Message *m, bool more) {
                  << " off=" << header2.data_off
                  << dendl;
   ssize_t total_send_size = connection->outgoing_bl.length();
+  if (more && (uint64_t)total_send_size < batch_bytes) {
+    // more messages are waiting in out_queue; keep appending frames and
+    // let write_event() flush them with a single scatter-gather send.
+    ldout(cct, 20) << __func__ << " batching " << m << ", "
+                   << total_send_size << " bytes pending" << dendl;
+    connection->logger->inc(l_msgr_send_batched_messages);
+    send_batched = true;
+    m->put();
+    return 0;
+  }
+  send_batched = false;
   ssize_t rc = connection->_try_send(more);
   if (rc < 0) {
     ldout(cct, 1) << __func__ << " error sending " << m << ", "
@@ -594,6 +605,13 @@ bool ProtocolV2::append_frame(F& frame) {
 
   ldout(cct, 25) << __func__ << " assembled frame " << bl.length()
                  << " bytes " << tx_frame_asm << dendl;
+  if (tx_frame_asm.is_compressed()) {
+    const auto& comp_tx = session_compression_handlers.tx;
+    connection->logger->inc(l_msgr_send_compress_in_bytes,
+                            comp_tx->get_initial_size());
+    connection->logger->inc(l_msgr_send_compress_out_bytes,
+                            comp_tx->get_final_size());
+  }
   connection->outgoing_bl.claim_append(bl);
   return true;
 }
@@ -654,9 +672,13 @@ void ProtocolV2::write_event() {
     }
 
     auto start = ceph::mono_clock::now();
+    const uint64_t batch_bytes =
+      cct->_conf.get_val<Option::size_t>("ms_async_send_batch_bytes");
+    const auto batch_time = ceph::make_timespan(
+      cct->_conf.get_val<double>("ms_async_send_batch_max_time"));
     bool more;
     do {
-      if (connection->is_queued()) {
+      if (connection->is_queued() && !send_batched) {
 	if (r = connection->_try_send(); r!= 0) {
 	  // either fails to send or not all queued buffer is sent
 	  break;
@@ -687,7 +709,9 @@ void ProtocolV2::write_event() {
 				 out_entry.m->queue_start);
       }
 
-      r = write_message(out_entry.m, more);
+      r = write_message(out_entry.m, more,
+                        ceph::mono_clock::now() - start < batch_time ?
+                        batch_bytes : 0);
 
       connection->write_lock.lock();
       if (r == 0) {
@@ -702,9 +726,12 @@ void ProtocolV2::write_event() {
       }
     } while (can_write);
     write_in_progress = false;
+    const bool flush_batch = send_batched;
+    send_batched = false;
 
     // if r > 0 mean data still lefted, so no need _try_send.
     if (r == 0) {
+      const ssize_t queued = connection->outgoing_bl.length();
       uint64_t left = ack_left;
       if (left) {
         ldout(cct, 10) << __func__ << " try send msg ack, acked " << left
@@ -720,6 +747,15 @@ void ProtocolV2::write_event() {
       } else if (is_queued()) {
         r = connection->_try_send();
       }
+      if (flush_batch && r >= 0) {
+        // account the coalesced frames that write_message() held back
+        const auto sent_bytes = std::max<ssize_t>(
+          0, queued - (ssize_t)connection->outgoing_bl.length());
+        connection->logger->inc(l_msgr_send_bytes, sent_bytes);
+        if (session_stream_handlers.tx) {
+          connection->logger->inc(l_msgr_send_encrypted_bytes, sent_bytes);
+        }
+      }
     }
     connection->write_lock.unlock();
 
@@ -2146,6 +2182,14 @@ CtPtr ProtocolV2::send_compression_request() {
     static_cast<Compressor::CompressionMode>(
       messenger->comp_registry.get_mode(peer_type, auth_meta->is_mode_secure()));
   const auto preferred_methods = messenger->comp_registry.get_methods(peer_type);
+  if (HAVE_MSGR2_FEATURE(peer_supported_features, COMPRESSION_STREAM)) {
+    auto comp_req_frame = CompressionStreamRequestFrame::Encode(
+      comp_meta.is_compress(), preferred_methods,
+      messenger->comp_registry.get_stream_window(peer_type));
+
+    INTERCEPT(19);
+    return WRITE(comp_req_frame, "compression request", read_frame);
+  }
   auto comp_req_frame = CompressionRequestFrame::Encode(comp_meta.is_compress(), preferred_methods);
 
   INTERCEPT(19);
@@ -2158,16 +2202,34 @@ CtPtr ProtocolV2::handle_compression_done(ceph::bufferlist &payload) {
     return _fault();
   }
 
-  auto response = CompressionDoneFrame::Decode(payload);
-  ldout(cct, 10) << __func__ << " CompressionDoneFrame(is_compress=" << response.is_compress()
-		 << ", method=" << response.method() << ")" << dendl;
+  bool is_compress;
+  if (HAVE_MSGR2_FEATURE(peer_supported_features, COMPRESSION_STREAM)) {
+    auto response = CompressionStreamDoneFrame::Decode(payload);
+    ldout(cct, 10) << __func__ << " CompressionStreamDoneFrame(is_compress="
+		   << response.is_compress() << ", method=" << response.method()
+		   << ", stream_window=" << response.stream_window() << ")" << dendl;
+    is_compress = response.is_compress();
+    comp_meta.con_method = static_cast<Compressor::CompressionAlgorithm>(response.method());
+    comp_meta.con_stream_window = response.stream_window();
+  } else {
+    auto response = CompressionDoneFrame::Decode(payload);
+    ldout(cct, 10) << __func__ << " CompressionDoneFrame(is_compress=" << response.is_compress()
+		   << ", method=" << response.method() << ")" << dendl;
+    is_compress = response.is_compress();
+    comp_meta.con_method = static_cast<Compressor::CompressionAlgorithm>(response.method());
+  }
 
-  comp_meta.con_method = static_cast<Compressor::CompressionAlgorithm>(response.method());
-  if (comp_meta.is_compress() != response.is_compress()) {
+  if (comp_meta.is_compress() != is_compress) {
     comp_meta.con_mode = Compressor::COMP_NONE;
   }
   session_compression_handlers = ceph::compression::onwire::rxtx_t::create_handler_pair(
     cct, comp_meta, messenger->comp_registry.get_min_compression_size(connection->get_peer_type()));
+  if (is_compress && !session_compression_handlers.rx) {
+    lderr(cct) << __func__ << " cannot decompress with negotiated method "
+	       << Compressor::get_comp_alg_name(comp_meta.get_method())
+	       << " stream_window=" << comp_meta.get_stream_window() << dendl;
+    return _fault();
+  }
 
   return start_session_connect();
 }
@@ -2996,25 +3058,56 @@ CtPtr ProtocolV2::handle_compression_request(ceph::bufferlist &payload) {
     return _fault();
   }
 
-  auto request = CompressionRequestFrame::Decode(payload);
-  ldout(cct, 10) << __func__ << " CompressionRequestFrame(is_compress=" << request.is_compress()
-		 << ", preferred_methods=" << request.preferred_methods() << ")" << dendl;
+  const bool is_stream =
+    HAVE_MSGR2_FEATURE(peer_supported_features, COMPRESSION_STREAM);
+  bool is_compress;
+  std::vector<uint32_t> preferred_methods;
+  uint32_t peer_stream_window = 0;
+  if (is_stream) {
+    auto request = CompressionStreamRequestFrame::Decode(payload);
+    ldout(cct, 10) << __func__ << " CompressionStreamRequestFrame(is_compress="
+		   << request.is_compress()
+		   << ", preferred_methods=" << request.preferred_methods()
+		   << ", stream_window=" << request.stream_window() << ")" << dendl;
+    is_compress = request.is_compress();
+    preferred_methods = std::move(request.preferred_methods());
+    peer_stream_window = request.stream_window();
+  } else {
+    auto request = CompressionRequestFrame::Decode(payload);
+    ldout(cct, 10) << __func__ << " CompressionRequestFrame(is_compress=" << request.is_compress()
+		   << ", preferred_methods=" << request.preferred_methods() << ")" << dendl;
+    is_compress = request.is_compress();
+    preferred_methods = std::move(request.preferred_methods());
+  }
 
   const int peer_type = connection->get_peer_type();
   if (Compressor::CompressionMode mode = messenger->comp_registry.get_mode(
         peer_type, auth_meta->is_mode_secure());
-      mode != Compressor::COMP_NONE && request.is_compress()) {
-    comp_meta.con_method = messenger->comp_registry.pick_method(peer_type, request.preferred_methods());
+      mode != Compressor::COMP_NONE && is_compress) {
+    comp_meta.con_method = messenger->comp_registry.pick_method(peer_type, preferred_methods);
     ldout(cct, 10) << __func__ << " Compressor(pick_method=" 
                    << Compressor::get_comp_alg_name(comp_meta.get_method())
                    << ")" << dendl;
     if (comp_meta.con_method != Compressor::COMP_ALG_NONE) {
       comp_meta.con_mode = mode;
+      comp_meta.con_stream_window =
+	ceph::compression::onwire::rxtx_t::negotiate_stream_window(
+	  cct, comp_meta.get_method(),
+	  messenger->comp_registry.get_stream_window(peer_type),
+	  peer_stream_window);
     }
   } else {
     comp_meta.con_method = Compressor::COMP_ALG_NONE;
   }
   
+  if (is_stream) {
+    auto response = CompressionStreamDoneFrame::Encode(
+      comp_meta.is_compress(), comp_meta.get_method(),
+      comp_meta.get_stream_window());
+
+    INTERCEPT(20);
+    return WRITE(response, "compression done", finish_compression);
+  }
   auto response = CompressionDoneFrame::Encode(comp_meta.is_compress(), comp_meta.get_method());
 
   INTERCEPT(20);
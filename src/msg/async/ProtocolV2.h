@@ -121,6 +121,8 @@ private:
 
   bool keepalive;
   bool write_in_progress = false;
+  // frames appended to outgoing_bl but held back for a coalesced send
+  bool send_batched = false;
 
   CompConnectionMeta comp_meta;
   std::ostream& _conn_prefix(std::ostream *_dout);
@@ -150,7 +152,7 @@ private:
   void reset_session();
   void prepare_send_message(uint64_t features, Message *m);
   out_queue_entry_t _get_next_outgoing();
-  ssize_t write_message(Message *m, bool more);
+  ssize_t write_message(Message *m, bool more, uint64_t batch_bytes = 0);
   void handle_message_ack(uint64_t seq);
   void reset_compression();
 
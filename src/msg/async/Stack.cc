@@ -47,13 +47,22 @@ std::function<void ()> NetworkStack::add_thread(Worker* w)
         ldout(cct, 30) << __func__ << " calling event process" << dendl;
 
         ceph::timespan dur;
-        int r = w->center.process_events(EventMaxWaitUs, &dur);
+        EventCenter::poll_stats_t stats;
+        int r = w->center.process_events(EventMaxWaitUs, &dur, &stats);
         if (r < 0) {
           ldout(cct, 20) << __func__ << " process events failed: "
                          << cpp_strerror(errno) << dendl;
           // TODO do something?
         }
         w->perf_logger->tinc(l_msgr_running_total_time, dur);
+        if (stats.busy_poll != ceph::timespan::zero()) {
+          w->perf_logger->tinc(l_msgr_busy_poll_time, stats.busy_poll);
+          w->perf_logger->inc(stats.busy_poll_hit ? l_msgr_busy_poll_hits :
+                                                    l_msgr_busy_poll_misses);
+        }
+        if (stats.wakeup_lat != ceph::timespan::zero()) {
+          w->perf_logger->tinc(l_msgr_external_wakeup_lat, stats.wakeup_lat);
+        }
       }
       w->reset();
       w->destroy();
@@ -211,6 +211,16 @@ enum {
   l_msgr_recv_encrypted_bytes,
   l_msgr_send_encrypted_bytes,
 
+  l_msgr_send_batched_messages,
+
+  l_msgr_send_compress_in_bytes,
+  l_msgr_send_compress_out_bytes,
+
+  l_msgr_busy_poll_time,
+  l_msgr_busy_poll_hits,
+  l_msgr_busy_poll_misses,
+  l_msgr_external_wakeup_lat,
+
   l_msgr_last,
 };
 
@@ -256,6 +266,15 @@ class Worker {
 
     plb.add_u64_counter(l_msgr_recv_encrypted_bytes, "msgr_recv_encrypted_bytes", "Network received encrypted bytes", NULL, 0, unit_t(UNIT_BYTES));
     plb.add_u64_counter(l_msgr_send_encrypted_bytes, "msgr_send_encrypted_bytes", "Network sent encrypted bytes", NULL, 0, unit_t(UNIT_BYTES));
+    plb.add_u64_counter(l_msgr_send_batched_messages, "msgr_send_batched_messages", "Messages coalesced into a later send");
+
+    plb.add_u64_counter(l_msgr_send_compress_in_bytes, "msgr_send_compress_in_bytes", "Frame bytes before on-wire compression", NULL, 0, unit_t(UNIT_BYTES));
+    plb.add_u64_counter(l_msgr_send_compress_out_bytes, "msgr_send_compress_out_bytes", "Frame bytes after on-wire compression", NULL, 0, unit_t(UNIT_BYTES));
+
+    plb.add_time(l_msgr_busy_poll_time, "msgr_busy_poll_time", "The total time of busy-polling for events");
+    plb.add_u64_counter(l_msgr_busy_poll_hits, "msgr_busy_poll_hits", "Busy-poll rounds that found an event");
+    plb.add_u64_counter(l_msgr_busy_poll_misses, "msgr_busy_poll_misses", "Busy-poll rounds that fell back to blocking");
+    plb.add_time_avg(l_msgr_external_wakeup_lat, "msgr_external_wakeup_lat", "Latency from external event dispatch to processing");
 
     perf_logger = plb.create_perf_counters();
     cct->get_perfcounters_collection()->add(perf_logger);
@@ -8,6 +8,7 @@ struct CompConnectionMeta {
     TOPNSPC::Compressor::COMP_NONE;  // negotiated mode
   TOPNSPC::Compressor::CompressionAlgorithm con_method =
     TOPNSPC::Compressor::COMP_ALG_NONE; // negotiated method
+  uint32_t con_stream_window = 0; // negotiated history window, 0 = per frame
 
   bool is_compress() const {
     return con_mode != TOPNSPC::Compressor::COMP_NONE;
@@ -18,4 +19,7 @@ struct CompConnectionMeta {
   TOPNSPC::Compressor::CompressionMode get_mode() const {
     return con_mode;
   }
+  uint32_t get_stream_window() const {
+    return con_stream_window;
+  }
 };
@@ -17,17 +17,53 @@ rxtx_t rxtx_t::create_handler_pair(
   if (comp_meta.is_compress()) {
      CompressorRef compressor = Compressor::create(ctx, comp_meta.get_method());
     if (compressor) {
-      return {std::make_unique<RxHandler>(ctx, compressor),
+      Compressor::StreamContextRef rx_stream, tx_stream;
+      if (const auto window = comp_meta.get_stream_window(); window > 0) {
+	rx_stream = compressor->create_stream_context(window);
+	tx_stream = compressor->create_stream_context(window);
+	if (!rx_stream || !tx_stream) {
+	  // the peer will send streamed frames we cannot decode
+	  lderr(ctx) << __func__ << " " << compressor->get_type_name()
+		     << " has no streaming mode" << dendl;
+	  return {};
+	}
+      }
+      return {std::make_unique<RxHandler>(ctx, compressor,
+					  std::move(rx_stream)),
 	      std::make_unique<TxHandler>(ctx, compressor,
 					  comp_meta.get_mode(),
-					  compress_min_size)};
+					  compress_min_size,
+					  std::move(tx_stream))};
     }
   }
   return {};
 }
 
+uint32_t rxtx_t::negotiate_stream_window(
+    CephContext* ctx,
+    Compressor::CompressionAlgorithm method,
+    uint32_t our_window,
+    uint32_t peer_window)
+{
+  if (our_window == 0 || peer_window == 0) {
+    return 0;
+  }
+  CompressorRef compressor = Compressor::create(ctx, method);
+  const uint32_t window = std::min(our_window, peer_window);
+  if (!compressor || !compressor->create_stream_context(window)) {
+    ldout(ctx, 10) << __func__ << " " << Compressor::get_comp_alg_name(method)
+		   << " has no streaming mode, compressing frames independently"
+		   << dendl;
+    return 0;
+  }
+  return window;
+}
+
 std::optional<ceph::bufferlist> TxHandler::compress(const ceph::bufferlist &input)
 {
+  if (m_stream_broken) {
+    return {};
+  }
   if (m_init_onwire_size < m_min_size) {
     ldout(m_cct, 20) << __func__ 
 		     << " discovered frame that is smaller than threshold, aborting compression"
@@ -46,6 +82,19 @@ std::optional<ceph::bufferlist> TxHandler::compress(const ceph::bufferlist &inpu
     return out;
   }
 
+  if (m_stream) {
+    if (m_stream->compress(input, out)) {
+      lderr(m_cct) << __func__ << " streaming compression failed,"
+		   << " disabling compression for this connection" << dendl;
+      m_stream_broken = true;
+      return {};
+    }
+    ldout(m_cct, 20) << __func__ << " uncompressed.length()=" << input.length()
+		     << " streamed.length()=" << out.length() << dendl;
+    m_onwire_size += out.length();
+    return out;
+  }
+
   std::optional<int32_t> compressor_message;
   if (m_compressor->compress(input, out, compressor_message)) {
     return {};
@@ -68,6 +117,21 @@ std::optional<ceph::bufferlist> RxHandler::decompress(const ceph::bufferlist &in
     return out;
   }
 
+  if (m_stream) {
+    try {
+      if (m_stream->decompress(input, out)) {
+	return {};
+      }
+    } catch (const ceph::buffer::error& e) {
+      ldout(m_cct, 1) << __func__ << " malformed streamed segment: "
+		      << e.what() << dendl;
+      return {};
+    }
+    ldout(m_cct, 20) << __func__ << " streamed.length()=" << input.length()
+		     << " uncompressed.length()=" << out.length() << dendl;
+    return out;
+  }
+
   std::optional<int32_t> compressor_message;
   if (m_compressor->decompress(input, out, compressor_message)) {
     return {};
@@ -17,18 +17,26 @@ namespace ceph::compression::onwire {
 
   class Handler {
   public:
-    Handler(CephContext* const cct, CompressorRef compressor)
-      : m_cct(cct), m_compressor(compressor) {}
+    Handler(CephContext* const cct, CompressorRef compressor,
+	    Compressor::StreamContextRef stream)
+      : m_cct(cct), m_compressor(compressor), m_stream(std::move(stream)) {}
+
+    bool is_streaming() const {
+      return static_cast<bool>(m_stream);
+    }
 
   protected:
     CephContext* const m_cct;
     CompressorRef m_compressor;
+    // if set, frames share one compression history per direction
+    Compressor::StreamContextRef m_stream;
   };
 
-  class RxHandler final : private Handler {
+  class RxHandler final : public Handler {
   public:
-    RxHandler(CephContext* const cct, CompressorRef compressor)
-      : Handler(cct, compressor) {}
+    RxHandler(CephContext* const cct, CompressorRef compressor,
+	      Compressor::StreamContextRef stream = nullptr)
+      : Handler(cct, compressor, std::move(stream)) {}
     ~RxHandler() {};
 
     /**
@@ -42,10 +50,11 @@ namespace ceph::compression::onwire {
     std::optional<ceph::bufferlist> decompress(const ceph::bufferlist &input);
   };
 
-  class TxHandler final : private Handler {
+  class TxHandler final : public Handler {
   public:
-    TxHandler(CephContext* const cct, CompressorRef compressor, int mode, std::uint64_t min_size)
-      : Handler(cct, compressor),
+    TxHandler(CephContext* const cct, CompressorRef compressor, int mode, std::uint64_t min_size,
+	      Compressor::StreamContextRef stream = nullptr)
+      : Handler(cct, compressor, std::move(stream)),
 	m_min_size(min_size),
 	m_mode(static_cast<Compressor::CompressionMode>(mode))
     {}
@@ -88,16 +97,34 @@ namespace ceph::compression::onwire {
     uint64_t m_init_onwire_size;
     uint64_t m_onwire_size;
     uint64_t m_compress_potential;
+
+    // a failed streaming compression leaves the history out of sync
+    // with the peer's, so no further frame may be compressed
+    bool m_stream_broken = false;
   };
 
   struct rxtx_t {
     std::unique_ptr<RxHandler> rx;
     std::unique_ptr<TxHandler> tx;
 
+    /// both handlers stream if comp_meta carries a stream window
     static rxtx_t create_handler_pair(
       CephContext* ctx,
       const CompConnectionMeta& comp_meta,
       std::uint64_t compress_min_size);
+
+    /**
+     * Pick the streaming window for a connection.
+     *
+     * @returns the smaller of the two windows, or 0 (compress frames
+     * independently) if either side does not ask for streaming or
+     * @p method has no streaming mode
+     */
+    static uint32_t negotiate_stream_window(
+      CephContext* ctx,
+      Compressor::CompressionAlgorithm method,
+      uint32_t our_window,
+      uint32_t peer_window);
   };
 }
 
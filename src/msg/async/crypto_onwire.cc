@@ -42,8 +42,13 @@ class AES128GCM_OnWireTxHandler : public ceph::crypto::onwire::TxHandler {
   nonce_t nonce, initial_nonce;
   bool used_initial_nonce;
   bool new_nonce_format;  // 64-bit counter?
+  // fragments smaller than this are copied into the ciphertext buffer
+  // and encrypted in place with a single EVP_EncryptUpdate()
+  const std::size_t coalesce_size;
   static_assert(sizeof(nonce) == AESGCM_IV_LEN);
 
+  void encrypt_in_place(char* p, std::size_t len);
+
 public:
   AES128GCM_OnWireTxHandler(CephContext* const cct,
 			    const key_t& key,
@@ -52,7 +57,9 @@ public:
     : cct(cct),
       ectx(EVP_CIPHER_CTX_new(), EVP_CIPHER_CTX_free),
       nonce(nonce), initial_nonce(nonce), used_initial_nonce(false),
-      new_nonce_format(new_nonce_format) {
+      new_nonce_format(new_nonce_format),
+      coalesce_size(cct->_conf.get_val<Option::size_t>(
+        "ms_crypto_coalesce_size")) {
     ceph_assert_always(ectx);
     ceph_assert_always(key.size() * CHAR_BIT == 128);
 
@@ -105,6 +112,17 @@ void AES128GCM_OnWireTxHandler::reset_tx_handler(const uint32_t* first,
   }
 }
 
+void AES128GCM_OnWireTxHandler::encrypt_in_place(char* p, std::size_t len)
+{
+  int update_len = 0;
+  auto up = reinterpret_cast<unsigned char*>(p);
+  if (1 != EVP_EncryptUpdate(ectx.get(), up, &update_len, up, len)) {
+    throw std::runtime_error("EVP_EncryptUpdate failed");
+  }
+  ceph_assert_always(update_len >= 0);
+  ceph_assert(static_cast<unsigned>(update_len) == len);
+}
+
 void AES128GCM_OnWireTxHandler::authenticated_encrypt_update(
   const ceph::bufferlist& plaintext)
 {
@@ -112,7 +130,27 @@ void AES128GCM_OnWireTxHandler::authenticated_encrypt_update(
               plaintext.length());
   auto filler = buffer.append_hole(plaintext.length());
 
+  // GCM is a stream mode, so a run of small fragments can be gathered
+  // into the (contiguous) output and encrypted by one update call. This
+  // lets the library's wide AES-GCM kernels work on the whole run instead
+  // of falling back to its per-block path for every tiny fragment.
+  char* run = nullptr;
+  std::size_t run_len = 0;
   for (const auto& plainbuf : plaintext.buffers()) {
+    if (plainbuf.length() < coalesce_size) {
+      if (!run) {
+        run = filler.c_str();
+      }
+      filler.copy_in(plainbuf.length(), plainbuf.c_str());
+      run_len += plainbuf.length();
+      continue;
+    }
+    if (run) {
+      encrypt_in_place(run, run_len);
+      run = nullptr;
+      run_len = 0;
+    }
+
     int update_len = 0;
 
     if(1 != EVP_EncryptUpdate(ectx.get(),
@@ -126,6 +164,9 @@ void AES128GCM_OnWireTxHandler::authenticated_encrypt_update(
     ceph_assert(static_cast<unsigned>(update_len) == plainbuf.length());
     filler.advance(update_len);
   }
+  if (run) {
+    encrypt_in_place(run, run_len);
+  }
 
   ldout(cct, 15) << __func__
 		 << " plaintext.length()=" << plaintext.length()
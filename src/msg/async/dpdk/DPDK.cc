@@ -460,14 +460,42 @@ void DPDKDevice::set_rss_table()
   /* the final level must be always type end */
   pattern[0].type = RTE_FLOW_ITEM_TYPE_END;
 
-  /*
-   * create the action sequence.
-   * one action only,  set rss hash func to toeplitz.
-   */
   uint16_t i = 0;
   for (auto& r : _redir_table) {
     r = i++ % _num_queues;
   }
+
+  // hash2qid() mirrors the redirection table in software to pick local
+  // ports whose flows come back to the connecting worker's queue, so
+  // the NIC has to use exactly this table.  Program it directly where
+  // the PMD allows, and fall back to an RSS flow rule.
+  if (_dev_info.reta_size) {
+    std::vector<rte_eth_rss_reta_entry64> reta_conf(
+      (_dev_info.reta_size + RTE_RETA_GROUP_SIZE - 1) / RTE_RETA_GROUP_SIZE);
+    memset(reta_conf.data(), 0, reta_conf.size() * sizeof(reta_conf[0]));
+    for (size_t idx = 0; idx < _redir_table.size(); ++idx) {
+      auto& entry = reta_conf[idx / RTE_RETA_GROUP_SIZE];
+      entry.mask |= 1ULL << (idx % RTE_RETA_GROUP_SIZE);
+      entry.reta[idx % RTE_RETA_GROUP_SIZE] = _redir_table[idx];
+    }
+    int r = rte_eth_dev_rss_reta_update(_port_idx, reta_conf.data(),
+                                        _dev_info.reta_size);
+    if (r == 0) {
+      ldout(cct, 5) << __func__ << " Port " << int(_port_idx)
+                    << ": RSS table of " << _redir_table.size()
+                    << " entries spread over " << _num_queues << " queues"
+                    << dendl;
+      return;
+    }
+    ldout(cct, 1) << __func__ << " Port " << int(_port_idx)
+                  << ": RSS table update failed: " << cpp_strerror(r)
+                  << ", trying flow rule" << dendl;
+  }
+
+  /*
+   * create the action sequence.
+   * one action only,  set rss hash func to toeplitz.
+   */
   rss_conf.func = RTE_ETH_HASH_FUNCTION_TOEPLITZ;
   rss_conf.types = ETH_RSS_FRAG_IPV4 | ETH_RSS_NONFRAG_IPV4_TCP;
   rss_conf.queue_num = _num_queues;
@@ -479,12 +507,31 @@ void DPDKDevice::set_rss_table()
   action[0].conf = &rss_conf;
   action[1].type = RTE_FLOW_ACTION_TYPE_END;
 
-  if (rte_flow_validate(_port_idx, &attr, pattern, action, nullptr) == 0)
+  if (rte_flow_validate(_port_idx, &attr, pattern, action, nullptr) == 0) {
     _flow = rte_flow_create(_port_idx, &attr, pattern, action, nullptr);
-  else
-    ldout(cct, 0) << __func__ << " Port " << _port_idx
-                  << ": flow rss func configuration is unsupported"
-                  << dendl;
+    return;
+  }
+  ldout(cct, 0) << __func__ << " Port " << _port_idx
+                << ": flow rss func configuration is unsupported"
+                << dendl;
+
+  // at least steer by whatever table the NIC came up with
+  if (_dev_info.reta_size) {
+    std::vector<rte_eth_rss_reta_entry64> reta_conf(
+      (_dev_info.reta_size + RTE_RETA_GROUP_SIZE - 1) / RTE_RETA_GROUP_SIZE);
+    for (auto& entry : reta_conf) {
+      entry.mask = ~0ULL;
+    }
+    if (rte_eth_dev_rss_reta_query(_port_idx, reta_conf.data(),
+                                   _dev_info.reta_size) == 0) {
+      for (size_t idx = 0; idx < _redir_table.size(); ++idx) {
+        _redir_table[idx] =
+          reta_conf[idx / RTE_RETA_GROUP_SIZE].reta[idx % RTE_RETA_GROUP_SIZE];
+      }
+      ldout(cct, 1) << __func__ << " Port " << _port_idx
+                    << ": using the device's default RSS table" << dendl;
+    }
+  }
 }
 
 void DPDKQueuePair::configure_proxies(const std::map<unsigned, float>& cpu_weights) {
@@ -727,6 +774,20 @@ void DPDKDevice::nic_stats_dump(Formatter *f)
   f->dump_unsigned("Rx_pps", mpps_rx);
   f->dump_unsigned("Tx_pps", mpps_tx);
   f->close_section();
+
+  // per-queue counters show how evenly RSS spreads flows over workers
+  f->open_array_section("queues");
+  for (unsigned q = 0; q < std::min<unsigned>(_num_queues, RTE_ETHDEV_QUEUE_STAT_CNTRS); ++q) {
+    f->open_object_section("queue");
+    f->dump_unsigned("id", q);
+    f->dump_unsigned("in_packets", stats.q_ipackets[q]);
+    f->dump_unsigned("in_bytes", stats.q_ibytes[q]);
+    f->dump_unsigned("out_packets", stats.q_opackets[q]);
+    f->dump_unsigned("out_bytes", stats.q_obytes[q]);
+    f->dump_unsigned("errors", stats.q_errors[q]);
+    f->close_section();
+  }
+  f->close_section();
 }
 
 void DPDKDevice::nic_xstats_dump(Formatter *f)
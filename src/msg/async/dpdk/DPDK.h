@@ -888,7 +888,6 @@ class DPDKDevice {
     if (!qp._sw_reta)
       return src_cpuid;
 
-    ceph_assert(!qp._sw_reta);
     auto hash = hashfn() >> _rss_table_bits;
     auto& reta = *qp._sw_reta;
     return reta[hash % reta.size()];
@@ -100,16 +100,22 @@ void DPDKWorker::initialize()
     std::map<unsigned, float> cpu_weights;
     for (unsigned j = sdev->hw_queues_count() + i % sdev->hw_queues_count();
          j < cores; j+= sdev->hw_queues_count())
-      cpu_weights[i] = 1;
+      cpu_weights[j] = 1;
     cpu_weights[i] = cct->_conf->ms_dpdk_hw_queue_weight;
     qp->configure_proxies(cpu_weights);
     sdev->set_local_queue(i, std::move(qp));
+    ldout(cct, 1) << __func__ << " worker " << i << " on lcore "
+                  << rte_lcore_id() << " owns rx/tx queue " << i << dendl;
     std::lock_guard l{lock};
     ++queue_init_done;
     cond.notify_all();
   } else {
     // auto master = qid % sdev->hw_queues_count();
     // sdev->set_local_queue(create_proxy_net_device(master, sdev.get()));
+    lderr(cct) << __func__ << " worker " << i << " has no hardware queue: port "
+               << cct->_conf->ms_dpdk_port_id << " offers only "
+               << sdev->hw_queues_count() << " rx/tx queue pairs, reduce"
+               << " ms_async_op_threads to at most that" << dendl;
     ceph_abort();
   }
   if (i == 0) {
@@ -264,6 +270,11 @@ void DPDKStack::spawn_worker(std::function<void ()> &&func)
       break;
     }
   }
+  // ms_dpdk_coremask need not be contiguous; remember where each worker
+  // (and hence its queue) runs
+  worker_lcores.push_back(core_id);
+  ldout(cct, 5) << __func__ << " worker " << funcs.size() - 1
+                << " -> lcore " << core_id << dendl;
   void *adapted_func = static_cast<void*>(&funcs.back());
   eal.execute_on_master([adapted_func, core_id, this]() {
     int r = rte_eal_remote_launch(dpdk_thread_adaptor, adapted_func, core_id);
@@ -277,7 +288,7 @@ void DPDKStack::spawn_worker(std::function<void ()> &&func)
 void DPDKStack::join_worker(unsigned i)
 {
   eal.execute_on_master([&]() {
-    rte_eal_wait_lcore(i+1);
+    rte_eal_wait_lcore(worker_lcores[i]);
   });
   if (i+1 == get_num_worker())
     eal.stop();
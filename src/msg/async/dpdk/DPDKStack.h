@@ -251,6 +251,7 @@ class DPDKWorker : public Worker {
 using namespace dpdk;
 class DPDKStack : public NetworkStack {
   std::vector<std::function<void()> > funcs;
+  std::vector<unsigned> worker_lcores;
 
   virtual Worker* create_worker(CephContext *c, unsigned worker_id) override {
     return new DPDKWorker(c, worker_id);
@@ -260,6 +261,7 @@ class DPDKStack : public NetworkStack {
  public:
   explicit DPDKStack(CephContext *cct): NetworkStack(cct), eal(cct) {
     funcs.reserve(cct->_conf->ms_async_op_threads);
+    worker_lcores.reserve(cct->_conf->ms_async_op_threads);
   }
   virtual bool support_local_listen_table() const override { return true; }
 
@@ -307,6 +307,10 @@ public:
   uint64_t get_frame_logical_len() const;
   uint64_t get_frame_onwire_len() const;
 
+  bool is_compressed() const { 
+    return m_flags & FRAME_EARLY_DATA_COMPRESSED; 
+  }
+
   bufferlist assemble_frame(Tag tag, bufferlist segment_bls[],
                             const uint16_t segment_aligns[],
                             size_t segment_count);
@@ -332,10 +336,6 @@ private:
     return m_crypto->rx->get_extra_size_at_final();
   }
 
-  bool is_compressed() const { 
-    return m_flags & FRAME_EARLY_DATA_COMPRESSED; 
-  }
-
   void asm_compress(bufferlist segment_bls[]);
 
   bufferlist asm_crc_rev0(const preamble_block_t& preamble,
@@ -895,6 +895,43 @@ protected:
   using ControlFrame::ControlFrame;
 };
 
+// Sent in place of the compression request/done frames above when both
+// peers advertise CEPH_MSGR2_FEATURE_COMPRESSION_STREAM.  The leading
+// fields are identical; the trailing one carries the history window.
+struct CompressionStreamRequestFrame
+  : public ControlFrame<CompressionStreamRequestFrame,
+                        bool, // is compress
+                        std::vector<uint32_t>, // preferred methods
+                        uint32_t> { // stream window, 0 = per frame
+  static const Tag tag = Tag::COMPRESSION_REQUEST;
+  using ControlFrame::Encode;
+  using ControlFrame::Decode;
+
+  inline bool &is_compress() { return get_val<0>(); }
+  inline std::vector<uint32_t> &preferred_methods() { return get_val<1>(); }
+  inline uint32_t &stream_window() { return get_val<2>(); }
+
+protected:
+  using ControlFrame::ControlFrame;
+};
+
+struct CompressionStreamDoneFrame
+  : public ControlFrame<CompressionStreamDoneFrame,
+                        bool, // is compress
+                        uint32_t, // method
+                        uint32_t> { // stream window, 0 = per frame
+  static const Tag tag = Tag::COMPRESSION_DONE;
+  using ControlFrame::Encode;
+  using ControlFrame::Decode;
+
+  inline bool &is_compress() { return get_val<0>(); }
+  inline uint32_t &method() { return get_val<1>(); }
+  inline uint32_t &stream_window() { return get_val<2>(); }
+
+protected:
+  using ControlFrame::ControlFrame;
+};
+
 } // namespace ceph::msgr::v2
 
 #endif // _MSG_ASYNC_FRAMES_V2_
@@ -17,6 +17,7 @@
 #include "Infiniband.h"
 #include "common/errno.h"
 #include "common/debug.h"
+#include "include/intarith.h"
 #include "RDMAStack.h"
 #include <sys/time.h>
 #include <sys/resource.h>
@@ -693,6 +694,15 @@ Infiniband::MemoryManager::Chunk::~Chunk()
 {
 }
 
+void Infiniband::MemoryManager::Chunk::set_zero_copy(const char* buf,
+                                                    uint32_t len, ibv_mr* m)
+{
+  ceph_assert(len <= bytes);
+  zc_buffer = buf;
+  zc_mr = m;
+  offset = len;
+}
+
 uint32_t Infiniband::MemoryManager::Chunk::get_offset()
 {
   return offset;
@@ -746,6 +756,104 @@ void Infiniband::MemoryManager::Chunk::reset_write_chunk()
 {
   offset = 0;
   bound = bytes;
+  zc_buffer = nullptr;
+  zc_mr = nullptr;
+}
+
+Infiniband::MemoryRegionCache::MemoryRegionCache(CephContext *c,
+                                                 ProtectionDomain *p,
+                                                 uint64_t max_bytes)
+  : cct(c), pd(p), max_bytes(max_bytes)
+{
+}
+
+Infiniband::MemoryRegionCache::~MemoryRegionCache()
+{
+  for (auto& [start, e] : entries) {
+    ibv_dereg_mr(e.mr);
+  }
+}
+
+ibv_mr* Infiniband::MemoryRegionCache::get(const ceph::buffer::ptr& bp,
+                                           PerfCounters *logger)
+{
+  const uintptr_t addr = reinterpret_cast<uintptr_t>(bp.c_str());
+  std::lock_guard l{lock};
+  if (auto p = entries.upper_bound(addr); p != entries.begin()) {
+    --p;
+    auto& e = p->second;
+    if (addr + bp.length() <= e.end) {
+      if (e.refs++ == 0) {
+        lru.erase(e.lru_pos);
+      }
+      logger->inc(l_msgr_rdma_mr_cache_hits);
+      return e.mr;
+    }
+  }
+
+  // register the whole raw so later slices of it hit the same region
+  const uintptr_t start = p2align<uintptr_t>(
+    reinterpret_cast<uintptr_t>(bp.raw_c_str()), CEPH_PAGE_SIZE);
+  const uintptr_t end = p2roundup<uintptr_t>(
+    reinterpret_cast<uintptr_t>(bp.raw_c_str()) + bp.raw_length(),
+    CEPH_PAGE_SIZE);
+  if (auto p = entries.lower_bound(start);
+      (p != entries.end() && p->first < end) ||
+      (p != entries.begin() && std::prev(p)->second.end > start)) {
+    // overlaps a region registered for a different raw; don't stack
+    // registrations of the same pages
+    logger->inc(l_msgr_rdma_mr_cache_misses);
+    return nullptr;
+  }
+
+  auto t0 = ceph::mono_clock::now();
+  ibv_mr *mr = ibv_reg_mr(pd->pd, reinterpret_cast<void*>(start), end - start,
+                          IBV_ACCESS_LOCAL_WRITE);
+  logger->tinc(l_msgr_rdma_mr_reg_lat, ceph::mono_clock::now() - t0);
+  logger->inc(l_msgr_rdma_mr_cache_misses);
+  if (!mr) {
+    ldout(cct, 1) << __func__ << " ibv_reg_mr of " << (end - start)
+                  << " bytes failed: " << cpp_strerror(errno) << dendl;
+    return nullptr;
+  }
+  auto& e = entries[start];
+  e.end = end;
+  e.mr = mr;
+  e.pin = ceph::buffer::ptr(bp, 0, bp.length());
+  e.refs = 1;
+  by_mr[mr] = start;
+  bytes += end - start;
+  trim(logger);
+  return mr;
+}
+
+void Infiniband::MemoryRegionCache::put(ibv_mr* mr)
+{
+  std::lock_guard l{lock};
+  auto p = by_mr.find(mr);
+  ceph_assert(p != by_mr.end());
+  auto& e = entries[p->second];
+  ceph_assert(e.refs > 0);
+  if (--e.refs == 0) {
+    e.lru_pos = lru.insert(lru.end(), p->second);
+  }
+}
+
+void Infiniband::MemoryRegionCache::trim(PerfCounters *logger)
+{
+  ceph_assert(ceph_mutex_is_locked(lock));
+  while (bytes > max_bytes && !lru.empty()) {
+    auto p = entries.find(lru.front());
+    ceph_assert(p != entries.end());
+    lru.pop_front();
+    ldout(cct, 20) << __func__ << " deregister " << (p->second.end - p->first)
+                   << " bytes at 0x" << std::hex << p->first << std::dec << dendl;
+    ibv_dereg_mr(p->second.mr);
+    by_mr.erase(p->second.mr);
+    bytes -= p->second.end - p->first;
+    entries.erase(p);
+    logger->inc(l_msgr_rdma_mr_cache_evictions);
+  }
 }
 
 Infiniband::MemoryManager::Cluster::Cluster(MemoryManager& m, uint32_t s)
@@ -1107,6 +1215,10 @@ void Infiniband::init()
 
   memory_manager = new MemoryManager(cct, device, pd);
   memory_manager->create_tx_pool(cct->_conf->ms_async_rdma_buffer_size, tx_queue_len);
+  if (cct->_conf.get_val<Option::size_t>("ms_async_rdma_zero_copy_threshold")) {
+    mr_cache = new MemoryRegionCache(
+      cct, pd, cct->_conf.get_val<Option::size_t>("ms_async_rdma_mr_cache_size"));
+  }
 
   if (support_srq) {
     srq = create_shared_receive_queue(rx_queue_len, MAX_SHARED_RX_SGE_COUNT);
@@ -1121,6 +1233,7 @@ Infiniband::~Infiniband()
   if (support_srq)
     ibv_destroy_srq(srq);
   delete memory_manager;
+  delete mr_cache;
   delete pd;
   delete device_list;
 }
@@ -26,9 +26,12 @@
 
 #include <atomic>
 #include <functional>
+#include <list>
+#include <map>
 #include <string>
 #include <vector>
 
+#include "include/buffer.h"
 #include "include/common_fwd.h"
 #include "include/int_types.h"
 #include "include/page.h"
@@ -187,6 +190,12 @@ enum {
   l_msgr_rdma_rx_bytes,
   l_msgr_rdma_pending_sent_conns,
 
+  l_msgr_rdma_tx_zero_copy_bytes,
+  l_msgr_rdma_mr_cache_hits,
+  l_msgr_rdma_mr_cache_misses,
+  l_msgr_rdma_mr_cache_evictions,
+  l_msgr_rdma_mr_reg_lat,
+
   l_msgr_rdma_last,
 };
 
@@ -202,6 +211,44 @@ class Infiniband {
     ibv_pd* const pd;
   };
 
+  /**
+   * Registration cache for memory that is sent without bouncing through
+   * the tx pool. Entries are keyed by the page range of a buffer::raw and
+   * hold a reference to it, so the pages cannot be freed (and reused by
+   * another allocation) while they are registered. Idle entries are
+   * deregistered LRU-first once the cache grows past its size limit.
+   */
+  class MemoryRegionCache {
+   public:
+    MemoryRegionCache(CephContext *c, ProtectionDomain *p, uint64_t max_bytes);
+    ~MemoryRegionCache();
+
+    // find or register the memory backing bp and take a reference on
+    // the region for one in-flight send; nullptr if it can't be registered
+    ibv_mr* get(const ceph::buffer::ptr& bp, PerfCounters *logger);
+    void put(ibv_mr* mr);
+
+   private:
+    struct entry_t {
+      uintptr_t end;
+      ibv_mr* mr;
+      ceph::buffer::ptr pin;
+      unsigned refs = 0;
+      std::list<uintptr_t>::iterator lru_pos;
+    };
+
+    void trim(PerfCounters *logger);
+
+    CephContext *cct;
+    ProtectionDomain *pd;
+    const uint64_t max_bytes;
+    uint64_t bytes = 0;
+    ceph::mutex lock = ceph::make_mutex("Infiniband::MemoryRegionCache::lock");
+    std::map<uintptr_t, entry_t> entries;    // page-aligned start -> entry
+    std::map<ibv_mr*, uintptr_t> by_mr;
+    std::list<uintptr_t> lru;                // idle entries, oldest first
+  };
+
   class QueuePair;
   class MemoryManager {
    public:
@@ -222,6 +269,12 @@ class Infiniband {
       void set_qp(QueuePair *qp) { this->qp = qp; }
       void clear_qp() { set_qp(nullptr); }
       QueuePair* get_qp() { return qp; }
+      // send len bytes straight from registered user memory instead of
+      // from this chunk's buffer; the chunk only carries the tx slot
+      void set_zero_copy(const char* buf, uint32_t len, ibv_mr* m);
+      bool is_zero_copy() const { return zc_mr != nullptr; }
+      const char* get_tx_addr() const { return zc_mr ? zc_buffer : buffer; }
+      uint32_t get_tx_lkey() const { return zc_mr ? zc_mr->lkey : mr->lkey; }
 
      public:
       ibv_mr* mr;
@@ -231,6 +284,8 @@ class Infiniband {
       uint32_t offset;
       uint32_t bound;
       char* buffer; // TODO: remove buffer/refactor TX
+      const char* zc_buffer = nullptr;
+      ibv_mr* zc_mr = nullptr;
       char  data[0];
     };
 
@@ -394,6 +449,7 @@ class Infiniband {
   uint32_t max_sge = 0;
   uint8_t  ib_physical_port = 0;
   MemoryManager* memory_manager = nullptr;
+  MemoryRegionCache* mr_cache = nullptr;
   ibv_srq* srq = nullptr;             // shared receive work queue
   Device *device = NULL;
   ProtectionDomain *pd = NULL;
@@ -579,6 +635,7 @@ class Infiniband {
   uint16_t get_lid() { return device->get_lid(); }
   ibv_gid get_gid() { return device->get_gid(); }
   MemoryManager* get_memory_manager() { return memory_manager; }
+  MemoryRegionCache* get_mr_cache() { return mr_cache; }
   Device* get_device() { return device; }
   int get_async_fd() { return device->ctxt->async_fd; }
   bool is_tx_buffer(const char* c) { return memory_manager->is_tx_buffer(c);}
@@ -56,6 +56,10 @@ RDMAConnectedSocketImpl::RDMAConnectedSocketImpl(CephContext *cct, std::shared_p
     established_handler(new C_handle_connection_established(this)),
     active(false), pending(false)
 {
+  if (ib->get_mr_cache()) {
+    zero_copy_threshold =
+      cct->_conf.get_val<Option::size_t>("ms_async_rdma_zero_copy_threshold");
+  }
   if (!cct->_conf->ms_async_rdma_cm) {
     qp = ib->create_queue_pair(cct, dispatcher->get_tx_cq(), dispatcher->get_rx_cq(), IBV_QPT_RC, NULL);
     if (!qp) {
@@ -404,6 +408,45 @@ size_t RDMAConnectedSocketImpl::tx_copy_chunk(std::vector<Chunk*> &tx_buffers,
   return write_len;
 }
 
+/*
+ * Post bp without copying it into tx chunks. Each tx chunk still
+ * provides the send slot (bounding in-flight WRs and the receiver's
+ * buffer size), but its sge points at bp's registered pages.
+ * Returns the number of bytes posted, or -1 if bp could not be
+ * registered and has to be copied instead.
+ */
+ssize_t RDMAConnectedSocketImpl::tx_zero_copy(std::vector<Chunk*> &tx_buffers,
+                                              const ceph::buffer::ptr& bp)
+{
+  auto mr_cache = ib->get_mr_cache();
+  ibv_mr *mr = mr_cache->get(bp, worker->perf_logger);
+  if (!mr)
+    return -1;
+
+  auto chunk_idx = tx_buffers.size();
+  if (0 == worker->get_reged_mem(this, tx_buffers, bp.length())) {
+    ldout(cct, 1) << __func__ << " no enough buffers in worker " << worker << dendl;
+    worker->perf_logger->inc(l_msgr_rdma_tx_no_mem);
+    mr_cache->put(mr);
+    return 0;
+  }
+
+  size_t sent = 0;
+  for (; chunk_idx < tx_buffers.size(); ++chunk_idx) {
+    Chunk *chunk = tx_buffers[chunk_idx];
+    uint32_t len = std::min<size_t>(chunk->get_size(), bp.length() - sent);
+    if (sent) {
+      // every chunk holds its own reference, dropped on tx completion
+      mr = mr_cache->get(bp, worker->perf_logger);
+      ceph_assert(mr);
+    }
+    chunk->set_zero_copy(bp.c_str() + sent, len, mr);
+    sent += len;
+  }
+  worker->perf_logger->inc(l_msgr_rdma_tx_zero_copy_bytes, sent);
+  return sent;
+}
+
 ssize_t RDMAConnectedSocketImpl::submit(bool more)
 {
   if (error)
@@ -432,6 +475,25 @@ ssize_t RDMAConnectedSocketImpl::submit(bool more)
       tx_buffers.push_back(ib->get_tx_chunk_by_buffer(it->raw_c_str()));
       total_copied += it->length();
       ++copy_start;
+    } else if (zero_copy_threshold && it->length() >= zero_copy_threshold) {
+      if (wait_copy_len) {
+        size_t copied = tx_copy_chunk(tx_buffers, wait_copy_len, copy_start, it);
+        total_copied += copied;
+        if (copied < wait_copy_len)
+          goto sending;
+        wait_copy_len = 0;
+      }
+      ceph_assert(copy_start == it);
+      ssize_t sent = tx_zero_copy(tx_buffers, *it);
+      if (sent < 0) {
+        // not registrable; copy it like any other buffer
+        wait_copy_len += it->length();
+      } else {
+        total_copied += sent;
+        if ((size_t)sent < it->length())
+          goto sending;
+        ++copy_start;
+      }
     } else {
       wait_copy_len += it->length();
     }
@@ -480,9 +542,9 @@ int RDMAConnectedSocketImpl::post_work_request(std::vector<Chunk*> &tx_buffers)
   memset(isge, 0, sizeof(isge));
  
   while (current_buffer != tx_buffers.end()) {
-    isge[current_sge].addr = reinterpret_cast<uint64_t>((*current_buffer)->buffer);
+    isge[current_sge].addr = reinterpret_cast<uint64_t>((*current_buffer)->get_tx_addr());
     isge[current_sge].length = (*current_buffer)->get_offset();
-    isge[current_sge].lkey = (*current_buffer)->mr->lkey;
+    isge[current_sge].lkey = (*current_buffer)->get_tx_lkey();
     ldout(cct, 25) << __func__ << " sending buffer: " << *current_buffer << " length: " << isge[current_sge].length  << dendl;
 
     iswr[current_swr].wr_id = reinterpret_cast<uint64_t>(*current_buffer);
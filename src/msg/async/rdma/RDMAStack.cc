@@ -572,6 +572,11 @@ void RDMADispatcher::post_tx_buffer(std::vector<Chunk*> &chunks)
     return ;
 
   inflight -= chunks.size();
+  for (auto chunk : chunks) {
+    if (chunk->is_zero_copy()) {
+      ib->get_mr_cache()->put(chunk->zc_mr);
+    }
+  }
   ib->get_memory_manager()->return_tx(chunks);
   ldout(cct, 30) << __func__ << " release " << chunks.size()
                  << " chunks, inflight " << inflight << dendl;
@@ -674,6 +679,12 @@ RDMAWorker::RDMAWorker(CephContext *c, unsigned worker_id)
   plb.add_u64_counter(l_msgr_rdma_rx_bytes, "rx_bytes", "The bytes of rx chunks transmitted", NULL, 0, unit_t(UNIT_BYTES));
   plb.add_u64_counter(l_msgr_rdma_pending_sent_conns, "pending_sent_conns", "The count of pending sent conns");
 
+  plb.add_u64_counter(l_msgr_rdma_tx_zero_copy_bytes, "tx_zero_copy_bytes", "The bytes sent from registered user memory", NULL, 0, unit_t(UNIT_BYTES));
+  plb.add_u64_counter(l_msgr_rdma_mr_cache_hits, "mr_cache_hits", "Zero-copy sends that found their memory registered");
+  plb.add_u64_counter(l_msgr_rdma_mr_cache_misses, "mr_cache_misses", "Zero-copy sends that had to register memory");
+  plb.add_u64_counter(l_msgr_rdma_mr_cache_evictions, "mr_cache_evictions", "Memory regions deregistered to stay under the cache size");
+  plb.add_time_avg(l_msgr_rdma_mr_reg_lat, "mr_reg_lat", "Latency of ibv_reg_mr for zero-copy sends");
+
   perf_logger = plb.create_perf_counters();
   cct->get_perfcounters_collection()->add(perf_logger);
 }
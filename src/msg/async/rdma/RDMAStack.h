@@ -195,6 +195,8 @@ class RDMAConnectedSocketImpl : public ConnectedSocketImpl {
   bool active;// qp is active ?
   bool pending;
   int post_backlog = 0;
+  // buffers at least this long are sent from registered user memory
+  uint64_t zero_copy_threshold = 0;
 
   void notify();
   void buffer_prefetch(void);
@@ -203,6 +205,8 @@ class RDMAConnectedSocketImpl : public ConnectedSocketImpl {
   size_t tx_copy_chunk(std::vector<Chunk*> &tx_buffers, size_t req_copy_len,
       decltype(std::cbegin(pending_bl.buffers()))& start,
       const decltype(std::cbegin(pending_bl.buffers()))& end);
+  ssize_t tx_zero_copy(std::vector<Chunk*> &tx_buffers,
+                       const ceph::buffer::ptr& bp);
 
  public:
   RDMAConnectedSocketImpl(CephContext *cct, std::shared_ptr<Infiniband>& ib,
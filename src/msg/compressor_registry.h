@@ -50,6 +50,16 @@ public:
     }
   }
 
+  uint32_t get_stream_window(uint32_t peer_type) const {
+    std::scoped_lock l(lock);
+    switch (peer_type) {
+      case CEPH_ENTITY_TYPE_OSD:
+        return ms_osd_compress_stream_window;
+      default:
+        return 0;
+    }
+  }
+
   bool get_is_compress_secure() const { 
     std::scoped_lock l(lock);
     return ms_compress_secure; 
@@ -62,6 +72,7 @@ private:
   uint32_t ms_osd_compress_mode;
   bool ms_compress_secure;
   std::uint64_t ms_osd_compress_min_size;
+  uint32_t ms_osd_compress_stream_window;
   std::vector<uint32_t> ms_osd_compression_methods;
 
   void _refresh_config();
@@ -478,6 +478,30 @@ public:
      ceph::buffer::list& bl,
      uint32_t op_flags = 0) = 0;
 
+  /**
+   * read_digest -- read() that also returns the crc32c of the data
+   *
+   * Backends that verify stored per-block checksums on read may compose
+   * the digest from those instead of hashing the data a second time.
+   *
+   * @param crc [in] crc32c seed, [out] crc32c of the data read
+   * @returns number of bytes read on success, or negative error code
+   */
+  virtual int read_digest(
+    CollectionHandle &c,
+    const ghobject_t& oid,
+    uint64_t offset,
+    size_t len,
+    ceph::buffer::list& bl,
+    uint32_t *crc,
+    uint32_t op_flags = 0) {
+    int r = read(c, oid, offset, len, bl, op_flags);
+    if (r > 0) {
+      *crc = bl.crc32c(*crc);
+    }
+    return r;
+  }
+
   /**
    * fiemap -- get extent std::map of data of an object
    *
@@ -1,6 +1,7 @@
 // -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
 // vim: ts=8 sw=2 smarttab
 #include <chrono>
+#include <future>
 #include "boost/algorithm/string.hpp" 
 #include "bluestore_common.h"
 #include "BlueFS.h"
@@ -96,6 +97,9 @@ public:
 	r = admin_socket->register_command("bluefs debug_inject_read_zeros", hook,
 					   "Injects 8K zeros into next BlueFS read. Debug only.");
 	ceph_assert(r == 0);
+	r = admin_socket->register_command("bluefs mount stats", hook,
+					   "print time spent in each phase of the last bluefs mount");
+	ceph_assert(r == 0);
       }
     }
     return hook;
@@ -178,6 +182,10 @@ private:
       f->flush(out);
     } else if (command == "bluefs debug_inject_read_zeros") {
       bluefs->inject_read_zeros++;
+    } else if (command == "bluefs mount stats") {
+      f->open_object_section("bluefs_mount_stats");
+      bluefs->mount_stats.dump(f);
+      f->close_section();
     } else {
       errss << "Invalid command" << std::endl;
       return -ENOSYS;
@@ -389,6 +397,18 @@ void BlueFS::_init_logger()
                     "regular unit size",
 		     "assf",
 		    PerfCountersBuilder::PRIO_USEFUL);
+  b.add_time_avg(l_bluefs_flush_lat_wal, "flush_lat_wal",
+		 "Average latency of flushing the WAL device",
+		 NULL,
+		 PerfCountersBuilder::PRIO_USEFUL);
+  b.add_time_avg(l_bluefs_flush_lat_db, "flush_lat_db",
+		 "Average latency of flushing the DB device",
+		 NULL,
+		 PerfCountersBuilder::PRIO_USEFUL);
+  b.add_time_avg(l_bluefs_flush_lat_slow, "flush_lat_slow",
+		 "Average latency of flushing the slow device",
+		 NULL,
+		 PerfCountersBuilder::PRIO_USEFUL);
   b.add_u64(l_bluefs_read_zeros_candidate, "read_zeros_candidate",
 	    "How many times bluefs read found page with all 0s");
   b.add_u64(l_bluefs_read_zeros_errors, "read_zeros_errors",
@@ -888,16 +908,32 @@ int BlueFS::_bdev_read_random(uint8_t ndev, uint64_t off, uint64_t len,
   return bdev[ndev]->read_random(off, len, buf, buffered);
 }
 
+void BlueFS::mount_stats_t::dump(Formatter *f) const
+{
+  f->dump_float("open_super_sec", ceph::to_seconds<double>(open_super));
+  f->dump_float("replay_sec", ceph::to_seconds<double>(replay));
+  f->dump_float("replay_read_sec", ceph::to_seconds<double>(replay_read));
+  f->dump_float("init_freelist_sec", ceph::to_seconds<double>(init_freelist));
+  f->dump_float("total_sec", ceph::to_seconds<double>(total));
+  f->dump_unsigned("replay_bytes", replay_bytes);
+  f->dump_unsigned("replay_transactions", replay_transactions);
+  f->dump_unsigned("replay_prefetch", replay_prefetch);
+}
+
 int BlueFS::mount()
 {
   dout(1) << __func__ << dendl;
 
+  auto mount_start = ceph::mono_clock::now();
+  auto phase_start = mount_start;
+  mount_stats = mount_stats_t();
   _init_logger();
   int r = _open_super();
   if (r < 0) {
     derr << __func__ << " failed to open super: " << cpp_strerror(r) << dendl;
     goto out;
   }
+  mount_stats.open_super = ceph::mono_clock::now() - phase_start;
 
   // set volume selector if not provided before/outside
   if (vselector == nullptr) {
@@ -910,14 +946,17 @@ int BlueFS::mount()
 
   _init_alloc();
 
+  phase_start = ceph::mono_clock::now();
   r = _replay(false, false);
   if (r < 0) {
     derr << __func__ << " failed to replay log: " << cpp_strerror(r) << dendl;
     _stop_alloc();
     goto out;
   }
+  mount_stats.replay = ceph::mono_clock::now() - phase_start;
 
   // init freelist
+  phase_start = ceph::mono_clock::now();
   for (auto& p : nodes.file_map) {
     dout(30) << __func__ << " noting alloc for " << p.second->fnode << dendl;
     for (auto& q : p.second->fnode.extents) {
@@ -939,6 +978,7 @@ int BlueFS::mount()
     dout(1) << __func__ << " shared bdev not used"
             << dendl;
   }
+  mount_stats.init_freelist = ceph::mono_clock::now() - phase_start;
 
   // set up the log for future writes
   log.writer = _create_writer(_get_file(1));
@@ -950,6 +990,12 @@ int BlueFS::mount()
            << dendl;
   // update log size
   logger->set(l_bluefs_log_bytes, log.writer->file->fnode.size);
+  mount_stats.total = ceph::mono_clock::now() - mount_start;
+  dout(1) << __func__ << " done in " << mount_stats.total
+          << " (open_super " << mount_stats.open_super
+          << ", replay " << mount_stats.replay
+          << " of which read " << mount_stats.replay_read
+          << ", init_freelist " << mount_stats.init_freelist << ")" << dendl;
   return 0;
 
  out:
@@ -1177,10 +1223,20 @@ int BlueFS::_replay(bool noop, bool to_stdout)
     std::cout << " log_fnode " << super.log_fnode << std::endl;
   } 
 
+  // The log is consumed strictly sequentially, so read it in windows much
+  // larger than the regular file prefetch to cut the number of device
+  // round trips on a long log.
+  uint64_t replay_prefetch = std::max<uint64_t>(
+    cct->_conf->bluefs_max_prefetch,
+    cct->_conf.get_val<Option::size_t>("bluefs_replay_prefetch"));
+  replay_prefetch = round_up_to(replay_prefetch, super.block_size);
   FileReader *log_reader = new FileReader(
-    log_file, cct->_conf->bluefs_max_prefetch,
+    log_file, replay_prefetch,
     false,  // !random
     true);  // ignore eof
+  ceph::timespan read_time = ceph::timespan::zero();
+  uint64_t replayed_bytes = 0;
+  uint64_t replayed_txns = 0;
 
   bool seen_recs = false;
 
@@ -1211,11 +1267,13 @@ int BlueFS::_replay(bool noop, bool to_stdout)
     uint64_t read_pos = pos;
     bufferlist bl;
     {
+      auto read_start = ceph::mono_clock::now();
       int r = _read(log_reader, read_pos, super.block_size,
 		    &bl, NULL);
       if (r != (int)super.block_size && cct->_conf->bluefs_replay_recovery) {
 	r += _do_replay_recovery_read(log_reader, pos, read_pos + r, super.block_size - r, &bl);
       }
+      read_time += ceph::mono_clock::now() - read_start;
       assert(r == (int)super.block_size);
       read_pos += r;
     }
@@ -1267,7 +1325,9 @@ int BlueFS::_replay(bool noop, bool to_stdout)
       dout(20) << __func__ << " need 0x" << std::hex << more << std::dec
                << " more bytes" << dendl;
       bufferlist t;
+      auto read_start = ceph::mono_clock::now();
       int r = _read(log_reader, read_pos, more, &t, NULL);
+      read_time += ceph::mono_clock::now() - read_start;
       if (r < (int)more) {
 	dout(10) << __func__ << " 0x" << std::hex << pos
                  << ": stop: len is 0x" << bl.length() + more << std::dec
@@ -1308,6 +1368,8 @@ int BlueFS::_replay(bool noop, bool to_stdout)
       break;
     }
     ceph_assert(seq == t.seq);
+    replayed_bytes += bl.length();
+    ++replayed_txns;
     dout(10) << __func__ << " 0x" << std::hex << pos << std::dec
              << ": " << t << dendl;
     if (unlikely(to_stdout)) {
@@ -1671,6 +1733,14 @@ int BlueFS::_replay(bool noop, bool to_stdout)
 
   delete log_reader;
 
+  mount_stats.replay_read = read_time;
+  mount_stats.replay_bytes = replayed_bytes;
+  mount_stats.replay_transactions = replayed_txns;
+  mount_stats.replay_prefetch = replay_prefetch;
+  dout(5) << __func__ << " replayed " << replayed_txns << " transactions, 0x"
+          << std::hex << replayed_bytes << std::dec << " bytes, read time "
+          << read_time << dendl;
+
   if (!noop) {
     // verify file link counts are all >0
     for (auto& p : nodes.file_map) {
@@ -2498,7 +2568,7 @@ void BlueFS::_rewrite_log_and_layout_sync_LNF_LD(bool permit_dev_fallback,
   // Part 0.
   // Lock the log totally till the end of the procedure
   std::lock_guard ll(log.lock);
-  auto t0 = mono_clock::now();
+  auto t0 = ceph::mono_clock::now();
 
   File *log_file = log.writer->file.get();
   bluefs_fnode_t fnode_tail;
@@ -2690,7 +2760,7 @@ void BlueFS::_rewrite_log_and_layout_sync_LNF_LD(bool permit_dev_fallback,
       dirty.pending_release[r.bdev].insert(r.offset, r.length);
     }
   }
-  logger->tinc(l_bluefs_compaction_lock_lat, mono_clock::now() - t0);
+  logger->tinc(l_bluefs_compaction_lock_lat, ceph::mono_clock::now() - t0);
 }
 
 /*
@@ -2737,7 +2807,7 @@ void BlueFS::_compact_log_async_LD_LNF_D() //also locks FW for new_writer
   }
   // lock log's run-time structures for a while
   log.lock.lock();
-  auto t0 = mono_clock::now();
+  auto t0 = ceph::mono_clock::now();
 
   // Part 1.
   // Prepare current log for jumping into it.
@@ -2830,7 +2900,7 @@ void BlueFS::_compact_log_async_LD_LNF_D() //also locks FW for new_writer
   // now state is captured to compacted_meta_t,
   // current log can be used to write to,
   //ops in log will be continuation of captured state
-  logger->tinc(l_bluefs_compaction_lock_lat, mono_clock::now() - t0);
+  logger->tinc(l_bluefs_compaction_lock_lat, ceph::mono_clock::now() - t0);
   log.lock.unlock();
 
   // 2.2 Allocate the space required for the compacted meta transaction
@@ -3704,9 +3774,27 @@ void BlueFS::_flush_bdev(std::array<bool, MAX_BDEV>& dirty_bdevs)
 {
   // NOTE: this is safe to call without a lock.
   dout(20) << __func__ << dendl;
+  std::vector<unsigned> ids;
   for (unsigned i = 0; i < MAX_BDEV; i++) {
     if (dirty_bdevs[i])
-      bdev[i]->flush();
+      ids.push_back(i);
+  }
+  if (ids.size() > 1 && cct->_conf.get_val<bool>("bluefs_parallel_flush")) {
+    // the devices are independent, so wait for the slowest one
+    // rather than for their sum
+    std::vector<std::future<void>> flushes;
+    for (auto i = ids.begin(); i + 1 != ids.end(); ++i) {
+      flushes.push_back(std::async(std::launch::async,
+				   &BlueFS::_flush_bdev_one, this, *i));
+    }
+    _flush_bdev_one(ids.back());
+    for (auto& f : flushes) {
+      f.get();
+    }
+  } else {
+    for (auto i : ids) {
+      _flush_bdev_one(i);
+    }
   }
 }
 
@@ -3714,13 +3802,34 @@ void BlueFS::_flush_bdev()
 {
   // NOTE: this is safe to call without a lock.
   dout(20) << __func__ << dendl;
+  std::array<bool, MAX_BDEV> devs;
   for (unsigned i = 0; i < MAX_BDEV; i++) {
     // alloc space from BDEV_SLOW is unexpected.
     // So most cases we don't alloc from BDEV_SLOW and so avoiding flush not-used device.
-    if (bdev[i] && (i != BDEV_SLOW || _get_used(i))) {
-      bdev[i]->flush();
-    }
+    devs[i] = bdev[i] && (i != BDEV_SLOW || _get_used(i));
+  }
+  _flush_bdev(devs);
+}
+
+void BlueFS::_flush_bdev_one(unsigned id)
+{
+  auto start = ceph::mono_clock::now();
+  bdev[id]->flush();
+  int counter;
+  switch (id) {
+  case BDEV_WAL:
+  case BDEV_NEWWAL:
+    counter = l_bluefs_flush_lat_wal;
+    break;
+  case BDEV_DB:
+  case BDEV_NEWDB:
+    counter = l_bluefs_flush_lat_db;
+    break;
+  default:
+    counter = l_bluefs_flush_lat_slow;
+    break;
   }
+  logger->tinc(counter, ceph::mono_clock::now() - start);
 }
 
 const char* BlueFS::get_device_name(unsigned id)
@@ -3912,13 +4021,13 @@ void BlueFS::_maybe_compact_log_LNF_NF_LD_D()
 {
   if (!cct->_conf->bluefs_replay_recovery_disable_compact &&
       _should_start_compact_log_L_N()) {
-    auto t0 = mono_clock::now();
+    auto t0 = ceph::mono_clock::now();
     if (cct->_conf->bluefs_compact_log_sync) {
       _compact_log_sync_LNF_LD();
     } else {
       _compact_log_async_LD_LNF_D();
     }
-    logger->tinc(l_bluefs_compaction_lat, mono_clock::now() - t0);
+    logger->tinc(l_bluefs_compaction_lat, ceph::mono_clock::now() - t0);
   }
 }
 
@@ -4016,6 +4125,13 @@ int BlueFS::open_for_write(
     if (logger) {
       logger->inc(l_bluefs_files_written_sst);
     }
+    // flush and compaction output; nothing waits on it but rocksdb
+    // background threads
+    for (auto ioc : (*h)->iocv) {
+      if (ioc) {
+	ioc->io_class = IOContext::IO_CLASS_BACKGROUND;
+      }
+    }
   }
 
   dout(10) << __func__ << " h " << *h << " on " << file->fnode << dendl;
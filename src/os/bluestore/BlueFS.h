@@ -67,6 +67,9 @@ enum {
   l_bluefs_alloc_shared_size_fallbacks,
   l_bluefs_read_zeros_candidate,
   l_bluefs_read_zeros_errors,
+  l_bluefs_flush_lat_wal,
+  l_bluefs_flush_lat_db,
+  l_bluefs_flush_lat_slow,
   l_bluefs_last,
 };
 
@@ -406,6 +409,19 @@ private:
   // used to trigger zeros into read (debug / verify)
   std::atomic<uint64_t> inject_read_zeros{0};
 
+  // wall-clock breakdown of the last mount(), reported via 'bluefs mount stats'
+  struct mount_stats_t {
+    ceph::timespan open_super = ceph::timespan::zero();
+    ceph::timespan replay = ceph::timespan::zero();
+    ceph::timespan replay_read = ceph::timespan::zero();
+    ceph::timespan init_freelist = ceph::timespan::zero();
+    ceph::timespan total = ceph::timespan::zero();
+    uint64_t replay_bytes = 0;
+    uint64_t replay_transactions = 0;
+    uint64_t replay_prefetch = 0;
+    void dump(ceph::Formatter *f) const;
+  } mount_stats;
+
   void _init_logger();
   void _shutdown_logger();
   void _update_logger_stats();
@@ -492,6 +508,7 @@ private:
   void _flush_bdev(FileWriter *h, bool check_mutex_locked = true);
   void _flush_bdev();  // this is safe to call without a lock
   void _flush_bdev(std::array<bool, MAX_BDEV>& dirty_bdevs);  // this is safe to call without a lock
+  void _flush_bdev_one(unsigned id);
 
   int _preallocate(FileRef f, uint64_t off, uint64_t len);
   int _truncate(FileWriter *h, uint64_t off);
@@ -41,6 +41,7 @@
 #include "common/PriorityCache.h"
 #include "common/url_escape.h"
 #include "Allocator.h"
+#include "CachingAllocator.h"
 #include "FreelistManager.h"
 #include "BlueFS.h"
 #include "BlueRocksEnv.h"
@@ -132,6 +133,7 @@ const string PREFIX_DEFERRED = "L";    // id -> deferred_transaction_t
 const string PREFIX_ALLOC = "B";       // u64 offset -> u64 length (freelist)
 const string PREFIX_ALLOC_BITMAP = "b";// (see BitmapFreelistManager)
 const string PREFIX_SHARED_BLOB = "X"; // u64 SB id -> shared_blob_t
+const string PREFIX_ALLOC_JOURNAL = "J"; // u64 seq -> alloc_journal_entry_t
 
 #ifdef HAVE_LIBZBD
 const string PREFIX_ZONED_FM_META = "Z";  // (see ZonedFreelistManager)
@@ -561,6 +563,11 @@ static void get_deferred_key(uint64_t seq, string *out)
   _key_encode_u64(seq, out);
 }
 
+static void get_alloc_journal_key(uint64_t seq, string *out)
+{
+  _key_encode_u64(seq, out);
+}
+
 static void get_pool_stat_key(int64_t pool_id, string *key)
 {
   key->clear();
@@ -1152,13 +1159,19 @@ struct LruOnodeCacheShard : public BlueStore::OnodeCacheShard {
 	  dout(20) << __func__ << " " << this << " " << o->oid << " unpinned"
                    << dendl;
         } else {
-	  ceph_assert(num);
-	  --num;
-	  o->clear_cached();
-	  dout(20) << __func__ << " " << this << " " << o->oid << " removed"
-                   << dendl;
-          // remove will also decrement nref
-          o->c->onode_space._remove(o->oid);
+          auto& os = o->c->onode_space;
+          std::lock_guard ml(os.map_lock);
+          // recheck under map_lock: a lockless lookup might have
+          // pinned the onode since we were called
+          if (o->pin_nref == 1) {
+	    ceph_assert(num);
+	    --num;
+	    o->clear_cached();
+	    dout(20) << __func__ << " " << this << " " << o->oid << " removed"
+                     << dendl;
+            // remove will also decrement nref
+            os._remove(o->oid);
+          }
         }
       } else if (o->exists) {
         // move onode within LRU
@@ -1193,13 +1206,15 @@ struct LruOnodeCacheShard : public BlueStore::OnodeCacheShard {
                << o->nref << " " << o->cached << dendl;
 
       *(o->cache_age_bin) -= 1;
+      auto& os = o->c->onode_space;
+      std::lock_guard ml(os.map_lock);
       if (o->pin_nref > 1) {
         dout(20) << __func__ << " " << this << " " << " " << " " << o->oid << dendl;
       } else {
 	ceph_assert(num);
         --num;
         o->clear_cached();
-        o->c->onode_space._remove(o->oid);
+        os._remove(o->oid);
       }
     }
   }
@@ -1940,7 +1955,12 @@ void BlueStore::BufferSpace::split(BufferCacheShard* cache, size_t pos, BlueStor
 BlueStore::OnodeRef BlueStore::OnodeSpace::add_onode(const ghobject_t& oid,
   OnodeRef& o)
 {
-  std::lock_guard l(cache->lock);
+  if (!cache->lock.try_lock()) {
+    cache->logger->inc(l_bluestore_onode_cache_lock_contended);
+    cache->lock.lock();
+  }
+  std::lock_guard l(cache->lock, std::adopt_lock);
+  std::unique_lock ml(map_lock);
   // add entry or return existing one
   auto p = onode_map.emplace(oid, o);
   if (!p.second) {
@@ -1951,6 +1971,8 @@ BlueStore::OnodeRef BlueStore::OnodeSpace::add_onode(const ghobject_t& oid,
   }
   ldout(cache->cct, 20) << __func__ << " " << oid << " " << o << dendl;
   cache->_add(o.get(), 1);
+  // trimming takes map_lock itself
+  ml.unlock();
   cache->_trim();
   return o;
 }
@@ -1966,8 +1988,7 @@ BlueStore::OnodeRef BlueStore::OnodeSpace::lookup(const ghobject_t& oid)
   ldout(cache->cct, 30) << __func__ << dendl;
   OnodeRef o;
 
-  {
-    std::lock_guard l(cache->lock);
+  auto do_lookup = [&]() {
     ceph::unordered_map<ghobject_t,OnodeRef>::iterator p = onode_map.find(oid);
     if (p == onode_map.end()) {
       ldout(cache->cct, 30) << __func__ << " " << oid << " miss" << dendl;
@@ -1983,6 +2004,21 @@ BlueStore::OnodeRef BlueStore::OnodeSpace::lookup(const ghobject_t& oid)
 
       cache->logger->inc(l_bluestore_onode_hits);
     }
+  };
+
+  if (cache->cct->_conf->bluestore_onode_cache_lockless_lookup) {
+    // Readers only exclude concurrent map updates; LRU maintenance is
+    // deferred to maybe_unpin() when the returned ref is dropped.
+    std::shared_lock ml(map_lock);
+    do_lookup();
+    cache->logger->inc(l_bluestore_onode_lockless_lookups);
+  } else {
+    if (!cache->lock.try_lock()) {
+      cache->logger->inc(l_bluestore_onode_cache_lock_contended);
+      cache->lock.lock();
+    }
+    std::lock_guard l(cache->lock, std::adopt_lock);
+    do_lookup();
   }
 
   return o;
@@ -1991,6 +2027,7 @@ BlueStore::OnodeRef BlueStore::OnodeSpace::lookup(const ghobject_t& oid)
 void BlueStore::OnodeSpace::clear()
 {
   std::lock_guard l(cache->lock);
+  std::lock_guard ml(map_lock);
   ldout(cache->cct, 10) << __func__ << " " << onode_map.size()<< dendl;
   for (auto &p : onode_map) {
     cache->_rm(p.second.get());
@@ -2000,7 +2037,7 @@ void BlueStore::OnodeSpace::clear()
 
 bool BlueStore::OnodeSpace::empty()
 {
-  std::lock_guard l(cache->lock);
+  std::shared_lock ml(map_lock);
   return onode_map.empty();
 }
 
@@ -2010,7 +2047,10 @@ void BlueStore::OnodeSpace::rename(
   const ghobject_t& new_oid,
   const mempool::bluestore_cache_meta::string& new_okey)
 {
+  // released only after map_lock is dropped, see OnodeSpace::map_lock
+  OnodeRef removed;
   std::lock_guard l(cache->lock);
+  std::unique_lock ml(map_lock);
   ldout(cache->cct, 30) << __func__ << " " << old_oid << " -> " << new_oid
 			<< dendl;
   ceph::unordered_map<ghobject_t,OnodeRef>::iterator po, pn;
@@ -2023,6 +2063,7 @@ void BlueStore::OnodeSpace::rename(
     ldout(cache->cct, 30) << __func__ << "  removing target " << pn->second
 			  << dendl;
     cache->_rm(pn->second.get());
+    removed = std::move(pn->second);
     onode_map.erase(pn);
   }
   OnodeRef o = po->second;
@@ -2038,6 +2079,7 @@ void BlueStore::OnodeSpace::rename(
 
   o->oid = new_oid;
   o->key = new_okey;
+  ml.unlock();
   cache->_trim();
 }
 
@@ -4126,27 +4168,44 @@ void BlueStore::Collection::split_cache(
   auto *ocache = get_onode_cache();
   auto *ocache_dest = dest->get_onode_cache();
 
+  // declared ahead of the locks so evicted onodes are released after them
+  std::vector<OnodeRef> evicted;
+
  // lock cache shards
   std::lock(ocache->lock, ocache_dest->lock, cache->lock, dest->cache->lock);
   std::lock_guard l(ocache->lock, std::adopt_lock);
   std::lock_guard l2(ocache_dest->lock, std::adopt_lock);
   std::lock_guard l3(cache->lock, std::adopt_lock);
   std::lock_guard l4(dest->cache->lock, std::adopt_lock);
+  // Both collection locks are held exclusively, which already excludes any
+  // lookup, so map_lock isn't needed here.  Taking it would also deadlock
+  // when dropping 'o' below unpins a non-existent onode.
 
   int destbits = dest->cnode.bits;
   spg_t destpg;
   bool is_pg = dest->cid.is_pg(&destpg);
   ceph_assert(is_pg);
 
+  bool evict_unpinned =
+    store->cct->_conf->bluestore_split_cache_evict_unpinned;
   auto p = onode_space.onode_map.begin();
   while (p != onode_space.onode_map.end()) {
-    OnodeRef o = p->second;
     if (!p->second->oid.match(destbits, destpg.pgid.ps())) {
       // onode does not belong to this child
-      ldout(store->cct, 20) << __func__ << " not moving " << o << " " << o->oid
-			    << dendl;
+      ldout(store->cct, 20) << __func__ << " not moving " << p->second
+			    << " " << p->second->oid << dendl;
       ++p;
+    } else if (evict_unpinned && p->second->pin_nref == 1) {
+      // only the cache holds it; let the child reload it on demand rather
+      // than migrating its blobs and buffers.  the ref is dropped once the
+      // cache locks are released since that may release shared blobs.
+      ldout(store->cct, 20) << __func__ << " evicting " << p->second << " "
+			    << p->second->oid << dendl;
+      ocache->_rm(p->second.get());
+      evicted.push_back(std::move(p->second));
+      p = onode_space.onode_map.erase(p);
     } else {
+      OnodeRef o = p->second;
       ldout(store->cct, 20) << __func__ << " moving " << o << " " << o->oid
 			    << dendl;
 
@@ -4197,6 +4256,8 @@ void BlueStore::Collection::split_cache(
     }
   }
   dest->cache->_trim();
+  ldout(store->cct, 10) << __func__ << " evicted " << evicted.size()
+			<< " onodes" << dendl;
 }
 
 // =======================================================
@@ -4229,6 +4290,17 @@ void *BlueStore::MempoolThread::entry()
 
   binned_kv_cache = store->db->get_priority_cache();
   binned_kv_onode_cache = store->db->get_priority_cache(PREFIX_OBJ);
+  // omap may live in any of the omap column families depending on the
+  // omap format of the store; balance the first one that has a cache of
+  // its own.
+  for (auto& prefix : { PREFIX_PERPG_OMAP, PREFIX_PERPOOL_OMAP,
+                        PREFIX_OMAP, PREFIX_PGMETA_OMAP }) {
+    binned_kv_omap_cache = store->db->get_priority_cache(prefix);
+    if (binned_kv_omap_cache != nullptr) {
+      kv_omap_prefix = prefix;
+      break;
+    }
+  }
   if (store->cache_autotune && binned_kv_cache != nullptr) {
     pcm = std::make_shared<PriorityCache::Manager>(
         store->cct, min, max, target, true, "bluestore-pricache");
@@ -4238,6 +4310,9 @@ void *BlueStore::MempoolThread::entry()
     if (binned_kv_onode_cache != nullptr) {
       pcm->insert("kv_onode", binned_kv_onode_cache, true);
     }
+    if (binned_kv_omap_cache != nullptr) {
+      pcm->insert("kv_omap", binned_kv_omap_cache, true);
+    }
   }
 
   utime_t next_balance = ceph_clock_now();
@@ -4277,6 +4352,9 @@ void *BlueStore::MempoolThread::entry()
       if (binned_kv_onode_cache != nullptr) {
         binned_kv_onode_cache->import_bins(store->kv_onode_bins);
       }
+      if (binned_kv_omap_cache != nullptr) {
+        binned_kv_omap_cache->import_bins(store->kv_bins);
+      }
       meta_cache->import_bins(store->meta_bins);
       data_cache->import_bins(store->data_bins);
 
@@ -4294,6 +4372,9 @@ void *BlueStore::MempoolThread::entry()
       if (binned_kv_onode_cache != nullptr) {
         binned_kv_onode_cache->set_cache_ratio(store->cache_kv_onode_ratio);
       }
+      if (binned_kv_omap_cache != nullptr) {
+        binned_kv_omap_cache->set_cache_ratio(store->cache_kv_omap_ratio);
+      }
       meta_cache->set_cache_ratio(store->cache_meta_ratio);
       data_cache->set_cache_ratio(store->cache_data_ratio);
 
@@ -4330,6 +4411,7 @@ void *BlueStore::MempoolThread::entry()
     _resize_shards(interval_stats_trim);
     interval_stats_trim = false;
 
+    _update_kv_cache_stats();
     store->_update_logger();
     auto wait = ceph::make_timespan(
       store->cct->_conf->bluestore_cache_trim_interval);
@@ -4339,9 +4421,39 @@ void *BlueStore::MempoolThread::entry()
   store->_record_allocation_stats();
   stop = false;
   pcm = nullptr;
+  binned_kv_omap_cache = nullptr;
+  kv_omap_prefix.clear();
   return NULL;
 }
 
+void BlueStore::MempoolThread::_update_kv_cache_stats()
+{
+  auto logger = store->logger;
+  uint64_t hits = 0, misses = 0;
+  if (store->db->get_cache_hit_stats(&hits, &misses) == 0) {
+    logger->set(l_bluestore_kv_cache_hits, hits);
+    logger->set(l_bluestore_kv_cache_misses, misses);
+  }
+  logger->set(l_bluestore_kv_cache_bytes,
+              std::max<int64_t>(0, store->db->get_cache_usage()));
+  if (binned_kv_onode_cache != nullptr) {
+    if (store->db->get_cache_hit_stats(PREFIX_OBJ, &hits, &misses) == 0) {
+      logger->set(l_bluestore_kv_onode_cache_hits, hits);
+      logger->set(l_bluestore_kv_onode_cache_misses, misses);
+    }
+    logger->set(l_bluestore_kv_onode_cache_bytes,
+                std::max<int64_t>(0, store->db->get_cache_usage(PREFIX_OBJ)));
+  }
+  if (binned_kv_omap_cache != nullptr) {
+    if (store->db->get_cache_hit_stats(kv_omap_prefix, &hits, &misses) == 0) {
+      logger->set(l_bluestore_kv_omap_cache_hits, hits);
+      logger->set(l_bluestore_kv_omap_cache_misses, misses);
+    }
+    logger->set(l_bluestore_kv_omap_cache_bytes,
+                std::max<int64_t>(0, store->db->get_cache_usage(kv_omap_prefix)));
+  }
+}
+
 void BlueStore::MempoolThread::_resize_shards(bool interval_stats)
 {
   size_t onode_shards = store->onode_cache_shards.size();
@@ -4626,7 +4738,8 @@ BlueStore::BlueStore(CephContext *cct,
   uint64_t _min_alloc_size)
   : ObjectStore(cct, path),
     throttle(cct),
-    finisher(cct, "commit_finisher", "cfin"),
+    finisher(cct, "commit_finisher", "cfin",
+	     cct->_conf.get_val<uint64_t>("bluestore_finisher_lanes")),
     kv_sync_thread(this),
     kv_finalize_thread(this),
 #ifdef HAVE_LIBZBD
@@ -4666,6 +4779,7 @@ const char **BlueStore::get_tracked_conf_keys() const
     "bluestore_csum_type",
     "bluestore_compression_mode",
     "bluestore_compression_algorithm",
+    "bluestore_compression_algorithm_cold",
     "bluestore_compression_min_blob_size",
     "bluestore_compression_min_blob_size_ssd",
     "bluestore_compression_min_blob_size_hdd",
@@ -4673,6 +4787,7 @@ const char **BlueStore::get_tracked_conf_keys() const
     "bluestore_compression_max_blob_size_ssd",
     "bluestore_compression_max_blob_size_hdd",
     "bluestore_compression_required_ratio",
+    "bluestore_compression_sample_size",
     "bluestore_max_alloc_size",
     "bluestore_prefer_deferred_size",
     "bluestore_prefer_deferred_size_hdd",
@@ -4725,8 +4840,10 @@ void BlueStore::handle_conf_change(const ConfigProxy& conf,
   }
   if (changed.count("bluestore_compression_mode") ||
       changed.count("bluestore_compression_algorithm") ||
+      changed.count("bluestore_compression_algorithm_cold") ||
       changed.count("bluestore_compression_min_blob_size") ||
-      changed.count("bluestore_compression_max_blob_size")) {
+      changed.count("bluestore_compression_max_blob_size") ||
+      changed.count("bluestore_compression_sample_size")) {
     if (bdev) {
       _set_compression();
     }
@@ -4794,6 +4911,7 @@ void BlueStore::_set_compression()
   }
 
   compressor = nullptr;
+  compressor_cold = nullptr;
 
   if (cct->_conf->bluestore_compression_min_blob_size) {
     comp_min_blob_size = cct->_conf->bluestore_compression_min_blob_size;
@@ -4826,11 +4944,28 @@ void BlueStore::_set_compression()
       _set_compression_alert(false, alg_name.c_str());
     }
   }
+
+  auto cold_alg_name =
+    cct->_conf.get_val<std::string>("bluestore_compression_algorithm_cold");
+  if (!cold_alg_name.empty()) {
+    compressor_cold = Compressor::create(cct, cold_alg_name);
+    if (!compressor_cold) {
+      derr << __func__ << " unable to initialize " << cold_alg_name.c_str()
+	   << " compressor" << dendl;
+      _set_compression_alert(false, cold_alg_name.c_str());
+    }
+  }
+
+  comp_sample_size =
+    cct->_conf.get_val<Option::size_t>("bluestore_compression_sample_size");
  
   dout(10) << __func__ << " mode " << Compressor::get_comp_mode_name(comp_mode)
 	   << " alg " << (compressor ? compressor->get_type_name() : "(none)")
+	   << " cold alg "
+	   << (compressor_cold ? compressor_cold->get_type_name() : "(none)")
 	   << " min_blob " << comp_min_blob_size
 	   << " max_blob " << comp_max_blob_size
+	   << " sample " << comp_sample_size
 	   << dendl;
 }
 
@@ -4963,10 +5098,18 @@ int BlueStore::_set_cache_sizes()
     return -EINVAL;
   }
 
+  cache_kv_omap_ratio = cct->_conf.get_val<double>("bluestore_cache_kv_omap_ratio");
+  if (cache_kv_omap_ratio < 0 || cache_kv_omap_ratio > 1.0) {
+    derr << __func__ << " bluestore_cache_kv_omap_ratio (" << cache_kv_omap_ratio
+         << ") must be in range [0,1.0]" << dendl;
+    return -EINVAL;
+  }
+
   cache_data_ratio = (double)1.0 - 
                      (double)cache_meta_ratio - 
                      (double)cache_kv_ratio - 
-                     (double)cache_kv_onode_ratio;
+                     (double)cache_kv_onode_ratio -
+                     (double)cache_kv_omap_ratio;
   if (cache_data_ratio < 0) {
     // deal with floating point imprecision
     cache_data_ratio = 0;
@@ -5081,9 +5224,9 @@ void BlueStore::_init_logger()
   b.add_time_avg(l_bluestore_submit_lat, "txc_submit_lat",
 		 "Average submit latency",
 		 "s_l", PerfCountersBuilder::PRIO_CRITICAL);
-  b.add_time_avg(l_bluestore_commit_lat, "txc_commit_lat",
-		 "Average commit latency",
-		 "c_l", PerfCountersBuilder::PRIO_CRITICAL);
+  b.add_time_avg_hist(l_bluestore_commit_lat, "txc_commit_lat",
+		      "Average commit latency",
+		      "c_l", PerfCountersBuilder::PRIO_CRITICAL);
   b.add_u64_counter(l_bluestore_txc, "txc_count", "Transactions committed");
   //****************************************
 
@@ -5122,6 +5265,30 @@ void BlueStore::_init_logger()
   b.add_time_avg(l_bluestore_kv_final_lat, "kv_final_lat",
 		 "Average kv_finalize thread latency",
 		 "kfll", PerfCountersBuilder::PRIO_INTERESTING);
+  b.add_u64_counter(l_bluestore_kv_group_commit_waits,
+		    "kv_group_commit_waits",
+		    "Number of kv_sync batches held open for group commit");
+  b.add_time_avg(l_bluestore_kv_group_commit_wait_lat,
+		 "kv_group_commit_wait_lat",
+		 "Average time kv_sync batches were held open for group commit");
+  PerfHistogramCommon::axis_config_d kv_batch_hist_x_axis_config{
+    "Batch size (txcs)",
+    PerfHistogramCommon::SCALE_LOG2, ///< Batch size in logarithmic scale
+    0,                               ///< Start at 0
+    1,                               ///< Quantization unit
+    12,                              ///< Enough to cover 1K+ txcs
+  };
+  PerfHistogramCommon::axis_config_d kv_batch_hist_y_axis_config{
+    "Flush + commit latency (usec)",
+    PerfHistogramCommon::SCALE_LOG2, ///< Latency in logarithmic scale
+    0,                               ///< Start at 0
+    8,                               ///< Quantization unit
+    16,                              ///< Enough to cover 250+ms
+  };
+  b.add_u64_counter_histogram(
+    l_bluestore_kv_batch_hist, "kv_batch_histogram",
+    kv_batch_hist_x_axis_config, kv_batch_hist_y_axis_config,
+    "Histogram of kv_sync batch sizes vs. their flush + commit latency");
   //****************************************
 
   // write op stats
@@ -5218,6 +5385,9 @@ void BlueStore::_init_logger()
 	    "Sum for beneficial compress ops");
   b.add_u64_counter(l_bluestore_compress_rejected_count, "compress_rejected_count",
 	    "Sum for compress ops rejected due to low net gain of space");
+  b.add_u64_counter(l_bluestore_compress_sample_rejected_count,
+	    "compress_sample_rejected_count",
+	    "Sum for compress ops rejected by compressing a sample only");
   //****************************************
 
   // onode cache stats
@@ -5237,6 +5407,13 @@ void BlueStore::_init_logger()
   b.add_u64_counter(l_bluestore_onode_shard_misses,
 		    "onode_shard_misses",
 		    "Count of onode shard cache lookups misses");
+  b.add_u64_counter(l_bluestore_onode_lockless_lookups,
+                    "onode_lockless_lookups",
+                    "Count of onode lookups that bypassed the cache shard lock");
+  b.add_u64_counter(l_bluestore_onode_cache_lock_contended,
+                    "onode_cache_lock_contended",
+                    "Count of onode lookups and inserts that had to wait "
+                    "for the cache shard lock");
   b.add_u64(l_bluestore_extents, "onode_extents",
 	    "Number of extents in cache");
   b.add_u64(l_bluestore_blobs, "onode_blobs",
@@ -5262,6 +5439,42 @@ void BlueStore::_init_logger()
 	    NULL,
 	    PerfCountersBuilder::PRIO_DEBUGONLY,
 	    unit_t(UNIT_BYTES));
+  b.add_u64_counter(l_bluestore_buffer_hit_shared_bytes, "buffer_hit_shared_bytes",
+	    "Sum for bytes of read found in the cache of a shared blob",
+	    NULL,
+	    PerfCountersBuilder::PRIO_DEBUGONLY,
+	    unit_t(UNIT_BYTES));
+  //****************************************
+
+  // kv block cache stats
+  //****************************************
+  b.add_u64(l_bluestore_kv_cache_hits, "kv_cache_hits",
+	    "Lookup hits in the default kv block cache");
+  b.add_u64(l_bluestore_kv_cache_misses, "kv_cache_misses",
+	    "Lookup misses in the default kv block cache");
+  b.add_u64(l_bluestore_kv_cache_bytes, "kv_cache_bytes",
+	    "Bytes used by the default kv block cache",
+	    NULL,
+	    PerfCountersBuilder::PRIO_DEBUGONLY,
+	    unit_t(UNIT_BYTES));
+  b.add_u64(l_bluestore_kv_onode_cache_hits, "kv_onode_cache_hits",
+	    "Lookup hits in the kv block cache of the onode column family");
+  b.add_u64(l_bluestore_kv_onode_cache_misses, "kv_onode_cache_misses",
+	    "Lookup misses in the kv block cache of the onode column family");
+  b.add_u64(l_bluestore_kv_onode_cache_bytes, "kv_onode_cache_bytes",
+	    "Bytes used by the kv block cache of the onode column family",
+	    NULL,
+	    PerfCountersBuilder::PRIO_DEBUGONLY,
+	    unit_t(UNIT_BYTES));
+  b.add_u64(l_bluestore_kv_omap_cache_hits, "kv_omap_cache_hits",
+	    "Lookup hits in the kv block cache of the omap column family");
+  b.add_u64(l_bluestore_kv_omap_cache_misses, "kv_omap_cache_misses",
+	    "Lookup misses in the kv block cache of the omap column family");
+  b.add_u64(l_bluestore_kv_omap_cache_bytes, "kv_omap_cache_bytes",
+	    "Bytes used by the kv block cache of the omap column family",
+	    NULL,
+	    PerfCountersBuilder::PRIO_DEBUGONLY,
+	    unit_t(UNIT_BYTES));
   //****************************************
 
   // internal stats
@@ -5275,6 +5488,13 @@ void BlueStore::_init_logger()
   b.add_u64_counter(l_bluestore_gc_merged, "gc_merged",
 		    "Sum for extents that have been merged due to garbage "
 		    "collection");
+  b.add_u64_counter(l_bluestore_zoned_cleaner_zones, "zoned_cleaner_zones",
+		    "Zones reclaimed by the zone cleaner");
+  b.add_u64_counter(l_bluestore_zoned_cleaner_bytes, "zoned_cleaner_bytes",
+		    "Live bytes rewritten by the zone cleaner",
+		    NULL, 0, unit_t(UNIT_BYTES));
+  b.add_time_avg(l_bluestore_zoned_cleaner_lat, "zoned_cleaner_lat",
+		 "Average time to clean one zone");
   //****************************************
   // misc
   //****************************************
@@ -5787,18 +6007,33 @@ int BlueStore::_create_alloc()
   }
 #endif
 
+  auto cache_shards =
+    cct->_conf.get_val<uint64_t>("bluestore_allocator_cache_shards");
+  if (allocator_type == "zoned") {
+    // ZonedAllocator is looked up via dynamic_cast
+    cache_shards = 0;
+  }
+
   alloc = Allocator::create(
     cct, allocator_type,
     bdev->get_size(),
     alloc_size,
     zone_size,
     first_sequential_zone,
-    "block");
+    cache_shards ? "block_backend" : "block");
   if (!alloc) {
     lderr(cct) << __func__ << " failed to create " << allocator_type << " allocator"
 	       << dendl;
     return -EINVAL;
   }
+  if (cache_shards) {
+    alloc = new CachingAllocator(
+      cct, alloc, cache_shards,
+      cct->_conf.get_val<Option::size_t>("bluestore_allocator_cache_run_size"),
+      cct->_conf.get_val<Option::size_t>("bluestore_allocator_cache_max_alloc"),
+      cct->_conf.get_val<Option::size_t>("bluestore_allocator_cache_release_batch"),
+      "block");
+  }
 
 #ifdef HAVE_LIBZBD
   if (freelist_type == "zoned") {
@@ -5946,7 +6181,8 @@ int BlueStore::_init_alloc(std::map<uint64_t, uint64_t> *zone_adjustments)
   return 0;
 }
 
-void BlueStore::_post_init_alloc(const std::map<uint64_t, uint64_t>& zone_adjustments)
+void BlueStore::_post_init_alloc(const std::map<uint64_t, uint64_t>& zone_adjustments,
+				 bool to_repair)
 {
   int r = 0;
 #ifdef HAVE_LIBZBD
@@ -5971,8 +6207,16 @@ void BlueStore::_post_init_alloc(const std::map<uint64_t, uint64_t>& zone_adjust
     // Now that we load the allocation map we need to invalidate the file as new allocation won't be reflected
     // Changes to the allocation map (alloc/release) are not updated inline and will only be stored on umount()
     // This means that we should not use the existing file on failure case (unplanned shutdown) and must resort
-    //  to recovery from RocksDB::ONodes
-    r = invalidate_allocation_file_on_bluefs();
+    //  to recovery from RocksDB::ONodes, unless the changes are journaled
+    if (!to_repair &&
+	cct->_conf.get_val<bool>("bluestore_allocation_journal")) {
+      r = start_allocation_journal();
+    } else {
+      r = stop_allocation_journal();
+      if (r == 0) {
+	r = invalidate_allocation_file_on_bluefs();
+      }
+    }
   }
   ceph_assert(r >= 0);
 }
@@ -6447,7 +6691,7 @@ int BlueStore::_open_db_and_around(bool read_only, bool to_repair)
   }
 
   if (!read_only) {
-    _post_init_alloc(zone_adjustments);
+    _post_init_alloc(zone_adjustments, to_repair);
   }
 
   // when function is called in repair mode (to_repair=true) we skip db->open()/create()
@@ -6759,6 +7003,13 @@ void BlueStore::_close_db()
   if (do_destage && is_statfs_recoverable()) {
     auto t = db->get_transaction();
     store_statfs_t s;
+    if (fm && fm->is_null_manager()) {
+      // the allocation file stored below replaces the journal; drop the
+      // base first so a crash in between never replays a partial journal
+      int r = stop_allocation_journal();
+      ceph_assert(r == 0);
+      t->rmkeys_by_prefix(PREFIX_ALLOC_JOURNAL);
+    }
     if (per_pool_stat_collection) {
       KeyValueDB::Iterator it = db->get_iterator(PREFIX_STAT, KeyValueDB::ITERATOR_NOCACHE);
       uint64_t pool_id;
@@ -10848,6 +11099,116 @@ int BlueStore::read(
   return r;
 }
 
+int BlueStore::read_digest(
+  CollectionHandle &c_,
+  const ghobject_t& oid,
+  uint64_t offset,
+  size_t length,
+  bufferlist& bl,
+  uint32_t *crc,
+  uint32_t op_flags)
+{
+  if (!cct->_conf.get_val<bool>("bluestore_read_digest_from_csum") ||
+      cct->_conf->bluestore_ignore_data_csum) {
+    return ObjectStore::read_digest(c_, oid, offset, length, bl, crc, op_flags);
+  }
+  Collection *c = static_cast<Collection *>(c_.get());
+  dout(15) << __func__ << " " << c->get_cid() << " " << oid
+	   << " 0x" << std::hex << offset << "~" << length << std::dec
+	   << dendl;
+  if (!c->exists)
+    return -ENOENT;
+
+  bl.clear();
+  int r;
+  {
+    // hold the lock across the read and the extent walk so the checksums
+    // we compose from are the ones the read was verified against
+    std::shared_lock l(c->lock);
+    OnodeRef o = c->get_onode(oid, false);
+    if (!o || !o->exists) {
+      return -ENOENT;
+    }
+    if (offset == length && offset == 0)
+      length = o->onode.size;
+
+    r = _do_read(c, o, offset, length, bl, op_flags);
+    if (r == -EIO) {
+      logger->inc(l_bluestore_read_eio);
+    }
+    if (r > 0) {
+      *crc = _compose_read_digest(o, offset, bl, *crc);
+    }
+  }
+  if (r >= 0 && _debug_data_eio(oid)) {
+    r = -EIO;
+    derr << __func__ << " " << c->cid << " " << oid << " INJECT EIO" << dendl;
+  }
+  dout(10) << __func__ << " " << c->get_cid() << " " << oid
+	   << " 0x" << std::hex << offset << "~" << length
+	   << " crc 0x" << *crc << std::dec << " = " << r << dendl;
+  return r;
+}
+
+uint32_t BlueStore::_compose_read_digest(
+  OnodeRef& o,
+  uint64_t offset,
+  const bufferlist& bl,
+  uint32_t crc)
+{
+  // A chunk's stored crc32c is crc(-1, data); re-seed it onto the running
+  // crc with crc(c, data) == crc(-1, data) ^ crc(c ^ -1, zeros).  Anything
+  // not covered by whole crc32c chunks is hashed from the buffer.
+  const uint64_t end = offset + bl.length();
+  uint64_t pos = offset;
+  uint64_t composed = 0;
+  auto p = bl.cbegin();
+  auto hash_data = [&](uint64_t l) {
+    crc = p.crc32c(l, crc);
+    pos += l;
+  };
+  auto ep = o->extent_map.seek_lextent(offset);
+  while (pos < end) {
+    if (ep == o->extent_map.extent_map.end() || ep->logical_offset >= end) {
+      hash_data(end - pos);
+      break;
+    }
+    if (ep->logical_offset > pos) {
+      // hole, reads back as zeros
+      uint64_t l = ep->logical_offset - pos;
+      crc = ceph_crc32c(crc, nullptr, l);
+      p += l;
+      pos += l;
+      continue;
+    }
+    const uint64_t l_end = std::min<uint64_t>(ep->logical_end(), end);
+    const bluestore_blob_t& b = ep->blob->get_blob();
+    if (b.csum_type != Checksummer::CSUM_CRC32C || b.is_compressed()) {
+      hash_data(l_end - pos);
+      ++ep;
+      continue;
+    }
+    const uint64_t cs = b.get_csum_chunk_size();
+    uint64_t b_off = ep->blob_offset + (pos - ep->logical_offset);
+    const uint64_t b_end = b_off + (l_end - pos);
+    uint64_t head = std::min(p2roundup(b_off, cs), b_end) - b_off;
+    hash_data(head);
+    b_off += head;
+    for (; b_end - b_off >= cs; b_off += cs) {
+      uint32_t stored = b.get_csum_item(b_off / cs);
+      crc = stored ^ ceph_crc32c(crc ^ 0xffffffff, nullptr, cs);
+      p += cs;
+      pos += cs;
+      composed += cs;
+    }
+    hash_data(b_end - b_off);
+    ++ep;
+  }
+  dout(20) << __func__ << " 0x" << std::hex << composed << " of 0x"
+	   << bl.length() << std::dec << " bytes from stored csums" << dendl;
+  return crc;
+}
+
 void BlueStore::_read_cache(
   OnodeRef& o,
   uint64_t offset,
@@ -10885,6 +11246,11 @@ void BlueStore::_read_cache(
              << " need 0x" << b_off << "~" << b_len
              << " cache has 0x" << cache_interval
              << std::dec << dendl;
+    if (bptr->get_blob().is_shared() && !cache_interval.empty()) {
+      // clones and snapshots reference these blocks through the same
+      // SharedBlob, so the hit is in the one copy they all share
+      logger->inc(l_bluestore_buffer_hit_shared_bytes, cache_interval.size());
+    }
 
     auto pc = cache_res.begin();
     uint64_t chunk_size = bptr->get_blob().get_chunk_size(block_size);
@@ -11147,7 +11513,7 @@ int BlueStore::_do_read(
   }
 
   auto start = mono_clock::now();
-  o->extent_map.fault_range(db, offset, length);
+  o->extent_map.fault_range_for_read(db, offset, length);
   log_latency(__func__,
     l_bluestore_read_onode_meta_lat,
     mono_clock::now() - start,
@@ -11344,7 +11710,7 @@ int BlueStore::_fiemap(
       length = o->onode.size - offset;
     }
 
-    o->extent_map.fault_range(db, offset, length);
+    o->extent_map.fault_range_for_read(db, offset, length);
     eend = o->extent_map.extent_map.end();
     ep = o->extent_map.seek_lextent(offset);
     while (length > 0) {
@@ -11512,7 +11878,7 @@ int BlueStore::_do_readv(
   ceph_assert(m.range_start() <= o->onode.size);
   ceph_assert(m.range_end() <= o->onode.size);
   auto start = mono_clock::now();
-  o->extent_map.fault_range(db, m.range_start(), m.range_end() - m.range_start());
+  o->extent_map.fault_range_for_read(db, m.range_start(), m.range_end() - m.range_start());
   log_latency(__func__,
     l_bluestore_read_onode_meta_lat,
     mono_clock::now() - start,
@@ -11961,7 +12327,8 @@ int BlueStore::_onode_omap_get(
     string head, tail;
     o->get_omap_header(&head);
     o->get_omap_tail(&tail);
-    KeyValueDB::Iterator it = db->get_iterator(prefix, 0, KeyValueDB::IteratorBounds{head, tail});
+    KeyValueDB::Iterator it = db->get_iterator(prefix, KeyValueDB::ITERATOR_SCAN,
+						 KeyValueDB::IteratorBounds{head, tail});
     it->lower_bound(head);
     while (it->valid()) {
       if (it->key() == head) {
@@ -12046,7 +12413,8 @@ int BlueStore::omap_get_keys(
     string head, tail;
     o->get_omap_key(string(), &head);
     o->get_omap_tail(&tail);
-    KeyValueDB::Iterator it = db->get_iterator(prefix, 0, KeyValueDB::IteratorBounds{head, tail});
+    KeyValueDB::Iterator it = db->get_iterator(prefix, KeyValueDB::ITERATOR_SCAN,
+						 KeyValueDB::IteratorBounds{head, tail});
     it->lower_bound(head);
     while (it->valid()) {
       if (it->key() >= tail) {
@@ -12239,7 +12607,9 @@ ObjectMap::ObjectMapIterator BlueStore::get_omap_iterator(
     bounds.lower_bound = std::move(lower_bound);
     bounds.upper_bound = std::move(upper_bound);
   }
-  KeyValueDB::Iterator it = db->get_iterator(o->get_omap_prefix(), 0, std::move(bounds));
+  KeyValueDB::Iterator it = db->get_iterator(o->get_omap_prefix(),
+					     KeyValueDB::ITERATOR_SCAN,
+					     std::move(bounds));
   return ObjectMap::ObjectMapIterator(new OmapIteratorImpl(logger,c, o, it));
 }
 
@@ -12839,6 +13209,8 @@ void BlueStore::_txc_finalize_kv(TransContext *txc, KeyValueDB::Transaction t)
 	       << "~" << p.get_len() << std::dec << dendl;
       fm->release(p.get_start(), p.get_len(), t);
     }
+  } else if (alloc_journal_active) {
+    _txc_journal_alloc(txc, t);
   }
 
 #ifdef HAVE_LIBZBD
@@ -12867,6 +13239,43 @@ void BlueStore::_txc_finalize_kv(TransContext *txc, KeyValueDB::Transaction t)
   _txc_update_store_statfs(txc);
 }
 
+void BlueStore::_txc_journal_alloc(TransContext *txc, KeyValueDB::Transaction t)
+{
+  if (txc->allocated.empty() && txc->released.empty() &&
+      txc->statfs_delta.is_empty()) {
+    return;
+  }
+
+  alloc_journal_entry_t e;
+  e.allocated = txc->allocated;
+  e.released = txc->released;
+  // a region both allocated and released by this txc ends up free,
+  // as it was before
+  interval_set<uint64_t> overlap;
+  overlap.intersection_of(e.allocated, e.released);
+  if (!overlap.empty()) {
+    e.allocated.subtract(overlap);
+    e.released.subtract(overlap);
+  }
+  e.pool = txc->osd_pool_id;
+  e.statfs = txc->statfs_delta;
+
+  bufferlist bl;
+  e.encode(bl);
+  string key;
+  get_alloc_journal_key(++alloc_journal_seq, &key);
+  t->set(PREFIX_ALLOC_JOURNAL, key, bl);
+
+  if (++alloc_journal_entries >
+      cct->_conf.get_val<uint64_t>("bluestore_allocation_journal_max_entries") &&
+      !alloc_journal_stopping.exchange(true)) {
+    dout(1) << __func__ << "::NCB::allocation journal is full, "
+	    << "an unplanned shutdown will need a full recovery" << dendl;
+    int r = stop_allocation_journal();
+    ceph_assert(r == 0);
+  }
+}
+
 void BlueStore::_txc_apply_kv(TransContext *txc, bool sync_submit_transaction)
 {
   ceph_assert(txc->get_state() == TransContext::STATE_KV_QUEUED);
@@ -12924,7 +13333,8 @@ void BlueStore::_txc_committed_kv(TransContext *txc)
     if (txc->ch->commit_queue) {
       txc->ch->commit_queue->queue(txc->oncommits);
     } else {
-      finisher.queue(txc->oncommits);
+      finisher.queue(reinterpret_cast<uintptr_t>(txc->osr.get()),
+		     txc->oncommits);
     }
   }
   throttle.log_state_latency(*txc, logger, l_bluestore_state_kv_committing_lat);
@@ -13253,6 +13663,9 @@ void BlueStore::_kv_sync_thread()
   auto t0 = mono_clock::now();
   timespan twait = ceph::make_timespan(0);
   size_t kv_submitted = 0;
+  // moving averages of txcs per batch and flush+commit latency, used to
+  // size the group commit window
+  double avg_batch = 0, avg_sync_us = 0;
 
   while (true) {
     auto period = cct->_conf->bluestore_kv_sync_util_logging_s;
@@ -13286,6 +13699,10 @@ void BlueStore::_kv_sync_thread()
       deque<DeferredBatch*> deferred_done, deferred_stable;
       uint64_t aios = 0, costs = 0;
 
+      if (!kv_queue.empty() && !kv_stop) {
+	_kv_sync_group_wait(l, avg_batch, avg_sync_us);
+      }
+
       dout(20) << __func__ << " committing " << kv_queue.size()
 	       << " submitting " << kv_queue_unsubmitted.size()
 	       << " deferred done " << deferred_done_queue.size()
@@ -13500,6 +13917,15 @@ void BlueStore::_kv_sync_thread()
 	  l_bluestore_kv_sync_lat,
 	  dur,
 	  cct->_conf->bluestore_log_op_age);
+
+	auto dur_us =
+	  std::chrono::duration_cast<std::chrono::microseconds>(dur).count();
+	logger->hinc(l_bluestore_kv_batch_hist, committing_size, dur_us);
+	if (committing_size) {
+	  // smoothing factor 1/8, same as TCP's srtt
+	  avg_batch += (committing_size - avg_batch) / 8;
+	  avg_sync_us += (dur_us - avg_sync_us) / 8;
+	}
       }
 
       l.lock();
@@ -13512,6 +13938,48 @@ void BlueStore::_kv_sync_thread()
   kv_sync_started = false;
 }
 
+/*
+ * Group commit: when recent batches show more than one txc in flight,
+ * hold the batch open for a bounded window so that concurrent submitters
+ * share the coming flush and sync instead of each paying for their own.
+ * The window is half of the recently observed sync latency, capped by
+ * bluestore_kv_sync_group_commit_max_wait_us, and ends early once the
+ * queue reaches twice the recent batch size.  At QD 1 the average batch
+ * stays at 1 and we never wait.
+ */
+void BlueStore::_kv_sync_group_wait(
+  std::unique_lock<ceph::mutex>& l,
+  double avg_batch,
+  double avg_sync_us)
+{
+  uint64_t max_wait_us = cct->_conf->bluestore_kv_sync_group_commit_max_wait_us;
+  if (!max_wait_us || avg_batch < 1.5) {
+    return;
+  }
+  size_t target = std::min<size_t>(
+    static_cast<size_t>(avg_batch * 2 + 0.5),
+    cct->_conf->bluestore_kv_sync_group_commit_max_txcs);
+  uint64_t wait_us = std::min<uint64_t>(max_wait_us, avg_sync_us / 2);
+  if (kv_queue.size() >= target || wait_us == 0) {
+    return;
+  }
+  dout(20) << __func__ << " queued " << kv_queue.size()
+	   << " target " << target
+	   << " wait " << wait_us << "us" << dendl;
+  auto start = mono_clock::now();
+  auto deadline = start + std::chrono::microseconds(wait_us);
+  while (kv_queue.size() < target && !kv_stop) {
+    // let submitters wake us as soon as they queue more txcs
+    kv_sync_in_progress = false;
+    if (kv_cond.wait_until(l, deadline) == std::cv_status::timeout) {
+      break;
+    }
+  }
+  kv_sync_in_progress = true;
+  logger->inc(l_bluestore_kv_group_commit_waits);
+  logger->tinc(l_bluestore_kv_group_commit_wait_lat, mono_clock::now() - start);
+}
+
 void BlueStore::_kv_finalize_thread()
 {
   deque<TransContext*> kv_committed;
@@ -13655,6 +14123,8 @@ void BlueStore::_zoned_clean_zone(
 {
   dout(10) << __func__ << " cleaning zone 0x" << std::hex << zone << std::dec << dendl;
 
+  auto start = mono_clock::now();
+  uint64_t moved = 0;
   KeyValueDB::Iterator it = db->get_iterator(PREFIX_ZONED_CL_INFO);
   std::string zone_start;
   get_zone_offset_object_key(zone, 0, ghobject_t(), &zone_start);
@@ -13675,8 +14145,9 @@ void BlueStore::_zoned_clean_zone(
     }
     dout(10) << __func__ << " zone 0x" << std::hex << zone << " offset 0x" << offset
 	     << std::dec << " " << oid << dendl;
-    _clean_some(oid, zone);
+    moved += _clean_some(oid, zone, a);
   }
+  logger->inc(l_bluestore_zoned_cleaner_bytes, moved);
 
   if (a->get_live_bytes(zone) > 0) {
     derr << "zone 0x" << std::hex << zone << " still has 0x" << a->get_live_bytes(zone)
@@ -13699,11 +14170,14 @@ void BlueStore::_zoned_clean_zone(
 
   // then allow ourselves to start allocating there
   dout(10) << __func__ << " done cleaning zone 0x" << std::hex << zone << std::dec
-	   << dendl;
+	   << ", rewrote 0x" << std::hex << moved << std::dec << dendl;
   a->reset_zone(zone);
+  logger->inc(l_bluestore_zoned_cleaner_zones);
+  logger->tinc(l_bluestore_zoned_cleaner_lat, mono_clock::now() - start);
 }
 
-void BlueStore::_clean_some(ghobject_t oid, uint32_t zone)
+uint64_t BlueStore::_clean_some(ghobject_t oid, uint32_t zone,
+				ZonedAllocator *a)
 {
   dout(10) << __func__ << " " << oid << " from zone 0x" << std::hex << zone << std::dec
 	   << dendl;
@@ -13711,7 +14185,7 @@ void BlueStore::_clean_some(ghobject_t oid, uint32_t zone)
   CollectionRef cref = _get_collection_by_oid(oid);
   if (!cref) {
     dout(10) << __func__ << " can't find collection for " << oid << dendl;
-    return;
+    return 0;
   }
   Collection *c = cref.get();
 
@@ -13722,7 +14196,7 @@ void BlueStore::_clean_some(ghobject_t oid, uint32_t zone)
   auto o = c->get_onode(oid, false);
   if (!o) {
     dout(10) << __func__ << " can't find " << oid << dendl;
-    return;
+    return 0;
   }
 
   o->extent_map.fault_range(db, 0, OBJECT_MAX_SIZE);
@@ -13760,7 +14234,7 @@ void BlueStore::_clean_some(ghobject_t oid, uint32_t zone)
   if (to_move.empty()) {
     dout(10) << __func__ << " no references to zone 0x" << std::hex << zone
 	     << std::dec << " from " << oid << dendl;
-    return;
+    return 0;
   }
 
   dout(10) << __func__ << " rewriting object extents 0x" << std::hex << to_move
@@ -13773,6 +14247,13 @@ void BlueStore::_clean_some(ghobject_t oid, uint32_t zone)
     txc->osd_pool_id = pgid.pool();
   }
 
+  // we hold atomic_alloc_and_submit_lock, so only our writes allocate
+  // while the allocator is steered to the cold zone
+  bool cold = cct->_conf->bluestore_zoned_cleaner_cold_zone;
+  if (cold) {
+    a->set_cold_allocation(true);
+  }
+  uint64_t moved = 0;
   for (auto& [offset, length] : to_move) {
     bufferlist bl;
     int r = _do_read(c, o, offset, length, bl, 0);
@@ -13780,12 +14261,17 @@ void BlueStore::_clean_some(ghobject_t oid, uint32_t zone)
 
     r = _do_write(txc, cref, o, offset, length, bl, 0);
     ceph_assert(r >= 0);
+    moved += length;
   }
   txc->write_onode(o);
 
   _txc_write_nodes(txc, txc->t);
   _txc_finalize_kv(txc, txc->t);
   _txc_state_proc(txc);
+  if (cold) {
+    a->set_cold_allocation(false);
+  }
+  return moved;
 }
 #endif
 
@@ -13860,11 +14346,17 @@ void BlueStore::deferred_try_submit()
     }
   }
 
+  // take the pending batches of all idle sequencers before submitting
+  // any, and submit them in device offset order: the batches of
+  // different sequencers then reach the device as one ascending sweep
+  // instead of in queue order
+  vector<DeferredBatch*> batches;
+  batches.reserve(osrs.size());
   for (auto& osr : osrs) {
     osr->deferred_lock.lock();
     if (osr->deferred_pending) {
       if (!osr->deferred_running) {
-	_deferred_submit_unlock(osr.get());
+	batches.push_back(_deferred_prepare_unlock(osr.get()));
       } else {
 	osr->deferred_lock.unlock();
 	dout(20) << __func__ << "  osr " << osr << " already has running"
@@ -13875,6 +14367,13 @@ void BlueStore::deferred_try_submit()
       dout(20) << __func__ << "  osr " << osr << " has no pending" << dendl;
     }
   }
+  std::sort(batches.begin(), batches.end(),
+	    [](const DeferredBatch *a, const DeferredBatch *b) {
+	      return a->first_offset < b->first_offset;
+	    });
+  for (auto b : batches) {
+    bdev->aio_submit(&b->ioc);
+  }
 
   {
     std::lock_guard l(deferred_lock);
@@ -13883,6 +14382,12 @@ void BlueStore::deferred_try_submit()
 }
 
 void BlueStore::_deferred_submit_unlock(OpSequencer *osr)
+{
+  DeferredBatch *b = _deferred_prepare_unlock(osr);
+  bdev->aio_submit(&b->ioc);
+}
+
+BlueStore::DeferredBatch *BlueStore::_deferred_prepare_unlock(OpSequencer *osr)
 {
   dout(10) << __func__ << " osr " << osr
 	   << " " << osr->deferred_pending->iomap.size() << " ios pending "
@@ -13905,6 +14410,7 @@ void BlueStore::_deferred_submit_unlock(OpSequencer *osr)
   uint64_t start = 0, pos = 0;
   bufferlist bl;
   auto i = b->iomap.begin();
+  b->first_offset = i == b->iomap.end() ? 0 : i->first;
   while (true) {
     if (i == b->iomap.end() || i->first != pos) {
       if (bl.length()) {
@@ -13935,8 +14441,7 @@ void BlueStore::_deferred_submit_unlock(OpSequencer *osr)
     bl.claim_append(i->second.bl);
     ++i;
   }
-
-  bdev->aio_submit(&b->ioc);
+  return b;
 }
 
 struct C_DeferredTrySubmit : public Context {
@@ -13970,7 +14475,8 @@ void BlueStore::_deferred_aio_finish(OpSequencer *osr)
       osr->deferred_lock.unlock();
       if (deferred_aggressive) {
 	dout(20) << __func__ << " queuing async deferred_try_submit" << dendl;
-	finisher.queue(new C_DeferredTrySubmit(this));
+	finisher.queue(reinterpret_cast<uintptr_t>(osr),
+		       new C_DeferredTrySubmit(this));
       } else {
 	dout(20) << __func__ << " leaving queued, more pending" << dendl;
       }
@@ -14240,7 +14746,7 @@ int BlueStore::queue_transactions(
     if (c->commit_queue) {
       c->commit_queue->queue(on_applied);
     } else {
-      finisher.queue(on_applied);
+      finisher.queue(reinterpret_cast<uintptr_t>(osr), on_applied);
     }
   }
 
@@ -15471,6 +15977,24 @@ void BlueStore::_do_write_big(
   }
 }
 
+bool BlueStore::_compress_sample_rejected(
+  CompressorRef& c,
+  const bufferlist& bl,
+  double crr)
+{
+  uint64_t sample_len = comp_sample_size;
+  if (!sample_len || bl.length() < sample_len * 2) {
+    return false;
+  }
+  // the middle of the blob is less likely to be a header or padding
+  bufferlist sample, t;
+  sample.substr_of(bl, p2align((bl.length() - sample_len) / 2, block_size),
+		   sample_len);
+  std::optional<int32_t> compressor_message;
+  int r = c->compress(sample, t, compressor_message);
+  return r == 0 && t.length() > sample_len * crr;
+}
+
 int BlueStore::_do_alloc_write(
   TransContext *txc,
   CollectionRef coll,
@@ -15508,6 +16032,12 @@ int BlueStore::_do_alloc_write(
         return std::optional<CompressorRef>();
       }
     );
+    if (wctx->compress_cold) {
+      CompressorRef cp = compressor_cold;
+      if (cp) {
+	c = cp;
+      }
+    }
 
     crr = select_option(
       "compression_required_ratio",
@@ -15559,6 +16089,21 @@ int BlueStore::_do_alloc_write(
       ceph_assert(wi.b_off == 0);
       ceph_assert(wi.blob_length == wi.bl.length());
 
+      if (_compress_sample_rejected(c, wi.bl, crr)) {
+	dout(20) << __func__ << std::hex << "  0x" << wi.blob_length
+		 << " sample does not compress with " << c->get_type()
+		 << ", leaving uncompressed" << std::dec << dendl;
+	logger->inc(l_bluestore_compress_rejected_count);
+	logger->inc(l_bluestore_compress_sample_rejected_count);
+	need += wi.blob_length;
+	data_size += wi.bl.length();
+	log_latency("compress@_do_alloc_write",
+	  l_bluestore_compress_lat,
+	  mono_clock::now() - start,
+	  cct->_conf->bluestore_log_op_age);
+	continue;
+      }
+
       // FIXME: memory alignment here is bad
       bufferlist t;
       std::optional<int32_t> compressor_message;
@@ -16010,6 +16555,15 @@ void BlueStore::_choose_write_options(
      (cm == Compressor::COMP_PASSIVE &&
       (alloc_hints & CEPH_OSD_ALLOC_HINT_FLAG_COMPRESSIBLE)));
 
+  // data that is not expected to be rewritten can take a slower but
+  // denser compressor
+  wctx->compress_cold = wctx->compress &&
+    (alloc_hints & (CEPH_OSD_ALLOC_HINT_FLAG_IMMUTABLE |
+		    CEPH_OSD_ALLOC_HINT_FLAG_APPEND_ONLY |
+		    CEPH_OSD_ALLOC_HINT_FLAG_LONGLIVED)) &&
+    (alloc_hints & (CEPH_OSD_ALLOC_HINT_FLAG_RANDOM_WRITE |
+		    CEPH_OSD_ALLOC_HINT_FLAG_SHORTLIVED)) == 0;
+
   if ((alloc_hints & CEPH_OSD_ALLOC_HINT_FLAG_SEQUENTIAL_READ) &&
       (alloc_hints & CEPH_OSD_ALLOC_HINT_FLAG_RANDOM_READ) == 0 &&
       (alloc_hints & (CEPH_OSD_ALLOC_HINT_FLAG_IMMUTABLE |
@@ -16070,6 +16624,7 @@ void BlueStore::_choose_write_options(
   dout(20) << __func__ << " prefer csum_order " << wctx->csum_order
            << " target_blob_size 0x" << std::hex << wctx->target_blob_size
 	   << " compress=" << (int)wctx->compress
+	   << " cold=" << (int)wctx->compress_cold
 	   << " buffered=" << (int)wctx->buffered
            << std::dec << dendl;
 }
@@ -16849,7 +17404,8 @@ int BlueStore::_clone(TransContext *txc,
     string head, tail;
     oldo->get_omap_header(&head);
     oldo->get_omap_tail(&tail);
-    KeyValueDB::Iterator it = db->get_iterator(prefix, 0, KeyValueDB::IteratorBounds{head, tail});
+    KeyValueDB::Iterator it = db->get_iterator(prefix, KeyValueDB::ITERATOR_SCAN,
+						 KeyValueDB::IteratorBounds{head, tail});
     it->lower_bound(head);
     while (it->valid()) {
       if (it->key() >= tail) {
@@ -18208,6 +18764,7 @@ bool RocksDBBlueFSVolumeSelector::compare(BlueFSVolumeSelector* other) {
 
 static const std::string allocator_dir    = "ALLOCATOR_NCB_DIR";
 static const std::string allocator_file   = "ALLOCATOR_NCB_FILE";
+static const std::string allocator_base   = "ALLOCATOR_NCB_BASE"; // allocator_file the journal applies to
 static uint32_t    s_format_version = 0x01; // support future changes to allocator-map file
 static uint32_t    s_serial         = 0x01;
 
@@ -18673,7 +19230,8 @@ int calc_allocator_image_trailer_size()
 }
 
 //-----------------------------------------------------------------------------------
-int BlueStore::__restore_allocator(Allocator* allocator, uint64_t *num, uint64_t *bytes)
+int BlueStore::__restore_allocator(Allocator* allocator, uint64_t *num, uint64_t *bytes,
+				    const std::string& file)
 {
   if (cct->_conf->bluestore_debug_inject_allocation_from_file_failure > 0) {
      boost::mt11213b rng(time(NULL));
@@ -18685,9 +19243,9 @@ int BlueStore::__restore_allocator(Allocator* allocator, uint64_t *num, uint64_t
   }
   utime_t start_time = ceph_clock_now();
   BlueFS::FileReader *p_temp_handle = nullptr;
-  int ret = bluefs->open_for_read(allocator_dir, allocator_file, &p_temp_handle, false);
+  int ret = bluefs->open_for_read(allocator_dir, file, &p_temp_handle, false);
   if (ret != 0) {
-    dout(1) << "Failed open_for_read with error-code " << ret << dendl;
+    dout(1) << "Failed open_for_read(" << file << ") with error-code " << ret << dendl;
     return -1;
   }
   unique_ptr<BlueFS::FileReader> p_handle(p_temp_handle);
@@ -18833,10 +19391,25 @@ int BlueStore::__restore_allocator(Allocator* allocator, uint64_t *num, uint64_t
 int BlueStore::restore_allocator(Allocator* dest_allocator, uint64_t *num, uint64_t *bytes)
 {
   utime_t    start = ceph_clock_now();
+  alloc_restored_from_file = false;
+  alloc_journal_replayed = false;
   auto temp_allocator = unique_ptr<Allocator>(create_bitmap_allocator(bdev->get_size()));
-  int ret = __restore_allocator(temp_allocator.get(), num, bytes);
-  if (ret != 0) {
-    return ret;
+  int ret = __restore_allocator(temp_allocator.get(), num, bytes, allocator_file);
+  if (ret == 0) {
+    alloc_restored_from_file = true;
+  } else {
+    // no file was stored at umount, but the changes made since the
+    // last one might have been journaled
+    temp_allocator.reset(create_bitmap_allocator(bdev->get_size()));
+    ret = __restore_allocator(temp_allocator.get(), num, bytes, allocator_base);
+    if (ret != 0) {
+      return ret;
+    }
+    ret = replay_allocation_journal(temp_allocator.get());
+    if (ret != 0) {
+      return ret;
+    }
+    alloc_journal_replayed = true;
   }
 
   uint64_t num_entries = 0;
@@ -18847,6 +19420,126 @@ int BlueStore::restore_allocator(Allocator* dest_allocator, uint64_t *num, uint6
   return ret;
 }
 
+//-----------------------------------------------------------------------------------
+int BlueStore::replay_allocation_journal(Allocator* allocator)
+{
+  utime_t start = ceph_clock_now();
+  uint64_t seq = 0, count = 0;
+  volatile_statfs store_delta;
+  std::map<int64_t, volatile_statfs> pool_deltas;
+  KeyValueDB::Iterator it = db->get_iterator(PREFIX_ALLOC_JOURNAL, KeyValueDB::ITERATOR_NOCACHE);
+  for (it->lower_bound(string()); it->valid(); it->next()) {
+    const char *p = _key_decode_u64(it->key().c_str(), &seq);
+    ceph_assert(p);
+    alloc_journal_entry_t e;
+    bufferlist bl = it->value();
+    auto bp = bl.cbegin();
+    try {
+      e.decode(bp);
+    } catch (ceph::buffer::error& err) {
+      derr << "failed to decode journal entry seq=" << seq << dendl;
+      return -EIO;
+    }
+    for (auto p = e.released.begin(); p != e.released.end(); ++p) {
+      allocator->init_add_free(p.get_start(), p.get_len());
+    }
+    for (auto p = e.allocated.begin(); p != e.allocated.end(); ++p) {
+      allocator->init_rm_free(p.get_start(), p.get_len());
+    }
+    store_delta += e.statfs;
+    pool_deltas[e.pool] += e.statfs;
+    ++count;
+  }
+
+  // statfs is only persisted at umount as well
+  {
+    std::lock_guard l(vstatfs_lock);
+    vstatfs += store_delta;
+    if (per_pool_stat_collection) {
+      for (auto& [pool, delta] : pool_deltas) {
+	osd_pools[pool] += delta;
+      }
+    }
+  }
+  alloc_journal_seq = seq;
+  alloc_journal_entries = count;
+  utime_t duration = ceph_clock_now() - start;
+  dout(5) << "replayed " << count << " entries up to seq=" << seq
+	  << " in " << duration << " seconds" << dendl;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------------
+int BlueStore::remove_allocation_journal_base()
+{
+  if (!bluefs->dir_exists(allocator_dir) ||
+      bluefs->stat(allocator_dir, allocator_base, nullptr, nullptr) != 0) {
+    return 0;
+  }
+  int ret = bluefs->unlink(allocator_dir, allocator_base);
+  if (ret != 0) {
+    derr << "Failed unlink(" << allocator_base << ") with error-code " << ret << dendl;
+    return ret;
+  }
+  bluefs->sync_metadata(false);
+  return 0;
+}
+
+//-----------------------------------------------------------------------------------
+int BlueStore::start_allocation_journal()
+{
+  // the file stored at umount covers whatever the journal does not
+  need_to_destage_allocation_file = true;
+  if (alloc_journal_replayed) {
+    dout(5) << "continuing journal at seq=" << alloc_journal_seq
+	    << " entries=" << alloc_journal_entries << dendl;
+    alloc_journal_stopping = false;
+    alloc_journal_active = true;
+    return 0;
+  }
+
+  // entries left over from an earlier mount belong to an older base
+  KeyValueDB::Transaction t = db->get_transaction();
+  t->rmkeys_by_prefix(PREFIX_ALLOC_JOURNAL);
+  int ret = db->submit_transaction_sync(t);
+  if (ret != 0) {
+    derr << "Failed to wipe the allocation journal with error-code " << ret << dendl;
+    return ret;
+  }
+  alloc_journal_seq = 0;
+  alloc_journal_entries = 0;
+  if (!alloc_restored_from_file) {
+    // rebuilt from the ONodes, there is nothing to journal against
+    // until the next umount stores a file
+    return remove_allocation_journal_base();
+  }
+
+  // the file we restored from becomes the base; moving it away also
+  // leaves no valid allocator_file for releases without the journal
+  ret = bluefs->rename(allocator_dir, allocator_file, allocator_dir, allocator_base);
+  if (ret != 0) {
+    derr << "Failed rename(" << allocator_file << " -> " << allocator_base
+	 << ") with error-code " << ret << dendl;
+    return ret;
+  }
+  bluefs->sync_metadata(false);
+  dout(5) << "journaling allocation changes against " << allocator_base << dendl;
+  alloc_journal_stopping = false;
+  alloc_journal_active = true;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------------
+int BlueStore::stop_allocation_journal()
+{
+  // without a base the journal is ignored on the next startup; it is
+  // wiped by the next start_allocation_journal() or umount
+  int ret = remove_allocation_journal_base();
+  alloc_journal_active = false;
+  alloc_journal_replayed = false;
+  return ret;
+}
+
 //-----------------------------------------------------------------------------------
 void BlueStore::set_allocation_in_simple_bmap(SimpleBitmap* sbmap, uint64_t offset, uint64_t length)
 {
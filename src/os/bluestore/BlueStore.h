@@ -121,6 +121,9 @@ enum {
   l_bluestore_kv_commit_lat,
   l_bluestore_kv_sync_lat,
   l_bluestore_kv_final_lat,
+  l_bluestore_kv_group_commit_waits,
+  l_bluestore_kv_group_commit_wait_lat,
+  l_bluestore_kv_batch_hist,
   //****************************************
 
   // write op stats
@@ -159,6 +162,7 @@ enum {
   l_bluestore_decompress_lat,
   l_bluestore_compress_success_count,
   l_bluestore_compress_rejected_count,
+  l_bluestore_compress_sample_rejected_count,
   //****************************************
 
   // onode cache stats
@@ -169,6 +173,8 @@ enum {
   l_bluestore_onode_misses,
   l_bluestore_onode_shard_hits,
   l_bluestore_onode_shard_misses,
+  l_bluestore_onode_lockless_lookups,
+  l_bluestore_onode_cache_lock_contended,
   l_bluestore_extents,
   l_bluestore_blobs,
   //****************************************
@@ -179,6 +185,20 @@ enum {
   l_bluestore_buffer_bytes,
   l_bluestore_buffer_hit_bytes,
   l_bluestore_buffer_miss_bytes,
+  l_bluestore_buffer_hit_shared_bytes,
+  //****************************************
+
+  // kv block cache stats
+  //****************************************
+  l_bluestore_kv_cache_hits,
+  l_bluestore_kv_cache_misses,
+  l_bluestore_kv_cache_bytes,
+  l_bluestore_kv_onode_cache_hits,
+  l_bluestore_kv_onode_cache_misses,
+  l_bluestore_kv_onode_cache_bytes,
+  l_bluestore_kv_omap_cache_hits,
+  l_bluestore_kv_omap_cache_misses,
+  l_bluestore_kv_omap_cache_bytes,
   //****************************************
 
   // internal stats
@@ -187,6 +207,9 @@ enum {
   l_bluestore_blob_split,
   l_bluestore_extent_compress,
   l_bluestore_gc_merged,
+  l_bluestore_zoned_cleaner_zones,
+  l_bluestore_zoned_cleaner_bytes,
+  l_bluestore_zoned_cleaner_lat,
   //****************************************
 
   // misc
@@ -1028,6 +1051,15 @@ public:
     void fault_range(KeyValueDB *db,
 		     uint32_t offset, uint32_t length);
 
+    /// ensure that a range of the map is loaded for reading.  Unlike
+    /// fault_range() this doesn't fault in the shard starting right at
+    /// offset + length: readers never look past the end of their range,
+    /// while writers may merge with the following extent.
+    void fault_range_for_read(KeyValueDB *db,
+			      uint32_t offset, uint32_t length) {
+      fault_range(db, offset, length ? length - 1 : 0);
+    }
+
     /// ensure a range of the map is marked dirty
     void dirty_range(uint32_t offset, uint32_t length);
 
@@ -1471,6 +1503,14 @@ private:
     /// forward lookups
     mempool::bluestore_cache_meta::unordered_map<ghobject_t,OnodeRef> onode_map;
 
+    /// guards onode_map so that lookups may skip the cache shard lock.
+    /// Writers hold cache->lock and then take this exclusively; lockless
+    /// lookups (bluestore_onode_cache_lockless_lookup) only take it shared.
+    /// No OnodeRef may be released while this is held exclusively, since
+    /// dropping the last pin may re-enter via maybe_unpin().
+    ceph::shared_mutex map_lock =
+      ceph::make_shared_mutex("BlueStore::OnodeSpace::map_lock");
+
     friend struct Collection; // for split_cache()
     friend struct Onode; // for put()
     friend struct LruOnodeCacheShard;
@@ -1696,6 +1736,33 @@ private:
     }
   };
 
+  /// allocation and statfs changes of a txc, journaled in NCB mode
+  struct alloc_journal_entry_t {
+    interval_set<uint64_t> allocated;
+    interval_set<uint64_t> released;
+    int64_t pool = 0;
+    volatile_statfs statfs;
+
+    void encode(ceph::buffer::list& bl) {
+      using ceph::encode;
+      ENCODE_START(1, 1, bl);
+      encode(allocated, bl);
+      encode(released, bl);
+      encode(pool, bl);
+      statfs.encode(bl);
+      ENCODE_FINISH(bl);
+    }
+    void decode(ceph::buffer::list::const_iterator& p) {
+      using ceph::decode;
+      DECODE_START(1, p);
+      decode(allocated, p);
+      decode(released, p);
+      decode(pool, p);
+      statfs.decode(p);
+      DECODE_FINISH(p);
+    }
+  };
+
   struct TransContext final : public AioContext {
     MEMPOOL_CLASS_HELPERS();
 
@@ -1995,12 +2062,15 @@ private:
     IOContext ioc;                   ///< our aios
     /// bytes of pending io for each deferred seq (may be 0)
     std::map<uint64_t,int> seq_bytes;
+    uint64_t first_offset = 0;       ///< lowest offset written, for ordering
 
     void _discard(CephContext *cct, uint64_t offset, uint64_t length);
     void _audit(CephContext *cct);
 
     DeferredBatch(CephContext *cct, OpSequencer *osr)
-      : osr(osr), ioc(cct, this) {}
+      : osr(osr), ioc(cct, this) {
+      ioc.io_class = IOContext::IO_CLASS_BACKGROUND;
+    }
 
     /// prepare a write
     void prepare_write(CephContext *cct,
@@ -2222,6 +2292,15 @@ private:
   bool db_was_opened_read_only = true;
   bool need_to_destage_allocation_file = false;
 
+  // allocation journal (see bluestore_allocation_journal): how the
+  // allocator was loaded at mount, and whether txcs are journaling
+  bool alloc_restored_from_file = false;
+  bool alloc_journal_replayed = false;
+  std::atomic<bool> alloc_journal_active = false;
+  std::atomic<bool> alloc_journal_stopping = false;
+  std::atomic<uint64_t> alloc_journal_seq = 0;
+  std::atomic<uint64_t> alloc_journal_entries = 0;
+
   ///< rwlock to protect coll_map/new_coll_map
   ceph::shared_mutex coll_lock = ceph::make_shared_mutex("BlueStore::coll_lock");
   mempool::bluestore_cache_other::unordered_map<coll_t, CollectionRef> coll_map;
@@ -2248,7 +2327,7 @@ private:
   deferred_osr_queue_t deferred_queue; ///< osr's with deferred io pending
   std::atomic_int deferred_queue_size = {0};         ///< num txc's queued across all osrs
   std::atomic_int deferred_aggressive = {0}; ///< aggressive wakeup of kv thread
-  Finisher  finisher;
+  ShardedFinisher finisher;  ///< lanes keyed by OpSequencer
   utime_t  deferred_last_submitted = utime_t();
 
   KVSyncThread kv_sync_thread;
@@ -2330,8 +2409,10 @@ private:
   std::atomic<Compressor::CompressionMode> comp_mode =
     {Compressor::COMP_NONE}; ///< compression mode
   CompressorRef compressor;
+  CompressorRef compressor_cold; ///< for data hinted as cold, if set
   std::atomic<uint64_t> comp_min_blob_size = {0};
   std::atomic<uint64_t> comp_max_blob_size = {0};
+  std::atomic<uint64_t> comp_sample_size = {0};
 
   std::atomic<uint64_t> max_blob_size = {0};  ///< maximum blob size
 
@@ -2343,6 +2424,7 @@ private:
   double cache_meta_ratio = 0;   ///< cache ratio dedicated to metadata
   double cache_kv_ratio = 0;     ///< cache ratio dedicated to kv (e.g., rocksdb)
   double cache_kv_onode_ratio = 0; ///< cache ratio dedicated to kv onodes (e.g., rocksdb onode CF)
+  double cache_kv_omap_ratio = 0; ///< cache ratio dedicated to kv omap (e.g., rocksdb omap CF)
   double cache_data_ratio = 0;   ///< cache ratio dedicated to object data
   bool cache_autotune = false;   ///< cache autotune setting
   double cache_age_bin_interval = 0; ///< time to wait between cache age bin rotations
@@ -2376,6 +2458,8 @@ private:
     bool stop = false;
     std::shared_ptr<PriorityCache::PriCache> binned_kv_cache = nullptr;
     std::shared_ptr<PriorityCache::PriCache> binned_kv_onode_cache = nullptr;
+    std::shared_ptr<PriorityCache::PriCache> binned_kv_omap_cache = nullptr;
+    std::string kv_omap_prefix; ///< omap column family owning binned_kv_omap_cache
     std::shared_ptr<PriorityCache::Manager> pcm = nullptr;
 
     struct MempoolCache : public PriorityCache::PriCache {
@@ -2597,6 +2681,7 @@ private:
   private:
     void _update_cache_settings();
     void _resize_shards(bool interval_stats);
+    void _update_kv_cache_stats();
   } mempool_thread;
 
 #ifdef WITH_BLKIN
@@ -2664,7 +2749,8 @@ private:
   int _write_out_fm_meta(uint64_t target_size);
   int _create_alloc();
   int _init_alloc(std::map<uint64_t, uint64_t> *zone_adjustments);
-  void _post_init_alloc(const std::map<uint64_t, uint64_t>& zone_adjustments);
+  void _post_init_alloc(const std::map<uint64_t, uint64_t>& zone_adjustments,
+			bool to_repair);
   void _close_alloc();
   int _open_collections();
   void _fsck_collections(int64_t* errors);
@@ -2727,6 +2813,7 @@ public:
 private:
   void _txc_finish_io(TransContext *txc);
   void _txc_finalize_kv(TransContext *txc, KeyValueDB::Transaction t);
+  void _txc_journal_alloc(TransContext *txc, KeyValueDB::Transaction t);
   void _txc_apply_kv(TransContext *txc, bool sync_submit_transaction);
   void _txc_committed_kv(TransContext *txc);
   void _txc_finish(TransContext *txc);
@@ -2741,6 +2828,9 @@ private:
   void _kv_start();
   void _kv_stop();
   void _kv_sync_thread();
+  void _kv_sync_group_wait(std::unique_lock<ceph::mutex>& l,
+			   double avg_batch,
+			   double avg_sync_us);
   void _kv_finalize_thread();
 
 #ifdef HAVE_LIBZBD
@@ -2750,7 +2840,8 @@ private:
   void _zoned_clean_zone(uint64_t zone_num,
 			 class ZonedAllocator *a,
 			 class ZonedFreelistManager *f);
-  void _clean_some(ghobject_t oid, uint32_t zone_num);
+  uint64_t _clean_some(ghobject_t oid, uint32_t zone_num,
+		       class ZonedAllocator *a);
 #endif
 
   bluestore_deferred_op_t *_get_deferred_op(TransContext *txc, uint64_t len);
@@ -2759,6 +2850,7 @@ public:
   void deferred_try_submit();
 private:
   void _deferred_submit_unlock(OpSequencer *osr);
+  DeferredBatch *_deferred_prepare_unlock(OpSequencer *osr);
   void _deferred_aio_finish(OpSequencer *osr);
   int _deferred_replay();
   bool _eliminate_outdated_deferred(bluestore_deferred_transaction_t* deferred_txn,
@@ -3008,6 +3100,14 @@ public:
     size_t len,
     ceph::buffer::list& bl,
     uint32_t op_flags = 0) override;
+  int read_digest(
+    CollectionHandle &c,
+    const ghobject_t& oid,
+    uint64_t offset,
+    size_t len,
+    ceph::buffer::list& bl,
+    uint32_t *crc,
+    uint32_t op_flags = 0) override;
 
 private:
 
@@ -3092,6 +3192,12 @@ private:
     uint32_t op_flags = 0,
     uint64_t retry_count = 0);
 
+  uint32_t _compose_read_digest(
+    OnodeRef& o,
+    uint64_t offset,
+    const ceph::buffer::list& bl,
+    uint32_t crc);
+
   int _do_readv(
     Collection *c,
     OnodeRef& o,
@@ -3399,6 +3505,7 @@ private:
   struct WriteContext {
     bool buffered = false;          ///< buffered write
     bool compress = false;          ///< compressed write
+    bool compress_cold = false;     ///< use compressor_cold if set
     uint64_t target_blob_size = 0;  ///< target (max) blob size
     unsigned csum_order = 0;        ///< target checksum chunk order
 
@@ -3448,6 +3555,7 @@ private:
     void fork(const WriteContext& other) {
       buffered = other.buffered;
       compress = other.compress;
+      compress_cold = other.compress_cold;
       target_blob_size = other.target_blob_size;
       csum_order = other.csum_order;
     }
@@ -3499,6 +3607,10 @@ private:
     uint64_t offset, uint64_t length,
     ceph::buffer::list::iterator& blp,
     WriteContext *wctx);
+  bool _compress_sample_rejected(
+    CompressorRef& c,
+    const ceph::buffer::list& bl,
+    double crr);
   int _do_alloc_write(
     TransContext *txc,
     CollectionRef c,
@@ -3828,8 +3940,13 @@ private:
   int  copy_allocator(Allocator* src_alloc, Allocator *dest_alloc, uint64_t* p_num_entries);
   int  store_allocator(Allocator* allocator);
   int  invalidate_allocation_file_on_bluefs();
-  int  __restore_allocator(Allocator* allocator, uint64_t *num, uint64_t *bytes);
+  int  __restore_allocator(Allocator* allocator, uint64_t *num, uint64_t *bytes,
+			   const std::string& file);
   int  restore_allocator(Allocator* allocator, uint64_t *num, uint64_t *bytes);
+  int  replay_allocation_journal(Allocator* allocator);
+  int  start_allocation_journal();
+  int  stop_allocation_journal();
+  int  remove_allocation_journal_base();
   int  read_allocation_from_drive_on_startup();
   int  reconstruct_allocations(SimpleBitmap *smbmp, read_alloc_stats_t &stats);
   int  read_allocation_from_onodes(SimpleBitmap *smbmp, read_alloc_stats_t& stats);
@@ -0,0 +1,248 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "CachingAllocator.h"
+
+#include <functional>
+#include <thread>
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include "common/debug.h"
+#include "include/intarith.h"
+
+#define dout_context cct
+#define dout_subsys ceph_subsys_bluestore
+#undef  dout_prefix
+#define dout_prefix *_dout << "CachingAllocator(" << this << ") "
+
+CachingAllocator::CachingAllocator(
+  CephContext* cct,
+  Allocator* backend,
+  unsigned num_shards,
+  uint64_t run_size,
+  uint64_t max_cached_alloc,
+  uint64_t release_batch,
+  std::string_view name)
+  : Allocator(name, backend->get_capacity(), backend->get_block_size()),
+    cct(cct),
+    backend(backend),
+    num_shards(std::max(1u, num_shards)),
+    run_size(p2roundup<uint64_t>(std::max(run_size, max_cached_alloc),
+				 backend->get_block_size())),
+    max_cached_alloc(max_cached_alloc),
+    release_batch(release_batch),
+    shards(new Shard[this->num_shards])
+{
+  ldout(cct, 10) << __func__ << " over " << backend->get_type()
+		 << " shards " << this->num_shards
+		 << std::hex << " run_size 0x" << this->run_size
+		 << " max_cached_alloc 0x" << max_cached_alloc
+		 << " release_batch 0x" << release_batch
+		 << std::dec << dendl;
+}
+
+CachingAllocator::~CachingAllocator()
+{
+  delete backend;
+}
+
+CachingAllocator::Shard& CachingAllocator::_pick_shard()
+{
+  size_t n;
+#if defined(__linux__)
+  int cpu = sched_getcpu();
+  if (cpu >= 0) {
+    n = cpu;
+  } else
+#endif
+  {
+    n = std::hash<std::thread::id>{}(std::this_thread::get_id());
+  }
+  return shards[n % num_shards];
+}
+
+void CachingAllocator::_flush_released(
+  Shard& s,
+  interval_set<uint64_t>* to_release)
+{
+  if (s.released.empty()) {
+    return;
+  }
+  cached_bytes -= s.released.size();
+  if (to_release->empty()) {
+    to_release->swap(s.released);
+  } else {
+    to_release->insert(s.released);
+    s.released.clear();
+  }
+}
+
+bool CachingAllocator::_refill(Shard& s, uint64_t want)
+{
+  // hand back what we queued first so the backend can merge it and
+  // perhaps give it out again as part of the new run
+  interval_set<uint64_t> to_release;
+  _flush_released(s, &to_release);
+  if (!to_release.empty()) {
+    backend->release(to_release);
+  }
+
+  PExtentVector got;
+  int64_t r = backend->allocate(run_size, block_size, 0, 0, &got);
+  if (r <= 0) {
+    ldout(cct, 10) << __func__ << " backend gave us nothing: " << r << dendl;
+    return s.run_bytes >= want;
+  }
+  ldout(cct, 20) << __func__ << " got 0x" << std::hex << r << std::dec
+		 << " in " << got.size() << " extents" << dendl;
+  s.runs.insert(s.runs.end(), got.begin(), got.end());
+  s.run_bytes += r;
+  cached_bytes += r;
+  return s.run_bytes >= want;
+}
+
+int64_t CachingAllocator::_carve(
+  Shard& s,
+  uint64_t want,
+  uint64_t max_alloc_size,
+  PExtentVector* extents)
+{
+  uint64_t max_len = max_alloc_size ?
+    std::max<uint64_t>(p2align<uint64_t>(max_alloc_size, block_size),
+		       block_size) :
+    want;
+  uint64_t left = want;
+  auto p = s.runs.begin();
+  while (left > 0) {
+    ceph_assert(p != s.runs.end());
+    uint64_t l = std::min({left, max_len, (uint64_t)p->length});
+    if (!extents->empty() &&
+	extents->back().end() == p->offset &&
+	extents->back().length + l <= max_len) {
+      extents->back().length += l;
+    } else {
+      extents->emplace_back(p->offset, l);
+    }
+    p->offset += l;
+    p->length -= l;
+    left -= l;
+    if (p->length == 0) {
+      ++p;
+    }
+  }
+  s.runs.erase(s.runs.begin(), p);
+  s.run_bytes -= want;
+  cached_bytes -= want;
+  return want;
+}
+
+int64_t CachingAllocator::allocate(
+  uint64_t want,
+  uint64_t unit,
+  uint64_t max_alloc_size,
+  int64_t hint,
+  PExtentVector *extents)
+{
+  if (want == 0 || want > max_cached_alloc ||
+      unit != (uint64_t)block_size || want % block_size) {
+    return backend->allocate(want, unit, max_alloc_size, hint, extents);
+  }
+  {
+    auto& s = _pick_shard();
+    std::lock_guard l(s.lock);
+    if (s.run_bytes >= want || _refill(s, want)) {
+      return _carve(s, want, max_alloc_size, extents);
+    }
+  }
+  // the backend is (nearly) out of space: give back whatever the shards
+  // hold and let it try on its own
+  ldout(cct, 10) << __func__ << " can't serve 0x" << std::hex << want
+		 << std::dec << " from cache, draining" << dendl;
+  drain();
+  return backend->allocate(want, unit, max_alloc_size, hint, extents);
+}
+
+void CachingAllocator::release(const interval_set<uint64_t>& release_set)
+{
+  if (release_set.size() > max_cached_alloc) {
+    backend->release(release_set);
+    return;
+  }
+  interval_set<uint64_t> to_release;
+  {
+    auto& s = _pick_shard();
+    std::lock_guard l(s.lock);
+    s.released.insert(release_set);
+    cached_bytes += release_set.size();
+    if (s.released.size() >= release_batch) {
+      _flush_released(s, &to_release);
+    }
+  }
+  if (!to_release.empty()) {
+    backend->release(to_release);
+  }
+}
+
+void CachingAllocator::drain()
+{
+  interval_set<uint64_t> to_release;
+  for (unsigned i = 0; i < num_shards; ++i) {
+    auto& s = shards[i];
+    std::lock_guard l(s.lock);
+    _flush_released(s, &to_release);
+    for (auto& e : s.runs) {
+      to_release.insert(e.offset, e.length);
+    }
+    cached_bytes -= s.run_bytes;
+    s.runs.clear();
+    s.run_bytes = 0;
+  }
+  if (!to_release.empty()) {
+    ldout(cct, 20) << __func__ << " releasing 0x" << std::hex
+		   << to_release.size() << std::dec << dendl;
+    backend->release(to_release);
+  }
+}
+
+void CachingAllocator::dump()
+{
+  drain();
+  backend->dump();
+}
+
+void CachingAllocator::foreach(
+  std::function<void(uint64_t offset, uint64_t length)> notify)
+{
+  drain();
+  backend->foreach(notify);
+}
+
+void CachingAllocator::init_add_free(uint64_t offset, uint64_t length)
+{
+  drain();
+  backend->init_add_free(offset, length);
+}
+
+void CachingAllocator::init_rm_free(uint64_t offset, uint64_t length)
+{
+  drain();
+  backend->init_rm_free(offset, length);
+}
+
+uint64_t CachingAllocator::get_free()
+{
+  return backend->get_free() + cached_bytes;
+}
+
+double CachingAllocator::get_fragmentation()
+{
+  return backend->get_fragmentation();
+}
+
+void CachingAllocator::shutdown()
+{
+  drain();
+  backend->shutdown();
+}
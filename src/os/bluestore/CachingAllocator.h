@@ -0,0 +1,92 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "Allocator.h"
+#include "common/ceph_mutex.h"
+#include "include/interval_set.h"
+
+/*
+ * Per-CPU front-end cache that can be layered over any Allocator.
+ *
+ * Each shard preallocates runs of space from the backend and carves small
+ * allocations out of them; small releases are queued per shard and handed
+ * back to the backend in batches.  The common path therefore only takes
+ * the lock of the shard picked by the current CPU instead of the backend's
+ * single lock.  Larger requests, requests with an allocation unit other
+ * than the backend's block size, and allocations that can't be served
+ * from the shard (e.g. when the device is nearly full) go straight to the
+ * backend, after all shards have given their cached space back.
+ *
+ * Cached space counts as free in get_free(); foreach(), dump() and the
+ * init_* methods drain the shards first so the backend's view is exact.
+ */
+class CachingAllocator : public Allocator {
+  struct alignas(64) Shard {
+    ceph::mutex lock = ceph::make_mutex("CachingAllocator::Shard::lock");
+    PExtentVector runs;      ///< preallocated from the backend, not handed out
+    uint64_t run_bytes = 0;
+    interval_set<uint64_t> released;  ///< queued for release to the backend
+  };
+
+  CephContext* cct;
+  Allocator* backend;
+  const unsigned num_shards;
+  const uint64_t run_size;         ///< how much a shard grabs at once
+  const uint64_t max_cached_alloc; ///< larger allocations bypass the cache
+  const uint64_t release_batch;    ///< release to the backend once queued
+  std::unique_ptr<Shard[]> shards;
+  std::atomic<uint64_t> cached_bytes = {0};
+
+  Shard& _pick_shard();
+  bool _refill(Shard& s, uint64_t want);
+  int64_t _carve(Shard& s, uint64_t want, uint64_t max_alloc_size,
+		 PExtentVector* extents);
+  void _flush_released(Shard& s, interval_set<uint64_t>* to_release);
+
+public:
+  /// takes ownership of backend
+  CachingAllocator(CephContext* cct,
+		   Allocator* backend,
+		   unsigned num_shards,
+		   uint64_t run_size,
+		   uint64_t max_cached_alloc,
+		   uint64_t release_batch,
+		   std::string_view name);
+  ~CachingAllocator() override;
+
+  const char* get_type() const override {
+    return backend->get_type();
+  }
+
+  int64_t allocate(
+    uint64_t want_size,
+    uint64_t unit,
+    uint64_t max_alloc_size,
+    int64_t hint,
+    PExtentVector *extents) override;
+
+  void release(const interval_set<uint64_t>& release_set) override;
+
+  void dump() override;
+  void foreach(
+    std::function<void(uint64_t offset, uint64_t length)> notify) override;
+
+  void init_add_free(uint64_t offset, uint64_t length) override;
+  void init_rm_free(uint64_t offset, uint64_t length) override;
+
+  uint64_t get_free() override;
+  double get_fragmentation() override;
+  void shutdown() override;
+
+  /// return everything the shards hold to the backend
+  void drain();
+
+  Allocator* get_backend() {
+    return backend;
+  }
+};
@@ -46,6 +46,7 @@ ZonedAllocator::ZonedAllocator(CephContext* cct,
   ceph_assert(size % zone_size == 0);
 
   zone_states.resize(num_zones);
+  zone_alloc_seq.resize(num_zones);
 }
 
 ZonedAllocator::~ZonedAllocator()
@@ -66,8 +67,24 @@ int64_t ZonedAllocator::allocate(
   ldout(cct, 10) << " trying to allocate 0x"
 		 << std::hex << want_size << std::dec << dendl;
 
+  if (cold_allocation) {
+    int64_t cold = pick_cold_zone(want_size);
+    if (cold >= 0) {
+      uint64_t offset = get_offset(cold);
+      increment_write_pointer(cold, want_size);
+      num_sequential_free -= want_size;
+      zone_alloc_seq[cold] = ++alloc_seq;
+      ldout(cct, 10) << " allocated 0x" << std::hex << offset << "~" << want_size
+		     << " from cold zone 0x" << cold << std::dec << dendl;
+      extents->emplace_back(bluestore_pextent_t(offset, want_size));
+      return want_size;
+    }
+    // no room for a separate cold zone; share the hot one
+  }
+
   uint64_t left = num_zones - first_seq_zone_num;
   uint64_t zone_num = starting_zone_num;
+  bool skipped_cold = false;
   for ( ; left > 0; ++zone_num, --left) {
     if (zone_num == num_zones) {
       zone_num = first_seq_zone_num;
@@ -77,6 +94,12 @@ int64_t ZonedAllocator::allocate(
 		     << " because we are cleaning it" << std::dec << dendl;
       continue;
     }
+    if ((int64_t)zone_num == cold_zone && fits(want_size, zone_num)) {
+      ldout(cct, 10) << " skipping zone 0x" << std::hex << zone_num
+		     << " because it holds cold data" << std::dec << dendl;
+      skipped_cold = true;
+      continue;
+    }
     if (!fits(want_size, zone_num)) {
       ldout(cct, 10) << " skipping zone 0x" << std::hex << zone_num
 		     << " because there is not enough space: "
@@ -89,7 +112,10 @@ int64_t ZonedAllocator::allocate(
     break;
   }
 
-  if (left == 0) {
+  if (left == 0 && skipped_cold) {
+    // better to mix temperatures than to fail
+    zone_num = cold_zone;
+  } else if (left == 0) {
     ldout(cct, 10) << " failed to allocate" << dendl;
     return -ENOSPC;
   }
@@ -103,6 +129,7 @@ int64_t ZonedAllocator::allocate(
 
   increment_write_pointer(zone_num, want_size);
   num_sequential_free -= want_size;
+  zone_alloc_seq[zone_num] = ++alloc_seq;
   if (get_remaining_space(zone_num) == 0) {
     starting_zone_num = zone_num + 1;
   }
@@ -166,19 +193,47 @@ void ZonedAllocator::init_from_zone_pointers(
 		 << dendl;
 }
 
+int64_t ZonedAllocator::pick_cold_zone(uint64_t want_size)
+{
+  if (cold_zone >= 0 && (uint64_t)cold_zone != cleaning_zone &&
+      fits(want_size, cold_zone)) {
+    return cold_zone;
+  }
+  // open a new cold zone, away from the zones being filled by fresh writes
+  for (uint64_t i = num_zones; i-- > first_seq_zone_num; ) {
+    if (i == cleaning_zone || i == starting_zone_num ||
+	zone_states[i].write_pointer != 0 || !fits(want_size, i)) {
+      continue;
+    }
+    ldout(cct, 10) << " opening cold zone 0x" << std::hex << i << std::dec
+		   << dendl;
+    cold_zone = i;
+    return cold_zone;
+  }
+  return -1;
+}
+
 int64_t ZonedAllocator::pick_zone_to_clean(float min_score, uint64_t min_saved)
 {
   std::lock_guard l(lock);
   int32_t best = -1;
   float best_score = 0.0;
   for (size_t i = first_seq_zone_num; i < num_zones; ++i) {
+    if ((int64_t)i == cold_zone) {
+      // still being filled by the cleaner itself
+      continue;
+    }
     // value (score) = benefit / cost
     //    benefit = how much net free space we'll get (dead bytes)
     //    cost = how many bytes we'll have to rewrite (live bytes)
-    // avoid divide by zero on a zone with no live bytes
+    // avoid divide by zero on a zone with no live bytes.  weight by age:
+    // live data that has not been overwritten for a long time is unlikely
+    // to die soon, so waiting on such a zone will not make it cheaper.
+    float age = alloc_seq ?
+      (float)(alloc_seq - zone_alloc_seq[i]) / (float)alloc_seq : 0.0;
     float score =
       (float)zone_states[i].num_dead_bytes /
-      (float)(zone_states[i].get_num_live_bytes() + 1);
+      (float)(zone_states[i].get_num_live_bytes() + 1) * (1.0 + age);
     if (score > 0) {
       ldout(cct, 20) << " zone 0x" << std::hex << i
 		     << " dead 0x" << zone_states[i].num_dead_bytes
@@ -216,8 +271,13 @@ int64_t ZonedAllocator::pick_zone_to_clean(float min_score, uint64_t min_saved)
 
 void ZonedAllocator::reset_zone(uint32_t zone)
 {
+  std::lock_guard l(lock);
   num_sequential_free += zone_states[zone].write_pointer;
   zone_states[zone].reset();
+  zone_alloc_seq[zone] = 0;
+  if (cold_zone == (int64_t)zone) {
+    cold_zone = -1;
+  }
 }
 
 bool ZonedAllocator::low_on_space(void)
@@ -41,6 +41,17 @@ class ZonedAllocator : public Allocator {
   std::atomic<uint32_t> cleaning_zone = -1;
   std::vector<zone_state_t> zone_states;
 
+  // Data rewritten by the cleaner has survived at least one cleaning and
+  // is likely to stay live, so while cold_allocation is set we fill a
+  // separate zone instead of mixing it with fresh writes.
+  bool cold_allocation = false;
+  int64_t cold_zone = -1;
+
+  // allocation sequence number of the last write to each zone, used as
+  // the zone's age by pick_zone_to_clean().  in memory only.
+  uint64_t alloc_seq = 0;
+  std::vector<uint64_t> zone_alloc_seq;
+
   inline uint64_t get_offset(uint64_t zone_num) const {
     return zone_num * zone_size + get_write_pointer(zone_num);
   }
@@ -66,6 +77,8 @@ private:
     return want_size <= get_remaining_space(zone_num);
   }
 
+  int64_t pick_cold_zone(uint64_t want_size);
+
 public:
   ZonedAllocator(CephContext* cct, int64_t size, int64_t block_size,
 		 int64_t _zone_size,
@@ -104,6 +117,10 @@ public:
   void clear_cleaning_zone(uint32_t zone) {
     cleaning_zone = -1;
   }
+  void set_cold_allocation(bool cold) {
+    std::lock_guard l(lock);
+    cold_allocation = cold;
+  }
   void reset_zone(uint32_t zone);
 
   void init_from_zone_pointers(
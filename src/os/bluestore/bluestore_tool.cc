@@ -1110,6 +1110,7 @@ int main(int argc, char **argv)
       get_ctrl(ctrl.keys_per_iterator);
       get_ctrl(ctrl.bytes_per_batch);
       get_ctrl(ctrl.keys_per_batch);
+      get_ctrl(ctrl.bytes_per_sec);
       if (!resharding_ctrl.empty()) {
 	cerr << "extra chars in --resharding-ctrl" << std::endl;
 	exit(EXIT_FAILURE);
@@ -415,9 +415,7 @@ struct bluestore_blob_use_tracker_t {
         denc_varint(total_bytes, p);
       } else {
         allocate(_num_au);
-        for (size_t i = 0; i < _num_au; ++i) {
-	  denc_varint(bytes_per_au[i], p);
-        }
+        denc_varint_n(bytes_per_au, _num_au, p);
       }
     }
   }
@@ -4,6 +4,8 @@
 #ifndef DYNAMIC_PERF_STATS_H
 #define DYNAMIC_PERF_STATS_H
 
+#include <algorithm>
+
 #include "include/random.h"
 #include "messages/MOSDOp.h"
 #include "mgr/OSDPerfMetricTypes.h"
@@ -15,12 +17,18 @@ public:
   DynamicPerfStats() {
   }
 
-  DynamicPerfStats(const std::list<OSDPerfMetricQuery> &queries) {
+  DynamicPerfStats(const std::list<OSDPerfMetricQuery> &queries,
+                   size_t max_keys = 0)
+    : max_keys(max_keys) {
     for (auto &query : queries) {
       data[query];
     }
   }
 
+  void set_max_keys(size_t n) {
+    max_keys = n;
+  }
+
   void merge(const DynamicPerfStats &dps) {
     for (auto &query_it : dps.data) {
       auto &query = query_it.first;
@@ -35,9 +43,11 @@ public:
               counter_it++;
             };
 
-        ceph_assert(key_it.second.size() >= data[query][key].size());
-        query.update_counters(update_counter_fnc, &data[query][key]);
+        auto &counters = data[query];
+        ceph_assert(key_it.second.size() >= counters[key].size());
+        query.update_counters(update_counter_fnc, &counters[key]);
       }
+      maybe_trim(&data[query]);
     }
   }
 
@@ -164,6 +174,7 @@ public:
       OSDPerfMetricKey key;
       if (query.get_key(get_subkey_fnc, &key)) {
         query.update_counters(update_counter_fnc, &it.second[key]);
+        maybe_trim(&it.second);
       }
     }
   }
@@ -245,6 +256,32 @@ public:
   }
 
 private:
+  // Keep a query with many distinct keys bounded: once it grows over
+  // max_keys, drop the quarter with the smallest first counter.  Dropping
+  // in batches keeps the cost per op amortized O(1) while the heavy keys,
+  // which are the ones limits and iotop-style consumers care about, stay.
+  void maybe_trim(std::map<OSDPerfMetricKey, PerformanceCounters> *counters) {
+    if (max_keys == 0 || counters->size() <= max_keys) {
+      return;
+    }
+    typedef std::map<OSDPerfMetricKey, PerformanceCounters>::iterator
+        Iterator;
+    std::vector<std::pair<uint64_t, Iterator>> weights;
+    weights.reserve(counters->size());
+    for (auto it = counters->begin(); it != counters->end(); it++) {
+      weights.emplace_back(it->second.empty() ? 0 : it->second[0].first, it);
+    }
+    size_t keep = max_keys - max_keys / 4;
+    size_t drop = weights.size() - keep;
+    std::nth_element(weights.begin(), weights.begin() + drop, weights.end(),
+                     [](const auto &a, const auto &b) {
+                       return a.first < b.first;
+                     });
+    for (size_t i = 0; i < drop; i++) {
+      counters->erase(weights[i].second);
+    }
+  }
+
   static bool is_limited(const OSDPerfMetricLimits &limits,
                          size_t counters_size) {
     if (limits.empty()) {
@@ -262,6 +299,7 @@ private:
 
   std::map<OSDPerfMetricQuery,
            std::map<OSDPerfMetricKey, PerformanceCounters>> data;
+  size_t max_keys = 0;
 };
 
 #endif // DYNAMIC_PERF_STATS_H
@@ -621,8 +621,9 @@ void ECBackend::continue_recovery_op(
       }
 
       map<pg_shard_t, vector<pair<int, int>>> to_read;
+      unsigned remote_avoided = 0;
       int r = get_min_avail_to_read_shards(
-	op.hoid, want, true, false, &to_read);
+	op.hoid, want, true, false, &to_read, &remote_avoided);
       if (r != 0) {
 	// we must have lost a recovery source
 	ceph_assert(!op.recovery_progress.first);
@@ -640,6 +641,11 @@ void ECBackend::continue_recovery_op(
 	std::move(want),
 	to_read,
 	op.recovery_progress.first && !op.obc);
+      if (remote_avoided) {
+	get_parent()->get_logger()->inc(
+	  l_osd_ec_recovery_remote_bytes_avoided,
+	  remote_avoided * sinfo.aligned_logical_offset_to_chunk_offset(amount));
+      }
       op.extent_requested = make_pair(
 	from,
 	amount);
@@ -1048,24 +1054,22 @@ void ECBackend::handle_sub_read(
         dout(25) << __func__ << " case2: going to do fragmented read." << dendl;
         int subchunk_size =
           sinfo.get_chunk_size() / ec_impl->get_sub_chunk_count();
-        bool error = false;
-        for (int m = 0; m < (int)j->get<1>() && !error;
+        // gather every sub-chunk of every chunk in the extent into one
+        // vectored read so the store can issue them together
+        interval_set<uint64_t> extents;
+        for (int m = 0; m < (int)j->get<1>();
              m += sinfo.get_chunk_size()) {
           for (auto &&k:op.subchunks.find(i->first)->second) {
-            bufferlist bl0;
-            r = store->read(
-                ch,
-                ghobject_t(i->first, ghobject_t::NO_GEN, shard),
-                j->get<0>() + m + (k.first)*subchunk_size,
-                (k.second)*subchunk_size,
-                bl0, j->get<2>());
-            if (r < 0) {
-              error = true;
-              break;
-            }
-            bl.claim_append(bl0);
+            extents.union_insert(
+              j->get<0>() + m + (k.first)*subchunk_size,
+              (k.second)*subchunk_size);
           }
         }
+        r = store->readv(
+          ch,
+          ghobject_t(i->first, ghobject_t::NO_GEN, shard),
+          extents,
+          bl, j->get<2>());
       }
 
       if (r < 0) {
@@ -1260,6 +1264,12 @@ void ECBackend::handle_sub_read_reply(
 
   ceph_assert(rop.in_progress.count(from));
   rop.in_progress.erase(from);
+  if (rop.for_recovery && op.errors.empty()) {
+    auto sent = rop.sent_at.find(from);
+    if (sent != rop.sent_at.end()) {
+      update_recovery_read_cost(from, ceph::mono_clock::now() - sent->second);
+    }
+  }
   unsigned is_complete = 0;
   bool need_resend = false;
   // For redundant reads check for completion as each shard comes in,
@@ -1474,6 +1484,8 @@ void ECBackend::on_change()
     cache.release_write_pin(op.second.pin);
   }
   tid_to_op_map.clear();
+  // in flight writes may be rolled back by the next interval
+  cache.invalidate_all_retained();
 
   for (map<ceph_tid_t, ReadOp>::iterator i = tid_to_read_map.begin();
        i != tid_to_read_map.end();
@@ -1631,12 +1643,56 @@ void ECBackend::get_all_avail_shards(
   }
 }
 
+/// recovery read cost of a shard outside our crush-locality subtree
+static constexpr uint64_t REMOTE_SHARD_READ_COST = 1 << 24;
+
+set<int> ECBackend::get_remote_shards(
+  const map<shard_id_t, pg_shard_t> &shards)
+{
+  set<int> remote;
+  const OSDMapRef &osdmap = get_osdmap();
+  const pg_pool_t &pool = get_parent()->get_pool();
+  if (osdmap->get_epoch() != locality_epoch) {
+    locality_epoch = osdmap->get_epoch();
+    locality_type = -1;
+    locality_of_osd.clear();
+    const auto &profile =
+      osdmap->get_erasure_code_profile(pool.erasure_code_profile);
+    auto p = profile.find("crush-locality");
+    if (p != profile.end() && !p->second.empty()) {
+      locality_type = osdmap->crush->get_type_id(p->second);
+    }
+  }
+  if (locality_type <= 0) {
+    return remote;
+  }
+  auto locality = [&](int osd) {
+    auto [p, inserted] = locality_of_osd.try_emplace(osd, 0);
+    if (inserted) {
+      p->second = osdmap->crush->get_parent_of_type(
+	osd, locality_type, pool.get_crush_rule());
+    }
+    return p->second;
+  };
+  int local = locality(get_parent()->whoami_shard().osd);
+  if (local == 0) {
+    return remote;
+  }
+  for (auto &&[shard, pg_shard] : shards) {
+    if (locality(pg_shard.osd) != local) {
+      remote.insert(shard);
+    }
+  }
+  return remote;
+}
+
 int ECBackend::get_min_avail_to_read_shards(
   const hobject_t &hoid,
   const set<int> &want,
   bool for_recovery,
   bool do_redundant_reads,
-  map<pg_shard_t, vector<pair<int, int>>> *to_read)
+  map<pg_shard_t, vector<pair<int, int>>> *to_read,
+  unsigned *remote_avoided)
 {
   // Make sure we don't do redundant reads for recovery
   ceph_assert(!for_recovery || !do_redundant_reads);
@@ -1647,11 +1703,61 @@ int ECBackend::get_min_avail_to_read_shards(
 
   get_all_avail_shards(hoid, error_shards, have, shards, for_recovery);
 
+  set<int> helpers = have;
+  set<int> remote;
+  const bool by_cost = for_recovery &&
+    cct->_conf.get_val<bool>("osd_ec_recovery_cost_aware");
+  if (by_cost) {
+    remote = get_remote_shards(shards);
+  }
+  if (by_cost && (!remote.empty() || !recovery_read_cost.empty())) {
+    // any shard outside our crush-locality subtree costs more than all
+    // the local ones together; within a tier shards we have no latency
+    // sample for cost nothing, so they are tried before the ones known
+    // to be slow
+    map<int, int> cost;
+    for (auto &&i : have) {
+      auto p = recovery_read_cost.find(shards[shard_id_t(i)]);
+      uint64_t c = p == recovery_read_cost.end() ? 0 :
+	std::min<uint64_t>(p->second, REMOTE_SHARD_READ_COST - 1);
+      if (remote.count(i)) {
+	c += REMOTE_SHARD_READ_COST;
+      }
+      cost[i] = c;
+    }
+    set<int> cheapest;
+    if (ec_impl->minimum_to_decode_with_cost(want, cost, &cheapest) == 0) {
+      dout(20) << __func__ << " cost " << cost << " helpers " << cheapest
+	       << dendl;
+      helpers.swap(cheapest);
+    }
+  }
+
   map<int, vector<pair<int, int>>> need;
-  int r = ec_impl->minimum_to_decode(want, have, &need);
+  int r = ec_impl->minimum_to_decode(want, helpers, &need);
+  if (r < 0 && helpers != have) {
+    need.clear();
+    r = ec_impl->minimum_to_decode(want, have, &need);
+  }
   if (r < 0)
     return r;
 
+  if (remote_avoided && !remote.empty() && helpers != have) {
+    map<int, vector<pair<int, int>>> baseline;
+    if (ec_impl->minimum_to_decode(want, have, &baseline) == 0) {
+      auto count_remote = [&remote](const auto &chunks) {
+	return std::count_if(chunks.begin(), chunks.end(),
+			     [&remote](const auto &c) {
+			       return remote.count(c.first) > 0;
+			     });
+      };
+      auto avoided = count_remote(baseline) - count_remote(need);
+      if (avoided > 0) {
+	*remote_avoided = avoided;
+      }
+    }
+  }
+
   if (do_redundant_reads) {
       vector<pair<int, int>> subchunks_list;
       subchunks_list.push_back(make_pair(0, ec_impl->get_sub_chunk_count()));
@@ -1670,6 +1776,20 @@ int ECBackend::get_min_avail_to_read_shards(
   return 0;
 }
 
+void ECBackend::update_recovery_read_cost(
+  pg_shard_t shard,
+  ceph::timespan latency)
+{
+  uint64_t usec =
+    std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+  auto [p, inserted] = recovery_read_cost.try_emplace(shard, usec);
+  if (!inserted) {
+    p->second = (p->second * 3 + usec) / 4;
+  }
+  dout(20) << __func__ << " " << shard << " " << usec << "us, avg "
+	   << p->second << "us" << dendl;
+}
+
 int ECBackend::get_remaining_shards(
   const hobject_t &hoid,
   const set<int> &avail,
@@ -1789,10 +1909,12 @@ void ECBackend::do_read_op(ReadOp &op)
 
   std::vector<std::pair<int, Message*>> m;
   m.reserve(messages.size());
+  auto now = ceph::mono_clock::now();
   for (map<pg_shard_t, ECSubRead>::iterator i = messages.begin();
        i != messages.end();
        ++i) {
     op.in_progress.insert(i->first);
+    op.sent_at[i->first] = now;
     shard_to_read_map[i->first].insert(op.tid);
     i->second.tid = tid;
     MOSDECSubOpRead *msg = new MOSDECSubOpRead;
@@ -1874,6 +1996,13 @@ ECUtil::HashInfoRef ECBackend::get_hash_info(
            << dendl;
       return ECUtil::HashInfoRef();
     }
+    if (get_parent()->get_pool().allows_ecoverwrites() &&
+	hinfo.has_chunk_hash()) {
+      // shard hashes are only checked in pools without overwrites; the
+      // first overwrite would drop them anyway, so don't keep them up
+      // to date on appends either
+      hinfo.set_total_chunk_size_clear_hash(hinfo.get_total_chunk_size());
+    }
     ref = unstable_hashinfo_registry.lookup_or_create(hoid, hinfo);
   }
   return ref;
@@ -2057,6 +2186,10 @@ bool ECBackend::try_reads_to_commit()
   dout(20) << __func__ << ": written_set: " << written_set << dendl;
   ceph_assert(written_set == op->plan.will_write);
 
+  if (op->plan.t) {
+    retain_written(*(op->plan.t), written);
+  }
+
   if (op->using_cache) {
     for (auto &&hpair: written) {
       dout(20) << __func__ << ": " << hpair << dendl;
@@ -2144,6 +2277,31 @@ bool ECBackend::try_reads_to_commit()
   return true;
 }
 
+void ECBackend::retain_written(
+  const PGTransaction &t,
+  const map<hobject_t,extent_map> &written)
+{
+  // the object lock keeps client reads out until this write commits,
+  // so what we retain here is what they would read from the shards
+  const uint64_t max_bytes =
+    cct->_conf.get_val<Option::size_t>("osd_ec_stripe_cache_size");
+  for (auto &&[oid, oop] : t.op_map) {
+    auto w = written.find(oid);
+    if (oop.is_none() && !oop.truncate && w != written.end()) {
+      cache.retain(oid, w->second, max_bytes);
+    } else {
+      // deleted, recreated, cloned over or truncated
+      cache.invalidate_retained(oid);
+    }
+    hobject_t source;
+    if (oop.has_source(&source)) {
+      cache.invalidate_retained(source);
+    }
+  }
+  get_parent()->get_logger()->set(
+    l_osd_ec_cache_bytes, ExtentCache::get_total_retained_bytes());
+}
+
 bool ECBackend::try_finish_rmw()
 {
   if (waiting_commit.empty())
@@ -2219,8 +2377,27 @@ void ECBackend::objects_read_async(
   map<hobject_t,std::list<boost::tuple<uint64_t, uint64_t, uint32_t> > >
     reads;
 
+  extent_set requested;
+  for (auto &&read : to_read) {
+    if (read.first.get<1>()) {
+      requested.union_insert(read.first.get<0>(), read.first.get<1>());
+    }
+  }
+  std::optional<extent_map> retained;
+  if (!requested.empty()) {
+    retained = cache.get_retained(hoid, requested);
+    get_parent()->get_logger()->inc(
+      retained ? l_osd_ec_cache_hit : l_osd_ec_cache_miss);
+  }
+
   uint32_t flags = 0;
   extent_set es;
+  // only read the shards holding the requested bytes; redundant reads
+  // and sub-chunked codes keep reading whole stripes
+  bool partial = !fast_read &&
+    ec_impl->get_sub_chunk_count() == 1 &&
+    cct->_conf.get_val<bool>("osd_ec_partial_reads");
+  map<hobject_t, set<int>> want_shards;
   for (list<pair<boost::tuple<uint64_t, uint64_t, uint32_t>,
 	 pair<bufferlist*, Context*> > >::const_iterator i =
 	 to_read.begin();
@@ -2232,6 +2409,10 @@ void ECBackend::objects_read_async(
 
     es.union_insert(tmp.first, tmp.second);
     flags |= i->first.get<2>();
+    if (partial) {
+      get_want_to_read_shards(
+	i->first.get<0>(), i->first.get<1>(), &want_shards[hoid]);
+    }
   }
 
   if (!es.empty()) {
@@ -2317,6 +2498,23 @@ void ECBackend::objects_read_async(
       to_read.clear();
     }
   };
+  if (retained) {
+    dout(20) << __func__ << ": " << hoid << " " << requested
+	     << " served from retained writes" << dendl;
+    // queue behind in progress reads to complete in order
+    in_progress_client_reads.emplace_back(
+      1,
+      make_gen_lambda_context<
+	map<hobject_t,pair<int, extent_map> > &&, cb>(
+	  cb(this,
+	     hoid,
+	     to_read,
+	     on_complete)));
+    in_progress_client_reads.back().complete_object(
+      hoid, 0, std::move(*retained));
+    kick_reads();
+    return;
+  }
   objects_read_and_reconstruct(
     reads,
     fast_read,
@@ -2325,7 +2523,8 @@ void ECBackend::objects_read_async(
 	cb(this,
 	   hoid,
 	   to_read,
-	   on_complete)));
+	   on_complete)),
+    partial ? &want_shards : nullptr);
 }
 
 struct CallClientContexts :
@@ -2334,12 +2533,36 @@ struct CallClientContexts :
   ECBackend *ec;
   ECBackend::ClientAsyncReadStatus *status;
   list<boost::tuple<uint64_t, uint64_t, uint32_t> > to_read;
+  /// data shards the caller needs, empty if it wants whole stripes
+  set<int> partial_want;
   CallClientContexts(
     hobject_t hoid,
     ECBackend *ec,
     ECBackend::ClientAsyncReadStatus *status,
-    const list<boost::tuple<uint64_t, uint64_t, uint32_t> > &to_read)
-    : hoid(hoid), ec(ec), status(status), to_read(to_read) {}
+    const list<boost::tuple<uint64_t, uint64_t, uint32_t> > &to_read,
+    const set<int> &partial_want)
+    : hoid(hoid), ec(ec), status(status), to_read(to_read),
+      partial_want(partial_want) {}
+  int reassemble(map<int, bufferlist> &to_decode, bufferlist *bl) {
+    map<int, bufferlist> decoded;
+    map<int, bufferlist*> missing;
+    for (int shard : partial_want) {
+      if (!to_decode.count(shard)) {
+	missing[shard] = &decoded[shard];
+      }
+    }
+    if (!missing.empty()) {
+      // a wanted shard failed and we were sent enough others to decode it
+      int r = ECUtil::decode(ec->sinfo, ec->ec_impl, to_decode, missing);
+      if (r < 0)
+	return r;
+      for (auto &&i : decoded) {
+	to_decode[i.first] = std::move(i.second);
+      }
+    }
+    ECUtil::concat_data_chunks(ec->sinfo, ec->ec_impl, to_decode, bl);
+    return 0;
+  }
   void finish(pair<RecoveryMessages *, ECBackend::read_result_t &> &in) override {
     ECBackend::read_result_t &res = in.second;
     extent_map result;
@@ -2361,11 +2584,13 @@ struct CallClientContexts :
 	   ++j) {
 	to_decode[j->first.shard] = std::move(j->second);
       }
-      int r = ECUtil::decode(
-	ec->sinfo,
-	ec->ec_impl,
-	to_decode,
-	&bl);
+      int r = partial_want.empty() ?
+	ECUtil::decode(
+	  ec->sinfo,
+	  ec->ec_impl,
+	  to_decode,
+	  &bl) :
+	reassemble(to_decode, &bl);
       if (r < 0) {
         res.r = r;
         goto out;
@@ -2391,7 +2616,8 @@ void ECBackend::objects_read_and_reconstruct(
     std::list<boost::tuple<uint64_t, uint64_t, uint32_t> >
   > &reads,
   bool fast_read,
-  GenContextURef<map<hobject_t,pair<int, extent_map> > &&> &&func)
+  GenContextURef<map<hobject_t,pair<int, extent_map> > &&> &&func,
+  const map<hobject_t, set<int>> *want_shards)
 {
   in_progress_client_reads.emplace_back(
     reads.size(), std::move(func));
@@ -2406,20 +2632,31 @@ void ECBackend::objects_read_and_reconstruct(
     
   map<hobject_t, read_request_t> for_read_op;
   for (auto &&to_read: reads) {
+    set<int> partial_want;
+    if (want_shards) {
+      auto p = want_shards->find(to_read.first);
+      if (p != want_shards->end() && p->second.size() < want_to_read.size()) {
+	partial_want = p->second;
+      }
+    }
+    const set<int> &want = partial_want.empty() ? want_to_read : partial_want;
     map<pg_shard_t, vector<pair<int, int>>> shards;
     int r = get_min_avail_to_read_shards(
       to_read.first,
-      want_to_read,
+      want,
       false,
       fast_read,
       &shards);
     ceph_assert(r == 0);
+    dout(20) << __func__ << ": " << to_read.first << " want " << want
+	     << " reading " << shards << dendl;
 
     CallClientContexts *c = new CallClientContexts(
       to_read.first,
       this,
       &(in_progress_client_reads.back()),
-      to_read.second);
+      to_read.second,
+      partial_want);
     for_read_op.insert(
       make_pair(
 	to_read.first,
@@ -2428,7 +2665,7 @@ void ECBackend::objects_read_and_reconstruct(
 	  shards,
 	  false,
 	  c)));
-    obj_want_to_read.insert(make_pair(to_read.first, want_to_read));
+    obj_want_to_read.insert(make_pair(to_read.first, want));
   }
 
   start_read_op(
@@ -2543,12 +2780,13 @@ int ECBackend::be_deep_scrub(
     stride += sinfo.get_chunk_size() - (stride % sinfo.get_chunk_size());
 
   bufferlist bl;
-  r = store->read(
+  uint32_t crc = pos.data_hash.digest();
+  r = store->read_digest(
     ch,
     ghobject_t(
       poid, ghobject_t::NO_GEN, get_parent()->whoami_shard().shard),
     pos.data_pos,
-    stride, bl,
+    stride, bl, &crc,
     fadvise_flags);
   if (r < 0) {
     dout(20) << __func__ << "  " << poid << " got "
@@ -2563,9 +2801,7 @@ int ECBackend::be_deep_scrub(
     o.read_error = true;
     return 0;
   }
-  if (r > 0) {
-    pos.data_hash << bl;
-  }
+  pos.data_hash = bufferhash(crc);
   pos.data_pos += r;
   if (r == (int)stride) {
     return -EINPROGRESS;
@@ -135,12 +135,18 @@ public:
    * still only perform a client read from shards in the acting std::set.  This
    * ensures that we won't ever have to restart a client initiated read in
    * check_recovery_sources.
+   *
+   * If want_shards names the shards an object's caller actually needs
+   * (usually fewer than k for a small read), only those are read when
+   * they are all available; the other data chunks of the returned
+   * stripes are zero filled.  Otherwise all data shards are wanted.
    */
   void objects_read_and_reconstruct(
     const std::map<hobject_t, std::list<boost::tuple<uint64_t, uint64_t, uint32_t> >
     > &reads,
     bool fast_read,
-    GenContextURef<std::map<hobject_t,std::pair<int, extent_map> > &&> &&func);
+    GenContextURef<std::map<hobject_t,std::pair<int, extent_map> > &&> &&func,
+    const std::map<hobject_t, std::set<int>> *want_shards = nullptr);
 
   friend struct CallClientContexts;
   struct ClientAsyncReadStatus {
@@ -215,6 +221,15 @@ private:
       want_to_read->insert(chunk);
     }
   }
+  /// shards holding the data chunks touched by the logical range
+  void get_want_to_read_shards(
+    uint64_t off, uint64_t len, std::set<int> *want_to_read) const {
+    const std::vector<int> &chunk_mapping = ec_impl->get_chunk_mapping();
+    for (int i : sinfo.offset_len_to_data_chunks(std::make_pair(off, len))) {
+      int chunk = (int)chunk_mapping.size() > i ? chunk_mapping[i] : i;
+      want_to_read->insert(chunk);
+    }
+  }
 
   /**
    * Recovery
@@ -385,6 +400,8 @@ public:
     void dump(ceph::Formatter *f) const;
 
     std::set<pg_shard_t> in_progress;
+    /// when the latest sub read was sent to each shard
+    std::map<pg_shard_t, ceph::mono_time> sent_at;
 
     ReadOp(
       int priority,
@@ -420,6 +437,11 @@ public:
   friend ostream &operator<<(ostream &lhs, const ReadOp &rhs);
   std::map<ceph_tid_t, ReadOp> tid_to_read_map;
   std::map<pg_shard_t, std::set<ceph_tid_t> > shard_to_read_map;
+
+  /// moving average of recovery sub read latency per shard, in usec
+  std::map<pg_shard_t, uint64_t> recovery_read_cost;
+  void update_recovery_read_cost(pg_shard_t shard, ceph::timespan latency);
+
   void start_read_op(
     int priority,
     std::map<hobject_t, std::set<int>> &want_to_read,
@@ -564,6 +586,10 @@ public:
   bool try_state_to_reads();
   bool try_reads_to_commit();
   bool try_finish_rmw();
+  /// hand the contents written by t to the cache for later reads
+  void retain_written(
+    const PGTransaction &t,
+    const std::map<hobject_t,extent_map> &written);
   void check_ops();
 
   ceph::ErasureCodeInterfaceRef ec_impl;
@@ -648,9 +674,17 @@ public:
     const std::set<int> &want,      ///< [in] desired shards
     bool for_recovery,         ///< [in] true if we may use non-acting replicas
     bool do_redundant_reads,   ///< [in] true if we want to issue redundant reads to reduce latency
-    std::map<pg_shard_t, std::vector<std::pair<int, int>>> *to_read   ///< [out] shards, corresponding subchunks to read
+    std::map<pg_shard_t, std::vector<std::pair<int, int>>> *to_read,   ///< [out] shards, corresponding subchunks to read
+    unsigned *remote_avoided = nullptr ///< [out] reads kept inside our crush-locality subtree
     ); ///< @return error code, 0 on success
 
+  /// shards outside our crush-locality subtree, if the profile has one
+  std::set<int> get_remote_shards(
+    const std::map<shard_id_t, pg_shard_t> &shards);
+  epoch_t locality_epoch = 0;
+  int locality_type = -1;
+  std::map<int, int> locality_of_osd;
+
   int get_remaining_shards(
     const hobject_t &hoid,
     const std::set<int> &avail,
@@ -1,7 +1,9 @@
 // -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
 
 #include <errno.h>
+#include "include/crc32c.h"
 #include "include/encoding.h"
+#include "common/Thread.h"
 #include "ECUtil.h"
 
 using namespace std;
@@ -120,6 +122,144 @@ int ECUtil::decode(
   return 0;
 }
 
+void ECUtil::concat_data_chunks(
+  const stripe_info_t &sinfo,
+  ErasureCodeInterfaceRef &ec_impl,
+  const map<int, bufferlist> &to_decode,
+  bufferlist *out) {
+  ceph_assert(to_decode.size());
+  ceph_assert(out);
+  ceph_assert(out->length() == 0);
+
+  uint64_t total_data_size = to_decode.begin()->second.length();
+  ceph_assert(total_data_size % sinfo.get_chunk_size() == 0);
+  for (auto &&i : to_decode) {
+    ceph_assert(i.second.length() == total_data_size);
+  }
+
+  const vector<int> &chunk_mapping = ec_impl->get_chunk_mapping();
+  const int k = ec_impl->get_data_chunk_count();
+  for (uint64_t i = 0; i < total_data_size; i += sinfo.get_chunk_size()) {
+    for (int j = 0; j < k; ++j) {
+      int shard = (int)chunk_mapping.size() > j ? chunk_mapping[j] : j;
+      auto p = to_decode.find(shard);
+      if (p == to_decode.end()) {
+	out->append_zero(sinfo.get_chunk_size());
+	continue;
+      }
+      bufferlist bl;
+      bl.substr_of(p->second, i, sinfo.get_chunk_size());
+      out->claim_append(bl);
+    }
+  }
+}
+
+namespace {
+/// whether concurrent encode() calls on one instance are safe
+bool encode_is_reentrant(const ceph::ErasureCodeProfile &profile)
+{
+  auto plugin = profile.find("plugin");
+  if (plugin == profile.end())
+    return false;
+  // both only read tables set up by init()
+  return plugin->second == "jerasure" || plugin->second == "isa";
+}
+
+/// whether encode() writes coding chunks into buffers passed in by the caller
+bool encodes_into_provided_buffers(const ceph::ErasureCodeProfile &profile)
+{
+  auto plugin = profile.find("plugin");
+  if (plugin == profile.end())
+    return false;
+  // these use ErasureCode::encode_prepare; shec insists on an empty map
+  return plugin->second == "jerasure" || plugin->second == "isa" ||
+    plugin->second == "lrc" || plugin->second == "clay";
+}
+}
+
+ECUtil::EncodeWorkers &ECUtil::EncodeWorkers::instance()
+{
+  static EncodeWorkers workers;
+  return workers;
+}
+
+void ECUtil::EncodeWorkers::start(unsigned num_threads, uint64_t _min_bytes)
+{
+  std::lock_guard l(lock);
+  ceph_assert(threads.empty());
+  stopping = false;
+  min_bytes = _min_bytes;
+  for (unsigned i = 0; i < num_threads; ++i) {
+    threads.push_back(make_named_thread("ec_encode", &EncodeWorkers::worker,
+					this));
+  }
+}
+
+void ECUtil::EncodeWorkers::stop()
+{
+  std::vector<std::thread> to_join;
+  {
+    std::lock_guard l(lock);
+    stopping = true;
+    to_join.swap(threads);
+  }
+  work_cond.notify_all();
+  for (auto &t : to_join) {
+    t.join();
+  }
+  ceph_assert(jobs.empty());
+}
+
+unsigned ECUtil::EncodeWorkers::get_batches(uint64_t bytes, uint64_t stripes)
+{
+  std::lock_guard l(lock);
+  if (threads.empty() || bytes < min_bytes)
+    return 1;
+  return std::min<uint64_t>(threads.size() + 1, stripes);
+}
+
+void ECUtil::EncodeWorkers::worker()
+{
+  std::unique_lock l(lock);
+  while (true) {
+    work_cond.wait(l, [this] { return stopping || !jobs.empty(); });
+    if (jobs.empty())
+      return;
+    job_t job = jobs.front();
+    jobs.pop_front();
+    l.unlock();
+    (*job.fn)(job.index);
+    l.lock();
+    if (--*job.pending == 0)
+      done_cond.notify_all();
+  }
+}
+
+void ECUtil::EncodeWorkers::parallel_for(
+  unsigned n,
+  const std::function<void(unsigned)> &fn)
+{
+  unsigned pending = n - 1;
+  {
+    std::unique_lock l(lock);
+    if (threads.empty()) {
+      // stopped since get_batches()
+      l.unlock();
+      for (unsigned i = 0; i < n; ++i) {
+	fn(i);
+      }
+      return;
+    }
+    for (unsigned i = 1; i < n; ++i) {
+      jobs.push_back(job_t{&fn, i, &pending});
+    }
+  }
+  work_cond.notify_all();
+  fn(0);
+  std::unique_lock l(lock);
+  done_cond.wait(l, [&pending] { return pending == 0; });
+}
+
 int ECUtil::encode(
   const stripe_info_t &sinfo,
   ErasureCodeInterfaceRef &ec_impl,
@@ -136,17 +276,67 @@ int ECUtil::encode(
   if (logical_size == 0)
     return 0;
 
-  for (uint64_t i = 0; i < logical_size; i += sinfo.get_stripe_width()) {
-    map<int, bufferlist> encoded;
-    bufferlist buf;
-    buf.substr_of(in, i, sinfo.get_stripe_width());
-    int r = ec_impl->encode(want, buf, &encoded);
-    ceph_assert(r == 0);
-    for (map<int, bufferlist>::iterator i = encoded.begin();
-	 i != encoded.end();
+  const uint64_t stripes = logical_size / sinfo.get_stripe_width();
+  unsigned batches = 1;
+  if (encode_is_reentrant(ec_impl->get_profile())) {
+    batches = EncodeWorkers::instance().get_batches(logical_size, stripes);
+  }
+  // encode the coding chunks of a whole batch into one buffer per shard
+  // rather than allocating a chunk for every stripe
+  set<int> coding;
+  if (encodes_into_provided_buffers(ec_impl->get_profile())) {
+    const vector<int> &mapping = ec_impl->get_chunk_mapping();
+    for (unsigned i = ec_impl->get_data_chunk_count();
+	 i < ec_impl->get_chunk_count();
 	 ++i) {
-      ceph_assert(i->second.length() == sinfo.get_chunk_size());
-      (*out)[i->first].claim_append(i->second);
+      int shard = i < mapping.size() ? mapping[i] : i;
+      if (want.count(shard))
+	coding.insert(shard);
+    }
+  }
+  vector<map<int, bufferlist>> batch_out(batches);
+  auto encode_batch = [&](unsigned b) {
+    const uint64_t first = stripes * b / batches;
+    const uint64_t last = stripes * (b + 1) / batches;
+    map<int, bufferptr> coding_bufs;
+    for (int shard : coding) {
+      coding_bufs[shard] = buffer::create_page_aligned(
+	(last - first) * sinfo.get_chunk_size());
+    }
+    for (uint64_t s = first; s < last; ++s) {
+      map<int, bufferlist> encoded;
+      for (auto &&[shard, bp] : coding_bufs) {
+	encoded[shard].append(
+	  bp, (s - first) * sinfo.get_chunk_size(), sinfo.get_chunk_size());
+      }
+      bufferlist buf;
+      buf.substr_of(in, s * sinfo.get_stripe_width(), sinfo.get_stripe_width());
+      int r = ec_impl->encode(want, buf, &encoded);
+      ceph_assert(r == 0);
+      for (map<int, bufferlist>::iterator i = encoded.begin();
+	   i != encoded.end();
+	   ++i) {
+	ceph_assert(i->second.length() == sinfo.get_chunk_size());
+	if (coding_bufs.count(i->first)) {
+	  // coalesces with the previous stripe's chunk when it was
+	  // encoded in place
+	  for (auto &&p : i->second.buffers()) {
+	    batch_out[b][i->first].append(p, 0, p.length());
+	  }
+	} else {
+	  batch_out[b][i->first].claim_append(i->second);
+	}
+      }
+    }
+  };
+  if (batches == 1) {
+    encode_batch(0);
+  } else {
+    EncodeWorkers::instance().parallel_for(batches, encode_batch);
+  }
+  for (auto &&b : batch_out) {
+    for (auto &&i : b) {
+      (*out)[i.first].claim_append(i.second);
     }
   }
 
@@ -161,20 +351,153 @@ int ECUtil::encode(
   return 0;
 }
 
+bool ECUtil::supports_parity_delta(const ceph::ErasureCodeProfile &profile)
+{
+  auto get = [&profile](const char *key, const char *def) {
+    auto i = profile.find(key);
+    return i == profile.end() ? string(def) : i->second;
+  };
+  const string plugin = get("plugin", "");
+  const string technique = get("technique", "reed_sol_van");
+  if (plugin == "jerasure") {
+    return technique == "reed_sol_van" || technique == "reed_sol_r6_op" ||
+      technique == "cauchy_orig" || technique == "cauchy_good";
+  }
+  if (plugin == "isa") {
+    return technique == "reed_sol_van" || technique == "cauchy";
+  }
+  return false;
+}
+
+// dst must not share its memory with anyone else
+static void xor_into(bufferlist &dst, const bufferlist &src)
+{
+  ceph_assert(dst.length() == src.length());
+  char *d = dst.c_str();
+  auto p = src.cbegin();
+  while (!p.end()) {
+    const char *s;
+    size_t l = p.get_ptr_and_advance(p.get_remaining(), &s);
+    for (size_t i = 0; i < l; ++i) {
+      d[i] ^= s[i];
+    }
+    d += l;
+  }
+}
+
+int ECUtil::encode_parity_delta(
+  const stripe_info_t &sinfo,
+  ErasureCodeInterfaceRef &ec_impl,
+  unsigned data_chunk,
+  const bufferlist &old_data,
+  const bufferlist &new_data,
+  map<int, bufferlist> *out)
+{
+  const uint64_t chunk_size = sinfo.get_chunk_size();
+  const unsigned k = ec_impl->get_data_chunk_count();
+  ceph_assert(data_chunk < k);
+  ceph_assert(old_data.length() == new_data.length());
+  ceph_assert(old_data.length() % chunk_size == 0);
+  ceph_assert(out);
+  ceph_assert(out->empty());
+
+  const vector<int> &mapping = ec_impl->get_chunk_mapping();
+  set<int> want;
+  for (unsigned i = k; i < ec_impl->get_chunk_count(); ++i) {
+    want.insert(i < mapping.size() ? mapping[i] : i);
+  }
+
+  // the code is linear: encode(new) ^ encode(old) == encode(new ^ old),
+  // and a stripe holding only that difference encodes to the parity delta
+  for (uint64_t off = 0; off < old_data.length(); off += chunk_size) {
+    bufferlist delta;
+    delta.substr_of(new_data, off, chunk_size);
+    delta.rebuild();
+    bufferlist old_chunk;
+    old_chunk.substr_of(old_data, off, chunk_size);
+    xor_into(delta, old_chunk);
+
+    bufferlist stripe;
+    stripe.append_zero(data_chunk * chunk_size);
+    stripe.claim_append(delta);
+    stripe.append_zero((k - data_chunk - 1) * chunk_size);
+
+    map<int, bufferlist> encoded;
+    int r = ec_impl->encode(want, stripe, &encoded);
+    if (r < 0) {
+      return r;
+    }
+    for (auto &&[shard, bl] : encoded) {
+      ceph_assert(bl.length() == chunk_size);
+      (*out)[shard].claim_append(bl);
+    }
+  }
+  return 0;
+}
+
+void ECUtil::apply_parity_delta(
+  const map<int, bufferlist> &delta,
+  map<int, bufferlist> *parity)
+{
+  for (auto &&[shard, bl] : delta) {
+    auto p = parity->find(shard);
+    ceph_assert(p != parity->end());
+    p->second.rebuild(); // the parity may come straight from a read buffer
+    xor_into(p->second, bl);
+  }
+}
+
+void ECUtil::HashInfo::append_batched(uint64_t size_to_append,
+				      map<int, bufferlist> &to_append) {
+  // every shard grows by the same amount, so all of the hashes can be
+  // updated in lockstep, one batch for each run of bytes that is
+  // contiguous in every shard's buffer
+  struct cursor_t {
+    bufferlist::buffers_t::const_iterator p;
+    unsigned off = 0;
+  };
+  std::vector<cursor_t> cursors;
+  std::vector<const unsigned char*> data(to_append.size());
+  std::vector<uint32_t> crcs;
+  cursors.reserve(to_append.size());
+  crcs.reserve(to_append.size());
+  for (auto& [shard, bl] : to_append) {
+    ceph_assert(size_to_append == bl.length());
+    ceph_assert((unsigned)shard < cumulative_shard_hashes.size());
+    cursors.push_back(cursor_t{bl.buffers().begin()});
+    crcs.push_back(cumulative_shard_hashes[shard]);
+  }
+  uint64_t remaining = size_to_append;
+  while (remaining) {
+    unsigned run = std::min<uint64_t>(remaining, UINT_MAX);
+    for (auto& c : cursors) {
+      while (c.off == c.p->length()) {
+	++c.p;
+	c.off = 0;
+      }
+      run = std::min(run, c.p->length() - c.off);
+    }
+    for (unsigned i = 0; i < cursors.size(); ++i) {
+      data[i] = reinterpret_cast<const unsigned char*>(cursors[i].p->c_str()) +
+	cursors[i].off;
+      cursors[i].off += run;
+    }
+    ceph_crc32c_multi(crcs.data(), data.data(), run, data.size());
+    remaining -= run;
+  }
+  auto crc = crcs.begin();
+  for (auto& [shard, bl] : to_append) {
+    cumulative_shard_hashes[shard] = *crc++;
+  }
+}
+
 void ECUtil::HashInfo::append(uint64_t old_size,
 			      map<int, bufferlist> &to_append) {
   ceph_assert(old_size == total_chunk_size);
   uint64_t size_to_append = to_append.begin()->second.length();
   if (has_chunk_hash()) {
     ceph_assert(to_append.size() == cumulative_shard_hashes.size());
-    for (map<int, bufferlist>::iterator i = to_append.begin();
-	 i != to_append.end();
-	 ++i) {
-      ceph_assert(size_to_append == i->second.length());
-      ceph_assert((unsigned)i->first < cumulative_shard_hashes.size());
-      uint32_t new_hash = i->second.crc32c(cumulative_shard_hashes[i->first]);
-      cumulative_shard_hashes[i->first] = new_hash;
-    }
+    append_batched(size_to_append, to_append);
   }
   total_chunk_size += size_to_append;
 }
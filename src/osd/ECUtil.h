@@ -15,12 +15,17 @@
 #ifndef ECUTIL_H
 #define ECUTIL_H
 
+#include <deque>
+#include <functional>
 #include <ostream>
+#include <set>
+#include <thread>
 #include "erasure-code/ErasureCodeInterface.h"
 #include "include/buffer_fwd.h"
 #include "include/ceph_assert.h"
 #include "include/encoding.h"
 #include "common/Formatter.h"
+#include "common/ceph_mutex.h"
 
 namespace ECUtil {
 
@@ -77,6 +82,28 @@ public:
       (in.first - off) + in.second);
     return std::make_pair(off, len);
   }
+  /// data chunk positions (0 to k-1) holding any byte of the logical range
+  std::set<int> offset_len_to_data_chunks(
+    std::pair<uint64_t, uint64_t> in) const {
+    const int k = stripe_width / chunk_size;
+    std::set<int> chunks;
+    if (in.second == 0) {
+      return chunks;
+    }
+    if (in.second >= stripe_width) {
+      for (int i = 0; i < k; ++i) {
+	chunks.insert(i);
+      }
+      return chunks;
+    }
+    int first = (in.first % stripe_width) / chunk_size;
+    int last = ((in.first + in.second - 1) % stripe_width) / chunk_size;
+    for (int i = first; i != last; i = (i + 1) % k) {
+      chunks.insert(i);
+    }
+    chunks.insert(last);
+    return chunks;
+  }
 };
 
 int decode(
@@ -91,6 +118,53 @@ int decode(
   std::map<int, ceph::buffer::list> &to_decode,
   std::map<int, ceph::buffer::list*> &out);
 
+/**
+ * Lay the data chunks in to_decode out as logical stripes without
+ * decoding.  Data chunks absent from to_decode read back as zeros, so
+ * only the ranges covered by the chunks present are meaningful.
+ */
+void concat_data_chunks(
+  const stripe_info_t &sinfo,
+  ceph::ErasureCodeInterfaceRef &ec_impl,
+  const std::map<int, ceph::buffer::list> &to_decode,
+  ceph::buffer::list *out);
+
+/**
+ * Threads encode() spreads the stripes of large buffers over, shared by
+ * every EC PG of the process.  While stopped (the default) encode runs
+ * inline on the caller.  Each call hands out at most one batch of
+ * stripes per thread and waits for them all on a single countdown, so
+ * wakeups do not grow with the number of stripes.
+ */
+class EncodeWorkers {
+  ceph::mutex lock = ceph::make_mutex("ECUtil::EncodeWorkers::lock");
+  ceph::condition_variable work_cond;
+  ceph::condition_variable done_cond;
+  struct job_t {
+    const std::function<void(unsigned)> *fn;
+    unsigned index;
+    unsigned *pending;
+  };
+  std::deque<job_t> jobs;
+  std::vector<std::thread> threads;
+  uint64_t min_bytes = 0;
+  bool stopping = false;
+
+  void worker();
+public:
+  ~EncodeWorkers() {
+    stop();
+  }
+  static EncodeWorkers &instance();
+
+  void start(unsigned num_threads, uint64_t min_bytes);
+  void stop();
+  /// number of batches to split an encode of bytes into, 1 if inline
+  unsigned get_batches(uint64_t bytes, uint64_t stripes);
+  /// run fn(0) ... fn(n - 1), fn(0) on the caller, and wait for them
+  void parallel_for(unsigned n, const std::function<void(unsigned)> &fn);
+};
+
 int encode(
   const stripe_info_t &sinfo,
   ceph::ErasureCodeInterfaceRef &ec_impl,
@@ -98,12 +172,41 @@ int encode(
   const std::set<int> &want,
   std::map<int, ceph::buffer::list> *out);
 
+/**
+ * Whether the code behind profile is linear, so that parity can be
+ * updated from the change to a single data chunk (jerasure and isa
+ * Reed-Solomon and Cauchy codes).
+ */
+bool supports_parity_delta(const ceph::ErasureCodeProfile &profile);
+
+/**
+ * Compute the change to every coding chunk caused by replacing old_data
+ * with new_data in the data chunk at position data_chunk (0 to k-1) of
+ * the stripes they span.  Both are chunk aligned and of equal length;
+ * *out is keyed by coding shard.  Only valid for linear codes.
+ */
+int encode_parity_delta(
+  const stripe_info_t &sinfo,
+  ceph::ErasureCodeInterfaceRef &ec_impl,
+  unsigned data_chunk,
+  const ceph::buffer::list &old_data,
+  const ceph::buffer::list &new_data,
+  std::map<int, ceph::buffer::list> *out);
+
+/// xor the deltas from encode_parity_delta() into the matching parity
+void apply_parity_delta(
+  const std::map<int, ceph::buffer::list> &delta,
+  std::map<int, ceph::buffer::list> *parity);
+
 class HashInfo {
   uint64_t total_chunk_size = 0;
   std::vector<uint32_t> cumulative_shard_hashes;
 
   // purely ephemeral, represents the size once all in-flight ops commit
   uint64_t projected_total_chunk_size = 0;
+
+  void append_batched(uint64_t size_to_append,
+                      std::map<int, ceph::buffer::list> &to_append);
 public:
   HashInfo() {}
   explicit HashInfo(unsigned num_chunks) :
@@ -220,6 +220,82 @@ void ExtentCache::present_rmw_update(
   }
 }
 
+std::atomic<uint64_t> ExtentCache::total_retained_bytes = 0;
+
+void ExtentCache::retain(
+  const hobject_t &oid,
+  const extent_map &extents,
+  uint64_t max_bytes)
+{
+  if (max_bytes == 0) {
+    invalidate_retained(oid);
+    return;
+  }
+  if (extents.empty()) {
+    return;
+  }
+  auto [p, inserted] = retained.try_emplace(oid);
+  retained_t &r = p->second;
+  if (inserted) {
+    retained_lru.push_front(oid);
+  } else {
+    retained_lru.splice(retained_lru.begin(), retained_lru, r.lru_pos);
+  }
+  r.lru_pos = retained_lru.begin();
+  r.data.insert(extents);
+
+  uint64_t bytes = r.data.get_interval_set().size();
+  retained_bytes += bytes - r.bytes;
+  total_retained_bytes += bytes - r.bytes;
+  r.bytes = bytes;
+
+  while (total_retained_bytes > max_bytes && !retained_lru.empty()) {
+    invalidate_retained(retained_lru.back());
+  }
+}
+
+std::optional<extent_map> ExtentCache::get_retained(
+  const hobject_t &oid,
+  const extent_set &to_read) const
+{
+  auto p = retained.find(oid);
+  if (p == retained.end()) {
+    return std::nullopt;
+  }
+  const extent_map &data = p->second.data;
+  extent_map ret;
+  for (auto &&e : to_read) {
+    auto range = data.get_containing_range(e.first, e.second);
+    if (range.first == range.second ||
+	range.first.get_off() > e.first ||
+	range.first.get_off() + range.first.get_len() < e.first + e.second) {
+      return std::nullopt;
+    }
+    ret.insert(data.intersect(e.first, e.second));
+  }
+  return ret;
+}
+
+void ExtentCache::invalidate_retained(const hobject_t &oid)
+{
+  auto p = retained.find(oid);
+  if (p == retained.end()) {
+    return;
+  }
+  retained_bytes -= p->second.bytes;
+  total_retained_bytes -= p->second.bytes;
+  retained_lru.erase(p->second.lru_pos);
+  retained.erase(p);
+}
+
+void ExtentCache::invalidate_all_retained()
+{
+  total_retained_bytes -= retained_bytes;
+  retained_bytes = 0;
+  retained.clear();
+  retained_lru.clear();
+}
+
 ostream &ExtentCache::print(ostream &out) const
 {
   out << "ExtentCache(" << std::endl;
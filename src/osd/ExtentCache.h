@@ -15,6 +15,7 @@
 #ifndef EXTENT_CACHE_H
 #define EXTENT_CACHE_H
 
+#include <atomic>
 #include <map>
 #include <list>
 #include <vector>
@@ -92,6 +93,14 @@
    All of the above suggests that there are 3 things users can
    ask of the cache corresponding to the 3 Write pipelines
    states.
+
+   Separately from the pinned extents, the cache can retain the data
+   written by committed writes so that a client read following a write
+   to the same stripes need not go back to the shards.  Retained data
+   is never used for rmw, it is LRU by object and bounded by a budget
+   shared by every ExtentCache in the process.  Users must invalidate
+   an object whenever its contents change other than by the written
+   extents they retain (truncate, delete, clone, interval change).
  */
 
 /// If someone wants these types, but not ExtentCache, move to another file
@@ -378,6 +387,17 @@ private:
     }
   };
 
+  struct retained_t {
+    extent_map data;
+    uint64_t bytes = 0;
+    std::list<hobject_t>::iterator lru_pos;
+  };
+  std::map<hobject_t, retained_t> retained;
+  std::list<hobject_t> retained_lru; ///< most recently written first
+  uint64_t retained_bytes = 0;
+  /// retained by every ExtentCache
+  static std::atomic<uint64_t> total_retained_bytes;
+
   void release_pin(pin_state &p) {
     for (auto iter = p.pin_list.begin(); iter != p.pin_list.end(); ) {
       std::unique_ptr<extent> extent(&*iter); // we now own this
@@ -481,6 +501,47 @@ public:
     release_pin(pin);
   }
 
+  ~ExtentCache() {
+    invalidate_all_retained();
+  }
+
+  /**
+   * Retain extents written to oid for later reads
+   *
+   * Overlays them on anything already retained for oid, then evicts
+   * least recently written objects while the process wide total is
+   * above max_bytes.
+   *
+   * @param oid [in] object
+   * @param extents [in] contents of oid once the write commits
+   * @param max_bytes [in] budget shared by all caches, 0 retains nothing
+   */
+  void retain(
+    const hobject_t &oid,
+    const extent_map &extents,
+    uint64_t max_bytes);
+
+  /**
+   * Retained contents of oid covering all of to_read
+   *
+   * @return nullopt unless every extent of to_read is retained
+   */
+  std::optional<extent_map> get_retained(
+    const hobject_t &oid,
+    const extent_set &to_read) const;
+
+  /// drop anything retained for oid
+  void invalidate_retained(const hobject_t &oid);
+
+  void invalidate_all_retained();
+
+  uint64_t get_retained_bytes() const {
+    return retained_bytes;
+  }
+  static uint64_t get_total_retained_bytes() {
+    return total_retained_bytes;
+  }
+
   std::ostream &print(std::ostream &out) const;
 };
 
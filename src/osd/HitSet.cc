@@ -33,6 +33,11 @@ HitSet::HitSet(const HitSet::Params& params)
     }
     break;
 
+  case TYPE_BLOCKED_BLOOM:
+    impl.reset(new BlockedBloomHitSet(
+		 static_cast<BloomHitSet::Params*>(params.impl.get())));
+    break;
+
   case TYPE_EXPLICIT_HASH:
     impl.reset(new ExplicitHashHitSet(static_cast<ExplicitHashHitSet::Params*>(params.impl.get())));
     break;
@@ -75,6 +80,9 @@ void HitSet::decode(ceph::buffer::list::const_iterator& bl)
   case TYPE_BLOOM:
     impl.reset(new BloomHitSet);
     break;
+  case TYPE_BLOCKED_BLOOM:
+    impl.reset(new BlockedBloomHitSet);
+    break;
   case TYPE_NONE:
     impl.reset(NULL);
     break;
@@ -101,6 +109,10 @@ void HitSet::generate_test_instances(list<HitSet*>& o)
   o.back()->insert(hobject_t());
   o.back()->insert(hobject_t("asdf", "", CEPH_NOSNAP, 123, 1, ""));
   o.back()->insert(hobject_t("qwer", "", CEPH_NOSNAP, 456, 1, ""));
+  o.push_back(new HitSet(new BlockedBloomHitSet(10, .1, 1)));
+  o.back()->insert(hobject_t());
+  o.back()->insert(hobject_t("asdf", "", CEPH_NOSNAP, 123, 1, ""));
+  o.back()->insert(hobject_t("qwer", "", CEPH_NOSNAP, 456, 1, ""));
   o.push_back(new HitSet(new ExplicitHashHitSet));
   o.back()->insert(hobject_t());
   o.back()->insert(hobject_t("asdf", "", CEPH_NOSNAP, 123, 1, ""));
@@ -162,6 +174,9 @@ bool HitSet::Params::create_impl(impl_type_t type)
   case TYPE_BLOOM:
     impl.reset(new BloomHitSet::Params);
     break;
+  case TYPE_BLOCKED_BLOOM:
+    impl.reset(new BlockedBloomHitSet::Params);
+    break;
   case TYPE_NONE:
     impl.reset(NULL);
     break;
@@ -203,6 +218,8 @@ void HitSet::Params::generate_test_instances(list<HitSet::Params*>& o)
   o.push_back(new Params);
   o.push_back(new Params(new BloomHitSet::Params));
   loop_hitset_params(BloomHitSet);
+  o.push_back(new Params(new BlockedBloomHitSet::Params));
+  loop_hitset_params(BlockedBloomHitSet);
   o.push_back(new Params(new ExplicitHashHitSet::Params));
   loop_hitset_params(ExplicitHashHitSet);
   o.push_back(new Params(new ExplicitObjectHitSet::Params));
@@ -254,3 +271,9 @@ void BloomHitSet::dump(Formatter *f) const {
   bloom.dump(f);
   f->close_section();
 }
+
+void BlockedBloomHitSet::dump(Formatter *f) const {
+  f->open_object_section("bloom_filter");
+  bloom.dump(f);
+  f->close_section();
+}
@@ -79,6 +79,7 @@
 #include "messages/MOSDMarkMeDead.h"
 #include "messages/MOSDFull.h"
 #include "messages/MOSDOp.h"
+#include "messages/MOSDOpBatch.h"
 #include "messages/MOSDOpReply.h"
 #include "messages/MOSDBackoff.h"
 #include "messages/MOSDBeacon.h"
@@ -139,6 +140,7 @@
 #include "perfglue/heap_profiler.h"
 
 #include "osd/ClassHandler.h"
+#include "osd/ECUtil.h"
 #include "osd/OpRequest.h"
 
 #include "auth/AuthAuthorizeHandler.h"
@@ -293,11 +295,13 @@ OSDService::OSDService(OSD *osd, ceph::async::io_context_pool& poolctx) :
   map_cache(cct, cct->_conf->osd_map_cache_size),
   map_bl_cache(cct->_conf->osd_map_cache_size),
   map_bl_inc_cache(cct->_conf->osd_map_cache_size),
+  map_msg_cache(cct->_conf->osd_map_share_cache_size),
   cur_state(NONE),
   cur_ratio(0), physical_ratio(0),
   boot_epoch(0), up_epoch(0), bind_epoch(0)
 {
   objecter->init();
+  remote_reserver.set_spread_owners(cct->_conf->osd_remote_reservation_spread);
 
   for (int i = 0; i < m_objecter_finishers; i++) {
     ostringstream str;
@@ -1399,6 +1403,22 @@ MOSDMap *OSDService::build_incremental_map_msg(epoch_t since, epoch_t to,
   int max = cct->_conf->osd_map_message_max;
   ssize_t max_bytes = cct->_conf->osd_map_message_max_bytes;
 
+  const bool use_cache = cct->_conf->osd_map_share_cache_size > 0;
+  const uint64_t cache_key = ((uint64_t)since << 32) | to;
+  if (use_cache) {
+    map_msg_contents_t cached;
+    if (map_msg_cache.lookup(cache_key, &cached) &&
+	cached.oldest_map == m->oldest_map) {
+      dout(20) << __func__ << " " << since << ".." << to
+	       << " from share cache" << dendl;
+      logger->inc(l_osd_map_msg_cache_hit);
+      m->maps = std::move(cached.maps);
+      m->incremental_maps = std::move(cached.incremental_maps);
+      return m;
+    }
+    logger->inc(l_osd_map_msg_cache_miss);
+  }
+
   if (since < m->oldest_map) {
     // we don't have the next map the target wants, so start with a
     // full map.
@@ -1432,6 +1452,12 @@ MOSDMap *OSDService::build_incremental_map_msg(epoch_t since, epoch_t to,
       break;
     }
   }
+  if (use_cache) {
+    // the buffers are shared, not copied
+    map_msg_cache.add(cache_key,
+		      map_msg_contents_t{m->oldest_map, m->maps,
+					 m->incremental_maps});
+  }
   return m;
 
  panic:
@@ -2341,6 +2367,8 @@ OSD::OSD(CephContext *cct_,
                                            cct->_conf->osd_op_history_duration);
   op_tracker.set_history_slow_op_size_and_threshold(cct->_conf->osd_op_history_slow_op_size,
                                                     cct->_conf->osd_op_history_slow_op_threshold);
+  op_tracker.set_sample_rate(
+    cct->_conf.get_val<uint64_t>("osd_op_tracker_sample_rate"));
   ObjectCleanRegions::set_max_num_intervals(cct->_conf->osd_object_clean_region_max_num_intervals);
 #ifdef WITH_BLKIN
   std::stringstream ss;
@@ -3869,6 +3897,9 @@ int OSD::init()
   }
 
   osd_op_tp.start();
+  ECUtil::EncodeWorkers::instance().start(
+    cct->_conf.get_val<uint64_t>("osd_ec_encode_threads"),
+    cct->_conf.get_val<Option::size_t>("osd_ec_encode_parallel_min_bytes"));
 
   // start the heartbeat
   heartbeat_thread.create("osd_srv_heartbt");
@@ -4504,6 +4535,7 @@ int OSD::shutdown()
 
   osd_op_tp.drain();
   osd_op_tp.stop();
+  ECUtil::EncodeWorkers::instance().stop();
   dout(10) << "op sharded tp stopped" << dendl;
 
   dout(10) << "stopping agent" << dendl;
@@ -5687,7 +5719,11 @@ void OSD::handle_osd_ping(MOSDPing *m)
 
 #define ROUND_S_TO_USEC(sec) (uint32_t)((sec) * 1000 * 1000 + 0.5)
 	    ++i->second.hb_average_count;
-	    uint32_t back_pingtime = ROUND_S_TO_USEC(i->second.last_rx_back - m->ping_stamp);
+	    // with osd_heartbeat_piggyback this round may have had no back
+	    // ping; count the front round trip for both sides then
+	    uint32_t back_pingtime = ROUND_S_TO_USEC(
+	      (i->second.last_rx_back >= m->ping_stamp ?
+	       i->second.last_rx_back : i->second.last_rx_front) - m->ping_stamp);
 	    i->second.hb_total_back += back_pingtime;
 	    if (back_pingtime < i->second.hb_min_back)
 	      i->second.hb_min_back = back_pingtime;
@@ -5951,6 +5987,7 @@ void OSD::heartbeat()
   if (load_for_logger) {
     logger->set(l_osd_loadavg, load_for_logger.value());
   }
+  service.get_scrub_services().update_io_load(op_tracker.get_num_ops_in_flight());
   dout(30) << "heartbeat checking stats" << dendl;
 
   // refresh peer list and osd stats
@@ -5986,27 +6023,46 @@ void OSD::heartbeat()
     }
     dout(30) << "heartbeat sending ping to osd." << peer << dendl;
 
+    // recent replication traffic from the peer stands in for the
+    // back-side reply; we still need a real one first, and a front con
+    // to carry this round's ping
+    bool piggyback = false;
+    if (cct->_conf->osd_heartbeat_piggyback &&
+	i->second.con_front &&
+	i->second.last_rx_back != utime_t()) {
+      uint64_t ns = s->stamps->last_rx_data;
+      utime_t rx_data(ns / 1000000000, ns % 1000000000);
+      if (rx_data > i->second.last_rx_back &&
+	  now - rx_data < cct->_conf->osd_heartbeat_interval) {
+	dout(30) << "heartbeat osd." << peer << " data rx " << rx_data
+		 << ", skipping back ping" << dendl;
+	i->second.last_rx_back = rx_data;
+	piggyback = true;
+      }
+    }
+
     i->second.last_tx = now;
     if (i->second.first_tx == utime_t())
       i->second.first_tx = now;
     i->second.ping_history[now] = make_pair(deadline,
-      HeartbeatInfo::HEARTBEAT_MAX_CONN);
+      HeartbeatInfo::HEARTBEAT_MAX_CONN - (piggyback ? 1 : 0));
     if (i->second.hb_interval_start == utime_t())
       i->second.hb_interval_start = now;
 
     std::optional<ceph::signedspan> delta_ub;
     s->stamps->sent_ping(&delta_ub);
 
-    i->second.con_back->send_message(
-      new MOSDPing(monc->get_fsid(),
-		   service.get_osdmap_epoch(),
-		   MOSDPing::PING,
-		   now,
-		   mnow,
-		   mnow,
-		   service.get_up_epoch(),
-		   cct->_conf->osd_heartbeat_min_size,
-		   delta_ub));
+    if (!piggyback)
+      i->second.con_back->send_message(
+	new MOSDPing(monc->get_fsid(),
+		     service.get_osdmap_epoch(),
+		     MOSDPing::PING,
+		     now,
+		     mnow,
+		     mnow,
+		     service.get_up_epoch(),
+		     cct->_conf->osd_heartbeat_min_size,
+		     delta_ub));
 
     if (i->second.con_front)
       i->second.con_front->send_message(
@@ -7322,6 +7378,9 @@ void OSD::ms_fast_dispatch(Message *m)
   case MSG_OSD_SCRUB2:
     handle_fast_scrub(static_cast<MOSDScrub2*>(m));
     return;
+  case CEPH_MSG_OSD_OP_BATCH:
+    handle_fast_op_batch(static_cast<MOSDOpBatch*>(m));
+    return;
   case MSG_OSD_PG_CREATE2:
     return handle_fast_pg_create(static_cast<MOSDPGCreate2*>(m));
   case MSG_OSD_PG_NOTIFY:
@@ -7352,6 +7411,18 @@ void OSD::ms_fast_dispatch(Message *m)
     }
   }
 
+  if (cct->_conf->osd_heartbeat_piggyback && m->get_source().is_osd()) {
+    // messages on a connection are fast-dispatched one at a time, so
+    // the session needs no locking here
+    auto priv = m->get_connection()->get_priv();
+    if (auto session = static_cast<Session*>(priv.get()); session) {
+      if (!session->stamps) {
+	session->stamps = service.get_hb_stamps(m->get_source().num());
+      }
+      session->stamps->last_rx_data = ceph_clock_now().to_nsec();
+    }
+  }
+
   OpRequestRef op = op_tracker.create_request<OpRequest, Message*>(m);
   {
 #ifdef WITH_LTTNG
@@ -7467,6 +7538,30 @@ void OSD::_dispatch(Message *m)
   }
 }
 
+void OSD::handle_fast_op_batch(MOSDOpBatch *m)
+{
+  dout(20) << __func__ << " " << *m << " from " << m->get_source() << dendl;
+  // the ops share the batch's buffers and messenger throttle budget, so
+  // keep the batch around until the last of them is gone
+  class C_PutBatch : public Message::CompletionHook {
+    ceph::ref_t<MOSDOpBatch> batch;
+  public:
+    C_PutBatch(Message *op, ceph::ref_t<MOSDOpBatch> batch)
+      : CompletionHook(op), batch(std::move(batch)) {}
+    void finish(int) override {}
+  };
+  auto ops = std::move(m->ops);
+  for (auto& op : ops) {
+    op->set_connection(m->get_connection());
+    op->set_recv_stamp(m->get_recv_stamp());
+    op->set_throttle_stamp(m->get_throttle_stamp());
+    op->set_recv_complete_stamp(m->get_recv_complete_stamp());
+    op->set_completion_hook(new C_PutBatch(op.get(), ceph::ref_t<MOSDOpBatch>(m)));
+    ms_fast_dispatch(op.detach());
+  }
+  m->put();
+}
+
 void OSD::handle_fast_scrub(MOSDScrub2 *m)
 {
   dout(10) << __func__ <<  " " << *m << dendl;
@@ -8024,14 +8119,26 @@ void OSD::handle_osd_map(MOSDMap *m)
 
       OSDMap *o = new OSDMap;
       if (e > 1) {
-	bufferlist obl;
-        bool got = get_map_bl(e - 1, obl);
-	if (!got) {
-	  auto p = added_maps_bl.find(e - 1);
-	  ceph_assert(p != added_maps_bl.end());
-	  obl = p->second;
+	// start from the previous epoch in memory if we have it, sharing
+	// whatever this incremental leaves untouched
+	OSDMapRef prev;
+	if (auto q = added_maps.find(e - 1); q != added_maps.end()) {
+	  prev = q->second;
+	} else {
+	  prev = service.try_get_map(e - 1);
+	}
+	if (prev) {
+	  o->shallow_copy_from(*prev);
+	} else {
+	  bufferlist obl;
+	  bool got = get_map_bl(e - 1, obl);
+	  if (!got) {
+	    auto p = added_maps_bl.find(e - 1);
+	    ceph_assert(p != added_maps_bl.end());
+	    obl = p->second;
+	  }
+	  o->decode(obl);
 	}
-	o->decode(obl);
       }
 
       OSDMap::Incremental inc;
@@ -9029,9 +9136,7 @@ void OSD::dispatch_context(PeeringCtx &ctx, PG *pg, OSDMapRef curmap,
 	continue;
       }
       service.maybe_share_map(con.get(), curmap);
-      for (auto m : ls) {
-	con->send_message2(m);
-      }
+      service.send_peering_messages(osd, con, curmap->get_epoch(), ls);
       ls.clear();
     }
   }
@@ -9044,6 +9149,99 @@ void OSD::dispatch_context(PeeringCtx &ctx, PG *pg, OSDMapRef curmap,
   }
 }
 
+void OSDService::send_peering_messages(
+  int osd,
+  const ConnectionRef& con,
+  epoch_t epoch,
+  std::vector<MessageRef>& ls)
+{
+  auto max = cct->_conf.get_val<uint64_t>("osd_peering_batch_max");
+  std::lock_guard l(peering_batch_lock);
+  auto& b = peering_batches[osd];
+  if (b.con != con) {
+    _send_peering_batch(b);
+    b.con = con;
+  }
+  b.epoch = std::max(b.epoch, epoch);
+  auto batchable_info = [](const MessageRef& m) {
+    if (m->get_type() != MSG_OSD_PG_INFO2) {
+      return false;
+    }
+    // MOSDPGInfo has no room for leases
+    auto i = static_cast<const MOSDPGInfo2*>(m.get());
+    return !i->lease && !i->lease_ack;
+  };
+  for (auto& m : ls) {
+    if (max && m->get_type() == MSG_OSD_PG_NOTIFY2) {
+      b.notifies.push_back(static_cast<MOSDPGNotify2*>(m.get())->notify);
+    } else if (max && batchable_info(m)) {
+      auto i = static_cast<MOSDPGInfo2*>(m.get());
+      b.infos.emplace_back(i->spgid.shard, i->info.pgid.shard,
+			   i->min_epoch, i->epoch_sent, i->info,
+			   PastIntervals());
+    } else {
+      _send_peering_batch(b);
+      con->send_message2(m);
+      continue;
+    }
+    if (b.size() >= max) {
+      _send_peering_batch(b);
+    }
+  }
+  if (b.size() && !peering_batch_flush_queued) {
+    peering_batch_flush_queued = true;
+    mono_timer.add_event(
+      ceph::make_timespan(
+	cct->_conf.get_val<double>("osd_peering_batch_delay")),
+      [this]() {
+	flush_peering_batches();
+      });
+  }
+}
+
+void OSDService::_send_peering_batch(PeeringBatch& b)
+{
+  ceph_assert(ceph_mutex_is_locked_by_me(peering_batch_lock));
+  if (!b.con) {
+    return;
+  }
+  // a lone message goes out in its usual single-PG form
+  if (b.notifies.size() == 1 && b.infos.empty()) {
+    auto& n = b.notifies.front();
+    b.con->send_message2(make_message<MOSDPGNotify2>(
+      spg_t(n.info.pgid.pgid, n.to), n));
+  } else if (!b.notifies.empty()) {
+    b.con->send_message2(make_message<MOSDPGNotify>(
+      b.epoch, std::move(b.notifies)));
+  }
+  if (b.infos.size() == 1) {
+    auto& i = b.infos.front();
+    b.con->send_message2(make_message<MOSDPGInfo2>(
+      spg_t(i.info.pgid.pgid, i.to), i.info, i.epoch_sent, i.query_epoch,
+      std::nullopt, std::nullopt));
+  } else if (!b.infos.empty()) {
+    b.con->send_message2(make_message<MOSDPGInfo>(
+      b.epoch, std::move(b.infos)));
+  }
+  b.notifies.clear();
+  b.infos.clear();
+}
+
+void OSDService::flush_peering_batches()
+{
+  std::lock_guard l(peering_batch_lock);
+  peering_batch_flush_queued = false;
+  for (auto p = peering_batches.begin(); p != peering_batches.end(); ) {
+    if (p->second.size()) {
+      _send_peering_batch(p->second);
+      ++p;
+    } else {
+      // nothing pending; let the connection go
+      p = peering_batches.erase(p);
+    }
+  }
+}
+
 void OSD::handle_fast_pg_create(MOSDPGCreate2 *m)
 {
   dout(7) << __func__ << " " << *m << " from " << m->get_source() << dendl;
@@ -9123,7 +9321,7 @@ void OSD::handle_fast_pg_notify(MOSDPGNotify* m)
 	  true,
 	  new PGCreateInfo(
 	    pgid,
-	    p.query_epoch,
+	    p.epoch_sent,  // as MOSDPGNotify2 does
 	    p.info.history,
 	    p.past_intervals,
 	    false)
@@ -9526,11 +9724,48 @@ void OSD::enqueue_op(spg_t pg, OpRequestRef&& op, epoch_t epoch)
         unique_ptr<OpSchedulerItem::OpQueueable>(new PGRecoveryMsg(pg, std::move(op))),
         cost, priority, stamp, owner, epoch));
   } else {
-    op_shardedwq.queue(
-      OpSchedulerItem(
-        unique_ptr<OpSchedulerItem::OpQueueable>(new PGOpItem(pg, std::move(op))),
-        cost, priority, stamp, owner, epoch));
-  }
+    OpSchedulerItem::qos_profile_t qos_profile;
+    if (type == CEPH_MSG_OSD_OP) {
+      qos_profile = get_qos_profile(pg, op);
+    }
+    OpSchedulerItem item(
+      unique_ptr<OpSchedulerItem::OpQueueable>(new PGOpItem(pg, std::move(op))),
+      cost, priority, stamp, owner, epoch);
+    item.set_qos_profile(std::move(qos_profile));
+    op_shardedwq.queue(std::move(item));
+  }
+}
+
+OpSchedulerItem::qos_profile_t OSD::get_qos_profile(spg_t pg, OpRequestRef& op)
+{
+  OpSchedulerItem::qos_profile_t profile;
+  auto curmap = get_osdmap();
+  const pg_pool_t *pi = curmap ? curmap->get_pg_pool(pg.pool()) : nullptr;
+  if (!pi) {
+    return profile;
+  }
+  int64_t res = 0, wgt = 0, lim = 0;
+  pi->opts.get(pool_opts_t::MCLOCK_RES, &res);
+  pi->opts.get(pool_opts_t::MCLOCK_WGT, &wgt);
+  pi->opts.get(pool_opts_t::MCLOCK_LIM, &lim);
+  if (res <= 0 && wgt <= 0 && lim <= 0) {
+    return profile;
+  }
+  // the namespace is only known after the final decode, which do_op would
+  // otherwise do once the op is dequeued
+  MOSDOp *m = static_cast<MOSDOp*>(op->get_nonconst_req());
+  if (m->finish_decode()) {
+    op->reset_desc();   // for TrackedOp
+    m->clear_payload();
+  }
+  profile.pool = pg.pool();
+  profile.nspace = m->get_hobj().nspace;
+  profile.id = (static_cast<uint64_t>(profile.pool + 1) << 32) |
+    ceph_str_hash_rjenkins(profile.nspace.c_str(), profile.nspace.length());
+  profile.res = std::max<int64_t>(res, 0);
+  profile.wgt = std::max<int64_t>(wgt, 0);
+  profile.lim = std::max<int64_t>(lim, 0);
+  return profile;
 }
 
 void OSD::enqueue_peering_evt(spg_t pgid, PGPeeringEventRef evt)
@@ -9650,6 +9885,7 @@ const char** OSD::get_tracked_conf_keys() const
   static const char* KEYS[] = {
     "osd_max_backfills",
     "osd_min_recovery_priority",
+    "osd_remote_reservation_spread",
     "osd_max_trimming_pgs",
     "osd_op_complaint_time",
     "osd_op_log_threshold",
@@ -9658,7 +9894,9 @@ const char** OSD::get_tracked_conf_keys() const
     "osd_op_history_slow_op_size",
     "osd_op_history_slow_op_threshold",
     "osd_enable_op_tracker",
+    "osd_op_tracker_sample_rate",
     "osd_map_cache_size",
+    "osd_map_share_cache_size",
     "osd_pg_epoch_max_lag_factor",
     "osd_pg_epoch_persisted_max_stale",
     "osd_recovery_sleep",
@@ -9736,6 +9974,10 @@ void OSD::handle_conf_change(const ConfigProxy& conf,
     service.local_reserver.set_min_priority(cct->_conf->osd_min_recovery_priority);
     service.remote_reserver.set_min_priority(cct->_conf->osd_min_recovery_priority);
   }
+  if (changed.count("osd_remote_reservation_spread")) {
+    service.remote_reserver.set_spread_owners(
+      cct->_conf->osd_remote_reservation_spread);
+  }
   if (changed.count("osd_max_trimming_pgs")) {
     service.snap_reserver.set_max(cct->_conf->osd_max_trimming_pgs);
   }
@@ -9757,11 +9999,18 @@ void OSD::handle_conf_change(const ConfigProxy& conf,
   if (changed.count("osd_enable_op_tracker")) {
       op_tracker.set_tracking(cct->_conf->osd_enable_op_tracker);
   }
+  if (changed.count("osd_op_tracker_sample_rate")) {
+    op_tracker.set_sample_rate(
+      cct->_conf.get_val<uint64_t>("osd_op_tracker_sample_rate"));
+  }
   if (changed.count("osd_map_cache_size")) {
     service.map_cache.set_size(cct->_conf->osd_map_cache_size);
     service.map_bl_cache.set_size(cct->_conf->osd_map_cache_size);
     service.map_bl_inc_cache.set_size(cct->_conf->osd_map_cache_size);
   }
+  if (changed.count("osd_map_share_cache_size")) {
+    service.map_msg_cache.set_size(cct->_conf->osd_map_share_cache_size);
+  }
   if (changed.count("clog_to_monitors") ||
       changed.count("clog_to_syslog") ||
       changed.count("clog_to_syslog_level") ||
@@ -10182,12 +10431,14 @@ MetricPayload OSD::get_perf_reports() {
   std::vector<PGRef> pgs;
   _get_pgs(&pgs);
   DynamicPerfStats dps;
+  dps.set_max_keys(cct->_conf->osd_perf_query_max_keys);
   for (auto& pg : pgs) {
     // m_perf_queries can be modified only in set_perf_queries by mgr client
     // request, and it is protected by by mgr client's lock, which is held
     // when set_perf_queries/get_perf_reports are called, so we may not hold
     // m_perf_queries_lock here.
-    DynamicPerfStats pg_dps(m_perf_queries);
+    DynamicPerfStats pg_dps(m_perf_queries,
+                            cct->_conf->osd_perf_query_max_keys);
     pg->lock();
     pg->get_dynamic_perf_stats(&pg_dps);
     pg->unlock();
@@ -10413,6 +10664,7 @@ int OSDShard::_wake_pg_slot(
   }
   slot->waiting_peering.clear();
   ++slot->requeue_seq;
+  queue_depth += count;
   return count;
 }
 
@@ -10670,10 +10922,39 @@ void OSD::ShardedOpWQ::_add_slot_waiter(
 #undef dout_prefix
 #define dout_prefix *_dout << "osd." << osd->whoami << " op_wq(" << shard_index << ") "
 
+OSDShard *OSD::ShardedOpWQ::_try_steal(uint32_t shard_index)
+{
+  // pick the most backlogged shard; depths are sampled without locks and
+  // only need to be roughly right
+  uint32_t min_depth = std::max<uint32_t>(
+    1, osd->cct->_conf->osd_op_queue_steal_min_depth);
+  OSDShard *victim = nullptr;
+  uint32_t victim_depth = 0;
+  for (uint32_t i = 1; i < osd->num_shards; ++i) {
+    OSDShard *s = osd->shards[(shard_index + i) % osd->num_shards];
+    uint32_t depth = s->queue_depth.load(std::memory_order_relaxed);
+    if (depth >= min_depth && depth > victim_depth) {
+      victim = s;
+      victim_depth = depth;
+    }
+  }
+  // never block on a busy shard's lock; just try again later
+  if (!victim || !victim->shard_lock.try_lock()) {
+    return nullptr;
+  }
+  if (victim->scheduler->empty()) {
+    victim->shard_lock.unlock();
+    return nullptr;
+  }
+  dout(20) << __func__ << " shard " << shard_index << " helping shard "
+	   << victim->shard_id << " depth " << victim_depth << dendl;
+  return victim;
+}
+
 void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
 {
   uint32_t shard_index = thread_index % osd->num_shards;
-  auto& sdata = osd->shards[shard_index];
+  OSDShard *sdata = osd->shards[shard_index];
   ceph_assert(sdata);
 
   // If all threads of shards do oncommits, there is a out-of-order
@@ -10681,9 +10962,26 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
   // thread_index(thread_index < num_shards) of shard to do oncommit
   // callback.
   bool is_smallest_thread_index = thread_index < osd->num_shards;
+  bool work_stealing = osd->cct->_conf->osd_op_queue_work_stealing &&
+    osd->num_shards > 1;
+  OSDShard *home = sdata;
 
   // peek at spg_t
   sdata->shard_lock.lock();
+  if (work_stealing &&
+      sdata->scheduler->empty() &&
+      (!is_smallest_thread_index || sdata->context_queue.empty())) {
+    // Our shard is idle; help a busy one by acting as one of its threads
+    // for a single item.  The item goes through the victim's pg slot just
+    // like it would for the victim's own threads, so per-PG ordering holds.
+    sdata->shard_lock.unlock();
+    if (OSDShard *victim = _try_steal(shard_index); victim) {
+      sdata = victim;
+      is_smallest_thread_index = false;
+    } else {
+      sdata->shard_lock.lock();
+    }
+  }
   if (sdata->scheduler->empty() &&
       (!is_smallest_thread_index || sdata->context_queue.empty())) {
     std::unique_lock wait_lock{sdata->sdata_wait_lock};
@@ -10694,7 +10992,14 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
       dout(20) << __func__ << " empty q, waiting" << dendl;
       osd->cct->get_heartbeat_map()->clear_timeout(hb);
       sdata->shard_lock.unlock();
-      sdata->sdata_cond.wait(wait_lock);
+      if (work_stealing) {
+	// wake up now and then to look for work on other shards
+	sdata->sdata_cond.wait_for(
+	  wait_lock,
+	  ceph::make_timespan(osd->cct->_conf->osd_op_queue_steal_poll_interval));
+      } else {
+	sdata->sdata_cond.wait(wait_lock);
+      }
       wait_lock.unlock();
       sdata->shard_lock.lock();
       if (sdata->scheduler->empty() &&
@@ -10735,6 +11040,14 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
     }
 
     work_item = sdata->scheduler->dequeue();
+    if (std::get_if<OpSchedulerItem>(&work_item)) {
+      --sdata->queue_depth;
+      if (sdata != home) {
+	++sdata->num_stolen;
+	++home->num_steals;
+	osd->logger->inc(l_osd_op_wq_steals);
+      }
+    }
     if (osd->is_stopping()) {
       sdata->shard_lock.unlock();
       for (auto c : oncommits) {
@@ -10747,6 +11060,11 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
     // If the work item is scheduled in the future, wait until
     // the time returned in the dequeue response before retrying.
     if (auto when_ready = std::get_if<double>(&work_item)) {
+      if (sdata != home) {
+	// leave future work to the shard's own threads
+	sdata->shard_lock.unlock();
+	return;
+      }
       if (is_smallest_thread_index) {
         sdata->shard_lock.unlock();
         handle_oncommits(oncommits);
@@ -11030,6 +11348,7 @@ void OSD::ShardedOpWQ::_enqueue(OpSchedulerItem&& item) {
     std::lock_guard l{sdata->shard_lock};
     empty = sdata->scheduler->empty();
     sdata->scheduler->enqueue(std::move(item));
+    ++sdata->queue_depth;
   }
 
   {
@@ -11070,6 +11389,7 @@ void OSD::ShardedOpWQ::_enqueue_front(OpSchedulerItem&& item)
     dout(20) << __func__ << " " << item << dendl;
   }
   sdata->scheduler->enqueue_front(std::move(item));
+  ++sdata->queue_depth;
   sdata->shard_lock.unlock();
   std::lock_guard l{sdata->sdata_wait_lock};
   sdata->sdata_cond.notify_one();
@@ -11089,6 +11409,7 @@ void OSD::ShardedOpWQ::stop_for_fast_shutdown()
       auto work_item = sdata->scheduler->dequeue();
       work_count++;
     }
+    sdata->queue_depth = 0;
     sdata->shard_lock.unlock();
   }
 }
@@ -671,6 +671,15 @@ public:
   SimpleLRU<epoch_t, ceph::buffer::list> map_bl_cache;
   SimpleLRU<epoch_t, ceph::buffer::list> map_bl_inc_cache;
 
+  // contents of recently built MOSDMaps, keyed by (since << 32 | to), so
+  // that peers lagging by the same range share a single gather
+  struct map_msg_contents_t {
+    epoch_t oldest_map = 0;
+    std::map<epoch_t, ceph::buffer::list> maps;
+    std::map<epoch_t, ceph::buffer::list> incremental_maps;
+  };
+  SimpleLRU<uint64_t, map_msg_contents_t> map_msg_cache;
+
   OSDMapRef try_get_map(epoch_t e);
   OSDMapRef get_map(epoch_t e) {
     OSDMapRef ret(try_get_map(e));
@@ -841,6 +850,32 @@ public:
 
   void queue_renew_lease(epoch_t epoch, spg_t spgid);
 
+  // -- batched peering messages --
+private:
+  /// notifies and infos headed for one peer, across PGs
+  struct PeeringBatch {
+    ConnectionRef con;
+    epoch_t epoch = 0;
+    std::vector<pg_notify_t> notifies;
+    std::vector<pg_notify_t> infos;
+    size_t size() const {
+      return notifies.size() + infos.size();
+    }
+  };
+  ceph::mutex peering_batch_lock =
+    ceph::make_mutex("OSDService::peering_batch_lock");
+  std::map<int, PeeringBatch> peering_batches;
+  bool peering_batch_flush_queued = false;
+
+  void _send_peering_batch(PeeringBatch& b);
+  void flush_peering_batches();
+public:
+  /// send peering messages for osd, folding notifies and infos into
+  /// per-peer batches; the batch is flushed ahead of anything else so
+  /// per-connection ordering is preserved
+  void send_peering_messages(int osd, const ConnectionRef& con, epoch_t epoch,
+			     std::vector<MessageRef>& ls);
+
   // -- stopping --
   ceph::mutex is_stopping_lock = ceph::make_mutex("OSDService::is_stopping_lock");
   ceph::condition_variable is_stopping_cond;
@@ -1001,6 +1036,12 @@ struct OSDShard {
   /// priority queue
   ceph::osd::scheduler::OpSchedulerRef scheduler;
 
+  /// number of items in scheduler.  updated under shard_lock, read without
+  /// it by idle threads of other shards looking for work to steal.
+  std::atomic<uint32_t> queue_depth = {0};
+  std::atomic<uint64_t> num_steals = {0};  ///< items our threads took from other shards
+  std::atomic<uint64_t> num_stolen = {0};  ///< our items run by other shards' threads
+
   bool stop_waiting = false;
 
   ContextQueue context_queue;
@@ -1570,6 +1611,9 @@ protected:
       OSDShardPGSlot *slot,
       OpSchedulerItem&& qi);
 
+    /// find a busy shard to help out; returns it with shard_lock held
+    OSDShard *_try_steal(uint32_t shard_index);
+
     /// try to do some work
     void _process(uint32_t thread_index, ceph::heartbeat_handle_d *hb) override;
 
@@ -1610,6 +1654,9 @@ protected:
 
 	std::scoped_lock l{sdata->shard_lock};
 	f->open_object_section(queue_name);
+	f->dump_unsigned("queue_depth", sdata->queue_depth);
+	f->dump_unsigned("steals", sdata->num_steals);
+	f->dump_unsigned("stolen", sdata->num_stolen);
 	sdata->scheduler->dump(*f);
 	f->close_section();
       }
@@ -1636,6 +1683,8 @@ protected:
 
 
   void enqueue_op(spg_t pg, OpRequestRef&& op, epoch_t epoch);
+  /// mclock profile for a client op from its pool's options, if it has any
+  OpSchedulerItem::qos_profile_t get_qos_profile(spg_t pg, OpRequestRef& op);
   void dequeue_op(
     PGRef pg, OpRequestRef op,
     ThreadPool::TPHandle &handle);
@@ -1883,6 +1932,7 @@ private:
     switch (m->get_type()) {
     case CEPH_MSG_PING:
     case CEPH_MSG_OSD_OP:
+    case CEPH_MSG_OSD_OP_BATCH:
     case CEPH_MSG_OSD_BACKOFF:
     case MSG_OSD_SCRUB2:
     case MSG_OSD_FORCE_RECOVERY:
@@ -1980,6 +2030,7 @@ private:
 			uuid_d& cluster_fsid, uuid_d& osd_fsid, int whoami, std::string& osdspec_affinity);
 
   void handle_fast_scrub(class MOSDScrub2 *m);
+  void handle_fast_op_batch(class MOSDOpBatch *m);
   void handle_osd_ping(class MOSDPing *m);
 
   size_t get_num_cache_shards();
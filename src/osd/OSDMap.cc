@@ -16,9 +16,11 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <bit>
 #include <optional>
 #include <random>
+#include <thread>
 #include <fmt/format.h>
 
 #include <boost/algorithm/string.hpp>
@@ -1869,10 +1871,16 @@ void OSDMap::dedup(const OSDMap *o, OSDMap *n)
 
   int diff = 0;
 
+  // n may already share components with o (see shallow_copy_from()), or
+  // with some other epoch.  Never write through a pointer someone else
+  // holds: readers of cached maps do not take any lock.
+  bool addrs_private = n->osd_addrs != o->osd_addrs &&
+    n->osd_addrs.use_count() == 1;
+
   // do addrs match?
   if (o->max_osd != n->max_osd)
     diff++;
-  for (int i = 0; i < o->max_osd && i < n->max_osd; i++) {
+  for (int i = 0; addrs_private && i < o->max_osd && i < n->max_osd; i++) {
     if ( n->osd_addrs->client_addrs[i] &&  o->osd_addrs->client_addrs[i] &&
 	*n->osd_addrs->client_addrs[i] == *o->osd_addrs->client_addrs[i])
       n->osd_addrs->client_addrs[i] = o->osd_addrs->client_addrs[i];
@@ -1894,31 +1902,35 @@ void OSDMap::dedup(const OSDMap *o, OSDMap *n)
     else
       diff++;
   }
-  if (diff == 0) {
+  if (addrs_private && diff == 0) {
     // zoinks, no differences at all!
     n->osd_addrs = o->osd_addrs;
   }
 
   // does crush match?
-  ceph::buffer::list oc, nc;
-  encode(*o->crush, oc, CEPH_FEATURES_SUPPORTED_DEFAULT);
-  encode(*n->crush, nc, CEPH_FEATURES_SUPPORTED_DEFAULT);
-  if (oc.contents_equal(nc)) {
-    n->crush = o->crush;
+  if (n->crush != o->crush) {
+    ceph::buffer::list oc, nc;
+    encode(*o->crush, oc, CEPH_FEATURES_SUPPORTED_DEFAULT);
+    encode(*n->crush, nc, CEPH_FEATURES_SUPPORTED_DEFAULT);
+    if (oc.contents_equal(nc)) {
+      n->crush = o->crush;
+    }
   }
 
   // does pg_temp match?
-  if (*o->pg_temp == *n->pg_temp)
+  if (n->pg_temp != o->pg_temp && *o->pg_temp == *n->pg_temp)
     n->pg_temp = o->pg_temp;
 
   // does primary_temp match?
-  if (o->primary_temp->size() == n->primary_temp->size()) {
+  if (n->primary_temp != o->primary_temp &&
+      o->primary_temp->size() == n->primary_temp->size()) {
     if (*o->primary_temp == *n->primary_temp)
       n->primary_temp = o->primary_temp;
   }
 
   // do uuids match?
-  if (o->osd_uuid->size() == n->osd_uuid->size() &&
+  if (n->osd_uuid != o->osd_uuid &&
+      o->osd_uuid->size() == n->osd_uuid->size() &&
       *o->osd_uuid == *n->osd_uuid)
     n->osd_uuid = o->osd_uuid;
 }
@@ -2211,6 +2223,61 @@ bool OSDMap::clean_pg_upmaps(
   return any_change;
 }
 
+namespace {
+// give p a private copy of its target if another map still references it
+template<typename T>
+void unshare(std::shared_ptr<T>& p)
+{
+  if (p && p.use_count() > 1) {
+    p = std::make_shared<T>(*p);
+  }
+}
+
+template<typename T>
+void unshare_empty(std::shared_ptr<T>& p)
+{
+  if (p && p.use_count() > 1) {
+    p = std::make_shared<T>();
+  }
+}
+}
+
+// A map built with shallow_copy_from() shares these components with the
+// epoch it came from; clone only the ones this incremental writes to.
+void OSDMap::unshare_for(const Incremental &inc)
+{
+  bool resized = inc.new_max_osd >= 0;
+  bool state = !inc.new_state.empty();
+  if (resized || state ||
+      !inc.new_up_client.empty() || !inc.new_up_cluster.empty()) {
+    unshare(osd_addrs);
+  }
+  if (resized || state || !inc.new_uuid.empty()) {
+    unshare(osd_uuid);
+  }
+  if (resized || state || !inc.new_primary_affinity.empty()) {
+    unshare(osd_primary_affinity);
+  }
+  if (!inc.new_pg_temp.empty()) {
+    unshare(pg_temp);
+  }
+  if (!inc.new_primary_temp.empty()) {
+    unshare(primary_temp);
+  }
+  // crush is only ever replaced wholesale
+}
+
+// decode() overwrites every component, so there is nothing to copy
+void OSDMap::unshare_for_decode()
+{
+  unshare_empty(osd_addrs);
+  unshare_empty(pg_temp);
+  unshare_empty(primary_temp);
+  unshare_empty(osd_uuid);
+  unshare_empty(crush);
+  // osd_primary_affinity is always reallocated by decode()
+}
+
 int OSDMap::apply_incremental(const Incremental &inc)
 {
   new_blocklist_entries = false;
@@ -2232,6 +2299,8 @@ int OSDMap::apply_incremental(const Incremental &inc)
   }
 
   // nope, incremental.
+  unshare_for(inc);
+
   if (inc.new_flags >= 0) {
     flags = inc.new_flags;
     // the below is just to cover a newly-upgraded luminous mon
@@ -3453,6 +3522,7 @@ void OSDMap::decode_classic(ceph::buffer::list::const_iterator& p)
 void OSDMap::decode(ceph::buffer::list::const_iterator& bl)
 {
   using ceph::decode;
+  unshare_for_decode();
   /**
    * Older encodings of the OSDMap had a single struct_v which
    * covered the whole encoding, and was prior to our modern
@@ -4977,6 +5047,8 @@ int OSDMap::calc_pg_upmaps(
     cct->_conf.get_val<bool>("osd_calc_pg_upmaps_aggressively_fast");
   auto local_fallback_retries =
     cct->_conf.get_val<uint64_t>("osd_calc_pg_upmaps_local_fallback_retries");
+  auto threads =
+    cct->_conf.get_val<uint64_t>("osd_calc_pg_upmaps_threads");
     
   while (max--) {
     ldout(cct, 30) << "Top of loop #" << max+1 << dendl;
@@ -5015,7 +5087,7 @@ int OSDMap::calc_pg_upmaps(
 
     set<pg_t> to_unmap;
     map<pg_t, mempool::osdmap::vector<pair<int32_t,int32_t>>> to_upmap;
-    auto temp_pgs_by_osd = pgs_by_osd;
+    pg_moves_t moves(pgs_by_osd);
     // always start with fullest, break if we find any changes to make
     for (auto p = deviation_osd.rbegin(); p != deviation_osd.rend(); ++p) {
       if (skip_overfull && !underfull.empty()) {
@@ -5064,68 +5136,25 @@ int OSDMap::calc_pg_upmaps(
       }
       // look for remaps we can un-remap
       if (try_drop_remap_overfull(cct, pgs, tmp_osd_map, osd,
-				  temp_pgs_by_osd, to_unmap, to_upmap))
+				  moves, to_unmap, to_upmap))
 	goto test_change;
 
       // try upmap
-      for (auto pg : pgs) {
-        auto temp_it = tmp_osd_map.pg_upmap.find(pg);
-        if (temp_it != tmp_osd_map.pg_upmap.end()) {
-          // leave pg_upmap alone
-          // it must be specified by admin since balancer does not
-          // support pg_upmap yet
-	  ldout(cct, 10) << " " << pg << " already has pg_upmap "
-                         << temp_it->second << ", skipping"
-                         << dendl;
-	  continue;
-	}
-        auto pg_pool_size = tmp_osd_map.get_pg_pool_size(pg);
-        mempool::osdmap::vector<pair<int32_t,int32_t>> new_upmap_items;
-        set<int> existing;
-        auto it = tmp_osd_map.pg_upmap_items.find(pg);
-        if (it != tmp_osd_map.pg_upmap_items.end()) {
-	  auto& um_items = it->second;
-          if (um_items.size() >= (size_t)pg_pool_size) {
-            ldout(cct, 10) << " " << pg << " already has full-size pg_upmap_items "
-                           << um_items << ", skipping"
-                           << dendl;
-            continue;
-          } else {
-            ldout(cct, 10) << " " << pg << " already has pg_upmap_items "
-                           << um_items
-                           << dendl;
-            new_upmap_items = um_items;
-            // build existing too (for dedup)
-            for (auto [um_from, um_to] : um_items) {
-              existing.insert(um_from);
-              existing.insert(um_to);
-            }
-	  }
-          // fall through
-          // to see if we can append more remapping pairs
-	}
-	ldout(cct, 10) << " trying " << pg << dendl;
-        vector<int> raw, orig, out;
-        tmp_osd_map.pg_to_raw_upmap(pg, &raw, &orig); // including existing upmaps too
-	if (!try_pg_upmap(cct, pg, overfull, underfull, more_underfull, &orig, &out)) {
-	  continue;
-	}
-	ldout(cct, 10) << " " << pg << " " << orig << " -> " << out << dendl;
-	if (orig.size() != out.size()) {
-	  continue;
-	}
-	ceph_assert(orig != out);
-	int pos = find_best_remap(cct, orig, out, existing, osd_deviation);
-	if (pos != -1) {
+      {
+        upmap_candidate_t c;
+        size_t n = find_upmap_candidate(cct, tmp_osd_map, pgs, overfull,
+                                        underfull, more_underfull,
+                                        osd_deviation, threads, &c);
+        if (n < pgs.size()) {
           // append new remapping pairs slowly
           // This way we can make sure that each tiny change will
           // definitely make distribution of PGs converging to
           // the perfect status.
-	  add_remap_pair(cct, orig[pos], out[pos], pg, (size_t)pg_pool_size, 
-	  		 osd, existing, temp_pgs_by_osd,
-			 new_upmap_items, to_upmap);
+	  add_remap_pair(cct, c.orig[c.pos], c.out[c.pos], pgs[n],
+			 c.pg_pool_size, osd, c.existing, moves,
+			 c.new_upmap_items, to_upmap);
           goto test_change;
-	}
+        }
       }
       if (fast_aggressive) {
 	if (prev_n_changes == n_changes) {  // no changes for prev OSD
@@ -5160,7 +5189,7 @@ int OSDMap::calc_pg_upmaps(
       // look for remaps we can un-remap
       candidates_t candidates = build_candidates(cct, tmp_osd_map, to_skip,
       						 only_pools, aggressive, p_seed);
-      if (try_drop_remap_underfull(cct, candidates, osd, temp_pgs_by_osd,
+      if (try_drop_remap_underfull(cct, candidates, osd, moves,
           to_unmap, to_upmap)) {
 	goto test_change;
       }
@@ -5189,13 +5218,11 @@ int OSDMap::calc_pg_upmaps(
     // test change, apply if change is good
     ceph_assert(to_unmap.size() || to_upmap.size());
     float new_stddev = 0;
-    map<int,float> temp_osd_deviation;
-    multimap<float,int> temp_deviation_osd;
-    float cur_max_deviation = calc_deviations(cct, temp_pgs_by_osd, osd_weight,
-    					      pgs_per_weight, temp_osd_deviation,
-					      temp_deviation_osd, new_stddev);
+    float cur_max_deviation = calc_stddev(cct, pgs_by_osd, osd_weight,
+					  pgs_per_weight, new_stddev);
     ldout(cct, 10) << " stddev " << stddev << " -> " << new_stddev << dendl;
     if (new_stddev >= stddev) {
+      moves.rollback();
       if (!aggressive) {
         ldout(cct, 10) << " break because stddev is not decreasing"
                        << " and aggressive mode is not enabled"
@@ -5226,9 +5253,9 @@ int OSDMap::calc_pg_upmaps(
     // ready to go
     ceph_assert(new_stddev < stddev);
     stddev = new_stddev;
-    pgs_by_osd = temp_pgs_by_osd;
-    osd_deviation = temp_osd_deviation;
-    deviation_osd = temp_deviation_osd;
+    update_deviations(cct, pgs_by_osd, osd_weight, pgs_per_weight,
+		      moves.osds, osd_deviation, deviation_osd);
+    moves.commit();
     n_changes++;
 
 
@@ -5401,6 +5428,109 @@ float OSDMap::calc_deviations (
   return cur_max_deviation;
 }
 
+float OSDMap::calc_stddev (
+  CephContext *cct,
+  const map<int,set<pg_t>>& pgs_by_osd,
+  const map<int,float>& osd_weight,
+  float pgs_per_weight,
+  float& stddev)  // return current max deviation
+{
+  //
+  // Same as calc_deviations, without building the deviation maps.  Used to
+  // test a candidate change; the maps are only updated if it is kept.
+  //
+  float cur_max_deviation = 0.0;
+  stddev = 0.0;
+  for (auto& [oid, opgs] : pgs_by_osd) {
+    ceph_assert(osd_weight.count(oid));
+    float target = osd_weight.at(oid) * pgs_per_weight;
+    float deviation = (float)opgs.size() - target;
+    ldout(cct, 20) << " osd." << oid
+                   << "\tpgs " << opgs.size()
+                   << "\ttarget " << target
+                   << "\tdeviation " << deviation
+                   << dendl;
+    stddev += deviation * deviation;
+    if (fabsf(deviation) > cur_max_deviation)
+      cur_max_deviation = fabsf(deviation);
+  }
+  return cur_max_deviation;
+}
+
+void OSDMap::update_deviations (
+  CephContext *cct,
+  const map<int,set<pg_t>>& pgs_by_osd,
+  const map<int,float>& osd_weight,
+  float pgs_per_weight,
+  const set<int>& osds,
+  map<int,float>& osd_deviation,
+  multimap<float,int>& deviation_osd)
+{
+  //
+  // Recompute the deviation of the given osds only.  deviation_osd keeps
+  // equal deviations in osd order, as calc_deviations builds it, so the
+  // search order of calc_pg_upmaps does not depend on how it got here.
+  //
+  for (auto oid : osds) {
+    auto p = osd_deviation.find(oid);
+    if (p != osd_deviation.end()) {
+      auto [first, last] = deviation_osd.equal_range(p->second);
+      for (auto q = first; q != last; ++q) {
+        if (q->second == oid) {
+          deviation_osd.erase(q);
+          break;
+        }
+      }
+    }
+    auto opgs = pgs_by_osd.find(oid);
+    ceph_assert(opgs != pgs_by_osd.end());
+    float target = osd_weight.at(oid) * pgs_per_weight;
+    float deviation = (float)opgs->second.size() - target;
+    ldout(cct, 20) << " osd." << oid
+                   << "\tpgs " << opgs->second.size()
+                   << "\ttarget " << target
+                   << "\tdeviation " << deviation
+                   << dendl;
+    osd_deviation[oid] = deviation;
+    auto [first, last] = deviation_osd.equal_range(deviation);
+    while (first != last && first->second < oid)
+      ++first;
+    deviation_osd.insert(first, make_pair(deviation, oid));
+  }
+}
+
+void OSDMap::pg_moves_t::apply(int osd, pg_t pg, bool insert)
+{
+  auto [p, created] = pgs_by_osd.try_emplace(osd);
+  bool changed = insert ? p->second.insert(pg).second :
+                          p->second.erase(pg) > 0;
+  undo.push_back(undo_t{osd, pg, created, insert, changed});
+  osds.insert(osd);
+}
+
+void OSDMap::pg_moves_t::move(pg_t pg, int from, int to)
+{
+  apply(from, pg, false);
+  apply(to, pg, true);
+}
+
+void OSDMap::pg_moves_t::rollback()
+{
+  for (auto u = undo.rbegin(); u != undo.rend(); ++u) {
+    auto p = pgs_by_osd.find(u->osd);
+    ceph_assert(p != pgs_by_osd.end());
+    if (u->changed) {
+      if (u->inserted)
+        p->second.erase(u->pg);
+      else
+        p->second.insert(u->pg);
+    }
+    if (u->created)
+      pgs_by_osd.erase(p);
+  }
+  commit();
+}
+
 void OSDMap::fill_overfull_underfull (
   CephContext *cct,
   const std::multimap<float,int>& deviation_osd,
@@ -5506,13 +5636,13 @@ bool OSDMap::try_drop_remap_overfull(
   const std::vector<pg_t>& pgs,
   const OSDMap& tmp_osd_map,
   int osd,
-  map<int,std::set<pg_t>>& temp_pgs_by_osd,
+  pg_moves_t& moves,
   set<pg_t>& to_unmap,
   map<pg_t, mempool::osdmap::vector<pair<int32_t,int32_t>>>& to_upmap)
 {
   //
   // This function tries to drop existimg upmap items which map data to overfull 
-  // OSDs. It updates temp_pgs_by_osd, to_unmap and to_upmap and rerturns true 
+  // OSDs. It updates moves, to_unmap and to_upmap and rerturns true 
   // if it found an item that can be dropped, false if not. 
   //
   for (auto pg : pgs) {
@@ -5531,8 +5661,7 @@ bool OSDMap::try_drop_remap_overfull(
                        << " which remapped " << pg
                        << " into overfull osd." << osd
                        << dendl;
-        temp_pgs_by_osd[um_to].erase(pg);
-        temp_pgs_by_osd[um_from].insert(pg);
+        moves.move(pg, um_to, um_from);
         } else {
           new_upmap_items.push_back(um_pair);
         }
@@ -5563,13 +5692,13 @@ bool OSDMap::try_drop_remap_underfull(
     CephContext *cct,
     const candidates_t& candidates,
     int osd,
-    map<int,std::set<pg_t>>& temp_pgs_by_osd,
+    pg_moves_t& moves,
     set<pg_t>& to_unmap,
     map<pg_t, mempool::osdmap::vector<std::pair<int32_t,int32_t>>>& to_upmap)
 {
   // 
   // This function tries to drop existimg upmap items which map data from underfull
-  // OSDs. It updates temp_pgs_by_osd, to_unmap and to_upmap and rerturns true 
+  // OSDs. It updates moves, to_unmap and to_upmap and rerturns true 
   // if it found an item that can be dropped, false if not. 
   //
   for (auto& [pg, um_pairs] : candidates) {
@@ -5584,8 +5713,7 @@ bool OSDMap::try_drop_remap_underfull(
                        << " which remapped " << pg
                        << " out from underfull osd." << osd
                        << dendl;
-        temp_pgs_by_osd[um_to].erase(pg);
-        temp_pgs_by_osd[um_from].insert(pg);
+        moves.move(pg, um_to, um_from);
       } else {
         new_upmap_items.push_back(ump);
       }
@@ -5622,7 +5750,7 @@ void OSDMap::add_remap_pair(
   size_t pg_pool_size,
   int osd,
   set<int>& existing,
-  map<int,set<pg_t>>& temp_pgs_by_osd,
+  pg_moves_t& moves,
   mempool::osdmap::vector<pair<int32_t,int32_t>> new_upmap_items,
   map<pg_t, mempool::osdmap::vector<pair<int32_t,int32_t>>>& to_upmap) 
 {
@@ -5636,8 +5764,7 @@ void OSDMap::add_remap_pair(
                  << dendl;
   existing.insert(orig);
   existing.insert(out);
-  temp_pgs_by_osd[orig].erase(pg);
-  temp_pgs_by_osd[out].insert(pg);
+  moves.move(pg, orig, out);
   ceph_assert(new_upmap_items.size() < pg_pool_size);
   new_upmap_items.push_back(make_pair(orig, out));
   // append new remapping pairs slowly
@@ -5648,6 +5775,116 @@ void OSDMap::add_remap_pair(
 
 }
 
+bool OSDMap::try_upmap_candidate(
+  CephContext *cct,
+  const OSDMap& tmp_osd_map,
+  pg_t pg,
+  const set<int>& overfull,
+  const vector<int>& underfull,
+  const vector<int>& more_underfull,
+  const map<int,float>& osd_deviation,
+  upmap_candidate_t *c)
+{
+  //
+  // Check whether pg can get a new remapping pair off an overfull osd,
+  // filling c with what add_remap_pair needs.  This only reads the maps,
+  // so find_upmap_candidate can run it for several pgs at once.
+  //
+  auto temp_it = tmp_osd_map.pg_upmap.find(pg);
+  if (temp_it != tmp_osd_map.pg_upmap.end()) {
+    // leave pg_upmap alone
+    // it must be specified by admin since balancer does not
+    // support pg_upmap yet
+    ldout(cct, 10) << " " << pg << " already has pg_upmap "
+                   << temp_it->second << ", skipping"
+                   << dendl;
+    return false;
+  }
+  c->pg_pool_size = tmp_osd_map.get_pg_pool_size(pg);
+  auto it = tmp_osd_map.pg_upmap_items.find(pg);
+  if (it != tmp_osd_map.pg_upmap_items.end()) {
+    auto& um_items = it->second;
+    if (um_items.size() >= c->pg_pool_size) {
+      ldout(cct, 10) << " " << pg << " already has full-size pg_upmap_items "
+                     << um_items << ", skipping"
+                     << dendl;
+      return false;
+    } else {
+      ldout(cct, 10) << " " << pg << " already has pg_upmap_items "
+                     << um_items
+                     << dendl;
+      c->new_upmap_items = um_items;
+      // build existing too (for dedup)
+      for (auto [um_from, um_to] : um_items) {
+        c->existing.insert(um_from);
+        c->existing.insert(um_to);
+      }
+    }
+    // fall through
+    // to see if we can append more remapping pairs
+  }
+  ldout(cct, 10) << " trying " << pg << dendl;
+  vector<int> raw;
+  tmp_osd_map.pg_to_raw_upmap(pg, &raw, &c->orig); // including existing upmaps too
+  if (!try_pg_upmap(cct, pg, overfull, underfull, more_underfull,
+                    &c->orig, &c->out)) {
+    return false;
+  }
+  ldout(cct, 10) << " " << pg << " " << c->orig << " -> " << c->out << dendl;
+  if (c->orig.size() != c->out.size()) {
+    return false;
+  }
+  ceph_assert(c->orig != c->out);
+  c->pos = find_best_remap(cct, c->orig, c->out, c->existing, osd_deviation);
+  return c->pos != -1;
+}
+
+size_t OSDMap::find_upmap_candidate(
+  CephContext *cct,
+  const OSDMap& tmp_osd_map,
+  const vector<pg_t>& pgs,
+  const set<int>& overfull,
+  const vector<int>& underfull,
+  const vector<int>& more_underfull,
+  const map<int,float>& osd_deviation,
+  unsigned threads,
+  upmap_candidate_t *c)
+{
+  //
+  // Find the first pg in pgs that try_upmap_candidate accepts.  With
+  // several threads the pgs are claimed in order and nobody claims past
+  // the best pg found so far, so every pg before the result has been
+  // tried and failed: the result is the one a serial scan would pick.
+  //
+  std::vector<upmap_candidate_t> results(pgs.size());
+  std::atomic<size_t> next = 0;
+  std::atomic<size_t> found = pgs.size();
+  auto scan = [&] {
+    for (;;) {
+      size_t i = next++;
+      if (i >= found.load())
+        return;
+      if (try_upmap_candidate(cct, tmp_osd_map, pgs[i], overfull, underfull,
+                              more_underfull, osd_deviation, &results[i])) {
+        size_t f = found.load();
+        while (i < f && !found.compare_exchange_weak(f, i))
+          ;
+      }
+    }
+  };
+  threads = std::min<size_t>(threads, pgs.size());
+  std::vector<std::thread> workers;
+  for (unsigned t = 1; t < threads; ++t)
+    workers.emplace_back(scan);
+  scan();
+  for (auto& w : workers)
+    w.join();
+  size_t n = found.load();
+  if (n < pgs.size())
+    *c = std::move(results[n]);
+  return n;
+}
+
 int OSDMap::find_best_remap (
   CephContext *cct,
   const vector<int>& orig,
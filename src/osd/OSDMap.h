@@ -657,6 +657,9 @@ private:
 
   friend class OSDMonitor;
 
+  void unshare_for(const Incremental &inc);
+  void unshare_for_decode();
+
  public:
   OSDMap() : epoch(0), 
 	     pool_max(0),
@@ -704,6 +707,18 @@ public:
     // allocate a new CrushWrapper, though.
   }
 
+  /**
+   * Make this map a copy of o that shares o's reference-counted
+   * components (addrs, pg_temp, primary_temp, primary affinity, uuids,
+   * crush).  apply_incremental() and decode() clone a shared component
+   * before modifying it, so consecutive epochs only pay for the parts an
+   * incremental actually touched.  Other mutators do not; use
+   * deepish_copy_from() if the copy is going to be edited directly.
+   */
+  void shallow_copy_from(const OSDMap& o) {
+    *this = o;
+  }
+
   // map info
   const uuid_d& get_fsid() const { return fsid; }
   void set_fsid(uuid_d& f) { fsid = f; }
@@ -1500,6 +1515,80 @@ private:
     float& stddev
   );  // return current max deviation
 
+  float calc_stddev (
+    CephContext *cct,
+    const std::map<int,std::set<pg_t>>& pgs_by_osd,
+    const std::map<int,float>& osd_weight,
+    float pgs_per_weight,
+    float& stddev
+  );  // return current max deviation
+
+  void update_deviations (
+    CephContext *cct,
+    const std::map<int,std::set<pg_t>>& pgs_by_osd,
+    const std::map<int,float>& osd_weight,
+    float pgs_per_weight,
+    const std::set<int>& osds,
+    std::map<int,float>& osd_deviation,
+    std::multimap<float,int>& deviation_osd
+  );
+
+  // The pg moves of the change calc_pg_upmaps is testing.  They are
+  // applied to pgs_by_osd in place and rolled back if the change is
+  // rejected, so a candidate does not cost a copy of every osd's pgs.
+  struct pg_moves_t {
+    std::map<int,std::set<pg_t>>& pgs_by_osd;
+    std::set<int> osds;  ///< osds whose pg sets changed
+
+    explicit pg_moves_t(std::map<int,std::set<pg_t>>& m) : pgs_by_osd(m) {}
+    void move(pg_t pg, int from, int to);
+    void rollback();
+    void commit() {
+      undo.clear();
+      osds.clear();
+    }
+  private:
+    struct undo_t {
+      int osd;
+      pg_t pg;
+      bool created;   ///< osd had no entry before
+      bool inserted;  ///< pg was inserted (else erased)
+      bool changed;   ///< the set operation had an effect
+    };
+    std::vector<undo_t> undo;
+    void apply(int osd, pg_t pg, bool insert);
+  };
+
+  struct upmap_candidate_t {
+    std::vector<int> orig, out;
+    std::set<int> existing;
+    mempool::osdmap::vector<std::pair<int32_t,int32_t>> new_upmap_items;
+    size_t pg_pool_size = 0;
+    int pos = -1;
+  };
+
+  bool try_upmap_candidate(
+    CephContext *cct,
+    const OSDMap& tmp_osd_map,
+    pg_t pg,
+    const std::set<int>& overfull,
+    const std::vector<int>& underfull,
+    const std::vector<int>& more_underfull,
+    const std::map<int,float>& osd_deviation,
+    upmap_candidate_t *c);
+
+  size_t find_upmap_candidate(
+    CephContext *cct,
+    const OSDMap& tmp_osd_map,
+    const std::vector<pg_t>& pgs,
+    const std::set<int>& overfull,
+    const std::vector<int>& underfull,
+    const std::vector<int>& more_underfull,
+    const std::map<int,float>& osd_deviation,
+    unsigned threads,
+    upmap_candidate_t *c
+  );  // return the index of the first usable pg, pgs.size() if none
+
   void fill_overfull_underfull (
     CephContext *cct,
     const std::multimap<float,int>& deviation_osd,
@@ -1528,7 +1617,7 @@ private:
     const std::vector<pg_t>& pgs,
     const OSDMap& tmp_osd_map,
     int osd,
-    std::map<int,std::set<pg_t>>& temp_pgs_by_osd,
+    pg_moves_t& moves,
     std::set<pg_t>& to_unmap,
     std::map<pg_t, mempool::osdmap::vector<std::pair<int32_t,int32_t>>>& to_upmap
   );
@@ -1540,7 +1629,7 @@ bool try_drop_remap_underfull(
     CephContext *cct,
     const candidates_t& candidates,
     int osd,
-    std::map<int,std::set<pg_t>>& temp_pgs_by_osd,
+    pg_moves_t& moves,
     std::set<pg_t>& to_unmap,
     std::map<pg_t, mempool::osdmap::vector<std::pair<int32_t,int32_t>>>& to_upmap
   );
@@ -1553,7 +1642,7 @@ bool try_drop_remap_underfull(
     size_t pg_pool_size,
     int osd,
     std::set<int>& existing,
-    std::map<int,std::set<pg_t>>& temp_pgs_by_osd,
+    pg_moves_t& moves,
     mempool::osdmap::vector<std::pair<int32_t,int32_t>> new_upmap_items,
     std::map<pg_t, mempool::osdmap::vector<std::pair<int32_t,int32_t>>>& to_upmap
   );
@@ -59,6 +59,116 @@ void OSDMapMapping::update(const OSDMap& osdmap, pg_t pgid)
   _update_range(osdmap, pgid.pool(), pgid.ps(), pgid.ps() + 1);
 }
 
+std::unique_ptr<OSDMapMapping::MappingJob> OSDMapMapping::start_update(
+  const OSDMap& osdmap,
+  ParallelPGMapper& mapper,
+  unsigned pgs_per_item,
+  const std::set<pg_t>& pgs,
+  const std::set<int64_t>& pools)
+{
+  std::unique_ptr<MappingJob> job(new MappingJob(&osdmap, this));
+  vector<pg_t> todo;
+  for (auto pool : pools) {
+    auto pi = osdmap.get_pg_pool(pool);
+    if (!pi) {
+      continue;
+    }
+    for (unsigned ps = 0; ps < pi->get_pg_num(); ++ps) {
+      todo.push_back(pg_t(ps, pool));
+    }
+  }
+  for (auto& pgid : pgs) {
+    if (pools.count(pgid.pool())) {
+      continue;
+    }
+    auto pi = osdmap.get_pg_pool(pgid.pool());
+    if (pi && pgid.ps() < pi->get_pg_num()) {
+      todo.push_back(pgid);
+    }
+  }
+  if (todo.empty()) {
+    // nothing moved; just bring the epoch (and rmap) forward
+    job->finish = ceph_clock_now();
+    job->complete();
+  } else {
+    mapper.queue(job.get(), pgs_per_item, todo);
+  }
+  return job;
+}
+
+bool OSDMapMapping::get_affected_pgs(
+  const OSDMap& osdmap,
+  const OSDMap::Incremental& inc,
+  std::set<pg_t> *pgs,
+  std::set<int64_t> *out_pools) const
+{
+  if (inc.fullmap.length() ||
+      inc.crush.length() ||
+      inc.new_max_osd >= 0 ||
+      !inc.new_weight.empty() ||
+      !inc.new_up_client.empty()) {
+    return false;
+  }
+
+  for (auto& p : inc.new_pools) {
+    out_pools->insert(p.first);
+  }
+
+  auto add = [pgs](const pg_t& pgid) {
+    pgs->insert(pgid);
+  };
+  for (auto& p : inc.new_pg_temp) add(p.first);
+  for (auto& p : inc.new_primary_temp) add(p.first);
+  for (auto& p : inc.new_pg_upmap) add(p.first);
+  for (auto& p : inc.new_pg_upmap_items) add(p.first);
+  for (auto& p : inc.new_pg_upmap_primary) add(p.first);
+  for (auto& pgid : inc.old_pg_upmap) add(pgid);
+  for (auto& pgid : inc.old_pg_upmap_items) add(pgid);
+  for (auto& pgid : inc.old_pg_upmap_primary) add(pgid);
+
+  // OSDs that went down or changed primary affinity only move PGs they
+  // were already mapped to
+  std::set<int32_t> osds;
+  for (auto& [osd, s] : inc.new_state) {
+    int state = s ? s : CEPH_OSD_UP;
+    if (state & CEPH_OSD_EXISTS) {
+      return false;  // created or destroyed
+    }
+    if (state & CEPH_OSD_UP) {
+      if (osdmap.is_up(osd)) {
+	return false;  // came up
+      }
+      osds.insert(osd);
+    }
+  }
+  for (auto& p : inc.new_primary_affinity) {
+    osds.insert(p.first);
+  }
+  if (osds.empty()) {
+    return true;
+  }
+  for (auto& [poolid, pm] : pools) {
+    if (out_pools->count(poolid)) {
+      continue;
+    }
+    const size_t row_size = pm.row_size();
+    for (unsigned ps = 0; ps < pm.pg_num; ++ps) {
+      const int32_t *row = &pm.table[row_size * ps];
+      bool hit = false;
+      for (int i = 0; !hit && i < row[2]; ++i) {
+	hit = osds.count(row[4 + i]);
+      }
+      for (int i = 0; !hit && i < row[3]; ++i) {
+	hit = osds.count(row[4 + pm.size + i]);
+      }
+      if (hit) {
+	pgs->insert(pg_t(ps, poolid));
+      }
+    }
+  }
+  return true;
+}
+
 void OSDMapMapping::_build_rmap(const OSDMap& osdmap)
 {
   acting_rmap.resize(osdmap.get_max_osd());
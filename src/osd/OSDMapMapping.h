@@ -7,13 +7,13 @@
 
 #include <vector>
 #include <map>
+#include <set>
 
 #include "osd/osd_types.h"
+#include "osd/OSDMap.h"
 #include "common/WorkQueue.h"
 #include "common/Cond.h"
 
-class OSDMap;
-
 /// work queue to perform work on batches of pgids on multiple CPUs
 class ParallelPGMapper {
 public:
@@ -289,7 +289,11 @@ private:
       : Job(osdmap), mapping(m) {
       mapping->_start(*osdmap);
     }
-    void process(const std::vector<pg_t>& pgs) override {}
+    void process(const std::vector<pg_t>& pgs) override {
+      for (auto& pgid : pgs) {
+	mapping->_update_range(*osdmap, pgid.pool(), pgid.ps(), pgid.ps() + 1);
+      }
+    }
     void process(int64_t pool, unsigned ps_begin, unsigned ps_end) override {
       mapping->_update_range(*osdmap, pool, ps_begin, ps_end);
     }
@@ -357,6 +361,36 @@ public:
     return job;
   }
 
+  /**
+   * start an update that only recomputes the given PGs and pools
+   *
+   * The mapping must be complete and current for the epoch before the
+   * incremental(s) the sets were gathered from with get_affected_pgs().
+   */
+  std::unique_ptr<MappingJob> start_update(
+    const OSDMap& map,
+    ParallelPGMapper& mapper,
+    unsigned pgs_per_item,
+    const std::set<pg_t>& pgs,
+    const std::set<int64_t>& pools);
+
+  /**
+   * gather the PGs whose mapping inc can have changed
+   *
+   * @param map the map inc produced; this mapping is still for its
+   *            predecessor (or for an earlier epoch whose later
+   *            incrementals were already gathered into pgs and pools)
+   * @param pgs [out] individual PGs to recompute
+   * @param pools [out] pools to recompute in full
+   * @returns false if inc can move PGs we cannot enumerate cheaply
+   *          (crush, weights, OSDs coming up, ...) and a full update
+   *          is needed
+   */
+  bool get_affected_pgs(const OSDMap& map,
+			const OSDMap::Incremental& inc,
+			std::set<pg_t> *pgs,
+			std::set<int64_t> *pools) const;
+
   epoch_t get_epoch() const {
     return epoch;
   }
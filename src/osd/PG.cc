@@ -1161,6 +1161,10 @@ void PG::update_snap_map(
   for (auto i = log_entries.cbegin(); i != log_entries.cend(); ++i) {
     OSDriver::OSTransaction _t(osdriver.get_transaction(&t));
     if (i->soid.snap < CEPH_MAXSNAP) {
+      // outside of cache tiering, only snap trimming deletes or modifies
+      // clones
+      const bool trim = i->is_delete() || i->is_modify();
+      const uint64_t bytes_before = trim ? t.get_num_bytes() : 0;
       if (i->is_delete()) {
 	int r = snap_mapper.remove_oid(
 	  i->soid,
@@ -1198,6 +1202,11 @@ void PG::update_snap_map(
 	  ceph_assert(i->is_clean());
 	}
       }
+      if (trim) {
+	osd->logger->inc(l_osd_snap_trim_clones);
+	osd->logger->inc(l_osd_snap_trim_kv_bytes,
+			 t.get_num_bytes() - bytes_before);
+      }
     }
   }
 }
@@ -1808,7 +1817,8 @@ void PG::request_remote_recovery_reservation(
       this, std::move(on_grant)) : nullptr,
     priority,
     on_preempt ? new QueuePeeringEvt(
-      this, std::move(on_preempt)) : nullptr);
+      this, std::move(on_preempt)) : nullptr,
+    get_primary().osd);
 }
 
 void PG::cancel_remote_recovery_reservation() {
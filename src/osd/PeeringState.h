@@ -140,6 +140,10 @@ struct HeartbeatStamps : public RefCountedObject {
   /// highest up_from we've seen from this rank
   epoch_t up_from = 0;
 
+  /// when we last got a message from this peer on the cluster network
+  /// (ns since epoch), for osd_heartbeat_piggyback
+  std::atomic<uint64_t> last_rx_data = {0};
+
   void print(std::ostream& out) const {
     std::lock_guard l(lock);
     out << "hbstamp(osd." << osd << " up_from " << up_from
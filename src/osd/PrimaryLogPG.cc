@@ -4422,6 +4422,7 @@ void PrimaryLogPG::set_dynamic_perf_stats_queries(
     const std::list<OSDPerfMetricQuery> &queries)
 {
   m_dynamic_perf_stats.set_queries(queries);
+  m_dynamic_perf_stats.set_max_keys(cct->_conf->osd_perf_query_max_keys);
 }
 
 void PrimaryLogPG::get_dynamic_perf_stats(DynamicPerfStats *stats)
@@ -4458,11 +4459,7 @@ void PrimaryLogPG::do_scan(
       bi.begin = m->begin;
       // No need to flush, there won't be any in progress writes occuring
       // past m->begin
-      scan_range(
-	cct->_conf->osd_backfill_scan_min,
-	cct->_conf->osd_backfill_scan_max,
-	&bi,
-	handle);
+      scan_range_adaptive(&bi, handle);
       MOSDPGScan *reply = new MOSDPGScan(
 	MOSDPGScan::OP_SCAN_DIGEST,
 	pg_whoami,
@@ -8811,6 +8808,8 @@ void PrimaryLogPG::do_osd_op_effects(OpContext *ctx, const ConnectionRef& conn)
       dout(10) << "starting notify on watch " << i->first << dendl;
       i->second->start_notify(notif);
     }
+    osd->logger->inc(l_osd_notify);
+    osd->logger->inc(l_osd_notify_watchers, ctx->obc->watchers.size());
     notif->init();
   }
 
@@ -8821,6 +8820,16 @@ void PrimaryLogPG::do_osd_op_effects(OpContext *ctx, const ConnectionRef& conn)
       dout(10) << "notify_ack " << make_pair(*(p->watch_cookie), p->notify_id) << dendl;
     else
       dout(10) << "notify_ack " << make_pair("NULL", p->notify_id) << dendl;
+    if (p->watch_cookie) {
+      // watchers are keyed by (cookie, entity): look the one watch up
+      // instead of walking every watcher of the object for each ack
+      auto i = ctx->obc->watchers.find(make_pair(*(p->watch_cookie), entity));
+      if (i != ctx->obc->watchers.end()) {
+	dout(10) << "acking notify on watch " << i->first << dendl;
+	i->second->notify_ack(p->notify_id, p->reply_bl);
+      }
+      continue;
+    }
     for (map<pair<uint64_t, entity_name_t>, WatchRef>::iterator i =
 	   ctx->obc->watchers.begin();
 	 i != ctx->obc->watchers.end();
@@ -10010,7 +10019,9 @@ void PrimaryLogPG::finish_copyfrom(CopyFromCallback *cb)
   ctx->mtime = utime_t();
 
   ctx->extra_reqids = cb->results->reqids;
-  ctx->extra_reqid_return_codes = cb->results->reqid_return_codes;
+  ctx->extra_reqid_return_codes.insert(
+    cb->results->reqid_return_codes.begin(),
+    cb->results->reqid_return_codes.end());
 
   // cache: clear whiteout?
   if (obs.oi.is_whiteout()) {
@@ -10187,7 +10198,9 @@ void PrimaryLogPG::finish_promote(int r, CopyResults *results,
   tctx->new_obs.exists = true;
 
   tctx->extra_reqids = results->reqids;
-  tctx->extra_reqid_return_codes = results->reqid_return_codes;
+  tctx->extra_reqid_return_codes.insert(
+    results->reqid_return_codes.begin(),
+    results->reqid_return_codes.end());
 
   if (obc->obs.oi.has_manifest() && obc->obs.oi.manifest.is_redirect()) {
     tctx->new_obs.oi.manifest.type = object_manifest_t::TYPE_NONE;
@@ -11844,12 +11857,33 @@ ObjectContextRef PrimaryLogPG::get_object_context(
     dout(10) << __func__ << ": obc NOT found in cache: " << soid << dendl;
     // check disk
     bufferlist bv;
+    // a head object needs both OI and SS (and EC wants every attr for
+    // attr_cache), so read them all at once rather than one at a time
+    map<string, bufferlist, less<>> prefetched;
+    bool prefetch = !attrs &&
+      (pool.info.is_erasure() ||
+       (soid.has_snapset() &&
+	cct->_conf.get_val<bool>("osd_pg_object_context_prefetch_attrs")));
     if (attrs) {
       auto it_oi = attrs->find(OI_ATTR);
       ceph_assert(it_oi != attrs->end());
       bv = it_oi->second;
     } else {
-      int r = pgbackend->objects_get_attr(soid, OI_ATTR, &bv);
+      int r;
+      if (prefetch) {
+	r = pgbackend->objects_get_attrs(soid, &prefetched);
+	if (r >= 0) {
+	  auto it_oi = prefetched.find(OI_ATTR);
+	  if (it_oi != prefetched.end()) {
+	    bv = it_oi->second;
+	    osd->logger->inc(l_osd_object_ctx_attrs_batched);
+	  } else {
+	    r = -ENOENT;
+	  }
+	}
+      } else {
+	r = pgbackend->objects_get_attr(soid, OI_ATTR, &bv);
+      }
       if (r < 0) {
 	if (!can_create) {
 	  dout(10) << __func__ << ": no obc for soid "
@@ -11890,9 +11924,13 @@ ObjectContextRef PrimaryLogPG::get_object_context(
     obc->obs.oi = oi;
     obc->obs.exists = true;
 
+    const map<string, bufferlist, less<>> *ss_attrs = attrs;
+    if (prefetch && prefetched.count(SS_ATTR)) {
+      ss_attrs = &prefetched;
+    }
     obc->ssc = get_snapset_context(
       soid, true,
-      soid.has_snapset() ? attrs : 0);
+      soid.has_snapset() ? ss_attrs : 0);
 
     if (is_primary() && is_active())
       populate_obc_watchers(obc);
@@ -11900,6 +11938,8 @@ ObjectContextRef PrimaryLogPG::get_object_context(
     if (pool.info.is_erasure()) {
       if (attrs) {
 	obc->attr_cache = *attrs;
+      } else if (prefetch) {
+	obc->attr_cache = std::move(prefetched);
       } else {
 	int r = pgbackend->objects_get_attrs(
 	  soid,
@@ -14181,14 +14221,11 @@ void PrimaryLogPG::update_range(
   BackfillInterval *bi,
   ThreadPool::TPHandle &handle)
 {
-  int local_min = cct->_conf->osd_backfill_scan_min;
-  int local_max = cct->_conf->osd_backfill_scan_max;
-
   if (bi->version < info.log_tail) {
     dout(10) << __func__<< ": bi is old, rescanning local backfill_info"
 	     << dendl;
     bi->version = info.last_update;
-    scan_range(local_min, local_max, bi, handle);
+    scan_range_adaptive(bi, handle);
   }
 
   if (bi->version >= projected_last_update) {
@@ -14288,6 +14325,40 @@ void PrimaryLogPG::scan_range(
   }
 }
 
+void PrimaryLogPG::scan_range_adaptive(
+  BackfillInterval *bi,
+  ThreadPool::TPHandle &handle)
+{
+  const int conf_min = cct->_conf->osd_backfill_scan_min;
+  const int conf_max = cct->_conf->osd_backfill_scan_max;
+  const int limit = std::max<int>(
+    conf_max, cct->_conf.get_val<int64_t>("osd_backfill_scan_adaptive_max"));
+  const double target =
+    cct->_conf.get_val<double>("osd_backfill_scan_target_latency");
+
+  int max = std::clamp(backfill_scan_max ? backfill_scan_max : conf_max,
+		       conf_max, limit);
+  int min = std::min(max, std::max(conf_min, max / 8));
+
+  auto start = ceph::mono_clock::now();
+  scan_range(min, max, bi, handle);
+  double elapsed = ceph::to_seconds<double>(ceph::mono_clock::now() - start);
+
+  // A scan holds the PG lock, so keep its duration near the target: grow
+  // while full scans are cheap (e.g. onto an idle device), back off once
+  // the store is slow enough that client ops would be held up.
+  if (elapsed > target) {
+    max = std::max(conf_max, max / 2);
+  } else if (elapsed < target / 2 &&
+	     bi->objects.size() >= static_cast<size_t>(max)) {
+    max = std::min(limit, max * 2);
+  }
+  if (max != backfill_scan_max) {
+    dout(10) << __func__ << " scan took " << elapsed << "s, next scan max "
+	     << max << dendl;
+    backfill_scan_max = max;
+  }
+}
 
 /** check_local
  *
@@ -14447,7 +14518,7 @@ void PrimaryLogPG::hit_set_create()
   HitSet::Params params(pool.info.hit_set_params);
 
   dout(20) << __func__ << " " << params << dendl;
-  if (pool.info.hit_set_params.get_type() == HitSet::TYPE_BLOOM) {
+  if (HitSet::is_bloom_type(pool.info.hit_set_params.get_type())) {
     BloomHitSet::Params *p =
       static_cast<BloomHitSet::Params*>(params.impl.get());
 
@@ -684,7 +684,7 @@ public:
     int num_write;   ///< count update ops
 
     mempool::osd_pglog::vector<std::pair<osd_reqid_t, version_t> > extra_reqids;
-    mempool::osd_pglog::map<uint32_t, int> extra_reqid_return_codes;
+    mempool::osd_pglog::flat_map<uint32_t, int> extra_reqid_return_codes;
 
     hobject_t new_temp_oid, discard_temp_oid;  ///< temp objects we should start/stop tracking
 
@@ -1125,6 +1125,8 @@ protected:
   /// last backfill operation started
   hobject_t last_backfill_started;
   bool new_backfill;
+  /// current upper bound on objects per backfill scan; 0 until first scan
+  int backfill_scan_max = 0;
 
   int prep_object_replica_pushes(const hobject_t& soid, eversion_t v,
 				 PGBackend::RecoveryHandle *h,
@@ -1281,6 +1283,12 @@ protected:
     ThreadPool::TPHandle &handle
     );
 
+  /// scan_range() with bounds adapted to how long recent scans took
+  void scan_range_adaptive(
+    BackfillInterval *bi,
+    ThreadPool::TPHandle &handle
+    );
+
   /// Update a hash range to reflect changes since the last scan
   void update_range(
     BackfillInterval *bi,        ///< [in,out] interval to update
@@ -656,12 +656,13 @@ int ReplicatedBackend::be_deep_scrub(
     const uint64_t stride = cct->_conf->osd_deep_scrub_stride;
 
     bufferlist bl;
-    r = store->read(
+    uint32_t crc = pos.data_hash.digest();
+    r = store->read_digest(
       ch,
       ghobject_t(
 	poid, ghobject_t::NO_GEN, get_parent()->whoami_shard().shard),
       pos.data_pos,
-      stride, bl,
+      stride, bl, &crc,
       fadvise_flags);
     if (r < 0) {
       dout(20) << __func__ << "  " << poid << " got "
@@ -669,9 +670,7 @@ int ReplicatedBackend::be_deep_scrub(
       o.read_error = true;
       return 0;
     }
-    if (r > 0) {
-      pos.data_hash << bl;
-    }
+    pos.data_hash = bufferhash(crc);
     pos.data_pos += r;
     if (static_cast<uint64_t>(r) == stride) {
       dout(20) << __func__ << "  " << poid << " more data, digest so far 0x"
@@ -2029,13 +2028,9 @@ int ReplicatedBackend::build_push_op(const ObjectRecoveryInfo &recovery_info,
 
   eversion_t v  = recovery_info.version;
   object_info_t oi;
+  bool no_omap = false;
   if (progress.first) {
-    int r = store->omap_get_header(ch, ghobject_t(recovery_info.soid), &out_op->omap_header);
-    if (r < 0) {
-      dout(1) << __func__ << " get omap header failed: " << cpp_strerror(-r) << dendl;
-      return r;
-    }
-    r = store->getattrs(ch, ghobject_t(recovery_info.soid), out_op->attrset);
+    int r = store->getattrs(ch, ghobject_t(recovery_info.soid), out_op->attrset);
     if (r < 0) {
       dout(1) << __func__ << " getattrs failed: " << cpp_strerror(-r) << dendl;
       return r;
@@ -2061,6 +2056,18 @@ int ReplicatedBackend::build_push_op(const ObjectRecoveryInfo &recovery_info,
       return -EINVAL;
     }
 
+    // Most small objects (RGW data, RBD) never had omap; skip the two kv
+    // lookups (header and iterator) that would only find nothing.
+    if (oi.is_omap()) {
+      r = store->omap_get_header(ch, ghobject_t(recovery_info.soid), &out_op->omap_header);
+      if (r < 0) {
+	dout(1) << __func__ << " get omap header failed: " << cpp_strerror(-r) << dendl;
+	return r;
+      }
+    } else {
+      no_omap = true;
+    }
+
     new_progress.first = false;
   }
   // Once we provide the version subsequent requests will have it, so
@@ -2068,7 +2075,9 @@ int ReplicatedBackend::build_push_op(const ObjectRecoveryInfo &recovery_info,
   ceph_assert(v != eversion_t());
 
   uint64_t available = cct->_conf->osd_recovery_max_chunk;
-  if (!progress.omap_complete) {
+  if (no_omap) {
+    new_progress.omap_complete = true;
+  } else if (!progress.omap_complete) {
     ObjectMap::ObjectMapIterator iter =
       store->get_omap_iterator(ch,
 			       ghobject_t(recovery_info.soid));
@@ -105,6 +105,25 @@ int OSDriver::get_next(
   }
 }
 
+int OSDriver::get_next_n(
+  const std::string &key,
+  unsigned max,
+  vector<pair<std::string, ceph::buffer::list>> *out)
+{
+  ObjectMap::ObjectMapIterator iter =
+    os->get_omap_iterator(ch, hoid);
+  if (!iter) {
+    ceph_abort();
+    return -EINVAL;
+  }
+  for (iter->upper_bound(key);
+       iter->valid() && out->size() < max;
+       iter->next()) {
+    out->emplace_back(iter->key(), iter->value());
+  }
+  return out->empty() ? -ENOENT : 0;
+}
+
 string SnapMapper::get_prefix(int64_t pool, snapid_t snap)
 {
   static_assert(sizeof(pool) == 8, "assumed by the formatting code");
@@ -459,29 +478,34 @@ int SnapMapper::get_next_objects_to_trim(
        ++i) {
     string prefix(get_prefix(pool, snap) + *i);
     string pos = prefix;
-    while (out->size() < max) {
-      pair<string, ceph::buffer::list> next;
-      r = backend.get_next(pos, &next);
-      dout(20) << __func__ << " get_next(" << pos << ") returns " << r
-	       << " " << next << dendl;
+    bool prefix_done = false;
+    while (out->size() < max && !prefix_done) {
+      // one store iterator for the whole batch, rather than one per object
+      vector<pair<string, ceph::buffer::list>> next;
+      r = backend.get_next_n(pos, max - out->size(), &next);
+      dout(20) << __func__ << " get_next_n(" << pos << ") returns " << r
+	       << " " << next.size() << " entries" << dendl;
       if (r != 0) {
 	break; // Done
       }
 
-      if (next.first.substr(0, prefix.size()) !=
-	  prefix) {
-	break; // Done with this prefix
-      }
+      for (auto& n : next) {
+	if (n.first.substr(0, prefix.size()) !=
+	    prefix) {
+	  prefix_done = true; // Done with this prefix
+	  break;
+	}
 
-      ceph_assert(is_mapping(next.first));
+	ceph_assert(is_mapping(n.first));
 
-      dout(20) << __func__ << " " << next.first << dendl;
-      pair<snapid_t, hobject_t> next_decoded(from_raw(next));
-      ceph_assert(next_decoded.first == snap);
-      ceph_assert(check(next_decoded.second));
+	dout(20) << __func__ << " " << n.first << dendl;
+	pair<snapid_t, hobject_t> next_decoded(from_raw(n));
+	ceph_assert(next_decoded.first == snap);
+	ceph_assert(check(next_decoded.second));
 
-      out->push_back(next_decoded.second);
-      pos = next.first;
+	out->push_back(next_decoded.second);
+	pos = n.first;
+      }
     }
   }
   if (out->size() == 0) {
@@ -59,6 +59,7 @@ Notify::Notify(
     cookie(cookie),
     notify_id(notify_id),
     version(version),
+    start_stamp(ceph::mono_clock::now()),
     osd(osd),
     cb(nullptr) {}
 
@@ -211,10 +212,14 @@ void Notify::maybe_complete_notify()
       empty,
       client_gid);
     reply->set_data(bl);
-    if (timed_out)
+    if (timed_out) {
       reply->return_code = -ETIMEDOUT;
+      osd->logger->inc(l_osd_notify_timeout);
+    }
     client->send_message(reply);
     unregister_cb();
+    osd->logger->tinc(l_osd_notify_lat,
+		      ceph::mono_clock::now() - start_stamp);
 
     complete = true;
   }
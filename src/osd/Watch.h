@@ -61,6 +61,7 @@ class Notify {
   uint64_t cookie;
   uint64_t notify_id;
   uint64_t version;
+  ceph::mono_time start_stamp;
 
   OSDService *osd;
   CancelableContext *cb;
@@ -45,7 +45,7 @@ PerfCounters *build_osd_logger(CephContext *cct) {
     l_osd_op_outb,  "op_out_bytes",
     "Client operations total read size",
     "rd", PerfCountersBuilder::PRIO_INTERESTING, unit_t(UNIT_BYTES));
-  osd_plb.add_time_avg(
+  osd_plb.add_time_avg_hist(
     l_osd_op_lat,   "op_latency",
     "Latency of client operations (including queue time)",
     "l", 9);
@@ -125,6 +125,9 @@ PerfCounters *build_osd_logger(CephContext *cct) {
     "Latency of IO before calling queue(before really queue into ShardedOpWq)"); // client io before queue op_wq latency
   osd_plb.add_time_avg(l_osd_op_before_dequeue_op_lat, "op_before_dequeue_op_lat",
     "Latency of IO before calling dequeue_op(already dequeued and get PG lock)"); // client io before dequeue_op latency
+  osd_plb.add_u64_counter(
+    l_osd_op_wq_steals, "op_wq_steals",
+    "Work items run by an idle thread of another op queue shard");
 
   osd_plb.add_u64_counter(
     l_osd_sop, "subop", "Suboperations");
@@ -212,6 +215,12 @@ PerfCounters *build_osd_logger(CephContext *cct) {
   osd_plb.add_u64_counter(
     l_osd_map_bl_cache_miss, "osd_map_bl_cache_miss",
     "OSDMap buffer cache misses");
+  osd_plb.add_u64_counter(
+    l_osd_map_msg_cache_hit, "osd_map_msg_cache_hit",
+    "Incremental map messages built from the share cache");
+  osd_plb.add_u64_counter(
+    l_osd_map_msg_cache_miss, "osd_map_msg_cache_miss",
+    "Incremental map messages gathered from the map caches or store");
 
   osd_plb.add_u64(
     l_osd_stat_bytes, "stat_bytes", "OSD size", "size",
@@ -261,6 +270,9 @@ PerfCounters *build_osd_logger(CephContext *cct) {
     l_osd_object_ctx_cache_hit, "object_ctx_cache_hit", "Object context cache hits");
   osd_plb.add_u64_counter(
     l_osd_object_ctx_cache_total, "object_ctx_cache_total", "Object context cache lookups");
+  osd_plb.add_u64_counter(
+    l_osd_object_ctx_attrs_batched, "object_ctx_attrs_batched",
+    "Object context cache misses loaded with a single getattrs");
 
   osd_plb.add_u64_counter(l_osd_op_cache_hit, "op_cache_hit");
   osd_plb.add_time_avg(
@@ -278,6 +290,46 @@ PerfCounters *build_osd_logger(CephContext *cct) {
   osd_plb.add_u64_counter(
     l_osd_pg_biginfo, "osd_pg_biginfo", "PG updated its biginfo attr");
 
+  osd_plb.add_u64_counter(
+    l_osd_snap_trim_clones, "snap_trim_clones",
+    "Clones trimmed or updated by snap trimming");
+  osd_plb.add_u64_counter(
+    l_osd_snap_trim_kv_bytes, "snap_trim_kv_bytes",
+    "Snap mapper bytes written by snap trimming", NULL, 0, unit_t(UNIT_BYTES));
+
+  osd_plb.add_u64_counter(
+    l_osd_ec_cache_hit, "ec_cache_hit",
+    "EC client reads served from recently written stripes");
+  osd_plb.add_u64_counter(
+    l_osd_ec_cache_miss, "ec_cache_miss",
+    "EC client reads that had to read shards");
+  osd_plb.add_u64(
+    l_osd_ec_cache_bytes, "ec_cache_bytes",
+    "Recently written EC stripe data retained for reads", NULL, 0,
+    unit_t(UNIT_BYTES));
+  osd_plb.add_u64_counter(
+    l_osd_ec_recovery_remote_bytes_avoided, "ec_recovery_remote_bytes_avoided",
+    "EC recovery bytes read inside the crush-locality subtree instead of "
+    "across it", NULL, 0, unit_t(UNIT_BYTES));
+
+  osd_plb.add_u64_counter(
+    l_osd_op_local_core, "op_local_core",
+    "Ops whose PG lives on the core that received them (crimson)");
+  osd_plb.add_u64_counter(
+    l_osd_op_remote_core, "op_remote_core",
+    "Ops forwarded to the core owning their PG (crimson)");
+
+  osd_plb.add_u64_counter(
+    l_osd_notify, "notify", "Notifies started");
+  osd_plb.add_u64_counter(
+    l_osd_notify_watchers, "notify_watchers",
+    "Watchers a notify was sent to");
+  osd_plb.add_u64_counter(
+    l_osd_notify_timeout, "notify_timeout", "Notifies that timed out");
+  osd_plb.add_time_avg_hist(
+    l_osd_notify_lat, "notify_latency",
+    "Time from notify until all watchers acked or it timed out");
+
   return osd_plb.create_perf_counters();
 }
  
@@ -38,6 +38,7 @@ enum {
 
   l_osd_op_before_queue_op_lat,
   l_osd_op_before_dequeue_op_lat,
+  l_osd_op_wq_steals,
 
   l_osd_sop,
   l_osd_sop_inb,
@@ -81,6 +82,8 @@ enum {
   l_osd_map_cache_miss_low_avg,
   l_osd_map_bl_cache_hit,
   l_osd_map_bl_cache_miss,
+  l_osd_map_msg_cache_hit,
+  l_osd_map_msg_cache_miss,
 
   l_osd_stat_bytes,
   l_osd_stat_bytes_used,
@@ -108,6 +111,7 @@ enum {
 
   l_osd_object_ctx_cache_hit,
   l_osd_object_ctx_cache_total,
+  l_osd_object_ctx_attrs_batched,
 
   l_osd_op_cache_hit,
   l_osd_tier_flush_lat,
@@ -118,6 +122,22 @@ enum {
   l_osd_pg_fastinfo,
   l_osd_pg_biginfo,
 
+  l_osd_snap_trim_clones,
+  l_osd_snap_trim_kv_bytes,
+
+  l_osd_ec_cache_hit,
+  l_osd_ec_cache_miss,
+  l_osd_ec_cache_bytes,
+  l_osd_ec_recovery_remote_bytes_avoided,
+
+  l_osd_op_local_core,
+  l_osd_op_remote_core,
+
+  l_osd_notify,
+  l_osd_notify_watchers,
+  l_osd_notify_timeout,
+  l_osd_notify_lat,
+
   l_osd_last,
 };
 
@@ -1375,7 +1375,13 @@ static opt_mapping_t opt_mapping = boost::assign::map_list_of
            ("dedup_cdc_chunk_size", pool_opts_t::opt_desc_t(
 	     pool_opts_t::DEDUP_CDC_CHUNK_SIZE, pool_opts_t::INT))
 	   ("pg_num_max", pool_opts_t::opt_desc_t(
-             pool_opts_t::PG_NUM_MAX, pool_opts_t::INT));
+             pool_opts_t::PG_NUM_MAX, pool_opts_t::INT))
+	   ("mclock_res", pool_opts_t::opt_desc_t(
+             pool_opts_t::MCLOCK_RES, pool_opts_t::INT))
+	   ("mclock_wgt", pool_opts_t::opt_desc_t(
+             pool_opts_t::MCLOCK_WGT, pool_opts_t::INT))
+	   ("mclock_lim", pool_opts_t::opt_desc_t(
+             pool_opts_t::MCLOCK_LIM, pool_opts_t::INT));
 
 bool pool_opts_t::is_opt_name(const std::string& name)
 {
@@ -1792,6 +1798,30 @@ uint32_t pg_pool_t::hash_key(const string& key, const string& ns) const
   return ceph_str_hash(object_hash, &buf[0], len);
 }
 
+void pg_pool_t::hash_keys(const vector<string>& keys, const string& ns,
+			  vector<uint32_t> *hashes) const
+{
+  vector<string> nskeys;
+  if (!ns.empty()) {
+    nskeys.reserve(keys.size());
+    for (auto& key : keys) {
+      nskeys.push_back(ns + '\037' + key);
+    }
+  }
+  const auto& in = ns.empty() ? keys : nskeys;
+  vector<const char*> strs;
+  vector<unsigned> lens;
+  strs.reserve(in.size());
+  lens.reserve(in.size());
+  for (auto& key : in) {
+    strs.push_back(key.data());
+    lens.push_back(key.length());
+  }
+  hashes->resize(in.size());
+  ceph_str_hash_batch(object_hash, strs.data(), lens.data(), in.size(),
+		      hashes->data());
+}
+
 uint32_t pg_pool_t::raw_hash_to_pg(uint32_t v) const
 {
   return ceph_stable_mod(v, pg_num, pg_num_mask);
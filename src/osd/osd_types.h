@@ -1078,6 +1078,9 @@ public:
     DEDUP_CHUNK_ALGORITHM,
     DEDUP_CDC_CHUNK_SIZE,
     PG_NUM_MAX, // max pg_num
+    MCLOCK_RES, // mclock client profile of the pool's namespaces
+    MCLOCK_WGT,
+    MCLOCK_LIM,
   };
 
   enum type_t {
@@ -1821,6 +1824,9 @@ public:
 
   /// hash a object name+namespace key to a hash position
   uint32_t hash_key(const std::string& key, const std::string& ns) const;
+  /// hash_key() for many keys in one namespace
+  void hash_keys(const std::vector<std::string>& keys, const std::string& ns,
+		 std::vector<uint32_t> *hashes) const;
 
   /// round a hash position down to a pg num
   uint32_t raw_hash_to_pg(uint32_t v) const;
@@ -4255,8 +4261,9 @@ struct pg_log_entry_t {
   osd_reqid_t reqid;  // caller+tid to uniquely identify request
   mempool::osd_pglog::vector<std::pair<osd_reqid_t, version_t> > extra_reqids;
 
-  /// map extra_reqids by index to error return code (if any)
-  mempool::osd_pglog::map<uint32_t, int> extra_reqid_return_codes;
+  /// map extra_reqids by index to error return code (if any); almost
+  /// always empty, so keep it flat rather than paying for an rb-tree
+  mempool::osd_pglog::flat_map<uint32_t, int> extra_reqid_return_codes;
 
   eversion_t version, prior_version, reverting_to;
   version_t user_version; // the user version for this entry
@@ -99,6 +99,17 @@ public:
 
   };
 
+  /// mclock client profile of a client op, derived from the pool options
+  /// of its pool; ops of each (pool, namespace) pair share one profile
+  struct qos_profile_t {
+    uint64_t id = 0;  ///< 0 if the op uses the default client allocations
+    int64_t pool = -1;
+    std::string nspace;
+    uint64_t res = 0; ///< 0 means the osd_mclock_scheduler_client_* default
+    uint64_t wgt = 0;
+    uint64_t lim = 0;
+  };
+
 private:
   OpQueueable::Ref qitem;
   int cost;
@@ -108,6 +119,7 @@ private:
   epoch_t map_epoch;    ///< an epoch we expect the PG to exist in
   int qos_cost;  ///< scaled cost calculated by the mclock scheduler
   bool qos_item;  ///< set to true if item is scheduled by mclock scheduler
+  qos_profile_t qos_profile;
 
 public:
   OpSchedulerItem(
@@ -191,6 +203,14 @@ public:
     return qos_cost;
   }
 
+  void set_qos_profile(qos_profile_t&& profile) {
+    qos_profile = std::move(profile);
+  }
+
+  const qos_profile_t& get_qos_profile() const {
+    return qos_profile;
+  }
+
   friend std::ostream& operator<<(std::ostream& out, const OpSchedulerItem& item) {
     out << "OpSchedulerItem("
         << item.get_ordering_token() << " " << *item.qitem;
@@ -61,10 +61,16 @@ mClockScheduler::mClockScheduler(CephContext *cct,
 
 void mClockScheduler::ClientRegistry::update_from_config(const ConfigProxy &conf)
 {
-  default_external_client_info.update(
-    conf.get_val<uint64_t>("osd_mclock_scheduler_client_res"),
-    conf.get_val<uint64_t>("osd_mclock_scheduler_client_wgt"),
-    conf.get_val<uint64_t>("osd_mclock_scheduler_client_lim"));
+  default_res = conf.get_val<uint64_t>("osd_mclock_scheduler_client_res");
+  default_wgt = conf.get_val<uint64_t>("osd_mclock_scheduler_client_wgt");
+  default_lim = conf.get_val<uint64_t>("osd_mclock_scheduler_client_lim");
+  default_external_client_info.update(default_res, default_wgt, default_lim);
+
+  // profile fields left unset in the pool follow the client defaults
+  for (auto &[id, client] : external_client_infos) {
+    auto info = make_profile_info(client.profile);
+    client.info.update(info.reservation, info.weight, info.limit);
+  }
 
   internal_client_infos[
     static_cast<size_t>(op_scheduler_class::background_recovery)].update(
@@ -86,7 +92,50 @@ const dmc::ClientInfo *mClockScheduler::ClientRegistry::get_external_client(
   if (ret == external_client_infos.end())
     return &default_external_client_info;
   else
-    return &(ret->second);
+    return &(ret->second.info);
+}
+
+dmc::ClientInfo mClockScheduler::ClientRegistry::make_profile_info(
+  const OpSchedulerItem::qos_profile_t &profile) const
+{
+  return dmc::ClientInfo(
+    profile.res ? profile.res : default_res,
+    profile.wgt ? profile.wgt : default_wgt,
+    profile.lim ? profile.lim : default_lim);
+}
+
+void mClockScheduler::ClientRegistry::update_profile(
+  const client_profile_id_t &id,
+  const OpSchedulerItem::qos_profile_t &profile)
+{
+  auto p = external_client_infos.find(id);
+  if (p == external_client_infos.end()) {
+    external_client_infos.emplace(
+      id, external_client_t(profile, make_profile_info(profile)));
+  } else if (p->second.profile.res != profile.res ||
+	     p->second.profile.wgt != profile.wgt ||
+	     p->second.profile.lim != profile.lim) {
+    // pool options changed; update in place so dmclock sees it
+    p->second.profile = profile;
+    auto info = make_profile_info(profile);
+    p->second.info.update(info.reservation, info.weight, info.limit);
+  }
+}
+
+void mClockScheduler::ClientRegistry::dump_profiles(ceph::Formatter &f) const
+{
+  f.open_array_section("client_profiles");
+  for (auto &[id, client] : external_client_infos) {
+    f.open_object_section("profile");
+    f.dump_unsigned("profile_id", id.profile_id);
+    f.dump_int("pool", client.profile.pool);
+    f.dump_string("namespace", client.profile.nspace);
+    f.dump_float("reservation", client.info.reservation);
+    f.dump_float("weight", client.info.weight);
+    f.dump_float("limit", client.info.limit);
+    f.close_section();
+  }
+  f.close_section();
 }
 
 const dmc::ClientInfo *mClockScheduler::ClientRegistry::get_info(
@@ -426,6 +475,9 @@ void mClockScheduler::dump(ceph::Formatter &f) const
   f.dump_string("clients", out.str());
   f.close_section();
 
+  // pool/namespace client profiles (res, wgt, lim)
+  client_registry.dump_profiles(f);
+
   // Display sorted queues (res, wgt, lim)
   f.open_object_section("mClockQueues");
   f.dump_string("queues", display_queues());
@@ -440,6 +492,10 @@ void mClockScheduler::enqueue(OpSchedulerItem&& item)
   if (op_scheduler_class::immediate == id.class_id) {
     immediate.push_front(std::move(item));
   } else {
+    if (id.client_profile_id.profile_id) {
+      client_registry.update_profile(id.client_profile_id,
+				     item.get_qos_profile());
+    }
     int cost = calc_scaled_cost(item.get_cost());
     item.set_qos_cost(cost);
     dout(20) << __func__ << " " << id
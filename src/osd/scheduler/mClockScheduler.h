@@ -117,14 +117,32 @@ class mClockScheduler : public OpScheduler, md_config_obs_t {
     };
 
     crimson::dmclock::ClientInfo default_external_client_info = {1, 1, 1};
-    std::map<client_profile_id_t,
-	     crimson::dmclock::ClientInfo> external_client_infos;
+    uint64_t default_res = 1;
+    uint64_t default_wgt = 1;
+    uint64_t default_lim = 1;
+
+    struct external_client_t {
+      OpSchedulerItem::qos_profile_t profile;
+      crimson::dmclock::ClientInfo info;
+      external_client_t(const OpSchedulerItem::qos_profile_t &p,
+			const crimson::dmclock::ClientInfo &i)
+	: profile(p), info(i) {}
+    };
+    // entries are never erased: dmclock keeps pointers to the ClientInfo
+    // of every client it has seen
+    std::map<client_profile_id_t, external_client_t> external_client_infos;
     const crimson::dmclock::ClientInfo *get_external_client(
       const client_profile_id_t &client) const;
+    crimson::dmclock::ClientInfo make_profile_info(
+      const OpSchedulerItem::qos_profile_t &profile) const;
   public:
     void update_from_config(const ConfigProxy &conf);
     const crimson::dmclock::ClientInfo *get_info(
       const scheduler_id_t &id) const;
+    /// register or refresh the pool/namespace profile of a client op
+    void update_profile(const client_profile_id_t &id,
+			const OpSchedulerItem::qos_profile_t &profile);
+    void dump_profiles(ceph::Formatter &f) const;
   } client_registry;
 
   using mclock_queue_t = crimson::dmclock::PullPriorityQueue<
@@ -137,6 +155,15 @@ class mClockScheduler : public OpScheduler, md_config_obs_t {
   std::list<OpSchedulerItem> immediate;
 
   static scheduler_id_t get_scheduler_id(const OpSchedulerItem &item) {
+    auto &profile = item.get_qos_profile();
+    if (profile.id &&
+	item.get_scheduler_class() == op_scheduler_class::client) {
+      // all clients of a pool/namespace share the profile's allocations
+      return scheduler_id_t{
+	op_scheduler_class::client,
+	client_profile_id_t{0, profile.id}
+      };
+    }
     return scheduler_id_t{
       item.get_scheduler_class(),
 	client_profile_id_t{
@@ -115,6 +115,47 @@ std::optional<double> ScrubQueue::update_load_average()
   return std::nullopt;
 }
 
+void ScrubQueue::update_io_load(uint64_t ops_in_flight)
+{
+  if (!conf().get_val<bool>("osd_scrub_io_aware")) {
+    return;
+  }
+  // smooth over a few heartbeats, so that a single burst of ops does not
+  // flip scrubbing on and off
+  double updated =
+    io_load.load(std::memory_order_relaxed) * 0.75 + ops_in_flight * 0.25;
+  io_load.store(updated, std::memory_order_relaxed);
+  dout(17) << "heartbeat: ops in flight " << ops_in_flight << " io_load "
+	   << updated << dendl;
+}
+
+std::optional<double> ScrubQueue::io_load_ratio() const
+{
+  if (!conf().get_val<bool>("osd_scrub_io_aware")) {
+    return std::nullopt;
+  }
+  const auto high = conf().get_val<uint64_t>("osd_scrub_io_load_high");
+  if (high == 0) {
+    return std::nullopt;
+  }
+  return io_load.load(std::memory_order_relaxed) / high;
+}
+
+bool ScrubQueue::io_load_is_high() const
+{
+  auto ratio = io_load_ratio();
+  return ratio && *ratio >= 1.0;
+}
+
+double ScrubQueue::chunk_size_scale() const
+{
+  auto ratio = io_load_ratio();
+  if (!ratio) {
+    return 1.0;
+  }
+  return std::clamp(2.0 - 2.0 * *ratio, 0.0, 2.0);
+}
+
 /*
  * Modify the scrub job state:
  * - if 'registered' (as expected): mark as 'unregistering'. The job will be
@@ -348,7 +389,7 @@ Scrub::schedule_result_t ScrubQueue::select_pg_and_scrub(
   utime_t now_is = time_now();
 
   preconds.time_permit = scrub_time_permit(now_is);
-  preconds.load_is_low = scrub_load_below_threshold();
+  preconds.load_is_low = scrub_load_below_threshold() && !io_load_is_high();
   preconds.only_deadlined = !preconds.time_permit || !preconds.load_is_low;
 
   //  create a list of candidates (copying, as otherwise creating a deadlock):
@@ -562,12 +603,13 @@ double ScrubQueue::scrub_sleep_time(bool must_scrub) const
 {
   double regular_sleep_period = conf()->osd_scrub_sleep;
 
-  if (must_scrub || scrub_time_permit(time_now())) {
+  if (must_scrub ||
+      (scrub_time_permit(time_now()) && !io_load_is_high())) {
     return regular_sleep_period;
   }
 
   // relevant if scrubbing started during allowed time, but continued into
-  // forbidden hours
+  // forbidden hours (or into a client I/O peak)
   double extended_sleep = conf()->osd_scrub_extended_sleep;
   dout(20) << "w/ extended sleep (" << extended_sleep << ")" << dendl;
   return std::max(extended_sleep, regular_sleep_period);
@@ -406,6 +406,19 @@ class ScrubQueue {
    */
   [[nodiscard]] std::optional<double> update_load_average();
 
+  /**
+   *  called every heartbeat with the number of ops in progress on the OSD
+   *  (only tracked if osd_scrub_io_aware is set)
+   */
+  void update_io_load(uint64_t ops_in_flight);
+
+  /**
+   * a factor (0 to 2) to apply to the configured maximal chunk size:
+   * 1 at half of osd_scrub_io_load_high, larger as the OSD becomes idle,
+   * 0 (i.e. the minimal chunk) at or above the high mark.
+   */
+  double chunk_size_scale() const;
+
  private:
   CephContext* cct;
   Scrub::ScrubSchedListener& osd_service;
@@ -433,6 +446,9 @@ class ScrubQueue {
 
   double daily_loadavg{0.0};
 
+  /// smoothed count of ops in progress (see update_io_load())
+  std::atomic<double> io_load{0.0};
+
   static inline constexpr auto registered_job = [](const auto& jobref) -> bool {
     return jobref->state == qu_state_t::registered;
   };
@@ -487,6 +503,10 @@ class ScrubQueue {
   std::atomic_bool a_pg_is_reserving{false};
 
   [[nodiscard]] bool scrub_load_below_threshold() const;
+
+  /// the smoothed I/O load relative to osd_scrub_io_load_high, if enabled
+  [[nodiscard]] std::optional<double> io_load_ratio() const;
+  [[nodiscard]] bool io_load_is_high() const;
   [[nodiscard]] bool scrub_time_permit(utime_t now) const;
 
   /**
@@ -705,12 +705,14 @@ bool PgScrubber::select_range()
       m_is_deep, conf, "osd_scrub_chunk_max", "osd_shallow_scrub_chunk_max");
 
   const int divisor = static_cast<int>(preemption_data.chunk_divisor());
+  const double io_scale = m_osds->get_scrub_services().chunk_size_scale();
   const int min_chunk_sz = std::max(3, min_from_conf / divisor);
-  const int max_chunk_sz = std::max(min_chunk_sz, max_from_conf / divisor);
+  const int max_chunk_sz = std::max(
+      min_chunk_sz, static_cast<int>(max_from_conf * io_scale) / divisor);
 
   dout(10) << fmt::format(
-		  "{}: Min: {} Max: {} Div: {}", __func__, min_chunk_sz,
-		  max_chunk_sz, divisor)
+		  "{}: Min: {} Max: {} Div: {} I/O scale: {:.2f}", __func__,
+		  min_chunk_sz, max_chunk_sz, divisor, io_scale)
 	   << dendl;
 
   hobject_t start = m_start;
@@ -1052,6 +1052,29 @@ void ObjectCacher::bh_write_adjacencies(BufferHead *bh, ceph::real_time cutoff,
   bh_write_scattered(blist);
 }
 
+/*
+ * write back the dirty data of every object in the set, one scattered
+ * write per object, until *max_amount is used up.
+ */
+void ObjectCacher::bh_write_oset(ObjectSet *oset, ceph::real_time cutoff,
+				 int64_t *max_amount)
+{
+  ceph_assert(ceph_mutex_is_locked(lock));
+  for (xlist<Object*>::iterator i = oset->objects.begin();
+       !i.end() && *max_amount > 0; ++i) {
+    Object *ob = *i;
+    list<BufferHead*> blist;
+    for (auto& [off, bh] : ob->data) {
+      if (bh->is_dirty() && bh->last_write <= cutoff) {
+	blist.push_back(bh);
+	*max_amount -= bh->length();
+      }
+    }
+    if (!blist.empty())
+      bh_write_scattered(blist);
+  }
+}
+
 class ObjectCacher::C_WriteCommit : public Context {
   ObjectCacher *oc;
   int64_t poolid;
@@ -1299,6 +1322,11 @@ void ObjectCacher::flush(ZTracer::Trace *trace, loff_t amount)
 
     if (scattered_write) {
       bh_write_adjacencies(bh, cutoff, amount > 0 ? &left : NULL, NULL);
+      // write back the rest of the same file while we are at it, as
+      // whole-object writes, rather than interleaving small writes to
+      // every file in lru order
+      if (amount > 0 && left > 0)
+	bh_write_oset(bh->ob->oset, cutoff, &left);
     } else {
       left -= bh->length();
       bh_write(bh, *trace);
@@ -539,6 +539,8 @@ class ObjectCacher {
   void bh_write_scattered(std::list<BufferHead*>& blist);
   void bh_write_adjacencies(BufferHead *bh, ceph::real_time cutoff,
 			    int64_t *amount, int *max_count);
+  void bh_write_oset(ObjectSet *oset, ceph::real_time cutoff,
+		     int64_t *amount);
 
   void trim();
   void flush(ZTracer::Trace *trace, loff_t amount=0);
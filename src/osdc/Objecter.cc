@@ -28,6 +28,7 @@
 
 #include "messages/MPing.h"
 #include "messages/MOSDOp.h"
+#include "messages/MOSDOpBatch.h"
 #include "messages/MOSDOpReply.h"
 #include "messages/MOSDBackoff.h"
 #include "messages/MOSDMap.h"
@@ -179,6 +180,11 @@ enum {
   l_osdc_osdop_omap_rd,
   l_osdc_osdop_omap_del,
 
+  l_osdc_rwlock_rd_wait,
+  l_osdc_rwlock_wr_wait,
+  l_osdc_session_lock_wait,
+  l_osdc_op_submit_relock,
+
   l_osdc_last,
 };
 
@@ -219,6 +225,9 @@ const char** Objecter::get_tracked_conf_keys() const
     "crush_location",
     "rados_mon_op_timeout",
     "rados_osd_op_timeout",
+    "objecter_op_batch_max",
+    "objecter_op_batch_window",
+    "objecter_balance_reads_by_load",
     NULL
   };
   return config_keys;
@@ -237,6 +246,17 @@ void Objecter::handle_conf_change(const ConfigProxy& conf,
   if (changed.count("rados_osd_op_timeout")) {
     osd_timeout = conf.get_val<std::chrono::seconds>("rados_osd_op_timeout");
   }
+  if (changed.count("objecter_op_batch_max")) {
+    op_batch_max = conf.get_val<uint64_t>("objecter_op_batch_max");
+  }
+  if (changed.count("objecter_op_batch_window")) {
+    op_batch_window = conf.get_val<std::chrono::milliseconds>(
+      "objecter_op_batch_window");
+  }
+  if (changed.count("objecter_balance_reads_by_load")) {
+    balance_reads_by_load = conf.get_val<bool>(
+      "objecter_balance_reads_by_load");
+  }
 }
 
 void Objecter::update_crush_location()
@@ -377,6 +397,16 @@ void Objecter::init()
     pcb.add_u64_counter(l_osdc_osdop_omap_del, "omap_del",
 			"OSD OMAP delete operations");
 
+    pcb.add_time_avg(l_osdc_rwlock_rd_wait, "rwlock_rd_wait",
+		     "Time op submit/reply waited for the map lock (shared)");
+    pcb.add_time_avg(l_osdc_rwlock_wr_wait, "rwlock_wr_wait",
+		     "Time op submit waited for the map lock (exclusive)");
+    pcb.add_time_avg(l_osdc_session_lock_wait, "session_lock_wait",
+		     "Time op submit/reply waited for an OSD session lock");
+    pcb.add_u64_counter(l_osdc_op_submit_relock, "op_submit_relock",
+			"Op submissions that had to retake the map lock "
+			"exclusively");
+
     logger = pcb.create_perf_counters();
     cct->get_perfcounters_collection()->add(logger);
   }
@@ -1874,6 +1904,50 @@ int Objecter::_get_session(int osd, OSDSession **session,
   return 0;
 }
 
+/*
+ * The op fast paths try the lock first and only read the clock when
+ * that fails, so the uncontended case costs nothing extra.  logger may
+ * already be gone if we lost a race with shutdown().
+ */
+void Objecter::_lock_shared_timed(shunique_lock<ceph::shared_mutex>& sul)
+{
+  if (sul.try_lock_shared()) {
+    return;
+  }
+  auto start = ceph::coarse_mono_clock::now();
+  sul.lock_shared();
+  if (logger) {
+    logger->tinc(l_osdc_rwlock_rd_wait,
+		 ceph::coarse_mono_clock::now() - start);
+  }
+}
+
+void Objecter::_lock_unique_timed(shunique_lock<ceph::shared_mutex>& sul)
+{
+  if (sul.try_lock()) {
+    return;
+  }
+  auto start = ceph::coarse_mono_clock::now();
+  sul.lock();
+  if (logger) {
+    logger->tinc(l_osdc_rwlock_wr_wait,
+		 ceph::coarse_mono_clock::now() - start);
+  }
+}
+
+void Objecter::_lock_session_timed(std::unique_lock<std::shared_mutex>& sl)
+{
+  if (sl.try_lock()) {
+    return;
+  }
+  auto start = ceph::coarse_mono_clock::now();
+  sl.lock();
+  if (logger) {
+    logger->tinc(l_osdc_session_lock_wait,
+		 ceph::coarse_mono_clock::now() - start);
+  }
+}
+
 void Objecter::put_session(Objecter::OSDSession *s)
 {
   if (s && !s->is_homeless()) {
@@ -1907,6 +1981,7 @@ void Objecter::_reopen_session(OSDSession *s)
     s->con->mark_down();
     logger->inc(l_osdc_osd_session_close);
   }
+  _cancel_op_batch(s);
   s->con = messenger->connect_to_osd(addrs);
   s->con->set_priv(RefCountedPtr{s});
   s->incarnation++;
@@ -1924,6 +1999,7 @@ void Objecter::close_session(OSDSession *s)
     logger->inc(l_osdc_osd_session_close);
   }
   unique_lock sl(s->lock);
+  _cancel_op_batch(s);
 
   std::list<LingerOp*> homeless_lingers;
   std::list<CommandOp*> homeless_commands;
@@ -2267,7 +2343,8 @@ void Objecter::resend_mon_ops()
 
 void Objecter::op_submit(Op *op, ceph_tid_t *ptid, int *ctx_budget)
 {
-  shunique_lock rl(rwlock, ceph::acquire_shared);
+  shunique_lock<ceph::shared_mutex> rl(rwlock, std::defer_lock);
+  _lock_shared_timed(rl);
   ceph_tid_t tid = 0;
   if (!ptid)
     ptid = &tid;
@@ -2413,7 +2490,8 @@ void Objecter::_op_submit(Op *op, shunique_lock<ceph::shared_mutex>& sul, ceph_t
     if (cct->_conf->objecter_debug_inject_relock_delay) {
       sleep(1);
     }
-    sul.lock();
+    _lock_unique_timed(sul);
+    logger->inc(l_osdc_op_submit_relock);
     if (orig_epoch != osdmap->get_epoch()) {
       // map changed; recalculate mapping
       ldout(cct, 10) << __func__ << " relock raced with osdmap, recalc target"
@@ -2451,7 +2529,8 @@ void Objecter::_op_submit(Op *op, shunique_lock<ceph::shared_mutex>& sul, ceph_t
     _maybe_request_map();
   }
 
-  unique_lock sl(s->lock);
+  unique_lock sl(s->lock, std::defer_lock);
+  _lock_session_timed(sl);
   if (op->tid == 0)
     op->tid = ++last_tid;
 
@@ -2772,6 +2851,32 @@ void Objecter::_prune_snapc(
   }
 }
 
+int Objecter::_pick_read_replica(const std::vector<int>& acting)
+{
+  // rwlock is locked
+
+  // power of two choices: compare two random members of the acting set
+  // and take the one whose session looks less loaded.  an osd without a
+  // session yet costs nothing, so that it gets tried.
+  auto cost = [this](int osd) -> double {
+    auto p = osd_sessions.find(osd);
+    if (p == osd_sessions.end()) {
+      return 0;
+    }
+    const OSDSession *s = p->second;
+    return (s->latency_avg.load(std::memory_order_relaxed) + 1.0) *
+      (s->num_ops.load(std::memory_order_relaxed) + 1);
+  };
+  int n = acting.size();
+  int a = rand() % n;
+  int b = (a + 1 + rand() % (n - 1)) % n;
+  int pick = cost(acting[b]) < cost(acting[a]) ? b : a;
+  ldout(cct, 20) << __func__ << " osd." << acting[a] << " cost "
+		 << cost(acting[a]) << " vs osd." << acting[b] << " cost "
+		 << cost(acting[b]) << dendl;
+  return pick;
+}
+
 int Objecter::_calc_target(op_target_t *t, Connection *con, bool any_change)
 {
   // rwlock is locked
@@ -2960,12 +3065,14 @@ int Objecter::_calc_target(op_target_t *t, Connection *con, bool any_change)
       int osd;
       ceph_assert(is_read && t->acting[0] == acting_primary);
       if (t->flags & CEPH_OSD_FLAG_BALANCE_READS) {
-	int p = rand() % t->acting.size();
+	int p = balance_reads_by_load ?
+	  _pick_read_replica(t->acting) : rand() % t->acting.size();
 	if (p)
 	  t->used_replica = true;
 	osd = t->acting[p];
-	ldout(cct, 10) << " chose random osd." << osd << " of " << t->acting
-		       << dendl;
+	ldout(cct, 10) << " chose " << (balance_reads_by_load ? "least loaded" :
+					 "random")
+		       << " osd." << osd << " of " << t->acting << dendl;
       } else {
 	// look for a local replica.  prefer the primary if the
 	// distance is the same.
@@ -3023,6 +3130,7 @@ void Objecter::_session_op_assign(OSDSession *to, Op *op)
   get_session(to);
   op->session = to;
   to->ops[op->tid] = op;
+  to->num_ops++;
 
   if (to->is_homeless()) {
     num_homeless_ops++;
@@ -3041,6 +3149,7 @@ void Objecter::_session_op_remove(OSDSession *from, Op *op)
   }
 
   from->ops.erase(op->tid);
+  from->num_ops--;
   put_session(from);
   op->session = NULL;
 
@@ -3311,7 +3420,71 @@ void Objecter::_send_op(Op *op)
   if (op->trace.valid()) {
     m->trace.init("op msg", nullptr, &op->trace);
   }
-  op->session->con->send_message(m);
+  if (op_batch_max > 1 &&
+      con->has_features(CEPH_FEATUREMASK_OSD_OP_BATCH)) {
+    _batch_op(op->session, m);
+  } else {
+    op->session->con->send_message(m);
+  }
+}
+
+void Objecter::_batch_op(OSDSession *s, MOSDOp *m)
+{
+  // s->lock is locked unique
+
+  s->op_batch.emplace_back(m, false);
+  if (s->op_batch.size() >= op_batch_max) {
+    _flush_op_batch(s);
+  } else if (s->op_batch.size() == 1) {
+    s->get();
+    s->op_batch_timer = timer.add_event(
+      op_batch_window,
+      [this, s]() {
+	unique_lock sl(s->lock);
+	s->op_batch_timer = 0;
+	_flush_op_batch(s);
+	sl.unlock();
+	s->put();
+      });
+  }
+}
+
+void Objecter::_flush_op_batch(OSDSession *s)
+{
+  // s->lock is locked unique
+
+  if (s->op_batch_timer) {
+    if (timer.cancel_event(s->op_batch_timer)) {
+      s->put();
+    }
+    s->op_batch_timer = 0;
+  }
+  if (s->op_batch.empty()) {
+    return;
+  }
+  ldout(cct, 15) << __func__ << " " << s->op_batch.size() << " ops to osd."
+		 << s->osd << dendl;
+  if (s->op_batch.size() == 1) {
+    s->con->send_message2(std::move(s->op_batch.front()));
+  } else {
+    s->con->send_message2(
+      ceph::make_message<MOSDOpBatch>(std::move(s->op_batch)));
+  }
+  s->op_batch.clear();
+}
+
+void Objecter::_cancel_op_batch(OSDSession *s)
+{
+  // s->lock is locked unique
+
+  // the ops are still in s->ops and are resent with the session
+  s->op_batch.clear();
+  if (s->op_batch_timer) {
+    if (timer.cancel_event(s->op_batch_timer)) {
+      s->put();
+    }
+    s->op_batch_timer = 0;
+  }
 }
 
 int Objecter::calc_op_budget(const bc::small_vector_base<OSDOp>& ops)
@@ -3372,7 +3545,8 @@ void Objecter::handle_osd_op_reply(MOSDOpReply *m)
   // get pio
   ceph_tid_t tid = m->get_tid();
 
-  shunique_lock sul(rwlock, ceph::acquire_shared);
+  shunique_lock<ceph::shared_mutex> sul(rwlock, std::defer_lock);
+  _lock_shared_timed(sul);
   if (!initialized) {
     m->put();
     return;
@@ -3387,7 +3561,8 @@ void Objecter::handle_osd_op_reply(MOSDOpReply *m)
     return;
   }
 
-  unique_lock sl(s->lock);
+  unique_lock sl(s->lock, std::defer_lock);
+  _lock_session_timed(sl);
 
   map<ceph_tid_t, Op *>::iterator iter = s->ops.find(tid);
   if (iter == s->ops.end()) {
@@ -3567,7 +3742,15 @@ void Objecter::handle_osd_op_reply(MOSDOpReply *m)
     op->onfinish = nullptr;
   }
   logger->inc(l_osdc_op_reply);
-  logger->tinc(l_osdc_op_latency, ceph::coarse_mono_time::clock::now() - op->stamp);
+  {
+    auto lat = ceph::coarse_mono_time::clock::now() - op->stamp;
+    logger->tinc(l_osdc_op_latency, lat);
+    // moving average with weight 1/8, as used for srtt in TCP
+    uint64_t ns = std::chrono::nanoseconds(lat).count();
+    uint64_t avg = s->latency_avg.load(std::memory_order_relaxed);
+    s->latency_avg.store(avg ? avg - avg / 8 + ns / 8 : ns,
+			 std::memory_order_relaxed);
+  }
   logger->set(l_osdc_op_inflight, num_in_flight);
 
   /* get it before we call _finish_op() */
@@ -5008,6 +5191,11 @@ Objecter::Objecter(CephContext *cct,
 {
   mon_timeout = cct->_conf.get_val<std::chrono::seconds>("rados_mon_op_timeout");
   osd_timeout = cct->_conf.get_val<std::chrono::seconds>("rados_osd_op_timeout");
+  op_batch_max = cct->_conf.get_val<uint64_t>("objecter_op_batch_max");
+  op_batch_window = cct->_conf.get_val<std::chrono::milliseconds>(
+    "objecter_op_batch_window");
+  balance_reads_by_load = cct->_conf.get_val<bool>(
+    "objecter_balance_reads_by_load");
 }
 
 Objecter::~Objecter()
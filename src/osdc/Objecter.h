@@ -2395,6 +2395,13 @@ public:
 
     int incarnation;
     ConnectionRef con;
+    // ops held back to go out together; see objecter_op_batch_max
+    std::vector<ceph::ref_t<MOSDOp>> op_batch;
+    uint64_t op_batch_timer = 0;
+    // recent reply latency (ns, moving average) and ops in flight; read
+    // without s->lock when choosing a replica for balanced reads
+    std::atomic<uint64_t> latency_avg{0};
+    std::atomic<uint32_t> num_ops{0};
     int num_locks;
     std::unique_ptr<std::mutex[]> completion_locks;
 
@@ -2453,9 +2460,16 @@ public:
 
   ceph::timespan mon_timeout;
   ceph::timespan osd_timeout;
+  uint64_t op_batch_max;
+  ceph::timespan op_batch_window;
+  bool balance_reads_by_load;
 
   MOSDOp *_prepare_osd_op(Op *op);
   void _send_op(Op *op);
+  void _batch_op(OSDSession *s, MOSDOp *m);
+  void _flush_op_batch(OSDSession *s);
+  void _cancel_op_batch(OSDSession *s);
+  int _pick_read_replica(const std::vector<int>& acting);
   void _send_op_account(Op *op);
   void _cancel_linger_op(Op *op);
   void _finish_op(Op *op, int r);
@@ -2539,6 +2553,9 @@ private:
 
   int _get_session(int osd, OSDSession **session,
 		   ceph::shunique_lock<ceph::shared_mutex>& sul);
+  void _lock_shared_timed(ceph::shunique_lock<ceph::shared_mutex>& sul);
+  void _lock_unique_timed(ceph::shunique_lock<ceph::shared_mutex>& sul);
+  void _lock_session_timed(std::unique_lock<std::shared_mutex>& sl);
   void put_session(OSDSession *s);
   void get_session(OSDSession *s);
   void _reopen_session(OSDSession *session);
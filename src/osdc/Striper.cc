@@ -204,6 +204,22 @@ void Striper::file_to_extents(
 		 << object_size << " stripes_per_object " << stripes_per_object
 		 << dendl;
 
+  if (object_extents->empty() && offset % su + len <= su) {
+    // the common case for small i/o: the range is within one stripe
+    // unit, so it maps to a single extent of a single object
+    uint64_t blockno = offset / su;
+    uint64_t stripeno = blockno / stripe_count;
+    uint64_t objectno = (stripeno / stripes_per_object) * stripe_count +
+      blockno % stripe_count;
+    uint64_t x_offset = (stripeno % stripes_per_object) * su + offset % su;
+    auto& ex = object_extents->emplace_back(
+      objectno, x_offset, len,
+      object_truncate_size(cct, layout, objectno, trunc_size));
+    ex.buffer_extents.emplace_back(buffer_offset, len);
+    ldout(cct, 15) << "file_to_extents  " << ex << dendl;
+    return;
+  }
+
   uint64_t cur = offset;
   uint64_t left = len;
   while (left > 0) {
@@ -744,6 +744,10 @@ int RGWAsyncFetchRemoteObj::_send_request(const DoutPrefixProvider *dpp)
   std::string etag;
 
   std::optional<uint64_t> bytes_transferred;
+  std::optional<PerfGuard> timer;
+  if (counters) {
+    timer.emplace(counters, sync_counters::l_fetch_latency);
+  }
   int r = store->getRados()->fetch_remote_obj(obj_ctx,
                        user_id.value_or(rgw_user()),
                        NULL, /* req_info */
@@ -774,6 +778,7 @@ int RGWAsyncFetchRemoteObj::_send_request(const DoutPrefixProvider *dpp)
                        filter.get(),
                        &zones_trace,
                        &bytes_transferred);
+  timer.reset();
 
   if (r < 0) {
     ldpp_dout(dpp, 0) << "store->fetch_remote_obj() returned r=" << r << dendl;
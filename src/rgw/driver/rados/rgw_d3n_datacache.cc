@@ -9,6 +9,7 @@
 #include "rgw_auth_s3.h"
 #include "rgw_op.h"
 #include "rgw_crypt_sanitize.h"
+#include "rgw_perf_counters.h"
 #if defined(__linux__)
 #include <features.h>
 #endif
@@ -94,11 +95,21 @@ void D3nDataCache::init(CephContext *_cct) {
   }
 
   auto conf_eviction_policy = cct->_conf.get_val<std::string>("rgw_d3n_l1_eviction_policy");
-  ceph_assert(conf_eviction_policy == "lru" || conf_eviction_policy == "random");
+  ceph_assert(conf_eviction_policy == "lru" || conf_eviction_policy == "random" ||
+              conf_eviction_policy == "weighted");
   if (conf_eviction_policy == "lru")
     eviction_policy = _eviction_policy::LRU;
   if (conf_eviction_policy == "random")
     eviction_policy = _eviction_policy::RANDOM;
+  if (conf_eviction_policy == "weighted")
+    eviction_policy = _eviction_policy::WEIGHTED;
+
+  admission_filter = cct->_conf.get_val<bool>("rgw_d3n_l1_admission_filter");
+  if (admission_filter || eviction_policy == _eviction_policy::WEIGHTED) {
+    // size the sketch for the number of chunks the cache can hold
+    frequency.init(free_data_cache_size /
+                   std::max<uint64_t>(1, cct->_conf->rgw_max_chunk_size));
+  }
 
 #if defined(HAVE_LIBAIO) && defined(__GLIBC__)
   // libaio setup
@@ -237,18 +248,30 @@ void D3nDataCache::put(bufferlist& bl, unsigned int len, std::string& oid)
     _outstanding_write_size = outstanding_write_size;
   }
   ldout(cct, 20) << "D3nDataCache: Before eviction _free_data_cache_size:" << _free_data_cache_size << ", _outstanding_write_size:" << _outstanding_write_size << ", freed_size:" << freed_size << dendl;
+  if (len > (_free_data_cache_size - _outstanding_write_size) && !admit(oid)) {
+    ldout(cct, 20) << "D3nDataCache: " << __func__ << "(): not admitting oid=" << oid << ", colder than the eviction candidate" << dendl;
+    if (perfcounter) {
+      perfcounter->inc(l_rgw_d3n_cache_admit_reject);
+    }
+    const std::lock_guard l(d3n_cache_lock);
+    d3n_outstanding_write_list.erase(oid);
+    return;
+  }
   while (len > (_free_data_cache_size - _outstanding_write_size + freed_size)) {
     ldout(cct, 20) << "D3nDataCache: enter eviction" << dendl;
     if (eviction_policy == _eviction_policy::LRU) {
       sr = lru_eviction();
     } else if (eviction_policy == _eviction_policy::RANDOM) {
       sr = random_eviction();
+    } else if (eviction_policy == _eviction_policy::WEIGHTED) {
+      sr = weighted_eviction();
     } else {
       ldout(cct, 0) << "D3nDataCache: Warning: unknown cache eviction policy, defaulting to lru eviction" << dendl;
       sr = lru_eviction();
     }
     if (sr == 0) {
       ldout(cct, 2) << "D3nDataCache: Warning: eviction was not able to free disk space, not writing to cache" << dendl;
+      const std::lock_guard l(d3n_cache_lock);
       d3n_outstanding_write_list.erase(oid);
       return;
     }
@@ -276,6 +299,7 @@ bool D3nDataCache::get(const string& oid, const off_t len)
   string location = cache_location + oid;
 
   lsubdout(g_ceph_context, rgw_datacache, 20) << "D3nDataCache: " << __func__ << "(): location=" << location << dendl;
+  frequency.increment(oid);
   std::unordered_map<string, D3nChunkDataInfo*>::iterator iter = d3n_cache_map.find(oid);
   if (!(iter == d3n_cache_map.end())) {
     // check inside cache whether file exists or not!!!! then make exist true;
@@ -297,9 +321,31 @@ bool D3nDataCache::get(const string& oid, const off_t len)
       exist = false;
     }
   }
+  if (perfcounter) {
+    if (exist) {
+      perfcounter->inc(l_rgw_d3n_cache_hit);
+      perfcounter->inc(l_rgw_d3n_cache_hit_bytes, len);
+    } else {
+      perfcounter->inc(l_rgw_d3n_cache_miss);
+    }
+  }
   return exist;
 }
 
+bool D3nDataCache::admit(const string& oid)
+{
+  if (!admission_filter) {
+    return true;
+  }
+  const std::lock_guard l(d3n_cache_lock);
+  const std::lock_guard le(d3n_eviction_lock);
+  if (tail == nullptr) {
+    return true;
+  }
+  // TinyLFU: a newcomer only displaces a chunk it is hotter than
+  return frequency.estimate(oid) > frequency.estimate(tail->oid);
+}
+
 size_t D3nDataCache::random_eviction()
 {
   lsubdout(g_ceph_context, rgw_datacache, 20) << "D3nDataCache: " << __func__ << "()" << dendl;
@@ -367,3 +413,40 @@ size_t D3nDataCache::lru_eviction()
   ::remove(location.c_str());
   return freed_size;
 }
+
+size_t D3nDataCache::weighted_eviction()
+{
+  lsubdout(g_ceph_context, rgw_datacache, 20) << "D3nDataCache: " << __func__ << "()" << dendl;
+  // among the few least recently used chunks, evict the one with the
+  // fewest accesses per byte
+  static constexpr int candidates = 8;
+  D3nChunkDataInfo* del_entry = nullptr;
+  string del_oid, location;
+  {
+    const std::lock_guard l(d3n_cache_lock);
+    const std::lock_guard le(d3n_eviction_lock);
+    double lowest = 0;
+    int i = 0;
+    for (auto o = tail; o != nullptr && i < candidates; o = o->lru_prev, ++i) {
+      const double score =
+        double(frequency.estimate(o->oid) + 1) / std::max<uint64_t>(1, o->size);
+      if (del_entry == nullptr || score < lowest) {
+        del_entry = o;
+        lowest = score;
+      }
+    }
+    if (del_entry == nullptr) {
+      ldout(cct, 2) << "D3nDataCache: weighted_eviction: del_entry=null_ptr" << dendl;
+      return 0;
+    }
+    lru_remove(del_entry);
+    del_oid = del_entry->oid;
+    ldout(cct, 20) << "D3nDataCache: weighted_eviction: oid to remove: " << del_oid << dendl;
+    d3n_cache_map.erase(del_oid);
+  }
+  const size_t freed_size = del_entry->size;
+  delete del_entry;
+  location = cache_location + del_oid;
+  ::remove(location.c_str());
+  return freed_size;
+}
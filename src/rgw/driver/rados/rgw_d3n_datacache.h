@@ -59,6 +59,70 @@ struct D3nCacheAioWriteRequest {
   }
 };
 
+/* Approximate access frequency of chunks (TinyLFU): a count-min sketch
+ * of 4-bit saturating counters that are halved once enough accesses have
+ * been recorded, so that the estimates follow recent popularity. */
+class D3nFrequencySketch {
+  static constexpr int depth = 4;
+  static constexpr uint8_t max_count = 15;
+  std::vector<uint8_t> table;
+  size_t mask = 0;
+  uint64_t additions = 0;
+  uint64_t sample_size = 0;
+
+  size_t index(size_t h, int i) const {
+    static constexpr uint64_t seeds[depth] = {
+      0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL,
+      0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL
+    };
+    uint64_t x = (h + seeds[i]) * seeds[(i + 1) % depth];
+    return (x >> 32) & mask;
+  }
+
+public:
+  void init(size_t entries) {
+    size_t width = 1024;
+    while (width < entries * 2) {
+      width <<= 1;
+    }
+    table.assign(width, 0);
+    mask = width - 1;
+    sample_size = width * 8;
+    additions = 0;
+  }
+
+  void increment(const std::string& key) {
+    if (table.empty()) {
+      return;
+    }
+    const size_t h = std::hash<std::string>{}(key);
+    for (int i = 0; i < depth; ++i) {
+      auto& c = table[index(h, i)];
+      if (c < max_count) {
+        ++c;
+      }
+    }
+    if (++additions >= sample_size) {
+      for (auto& c : table) {
+        c >>= 1;
+      }
+      additions /= 2;
+    }
+  }
+
+  uint8_t estimate(const std::string& key) const {
+    if (table.empty()) {
+      return 0;
+    }
+    const size_t h = std::hash<std::string>{}(key);
+    uint8_t est = max_count;
+    for (int i = 0; i < depth; ++i) {
+      est = std::min(est, table[index(h, i)]);
+    }
+    return est;
+  }
+};
+
 struct D3nDataCache {
 
 private:
@@ -74,8 +138,11 @@ private:
     SEND_FILE = 3
   } io_type;
   enum class _eviction_policy {
-    LRU=0, RANDOM=1
+    LRU=0, RANDOM=1, WEIGHTED=2
   } eviction_policy;
+  bool admission_filter = false;
+  // protected by d3n_cache_lock
+  D3nFrequencySketch frequency;
 
   struct sigaction action;
   uint64_t free_data_cache_size = 0;
@@ -101,6 +168,8 @@ public:
   void d3n_libaio_write_completion_cb(D3nCacheAioWriteRequest* c);
   size_t random_eviction();
   size_t lru_eviction();
+  size_t weighted_eviction();
+  bool admit(const std::string& oid);
 
   void init(CephContext *_cct);
 
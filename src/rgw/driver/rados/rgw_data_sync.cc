@@ -4044,6 +4044,41 @@ public:
   }
 };
 
+// result of a bilog listing that runs alongside incremental sync
+struct bilog_prefetch {
+  bilog_list_result result;
+  int ret = 0;
+  bool done = false;
+};
+
+// lists the bilog page that follows the one being synced. the listing is
+// spawned rather than called, so its outcome is reported through the shared
+// state instead of the coroutine's return code
+class RGWPrefetchBucketIndexLogCR : public RGWCoroutine {
+  RGWDataSyncCtx *sc;
+  const rgw_bucket_shard& bs;
+  string marker;
+  uint64_t generation;
+  std::shared_ptr<bilog_prefetch> prefetch;
+
+public:
+  RGWPrefetchBucketIndexLogCR(RGWDataSyncCtx *_sc, const rgw_bucket_shard& bs,
+                              string _marker, uint64_t generation,
+                              std::shared_ptr<bilog_prefetch> prefetch)
+    : RGWCoroutine(_sc->cct), sc(_sc), bs(bs), marker(std::move(_marker)),
+      generation(generation), prefetch(std::move(prefetch)) {}
+
+  int operate(const DoutPrefixProvider *dpp) override {
+    reenter(this) {
+      yield call(new RGWListBucketIndexLogCR(sc, bs, marker, generation, &prefetch->result));
+      prefetch->ret = retcode;
+      prefetch->done = true;
+      return set_cr_done();
+    }
+    return 0;
+  }
+};
+
 #define BUCKET_SYNC_UPDATE_MARKER_WINDOW 10
 
 class RGWBucketFullSyncMarkerTrack : public RGWSyncShardMarkerTrack<rgw_obj_key, rgw_obj_key> {
@@ -4725,6 +4760,8 @@ class RGWBucketShardIncrementalSyncCR : public RGWCoroutine {
   int sync_status{0};
   bool syncstopped{false};
 
+  std::shared_ptr<bilog_prefetch> prefetch;
+
   RGWSyncTraceNodeRef tn;
   RGWBucketIncSyncShardMarkerTrack marker_tracker;
 
@@ -4784,9 +4821,34 @@ int RGWBucketShardIncrementalSyncCR::operate(const DoutPrefixProvider *dpp)
         }
         return set_cr_error(-ECANCELED);
       }
-      tn->log(20, SSTR("listing bilog for incremental sync; position=" << sync_info.inc_marker.position));
-      set_status() << "listing bilog; position=" << sync_info.inc_marker.position;
-      yield call(new RGWListBucketIndexLogCR(sc, bs, sync_info.inc_marker.position, generation, &extended_result));
+      if (prefetch) {
+        // the next page was requested while the previous one synced
+        set_status() << "waiting for bilog prefetch; position=" << sync_info.inc_marker.position;
+        while (!prefetch->done) {
+          yield wait_for_child();
+          bool again = true;
+          while (again) {
+            again = collect(&ret, nullptr);
+            if (ret < 0) {
+              tn->log(10, "a sync operation returned error");
+              sync_status = ret;
+            }
+          }
+        }
+        retcode = prefetch->ret;
+        extended_result = std::move(prefetch->result);
+        prefetch.reset();
+        if (sync_env->counters) {
+          sync_env->counters->inc(sync_counters::l_bilog_prefetched);
+        }
+        if (sync_status != 0) {
+          break;
+        }
+      } else {
+        tn->log(20, SSTR("listing bilog for incremental sync; position=" << sync_info.inc_marker.position));
+        set_status() << "listing bilog; position=" << sync_info.inc_marker.position;
+        yield call(new RGWListBucketIndexLogCR(sc, bs, sync_info.inc_marker.position, generation, &extended_result));
+      }
       if (retcode < 0 && retcode != -ENOENT) {
         /* wait for all operations to complete */
         drain_all();
@@ -4799,6 +4861,9 @@ int RGWBucketShardIncrementalSyncCR::operate(const DoutPrefixProvider *dpp)
         next_gen = extended_result.next_log->generation;
         next_num_shards = extended_result.next_log->num_shards;
       }
+      if (sync_env->counters) {
+        sync_env->counters->inc(sync_counters::l_bilog_entries, list_result.size());
+      }
 
       squash_map.clear();
       entries_iter = list_result.begin();
@@ -4834,6 +4899,17 @@ int RGWBucketShardIncrementalSyncCR::operate(const DoutPrefixProvider *dpp)
         }
       }
 
+      if (truncated && !syncstopped && !list_result.empty() &&
+          cct->_conf.get_val<bool>("rgw_bucket_sync_bilog_prefetch")) {
+        // overlap the next listing with the object fetches for this page
+        const auto& last_id = list_result.back().id;
+        auto p = last_id.find('#');
+        prefetch = std::make_shared<bilog_prefetch>();
+        spawn(new RGWPrefetchBucketIndexLogCR(sc, bs,
+                  p == string::npos ? last_id : last_id.substr(p + 1),
+                  generation, prefetch), false);
+      }
+
       entries_iter = list_result.begin();
       for (; entries_iter != entries_end; ++entries_iter) {
         if (lease_cr && !lease_cr->is_locked()) {
@@ -4912,6 +4988,9 @@ int RGWBucketShardIncrementalSyncCR::operate(const DoutPrefixProvider *dpp)
           set_status() << "squashed operation, skipping";
           tn->log(20, SSTR("skipping object: "
               << bucket_shard_str{bs} << "/" << key << ": squashed operation"));
+          if (sync_env->counters) {
+            sync_env->counters->inc(sync_counters::l_bilog_squashed);
+          }
           marker_tracker.try_update_high_marker(cur_id, 0, entry->timestamp);
           continue;
         }
@@ -4959,6 +5038,11 @@ int RGWBucketShardIncrementalSyncCR::operate(const DoutPrefixProvider *dpp)
               versioned_epoch = entry->ver.epoch;
             }
             tn->log(20, SSTR("entry->timestamp=" << entry->timestamp));
+            if (sync_env->counters) {
+              // clamp to zero in case the zones' clocks disagree
+              auto lag = std::max(real_clock::now() - entry->timestamp, ceph::timespan::zero());
+              sync_env->counters->tset(sync_counters::l_bilog_lag, utime_t(lag));
+            }
             using SyncCR = RGWBucketSyncSingleEntryCR<string, rgw_obj_key>;
             spawn(new SyncCR(sc, sync_pipe, key,
                              entry->is_versioned(), versioned_epoch,
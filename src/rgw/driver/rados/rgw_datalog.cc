@@ -412,7 +412,8 @@ RGWDataChangesLog::RGWDataChangesLog(CephContext* cct)
   : cct(cct),
     num_shards(cct->_conf->rgw_data_log_num_shards),
     prefix(get_prefix()),
-    changes(cct->_conf->rgw_data_log_changes_size) {}
+    changes(cct->_conf->rgw_data_log_changes_size),
+    append_queues(std::make_unique<AppendQueue[]>(num_shards)) {}
 
 bs::error_code DataLogBackends::handle_init(entries_t e) noexcept {
   std::unique_lock l(m);
@@ -635,6 +636,55 @@ std::string RGWDataChangesLog::get_oid(uint64_t gen_id, int i) const {
 	  fmt::format("{}.{}", prefix, i));
 }
 
+int RGWDataChangesLog::push_batched(const DoutPrefixProvider *dpp, int index,
+				    const BucketGen& bg, ceph::real_time now,
+				    const std::string& key,
+				    ceph::buffer::list&& bl, optional_yield y)
+{
+  if (!cct->_conf.get_val<bool>("rgw_data_log_batch_appends")) {
+    auto be = bes->head();
+    return be->push(dpp, index, now, key, std::move(bl), y);
+  }
+
+  auto& q = append_queues[index];
+  std::unique_lock l(q.lock);
+  if (!q.filling) {
+    q.filling = std::make_shared<AppendBatch>();
+  }
+  auto batch = q.filling;
+  batch->appends.insert_or_assign(bg, PendingAppend{now, key, std::move(bl)});
+
+  q.cond.wait(l, [&] { return batch->done || !q.pushing; });
+  if (batch->done) {
+    // another caller pushed our entry along with its own
+    return batch->ret;
+  }
+
+  q.pushing = true;
+  q.filling.reset();
+  l.unlock();
+
+  ldpp_dout(dpp, 20) << "RGWDataChangesLog::push_batched() pushing "
+		     << batch->appends.size() << " entries to shard "
+		     << index << dendl;
+
+  auto be = bes->head();
+  RGWDataChangesBE::entries entries;
+  for (auto& [_, a] : batch->appends) {
+    be->prepare(a.timestamp, a.key, std::move(a.bl), entries);
+  }
+  int ret = be->push(dpp, index, std::move(entries), y);
+
+  l.lock();
+  batch->ret = ret;
+  batch->done = true;
+  q.pushing = false;
+  l.unlock();
+  q.cond.notify_all();
+
+  return ret;
+}
+
 int RGWDataChangesLog::add_entry(const DoutPrefixProvider *dpp,
 				 const RGWBucketInfo& bucket_info,
 				 const rgw::bucket_log_layout_generation& gen,
@@ -719,8 +769,8 @@ int RGWDataChangesLog::add_entry(const DoutPrefixProvider *dpp,
 
     ldpp_dout(dpp, 20) << "RGWDataChangesLog::add_entry() sending update with now=" << now << " cur_expiration=" << expiration << dendl;
 
-    auto be = bes->head();
-    ret = be->push(dpp, index, now, change.key, std::move(bl), y);
+    ret = push_batched(dpp, index, {bs, gen.gen}, now, change.key,
+		       std::move(bl), y);
 
     now = real_clock::now();
 
@@ -271,6 +271,33 @@ class RGWDataChangesLog {
 
   bc::flat_set<BucketGen> cur_cycle;
 
+  // appends to a shard that arrive while a push to it is in flight are
+  // collected into one batch, and pushed together by the first caller to
+  // find the shard idle. repeated changes to a bucket shard collapse into
+  // a single entry
+  struct PendingAppend {
+    ceph::real_time timestamp;
+    std::string key;
+    ceph::buffer::list bl;
+  };
+  struct AppendBatch {
+    bc::flat_map<BucketGen, PendingAppend> appends;
+    bool done = false;
+    int ret = 0;
+  };
+  struct AppendQueue {
+    ceph::mutex lock = ceph::make_mutex("RGWDataChangesLog::AppendQueue");
+    ceph::condition_variable cond;
+    bool pushing = false;
+    std::shared_ptr<AppendBatch> filling;
+  };
+  std::unique_ptr<AppendQueue[]> append_queues;
+
+  int push_batched(const DoutPrefixProvider *dpp, int index,
+		   const BucketGen& bg, ceph::real_time now,
+		   const std::string& key, ceph::buffer::list&& bl,
+		   optional_yield y);
+
   ChangeStatusPtr _get_change(const rgw_bucket_shard& bs, uint64_t gen);
   void register_renew(const rgw_bucket_shard& bs,
 		      const rgw::bucket_log_layout_generation& gen);
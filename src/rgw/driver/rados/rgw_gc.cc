@@ -350,6 +350,7 @@ class RGWGCIOManager {
     string oid;
     int index{-1};
     string tag;
+    ceph::mono_time start{};
   };
 
   deque<IO> ios;
@@ -361,12 +362,39 @@ class RGWGCIOManager {
 
 #define MAX_AIO_DEFAULT 10
   size_t max_aio{MAX_AIO_DEFAULT};
+  size_t max_aio_limit{MAX_AIO_DEFAULT};
+  ceph::timespan target_latency{};
+
+  /* tail objects are mostly in a handful of pools, so keep their ioctxs
+   * for the whole pass instead of opening one per pool change */
+  map<string, IoCtx> pool_ctxs;
+
+  /* additive increase, multiplicative decrease of max_aio around
+   * rgw_gc_target_io_latency */
+  void adapt_max_aio(ceph::timespan latency) {
+    if (target_latency == ceph::timespan::zero()) {
+      return;
+    }
+    if (latency > target_latency) {
+      max_aio = std::max<size_t>(1, max_aio - max_aio / 4);
+    } else if (max_aio < max_aio_limit) {
+      ++max_aio;
+    }
+    if (perfcounter) {
+      perfcounter->set(l_rgw_gc_max_aio, max_aio);
+    }
+  }
 
 public:
   RGWGCIOManager(const DoutPrefixProvider* _dpp, CephContext *_cct, RGWGC *_gc) : dpp(_dpp),
                                                                                   cct(_cct),
                                                                                   gc(_gc) {
-    max_aio = cct->_conf->rgw_gc_max_concurrent_io;
+    max_aio = max_aio_limit = cct->_conf->rgw_gc_max_concurrent_io;
+    target_latency = cct->_conf.get_val<std::chrono::milliseconds>(
+      "rgw_gc_target_io_latency");
+    if (perfcounter) {
+      perfcounter->set(l_rgw_gc_max_aio, max_aio);
+    }
     remove_tags.resize(min(static_cast<int>(cct->_conf->rgw_gc_max_objs), rgw_shards_max()));
     tag_io_size.resize(min(static_cast<int>(cct->_conf->rgw_gc_max_objs), rgw_shards_max()));
   }
@@ -395,8 +423,21 @@ public:
     if (ret < 0) {
       return ret;
     }
-    ios.push_back(IO{IO::TailIO, c, oid, index, tag});
+    ios.push_back(IO{IO::TailIO, c, oid, index, tag, ceph::mono_clock::now()});
+
+    return 0;
+  }
 
+  int get_pool_ctx(librados::Rados *rados, const string& pool, IoCtx **ctx) {
+    auto [i, inserted] = pool_ctxs.try_emplace(pool);
+    if (inserted) {
+      int ret = rgw_init_ioctx(dpp, rados, pool, i->second);
+      if (ret < 0) {
+	pool_ctxs.erase(i);
+	return ret;
+      }
+    }
+    *ctx = &i->second;
     return 0;
   }
 
@@ -425,6 +466,13 @@ public:
       goto done;
     }
 
+    if (io.type == IO::TailIO) {
+      adapt_max_aio(ceph::mono_clock::now() - io.start);
+      if (perfcounter) {
+	perfcounter->inc(l_rgw_gc_tail_remove);
+      }
+    }
+
     if (! gc->transitioned_objects_cache[io.index]) {
       schedule_tag_removal(io.index, io.tag);
     }
@@ -577,7 +625,7 @@ int RGWGC::process(int index, int max_secs, bool expired_only,
   string marker;
   string next_marker;
   bool truncated;
-  IoCtx *ctx = new IoCtx;
+  IoCtx *ctx = nullptr;
   do {
     int max = 100;
     std::list<cls_rgw_gc_obj_info> entries;
@@ -627,7 +675,6 @@ int RGWGC::process(int index, int max_secs, bool expired_only,
 
     marker = next_marker;
 
-    string last_pool;
     std::list<cls_rgw_gc_obj_info>::iterator iter;
     for (iter = entries.begin(); iter != entries.end(); ++iter) {
       cls_rgw_gc_obj_info& info = *iter;
@@ -643,6 +690,12 @@ int RGWGC::process(int index, int max_secs, bool expired_only,
       if (now >= end) {
         goto done;
       }
+      if (perfcounter) {
+        const auto expired = ceph::real_clock::now() - info.time;
+        if (expired > ceph::timespan::zero()) {
+          perfcounter->tinc(l_rgw_gc_entry_age, expired);
+        }
+      }
       if (! transitioned_objects_cache[index]) {
         if (chain.objs.empty()) {
           io_manager.schedule_tag_removal(index, info.tag);
@@ -654,20 +707,15 @@ int RGWGC::process(int index, int max_secs, bool expired_only,
 	for (liter = chain.objs.begin(); liter != chain.objs.end(); ++liter) {
 	  cls_rgw_obj& obj = *liter;
 
-	  if (obj.pool != last_pool) {
-	    delete ctx;
-	    ctx = new IoCtx;
-	    ret = rgw_init_ioctx(this, store->get_rados_handle(), obj.pool, *ctx);
-	    if (ret < 0) {
+	  ret = io_manager.get_pool_ctx(store->get_rados_handle(), obj.pool,
+					&ctx);
+	  if (ret < 0) {
         if (transitioned_objects_cache[index]) {
           goto done;
         }
-	      last_pool = "";
-	      ldpp_dout(this, 0) << "ERROR: failed to create ioctx pool=" <<
-		obj.pool << dendl;
-	      continue;
-	    }
-	    last_pool = obj.pool;
+	    ldpp_dout(this, 0) << "ERROR: failed to create ioctx pool=" <<
+	      obj.pool << dendl;
+	    continue;
 	  }
 
 	  ctx->locator_set_key(obj.loc);
@@ -717,7 +765,6 @@ done:
    * hold the system if backend is unresponsive
    */
   l.unlock(&store->gc_pool_ctx, obj_names[index]);
-  delete ctx;
 
   return 0;
 }
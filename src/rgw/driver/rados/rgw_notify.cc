@@ -5,6 +5,7 @@
 #include "cls/2pc_queue/cls_2pc_queue_client.h"
 #include "cls/lock/cls_lock_client.h"
 #include <memory>
+#include <unordered_map>
 #include <boost/algorithm/hex.hpp>
 #include <boost/context/protected_fixedsize_stack.hpp>
 #include <spawn/spawn.hpp>
@@ -159,9 +160,14 @@ class Manager : public DoutPrefixProvider {
     }   
   };
 
+  // endpoints created while processing one batch of a queue. entries of
+  // the same topic share an endpoint, and with it the broker connection
+  // lookup and argument parsing
+  using endpoint_cache_t = std::unordered_map<std::string, std::shared_ptr<RGWPubSubEndpoint>>;
+
   // processing of a specific entry
   // return whether processing was successfull (true) or not (false)
-  bool process_entry(const cls_queue_entry& entry, yield_context yield) {
+  bool process_entry(const cls_queue_entry& entry, endpoint_cache_t& endpoints, yield_context yield) {
     event_entry_t event_entry;
     auto iter = entry.data.cbegin();
     try {
@@ -171,12 +177,16 @@ class Manager : public DoutPrefixProvider {
       return false;
     }
     try {
-      // TODO move endpoint creation to queue level
-      const auto push_endpoint = RGWPubSubEndpoint::create(event_entry.push_endpoint, event_entry.arn_topic,
-          RGWHTTPArgs(event_entry.push_endpoint_args, this), 
-          cct);
-      ldpp_dout(this, 20) << "INFO: push endpoint created: " << event_entry.push_endpoint <<
-        " for entry: " << entry.marker << dendl;
+      const auto endpoint_key = event_entry.push_endpoint + '\0' +
+        event_entry.push_endpoint_args + '\0' + event_entry.arn_topic;
+      auto& push_endpoint = endpoints[endpoint_key];
+      if (!push_endpoint) {
+        push_endpoint = RGWPubSubEndpoint::create(event_entry.push_endpoint, event_entry.arn_topic,
+            RGWHTTPArgs(event_entry.push_endpoint_args, this), 
+            cct);
+        ldpp_dout(this, 20) << "INFO: push endpoint created: " << event_entry.push_endpoint <<
+          " for entry: " << entry.marker << dendl;
+      }
       const auto ret = push_endpoint->send_to_completion_async(cct, event_entry.event, optional_yield(io_context, yield));
       if (ret < 0) {
         ldpp_dout(this, 5) << "WARNING: push entry: " << entry.marker << " to endpoint: " << event_entry.push_endpoint 
@@ -305,15 +315,16 @@ class Manager : public DoutPrefixProvider {
       auto remove_entries = false;
       auto entry_idx = 1U;
       tokens_waiter waiter(io_context);
+      endpoint_cache_t endpoints;
       for (auto& entry : entries) {
         if (has_error) {
           // bail out on first error
           break;
         }
         // TODO pass entry pointer instead of by-value
-        spawn::spawn(yield, [this, &queue_name, entry_idx, total_entries, &end_marker, &remove_entries, &has_error, &waiter, entry](yield_context yield) {
+        spawn::spawn(yield, [this, &queue_name, entry_idx, total_entries, &end_marker, &remove_entries, &has_error, &waiter, &endpoints, entry](yield_context yield) {
             const auto token = waiter.make_token();
-            if (process_entry(entry, yield)) {
+            if (process_entry(entry, endpoints, yield)) {
               ldpp_dout(this, 20) << "INFO: processing of entry: " << 
                 entry.marker << " (" << entry_idx << "/" << total_entries << ") from: " << queue_name << " ok" << dendl;
               remove_entries = true;
@@ -5,6 +5,7 @@
 #include <string>
 #include <sstream>
 #include <algorithm>
+#include <limits>
 #include "include/buffer_fwd.h"
 #include "common/Formatter.h"
 #include "common/iso_8601.h"
@@ -302,6 +303,23 @@ private:
     throw configuration_error("Kafka: invalid kafka-ack-level: " + str_ack_level);
   }
 
+  static boost::optional<unsigned> get_unsigned(const RGWHTTPArgs& args, const std::string& name) {
+    bool exists;
+    const auto& str_value = args.get(name, &exists);
+    if (!exists) {
+      return boost::none;
+    }
+    try {
+      std::size_t pos = 0;
+      const auto value = std::stoul(str_value, &pos);
+      if (pos == str_value.size() && value <= std::numeric_limits<unsigned>::max()) {
+        return static_cast<unsigned>(value);
+      }
+    } catch (const std::logic_error&) {
+    }
+    throw configuration_error("Kafka: invalid " + name + ": " + str_value);
+  }
+
 public:
   RGWPubSubKafkaEndpoint(const std::string& _endpoint,
       const std::string& _topic,
@@ -309,7 +327,8 @@ public:
       CephContext* _cct) : 
         cct(_cct),
         topic(_topic),
-        conn(kafka::connect(_endpoint, get_bool(args, "use-ssl", false), get_bool(args, "verify-ssl", true), args.get_optional("ca-location"))) ,
+        conn(kafka::connect(_endpoint, get_bool(args, "use-ssl", false), get_bool(args, "verify-ssl", true), args.get_optional("ca-location"),
+              get_unsigned(args, "kafka-linger-ms"), get_unsigned(args, "kafka-batch-size"))) ,
         ack_level(get_ack_level(args)) {
     if (!conn) { 
       throw configuration_error("Kafka: failed to create connection to: " + _endpoint);
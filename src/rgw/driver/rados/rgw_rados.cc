@@ -1597,14 +1597,51 @@ int RGWRados::log_usage(const DoutPrefixProvider *dpp, map<rgw_user_bucket, RGWU
     }
   }
 
-  map<string, rgw_usage_log_info>::iterator liter;
+  /* issue the write for every usage shard before waiting on any of
+     them, so a flush costs one round trip rather than one per shard */
+  struct pending_add {
+    rgw_rados_ref ref;
+    librados::AioCompletion *c = nullptr;
+  };
+  std::vector<pending_add> pending;
+  pending.reserve(log_objs.size());
 
-  for (liter = log_objs.begin(); liter != log_objs.end(); ++liter) {
-    int r = cls_obj_usage_log_add(dpp, liter->first, liter->second);
-    if (r < 0)
-      return r;
+  int ret = 0;
+  for (auto& [oid, info] : log_objs) {
+    rgw_raw_obj obj(svc.zone->get_zone_params().usage_log_pool, oid);
+    pending_add& p = pending.emplace_back();
+    int r = get_raw_obj_ref(dpp, obj, &p.ref);
+    if (r < 0) {
+      pending.pop_back();
+      ret = r;
+      break;
+    }
+
+    ObjectWriteOperation op;
+    cls_rgw_usage_log_add(op, info);
+    p.c = librados::Rados::aio_create_completion(nullptr, nullptr);
+    r = p.ref.pool.ioctx().aio_operate(p.ref.obj.oid, p.c, &op);
+    if (r < 0) {
+      p.c->release();
+      pending.pop_back();
+      ret = r;
+      break;
+    }
   }
-  return 0;
+
+  for (auto& p : pending) {
+    p.c->wait_for_complete();
+    int r = p.c->get_return_value();
+    p.c->release();
+    if (r < 0) {
+      ldpp_dout(dpp, 0) << "ERROR: RGWRados::log_usage(): failed to write usage to "
+                        << p.ref.obj.oid << ", r=" << r << dendl;
+      if (ret == 0) {
+        ret = r;
+      }
+    }
+  }
+  return ret;
 }
 
 int RGWRados::read_usage(const DoutPrefixProvider *dpp, const rgw_user& user, const string& bucket_name, uint64_t start_epoch, uint64_t end_epoch,
@@ -6595,7 +6632,9 @@ int RGWRados::Object::Read::iterate(const DoutPrefixProvider *dpp, int64_t ofs,
   const uint64_t chunk_size = cct->_conf->rgw_get_obj_max_req_size;
   const uint64_t window_size = cct->_conf->rgw_get_obj_window_size;
 
-  auto aio = rgw::make_throttle(window_size, y);
+  auto aio = rgw::make_throttle(window_size,
+                                cct->_conf->rgw_get_obj_max_window_size,
+                                cct->_conf->rgw_aio_window_budget, y);
   get_obj_data data(store, cb, &*aio, ofs, y);
 
   int r = store->iterate_obj(dpp, source->get_ctx(), source->get_bucket_info(),
@@ -8697,6 +8736,7 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     const std::string& oid_name;
     RGWRados::ent_map_t::iterator cursor;
     RGWRados::ent_map_t::iterator end;
+    uint32_t refill_entries;
 
     // manages an iterator through a shard and provides other
     // accessors
@@ -8707,9 +8747,17 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
       result(_result),
       oid_name(_oid_name),
       cursor(_result.dir.m.begin()),
-      end(_result.dir.m.end())
+      end(_result.dir.m.end()),
+      refill_entries(0)
     {}
 
+    // replace the consumed results with the next batch from this shard
+    inline void reset(rgw_cls_list_ret&& next) {
+      result = std::move(next);
+      cursor = result.dir.m.begin();
+      end = result.dir.m.end();
+    }
+
     inline const std::string& entry_name() const {
       return cursor->first;
     }
@@ -8771,6 +8819,33 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     ++tracker_idx;
   }
 
+  // read the next batch from a single shard whose truncated results
+  // have been used up, starting at the marker cls gave us; the results
+  // it replaces are kept, as entries there may still be referenced
+  uint32_t refills_left = cct->_conf->rgw_bucket_list_max_shard_refills;
+  std::list<rgw_cls_list_ret> retired_results;
+  auto refill = [&](ShardTracker& t, uint32_t remaining) -> int {
+    // double the batch each time the same shard runs dry
+    t.refill_entries = std::min(remaining,
+				t.refill_entries ? t.refill_entries * 2 :
+				num_entries_per_shard);
+    std::map<int, std::string> oid{{int(t.shard_idx), t.oid_name}};
+    std::map<int, rgw_cls_list_ret> next;
+    int ret = CLSRGWIssueBucketList(ioctx, t.result.marker, prefix, delimiter,
+				    t.refill_entries, list_versions, oid,
+				    next, 1)();
+    if (ret < 0) {
+      return ret;
+    }
+    ldpp_dout(dpp, 20) << __func__ << ": refilled shard " << t.shard_idx <<
+      " after \"" << t.result.marker << "\" with " <<
+      next[t.shard_idx].dir.m.size() << " entries" << dendl;
+    *cls_filtered = *cls_filtered && next[t.shard_idx].cls_filtered;
+    retired_results.push_back(std::move(t.result));
+    t.reset(std::move(next[t.shard_idx]));
+    return 0;
+  };
+
   rgw_bucket_dir_entry*
     last_entry_visited = nullptr; // to set last_entry (marker)
   std::map<std::string, bufferlist> updates;
@@ -8848,6 +8923,21 @@ int RGWRados::cls_bucket_list_ordered(const DoutPrefixProvider *dpp,
     for (auto idx : vidx) {
       auto& tracker_match = results_trackers.at(idx);
       tracker_match.advance();
+      // pull more from this shard alone rather than giving up on the
+      // merge; a shard may come back empty but truncated when cls
+      // filtered everything it read, so keep going while we may
+      while (tracker_match.at_end() && tracker_match.is_truncated() &&
+	     !tracker_match.result.marker.empty() &&
+	     count < num_entries && refills_left > 0) {
+	--refills_left;
+	r = refill(tracker_match, num_entries - count);
+	if (r < 0) {
+	  ldpp_dout(dpp, 0) << __func__ <<
+	    ": CLSRGWIssueBucketList for shard " << tracker_match.shard_idx <<
+	    " of " << bucket_info.bucket << " failed" << dendl;
+	  return r;
+	}
+      }
       next_candidate(cct, tracker_match, candidates, idx);
       if (tracker_match.at_end() && tracker_match.is_truncated()) {
         need_to_stop = true;
@@ -1,6 +1,7 @@
 // -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
 // vim: ts=8 sw=2 smarttab ft=cpp
 
+#include <future>
 #include <limits>
 #include <sstream>
 
@@ -823,19 +824,56 @@ int RGWBucketReshard::do_reshard(const rgw::bucket_index_layout_generation& curr
     (*out) << "total entries:";
   }
 
+  // Source shards are read a window at a time. Each shard in the window
+  // always has its next chunk in flight while the previous one is copied,
+  // so the copy is bound by the slowest shard rather than by the sum of
+  // every bi_list round trip.
+  struct source_chunk {
+    int ret = 0;
+    list<rgw_cls_bi_entry> entries;
+    bool is_truncated = false;
+  };
+  auto list_chunk = [this, dpp, max_entries] (int shard, string marker) {
+    return std::async(std::launch::async,
+      [this, dpp, max_entries, shard, marker = std::move(marker)] {
+        const std::string null_object_filter; // empty string since we're not filtering by object
+        source_chunk chunk;
+        chunk.ret = store->getRados()->bi_list(dpp, bucket_info, shard,
+					       null_object_filter, marker,
+					       max_entries, &chunk.entries,
+					       &chunk.is_truncated);
+        return chunk;
+      });
+  };
+
   const int num_source_shards = current.layout.normal.num_shards;
+  const int window = std::max<int>(1,
+    store->ctx()->_conf.get_val<uint64_t>("rgw_reshard_list_concurrency"));
   string marker;
-  for (int i = 0; i < num_source_shards; ++i) {
-    bool is_truncated = true;
-    marker.clear();
-    const std::string null_object_filter; // empty string since we're not filtering by object
-    while (is_truncated) {
-      entries.clear();
-      int ret = store->getRados()->bi_list(dpp, bucket_info, i, null_object_filter, marker, max_entries, &entries, &is_truncated);
-      if (ret < 0 && ret != -ENOENT) {
-        derr << "ERROR: bi_list(): " << cpp_strerror(-ret) << dendl;
-        return ret;
+  for (int first = 0; first < num_source_shards; first += window) {
+    std::map<int, std::future<source_chunk>> in_flight;
+    for (int i = first; i < std::min(first + window, num_source_shards); ++i) {
+      in_flight.emplace(i, list_chunk(i, string()));
+    }
+    // visit the window round robin until every shard in it is drained
+    auto shard = in_flight.begin();
+    while (!in_flight.empty()) {
+      if (shard == in_flight.end()) {
+        shard = in_flight.begin();
+      }
+      const int i = shard->first;
+      source_chunk chunk = shard->second.get();
+      if (chunk.ret < 0 && chunk.ret != -ENOENT) {
+        derr << "ERROR: bi_list(): " << cpp_strerror(-chunk.ret) << dendl;
+        return chunk.ret;
+      }
+      if (chunk.is_truncated && !chunk.entries.empty()) {
+        shard->second = list_chunk(i, chunk.entries.back().idx);
+        ++shard;
+      } else {
+        shard = in_flight.erase(shard);
       }
+      entries = std::move(chunk.entries);
 
       for (auto iter = entries.begin(); iter != entries.end(); ++iter) {
 	rgw_cls_bi_entry& entry = *iter;
@@ -1585,7 +1585,9 @@ std::unique_ptr<Writer> RadosStore::get_append_writer(const DoutPrefixProvider *
 				  uint64_t position,
 				  uint64_t *cur_accounted_size)
 {
-  auto aio = rgw::make_throttle(ctx()->_conf->rgw_put_obj_min_window_size, y);
+  auto aio = rgw::make_throttle(ctx()->_conf->rgw_put_obj_min_window_size,
+                                ctx()->_conf->rgw_put_obj_max_window_size,
+                                ctx()->_conf->rgw_aio_window_budget, y);
   return std::make_unique<RadosAppendWriter>(dpp, y,
 				 std::move(_head_obj),
 				 this, std::move(aio), owner,
@@ -1602,7 +1604,9 @@ std::unique_ptr<Writer> RadosStore::get_atomic_writer(const DoutPrefixProvider *
 				  uint64_t olh_epoch,
 				  const std::string& unique_tag)
 {
-  auto aio = rgw::make_throttle(ctx()->_conf->rgw_put_obj_min_window_size, y);
+  auto aio = rgw::make_throttle(ctx()->_conf->rgw_put_obj_min_window_size,
+                                ctx()->_conf->rgw_put_obj_max_window_size,
+                                ctx()->_conf->rgw_aio_window_budget, y);
   return std::make_unique<RadosAtomicWriter>(dpp, y,
 				 std::move(_head_obj),
 				 this, std::move(aio), owner,
@@ -2286,9 +2290,9 @@ int RadosObject::swift_versioning_copy(const DoutPrefixProvider* dpp, optional_y
 int RadosMultipartUpload::cleanup_part_history(const DoutPrefixProvider* dpp,
                                                optional_yield y,
                                                RadosMultipartPart *part,
-                                               list<rgw_obj_index_key>& remove_objs)
+                                               list<rgw_obj_index_key>& remove_objs,
+                                               cls_rgw_obj_chain& chain)
 {
-  cls_rgw_obj_chain chain;
   for (auto& ppfx : part->get_past_prefixes()) {
     rgw_obj past_obj;
     past_obj.init_ns(bucket->get_key(), ppfx + "." + std::to_string(part->info.num), mp_ns);
@@ -2306,6 +2310,12 @@ int RadosMultipartUpload::cleanup_part_history(const DoutPrefixProvider* dpp,
       chain.push_obj(raw_part_obj.pool.to_str(), part_key, raw_part_obj.loc);
     }
   }
+  return 0;
+}
+
+int RadosMultipartUpload::remove_chain(const DoutPrefixProvider* dpp,
+                                       cls_rgw_obj_chain& chain)
+{
   if (store->getRados()->get_gc() == nullptr) {
     // Delete objects inline if gc hasn't been initialised (in case when bypass gc is specified)
     store->getRados()->delete_objs_inline(dpp, chain, mp_obj.get_upload_id());
@@ -2369,27 +2379,16 @@ int RadosMultipartUpload::abort(const DoutPrefixProvider *dpp, CephContext *cct)
           head->get_key().get_index_key(&key);
           remove_objs.push_back(key);
 
-          cleanup_part_history(dpp, null_yield, obj_part, remove_objs);
+          cleanup_part_history(dpp, null_yield, obj_part, remove_objs, chain);
         }
       }
       parts_accounted_size += obj_part->info.accounted_size;
     }
   } while (truncated);
 
-  if (store->getRados()->get_gc() == nullptr) {
-    //Delete objects inline if gc hasn't been initialised (in case when bypass gc is specified)
-    store->getRados()->delete_objs_inline(dpp, chain, mp_obj.get_upload_id());
-  } else {
-    /* use upload id as tag and do it synchronously */
-    auto [ret, leftover_chain] = store->getRados()->send_chain_to_gc(chain, mp_obj.get_upload_id());
-    if (ret < 0 && leftover_chain) {
-      ldpp_dout(dpp, 5) << __func__ << ": gc->send_chain() returned " << ret << dendl;
-      if (ret == -ENOENT) {
-        return -ERR_NO_SUCH_UPLOAD;
-      }
-      //Delete objects inline if send chain to gc fails
-      store->getRados()->delete_objs_inline(dpp, *leftover_chain, mp_obj.get_upload_id());
-    }
+  ret = remove_chain(dpp, chain);
+  if (ret < 0) {
+    return ret;
   }
 
   std::unique_ptr<rgw::sal::Object::DeleteOp> del_op = meta_obj->get_delete_op();
@@ -2562,6 +2561,104 @@ int RadosMultipartUpload::list_parts(const DoutPrefixProvider *dpp, CephContext
   return 0;
 }
 
+int RadosMultipartUpload::list_all_parts(const DoutPrefixProvider *dpp,
+					 int num_parts, int max_parts)
+{
+  std::unique_ptr<rgw::sal::Object> obj = bucket->get_object(
+		      rgw_obj_key(get_meta(), std::string(), RGW_OBJ_NS_MULTIPART));
+  obj->set_in_extra_data(true);
+
+  rgw_raw_obj raw_obj;
+  dynamic_cast<RadosObject*>(obj.get())->get_raw_obj(&raw_obj);
+
+  rgw_rados_ref ref;
+  int ret = store->getRados()->get_raw_obj_ref(dpp, raw_obj, &ref);
+  if (ret < 0) {
+    return ret;
+  }
+
+  auto part_key = [](int num) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "part.%08d", num);
+    return std::string(buf);
+  };
+
+  /* the omap keys of a v2 upload sort by part number, so the start of
+   * every page is known up front and the pages can be read at once. the
+   * last page asks for one entry past num_parts to catch extra parts */
+  struct page_read {
+    std::map<std::string, bufferlist> vals;
+    bool more = false;
+    int rval = 0;
+    librados::AioCompletion *c = nullptr;
+  };
+  const int num_pages = (num_parts + max_parts - 1) / max_parts;
+  std::vector<page_read> pages(num_pages);
+
+  int issued = 0;
+  for (; issued < num_pages; ++issued) {
+    page_read& page = pages[issued];
+    const int first = issued * max_parts;
+    const int count = (issued == num_pages - 1) ?
+      num_parts - first + 1 : max_parts;
+
+    librados::ObjectReadOperation op;
+    op.omap_get_vals2(part_key(first), count, &page.vals, &page.more,
+		      &page.rval);
+    page.c = librados::Rados::aio_create_completion(nullptr, nullptr);
+    ret = ref.pool.ioctx().aio_operate(ref.obj.oid, page.c, &op, nullptr);
+    if (ret < 0) {
+      page.c->release();
+      break;
+    }
+  }
+
+  for (int i = 0; i < issued; ++i) {
+    page_read& page = pages[i];
+    page.c->wait_for_complete();
+    int r = page.c->get_return_value();
+    page.c->release();
+    if (r == 0) {
+      r = page.rval;
+    }
+    if (r < 0 && ret == 0) {
+      ret = r;
+    }
+  }
+  if (ret < 0) {
+    return ret;
+  }
+
+  parts.clear();
+
+  uint32_t expected_next = 1;
+  for (auto& page : pages) {
+    for (auto& [key, bl] : page.vals) {
+      auto bli = bl.cbegin();
+      std::unique_ptr<RadosMultipartPart> part = std::make_unique<RadosMultipartPart>();
+      try {
+	decode(part->info, bli);
+      } catch (buffer::error& err) {
+	ldpp_dout(dpp, 0) << "ERROR: could not part info, caught buffer::error" <<
+	  dendl;
+	return -EIO;
+      }
+      if (part->info.num != expected_next) {
+	/* a gap, a part from a gateway that doesn't sort its omap keys,
+	 * or a part past num_parts; leave it to list_parts() */
+	return -EAGAIN;
+      }
+      expected_next++;
+      parts[part->info.num] = std::move(part);
+    }
+  }
+
+  if ((int)parts.size() != num_parts || pages.back().more) {
+    return -EAGAIN;
+  }
+  return 0;
+}
+
 int RadosMultipartUpload::complete(const DoutPrefixProvider *dpp,
 				   optional_yield y, CephContext* cct,
 				   map<int, string>& part_etags,
@@ -2589,14 +2686,31 @@ int RadosMultipartUpload::complete(const DoutPrefixProvider *dpp,
   uint64_t min_part_size = cct->_conf->rgw_multipart_min_part_size;
   auto etags_iter = part_etags.begin();
   rgw::sal::Attrs attrs = target_obj->get_attrs();
+  cls_rgw_obj_chain history_chain;
+
+  /* try to fetch every part in one round of concurrent reads, falling
+   * back to paging through them when that doesn't apply */
+  bool listed_all = false;
+  if (is_v2_upload_id(get_upload_id()) && !part_etags.empty()) {
+    ret = list_all_parts(dpp, part_etags.size(), max_parts);
+    if (ret == 0) {
+      listed_all = true;
+    } else if (ret != -EAGAIN) {
+      return (ret == -ENOENT) ? -ERR_NO_SUCH_UPLOAD : ret;
+    }
+  }
 
   do {
-    ret = list_parts(dpp, cct, max_parts, marker, &marker, &truncated);
-    if (ret == -ENOENT) {
-      ret = -ERR_NO_SUCH_UPLOAD;
+    if (listed_all) {
+      truncated = false;
+    } else {
+      ret = list_parts(dpp, cct, max_parts, marker, &marker, &truncated);
+      if (ret == -ENOENT) {
+        ret = -ERR_NO_SUCH_UPLOAD;
+      }
+      if (ret < 0)
+        return ret;
     }
-    if (ret < 0)
-      return ret;
 
     total_parts += parts.size();
     if (!truncated && total_parts != (int)part_etags.size()) {
@@ -2691,12 +2805,19 @@ int RadosMultipartUpload::complete(const DoutPrefixProvider *dpp,
 
       remove_objs.push_back(remove_key);
 
-      cleanup_part_history(dpp, y, part, remove_objs);
+      cleanup_part_history(dpp, y, part, remove_objs, history_chain);
 
       ofs += obj_part.size;
       accounted_size += obj_part.accounted_size;
     }
   } while (truncated);
+
+  /* release the objects of all re-uploaded parts in one go */
+  ret = remove_chain(dpp, history_chain);
+  if (ret < 0) {
+    return ret;
+  }
+
   hash.Final((unsigned char *)final_etag);
 
   buf_to_hex((unsigned char *)final_etag, sizeof(final_etag), final_etag_str);
@@ -2827,7 +2948,9 @@ std::unique_ptr<Writer> RadosMultipartUpload::get_writer(
 				  uint64_t part_num,
 				  const std::string& part_num_str)
 {
-  auto aio = rgw::make_throttle(store->ctx()->_conf->rgw_put_obj_min_window_size, y);
+  auto aio = rgw::make_throttle(store->ctx()->_conf->rgw_put_obj_min_window_size,
+                                store->ctx()->_conf->rgw_put_obj_max_window_size,
+                                store->ctx()->_conf->rgw_aio_window_budget, y);
   return std::make_unique<RadosMultipartWriter>(dpp, y, this,
 				 std::move(_head_obj), store, std::move(aio), owner,
 				 ptail_placement_rule, part_num, part_num_str);
@@ -684,7 +684,13 @@ protected:
   int cleanup_part_history(const DoutPrefixProvider* dpp,
                            optional_yield y,
                            RadosMultipartPart* part,
-                           std::list<rgw_obj_index_key>& remove_objs);
+                           std::list<rgw_obj_index_key>& remove_objs,
+                           cls_rgw_obj_chain& chain);
+  int remove_chain(const DoutPrefixProvider* dpp, cls_rgw_obj_chain& chain);
+  /* reads parts 1..num_parts of a v2 upload with concurrent paged reads;
+   * returns -EAGAIN if the upload doesn't hold exactly those parts */
+  int list_all_parts(const DoutPrefixProvider* dpp, int num_parts,
+                     int max_parts);
 };
 
 class MPRadosSerializer : public StoreMPSerializer {
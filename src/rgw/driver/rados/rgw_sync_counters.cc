@@ -16,10 +16,16 @@ PerfCountersRef build(CephContext *cct, const std::string& name)
   b.add_u64_avg(l_fetch, "fetch_bytes", "Number of object bytes replicated");
   b.add_u64_counter(l_fetch_not_modified, "fetch_not_modified", "Number of objects already replicated");
   b.add_u64_counter(l_fetch_err, "fetch_errors", "Number of object replication errors");
+  b.add_time_avg(l_fetch_latency, "fetch_latency", "Average latency of object replication");
 
   b.add_time_avg(l_poll, "poll_latency", "Average latency of replication log requests");
   b.add_u64_counter(l_poll_err, "poll_errors", "Number of replication log request errors");
 
+  b.add_u64_counter(l_bilog_entries, "bilog_entries", "Number of bucket index log entries read by incremental sync");
+  b.add_u64_counter(l_bilog_squashed, "bilog_squashed", "Number of bucket index log entries superseded by a later entry for the same object");
+  b.add_u64_counter(l_bilog_prefetched, "bilog_prefetched", "Number of bucket index log pages listed while the previous page was being synced");
+  b.add_time(l_bilog_lag, "bilog_lag", "Age of the bucket index log entry most recently started by incremental sync");
+
   auto logger = PerfCountersRef{ b.create_perf_counters(), cct };
   cct->get_perfcounters_collection()->add(logger.get());
   return logger;
@@ -13,10 +13,16 @@ enum {
   l_fetch,
   l_fetch_not_modified,
   l_fetch_err,
+  l_fetch_latency,
 
   l_poll,
   l_poll_err,
 
+  l_bilog_entries,
+  l_bilog_squashed,
+  l_bilog_prefetched,
+  l_bilog_lag,
+
   l_last,
 };
 
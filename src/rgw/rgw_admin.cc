@@ -39,6 +39,7 @@ extern "C" {
 #include "rgw_rados.h"
 #include "rgw_acl.h"
 #include "rgw_acl_s3.h"
+#include "rgw_compression.h"
 #include "rgw_datalog.h"
 #include "rgw_lc.h"
 #include "rgw_log.h"
@@ -162,6 +163,8 @@ void usage()
   cout << "  bucket sync disable        disable bucket sync\n";
   cout << "  bucket sync enable         enable bucket sync\n";
   cout << "  bucket radoslist           list rados objects backing bucket's objects\n";
+  cout << "  bucket compression-dict train\n";
+  cout << "                             train a compression dictionary for the bucket's small objects\n";
   cout << "  bi get                     retrieve bucket index object entries\n";
   cout << "  bi put                     store bucket index object entries\n";
   cout << "  bi list                    list raw bucket index entries\n";
@@ -667,6 +670,7 @@ enum class OPT {
   BUCKET_RADOS_LIST,
   BUCKET_SHARD_OBJECTS,
   BUCKET_OBJECT_SHARD,
+  BUCKET_COMPRESSION_DICT_TRAIN,
   POLICY,
   POOL_ADD,
   POOL_RM,
@@ -882,6 +886,7 @@ static SimpleCmd::Commands all_cmds = {
   { "bucket shard objects", OPT::BUCKET_SHARD_OBJECTS },
   { "bucket shard object", OPT::BUCKET_SHARD_OBJECTS },
   { "bucket object shard", OPT::BUCKET_OBJECT_SHARD },
+  { "bucket compression-dict train", OPT::BUCKET_COMPRESSION_DICT_TRAIN },
   { "policy", OPT::POLICY },
   { "pool add", OPT::POOL_ADD },
   { "pool rm", OPT::POOL_RM },
@@ -7163,6 +7168,37 @@ int main(int argc, const char **argv)
     formatter->flush(cout);
   }
 
+  if (opt_cmd == OPT::BUCKET_COMPRESSION_DICT_TRAIN) {
+    if (bucket_name.empty()) {
+      cerr << "ERROR: bucket not specified" << std::endl;
+      return EINVAL;
+    }
+    int ret = init_bucket(user.get(), tenant, bucket_name, bucket_id, &bucket);
+    if (ret < 0) {
+      cerr << "ERROR: could not init bucket: " << cpp_strerror(-ret) << std::endl;
+      return -ret;
+    }
+    const auto& compression_type = driver->get_compression_type(bucket->get_placement_rule());
+    if (compression_type == "none") {
+      cerr << "ERROR: compression is not enabled for placement "
+	   << bucket->get_placement_rule() << std::endl;
+      return EINVAL;
+    }
+    uint32_t dict_id = 0;
+    ret = rgw_compression_dict_train(dpp(), bucket.get(), compression_type,
+				     max_entries_specified ? max_entries : 1000,
+				     null_yield, &dict_id);
+    if (ret < 0) {
+      cerr << "ERROR: failed to train compression dictionary: "
+	   << cpp_strerror(-ret) << std::endl;
+      return -ret;
+    }
+    RGWCompressionDictionaries dicts;
+    rgw_compression_dicts_from_attrset(bucket->get_attrs(), dicts);
+    encode_json("compression_dictionaries", dicts, formatter.get());
+    formatter->flush(cout);
+  }
+
   if (opt_cmd == OPT::BUCKET_CHOWN) {
     if (bucket_name.empty()) {
       cerr << "ERROR: bucket name not specified" << std::endl;
@@ -17,8 +17,14 @@
 
 #include "rgw_aio_throttle.h"
 
+#include <algorithm>
+#include <atomic>
+
 namespace rgw {
 
+// bytes reserved above their minimum by all adaptive throttles
+static std::atomic<uint64_t> adaptive_window_reserved{0};
+
 bool Throttle::waiter_ready() const
 {
   switch (waiter) {
@@ -29,6 +35,63 @@ bool Throttle::waiter_ready() const
   }
 }
 
+void Throttle::on_issue(bool waited)
+{
+  if (round_start == ceph::mono_time{}) {
+    round_start = ceph::mono_clock::now();
+  }
+  round_limited |= waited;
+}
+
+void Throttle::on_complete(ceph::mono_time started, uint64_t cost)
+{
+  const auto now = ceph::mono_clock::now();
+  min_latency = std::min(min_latency, now - started);
+  round_bytes += cost;
+  if (round_bytes < window) {
+    return;
+  }
+  const double elapsed = std::chrono::duration<double>(now - round_start).count();
+  if (elapsed > 0) {
+    // keep twice the bandwidth-delay product in flight: enough to cover
+    // the unloaded latency, while growth stops once the added requests
+    // only queue up and raise the latency
+    const double throughput = round_bytes / elapsed;
+    auto target = static_cast<uint64_t>(
+        2 * throughput * std::chrono::duration<double>(min_latency).count());
+    if (!round_limited) {
+      // the caller didn't fill the window, so it can't tell us more
+      target = std::min(target, window);
+    }
+    resize(std::min(target, window * 2));
+  }
+  round_start = now;
+  round_bytes = 0;
+  round_limited = false;
+}
+
+void Throttle::resize(uint64_t target)
+{
+  target = std::clamp(target, min_window, max_window);
+  if (target < window) {
+    adaptive_window_reserved -= window - target;
+    window = target;
+    return;
+  }
+  const uint64_t want = target - window;
+  uint64_t reserved = adaptive_window_reserved.load();
+  uint64_t grant = 0;
+  do {
+    grant = reserved >= window_budget ? 0 :
+        std::min(want, window_budget - reserved);
+    if (grant == 0) {
+      return;
+    }
+  } while (!adaptive_window_reserved.compare_exchange_weak(reserved,
+                                                           reserved + grant));
+  window += grant;
+}
+
 AioResultList BlockingAioThrottle::get(const RGWSI_RADOS::Obj& obj,
                                        OpFunc&& f,
                                        uint64_t cost, uint64_t id)
@@ -45,12 +108,17 @@ AioResultList BlockingAioThrottle::get(const RGWSI_RADOS::Obj& obj,
   } else {
     // wait for the write size to become available
     pending_size += p->cost;
-    if (!is_available()) {
+    const bool waited = !is_available();
+    if (waited) {
       ceph_assert(waiter == Wait::None);
       waiter = Wait::Available;
       cond.wait(lock, [this] { return is_available(); });
       waiter = Wait::None;
     }
+    if (is_adaptive()) {
+      on_issue(waited);
+      p->started = ceph::mono_clock::now();
+    }
 
     // register the pending write and attach a completion
     p->parent = this;
@@ -73,6 +141,9 @@ void BlockingAioThrottle::put(AioResult& r)
   completed.push_back(p);
 
   pending_size -= p.cost;
+  if (is_adaptive()) {
+    on_complete(p.started, p.cost);
+  }
 
   if (waiter_ready()) {
     cond.notify_one();
@@ -135,7 +206,8 @@ AioResultList YieldingAioThrottle::get(const RGWSI_RADOS::Obj& obj,
   } else {
     // wait for the write size to become available
     pending_size += p->cost;
-    if (!is_available()) {
+    const bool waited = !is_available();
+    if (waited) {
       ceph_assert(waiter == Wait::None);
       ceph_assert(!completion);
 
@@ -143,6 +215,10 @@ AioResultList YieldingAioThrottle::get(const RGWSI_RADOS::Obj& obj,
       waiter = Wait::Available;
       async_wait(yield[ec]);
     }
+    if (is_adaptive()) {
+      on_issue(waited);
+      p->started = ceph::mono_clock::now();
+    }
 
     // register the pending write and initiate the operation
     pending.push_back(*p);
@@ -161,6 +237,9 @@ void YieldingAioThrottle::put(AioResult& r)
   completed.push_back(p);
 
   pending_size -= p.cost;
+  if (is_adaptive()) {
+    on_complete(p.started, p.cost);
+  }
 
   if (waiter_ready()) {
     ceph_assert(completion);
@@ -16,7 +16,9 @@
 #pragma once
 
 #include "include/rados/librados_fwd.hpp"
+#include <algorithm>
 #include <memory>
+#include "common/ceph_time.h"
 #include "common/ceph_mutex.h"
 #include "common/async/completion.h"
 #include "common/async/yield_context.h"
@@ -27,9 +29,26 @@ namespace rgw {
 
 class Throttle {
  protected:
-  const uint64_t window;
+  uint64_t window;
+  const uint64_t min_window;
+  const uint64_t max_window;
+  // bound on the bytes all adaptive throttles may hold above their minimum
+  const uint64_t window_budget;
   uint64_t pending_size = 0;
 
+  // adaptive sizing state, used when max_window > min_window. the window
+  // tracks twice the bandwidth-delay product measured over rounds of one
+  // window's worth of completions
+  ceph::timespan min_latency = ceph::timespan::max();
+  ceph::mono_time round_start;
+  uint64_t round_bytes = 0;
+  bool round_limited = false;
+
+  bool is_adaptive() const { return max_window > min_window; }
+  void on_issue(bool waited);
+  void on_complete(ceph::mono_time started, uint64_t cost);
+  void resize(uint64_t target);
+
   AioResultList pending;
   AioResultList completed;
 
@@ -43,12 +62,19 @@ class Throttle {
   bool waiter_ready() const;
 
  public:
-  Throttle(uint64_t window) : window(window) {}
+  Throttle(uint64_t window)
+    : window(window), min_window(window), max_window(window), window_budget(0)
+  {}
+  Throttle(uint64_t min_window, uint64_t max_window, uint64_t window_budget)
+    : window(min_window), min_window(min_window),
+      max_window(std::max(min_window, max_window)), window_budget(window_budget)
+  {}
 
   virtual ~Throttle() {
     // must drain before destructing
     ceph_assert(pending.empty());
     ceph_assert(completed.empty());
+    resize(min_window); // return any budget we hold
   }
 };
 
@@ -62,9 +88,13 @@ class BlockingAioThrottle final : public Aio, private Throttle {
     BlockingAioThrottle *parent = nullptr;
     uint64_t cost = 0;
     librados::AioCompletion *completion = nullptr;
+    ceph::mono_time started;
   };
  public:
   BlockingAioThrottle(uint64_t window) : Throttle(window) {}
+  BlockingAioThrottle(uint64_t min_window, uint64_t max_window,
+                      uint64_t window_budget)
+    : Throttle(min_window, max_window, window_budget) {}
 
   virtual ~BlockingAioThrottle() override {};
 
@@ -94,13 +124,22 @@ class YieldingAioThrottle final : public Aio, private Throttle {
   template <typename CompletionToken>
   auto async_wait(CompletionToken&& token);
 
-  struct Pending : AioResultEntry { uint64_t cost = 0; };
+  struct Pending : AioResultEntry {
+    uint64_t cost = 0;
+    ceph::mono_time started;
+  };
 
  public:
   YieldingAioThrottle(uint64_t window, boost::asio::io_context& context,
                       yield_context yield)
     : Throttle(window), context(context), yield(yield)
   {}
+  YieldingAioThrottle(uint64_t min_window, uint64_t max_window,
+                      uint64_t window_budget, boost::asio::io_context& context,
+                      yield_context yield)
+    : Throttle(min_window, max_window, window_budget),
+      context(context), yield(yield)
+  {}
 
   virtual ~YieldingAioThrottle() override {};
 
@@ -130,4 +169,24 @@ inline auto make_throttle(uint64_t window_size, optional_yield y)
   return aio;
 }
 
+// return a smart pointer to Aio whose window starts at min_window_size and
+// adapts to the measured latency and throughput, up to max_window_size
+inline auto make_throttle(uint64_t min_window_size, uint64_t max_window_size,
+                          uint64_t window_budget, optional_yield y)
+{
+  std::unique_ptr<Aio> aio;
+  if (y) {
+    aio = std::make_unique<YieldingAioThrottle>(min_window_size,
+                                                max_window_size,
+                                                window_budget,
+                                                y.get_io_context(),
+                                                y.get_yield_context());
+  } else {
+    aio = std::make_unique<BlockingAioThrottle>(min_window_size,
+                                                max_window_size,
+                                                window_budget);
+  }
+  return aio;
+}
+
 } // namespace rgw
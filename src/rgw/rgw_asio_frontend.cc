@@ -3,6 +3,7 @@
 
 #include <atomic>
 #include <ctime>
+#include <deque>
 #include <thread>
 #include <vector>
 
@@ -15,6 +16,7 @@
 
 #include "common/async/shared_mutex.h"
 #include "common/errno.h"
+#include "common/perf_counters_collection.h"
 #include "common/strtol.h"
 
 #include "rgw_asio_client.h"
@@ -185,6 +187,30 @@ std::ostream& operator<<(std::ostream& out, const log_apache_time& a) {
 
 using SharedMutex = ceph::async::SharedMutex<boost::asio::io_context::executor_type>;
 
+// per-worker counters of the so_reuseport mode
+enum {
+  l_beast_worker_first = 16300,
+  l_beast_worker_connections,
+  l_beast_worker_active_connections,
+  l_beast_worker_requests,
+  l_beast_worker_last,
+};
+
+PerfCountersRef build_worker_counters(CephContext *cct, const std::string& name)
+{
+  PerfCountersBuilder b(cct, name, l_beast_worker_first, l_beast_worker_last);
+  b.add_u64_counter(l_beast_worker_connections, "connections",
+                    "Connections accepted by this worker");
+  b.add_u64(l_beast_worker_active_connections, "active_connections",
+            "Open connections served by this worker");
+  b.add_u64_counter(l_beast_worker_requests, "requests",
+                    "Requests served by this worker");
+
+  auto logger = PerfCountersRef{ b.create_perf_counters(), cct };
+  cct->get_perfcounters_collection()->add(logger.get());
+  return logger;
+}
+
 template <typename Stream>
 void handle_connection(boost::asio::io_context& context,
                        RGWProcessEnv& env, Stream& stream,
@@ -192,6 +218,7 @@ void handle_connection(boost::asio::io_context& context,
                        parse_buffer& buffer, bool is_ssl,
                        SharedMutex& pause_mutex,
                        rgw::dmclock::Scheduler *scheduler,
+                       PerfCounters *worker_counters,
                        const std::string& uri_prefix,
                        boost::system::error_code& ec,
                        yield_context yield)
@@ -251,6 +278,9 @@ void handle_connection(boost::asio::io_context& context,
 
       // process the request
       RGWRequest req{env.driver->get_new_req_id()};
+      if (worker_counters) {
+        worker_counters->inc(l_beast_worker_requests);
+      }
 
       auto& socket = stream.lowest_layer();
       const auto& remote_endpoint = socket.remote_endpoint(ec);
@@ -391,6 +421,22 @@ class ConnectionList {
   }
 };
 
+// tracks a connection in its worker's active_connections gauge
+class worker_connection_guard {
+  PerfCounters *counters;
+ public:
+  explicit worker_connection_guard(PerfCounters *counters) : counters(counters) {
+    if (counters) {
+      counters->inc(l_beast_worker_active_connections);
+    }
+  }
+  ~worker_connection_guard() {
+    if (counters) {
+      counters->dec(l_beast_worker_active_connections);
+    }
+  }
+};
+
 namespace dmc = rgw::dmclock;
 class AsioFrontend {
   RGWProcessEnv& env;
@@ -411,23 +457,36 @@ class AsioFrontend {
   SharedMutex pause_mutex;
   std::unique_ptr<rgw::dmclock::Scheduler> scheduler;
 
+  // with so_reuseport, each thread runs its own io_context (the first one
+  // is 'context') and accepts on its own SO_REUSEPORT socket per endpoint,
+  // so the kernel spreads connections over the threads
+  bool reuseport = false;
+  std::deque<boost::asio::io_context> worker_contexts;
+  std::vector<PerfCountersRef> worker_counters;
+
+  boost::asio::io_context& context_of(size_t worker) {
+    return worker == 0 ? context : worker_contexts[worker - 1];
+  }
+
   struct Listener {
+    boost::asio::io_context& context;
+    size_t worker = 0;
     tcp::endpoint endpoint;
     tcp::acceptor acceptor;
     tcp_socket socket;
     bool use_ssl = false;
     bool use_nodelay = false;
 
-    explicit Listener(boost::asio::io_context& context)
-      : acceptor(context), socket(context) {}
+    explicit Listener(boost::asio::io_context& context, size_t worker = 0)
+      : context(context), worker(worker), acceptor(context), socket(context) {}
   };
   std::vector<Listener> listeners;
 
   ConnectionList connections;
 
-  // work guard to keep run() threads busy while listeners are paused
+  // work guards to keep run() threads busy while listeners are paused
   using Executor = boost::asio::io_context::executor_type;
-  std::optional<boost::asio::executor_work_guard<Executor>> work;
+  std::vector<boost::asio::executor_work_guard<Executor>> work;
 
   std::vector<std::thread> threads;
   std::atomic<bool> going_down{false};
@@ -630,7 +689,34 @@ int AsioFrontend::init()
       l.use_nodelay = (nodelay->second == "1");
     }
   }
-  
+
+  if (auto i = config.find("so_reuseport"); i != config.end()) {
+    reuseport = (i->second == "1");
+  }
+  if (reuseport) {
+    // clone each listener for every other worker
+    const size_t worker_count = std::max<int64_t>(1, ctx()->_conf->rgw_thread_pool_size);
+    const size_t endpoint_count = listeners.size();
+    for (size_t w = 1; w < worker_count; w++) {
+      worker_contexts.emplace_back(1);
+    }
+    listeners.reserve(endpoint_count * worker_count);
+    for (size_t w = 1; w < worker_count; w++) {
+      for (size_t i = 0; i < endpoint_count; i++) {
+        const auto& src = listeners[i];
+        Listener l{context_of(w), w};
+        l.endpoint = src.endpoint;
+        l.use_ssl = src.use_ssl;
+        l.use_nodelay = src.use_nodelay;
+        listeners.push_back(std::move(l));
+      }
+    }
+    for (size_t w = 0; w < worker_count; w++) {
+      worker_counters.push_back(build_worker_counters(
+          ctx(), "rgw_beast_worker-" + std::to_string(w)));
+    }
+  }
+
 
   bool socket_bound = false;
   // start listeners
@@ -657,6 +743,16 @@ int AsioFrontend::init()
     }
 
     l.acceptor.set_option(tcp::acceptor::reuse_address(true));
+    if (reuseport) {
+      using reuse_port = boost::asio::detail::socket_option::boolean<
+          SOL_SOCKET, SO_REUSEPORT>;
+      l.acceptor.set_option(reuse_port(true), ec);
+      if (ec) {
+        lderr(ctx()) << "failed to set SO_REUSEPORT socket option: "
+		     << ec.message() << dendl;
+        return -ec.value();
+      }
+    }
     l.acceptor.bind(l.endpoint, ec);
     if (ec) {
       lderr(ctx()) << "failed to bind address " << l.endpoint
@@ -680,7 +776,8 @@ int AsioFrontend::init()
                               accept(l, ec);
                             });
 
-    ldout(ctx(), 4) << "frontend listening on " << l.endpoint << dendl;
+    ldout(ctx(), 4) << "frontend listening on " << l.endpoint
+        << (reuseport ? " worker=" + std::to_string(l.worker) : "") << dendl;
     socket_bound = true;
   }
   if (!socket_bound) {
@@ -1011,14 +1108,22 @@ void AsioFrontend::accept(Listener& l, boost::system::error_code ec)
                           [this, &l] (boost::system::error_code ec) {
                             accept(l, ec);
                           });
-  
+
+  auto& context = l.context;
+  PerfCounters *counters = nullptr;
+  if (reuseport) {
+    counters = worker_counters[l.worker].get();
+    counters->inc(l_beast_worker_connections);
+  }
+
   // spawn a coroutine to handle the connection
 #ifdef WITH_RADOSGW_BEAST_OPENSSL
   if (l.use_ssl) {
     spawn::spawn(context,
-      [this, s=std::move(stream)] (yield_context yield) mutable {
+      [this, &context, counters, s=std::move(stream)] (yield_context yield) mutable {
         auto conn = boost::intrusive_ptr{new Connection(std::move(s))};
         auto c = connections.add(*conn);
+        auto active = worker_connection_guard{counters};
         // wrap the tcp stream in an ssl stream
         boost::asio::ssl::stream<tcp_socket&> stream{conn->socket, *ssl_context};
         auto timeout = timeout_timer{context.get_executor(), request_timeout, conn};
@@ -1035,7 +1140,7 @@ void AsioFrontend::accept(Listener& l, boost::system::error_code ec)
         conn->buffer.consume(bytes);
         handle_connection(context, env, stream, timeout, header_limit,
                           conn->buffer, true, pause_mutex, scheduler.get(),
-                          uri_prefix, ec, yield);
+                          counters, uri_prefix, ec, yield);
         if (!ec) {
           // ssl shutdown (ignoring errors)
           stream.async_shutdown(yield[ec]);
@@ -1047,14 +1152,15 @@ void AsioFrontend::accept(Listener& l, boost::system::error_code ec)
   {
 #endif // WITH_RADOSGW_BEAST_OPENSSL
     spawn::spawn(context,
-      [this, s=std::move(stream)] (yield_context yield) mutable {
+      [this, &context, counters, s=std::move(stream)] (yield_context yield) mutable {
         auto conn = boost::intrusive_ptr{new Connection(std::move(s))};
         auto c = connections.add(*conn);
+        auto active = worker_connection_guard{counters};
         auto timeout = timeout_timer{context.get_executor(), request_timeout, conn};
         boost::system::error_code ec;
         handle_connection(context, env, conn->socket, timeout, header_limit,
                           conn->buffer, false, pause_mutex, scheduler.get(),
-                          uri_prefix, ec, yield);
+                          counters, uri_prefix, ec, yield);
         conn->socket.shutdown(tcp_socket::shutdown_both, ec);
       }, make_stack_allocator());
   }
@@ -1063,22 +1169,28 @@ void AsioFrontend::accept(Listener& l, boost::system::error_code ec)
 int AsioFrontend::run()
 {
   auto cct = ctx();
-  const int thread_count = cct->_conf->rgw_thread_pool_size;
+  const int thread_count = reuseport ? worker_contexts.size() + 1 :
+      cct->_conf->rgw_thread_pool_size;
   threads.reserve(thread_count);
 
-  ldout(cct, 4) << "frontend spawning " << thread_count << " threads" << dendl;
+  ldout(cct, 4) << "frontend spawning " << thread_count << " threads"
+      << (reuseport ? ", one io_context each" : "") << dendl;
 
   // the worker threads call io_context::run(), which will return when there's
   // no work left. hold a work guard to keep these threads going until join()
-  work.emplace(boost::asio::make_work_guard(context));
+  work.push_back(boost::asio::make_work_guard(context));
+  for (auto& c : worker_contexts) {
+    work.push_back(boost::asio::make_work_guard(c));
+  }
 
   for (int i = 0; i < thread_count; i++) {
-    threads.emplace_back([this]() noexcept {
+    auto& c = reuseport ? context_of(i) : context;
+    threads.emplace_back([&c]() noexcept {
       // request warnings on synchronous librados calls in this thread
       is_asio_thread = true;
       // Have uncaught exceptions kill the process and give a
       // stacktrace, not be swallowed.
-      context.run();
+      c.run();
     });
   }
   return 0;
@@ -1105,7 +1217,7 @@ void AsioFrontend::join()
   if (!going_down) {
     stop();
   }
-  work.reset();
+  work.clear();
 
   ldout(ctx(), 4) << "frontend joining threads..." << dendl;
   for (auto& thread : threads) {
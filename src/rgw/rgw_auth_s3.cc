@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "common/armor.h"
+#include "common/lru_map.h"
 #include "common/utf8.h"
 #include "rgw_rest_s3.h"
 #include "rgw_auth_s3.h"
@@ -894,6 +895,20 @@ transform_secret_key(const std::string_view& secret_access_key)
   return secret_key_utf8;
 }
 
+/*
+ * the SigningKey depends only on the secret and the credential scope, so
+ * it stays valid for the whole day the scope names. the secret is part of
+ * the cache key, so a changed secret can never match a stale entry
+ */
+static lru_map<std::string, sha256_digest_t>*
+get_v4_signing_key_cache(CephContext* const cct)
+{
+  static const auto size =
+    cct->_conf.get_val<uint64_t>("rgw_s3_signing_key_cache_size");
+  static lru_map<std::string, sha256_digest_t> cache(size);
+  return size > 0 ? &cache : nullptr;
+}
+
 /*
  * calculate the SigningKey of AWS auth version 4
  */
@@ -903,6 +918,21 @@ get_v4_signing_key(CephContext* const cct,
                    const std::string_view& secret_access_key,
                    const DoutPrefixProvider *dpp)
 {
+  auto cache = get_v4_signing_key_cache(cct);
+  std::string cache_key;
+  if (cache) {
+    cache_key.reserve(secret_access_key.size() + 1 + credential_scope.size());
+    cache_key.append(secret_access_key);
+    cache_key.push_back('\0');
+    cache_key.append(credential_scope);
+
+    sha256_digest_t signing_key;
+    if (cache->find(cache_key, signing_key)) {
+      ldpp_dout(dpp, 10) << "signing_k = " << signing_key << " (cached)" << dendl;
+      return signing_key;
+    }
+  }
+
   std::string_view date, region, service;
   std::tie(date, region, service) = parse_cred_scope(credential_scope);
 
@@ -920,6 +950,10 @@ get_v4_signing_key(CephContext* const cct,
   ldpp_dout(dpp, 10) << "service_k = " << service_k << dendl;
   ldpp_dout(dpp, 10) << "signing_k = " << signing_key << dendl;
 
+  if (cache) {
+    auto value = signing_key;
+    cache->add(cache_key, value);
+  }
   return signing_key;
 }
 
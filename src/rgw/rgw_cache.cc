@@ -5,19 +5,63 @@
 #include "rgw_perf_counters.h"
 
 #include <errno.h>
+#include <algorithm>
 
 #define dout_subsys ceph_subsys_rgw
 
 using namespace std;
 
-int ObjectCache::get(const DoutPrefixProvider *dpp, const string& name, ObjectCacheInfo& info, uint32_t mask, rgw_cache_entry_info *cache_info)
+std::shared_lock<ceph::shared_mutex> ObjectCache::read_lock(Shard& shard)
+{
+  std::shared_lock l{shard.lock, std::try_to_lock};
+  if (!l.owns_lock()) {
+    auto start = ceph::mono_clock::now();
+    l.lock();
+    if (perfcounter) {
+      perfcounter->tinc(l_rgw_cache_lock_wait, ceph::mono_clock::now() - start);
+    }
+  }
+  return l;
+}
+
+std::unique_lock<ceph::shared_mutex> ObjectCache::write_lock(Shard& shard)
+{
+  std::unique_lock l{shard.lock, std::try_to_lock};
+  if (!l.owns_lock()) {
+    auto start = ceph::mono_clock::now();
+    l.lock();
+    if (perfcounter) {
+      perfcounter->tinc(l_rgw_cache_lock_wait, ceph::mono_clock::now() - start);
+    }
+  }
+  return l;
+}
+
+void ObjectCache::upgrade_lock(std::shared_lock<ceph::shared_mutex>& rl,
+                               std::unique_lock<ceph::shared_mutex>& wl)
 {
+  rl.unlock();
+  if (!wl.try_lock()) {
+    auto start = ceph::mono_clock::now();
+    wl.lock();
+    if (perfcounter) {
+      perfcounter->tinc(l_rgw_cache_lock_wait, ceph::mono_clock::now() - start);
+    }
+  }
+}
 
-  std::shared_lock rl{lock};
-  std::unique_lock wl{lock, std::defer_lock}; // may be promoted to write lock
+int ObjectCache::get(const DoutPrefixProvider *dpp, const string& name, ObjectCacheInfo& info, uint32_t mask, rgw_cache_entry_info *cache_info)
+{
+  if (!enabled) {
+    return -ENOENT;
+  }
+  Shard& shard = shard_of(name);
+  auto rl = read_lock(shard);
+  std::unique_lock wl{shard.lock, std::defer_lock}; // may be promoted to write lock
   if (!enabled) {
     return -ENOENT;
   }
+  auto& cache_map = shard.cache_map;
   auto iter = cache_map.find(name);
   if (iter == cache_map.end()) {
     ldpp_dout(dpp, 10) << "cache get: name=" << name << " : miss" << dendl;
@@ -30,14 +74,13 @@ int ObjectCache::get(const DoutPrefixProvider *dpp, const string& name, ObjectCa
   if (expiry.count() &&
        (ceph::coarse_mono_clock::now() - iter->second.info.time_added) > expiry) {
     ldpp_dout(dpp, 10) << "cache get: name=" << name << " : expiry miss" << dendl;
-    rl.unlock();
-    wl.lock(); // write lock for expiration
+    upgrade_lock(rl, wl); // write lock for expiration
     // check that wasn't already removed by other thread
     iter = cache_map.find(name);
     if (iter != cache_map.end()) {
       for (auto &kv : iter->second.chained_entries)
         kv.first->invalidate(kv.second);
-      remove_lru(name, iter->second.lru_iter);
+      remove_lru(shard, name, iter->second.lru_iter);
       cache_map.erase(iter);
     }
     if (perfcounter) {
@@ -48,11 +91,10 @@ int ObjectCache::get(const DoutPrefixProvider *dpp, const string& name, ObjectCa
 
   ObjectCacheEntry *entry = &iter->second;
 
-  if (lru_counter - entry->lru_promotion_ts > lru_window) {
-    ldpp_dout(dpp, 20) << "cache get: touching lru, lru_counter=" << lru_counter
+  if (shard.lru_counter - entry->lru_promotion_ts > lru_window) {
+    ldpp_dout(dpp, 20) << "cache get: touching lru, lru_counter=" << shard.lru_counter
                    << " promotion_ts=" << entry->lru_promotion_ts << dendl;
-    rl.unlock();
-    wl.lock(); // write lock for touch_lru()
+    upgrade_lock(rl, wl); // write lock for touch_lru()
     /* need to redo this because entry might have dropped off the cache */
     iter = cache_map.find(name);
     if (iter == cache_map.end()) {
@@ -63,8 +105,8 @@ int ObjectCache::get(const DoutPrefixProvider *dpp, const string& name, ObjectCa
 
     entry = &iter->second;
     /* check again, we might have lost a race here */
-    if (lru_counter - entry->lru_promotion_ts > lru_window) {
-      touch_lru(dpp, name, *entry, iter->second.lru_iter);
+    if (shard.lru_counter - entry->lru_promotion_ts > lru_window) {
+      touch_lru(dpp, shard, name, *entry, iter->second.lru_iter);
     }
   }
 
@@ -99,7 +141,24 @@ bool ObjectCache::chain_cache_entry(const DoutPrefixProvider *dpp,
                                     std::initializer_list<rgw_cache_entry_info*> cache_info_entries,
 				    RGWChainedCache::Entry *chained_entry)
 {
-  std::unique_lock l{lock};
+  if (!enabled) {
+    return false;
+  }
+
+  /* the entries may live in different shards; lock each of them once,
+   * in shard order */
+  std::vector<size_t> shard_ids;
+  shard_ids.reserve(cache_info_entries.size());
+  for (auto cache_info : cache_info_entries) {
+    shard_ids.push_back(&shard_of(cache_info->cache_locator) - shards.get());
+  }
+  std::sort(shard_ids.begin(), shard_ids.end());
+  shard_ids.erase(std::unique(shard_ids.begin(), shard_ids.end()), shard_ids.end());
+  std::vector<std::unique_lock<ceph::shared_mutex>> locks;
+  locks.reserve(shard_ids.size());
+  for (auto id : shard_ids) {
+    locks.push_back(write_lock(shards[id]));
+  }
 
   if (!enabled) {
     return false;
@@ -111,6 +170,7 @@ bool ObjectCache::chain_cache_entry(const DoutPrefixProvider *dpp,
   for (auto cache_info : cache_info_entries) {
     ldpp_dout(dpp, 10) << "chain_cache_entry: cache_locator="
 		   << cache_info->cache_locator << dendl;
+    auto& cache_map = shard_of(cache_info->cache_locator).cache_map;
     auto iter = cache_map.find(cache_info->cache_locator);
     if (iter == cache_map.end()) {
       ldpp_dout(dpp, 20) << "chain_cache_entry: couldn't find cache locator" << dendl;
@@ -141,7 +201,11 @@ bool ObjectCache::chain_cache_entry(const DoutPrefixProvider *dpp,
 
 void ObjectCache::put(const DoutPrefixProvider *dpp, const string& name, ObjectCacheInfo& info, rgw_cache_entry_info *cache_info)
 {
-  std::unique_lock l{lock};
+  if (!enabled) {
+    return;
+  }
+  Shard& shard = shard_of(name);
+  auto l = write_lock(shard);
 
   if (!enabled) {
     return;
@@ -150,11 +214,11 @@ void ObjectCache::put(const DoutPrefixProvider *dpp, const string& name, ObjectC
   ldpp_dout(dpp, 10) << "cache put: name=" << name << " info.flags=0x"
                  << std::hex << info.flags << std::dec << dendl;
 
-  auto [iter, inserted] = cache_map.emplace(name, ObjectCacheEntry{});
+  auto [iter, inserted] = shard.cache_map.emplace(name, ObjectCacheEntry{});
   ObjectCacheEntry& entry = iter->second;
   entry.info.time_added = ceph::coarse_mono_clock::now();
   if (inserted) {
-    entry.lru_iter = lru.end();
+    entry.lru_iter = shard.lru.end();
   }
   ObjectCacheInfo& target = entry.info;
 
@@ -163,7 +227,7 @@ void ObjectCache::put(const DoutPrefixProvider *dpp, const string& name, ObjectC
   entry.chained_entries.clear();
   entry.gen++;
 
-  touch_lru(dpp, name, entry, entry.lru_iter);
+  touch_lru(dpp, shard, name, entry, entry.lru_iter);
 
   target.status = info.status;
 
@@ -218,14 +282,18 @@ void ObjectCache::put(const DoutPrefixProvider *dpp, const string& name, ObjectC
 // negative lookup. It must only invalidate.
 bool ObjectCache::invalidate_remove(const DoutPrefixProvider *dpp, const string& name)
 {
-  std::unique_lock l{lock};
+  if (!enabled) {
+    return false;
+  }
+  Shard& shard = shard_of(name);
+  auto l = write_lock(shard);
 
   if (!enabled) {
     return false;
   }
 
-  auto iter = cache_map.find(name);
-  if (iter == cache_map.end())
+  auto iter = shard.cache_map.find(name);
+  if (iter == shard.cache_map.end())
     return false;
 
   ldpp_dout(dpp, 10) << "removing " << name << " from cache" << dendl;
@@ -235,15 +303,16 @@ bool ObjectCache::invalidate_remove(const DoutPrefixProvider *dpp, const string&
     kv.first->invalidate(kv.second);
   }
 
-  remove_lru(name, iter->second.lru_iter);
-  cache_map.erase(iter);
+  remove_lru(shard, name, iter->second.lru_iter);
+  shard.cache_map.erase(iter);
   return true;
 }
 
-void ObjectCache::touch_lru(const DoutPrefixProvider *dpp, const string& name, ObjectCacheEntry& entry,
-			    std::list<string>::iterator& lru_iter)
+void ObjectCache::touch_lru(const DoutPrefixProvider *dpp, Shard& shard, const string& name,
+			    ObjectCacheEntry& entry, std::list<string>::iterator& lru_iter)
 {
-  while (lru_size > (size_t)cct->_conf->rgw_cache_lru_size) {
+  auto& lru = shard.lru;
+  while (shard.lru_size > lru_max) {
     auto iter = lru.begin();
     if ((*iter).compare(name) == 0) {
       /*
@@ -252,20 +321,20 @@ void ObjectCache::touch_lru(const DoutPrefixProvider *dpp, const string& name, O
        */
       break;
     }
-    auto map_iter = cache_map.find(*iter);
+    auto map_iter = shard.cache_map.find(*iter);
     ldout(cct, 10) << "removing entry: name=" << *iter << " from cache LRU" << dendl;
-    if (map_iter != cache_map.end()) {
+    if (map_iter != shard.cache_map.end()) {
       ObjectCacheEntry& entry = map_iter->second;
       invalidate_lru(entry);
-      cache_map.erase(map_iter);
+      shard.cache_map.erase(map_iter);
     }
     lru.pop_front();
-    lru_size--;
+    shard.lru_size--;
   }
 
   if (lru_iter == lru.end()) {
     lru.push_back(name);
-    lru_size++;
+    shard.lru_size++;
     lru_iter--;
     ldpp_dout(dpp, 10) << "adding " << name << " to cache LRU end" << dendl;
   } else {
@@ -276,19 +345,19 @@ void ObjectCache::touch_lru(const DoutPrefixProvider *dpp, const string& name, O
     --lru_iter;
   }
 
-  lru_counter++;
-  entry.lru_promotion_ts = lru_counter;
+  shard.lru_counter++;
+  entry.lru_promotion_ts = shard.lru_counter;
 }
 
-void ObjectCache::remove_lru(const string& name,
+void ObjectCache::remove_lru(Shard& shard, const string& name,
 			     std::list<string>::iterator& lru_iter)
 {
-  if (lru_iter == lru.end())
+  if (lru_iter == shard.lru.end())
     return;
 
-  lru.erase(lru_iter);
-  lru_size--;
-  lru_iter = lru.end();
+  shard.lru.erase(lru_iter);
+  shard.lru_size--;
+  lru_iter = shard.lru.end();
 }
 
 void ObjectCache::invalidate_lru(ObjectCacheEntry& entry)
@@ -302,8 +371,6 @@ void ObjectCache::invalidate_lru(ObjectCacheEntry& entry)
 
 void ObjectCache::set_enabled(bool status)
 {
-  std::unique_lock l{lock};
-
   enabled = status;
 
   if (!enabled) {
@@ -313,32 +380,33 @@ void ObjectCache::set_enabled(bool status)
 
 void ObjectCache::invalidate_all()
 {
-  std::unique_lock l{lock};
-
   do_invalidate_all();
 }
 
 void ObjectCache::do_invalidate_all()
 {
-  cache_map.clear();
-  lru.clear();
-
-  lru_size = 0;
-  lru_counter = 0;
-  lru_window = 0;
+  for (size_t i = 0; i < num_shards; ++i) {
+    auto& shard = shards[i];
+    std::unique_lock l{shard.lock};
+    shard.cache_map.clear();
+    shard.lru.clear();
+    shard.lru_size = 0;
+    shard.lru_counter = 0;
+  }
 
+  std::shared_lock l{chained_lock};
   for (auto& cache : chained_cache) {
     cache->invalidate_all();
   }
 }
 
 void ObjectCache::chain_cache(RGWChainedCache *cache) {
-  std::unique_lock l{lock};
+  std::unique_lock l{chained_lock};
   chained_cache.push_back(cache);
 }
 
 void ObjectCache::unchain_cache(RGWChainedCache *cache) {
-  std::unique_lock l{lock};
+  std::unique_lock l{chained_lock};
 
   auto iter = chained_cache.begin();
   for (; iter != chained_cache.end(); ++iter) {
@@ -6,6 +6,8 @@
 #include <string>
 #include <map>
 #include <unordered_map>
+#include <atomic>
+#include <memory>
 #include "include/types.h"
 #include "include/utime.h"
 #include "include/ceph_assert.h"
@@ -159,28 +161,45 @@ struct ObjectCacheEntry {
 };
 
 class ObjectCache {
-  std::unordered_map<std::string, ObjectCacheEntry> cache_map;
-  std::list<std::string> lru;
-  unsigned long lru_size;
-  unsigned long lru_counter;
+  /* entries are spread over independently locked shards by name hash,
+   * so lookups of unrelated metadata objects don't contend */
+  struct Shard {
+    std::unordered_map<std::string, ObjectCacheEntry> cache_map;
+    std::list<std::string> lru;
+    unsigned long lru_size = 0;
+    unsigned long lru_counter = 0;
+    ceph::shared_mutex lock = ceph::make_shared_mutex("ObjectCache::Shard");
+  };
+  std::unique_ptr<Shard[]> shards;
+  size_t num_shards;
+  unsigned long lru_max;
   unsigned long lru_window;
-  ceph::shared_mutex lock = ceph::make_shared_mutex("ObjectCache");
   CephContext *cct;
 
+  ceph::shared_mutex chained_lock = ceph::make_shared_mutex("ObjectCache::chained");
   std::vector<RGWChainedCache *> chained_cache;
 
-  bool enabled;
+  std::atomic<bool> enabled;
   ceph::timespan expiry;
 
-  void touch_lru(const DoutPrefixProvider *dpp, const std::string& name, ObjectCacheEntry& entry,
-		 std::list<std::string>::iterator& lru_iter);
-  void remove_lru(const std::string& name, std::list<std::string>::iterator& lru_iter);
+  Shard& shard_of(const std::string& name) {
+    return shards[std::hash<std::string>{}(name) % num_shards];
+  }
+  std::shared_lock<ceph::shared_mutex> read_lock(Shard& shard);
+  std::unique_lock<ceph::shared_mutex> write_lock(Shard& shard);
+  void upgrade_lock(std::shared_lock<ceph::shared_mutex>& rl,
+                    std::unique_lock<ceph::shared_mutex>& wl);
+
+  void touch_lru(const DoutPrefixProvider *dpp, Shard& shard, const std::string& name,
+		 ObjectCacheEntry& entry, std::list<std::string>::iterator& lru_iter);
+  void remove_lru(Shard& shard, const std::string& name, std::list<std::string>::iterator& lru_iter);
   void invalidate_lru(ObjectCacheEntry& entry);
 
   void do_invalidate_all();
 
 public:
-  ObjectCache() : lru_size(0), lru_counter(0), lru_window(0), cct(NULL), enabled(false) { }
+  ObjectCache() : shards(new Shard[1]), num_shards(1), lru_max(0), lru_window(0),
+                  cct(NULL), enabled(false) { }
   ~ObjectCache();
   int get(const DoutPrefixProvider *dpp, const std::string& name, ObjectCacheInfo& bl, uint32_t mask, rgw_cache_entry_info *cache_info);
   std::optional<ObjectCacheInfo> get(const DoutPrefixProvider *dpp, const std::string& name) {
@@ -191,10 +210,14 @@ public:
 
   template<typename F>
   void for_each(const F& f) {
-    std::shared_lock l{lock};
-    if (enabled) {
+    if (!enabled) {
+      return;
+    }
+    for (size_t i = 0; i < num_shards; ++i) {
+      auto& shard = shards[i];
+      std::shared_lock l{shard.lock};
       auto now  = ceph::coarse_mono_clock::now();
-      for (const auto& [name, entry] : cache_map) {
+      for (const auto& [name, entry] : shard.cache_map) {
         if (expiry.count() && (now - entry.info.time_added) < expiry) {
           f(name, entry);
         }
@@ -206,7 +229,10 @@ public:
   bool invalidate_remove(const DoutPrefixProvider *dpp, const std::string& name);
   void set_ctx(CephContext *_cct) {
     cct = _cct;
-    lru_window = cct->_conf->rgw_cache_lru_size / 2;
+    num_shards = std::max<uint64_t>(1, cct->_conf.get_val<uint64_t>("rgw_cache_shards"));
+    shards.reset(new Shard[num_shards]);
+    lru_max = std::max<unsigned long>(1, cct->_conf->rgw_cache_lru_size / num_shards);
+    lru_window = lru_max / 2;
     expiry = std::chrono::seconds(cct->_conf.get_val<uint64_t>(
 						"rgw_cache_expiry_interval"));
   }
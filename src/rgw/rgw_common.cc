@@ -2168,6 +2168,13 @@ bool match_policy(std::string_view pattern, std::string_view input,
 {
   const uint32_t flag2 = flag & (MATCH_POLICY_ACTION|MATCH_POLICY_ARN) ?
       MATCH_CASE_INSENSITIVE : 0;
+
+  // without wildcards, matching block by block is the same as comparing
+  // the whole strings
+  if (pattern.find_first_of("*?") == std::string_view::npos) {
+    return match_wildcards(pattern, input, flag2);
+  }
+
   const bool colonblocks = !(flag & (MATCH_POLICY_RESOURCE |
 				     MATCH_POLICY_STRING));
 
@@ -1,6 +1,11 @@
 // -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
 // vim: ts=8 sw=2 smarttab ft=cpp
 
+#include <limits>
+
+#include "common/ceph_mutex.h"
+#include "common/errno.h"
+#include "common/random.h"
 #include "rgw_compression.h"
 
 #define dout_subsys ceph_subsys_rgw
@@ -39,6 +44,270 @@ int rgw_compression_info_from_attrset(const map<string, bufferlist>& attrs,
   return rgw_compression_info_from_attr(value->second, need_decompress, cs_info);
 }
 
+namespace {
+
+// digested dictionaries by id. an id is never reused for other content, so
+// entries don't need invalidation
+class DictContextCache {
+  static constexpr size_t max_entries = 64;
+  ceph::mutex mutex = ceph::make_mutex("rgw_compression_dict_cache");
+  std::map<uint32_t, Compressor::DictionaryContextRef> contexts;
+ public:
+  Compressor::DictionaryContextRef get(CephContext* cct, uint32_t id,
+                                       const rgw_compression_dict& dict) {
+    {
+      std::lock_guard l{mutex};
+      auto i = contexts.find(id);
+      if (i != contexts.end()) {
+        return i->second;
+      }
+    }
+    auto compressor = Compressor::create(cct, dict.compression_type);
+    if (!compressor) {
+      return nullptr;
+    }
+    auto ctx = compressor->create_dictionary_context(dict.data);
+    if (!ctx) {
+      return nullptr;
+    }
+    std::lock_guard l{mutex};
+    if (contexts.size() >= max_entries) {
+      contexts.erase(contexts.begin());
+    }
+    contexts.emplace(id, ctx);
+    return ctx;
+  }
+};
+DictContextCache dict_contexts;
+
+// gathers the (decompressed) data of an object read
+class SampleCollector : public RGWGetObj_Filter {
+  bufferlist& data;
+ public:
+  explicit SampleCollector(bufferlist& data) : data(data) {}
+  int handle_data(bufferlist& bl, off_t bl_ofs, off_t bl_len) override {
+    bl.begin(bl_ofs).copy(bl_len, data);
+    return 0;
+  }
+};
+
+} // anonymous namespace
+
+int rgw_compression_dicts_from_attrset(const map<string, bufferlist>& bucket_attrs,
+                                       RGWCompressionDictionaries& dicts)
+{
+  auto value = bucket_attrs.find(RGW_ATTR_COMPRESSION_DICT);
+  if (value == bucket_attrs.end()) {
+    return -ENOENT;
+  }
+  auto bliter = value->second.cbegin();
+  try {
+    decode(dicts, bliter);
+  } catch (buffer::error& err) {
+    return -EIO;
+  }
+  return 0;
+}
+
+Compressor::DictionaryContextRef
+rgw_compression_dict_context(CephContext* cct,
+                             const RGWCompressionInfo& cs_info,
+                             const map<string, bufferlist>& bucket_attrs)
+{
+  if (!cs_info.dictionary_id) {
+    return nullptr;
+  }
+  RGWCompressionDictionaries dicts;
+  if (rgw_compression_dicts_from_attrset(bucket_attrs, dicts) < 0) {
+    return nullptr;
+  }
+  auto i = dicts.dicts.find(*cs_info.dictionary_id);
+  if (i == dicts.dicts.end()) {
+    return nullptr;
+  }
+  return dict_contexts.get(cct, i->first, i->second);
+}
+
+Compressor::DictionaryContextRef
+rgw_compression_current_dict(CephContext* cct,
+                             const map<string, bufferlist>& bucket_attrs,
+                             const std::string& compression_type,
+                             uint32_t& id)
+{
+  RGWCompressionDictionaries dicts;
+  if (rgw_compression_dicts_from_attrset(bucket_attrs, dicts) < 0) {
+    return nullptr;
+  }
+  auto i = dicts.dicts.find(dicts.current);
+  if (i == dicts.dicts.end() ||
+      i->second.compression_type != compression_type) {
+    return nullptr;
+  }
+  id = i->first;
+  return dict_contexts.get(cct, i->first, i->second);
+}
+
+int rgw_compression_dict_copy(const DoutPrefixProvider* dpp,
+                              const RGWCompressionInfo& cs_info,
+                              rgw::sal::Bucket* src_bucket,
+                              rgw::sal::Bucket* dest_bucket,
+                              optional_yield y)
+{
+  if (!cs_info.dictionary_id ||
+      src_bucket->get_key() == dest_bucket->get_key()) {
+    return 0;
+  }
+  const uint32_t id = *cs_info.dictionary_id;
+  RGWCompressionDictionaries dest_dicts;
+  int r = rgw_compression_dicts_from_attrset(dest_bucket->get_attrs(), dest_dicts);
+  if (r < 0 && r != -ENOENT) {
+    return r;
+  }
+  if (dest_dicts.dicts.count(id)) {
+    return 0;
+  }
+  RGWCompressionDictionaries src_dicts;
+  r = rgw_compression_dicts_from_attrset(src_bucket->get_attrs(), src_dicts);
+  auto i = src_dicts.dicts.find(id);
+  if (r < 0 || i == src_dicts.dicts.end()) {
+    ldpp_dout(dpp, 0) << "ERROR: compression dictionary " << id
+        << " not found in bucket " << src_bucket->get_name() << dendl;
+    return -EIO;
+  }
+  dest_dicts.dicts.emplace(id, i->second);
+
+  rgw::sal::Attrs attrs;
+  encode(dest_dicts, attrs[RGW_ATTR_COMPRESSION_DICT]);
+  r = dest_bucket->merge_and_store_attrs(dpp, attrs, y);
+  if (r < 0) {
+    ldpp_dout(dpp, 0) << "ERROR: failed to store compression dictionary " << id
+        << " in bucket " << dest_bucket->get_name() << ": "
+        << cpp_strerror(-r) << dendl;
+    return r;
+  }
+  ldpp_dout(dpp, 10) << "copied compression dictionary " << id << " from bucket "
+      << src_bucket->get_name() << " to " << dest_bucket->get_name() << dendl;
+  return 0;
+}
+
+int rgw_compression_dict_train(const DoutPrefixProvider* dpp,
+                               rgw::sal::Bucket* bucket,
+                               const std::string& compression_type,
+                               uint32_t max_samples,
+                               optional_yield y,
+                               uint32_t* id)
+{
+  CephContext* cct = dpp->get_cct();
+  CompressorRef compressor = Compressor::create(cct, compression_type);
+  if (!compressor) {
+    ldpp_dout(dpp, 0) << "ERROR: cannot load compressor of type "
+        << compression_type << dendl;
+    return -EINVAL;
+  }
+  const uint64_t max_object_size = cct->_conf->rgw_compression_dict_max_object_size;
+
+  std::vector<bufferlist> samples;
+  rgw::sal::Bucket::ListParams params;
+  params.allow_unordered = true;
+  rgw::sal::Bucket::ListResults results;
+  do {
+    int r = bucket->list(dpp, params, 1000, results, y);
+    if (r < 0) {
+      ldpp_dout(dpp, 0) << "ERROR: failed to list bucket " << bucket->get_name()
+          << ": " << cpp_strerror(-r) << dendl;
+      return r;
+    }
+    params.marker = results.next_marker;
+
+    for (const auto& ent : results.objs) {
+      if (samples.size() >= max_samples) {
+        break;
+      }
+      if (ent.meta.accounted_size == 0 ||
+          ent.meta.accounted_size > max_object_size) {
+        continue;
+      }
+      auto obj = bucket->get_object(ent.key);
+      auto read_op = obj->get_read_op();
+      r = read_op->prepare(y, dpp);
+      if (r < 0) {
+        continue;
+      }
+      const auto& attrs = obj->get_attrs();
+      if (attrs.count(RGW_ATTR_CRYPT_MODE)) {
+        continue;
+      }
+      bool need_decompress = false;
+      RGWCompressionInfo cs_info;
+      r = rgw_compression_info_from_attrset(attrs, need_decompress, cs_info);
+      if (r < 0) {
+        continue;
+      }
+
+      bufferlist data;
+      SampleCollector collector{data};
+      RGWGetObj_Filter* filter = &collector;
+      boost::optional<RGWGetObj_Decompress> decompress;
+      if (need_decompress) {
+        decompress.emplace(cct, &cs_info, false, filter,
+                           rgw_compression_dict_context(cct, cs_info, bucket->get_attrs()));
+        filter = &*decompress;
+      }
+      off_t ofs = 0;
+      off_t end = ent.meta.accounted_size - 1;
+      filter->fixup_range(ofs, end);
+      r = read_op->iterate(dpp, ofs, end, filter, y);
+      if (r >= 0) {
+        r = filter->flush();
+      }
+      if (r < 0) {
+        ldpp_dout(dpp, 5) << "failed to read sample " << ent.key.name << ": "
+            << cpp_strerror(-r) << dendl;
+        continue;
+      }
+      samples.push_back(std::move(data));
+    }
+  } while (results.is_truncated && samples.size() < max_samples);
+
+  ldpp_dout(dpp, 10) << "training " << compression_type << " dictionary for bucket "
+      << bucket->get_name() << " from " << samples.size() << " objects" << dendl;
+  rgw_compression_dict dict;
+  dict.compression_type = compression_type;
+  int r = compressor->train_dictionary(samples, cct->_conf->rgw_compression_dict_size,
+                                       dict.data);
+  if (r < 0) {
+    ldpp_dout(dpp, 0) << "ERROR: failed to train " << compression_type
+        << " dictionary from " << samples.size() << " objects: "
+        << cpp_strerror(-r) << dendl;
+    return r;
+  }
+
+  RGWCompressionDictionaries dicts;
+  r = rgw_compression_dicts_from_attrset(bucket->get_attrs(), dicts);
+  if (r < 0 && r != -ENOENT) {
+    return r;
+  }
+  // ids are unique across buckets, so copies can carry them over
+  uint32_t new_id;
+  do {
+    new_id = ceph::util::generate_random_number<uint32_t>(
+        1, std::numeric_limits<uint32_t>::max());
+  } while (dicts.dicts.count(new_id));
+  dicts.dicts.emplace(new_id, std::move(dict));
+  dicts.current = new_id;
+
+  rgw::sal::Attrs attrs;
+  encode(dicts, attrs[RGW_ATTR_COMPRESSION_DICT]);
+  r = bucket->merge_and_store_attrs(dpp, attrs, y);
+  if (r < 0) {
+    ldpp_dout(dpp, 0) << "ERROR: failed to store compression dictionary in bucket "
+        << bucket->get_name() << ": " << cpp_strerror(-r) << dendl;
+    return r;
+  }
+  *id = new_id;
+  return 0;
+}
+
 //------------RGWPutObj_Compress---------------
 
 int RGWPutObj_Compress::process(bufferlist&& in, uint64_t logical_offset)
@@ -51,7 +320,8 @@ int RGWPutObj_Compress::process(bufferlist&& in, uint64_t logical_offset)
     if ((logical_offset > 0 && compressed) || // if previous part was compressed
         (logical_offset == 0)) {              // or it's the first part
       ldout(cct, 10) << "Compression for rgw is enabled, compress part " << in.length() << dendl;
-      int cr = compressor->compress(in, out, compressor_message);
+      int cr = dict_ctx ? dict_ctx->compress(in, out) :
+                          compressor->compress(in, out, compressor_message);
       if (cr < 0) {
         if (logical_offset > 0) {
           lderr(cct) << "Compression failed with exit code " << cr
@@ -91,10 +361,13 @@ int RGWPutObj_Compress::process(bufferlist&& in, uint64_t logical_offset)
 RGWGetObj_Decompress::RGWGetObj_Decompress(CephContext* cct_, 
                                            RGWCompressionInfo* cs_info_, 
                                            bool partial_content_,
-                                           RGWGetObj_Filter* next): RGWGetObj_Filter(next),
+                                           RGWGetObj_Filter* next,
+                                           Compressor::DictionaryContextRef dict_ctx_):
+                                                                RGWGetObj_Filter(next),
                                                                 cct(cct_),
                                                                 cs_info(cs_info_),
                                                                 partial_content(partial_content_),
+                                                                dict_ctx(std::move(dict_ctx_)),
                                                                 q_ofs(0),
                                                                 q_len(0),
                                                                 cur_ofs(0)
@@ -114,6 +387,10 @@ int RGWGetObj_Decompress::handle_data(bufferlist& bl, off_t bl_ofs, off_t bl_len
     lderr(cct) << "Cannot load compressor of type " << cs_info->compression_type << dendl;
     return -EIO;
   }
+  if (cs_info->dictionary_id && !dict_ctx) {
+    lderr(cct) << "Cannot find compression dictionary " << *cs_info->dictionary_id << dendl;
+    return -EIO;
+  }
   bufferlist out_bl, in_bl, temp_in_bl;
   bl.begin(bl_ofs).copy(bl_len, temp_in_bl);
   bl_ofs = 0;
@@ -145,7 +422,8 @@ int RGWGetObj_Decompress::handle_data(bufferlist& bl, off_t bl_ofs, off_t bl_len
       iter_in_bl.seek(ofs_in_bl);
     }
     iter_in_bl.copy(first_block->len, tmp);
-    int cr = compressor->decompress(tmp, out_bl, cs_info->compressor_message);
+    int cr = dict_ctx ? dict_ctx->decompress(tmp, out_bl) :
+                        compressor->decompress(tmp, out_bl, cs_info->compressor_message);
     if (cr < 0) {
       lderr(cct) << "Decompression failed with exit code " << cr << dendl;
       return cr;
@@ -232,5 +510,27 @@ void RGWCompressionInfo::dump(Formatter *f) const
     f->dump_int("compressor_message", *compressor_message);
   }
   ::encode_json("blocks", blocks, f);
+  if (dictionary_id) {
+    f->dump_unsigned("dictionary_id", *dictionary_id);
+  }
+}
+
+void rgw_compression_dict::dump(Formatter *f) const
+{
+  f->dump_string("compression_type", compression_type);
+  f->dump_unsigned("size", data.length());
+}
+
+void RGWCompressionDictionaries::dump(Formatter *f) const
+{
+  f->dump_unsigned("current", current);
+  f->open_array_section("dictionaries");
+  for (const auto& [id, dict] : dicts) {
+    f->open_object_section("dictionary");
+    f->dump_unsigned("id", id);
+    dict.dump(f);
+    f->close_section();
+  }
+  f->close_section();
 }
 
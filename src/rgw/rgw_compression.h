@@ -17,12 +17,44 @@ int rgw_compression_info_from_attrset(const std::map<std::string, bufferlist>& a
                                       bool& need_decompress,
                                       RGWCompressionInfo& cs_info);
 
+int rgw_compression_dicts_from_attrset(const std::map<std::string, bufferlist>& bucket_attrs,
+                                       RGWCompressionDictionaries& dicts);
+// the dictionary that cs_info was compressed with, or nullptr if it
+// references none or the bucket doesn't have it
+Compressor::DictionaryContextRef
+rgw_compression_dict_context(CephContext* cct,
+                             const RGWCompressionInfo& cs_info,
+                             const std::map<std::string, bufferlist>& bucket_attrs);
+// the bucket's current dictionary for compression_type, if any
+Compressor::DictionaryContextRef
+rgw_compression_current_dict(CephContext* cct,
+                             const std::map<std::string, bufferlist>& bucket_attrs,
+                             const std::string& compression_type,
+                             uint32_t& id);
+// objects are copied without recompression; make sure the destination
+// bucket holds the dictionary that the source object references
+int rgw_compression_dict_copy(const DoutPrefixProvider* dpp,
+                              const RGWCompressionInfo& cs_info,
+                              rgw::sal::Bucket* src_bucket,
+                              rgw::sal::Bucket* dest_bucket,
+                              optional_yield y);
+// train a dictionary from up to max_samples of the bucket's objects of
+// at most rgw_compression_dict_max_object_size bytes, and make it the
+// bucket's current one
+int rgw_compression_dict_train(const DoutPrefixProvider* dpp,
+                               rgw::sal::Bucket* bucket,
+                               const std::string& compression_type,
+                               uint32_t max_samples,
+                               optional_yield y,
+                               uint32_t* id);
+
 class RGWGetObj_Decompress : public RGWGetObj_Filter
 {
   CephContext* cct;
   CompressorRef compressor;
   RGWCompressionInfo* cs_info;
   bool partial_content;
+  Compressor::DictionaryContextRef dict_ctx;
   std::vector<compression_block>::iterator first_block, last_block;
   off_t q_ofs, q_len;
   uint64_t cur_ofs;
@@ -31,7 +63,8 @@ public:
   RGWGetObj_Decompress(CephContext* cct_, 
                        RGWCompressionInfo* cs_info_, 
                        bool partial_content_,
-                       RGWGetObj_Filter* next);
+                       RGWGetObj_Filter* next,
+                       Compressor::DictionaryContextRef dict_ctx_ = nullptr);
   virtual ~RGWGetObj_Decompress() override {}
 
   int handle_data(bufferlist& bl, off_t bl_ofs, off_t bl_len) override;
@@ -45,6 +78,8 @@ class RGWPutObj_Compress : public rgw::putobj::Pipe
   bool compressed{false};
   CompressorRef compressor;
   std::optional<int32_t> compressor_message;
+  Compressor::DictionaryContextRef dict_ctx;
+  std::optional<uint32_t> dictionary_id;
   std::vector<compression_block> blocks;
   uint64_t compressed_ofs{0};
 public:
@@ -59,4 +94,10 @@ public:
   std::vector<compression_block>& get_compression_blocks() { return blocks; }
   std::optional<int32_t> get_compressor_message() { return compressor_message; }
 
+  void set_dictionary(uint32_t id, Compressor::DictionaryContextRef ctx) {
+    dictionary_id = id;
+    dict_ctx = std::move(ctx);
+  }
+  std::optional<uint32_t> get_dictionary_id() { return dictionary_id; }
+
 }; /* RGWPutObj_Compress */
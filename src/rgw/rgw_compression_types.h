@@ -44,33 +44,84 @@ struct RGWCompressionInfo {
   uint64_t orig_size;
   std::optional<int32_t> compressor_message;
   std::vector<compression_block> blocks;
+  // the bucket's compression dictionary the blocks were compressed with
+  std::optional<uint32_t> dictionary_id;
 
   RGWCompressionInfo() : compression_type("none"), orig_size(0) {}
   RGWCompressionInfo(const RGWCompressionInfo& cs_info) : compression_type(cs_info.compression_type),
                                                           orig_size(cs_info.orig_size),
 							  compressor_message(cs_info.compressor_message),
-                                                          blocks(cs_info.blocks) {}
+                                                          blocks(cs_info.blocks),
+                                                          dictionary_id(cs_info.dictionary_id) {}
 
   void encode(bufferlist& bl) const {
-    ENCODE_START(2, 1, bl);
+    ENCODE_START(3, 1, bl);
     encode(compression_type, bl);
     encode(orig_size, bl);
     encode(compressor_message, bl);
     encode(blocks, bl);
+    encode(dictionary_id, bl);
     ENCODE_FINISH(bl);
   }
 
   void decode(bufferlist::const_iterator& bl) {
-     DECODE_START(2, bl);
+     DECODE_START(3, bl);
      decode(compression_type, bl);
      decode(orig_size, bl);
      if (struct_v >= 2) {
        decode(compressor_message, bl);
      }
      decode(blocks, bl);
+     if (struct_v >= 3) {
+       decode(dictionary_id, bl);
+     }
      DECODE_FINISH(bl);
   } 
   void dump(Formatter *f) const;
 };
 WRITE_CLASS_ENCODER(RGWCompressionInfo)
 
+struct rgw_compression_dict {
+  std::string compression_type;
+  bufferlist data;
+
+  void encode(bufferlist& bl) const {
+    ENCODE_START(1, 1, bl);
+    encode(compression_type, bl);
+    encode(data, bl);
+    ENCODE_FINISH(bl);
+  }
+
+  void decode(bufferlist::const_iterator& bl) {
+     DECODE_START(1, bl);
+     decode(compression_type, bl);
+     decode(data, bl);
+     DECODE_FINISH(bl);
+  }
+  void dump(Formatter *f) const;
+};
+WRITE_CLASS_ENCODER(rgw_compression_dict)
+
+// the dictionaries trained for a bucket, stored in its RGW_ATTR_COMPRESSION_DICT.
+// new small objects are compressed with 'current'; older dictionaries are kept
+// for as long as objects may still reference them
+struct RGWCompressionDictionaries {
+  uint32_t current = 0; // 0 if none
+  std::map<uint32_t, rgw_compression_dict> dicts;
+
+  void encode(bufferlist& bl) const {
+    ENCODE_START(1, 1, bl);
+    encode(current, bl);
+    encode(dicts, bl);
+    ENCODE_FINISH(bl);
+  }
+
+  void decode(bufferlist::const_iterator& bl) {
+     DECODE_START(1, bl);
+     decode(current, bl);
+     decode(dicts, bl);
+     DECODE_FINISH(bl);
+  }
+  void dump(Formatter *f) const;
+};
+WRITE_CLASS_ENCODER(RGWCompressionDictionaries)
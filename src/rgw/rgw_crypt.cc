@@ -16,6 +16,7 @@
 #include "crypto/crypto_accel.h"
 #include "crypto/crypto_plugin.h"
 #include "rgw/rgw_kms.h"
+#include "rgw/rgw_perf_counters.h"
 #include "rapidjson/document.h"
 #include "rapidjson/writer.h"
 #include "rapidjson/error/error.h"
@@ -409,6 +410,7 @@ private:
   static const uint8_t IV[AES_256_IVSIZE];
   CephContext* cct;
   uint8_t key[AES_256_KEYSIZE];
+  CryptoAccelRef crypto_accel;
 public:
   explicit AES_256_CBC(const DoutPrefixProvider* dpp, CephContext* cct): dpp(dpp), cct(cct) {
   }
@@ -437,6 +439,51 @@ public:
       dpp, cct, EVP_aes_256_cbc(), out, in, size, iv, key, encrypt);
   }
 
+  /* the openssl fallback for a run of chunks: the key is expanded once,
+   * and only the IV is reset between chunks */
+  bool cbc_transform_chunks(unsigned char* out,
+                            const unsigned char* in,
+                            const size_t size,
+                            const unsigned char (*iv)[AES_256_IVSIZE],
+                            const unsigned char (&key)[AES_256_KEYSIZE],
+                            bool encrypt)
+  {
+    using pctx_t = \
+      std::unique_ptr<EVP_CIPHER_CTX, decltype(&::EVP_CIPHER_CTX_free)>;
+    pctx_t pctx{ EVP_CIPHER_CTX_new(), EVP_CIPHER_CTX_free };
+
+    if (!pctx) {
+      return false;
+    }
+    if (1 != EVP_CipherInit_ex(pctx.get(), EVP_aes_256_cbc(), nullptr,
+                               key, nullptr, encrypt)) {
+      ldpp_dout(dpp, 5) << "EVP: failed to initialize cipher" << dendl;
+      return false;
+    }
+    if (1 != EVP_CIPHER_CTX_set_padding(pctx.get(), 0)) {
+      ldpp_dout(dpp, 5) << "EVP: cannot disable PKCS padding" << dendl;
+      return false;
+    }
+    for (size_t offset = 0; offset < size; offset += CHUNK_SIZE, ++iv) {
+      size_t process_size = std::min(CHUNK_SIZE, size - offset);
+      int written = 0;
+      int finally_written = 0;
+      if (1 != EVP_CipherInit_ex(pctx.get(), nullptr, nullptr,
+                                 nullptr, *iv, -1) ||
+          1 != EVP_CipherUpdate(pctx.get(), out + offset, &written,
+                                in + offset, process_size) ||
+          1 != EVP_CipherFinal_ex(pctx.get(), out + offset + written,
+                                  &finally_written)) {
+        ldpp_dout(dpp, 5) << "EVP: failed to transform chunk at " << offset << dendl;
+        return false;
+      }
+      if (written + finally_written != static_cast<int>(process_size)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   bool cbc_transform(unsigned char* out,
                      const unsigned char* in,
                      size_t size,
@@ -445,33 +492,32 @@ public:
                      bool encrypt)
   {
     static std::atomic<bool> failed_to_get_crypto(false);
-    CryptoAccelRef crypto_accel;
-    if (! failed_to_get_crypto.load())
+    if (!crypto_accel && !failed_to_get_crypto.load())
     {
       crypto_accel = get_crypto_accel(this->dpp, cct);
       if (!crypto_accel)
         failed_to_get_crypto = true;
     }
-    bool result = true;
-    unsigned char iv[AES_256_IVSIZE];
-    for (size_t offset = 0; result && (offset < size); offset += CHUNK_SIZE) {
-      size_t process_size = offset + CHUNK_SIZE <= size ? CHUNK_SIZE : size - offset;
-      prepare_iv(iv, stream_offset + offset);
-      if (crypto_accel != nullptr) {
-        if (encrypt) {
-          result = crypto_accel->cbc_encrypt(out + offset, in + offset,
-                                             process_size, iv, key);
-        } else {
-          result = crypto_accel->cbc_decrypt(out + offset, in + offset,
-                                             process_size, iv, key);
-        }
+    if (size == 0) {
+      return true;
+    }
+    /* every chunk is chained from its own IV, so the whole run can be
+     * handed over at once */
+    const size_t chunks = (size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    auto ivs = std::make_unique<unsigned char[][AES_256_IVSIZE]>(chunks);
+    for (size_t i = 0; i < chunks; i++) {
+      prepare_iv(ivs[i], stream_offset + i * CHUNK_SIZE);
+    }
+    if (crypto_accel != nullptr) {
+      if (encrypt) {
+        return crypto_accel->cbc_encrypt_chunks(out, in, size, CHUNK_SIZE,
+                                                ivs.get(), key);
       } else {
-        result = cbc_transform(
-            out + offset, in + offset, process_size,
-            iv, key, encrypt);
+        return crypto_accel->cbc_decrypt_chunks(out, in, size, CHUNK_SIZE,
+                                                ivs.get(), key);
       }
     }
-    return result;
+    return cbc_transform_chunks(out, in, size, ivs.get(), key, encrypt);
   }
 
 
@@ -481,6 +527,7 @@ public:
                bufferlist& output,
                off_t stream_offset)
   {
+    const auto start = ceph::mono_clock::now();
     bool result = false;
     size_t aligned_size = size / AES_256_IVSIZE * AES_256_IVSIZE;
     size_t unaligned_rest_size = size - aligned_size;
@@ -523,6 +570,10 @@ public:
       ldpp_dout(this->dpp, 25) << "Encrypted " << size << " bytes"<< dendl;
       buf.set_length(size);
       output.append(buf);
+      if (perfcounter) {
+        perfcounter->inc(l_rgw_crypt_encrypt_b, size);
+        perfcounter->tinc(l_rgw_crypt_encrypt_lat, ceph::mono_clock::now() - start);
+      }
     } else {
       ldpp_dout(this->dpp, 5) << "Failed to encrypt" << dendl;
     }
@@ -536,6 +587,7 @@ public:
                bufferlist& output,
                off_t stream_offset)
   {
+    const auto start = ceph::mono_clock::now();
     bool result = false;
     size_t aligned_size = size / AES_256_IVSIZE * AES_256_IVSIZE;
     size_t unaligned_rest_size = size - aligned_size;
@@ -578,6 +630,10 @@ public:
       ldpp_dout(this->dpp, 25) << "Decrypted " << size << " bytes"<< dendl;
       buf.set_length(size);
       output.append(buf);
+      if (perfcounter) {
+        perfcounter->inc(l_rgw_crypt_decrypt_b, size);
+        perfcounter->tinc(l_rgw_crypt_decrypt_lat, ceph::mono_clock::now() - start);
+      }
     } else {
       ldpp_dout(this->dpp, 5) << "Failed to decrypt" << dendl;
     }
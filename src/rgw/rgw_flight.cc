@@ -14,6 +14,7 @@
 #include <mutex>
 #include <map>
 #include <algorithm>
+#include <numeric>
 
 #include "arrow/type.h"
 #include "arrow/buffer.h"
@@ -202,9 +203,67 @@ arw::Status FlightServer::ListFlights(const flt::ServerCallContext& context,
 } // FlightServer::ListFlights
 
 
+// The descriptor path is { tenant, bucket [, object-name-prefix] }. Every
+// flight under that prefix becomes its own endpoint, so a client can
+// DoGet the tickets over as many parallel streams as it likes. Since a
+// FlightInfo carries a single schema, flights whose schema differs from
+// the first one found are left out.
 arw::Status FlightServer::GetFlightInfo(const flt::ServerCallContext &context,
 					const flt::FlightDescriptor &request,
 					std::unique_ptr<flt::FlightInfo> *info) {
+  if (request.type != flt::FlightDescriptor::PATH ||
+      request.path.size() < 2 || request.path.size() > 3) {
+    return arw::Status::Invalid(
+      "flight descriptor must be a path of tenant, bucket, and optional prefix");
+  }
+
+  const std::string& tenant_name = request.path[0];
+  const std::string& bucket_name = request.path[1];
+  const std::string prefix =
+    request.path.size() > 2 ? request.path[2] : std::string();
+
+  std::shared_ptr<arw::Schema> schema;
+  std::vector<flt::FlightEndpoint> endpoints;
+  int64_t total_records = 0;
+  int64_t total_bytes = 0;
+
+  FlightKey previous_key = null_flight_key;
+  while (std::optional<FlightData> fd = flight_store->after_key(previous_key)) {
+    previous_key = fd->key;
+    if (fd->tenant_name != tenant_name ||
+	fd->bucket_name != bucket_name ||
+	fd->object_key.name.compare(0, prefix.size(), prefix) != 0) {
+      continue;
+    }
+
+    if (!schema) {
+      schema = fd->schema;
+    } else if (!schema->Equals(*fd->schema)) {
+      INFO << "skipping flight " << fd->key << " for object " <<
+	fd->object_key << " as its schema differs" << dendl;
+      continue;
+    }
+
+    flt::FlightEndpoint endpoint;
+    endpoint.ticket = FlightKeyToTicket(fd->key);
+    endpoints.push_back(std::move(endpoint));
+    total_records += fd->num_records;
+    total_bytes += fd->obj_size;
+  }
+
+  if (endpoints.empty()) {
+    return arw::Status::KeyError(
+      "no flights found for tenant \"", tenant_name,
+      "\", bucket \"", bucket_name, "\", prefix \"", prefix, "\"");
+  }
+
+  INFO << "returning " << endpoints.size() << " endpoints for bucket " <<
+    bucket_name << " and prefix \"" << prefix << "\"" << dendl;
+
+  ARROW_ASSIGN_OR_RAISE(flt::FlightInfo info_obj,
+			flt::FlightInfo::Make(*schema, request, endpoints,
+					      total_records, total_bytes));
+  *info = std::make_unique<flt::FlightInfo>(std::move(info_obj));
   return arw::Status::OK();
 } // FlightServer::GetFlightInfo
 
@@ -257,6 +316,30 @@ public:
   }
 }; // class OwnedBuffer
 
+// A Buffer that keeps the bufferlist returned by a RADOS read alive, so
+// the data can be handed to arrow without copying it out first. Only a
+// fragmented bufferlist is copied, once, when it is made contiguous.
+class BufferlistBuffer : public arw::Buffer {
+
+  bufferlist bl;
+
+  BufferlistBuffer(bufferlist&& _bl) :
+    Buffer(nullptr, 0),
+    bl(std::move(_bl))
+    {
+      data_ = reinterpret_cast<const uint8_t*>(bl.c_str());
+      size_ = bl.length();
+      capacity_ = size_;
+    }
+
+public:
+
+  static std::shared_ptr<BufferlistBuffer> make(bufferlist&& bl) {
+    return std::shared_ptr<BufferlistBuffer>(
+      new BufferlistBuffer(std::move(bl)));
+  }
+}; // class BufferlistBuffer
+
 #if 0 // remove classes used for testing and incrementally building
 
 // make local to DoGet eventually
@@ -557,9 +640,9 @@ public:
     return is_closed;
   }
 
-  arw::Result<int64_t> Read(int64_t nbytes, void* out) override {
-    INFO << "entered: asking for " << nbytes << " bytes" << dendl;
-
+  // reads up to nbytes at the current position into bl and advances
+  // the position
+  arw::Result<int64_t> read_bl(int64_t nbytes, bufferlist& bl) {
     if (position < 0) {
       ERROR << "error, position indicated error" << dendl;
       return arw::Status::IOError("object read op is in bad state");
@@ -568,8 +651,6 @@ public:
     // note: read function reads through end_position inclusive
     int64_t end_position = position + nbytes - 1;
 
-    bufferlist bl;
-
     const int64_t bytes_read =
       op->read(position, end_position, bl, null_yield, &dp);
     if (bytes_read < 0) {
@@ -582,10 +663,6 @@ public:
 	bytes_read);
     }
 
-    // TODO: see if there's a way to get rid of this copy, perhaps
-    // updating rgw::sal::read_op
-    bl.cbegin().copy(bytes_read, reinterpret_cast<char*>(out));
-
     position += bytes_read;
 
     if (nbytes != bytes_read) {
@@ -596,21 +673,29 @@ public:
     return bytes_read;
   }
 
-  arw::Result<std::shared_ptr<arw::Buffer>> Read(int64_t nbytes) override {
+  arw::Result<int64_t> Read(int64_t nbytes, void* out) override {
     INFO << "entered: asking for " << nbytes << " bytes" << dendl;
 
-    std::shared_ptr<OwnedBuffer> buffer;
-    ARROW_ASSIGN_OR_RAISE(buffer, OwnedBuffer::make(nbytes));
+    bufferlist bl;
+    ARROW_ASSIGN_OR_RAISE(const int64_t bytes_read, read_bl(nbytes, bl));
 
-    ARROW_ASSIGN_OR_RAISE(const int64_t bytes_read,
-			  Read(nbytes, buffer->writeable_data()));
-    buffer->set_size(bytes_read);
+    // the caller supplied the destination, so a copy is unavoidable here
+    bl.cbegin().copy(bytes_read, reinterpret_cast<char*>(out));
+    return bytes_read;
+  }
 
-    return buffer;
+  arw::Result<std::shared_ptr<arw::Buffer>> Read(int64_t nbytes) override {
+    INFO << "entered: asking for " << nbytes << " bytes" << dendl;
+
+    bufferlist bl;
+    ARROW_ASSIGN_OR_RAISE(const int64_t bytes_read, read_bl(nbytes, bl));
+    (void) bytes_read; // silence unused variable warnings
+
+    return BufferlistBuffer::make(std::move(bl));
   }
 
   bool supports_zero_copy() const override {
-    return false;
+    return true;
   }
 
   // implement Seekable
@@ -665,6 +750,46 @@ public:
   }
 }; // class RandomAccessObject
 
+// Streams the record batches of a parquet file. The parquet batch
+// reader refers back to the file reader that created it, so the two are
+// kept together.
+class ParquetBatchReader : public arw::RecordBatchReader {
+
+  std::unique_ptr<parquet::arrow::FileReader> file_reader;
+  std::unique_ptr<arw::RecordBatchReader> batch_reader;
+
+  ParquetBatchReader(std::unique_ptr<parquet::arrow::FileReader>&& _file_reader,
+		     std::unique_ptr<arw::RecordBatchReader>&& _batch_reader) :
+    file_reader(std::move(_file_reader)),
+    batch_reader(std::move(_batch_reader))
+    { }
+
+public:
+
+  static arw::Result<std::shared_ptr<ParquetBatchReader>> make(
+    std::unique_ptr<parquet::arrow::FileReader>&& file_reader)
+  {
+    const int num_row_groups = file_reader->num_row_groups();
+    std::vector<int> row_groups(num_row_groups);
+    std::iota(row_groups.begin(), row_groups.end(), 0);
+
+    std::unique_ptr<arw::RecordBatchReader> batch_reader;
+    ARROW_RETURN_NOT_OK(
+      file_reader->GetRecordBatchReader(row_groups, &batch_reader));
+
+    return std::shared_ptr<ParquetBatchReader>(
+      new ParquetBatchReader(std::move(file_reader), std::move(batch_reader)));
+  }
+
+  std::shared_ptr<arw::Schema> schema() const override {
+    return batch_reader->schema();
+  }
+
+  arw::Status ReadNext(std::shared_ptr<arw::RecordBatch>* batch) override {
+    return batch_reader->ReadNext(batch);
+  }
+}; // class ParquetBatchReader
+
 arw::Status FlightServer::DoGet(const flt::ServerCallContext &context,
 				const flt::Ticket &request,
 				std::unique_ptr<flt::FlightDataStream> *stream) {
@@ -705,18 +830,12 @@ arw::Status FlightServer::DoGet(const flt::ServerCallContext &context,
 					       arw::default_memory_pool(),
 					       &reader));
 
-  std::shared_ptr<arrow::Table> table;
-  ARROW_RETURN_NOT_OK(reader->ReadTable(&table));
-
-  std::vector<std::shared_ptr<arw::RecordBatch>> batches;
-  arw::TableBatchReader batch_reader(*table);
-  ARROW_RETURN_NOT_OK(batch_reader.ReadAll(&batches));
-
-  ARROW_ASSIGN_OR_RAISE(auto owning_reader,
-			arw::RecordBatchReader::Make(
-			  std::move(batches), table->schema()));
+  // decode one row group at a time as the stream is consumed rather
+  // than materializing the whole table before the first batch is sent
+  ARROW_ASSIGN_OR_RAISE(auto batch_reader,
+			ParquetBatchReader::make(std::move(reader)));
   *stream = std::unique_ptr<flt::FlightDataStream>(
-    new flt::RecordBatchStream(owning_reader));
+    new flt::RecordBatchStream(batch_reader));
 
   return arw::Status::OK();
 } // flightServer::DoGet
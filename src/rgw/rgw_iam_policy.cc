@@ -1103,6 +1103,14 @@ Effect Statement::eval(const Environment& e,
 		       boost::optional<const rgw::auth::Identity&> ida,
 		       uint64_t act, boost::optional<const ARN&> res, boost::optional<PolicyPrincipal&> princ_type) const {
 
+  const bool act_matches = (action[act] == 1) && !(notaction[act] == 1);
+  // the action test is a bit lookup, so try it before any pattern
+  // matching. eval_principal() still has to run when the caller wants
+  // the principal type back.
+  if (!act_matches && !princ_type) {
+    return Effect::Pass;
+  }
+
   if (eval_principal(e, ida, princ_type) == Effect::Deny) {
     return Effect::Pass;
   }
@@ -1129,7 +1137,7 @@ Effect Statement::eval(const Environment& e,
     }
   }
 
-  if (!(action[act] == 1) || (notaction[act] == 1)) {
+  if (!act_matches) {
     return Effect::Pass;
   }
 
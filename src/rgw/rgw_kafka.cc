@@ -73,6 +73,8 @@ struct connection_t {
   const boost::optional<std::string> ca_location;
   const std::string user;
   const std::string password;
+  const boost::optional<unsigned> linger_ms;
+  const boost::optional<unsigned> batch_size;
   utime_t timestamp = ceph_clock_now();
 
   // cleanup of all internal connection resource
@@ -107,8 +109,10 @@ struct connection_t {
   // ctor for setting immutable values
   connection_t(CephContext* _cct, const std::string& _broker, bool _use_ssl, bool _verify_ssl, 
           const boost::optional<const std::string&>& _ca_location,
-          const std::string& _user, const std::string& _password) :
-      cct(_cct), broker(_broker), use_ssl(_use_ssl), verify_ssl(_verify_ssl), ca_location(_ca_location), user(_user), password(_password) {}
+          const std::string& _user, const std::string& _password,
+          boost::optional<unsigned> _linger_ms, boost::optional<unsigned> _batch_size) :
+      cct(_cct), broker(_broker), use_ssl(_use_ssl), verify_ssl(_verify_ssl), ca_location(_ca_location), user(_user), password(_password),
+      linger_ms(_linger_ms), batch_size(_batch_size) {}
 
   // dtor also destroys the internals
   ~connection_t() {
@@ -124,6 +128,8 @@ std::string to_string(const connection_ptr_t& conn) {
     str += "\nBroker: " + conn->broker; 
     str += conn->use_ssl ? "\nUse SSL" : ""; 
     str += conn->ca_location ? "\nCA Location: " + *(conn->ca_location) : "";
+    str += conn->linger_ms ? "\nLinger: " + std::to_string(*conn->linger_ms) + "ms" : "";
+    str += conn->batch_size ? "\nBatch Size: " + std::to_string(*conn->batch_size) : "";
     return str;
 }
 // these are required interfaces so that connection_t could be used inside boost::intrusive_ptr
@@ -216,6 +222,14 @@ connection_ptr_t& create_connection(connection_ptr_t& conn) {
   // get list of brokers based on the bootsrap broker
   if (rd_kafka_conf_set(conn->temp_conf, "bootstrap.servers", conn->broker.c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) goto conf_error;
 
+  // let the producer collect messages into larger requests
+  if (conn->linger_ms) {
+    if (rd_kafka_conf_set(conn->temp_conf, "linger.ms", std::to_string(*conn->linger_ms).c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) goto conf_error;
+  }
+  if (conn->batch_size) {
+    if (rd_kafka_conf_set(conn->temp_conf, "batch.size", std::to_string(*conn->batch_size).c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK) goto conf_error;
+  }
+
   if (conn->use_ssl) {
     if (!conn->user.empty()) {
       // use SSL+SASL
@@ -286,9 +300,12 @@ connection_ptr_t create_new_connection(const std::string& broker, CephContext* c
         bool verify_ssl,
         boost::optional<const std::string&> ca_location, 
         const std::string& user, 
-        const std::string& password) { 
+        const std::string& password,
+        boost::optional<unsigned> linger_ms,
+        boost::optional<unsigned> batch_size) { 
   // create connection state
-  connection_ptr_t conn(new connection_t(cct, broker, use_ssl, verify_ssl, ca_location, user, password));
+  connection_ptr_t conn(new connection_t(cct, broker, use_ssl, verify_ssl, ca_location, user, password,
+        linger_ms, batch_size));
   return create_connection(conn);
 }
 
@@ -529,7 +546,9 @@ public:
   connection_ptr_t connect(const std::string& url, 
           bool use_ssl,
           bool verify_ssl,
-          boost::optional<const std::string&> ca_location) {
+          boost::optional<const std::string&> ca_location,
+          boost::optional<unsigned> linger_ms,
+          boost::optional<unsigned> batch_size) {
     if (stopped) {
       // TODO: increment counter
       ldout(cct, 1) << "Kafka connect: manager is stopped" << dendl;
@@ -553,8 +572,16 @@ public:
       return nullptr;
 	}
 
+    // producer batching settings apply to the whole connection, so topics
+    // that ask for different settings get separate connections
+    std::string conn_key = broker;
+    if (linger_ms || batch_size) {
+      conn_key += "?linger.ms=" + (linger_ms ? std::to_string(*linger_ms) : "") +
+        "&batch.size=" + (batch_size ? std::to_string(*batch_size) : "");
+    }
+
     std::lock_guard lock(connections_lock);
-    const auto it = connections.find(broker);
+    const auto it = connections.find(conn_key);
     // note that ssl vs. non-ssl connection to the same host are two separate conenctions
     if (it != connections.end()) {
       // connection found - return even if non-ok
@@ -568,14 +595,15 @@ public:
       ldout(cct, 1) << "Kafka connect: max connections exceeded" << dendl;
       return nullptr;
     }
-    const auto conn = create_new_connection(broker, cct, use_ssl, verify_ssl, ca_location, user, password);
+    const auto conn = create_new_connection(broker, cct, use_ssl, verify_ssl, ca_location, user, password,
+        linger_ms, batch_size);
     // create_new_connection must always return a connection object
     // even if error occurred during creation. 
     // in such a case the creation will be retried in the main thread
     ceph_assert(conn);
     ++connection_count;
     ldout(cct, 10) << "Kafka connect: new connection is created. Total connections: " << connection_count << dendl;
-    return connections.emplace(broker, conn).first->second;
+    return connections.emplace(conn_key, conn).first->second;
   }
 
   // TODO publish with confirm is needed in "none" case as well, cb should be invoked publish is ok (no ack)
@@ -671,9 +699,11 @@ void shutdown() {
 }
 
 connection_ptr_t connect(const std::string& url, bool use_ssl, bool verify_ssl,
-        boost::optional<const std::string&> ca_location) {
+        boost::optional<const std::string&> ca_location,
+        boost::optional<unsigned> linger_ms,
+        boost::optional<unsigned> batch_size) {
   if (!s_manager) return nullptr;
-  return s_manager->connect(url, use_ssl, verify_ssl, ca_location);
+  return s_manager->connect(url, use_ssl, verify_ssl, ca_location, linger_ms, batch_size);
 }
 
 int publish(connection_ptr_t& conn, 
@@ -31,7 +31,11 @@ bool init(CephContext* cct);
 void shutdown();
 
 // connect to a kafka endpoint
-connection_ptr_t connect(const std::string& url, bool use_ssl, bool verify_ssl, boost::optional<const std::string&> ca_location);
+// linger_ms and batch_size set the producer's "linger.ms" and "batch.size"
+// when given; otherwise the librdkafka defaults are used
+connection_ptr_t connect(const std::string& url, bool use_ssl, bool verify_ssl, boost::optional<const std::string&> ca_location,
+    boost::optional<unsigned> linger_ms = boost::none,
+    boost::optional<unsigned> batch_size = boost::none);
 
 // publish a message over a connection that was already created
 int publish(connection_ptr_t& conn,
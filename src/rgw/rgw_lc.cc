@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <tuple>
 #include <functional>
+#include <thread>
 
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string.hpp>
@@ -383,6 +384,10 @@ public:
     list_params.prefix = prefix;
   }
 
+  void set_shard(int shard_id) {
+    list_params.shard_id = shard_id;
+  }
+
   int init(const DoutPrefixProvider *dpp) {
     return fetch(dpp);
   }
@@ -763,7 +768,7 @@ class RGWLC::WorkPool
 {
   using TVector = ceph::containers::tiny_vector<WorkQ, 3>;
   TVector wqs;
-  uint64_t ix;
+  std::atomic<uint64_t> ix;
 
 public:
   WorkPool(RGWLC::LCWorker* wk, uint16_t n_threads, uint32_t qmax)
@@ -787,9 +792,9 @@ public:
     }
   }
 
+  // may be called from several listers of the same bucket at once
   void enqueue(WorkItem item) {
-    const auto tix = ix;
-    ix = (ix+1) % wqs.size();
+    const auto tix = ix++ % wqs.size();
     (wqs[tix]).enqueue(std::move(item));
   }
 
@@ -1626,39 +1631,91 @@ int RGWLC::bucket_lc_process(string& shard_id, LCWorker* worker,
       pre_marker = next_marker;
     }
 
-    LCObjsLister ol(driver, bucket.get());
-    ol.set_prefix(prefix_iter->first);
-
     if (! zone_check(op, zone)) {
       ldpp_dout(this, 7) << "LC rule not executable in " << zone->get_tier_type()
 			 << " zone, skipping" << dendl;
       continue;
     }
 
-    ret = ol.init(this);
-    if (ret < 0) {
-      if (ret == (-ENOENT))
-        return 0;
-      ldpp_dout(this, 0) << "ERROR: driver->list_objects():" << dendl;
-      return ret;
-    }
+    /* list the objects under this prefix on one index shard (or on all
+     * of them, one after another, for RGW_NO_SHARD) and feed them to
+     * the workpool; returns 1 if the interval budget ran out */
+    auto list_and_enqueue = [&](int shard_id) -> int {
+      LCObjsLister ol(driver, bucket.get());
+      ol.set_prefix(prefix_iter->first);
+      ol.set_shard(shard_id);
 
-    op_env oenv(op, driver, worker, bucket.get(), ol);
-    LCOpRule orule(oenv);
-    orule.build(); // why can't ctor do it?
-    rgw_bucket_dir_entry* o{nullptr};
-    for (auto offset = 0; ol.get_obj(this, &o /* , fetch_barrier */); ++offset, ol.next()) {
-      orule.update();
-      std::tuple<LCOpRule, rgw_bucket_dir_entry> t1 = {orule, *o};
-      worker->workpool->enqueue(WorkItem{t1});
-      if ((offset % 100) == 0) {
-	if (worker_should_stop(stop_at, once)) {
-	  ldpp_dout(this, 5) << __func__ << " interval budget EXPIRED worker "
-			     << worker->ix
-			     << dendl;
+      int r = ol.init(this);
+      if (r < 0) {
+	if (r == (-ENOENT))
 	  return 0;
+	ldpp_dout(this, 0) << "ERROR: driver->list_objects():" << dendl;
+	return r;
+      }
+
+      op_env oenv(op, driver, worker, bucket.get(), ol);
+      LCOpRule orule(oenv);
+      orule.build(); // why can't ctor do it?
+      rgw_bucket_dir_entry* o{nullptr};
+      for (auto offset = 0; ol.get_obj(this, &o /* , fetch_barrier */); ++offset, ol.next()) {
+	orule.update();
+	std::tuple<LCOpRule, rgw_bucket_dir_entry> t1 = {orule, *o};
+	worker->workpool->enqueue(WorkItem{t1});
+	if ((offset % 100) == 0) {
+	  if (worker_should_stop(stop_at, once)) {
+	    ldpp_dout(this, 5) << __func__ << " interval budget EXPIRED worker "
+			       << worker->ix
+			       << dendl;
+	    return 1;
+	  }
 	}
       }
+      return 0;
+    };
+
+    /* all versions of an object live on the same index shard, so shards
+     * can be listed independently; split them among a few listers */
+    const int num_shards =
+      bucket->get_info().layout.current_index.layout.normal.num_shards;
+    const int listers = std::min<int>(
+      num_shards, cct->_conf.get_val<uint64_t>("rgw_lc_max_shard_listers"));
+    if (listers <= 1) {
+      ret = list_and_enqueue(RGW_NO_SHARD);
+    } else {
+      ldpp_dout(this, 20) << __func__ << "(): listing " << num_shards
+			  << " index shards with " << listers << " listers"
+			  << dendl;
+      std::vector<int> results(listers, 0);
+      std::vector<std::thread> threads;
+      threads.reserve(listers);
+      for (int l = 0; l < listers; ++l) {
+	threads.emplace_back([&, l] {
+	  for (int shard = l; shard < num_shards; shard += listers) {
+	    int r = list_and_enqueue(shard);
+	    if (r != 0) {
+	      results[l] = r;
+	      return;
+	    }
+	  }
+	});
+      }
+      for (auto& t : threads) {
+	t.join();
+      }
+      ret = 0;
+      for (int r : results) {
+	if (r < 0) {
+	  ret = r;
+	  break;
+	} else if (r > 0) {
+	  ret = r;
+	}
+      }
+    }
+    if (ret < 0) {
+      return ret;
+    } else if (ret > 0) {
+      return 0;
     }
     worker->workpool->drain();
   }
@@ -112,6 +112,19 @@ class UsageLogger : public DoutPrefixProvider {
     }
   };
 
+  class C_UsageLogFlush : public Context {
+    UsageLogger *logger;
+  public:
+    explicit C_UsageLogFlush(UsageLogger *_l) : logger(_l) {}
+    void finish(int r) override {
+      logger->flush_pending = false;
+      logger->flush();
+    }
+  };
+
+  /* protected by timer_lock */
+  bool flush_pending = false;
+
   void set_timer() {
     timer.add_event_after(cct->_conf->rgw_usage_log_tick_interval, new C_UsageLogTimeout(this));
   }
@@ -151,8 +164,13 @@ public:
     bool need_flush = (num_entries > cct->_conf->rgw_usage_log_flush_threshold);
     lock.unlock();
     if (need_flush) {
+      /* hand the flush to the timer thread instead of holding up the
+         request that crossed the threshold */
       std::lock_guard l{timer_lock};
-      flush();
+      if (!flush_pending) {
+        flush_pending = true;
+        timer.add_event_after(0.0, new C_UsageLogFlush(this));
+      }
     }
   }
 
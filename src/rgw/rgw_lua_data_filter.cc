@@ -112,7 +112,7 @@ int RGWObjFilter::execute(bufferlist& bl, off_t offset, const char* op_name) con
 
   try {
     // execute the lua script
-    if (luaL_dostring(L, script.c_str()) != LUA_OK) {
+    if (dostring(L, script) != LUA_OK) {
       const std::string err(lua_tostring(L, -1));
       ldpp_dout(s, 1) << "Lua ERROR: " << err << dendl;
       return -EINVAL;
@@ -884,9 +884,10 @@ int execute(
   }
 
   int rc = 0;
+  const auto start = ceph::mono_clock::now();
   try {
     // execute the lua script
-    if (luaL_dostring(L, script.c_str()) != LUA_OK) {
+    if (rgw::lua::dostring(L, script) != LUA_OK) {
       const std::string err(lua_tostring(L, -1));
       ldpp_dout(s, 1) << "Lua ERROR: " << err << dendl;
       rc = -1;
@@ -896,7 +897,12 @@ int execute(
     rc = -1;
   }
   if (perfcounter) {
+    const auto elapsed = ceph::mono_clock::now() - start;
     perfcounter->inc((rc == -1 ? l_rgw_lua_script_fail : l_rgw_lua_script_ok), 1);
+    perfcounter->tinc(l_rgw_lua_script_lat, elapsed);
+    perfcounter->hinc(l_rgw_lua_script_lat_hist,
+                      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                      script.size());
   }
 
   return rc;
@@ -1,7 +1,9 @@
+#include <memory>
 #include <string>
 #include <lua.hpp>
 #include "common/ceph_context.h"
 #include "common/dout.h"
+#include "common/lru_map.h"
 #include "rgw_lua_utils.h"
 #include "rgw_lua_version.h"
 
@@ -73,5 +75,36 @@ void open_standard_libs(lua_State* L) {
   lua_settable(L, -3);
 }
 
+constexpr auto SCRIPT_CACHE_SIZE = 64;
+
+static int bytecode_writer(lua_State* L, const void* p, size_t sz, void* ud) {
+  reinterpret_cast<std::string*>(ud)->append(reinterpret_cast<const char*>(p), sz);
+  return 0;
+}
+
+int dostring(lua_State* L, const std::string& script) {
+  static lru_map<std::string, std::shared_ptr<const std::string>> cache(SCRIPT_CACHE_SIZE);
+
+  std::shared_ptr<const std::string> bytecode;
+  int rc;
+  if (cache.find(script, bytecode)) {
+    rc = luaL_loadbufferx(L, bytecode->data(), bytecode->size(), "=script", "b");
+  } else {
+    rc = luaL_loadstring(L, script.c_str());
+    if (rc == LUA_OK) {
+      // debug info is kept, so errors still point into the script text
+      auto dumped = std::make_shared<std::string>();
+      if (lua_dump(L, bytecode_writer, dumped.get(), 0) == 0) {
+        bytecode = std::move(dumped);
+        cache.add(script, bytecode);
+      }
+    }
+  }
+  if (rc != LUA_OK) {
+    return rc;
+  }
+  return lua_pcall(L, 0, LUA_MULTRET, 0);
+}
+
 } // namespace rgw::lua
 
@@ -214,6 +214,10 @@ void set_package_path(lua_State* L, const std::string& install_dir);
 // and the "debug" library
 void open_standard_libs(lua_State* L);
 
+// same as luaL_dostring(), but the script is compiled only on first use
+// and its bytecode is kept, keyed by the script text, for later calls
+int dostring(lua_State* L, const std::string& script);
+
 typedef int MetaTableClosure(lua_State* L);
 
 template<typename MapType=std::map<std::string, std::string>>
@@ -17,6 +17,7 @@
 #include "common/Clock.h"
 #include "common/armor.h"
 #include "common/errno.h"
+#include "common/lru_map.h"
 #include "common/mime.h"
 #include "common/utf8.h"
 #include "common/ceph_json.h"
@@ -294,12 +295,42 @@ static int get_obj_policy_from_attr(const DoutPrefixProvider *dpp,
 }
 
 
+/*
+ * stored bucket policies are parsed on every request. the parsed form
+ * depends only on the tenant and the policy text, so it is cached under
+ * those; a changed policy has different text and simply misses
+ */
+static std::shared_ptr<const Policy> get_cached_iam_policy(CephContext* cct,
+							   const string& tenant,
+							   const bufferlist& text) {
+  static const auto size =
+    cct->_conf.get_val<uint64_t>("rgw_iam_policy_cache_size");
+  if (size == 0) {
+    return std::make_shared<const Policy>(cct, tenant, text, false);
+  }
+  static lru_map<std::string, std::shared_ptr<const Policy>> cache(size);
+
+  std::string key;
+  key.reserve(tenant.size() + 1 + text.length());
+  key.append(tenant);
+  key.push_back('\0');
+  key.append(text.to_str());
+
+  std::shared_ptr<const Policy> policy;
+  if (!cache.find(key, policy)) {
+    // parse errors throw, and are never cached
+    policy = std::make_shared<const Policy>(cct, tenant, text, false);
+    cache.add(key, policy);
+  }
+  return policy;
+}
+
 static boost::optional<Policy> get_iam_policy_from_attr(CephContext* cct,
 							map<string, bufferlist>& attrs,
 							const string& tenant) {
   auto i = attrs.find(RGW_ATTR_IAM_POLICY);
   if (i != attrs.end()) {
-    return Policy(cct, tenant, i->second, false);
+    return *get_cached_iam_policy(cct, tenant, i->second);
   } else {
     return none;
   }
@@ -1614,7 +1645,8 @@ int RGWGetObj::read_user_manifest_part(rgw::sal::Bucket* bucket,
           << ", actual read size=" << ent.meta.size << dendl;
       return -EIO;
     }
-    decompress.emplace(s->cct, &cs_info, partial_content, filter);
+    decompress.emplace(s->cct, &cs_info, partial_content, filter,
+                       rgw_compression_dict_context(s->cct, cs_info, bucket->get_attrs()));
     filter = &*decompress;
   }
   else
@@ -2256,7 +2288,8 @@ void RGWGetObj::execute(optional_yield y)
   if (need_decompress) {
       s->obj_size = cs_info.orig_size;
       s->object->set_obj_size(cs_info.orig_size);
-      decompress.emplace(s->cct, &cs_info, partial_content, filter);
+      decompress.emplace(s->cct, &cs_info, partial_content, filter,
+                         rgw_compression_dict_context(s->cct, cs_info, s->bucket->get_attrs()));
       filter = &*decompress;
   }
 
@@ -3839,7 +3872,14 @@ int RGWPutObj::get_data(const off_t fst, const off_t lst, bufferlist& bl)
   if (need_decompress)
   {
     obj_size = cs_info.orig_size;
-    decompress.emplace(s->cct, &cs_info, partial_content, filter);
+    if (cs_info.dictionary_id) {
+      // the dictionary is in the bucket's attrs, which bucket info alone lacks
+      ret = bucket->load_bucket(this, s->yield);
+      if (ret < 0)
+        return ret;
+    }
+    decompress.emplace(s->cct, &cs_info, partial_content, filter,
+                       rgw_compression_dict_context(s->cct, cs_info, bucket->get_attrs()));
     filter = &*decompress;
   }
 
@@ -4122,6 +4162,17 @@ void RGWPutObj::execute(optional_yield y)
         filter = &*compressor;
         // always send incompressible hint when rgw is itself doing compression
         s->object->set_compressed();
+        // small whole objects use the bucket's trained dictionary
+        if (!multipart && s->content_length >= 0 &&
+            static_cast<uint64_t>(s->content_length) <=
+              s->cct->_conf->rgw_compression_dict_max_object_size) {
+          uint32_t dict_id = 0;
+          auto dict_ctx = rgw_compression_current_dict(
+              s->cct, s->bucket->get_attrs(), plugin->get_type_name(), dict_id);
+          if (dict_ctx) {
+            compressor->set_dictionary(dict_id, std::move(dict_ctx));
+          }
+        }
       }
     }
     // run lua script before data is compressed and encrypted - last filter runs first
@@ -4210,12 +4261,14 @@ void RGWPutObj::execute(optional_yield y)
     cs_info.orig_size = s->obj_size;
     cs_info.compressor_message = compressor->get_compressor_message();
     cs_info.blocks = move(compressor->get_compression_blocks());
+    cs_info.dictionary_id = compressor->get_dictionary_id();
     encode(cs_info, tmp);
     attrs[RGW_ATTR_COMPRESSION] = tmp;
     ldpp_dout(this, 20) << "storing " << RGW_ATTR_COMPRESSION
         << " with type=" << cs_info.compression_type
         << ", orig_size=" << cs_info.orig_size
-        << ", blocks=" << cs_info.blocks.size() << dendl;
+        << ", blocks=" << cs_info.blocks.size()
+        << ", dictionary=" << cs_info.dictionary_id.value_or(0) << dendl;
   }
 
   buf_to_hex(m, CEPH_CRYPTO_MD5_DIGESTSIZE, calc_md5);
@@ -5537,6 +5590,21 @@ void RGWCopyObj::execute(optional_yield y)
     }
 
     obj_size = astate->size;
+
+    // the data is copied as it is; a dictionary it was compressed with
+    // must be found in the destination bucket too
+    if (astate->get_attr(RGW_ATTR_COMPRESSION, bl)) {
+      RGWCompressionInfo cs_info;
+      bool compressed = false;
+      if (rgw_compression_info_from_attr(bl, compressed, cs_info) == 0 &&
+          compressed) {
+        op_ret = rgw_compression_dict_copy(this, cs_info, src_bucket.get(),
+                                           dest_bucket.get(), y);
+        if (op_ret < 0) {
+          return;
+        }
+      }
+    }
   
     if (!s->system_request) { // no quota enforcement for system requests
       if (astate->accounted_size > static_cast<size_t>(s->cct->_conf->rgw_max_put_size)) {
@@ -11,6 +11,23 @@ int rgw_perf_start(CephContext *cct)
 {
   PerfCountersBuilder plb(cct, "rgw", l_rgw_first, l_rgw_last);
 
+  // Latency axis configuration for the lua script histogram, in nanoseconds
+  PerfHistogramCommon::axis_config_d lua_lat_axis_config{
+    "Latency (nsec)",
+    PerfHistogramCommon::SCALE_LOG2, ///< Latency in logarithmic scale
+    0,                               ///< Start at 0
+    1000,                            ///< Quantization unit is 1usec
+    16,                              ///< Ranges into the tens of mS
+  };
+  // Script size axis configuration for the lua script histogram, in bytes
+  PerfHistogramCommon::axis_config_d lua_size_axis_config{
+    "Script size (bytes)",
+    PerfHistogramCommon::SCALE_LOG2, ///< Script size in logarithmic scale
+    0,                               ///< Start at 0
+    256,                             ///< Quantization unit is 256 bytes
+    8,                               ///< Scripts up to >16k
+  };
+
   // RGW emits comparatively few metrics, so let's be generous
   // and mark them all USEFUL to get transmission to ceph-mgr by default.
   plb.set_prio_default(PerfCountersBuilder::PRIO_USEFUL);
@@ -20,21 +37,32 @@ int rgw_perf_start(CephContext *cct)
 
   plb.add_u64_counter(l_rgw_get, "get", "Gets");
   plb.add_u64_counter(l_rgw_get_b, "get_b", "Size of gets");
-  plb.add_time_avg(l_rgw_get_lat, "get_initial_lat", "Get latency");
+  plb.add_time_avg_hist(l_rgw_get_lat, "get_initial_lat", "Get latency");
   plb.add_u64_counter(l_rgw_put, "put", "Puts");
   plb.add_u64_counter(l_rgw_put_b, "put_b", "Size of puts");
-  plb.add_time_avg(l_rgw_put_lat, "put_initial_lat", "Put latency");
+  plb.add_time_avg_hist(l_rgw_put_lat, "put_initial_lat", "Put latency");
 
   plb.add_u64(l_rgw_qlen, "qlen", "Queue length");
   plb.add_u64(l_rgw_qactive, "qactive", "Active requests queue");
 
   plb.add_u64_counter(l_rgw_cache_hit, "cache_hit", "Cache hits");
   plb.add_u64_counter(l_rgw_cache_miss, "cache_miss", "Cache miss");
+  plb.add_time_avg(l_rgw_cache_lock_wait, "cache_lock_wait", "Time spent waiting for a metadata cache shard lock");
+  plb.add_u64_counter(l_rgw_cache_stale_hit, "cache_stale_hit", "Expired metadata cache entries served while being refreshed");
 
   plb.add_u64_counter(l_rgw_keystone_token_cache_hit, "keystone_token_cache_hit", "Keystone token cache hits");
   plb.add_u64_counter(l_rgw_keystone_token_cache_miss, "keystone_token_cache_miss", "Keystone token cache miss");
 
+  plb.add_u64_counter(l_rgw_d3n_cache_hit, "d3n_cache_hit", "D3N datacache hits");
+  plb.add_u64_counter(l_rgw_d3n_cache_miss, "d3n_cache_miss", "D3N datacache misses");
+  plb.add_u64_counter(l_rgw_d3n_cache_hit_bytes, "d3n_cache_hit_bytes", "Bytes served from the D3N datacache instead of RADOS",
+		      NULL, 0, unit_t(UNIT_BYTES));
+  plb.add_u64_counter(l_rgw_d3n_cache_admit_reject, "d3n_cache_admit_reject", "D3N datacache writes skipped by the admission filter");
+
   plb.add_u64_counter(l_rgw_gc_retire, "gc_retire_object", "GC object retires");
+  plb.add_u64_counter(l_rgw_gc_tail_remove, "gc_tail_remove", "GC tail objects removed");
+  plb.add_time_avg(l_rgw_gc_entry_age, "gc_entry_age", "GC time between entry expiry and processing");
+  plb.add_u64(l_rgw_gc_max_aio, "gc_max_concurrent_io", "GC concurrent IO limit");
 
   plb.add_u64_counter(l_rgw_lc_expire_current, "lc_expire_current",
 		      "Lifecycle current expiration");
@@ -62,7 +90,19 @@ int rgw_perf_start(CephContext *cct)
   
   plb.add_u64_counter(l_rgw_lua_script_ok, "lua_script_ok", "Successfull executions of lua scripts");
   plb.add_u64_counter(l_rgw_lua_script_fail, "lua_script_fail", "Failed executions of lua scripts");
+  plb.add_time_avg(l_rgw_lua_script_lat, "lua_script_lat", "Latency of request lua scripts");
+  plb.add_u64_counter_histogram(
+    l_rgw_lua_script_lat_hist, "lua_script_lat_size_histogram",
+    lua_lat_axis_config, lua_size_axis_config,
+    "Histogram of request lua script latency (nanoseconds) vs. script size");
   plb.add_u64(l_rgw_lua_current_vms, "lua_current_vms", "Number of Lua VMs currently being executed");
+
+  plb.add_u64_counter(l_rgw_crypt_encrypt_b, "crypt_encrypt_b", "Bytes encrypted for server-side encryption",
+		      NULL, 0, unit_t(UNIT_BYTES));
+  plb.add_time_avg(l_rgw_crypt_encrypt_lat, "crypt_encrypt_lat", "Server-side encryption latency per buffer");
+  plb.add_u64_counter(l_rgw_crypt_decrypt_b, "crypt_decrypt_b", "Bytes decrypted for server-side encryption",
+		      NULL, 0, unit_t(UNIT_BYTES));
+  plb.add_time_avg(l_rgw_crypt_decrypt_lat, "crypt_decrypt_lat", "Server-side decryption latency per buffer");
   
   perfcounter = plb.create_perf_counters();
   cct->get_perfcounters_collection()->add(perfcounter);
@@ -28,11 +28,21 @@ enum {
 
   l_rgw_cache_hit,
   l_rgw_cache_miss,
+  l_rgw_cache_lock_wait,
+  l_rgw_cache_stale_hit,
 
   l_rgw_keystone_token_cache_hit,
   l_rgw_keystone_token_cache_miss,
 
+  l_rgw_d3n_cache_hit,
+  l_rgw_d3n_cache_miss,
+  l_rgw_d3n_cache_hit_bytes,
+  l_rgw_d3n_cache_admit_reject,
+
   l_rgw_gc_retire,
+  l_rgw_gc_tail_remove,
+  l_rgw_gc_entry_age,
+  l_rgw_gc_max_aio,
 
   l_rgw_lc_expire_current,
   l_rgw_lc_expire_noncurrent,
@@ -54,6 +64,13 @@ enum {
   l_rgw_lua_current_vms,
   l_rgw_lua_script_ok,
   l_rgw_lua_script_fail,
+  l_rgw_lua_script_lat,
+  l_rgw_lua_script_lat_hist,
+
+  l_rgw_crypt_encrypt_b,
+  l_rgw_crypt_encrypt_lat,
+  l_rgw_crypt_decrypt_b,
+  l_rgw_crypt_decrypt_lat,
 
   l_rgw_last,
 };
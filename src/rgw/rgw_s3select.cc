@@ -261,6 +261,7 @@ void aws_response_handler::send_stats_response()
 RGWSelectObj_ObjStore_S3::RGWSelectObj_ObjStore_S3():
   m_buff_header(std::make_unique<char[]>(1000)),
   m_parquet_type(false),
+  m_read_ahead_ofs(0),
   chunk_number(0)
 {
   set_get_data(true);
@@ -539,16 +540,41 @@ int RGWSelectObj_ObjStore_S3::range_request(int64_t ofs, int64_t len, void* buff
 {
   //purpose: implementation for arrow::ReadAt, this may take several async calls.
   //send_response_date(call_back) accumulate buffer, upon completion control is back to ReadAt.
-  range_req_str = "bytes=" + std::to_string(ofs) + "-" + std::to_string(ofs+len-1);
+  if (ofs >= m_read_ahead_ofs &&
+      ofs + len <= m_read_ahead_ofs + static_cast<int64_t>(m_read_ahead_buffer.size())) {
+    ldout(s->cct, 20) << "S3select: range-request served from read-ahead buffer, offset: " << ofs << " length: " << len << dendl;
+    memcpy(buff, m_read_ahead_buffer.data() + (ofs - m_read_ahead_ofs), len);
+    return len;
+  }
+  //small reads (footer, page headers, small column chunks) fetch a larger range,
+  //so the reads following them do not each cost a round trip to RADOS
+  const int64_t read_ahead = s->cct->_conf->rgw_s3select_parquet_read_ahead;
+  const int64_t obj_size = static_cast<int64_t>(s->obj_size);
+  int64_t fetch_len = len;
+  if (len < read_ahead && ofs + len < obj_size) {
+    fetch_len = std::min(read_ahead, obj_size - ofs);
+  }
+  range_req_str = "bytes=" + std::to_string(ofs) + "-" + std::to_string(ofs+fetch_len-1);
   range_str = range_req_str.c_str();
   range_parsed = false;
   RGWGetObj::parse_range();
   requested_buffer.clear();
-  m_request_range = len;
-  ldout(s->cct, 10) << "S3select: calling execute(async):" << " request-offset :" << ofs << " request-length :" << len << " buffer size : " << requested_buffer.size() << dendl;
+  m_request_range = fetch_len;
+  ldout(s->cct, 10) << "S3select: calling execute(async):" << " request-offset :" << ofs << " request-length :" << len << " fetch-length :" << fetch_len << dendl;
   RGWGetObj::execute(y);
+  if (requested_buffer.size() < static_cast<size_t>(len)) {
+    //a short read, reported as such to the reader
+    ldout(s->cct, 10) << "S3select: range-request returned " << requested_buffer.size() << " bytes out of " << len << dendl;
+    len = requested_buffer.size();
+    fetch_len = len;
+  }
   memcpy(buff, requested_buffer.data(), len);
   ldout(s->cct, 10) << "S3select: done waiting, buffer is complete buffer-size:" << requested_buffer.size() << dendl;
+  if (fetch_len > len) {
+    m_read_ahead_ofs = ofs;
+    m_read_ahead_buffer.swap(requested_buffer);
+  }
+  requested_buffer.clear();
   return len;
 }
 
@@ -598,18 +624,11 @@ int RGWSelectObj_ObjStore_S3::parquet_processing(bufferlist& bl, off_t ofs, off_
       end_header(s, this, "application/xml", CHUNKED_TRANSFER_ENCODING);
     }
     chunk_number++;
-    size_t append_in_callback = 0;
-    int part_no = 1;
-    //concat the requested buffer
-    for (auto& it : bl.buffers()) {
-      if(it.length() == 0) {
-        ldout(s->cct, 10) << "S3select: get zero-buffer while appending request-buffer " << dendl;
-      }
-      append_in_callback += it.length();
-      ldout(s->cct, 10) << "S3select: part " << part_no++ << " it.length() = " << it.length() << dendl;
-      requested_buffer.append(&(it)[0]+ofs, len);
+    //concat the requested buffer; [ofs, ofs+len) may span several segments of bl
+    if (len > 0) {
+      bl.cbegin(ofs).copy(len, requested_buffer);
     }
-    ldout(s->cct, 10) << "S3select:append_in_callback = " << append_in_callback << dendl;
+    ldout(s->cct, 10) << "S3select:append_in_callback = " << len << " segments: " << bl.get_num_buffers() << dendl;
     if (requested_buffer.size() < m_request_range) {
       ldout(s->cct, 10) << "S3select: need another round buffe-size: " << requested_buffer.size() << " request range length:" << m_request_range << dendl;
       return 0;
@@ -194,6 +194,9 @@ private:
   //a request for range may statisfy by several calls to send_response_date;
   size_t m_request_range;
   std::string requested_buffer;
+  //the last range read ahead of a small request, serves the reads that follow it
+  int64_t m_read_ahead_ofs;
+  std::string m_read_ahead_buffer;
   std::string range_req_str;
   std::function<int(std::string&)> fp_result_header_format;
   std::function<int(std::string&)> fp_s3select_result_format;
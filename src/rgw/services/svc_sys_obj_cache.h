@@ -6,6 +6,7 @@
 #include "common/RWLock.h"
 #include "rgw_service.h"
 #include "rgw_cache.h"
+#include "rgw_perf_counters.h"
 
 #include "svc_sys_obj_core.h"
 
@@ -147,9 +148,16 @@ template <class T>
 class RGWChainedCacheImpl : public RGWChainedCache {
   RGWSI_SysObj_Cache *svc{nullptr};
   ceph::timespan expiry;
+  ceph::timespan stale;
   RWLock lock;
 
-  std::unordered_map<std::string, std::pair<T, ceph::coarse_mono_time>> entries;
+  struct CacheEntry {
+    T data;
+    ceph::coarse_mono_time added;
+    // set once a caller has been sent to refresh an expired entry
+    std::atomic<bool> refreshing{false};
+  };
+  std::unordered_map<std::string, CacheEntry> entries;
 
 public:
   RGWChainedCacheImpl() : lock("RGWChainedCacheImpl::lock") {}
@@ -172,6 +180,8 @@ public:
     svc->register_chained_cache(this);
     expiry = std::chrono::seconds(svc->ctx()->_conf.get_val<uint64_t>(
 				    "rgw_cache_expiry_interval"));
+    stale = std::chrono::seconds(svc->ctx()->_conf.get_val<uint64_t>(
+				    "rgw_cache_stale_interval"));
   }
 
   boost::optional<T> find(const std::string& key) {
@@ -180,12 +190,23 @@ public:
     if (iter == entries.end()) {
       return boost::none;
     }
-    if (expiry.count() &&
-	(ceph::coarse_mono_clock::now() - iter->second.second) > expiry) {
-      return boost::none;
+    if (expiry.count()) {
+      auto age = ceph::coarse_mono_clock::now() - iter->second.added;
+      if (age > expiry) {
+        /* stale-while-revalidate: the first caller misses and re-reads
+         * the entry, the others keep using the expired copy until it
+         * has been put back */
+        if (age > expiry + stale ||
+            !iter->second.refreshing.exchange(true)) {
+          return boost::none;
+        }
+        if (perfcounter) {
+          perfcounter->inc(l_rgw_cache_stale_hit);
+        }
+      }
     }
 
-    return iter->second.first;
+    return iter->second.data;
   }
 
   bool put(const DoutPrefixProvider *dpp, RGWSI_SysObj_Cache *svc, const std::string& key, T *entry,
@@ -203,10 +224,12 @@ public:
   void chain_cb(const std::string& key, void *data) override {
     T *entry = static_cast<T *>(data);
     std::unique_lock wl{lock};
-    entries[key].first = *entry;
+    auto& e = entries[key];
+    e.data = *entry;
     if (expiry.count() > 0) {
-      entries[key].second = ceph::coarse_mono_clock::now();
+      e.added = ceph::coarse_mono_clock::now();
     }
+    e.refreshing = false;
   }
 
   void invalidate(const std::string& key) override {
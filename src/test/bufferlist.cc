@@ -3018,6 +3018,72 @@ TEST(BufferList, TestIsProvidedBuffer) {
   ASSERT_FALSE(bl.is_provided_buffer(buff));
 }
 
+// Build and tear down bufferlists shaped like small MOSDOp/MOSDOpReply
+// messages (front encoded field by field, several small segments, a
+// shared data payload) and report the ptr_node heap allocations per
+// message once the per-thread node cache is warm.
+TEST(BufferList, PtrNodeAllocsPerMessage) {
+  auto data = buffer::create(4096);
+  data.zero();
+  auto build_op = [&data] {
+    bufferlist front, middle, payload;
+    encode(uint64_t(42), front);              // tid
+    encode(std::string("rbd_data.1234.0000000000000001"), front);
+    for (int i = 0; i < 4; ++i) {             // ops
+      bufferlist op;
+      encode(uint16_t(i), op);
+      encode(uint64_t(i * 4096), op);
+      front.claim_append(op);
+    }
+    payload.push_back(data);
+    bufferlist msg;
+    msg.claim_append(front);
+    msg.claim_append(middle);
+    msg.claim_append(payload);
+    return msg;
+  };
+  auto build_reply = [] {
+    bufferlist front;
+    encode(uint64_t(42), front);
+    encode(int32_t(0), front);
+    bufferlist outdata;
+    outdata.append("ok", 2);
+    front.claim_append(outdata);
+    return front;
+  };
+  auto decode_msg = [](bufferlist& msg) {
+    bufferlist front;
+    front.substr_of(msg, 0, msg.length() / 2);
+    bufferlist rest;
+    msg.splice(0, msg.length() / 2, &rest);
+    return front.length() + rest.length();
+  };
+
+  auto run = [&decode_msg](const char* name, auto build) {
+    // warm the cache
+    for (int i = 0; i < 16; ++i) {
+      auto msg = build();
+      decode_msg(msg);
+    }
+    constexpr int count = 10000;
+    const auto heap_before = buffer::get_ptr_node_heap_allocs();
+    const auto cached_before = buffer::get_ptr_node_cached_allocs();
+    for (int i = 0; i < count; ++i) {
+      auto msg = build();
+      decode_msg(msg);
+    }
+    const double heap = buffer::get_ptr_node_heap_allocs() - heap_before;
+    const double cached = buffer::get_ptr_node_cached_allocs() - cached_before;
+    std::cout << name << ": " << heap / count << " heap and "
+	      << cached / count << " cached ptr_node allocs per message"
+	      << std::endl;
+    EXPECT_EQ(0.0, heap);
+    EXPECT_LT(0.0, cached);
+  };
+  run("osd_op", build_op);
+  run("osd_op_reply", build_reply);
+}
+
 TEST(BufferList, DISABLED_DanglingLastP) {
   bufferlist bl;
   {
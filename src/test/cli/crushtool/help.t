@@ -95,6 +95,7 @@
         [--min-rep n] [--max-rep n] [--num-rep n]
         [--pool-id n]      specifies pool id
         [--batches b]      split the CRUSH mapping into b > 1 rounds
+        [--threads n]      map the inputs on n threads
         [--weight|-w devno weight]
                            where weight is 0 to 1.0
         [--simulate]       simulate placements using a random
@@ -103,6 +104,9 @@
      --show-utilization    show OSD usage
      --show-utilization-all
                            include zero weight items
+     --show-utilization-histogram
+                           show how many OSDs hold each fraction
+                           of their expected usage
      --show-statistics     show chi squared statistics
      --show-mappings       show mappings
      --show-bad-mappings   show bad mappings
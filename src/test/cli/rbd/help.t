@@ -173,24 +173,34 @@
                    [--io-size <io-size>] [--io-threads <io-threads>] 
                    [--io-total <io-total>] [--io-pattern <io-pattern>] 
                    [--rw-mix-read <rw-mix-read>] --io-type <io-type> 
+                   [--encryption-format <encryption-format>] 
+                   [--encryption-passphrase-file <encryption-passphrase-file>] 
                    <image-spec> 
   
   Simple benchmark.
   
   Positional arguments
-    <image-spec>         image specification
-                         (example: [<pool-name>/[<namespace>/]]<image-name>)
+    <image-spec>                     image specification
+                                     (example:
+                                     [<pool-name>/[<namespace>/]]<image-name>)
   
   Optional arguments
-    -p [ --pool ] arg    pool name
-    --namespace arg      namespace name
-    --image arg          image name
-    --io-size arg        IO size (in B/K/M/G) (< 4G) [default: 4K]
-    --io-threads arg     ios in flight [default: 16]
-    --io-total arg       total size for IO (in B/K/M/G/T) [default: 1G]
-    --io-pattern arg     IO pattern (rand, seq, or full-seq) [default: seq]
-    --rw-mix-read arg    read proportion in readwrite (<= 100) [default: 50]
-    --io-type arg        IO type (read, write, or readwrite(rw))
+    -p [ --pool ] arg                pool name
+    --namespace arg                  namespace name
+    --image arg                      image name
+    --io-size arg                    IO size (in B/K/M/G) (< 4G) [default: 4K]
+    --io-threads arg                 ios in flight [default: 16]
+    --io-total arg                   total size for IO (in B/K/M/G/T) [default:
+                                     1G]
+    --io-pattern arg                 IO pattern (rand, seq, or full-seq)
+                                     [default: seq]
+    --rw-mix-read arg                read proportion in readwrite (<= 100)
+                                     [default: 50]
+    --io-type arg                    IO type (read, write, or readwrite(rw))
+    --encryption-format arg          encryption format (luks, luks1, luks2)
+                                     [default: luks]
+    --encryption-passphrase-file arg path to file containing passphrase for
+                                     unlocking the image
   
   rbd help children
   usage: rbd children [--pool <pool>] [--namespace <namespace>] 
@@ -412,3 +412,59 @@ TEST(ClsNumOps, Div) {
 
   ASSERT_EQ(0, destroy_one_pool_pp(pool_name, cluster));
 }
+
+TEST(ClsNumOps, Many) {
+  Rados cluster;
+  std::string pool_name = get_temp_pool_name();
+  ASSERT_EQ("", create_one_pool_pp(pool_name, cluster));
+  IoCtx ioctx;
+  cluster.ioctx_create(pool_name.c_str(), ioctx);
+
+  // add to many keys, some of which do not exist yet
+
+  std::map<std::string, bufferlist> omap;
+  omap["key-0"].append("1.5");
+  ASSERT_EQ(0, ioctx.omap_set("myobject", omap));
+
+  std::map<std::string, double> values;
+  std::set<std::string> keys;
+  for (int i = 0; i < 1000; ++i) {
+    std::string key = "key-" + std::to_string(i);
+    values[key] = i;
+    keys.insert(key);
+  }
+
+  ASSERT_EQ(0, rados::cls::numops::add(&ioctx, "myobject", values));
+
+  omap.clear();
+  ASSERT_EQ(0, ioctx.omap_get_vals_by_keys("myobject", keys, &omap));
+  ASSERT_EQ(1000u, omap.size());
+  EXPECT_EQ("1.5", omap["key-0"].to_str());
+  EXPECT_EQ("999", omap["key-999"].to_str());
+
+  // multiply a subset
+
+  std::map<std::string, double> factors = {{"key-0", 2}, {"key-10", 0.5}};
+  ASSERT_EQ(0, rados::cls::numops::mul(&ioctx, "myobject", factors));
+
+  omap.clear();
+  ASSERT_EQ(0, ioctx.omap_get_vals_by_keys("myobject", keys, &omap));
+  EXPECT_EQ("3", omap["key-0"].to_str());
+  EXPECT_EQ("5", omap["key-10"].to_str());
+  EXPECT_EQ("11", omap["key-11"].to_str());
+
+  // a non-numeric stored value fails the whole batch
+
+  omap.clear();
+  omap["key-5"].append("some-non-numeric-text");
+  ASSERT_EQ(0, ioctx.omap_set("myobject", omap));
+
+  std::map<std::string, double> increments = {{"key-4", 1}, {"key-5", 1}};
+  ASSERT_EQ(-EBADMSG, rados::cls::numops::add(&ioctx, "myobject", increments));
+
+  omap.clear();
+  ASSERT_EQ(0, ioctx.omap_get_vals_by_keys("myobject", keys, &omap));
+  EXPECT_EQ("4", omap["key-4"].to_str());
+
+  ASSERT_EQ(0, destroy_one_pool_pp(pool_name, cluster));
+}
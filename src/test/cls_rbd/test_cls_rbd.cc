@@ -1413,6 +1413,58 @@ TEST_F(TestClsRbd, object_map_snap_add)
   ASSERT_EQ(ref_bit_vector, osd_bit_vector);
 }
 
+TEST_F(TestClsRbd, object_map_snap_add_large)
+{
+  librados::IoCtx ioctx;
+  ASSERT_EQ(0, _rados.ioctx_create(_pool_name.c_str(), ioctx));
+
+  // spans several CRC blocks, only some of which change
+  string oid = get_temp_image_name();
+  BitVector<2> ref_bit_vector;
+  ref_bit_vector.resize(100000);
+  for (uint64_t i = 0; i < ref_bit_vector.size(); ++i) {
+    ref_bit_vector[i] = OBJECT_EXISTS_CLEAN;
+  }
+
+  librados::ObjectWriteOperation op1;
+  object_map_resize(&op1, ref_bit_vector.size(), OBJECT_EXISTS_CLEAN);
+  ASSERT_EQ(0, ioctx.operate(oid, &op1));
+
+  librados::ObjectWriteOperation op2;
+  object_map_update(&op2, 20000, 20010, OBJECT_EXISTS,
+                    boost::optional<uint8_t>());
+  ASSERT_EQ(0, ioctx.operate(oid, &op2));
+
+  librados::ObjectWriteOperation op3;
+  object_map_update(&op3, 99990, 100000, OBJECT_EXISTS,
+                    boost::optional<uint8_t>());
+  ASSERT_EQ(0, ioctx.operate(oid, &op3));
+
+  librados::ObjectWriteOperation op4;
+  object_map_snap_add(&op4);
+  ASSERT_EQ(0, ioctx.operate(oid, &op4));
+
+  BitVector<2> osd_bit_vector;
+  ASSERT_EQ(0, object_map_load(&ioctx, oid, &osd_bit_vector));
+  ASSERT_EQ(ref_bit_vector, osd_bit_vector);
+
+  BitVector<2> snap_bit_vector;
+  snap_bit_vector.resize(ref_bit_vector.size());
+  for (uint64_t i = 0; i < snap_bit_vector.size(); ++i) {
+    snap_bit_vector[i] = (i % 7 == 0 ? OBJECT_EXISTS : OBJECT_NONEXISTENT);
+    if (i % 7 == 0) {
+      ref_bit_vector[i] = OBJECT_EXISTS;
+    }
+  }
+
+  librados::ObjectWriteOperation op5;
+  object_map_snap_remove(&op5, snap_bit_vector);
+  ASSERT_EQ(0, ioctx.operate(oid, &op5));
+
+  ASSERT_EQ(0, object_map_load(&ioctx, oid, &osd_bit_vector));
+  ASSERT_EQ(ref_bit_vector, osd_bit_vector);
+}
+
 TEST_F(TestClsRbd, object_map_snap_remove)
 {
   librados::IoCtx ioctx;
@@ -130,3 +130,49 @@ TEST(Readahead, alignment) {
   ASSERT_RA(1400, 300, r.update(1290, 10, Readahead::NO_LIMIT)); // internal readahead size 320
   ASSERT_RA(0, 0, r.update(1300, 10, Readahead::NO_LIMIT));
 }
+
+TEST(Readahead, multiple_streams) {
+  Readahead r;
+  r.set_trigger_requests(2);
+  r.set_max_streams(2);
+  ASSERT_RA(0, 0, r.update(1000, 10, Readahead::NO_LIMIT));
+  ASSERT_RA(0, 0, r.update(5000, 10, Readahead::NO_LIMIT));
+  ASSERT_RA(0, 0, r.update(1010, 10, Readahead::NO_LIMIT));
+  ASSERT_RA(0, 0, r.update(5010, 10, Readahead::NO_LIMIT));
+  ASSERT_RA(1030, 20, r.update(1020, 10, Readahead::NO_LIMIT));
+  ASSERT_RA(5030, 20, r.update(5020, 10, Readahead::NO_LIMIT));
+  ASSERT_RA(1050, 40, r.update(1030, 10, Readahead::NO_LIMIT));
+  ASSERT_RA(5050, 40, r.update(5030, 10, Readahead::NO_LIMIT));
+}
+
+TEST(Readahead, stride) {
+  Readahead r;
+  r.set_trigger_requests(2);
+  r.set_stride_detection(true);
+  ASSERT_RA(0, 0, r.update(1000, 10, Readahead::NO_LIMIT));
+  ASSERT_RA(0, 0, r.update(1015, 10, Readahead::NO_LIMIT));
+  ASSERT_RA(1040, 20, r.update(1030, 10, Readahead::NO_LIMIT));
+  ASSERT_RA(1060, 40, r.update(1045, 10, Readahead::NO_LIMIT));
+
+  // gaps larger than the reads are not treated as a stride
+  ASSERT_RA(0, 0, r.update(2000, 10, Readahead::NO_LIMIT));
+  ASSERT_RA(0, 0, r.update(2100, 10, Readahead::NO_LIMIT));
+  ASSERT_RA(0, 0, r.update(2200, 10, Readahead::NO_LIMIT));
+  ASSERT_RA(0, 0, r.update(2300, 10, Readahead::NO_LIMIT));
+}
+
+TEST(Readahead, adaptive_max_size) {
+  Readahead r;
+  r.set_trigger_requests(2);
+  r.set_max_readahead_size(20);
+  r.set_adaptive_max_readahead_size(80);
+  ASSERT_RA(0, 0, r.update(1000, 10, Readahead::NO_LIMIT));
+  ASSERT_RA(0, 0, r.update(1010, 10, Readahead::NO_LIMIT));
+  ASSERT_RA(1030, 20, r.update(1020, 10, Readahead::NO_LIMIT));
+  ASSERT_RA(1050, 20, r.update(1030, 10, Readahead::NO_LIMIT));
+  ASSERT_RA(0, 0, r.update(1040, 10, Readahead::NO_LIMIT));
+  ASSERT_RA(1070, 40, r.update(1050, 10, Readahead::NO_LIMIT));
+  ASSERT_RA(0, 0, r.update(1060, 10, Readahead::NO_LIMIT));
+  ASSERT_RA(0, 0, r.update(1070, 10, Readahead::NO_LIMIT));
+  ASSERT_RA(1110, 80, r.update(1080, 10, Readahead::NO_LIMIT));
+}
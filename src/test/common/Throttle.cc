@@ -27,6 +27,7 @@
 #include <mutex>
 #include <random>
 #include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "common/Thread.h"
@@ -165,6 +166,36 @@ TEST_F(ThrottleTest, get_or_fail) {
   }
 }
 
+TEST_F(ThrottleTest, get_put_concurrent) {
+  // most gets and puts take the lock-free path; make sure waiters are
+  // still woken up and nobody gets more than max
+  int64_t throttle_max = 4;
+  Throttle throttle(g_ceph_context, "throttle", throttle_max);
+  std::atomic<bool> exceeded = false;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; i++) {
+    threads.emplace_back([&throttle, &exceeded, throttle_max, i] {
+      for (int j = 0; j < 10000; j++) {
+	int64_t c = (i + j) % 3 + 1;
+	if (j % 2) {
+	  throttle.get(c);
+	} else if (!throttle.get_or_fail(c)) {
+	  continue;
+	}
+	if (throttle.get_current() > throttle_max) {
+	  exceeded = true;
+	}
+	throttle.put(c);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_FALSE(exceeded);
+  ASSERT_EQ(throttle.get_current(), 0);
+}
+
 TEST_F(ThrottleTest, wait) {
   int64_t throttle_max = 10;
   Throttle throttle(g_ceph_context, "throttle");
@@ -321,3 +321,72 @@ TEST(BloomFilter, Assignement) {
   ASSERT_EQ(2U, bf1.element_count());
   ASSERT_EQ(1U, bf2.element_count());
 }
+
+TEST(BlockedBloomFilter, Empty) {
+  blocked_bloom_filter bf;
+  for (int i=0; i<100; ++i) {
+    ASSERT_FALSE(bf.contains((uint32_t) i));
+    ASSERT_FALSE(bf.contains(stringify(i)));
+  }
+}
+
+TEST(BlockedBloomFilter, SweepInt) {
+  unsigned int seed = 0;
+  std::cout.setf(std::ios_base::fixed, std::ios_base::floatfield);
+  std::cout.precision(5);
+  std::cout << "# max\tfpp\tactual\tsize\tB/insert\tdensity\tapprox_element_count" << std::endl;
+  for (int ex = 3; ex < 12; ex += 2) {
+    for (float fpp = .001; fpp < .5; fpp *= 4.0) {
+      int max = 2 << ex;
+      blocked_bloom_filter bf(max, fpp, 1);
+      bf.insert("foo");
+      bf.insert("bar");
+
+      srand(seed++);
+      for (int n = 0; n < max; n++)
+	bf.insert((uint32_t) rand());
+
+      ASSERT_TRUE(bf.contains("foo"));
+      ASSERT_TRUE(bf.contains("bar"));
+
+      int test = max * 100;
+      int hit = 0;
+      for (int n = 0; n < test; n++)
+	if (bf.contains((uint32_t) rand()))
+	  hit++;
+
+      double actual = (double)hit / (double)test;
+
+      bufferlist bl;
+      encode(bf, bl);
+
+      double byte_per_insert = (double)bl.length() / (double)max;
+
+      std::cout << max << "\t" << fpp << "\t" << actual << "\t" << bl.length() << "\t" << byte_per_insert
+		<< "\t" << bf.density() << "\t" << bf.approx_unique_element_count() << std::endl;
+      ASSERT_TRUE(actual < fpp * 3);
+
+      blocked_bloom_filter copy;
+      auto p = bl.cbegin();
+      decode(copy, p);
+      ASSERT_EQ(bf.element_count(), copy.element_count());
+      ASSERT_TRUE(copy.contains("foo"));
+      ASSERT_TRUE(copy.contains("bar"));
+      ASSERT_EQ(bf.density(), copy.density());
+    }
+  }
+}
+
+TEST(BlockedBloomFilter, Assignment) {
+  blocked_bloom_filter bf1(10, .1, 1), bf2;
+
+  bf1.insert("foo");
+  bf2 = bf1;
+  bf1.insert("bar");
+
+  ASSERT_TRUE(bf2.contains("foo"));
+  ASSERT_FALSE(bf2.contains("bar"));
+
+  ASSERT_EQ(2U, bf1.element_count());
+  ASSERT_EQ(1U, bf2.element_count());
+}
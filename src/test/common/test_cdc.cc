@@ -109,6 +109,24 @@ TEST_P(CDCTest, specific_result)
   ASSERT_EQ(chunks, expected[GetParam()]);
 }
 
+TEST_P(CDCTest, fragmented)
+{
+  // generate_buffer() assembles the data from many small segments; the
+  // cut points must not depend on where those segment boundaries fall
+  bufferlist bl;
+  generate_buffer(4*1024*1024, &bl, 7);
+  ASSERT_GT(bl.get_num_buffers(), 1u);
+  bufferptr bp(bl.length());
+  bl.cbegin().copy(bl.length(), bp.c_str());
+  bufferlist flat;
+  flat.append(std::move(bp));
+  ASSERT_EQ(flat.get_num_buffers(), 1u);
+  vector<pair<uint64_t,uint64_t>> a, b;
+  cdc->calc_chunks(bl, &a);
+  cdc->calc_chunks(flat, &b);
+  ASSERT_EQ(a, b);
+}
+
 
 void do_size_histogram(CDC& cdc, bufferlist& bl,
 		       map<int,int> *h)
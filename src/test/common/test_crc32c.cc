@@ -14,6 +14,8 @@
 #include "common/sctp_crc32.h"
 #include "common/crc32c_intel_baseline.h"
 #include "common/crc32c_aarch64.h"
+#include "common/crc32c_intel_avx512.h"
+#include "arch/intel.h"
 
 TEST(Crc32c, Small) {
   const char *a = "foo bar baz";
@@ -84,6 +86,18 @@ TEST(Crc32c, Performance) {
     std::cout << "intel baseline = " << rate << " MB/sec" << std::endl;
     ASSERT_EQ(261108528u, val);
   }
+#if defined(__x86_64__)
+  if (ceph_arch_intel_avx512 && ceph_arch_intel_vpclmul &&
+      ceph_crc32c_intel_avx512_exists())
+  {
+    utime_t start = ceph_clock_now();
+    unsigned val = ceph_crc32c_intel_avx512(0, (unsigned char *)a, len);
+    utime_t end = ceph_clock_now();
+    float rate = (float)len / (float)(1024*1024) / (float)(end - start);
+    std::cout << "intel avx512 = " << rate << " MB/sec" << std::endl;
+    ASSERT_EQ(261108528u, val);
+  }
+#endif
 #if defined(__arm__) || defined(__aarch64__)
   if (ceph_arch_aarch64_crc32) // Skip if CRC32C instructions are not defined.
   {
@@ -363,3 +377,42 @@ TEST(Crc32c, zeros_performance) {
 
 }
 
+#if defined(__x86_64__)
+TEST(Crc32c, AVX512Lengths) {
+  if (!(ceph_arch_intel_avx512 && ceph_arch_intel_vpclmul &&
+	ceph_crc32c_intel_avx512_exists())) {
+    GTEST_SKIP() << "no avx512/vpclmulqdq";
+  }
+  std::vector<unsigned char> buf(4096 + 64);
+  for (size_t i = 0; i < buf.size(); ++i) {
+    buf[i] = (i * 7919) & 0xff;
+  }
+  // cover every tail length around the 64/256 byte folding boundaries,
+  // at unaligned start offsets
+  for (unsigned len = 0; len <= 4096; len += (len < 1100 ? 1 : 61)) {
+    for (unsigned off = 0; off < 3; ++off) {
+      ASSERT_EQ(ceph_crc32c_sctp(len * 31, &buf[off], len),
+		ceph_crc32c_intel_avx512(len * 31, &buf[off], len))
+	<< "len " << len << " off " << off;
+    }
+  }
+}
+#endif
+
+TEST(Crc32c, Multi) {
+  const unsigned len = 4096, n = 9;
+  std::vector<unsigned char> buf(len * n);
+  for (size_t i = 0; i < buf.size(); ++i) {
+    buf[i] = (i * 131) & 0xff;
+  }
+  const unsigned char *data[n];
+  uint32_t crcs[n];
+  for (unsigned i = 0; i < n; ++i) {
+    data[i] = &buf[i * len];
+    crcs[i] = i;
+  }
+  ceph_crc32c_multi(crcs, data, len, n);
+  for (unsigned i = 0; i < n; ++i) {
+    ASSERT_EQ(ceph_crc32c(i, data[i], len), crcs[i]);
+  }
+}
@@ -245,3 +245,57 @@ TEST(PerfHistogram, AxisAddressing) {
     }
   }
 }
+
+TEST(PerfHdrHistogram, Buckets) {
+  // Values below 2^SUB_BUCKET_BITS get a bucket each
+  for (uint64_t v = 0; v < 8; ++v) {
+    ASSERT_EQ(v, PerfHdrHistogram::get_bucket(v));
+    ASSERT_EQ(v, PerfHdrHistogram::get_bucket_max(v));
+  }
+
+  // Every value lands in a bucket whose bounds contain it, and the
+  // bucket width stays within 1/8 of the value
+  for (uint64_t v : {8ull, 9ull, 15ull, 16ull, 17ull, 1000ull, 123456789ull,
+                     (1ull << 39) + 12345}) {
+    unsigned b = PerfHdrHistogram::get_bucket(v);
+    ASSERT_LT(b, PerfHdrHistogram::NUM_BUCKETS - 1);
+    ASSERT_LE(v, PerfHdrHistogram::get_bucket_max(b));
+    ASSERT_GT(v, PerfHdrHistogram::get_bucket_max(b - 1));
+    ASSERT_LE(PerfHdrHistogram::get_bucket_max(b) -
+              PerfHdrHistogram::get_bucket_max(b - 1), v / 8 + 1);
+  }
+
+  // Anything too large goes to the overflow bucket
+  ASSERT_EQ(PerfHdrHistogram::NUM_BUCKETS - 1,
+            PerfHdrHistogram::get_bucket(1ull << 40));
+  ASSERT_EQ(PerfHdrHistogram::NUM_BUCKETS - 1,
+            PerfHdrHistogram::get_bucket(UINT64_MAX));
+}
+
+TEST(PerfHdrHistogram, Quantiles) {
+  PerfHdrHistogram h;
+  ASSERT_EQ(0u, h.get_quantile(0.99));
+
+  for (uint64_t v = 1; v <= 1000; ++v) {
+    h.inc(v * 1000);
+  }
+  ASSERT_EQ(1000u, h.get_count());
+
+  uint64_t p50 = h.get_quantile(0.5);
+  ASSERT_GE(p50, 500000u);
+  ASSERT_LE(p50, 500000u + 500000u / 8);
+  uint64_t p99 = h.get_quantile(0.99);
+  ASSERT_GE(p99, 990000u);
+  ASSERT_LE(p99, 990000u + 990000u / 8);
+
+  PerfHdrHistogram other(h);
+  other.merge(h);
+  ASSERT_EQ(2000u, other.get_count());
+  ASSERT_EQ(p99, other.get_quantile(0.99));
+  ASSERT_EQ(h.get_nonempty_buckets().size(),
+            other.get_nonempty_buckets().size());
+
+  h.reset();
+  ASSERT_EQ(0u, h.get_count());
+  ASSERT_TRUE(h.get_nonempty_buckets().empty());
+}
@@ -371,6 +371,95 @@ TEST_P(CompressorTest, decompress_16384)
 }
 
 
+TEST_P(CompressorTest, stream_round_trip)
+{
+  const size_t window = 64 << 10;
+  auto tx = compressor->create_stream_context(window);
+  auto rx = compressor->create_stream_context(window);
+  if (!tx) {
+    GTEST_SKIP() << plugin << " has no streaming mode";
+  }
+  ASSERT_TRUE(rx);
+
+  // small, nearly identical frames with the occasional large one, so that
+  // history slides past the window a few times
+  size_t oneshot_len = 0, stream_len = 0;
+  for (unsigned i = 0; i < 500; ++i) {
+    bufferlist orig;
+    if (i % 100 == 99) {
+      while (orig.length() < 300000) {
+	orig.append(std::to_string(orig.length() * 7919));
+      }
+    } else {
+      orig.append("pg 1." + std::to_string(i % 32) +
+		  " active+clean num_objects=" + std::to_string(1000 + i) +
+		  " num_bytes=4194304 log_size=3000 ondisk_log_size=3000");
+    }
+    bufferlist streamed;
+    ASSERT_EQ(0, tx->compress(orig, streamed));
+    bufferlist decompressed;
+    ASSERT_EQ(0, rx->decompress(streamed, decompressed));
+    ASSERT_TRUE(decompressed.contents_equal(orig)) << "frame " << i;
+
+    if (orig.length() < 1000) {
+      bufferlist oneshot;
+      std::optional<int32_t> compressor_message;
+      ASSERT_EQ(0, compressor->compress(orig, oneshot, compressor_message));
+      oneshot_len += oneshot.length();
+      stream_len += streamed.length();
+    }
+  }
+  cout << "small frames: one-shot " << oneshot_len << " streamed "
+       << stream_len << " with " << GetParam() << std::endl;
+  EXPECT_LT(stream_len, oneshot_len / 2);
+}
+
+TEST_P(CompressorTest, dictionary_round_trip)
+{
+  // small json documents sharing their keys, like bucket listings or logs
+  auto make_doc = [] (unsigned i) {
+    bufferlist bl;
+    bl.append("{\"bucket\":\"logs-" + std::to_string(i % 7) +
+	      "\",\"key\":\"2023/02/21/host" + std::to_string(i % 13) +
+	      "/access.log\",\"size\":" + std::to_string(1000 + i * 37) +
+	      ",\"storage_class\":\"STANDARD\",\"owner\":\"user" +
+	      std::to_string(i % 5) + "\",\"status\":200}");
+    return bl;
+  };
+  std::vector<bufferlist> samples;
+  for (unsigned i = 0; i < 1000; ++i) {
+    samples.push_back(make_doc(i));
+  }
+  bufferlist dict;
+  int r = compressor->train_dictionary(samples, 16 << 10, dict);
+  if (r == -EOPNOTSUPP) {
+    GTEST_SKIP() << plugin << " has no dictionary mode";
+  }
+  ASSERT_EQ(0, r);
+  ASSERT_GT(dict.length(), 0u);
+  auto ctx = compressor->create_dictionary_context(dict);
+  ASSERT_TRUE(ctx);
+
+  size_t plain_len = 0, dict_len = 0;
+  for (unsigned i = 1000; i < 1100; ++i) {
+    bufferlist orig = make_doc(i);
+    bufferlist compressed;
+    ASSERT_EQ(0, ctx->compress(orig, compressed));
+    bufferlist decompressed;
+    ASSERT_EQ(0, ctx->decompress(compressed, decompressed));
+    ASSERT_TRUE(decompressed.contents_equal(orig)) << "doc " << i;
+
+    bufferlist plain;
+    std::optional<int32_t> compressor_message;
+    ASSERT_EQ(0, compressor->compress(orig, plain, compressor_message));
+    plain_len += plain.length();
+    dict_len += compressed.length();
+  }
+  cout << "small docs: plain " << plain_len << " with dictionary "
+       << dict_len << " with " << GetParam() << std::endl;
+  EXPECT_LT(dict_len, plain_len / 2);
+}
+
 INSTANTIATE_TEST_SUITE_P(
   Compressor,
   CompressorTest,
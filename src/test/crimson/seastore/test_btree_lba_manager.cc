@@ -664,6 +664,51 @@ TEST_F(btree_lba_manager_test, force_split_merge)
   });
 }
 
+TEST_F(btree_lba_manager_test, get_mappings_list)
+{
+  run_async([this] {
+    {
+      auto t = create_transaction();
+      for (unsigned i = 0; i < 400; ++i) {
+	alloc_mapping(t, 0, block_size, get_paddr());
+      }
+      submit_test_transaction(std::move(t));
+    }
+
+    // every other mapping, handed over in reverse order, some of the
+    // ranges ending in the middle of the next mapping
+    auto t = create_transaction();
+    laddr_list_t list;
+    std::vector<laddr_t> expected;
+    unsigned i = 0;
+    for (auto &[laddr, ext] : t.mappings) {
+      if (i++ % 2 == 0) {
+	auto len = ext.len;
+	if (i % 3 == 0) {
+	  len += block_size / 2;
+	}
+	list.emplace_front(laddr, len);
+	expected.push_back(laddr);
+	if (len > ext.len && t.mappings.count(laddr + ext.len)) {
+	  expected.push_back(laddr + ext.len);
+	}
+      }
+    }
+    auto ret_list = with_trans_intr(
+      *t.t,
+      [&list, this](auto &t) {
+	return lba_manager->get_mappings(t, std::move(list));
+      }).unsafe_get0();
+    EXPECT_EQ(ret_list.size(), expected.size());
+    auto exp = expected.begin();
+    for (auto &pin : ret_list) {
+      ASSERT_NE(exp, expected.end());
+      EXPECT_EQ(*exp++, pin->get_key());
+      EXPECT_EQ(t.mappings.at(pin->get_key()).addr, pin->get_val());
+    }
+  });
+}
+
 TEST_F(btree_lba_manager_test, single_transaction_split_merge)
 {
   run_async([this] {
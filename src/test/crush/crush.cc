@@ -658,3 +658,60 @@ TEST_F(CRUSHTest, straw2_reweight) {
     cout << "     vs " << estddev << std::endl;
   }
 }
+
+TEST_F(CRUSHTest, hash32_3_multi) {
+  // the vector lanes must agree with the scalar hash for every length,
+  // including the tail that does not fill a whole vector
+  vector<__u32> b(77);
+  for (unsigned i = 0; i < b.size(); ++i)
+    b[i] = i * 2654435761u;
+  for (unsigned n = 0; n <= b.size(); ++n) {
+    for (__u32 x : {0u, 1u, 12345u, 0xffffffffu}) {
+      vector<__u32> out(n);
+      crush_hash32_3_multi(CRUSH_HASH_RJENKINS1, x, b.data(), 3, out.data(), n);
+      for (unsigned i = 0; i < n; ++i)
+	ASSERT_EQ(crush_hash32_3(CRUSH_HASH_RJENKINS1, x, b[i], 3), out[i]);
+    }
+  }
+}
+
+TEST_F(CRUSHTest, do_rule_batch) {
+  // a straw2 bucket wider than one hash batch, with a zero weight item
+  const int n = 150;
+  std::unique_ptr<CrushWrapper> c(new CrushWrapper);
+  c->set_type_name(1, "root");
+  c->set_type_name(0, "osd");
+  int items[n], weights[n];
+  for (int i = 0; i < n; ++i) {
+    items[i] = i;
+    weights[i] = 0x10000 * (1 + i % 5);
+  }
+  weights[7] = 0;
+  c->set_max_devices(n);
+  crush_bucket *b = crush_make_bucket(c->get_crush_map(),
+				      CRUSH_BUCKET_STRAW2, CRUSH_HASH_RJENKINS1,
+				      1, n, items, weights);
+  int root;
+  EXPECT_EQ(0, crush_add_bucket(c->get_crush_map(), 0, b, &root));
+  EXPECT_EQ(0, c->set_item_name(root, "root"));
+  int rule = c->add_simple_rule("rule", "root", "osd", "",
+				"firstn", pg_pool_t::TYPE_REPLICATED);
+  EXPECT_EQ(0, rule);
+  c->finalize();
+
+  vector<__u32> reweight(n, 0x10000);
+  reweight[3] = 0x8000;
+  vector<int> xs;
+  for (int x = 0; x < 1000; ++x)
+    xs.push_back(x);
+  vector<vector<int>> batch;
+  c->do_rule_batch(rule, xs, batch, 3, reweight, 0);
+  ASSERT_EQ(xs.size(), batch.size());
+  for (unsigned i = 0; i < xs.size(); ++i) {
+    vector<int> out;
+    c->do_rule(rule, xs[i], out, 3, reweight, 0);
+    ASSERT_EQ(out, batch[i]);
+    ASSERT_EQ(3u, out.size());
+    ASSERT_EQ(0, std::count(out.begin(), out.end(), 7));
+  }
+}
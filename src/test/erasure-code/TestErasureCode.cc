@@ -158,6 +158,37 @@ TEST(ErasureCodeTest, encode_misaligned_non_contiguous)
   }
 }
 
+TEST(ErasureCodeTest, encode_into_provided_buffers)
+{
+  int k = 3;
+  int m = 2;
+  unsigned chunk_size = ErasureCode::SIMD_ALIGN * 7;
+  ErasureCodeTest erasure_code(k, m, chunk_size);
+
+  set<int> want_to_encode;
+  for (unsigned int i = 0; i < erasure_code.get_chunk_count(); i++)
+    want_to_encode.insert(i);
+  bufferptr data(buffer::create_aligned(k * chunk_size, ErasureCode::SIMD_ALIGN));
+  data.zero();
+  bufferlist in;
+  in.append(data);
+  // an aligned buffer for coding chunk 3, a misaligned one for 4
+  bufferptr coding(buffer::create_aligned(2 * chunk_size, ErasureCode::SIMD_ALIGN));
+  map<int, bufferlist> encoded;
+  encoded[3].append(coding, 0, chunk_size);
+  encoded[4].append(coding, chunk_size + 1, chunk_size - 1);
+
+  ASSERT_EQ(0, erasure_code.encode(want_to_encode, in, &encoded));
+  // neither the input nor the provided buffer were copied
+  ASSERT_EQ(data.c_str(), encoded[0].c_str());
+  ASSERT_EQ(data.c_str() + chunk_size, encoded[1].c_str());
+  ASSERT_EQ(coding.c_str(), encoded[3].c_str());
+  // the unusable one was replaced
+  ASSERT_EQ(chunk_size, encoded[4].length());
+  ASSERT_TRUE(encoded[4].is_aligned(ErasureCode::SIMD_ALIGN));
+  ASSERT_NE(coding.c_str() + chunk_size + 1, encoded[4].c_str());
+}
+
 /*
  * Local Variables:
  * compile-command: "cd ../.. ;
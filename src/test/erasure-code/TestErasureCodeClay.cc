@@ -458,6 +458,53 @@ TEST(ErasureCodeClay, minimum_to_decode)
   }
 }
 
+TEST(ErasureCodeClay, minimum_to_decode_with_cost)
+{
+  ErasureCodeClay clay(g_conf().get_val<std::string>("erasure_code_dir"));
+  ErasureCodeProfile profile;
+  profile["k"] = "3";
+  profile["m"] = "3";
+  profile["d"] = "4";
+  EXPECT_EQ(0, clay.init(profile, &cerr));
+  //
+  // repairing chunk 0 always reads from its y-section peer, chunk 1,
+  // and then from the cheapest of the others
+  //
+  {
+    set<int> want_to_read{0};
+    map<int, int> available{{1, 100}, {2, 50}, {3, 1}, {4, 10}, {5, 5}};
+    set<int> minimum;
+    EXPECT_EQ(0, clay.minimum_to_decode_with_cost(want_to_read,
+						  available,
+						  &minimum));
+    EXPECT_EQ(set<int>({1, 3, 4, 5}), minimum);
+
+    map<int, vector<pair<int, int>>> need;
+    EXPECT_EQ(0, clay.minimum_to_decode(want_to_read, minimum, &need));
+    EXPECT_EQ(4u, need.size());
+    for (auto &[chunk, subchunks] : need) {
+      EXPECT_EQ(1u, minimum.count(chunk));
+      int count = 0;
+      for (auto &[index, len] : subchunks) {
+	count += len;
+      }
+      EXPECT_EQ(clay.get_repair_sub_chunk_count(want_to_read), count);
+    }
+  }
+  //
+  // not a repair: fall back to the default selection
+  //
+  {
+    set<int> want_to_read{0, 1};
+    map<int, int> available{{2, 1}, {3, 1}, {4, 1}, {5, 1}};
+    set<int> minimum;
+    EXPECT_EQ(0, clay.minimum_to_decode_with_cost(want_to_read,
+						  available,
+						  &minimum));
+    EXPECT_EQ(3u, minimum.size());
+  }
+}
+
 TEST(ErasureCodeClay, encode)
 {
   ErasureCodeClay clay(g_conf().get_val<std::string>("erasure_code_dir"));
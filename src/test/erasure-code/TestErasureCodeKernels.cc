@@ -0,0 +1,96 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph distributed storage system
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+#include <stdlib.h>
+#include <vector>
+
+#include "erasure-code/ErasureCodeKernels.h"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace ceph;
+
+TEST(ErasureCodeKernels, gf_mul)
+{
+  // the field generated by 0x11d: x^8 = x^4 + x^3 + x^2 + 1
+  EXPECT_EQ(0x1d, ec_kernel::gf_mul(0x80, 2));
+  EXPECT_EQ(0, ec_kernel::gf_mul(0, 0x53));
+  for (unsigned a = 1; a < 256; a++) {
+    EXPECT_EQ(a, ec_kernel::gf_mul(a, 1));
+    unsigned inverses = 0;
+    for (unsigned b = 1; b < 256; b++) {
+      if (ec_kernel::gf_mul(a, b) == 1)
+	inverses++;
+    }
+    EXPECT_EQ(1u, inverses) << a;
+  }
+}
+
+TEST(ErasureCodeKernels, supported_kernels_agree)
+{
+  auto kernels = ec_kernel::get_supported();
+  ASSERT_FALSE(kernels.empty());
+  ASSERT_STREQ("generic", kernels.front()->name);
+
+  // odd lengths and offsets exercise the unaligned heads and tails
+  const size_t length = 4096 + 37;
+  vector<uint8_t> src(length + 1), dst(length + 1);
+  for (auto &b : src)
+    b = rand();
+  for (auto &b : dst)
+    b = rand();
+
+  for (unsigned c : {0u, 1u, 2u, 0x1du, 0x53u, 0x8eu, 0xffu}) {
+    for (size_t len : {(size_t)0, (size_t)15, (size_t)64, (size_t)100, length}) {
+      vector<uint8_t> expected(dst);
+      for (size_t i = 0; i < len; i++)
+	expected[1 + i] ^= ec_kernel::gf_mul(c, src[1 + i]);
+      for (auto kernel : kernels) {
+	vector<uint8_t> out(dst);
+	kernel->region_mul_xor(c, &src[1], &out[1], len);
+	ASSERT_EQ(expected, out) << kernel->name << " c=" << c << " len=" << len;
+	if (c == 1) {
+	  out = dst;
+	  kernel->region_xor(&src[1], &out[1], len);
+	  ASSERT_EQ(expected, out) << kernel->name << " len=" << len;
+	}
+      }
+    }
+  }
+}
+
+TEST(ErasureCodeKernels, region_dot_prod)
+{
+  const int n = 5;
+  const size_t len = 1000;
+  const int coeffs[n] = {1, 2, 0, 0x47, 0xfe};
+  vector<vector<uint8_t>> src(n, vector<uint8_t>(len));
+  const uint8_t *srcp[n];
+  for (int i = 0; i < n; i++) {
+    for (auto &b : src[i])
+      b = rand();
+    srcp[i] = src[i].data();
+  }
+  vector<uint8_t> expected(len, 0);
+  for (size_t j = 0; j < len; j++) {
+    for (int i = 0; i < n; i++)
+      expected[j] ^= ec_kernel::gf_mul(coeffs[i], src[i][j]);
+  }
+  for (auto kernel : ec_kernel::get_supported()) {
+    ASSERT_TRUE(ec_kernel::select(kernel->name));
+    ASSERT_STREQ(kernel->name, ec_kernel::get().name);
+    vector<uint8_t> out(len, 0xaa);
+    ec_kernel::region_dot_prod(coeffs, srcp, n, out.data(), len);
+    ASSERT_EQ(expected, out) << kernel->name;
+  }
+  ASSERT_FALSE(ec_kernel::select("no-such-kernel"));
+}
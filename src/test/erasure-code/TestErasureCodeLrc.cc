@@ -601,6 +601,65 @@ TEST(ErasureCodeLrc, minimum_to_decode)
   }
 }
 
+TEST(ErasureCodeLrc, minimum_to_decode_with_cost)
+{
+  ErasureCodeLrc lrc(g_conf().get_val<std::string>("erasure_code_dir"));
+  ErasureCodeProfile profile;
+  profile["mapping"] =
+	  "__DDD__DD_";
+  const char *description_string =
+    "[ "
+    "  [ \"_cDDD_cDD_\", \"\" ],"
+    "  [ \"c_DDD_____\", \"\" ],"
+    "  [ \"_____cDDD_\", \"\" ],"
+    "  [ \"_____DDDDc\", \"\" ],"
+    "]";
+  profile["layers"] = description_string;
+  EXPECT_EQ(0, lrc.init(profile, &cerr));
+  //
+  // chunk 6 can be repaired by _____DDDDc or by _____cDDD_: when chunk
+  // 9 is expensive the second layer is used
+  //
+  {
+    set<int> want_to_read;
+    want_to_read.insert(6);
+    map<int, int> available;
+    for (int i = 0; i < (int)lrc.get_chunk_count(); i++) {
+      if (i != 6)
+	available[i] = 1;
+    }
+    available[9] = 1000;
+    set<int> minimum;
+    EXPECT_EQ(0, lrc.minimum_to_decode_with_cost(want_to_read, available,
+						 &minimum));
+    set<int> expected_minimum;
+    expected_minimum.insert(5);
+    expected_minimum.insert(7);
+    expected_minimum.insert(8);
+    EXPECT_EQ(expected_minimum, minimum);
+  }
+  //
+  // chunk 9 can only be repaired by _____DDDDc whatever the cost
+  //
+  {
+    set<int> want_to_read;
+    want_to_read.insert(9);
+    map<int, int> available;
+    for (int i = 0; i < (int)lrc.get_chunk_count() - 1; i++)
+      available[i] = 1;
+    available[5] = 1000;
+    set<int> minimum;
+    EXPECT_EQ(0, lrc.minimum_to_decode_with_cost(want_to_read, available,
+						 &minimum));
+    set<int> expected_minimum;
+    expected_minimum.insert(5);
+    expected_minimum.insert(6);
+    expected_minimum.insert(7);
+    expected_minimum.insert(8);
+    EXPECT_EQ(expected_minimum, minimum);
+  }
+}
+
 TEST(ErasureCodeLrc, encode_decode)
 {
   ErasureCodeLrc lrc(g_conf().get_val<std::string>("erasure_code_dir"));
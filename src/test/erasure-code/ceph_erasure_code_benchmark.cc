@@ -33,6 +33,8 @@
 #include "include/utime.h"
 #include "erasure-code/ErasureCodePlugin.h"
 #include "erasure-code/ErasureCode.h"
+#include "erasure-code/ErasureCodeKernels.h"
+#include "osd/ECUtil.h"
 #include "ceph_erasure_code_benchmark.h"
 
 using std::endl;
@@ -59,7 +61,13 @@ int ErasureCodeBench::setup(int argc, char** argv) {
     ("plugin,p", po::value<string>()->default_value("jerasure"),
      "erasure code plugin name")
     ("workload,w", po::value<string>()->default_value("encode"),
-     "run either encode or decode")
+     "run either encode, decode, kernels (GB/s of each GF(2^8) region "
+     "kernel supported by this CPU) or pipeline (the OSD write path: "
+     "stripe encode, hinfo crc and shard message framing, timed per stage)")
+    ("stripe-unit,u", po::value<int>()->default_value(4096),
+     "bytes of each chunk in a stripe, for the pipeline workload")
+    ("threads,t", po::value<int>()->default_value(0),
+     "encode worker threads, for the pipeline workload")
     ("erasures,e", po::value<int>()->default_value(1),
      "number of erasures when decoding")
     ("erased", po::value<vector<int> >(),
@@ -123,6 +131,8 @@ int ErasureCodeBench::setup(int argc, char** argv) {
   plugin = vm["plugin"].as<string>();
   workload = vm["workload"].as<string>();
   erasures = vm["erasures"].as<int>();
+  stripe_unit = vm["stripe-unit"].as<int>();
+  threads = vm["threads"].as<int>();
   if (vm.count("erasures-generation") > 0 &&
       vm["erasures-generation"].as<string>() == "exhaustive")
     exhaustive_erasures = true;
@@ -130,7 +140,10 @@ int ErasureCodeBench::setup(int argc, char** argv) {
     exhaustive_erasures = false;
   if (vm.count("erased") > 0)
     erased = vm["erased"].as<vector<int> >();
-  
+  verbose = vm.count("verbose") > 0 ? true : false;
+  if (workload == "kernels")
+    return 0;
+
   try {
     k = stoi(profile["k"]);
     m = stoi(profile["m"]);
@@ -147,8 +160,6 @@ int ErasureCodeBench::setup(int argc, char** argv) {
     return -EINVAL;
   } 
 
-  verbose = vm.count("verbose") > 0 ? true : false;
-
   return 0;
 }
 
@@ -158,10 +169,40 @@ int ErasureCodeBench::run() {
 
   if (workload == "encode")
     return encode();
+  else if (workload == "kernels")
+    return kernels();
+  else if (workload == "pipeline")
+    return pipeline();
   else
     return decode();
 }
 
+int ErasureCodeBench::kernels()
+{
+  vector<uint8_t> src(in_size), dst(in_size);
+  for (auto &b : src)
+    b = rand();
+  for (auto kernel : ceph::ec_kernel::get_supported()) {
+    utime_t begin_time = ceph_clock_now();
+    for (int i = 0; i < max_iterations; i++) {
+      kernel->region_mul_xor(0x8e, src.data(), dst.data(), in_size);
+    }
+    double mul = (ceph_clock_now() - begin_time).to_nsec();
+    begin_time = ceph_clock_now();
+    for (int i = 0; i < max_iterations; i++) {
+      kernel->region_xor(src.data(), dst.data(), in_size);
+    }
+    double xor_ = (ceph_clock_now() - begin_time).to_nsec();
+    double bytes = (double)max_iterations * in_size;
+    cout << kernel->name
+	 << "\tmul_xor " << (mul ? bytes / mul : 0) << " GB/s"
+	 << "\txor " << (xor_ ? bytes / xor_ : 0) << " GB/s"
+	 << (kernel == &ceph::ec_kernel::get() ? "\t(default)" : "")
+	 << endl;
+  }
+  return 0;
+}
+
 int ErasureCodeBench::encode()
 {
   ErasureCodePluginRegistry &instance = ErasureCodePluginRegistry::instance();
@@ -194,6 +235,92 @@ int ErasureCodeBench::encode()
   return 0;
 }
 
+int ErasureCodeBench::pipeline()
+{
+  ErasureCodePluginRegistry &instance = ErasureCodePluginRegistry::instance();
+  ErasureCodeInterfaceRef erasure_code;
+  stringstream messages;
+  int code = instance.factory(plugin,
+			      g_conf().get_val<std::string>("erasure_code_dir"),
+			      profile, &erasure_code, &messages);
+  if (code) {
+    cerr << messages.str() << endl;
+    return code;
+  }
+
+  const unsigned stripe_width = erasure_code->get_data_chunk_count() * stripe_unit;
+  if (stripe_unit <= 0 ||
+      erasure_code->get_chunk_size(stripe_width) != (unsigned)stripe_unit) {
+    cerr << "stripe unit " << stripe_unit << " does not match the chunk size "
+	 << erasure_code->get_chunk_size(stripe_width) << " of " << plugin
+	 << " for a stripe of " << stripe_width << " bytes" << endl;
+    return -EINVAL;
+  }
+  ECUtil::stripe_info_t sinfo(erasure_code->get_data_chunk_count(),
+			      stripe_width);
+  // the OSD only writes whole stripes
+  const uint64_t size = sinfo.logical_to_next_stripe_offset(in_size);
+
+  set<int> want_to_encode;
+  for (unsigned i = 0; i < erasure_code->get_chunk_count(); i++) {
+    want_to_encode.insert(i);
+  }
+  if (threads > 0) {
+    ECUtil::EncodeWorkers::instance().start(
+      threads,
+      g_conf().get_val<Option::size_t>("osd_ec_encode_parallel_min_bytes"));
+  }
+
+  // what the messenger hands to the OSD: a page aligned payload
+  bufferlist in;
+  in.push_back(buffer::create_page_aligned(size));
+  memset(in.c_str(), 'X', size);
+
+  utime_t encode_time, hinfo_time, frame_time;
+  uint64_t framed = 0;
+  for (int i = 0; i < max_iterations; i++) {
+    utime_t begin_time = ceph_clock_now();
+    map<int, bufferlist> encoded;
+    code = ECUtil::encode(sinfo, erasure_code, in, want_to_encode, &encoded);
+    if (code)
+      return code;
+    utime_t hinfo_begin = ceph_clock_now();
+    ECUtil::HashInfo hinfo(erasure_code->get_chunk_count());
+    hinfo.append(0, encoded);
+    bufferlist hbuf;
+    hinfo.encode(hbuf);
+    utime_t frame_begin = ceph_clock_now();
+    for (auto &&[shard, bl] : encoded) {
+      // the sub write message payload, and the crc msgr2 puts in the
+      // epilogue of each frame segment
+      bufferlist payload;
+      ceph::encode(shard, payload);
+      ceph::encode(hbuf, payload);
+      ceph::encode(bl, payload);
+      uint32_t crc = payload.crc32c(-1);
+      framed += payload.length() + sizeof(crc);
+    }
+    utime_t end_time = ceph_clock_now();
+    encode_time += hinfo_begin - begin_time;
+    hinfo_time += frame_begin - hinfo_begin;
+    frame_time += end_time - frame_begin;
+  }
+  if (threads > 0) {
+    ECUtil::EncodeWorkers::instance().stop();
+  }
+  if (verbose) {
+    cout << "stripe_width " << stripe_width << " stripes "
+	 << size / stripe_width << " framed " << framed / max_iterations
+	 << " bytes per write" << endl;
+  }
+  cout << "encode\t" << encode_time << endl;
+  cout << "hinfo\t" << hinfo_time << endl;
+  cout << "frame\t" << frame_time << endl;
+  cout << (encode_time + hinfo_time + frame_time) << "\t"
+       << (max_iterations * (size / 1024)) << endl;
+  return 0;
+}
+
 static void display_chunks(const map<int,bufferlist> &chunks,
 			   unsigned int chunk_count) {
   cout << "chunks ";
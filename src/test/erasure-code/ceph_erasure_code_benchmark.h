@@ -36,6 +36,8 @@ class ErasureCodeBench {
   int erasures;
   int k;
   int m;
+  int stripe_unit;
+  int threads;
 
   std::string plugin;
 
@@ -57,6 +59,8 @@ public:
 		      ErasureCodeInterfaceRef erasure_code);
   int decode();
   int encode();
+  int kernels();
+  int pipeline();
 };
 
 #endif
@@ -122,6 +122,22 @@ TEST(EscapeJson, ControlChars) {
   ASSERT_EQ(escape_json_stream("abc\x7f"), "abc\\u007f");
 }
 
+TEST(EscapeJson, Append) {
+  // escape_json_append() scans eight bytes at a time; put each kind of
+  // escaped character at every offset of a word
+  const std::string specials = std::string("\"\\\t\n\x01\x7f\x00", 7);
+  for (char c : specials) {
+    for (size_t pos = 0; pos < 20; ++pos) {
+      std::string in(20, 'x');
+      in[pos] = c;
+      in += "\xe6\xb1\x89 tail";
+      std::string out = "prefix";
+      escape_json_append(in, out);
+      ASSERT_EQ(out, "prefix" + escape_json_stream(in.c_str(), in.size()));
+    }
+  }
+}
+
 TEST(EscapeJson, Utf8) {
   EXPECT_EQ(escape_json_attrs("\xe6\xb1\x89\xe5\xad\x97\n"), "\xe6\xb1\x89\xe5\xad\x97\\n");
   EXPECT_EQ(escape_json_stream("\xe6\xb1\x89\xe5\xad\x97\n"), "\xe6\xb1\x89\xe5\xad\x97\\n");
@@ -54,8 +54,12 @@ struct Options {
     pglog_dup_omap_len_low,
     pglog_dup_omap_len_high,
     _fastinfo_omap_len_low,
-    _fastinfo_omap_len_high;
+    _fastinfo_omap_len_high,
+    object_omap_len_low,
+    object_omap_len_high,
+    object_omap_keys;
   unsigned simulate_pglog;
+  unsigned osd_profile;
   unsigned single_pool_mode;
   unsigned preallocate_files;
   unsigned check_files;
@@ -146,6 +150,34 @@ static std::vector<fio_option> ceph_options{
     o.def    = 0;
     o.minval = 0;
   }),
+  make_option([] (fio_option& o) {
+    o.name   = "object_omap_len";
+    o.lname  = "object omap entry length";
+    o.type   = FIO_OPT_STR_VAL;
+    o.help   = "Set omap entries written to the object itself to specified length";
+    o.off1   = offsetof(Options, object_omap_len_low);
+    o.off2   = offsetof(Options, object_omap_len_high);
+    o.def    = 0;
+    o.minval = 0;
+  }),
+  make_option([] (fio_option& o) {
+    o.name   = "object_omap_keys";
+    o.lname  = "object omap entries per write";
+    o.type   = FIO_OPT_STR_VAL;
+    o.help   = "Number of omap entries written to the object with each write";
+    o.off1   = offsetof(Options, object_omap_keys);
+    o.def    = "1";
+    o.minval = 0;
+  }),
+  make_option([] (fio_option& o) {
+    o.name   = "osd_profile";
+    o.lname  = "OSD-like metadata per write";
+    o.type   = FIO_OPT_BOOL;
+    o.help   = "Couple each write with the attrs and PG log omap an OSD "
+               "would write, for any length not set explicitly";
+    o.off1   = offsetof(Options, osd_profile);
+    o.def    = "0";
+  }),
   make_option([] (fio_option& o) {
     o.name   = "single_pool_mode";
     o.lname  = "single(shared among jobs) pool mode";
@@ -519,11 +551,29 @@ Job::Job(Engine* engine, const thread_data* td)
 {
   engine->ref();
   auto o = static_cast<Options*>(td->eo);
+  if (o->osd_profile) {
+    // typical sizes for a replicated pool's client write
+    auto set_default = [](unsigned long long& low, unsigned long long& high,
+			  unsigned long long len) {
+      if (!high) {
+	low = high = len;
+      }
+    };
+    set_default(o->oi_attr_len_low, o->oi_attr_len_high, 350);
+    set_default(o->snapset_attr_len_low, o->snapset_attr_len_high, 35);
+    set_default(o->_fastinfo_omap_len_low, o->_fastinfo_omap_len_high, 186);
+    set_default(o->pglog_omap_len_low, o->pglog_omap_len_high, 173);
+    set_default(o->pglog_dup_omap_len_low, o->pglog_dup_omap_len_high, 57);
+    o->simulate_pglog = 1;
+  }
+  o->object_omap_len_high = max(o->object_omap_len_low,
+				o->object_omap_len_high);
   unsigned long long max_data = max(o->oi_attr_len_high,
 				  o->snapset_attr_len_high);
   max_data = max(max_data, o->pglog_omap_len_high);
   max_data = max(max_data, o->pglog_dup_omap_len_high);
   max_data = max(max_data, o->_fastinfo_omap_len_high);
+  max_data = max(max_data, o->object_omap_len_high);
   one_for_all_data = buffer::create(max_data);
 
   std::vector<Collection>* colls;
@@ -834,6 +884,21 @@ enum fio_q_status fio_ceph_os_queue(thread_data* td, io_u* u)
     }
     t.write(coll.cid, object.oid, u->offset, u->xfer_buflen, bl, flags);
 
+    if (o->object_omap_len_high && o->object_omap_keys) {
+      // key on the write offset so rewrites replace entries, like a
+      // bucket index that updates existing keys
+      map<string, bufferlist> object_omaps;
+      for (unsigned long long i = 0; i < o->object_omap_keys; ++i) {
+	snprintf(ver_key, sizeof(ver_key), "%020llu.%llu",
+	  (unsigned long long)u->offset, i);
+	job->one_for_all_data.set_length(
+	  ceph::util::generate_random_number(
+	    o->object_omap_len_low, o->object_omap_len_high));
+	object_omaps[ver_key].append(job->one_for_all_data);
+      }
+      t.omap_setkeys(coll.cid, object.oid, object_omaps);
+    }
+
     set<string> rmkeys;
     for( auto i = pglog_trim_tail; i < pglog_trim_head; ++i) {
 	snprintf(ver_key, sizeof(ver_key),
@@ -73,10 +73,12 @@ int RadosTestFixture::create(const std::string &oid, uint8_t order,
 
 ceph::ref_t<journal::JournalMetadata> RadosTestFixture::create_metadata(
     const std::string &oid, const std::string &client_id,
-    double commit_interval, int max_concurrent_object_sets) {
+    double commit_interval, int max_concurrent_object_sets,
+    uint32_t fetch_ahead_objects) {
   journal::Settings settings;
   settings.commit_interval = commit_interval;
   settings.max_concurrent_object_sets = max_concurrent_object_sets;
+  settings.fetch_ahead_objects = fetch_ahead_objects;
 
   auto metadata = ceph::make_ref<journal::JournalMetadata>(
     m_work_queue, m_timer, &m_timer_lock, m_ioctx, oid, client_id, settings);
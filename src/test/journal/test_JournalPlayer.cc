@@ -621,6 +621,49 @@ TYPED_TEST(TestJournalPlayer, PrefetchSkippedObject) {
   ASSERT_EQ(126U, last_tid);
 }
 
+TYPED_TEST(TestJournalPlayer, PrefetchFetchAhead) {
+  std::string oid = this->get_temp_oid();
+
+  cls::journal::ObjectSetPosition commit_position;
+
+  ASSERT_EQ(0, this->create(oid, 14, 2));
+  ASSERT_EQ(0, this->client_register(oid));
+  ASSERT_EQ(0, this->client_commit(oid, commit_position));
+
+  auto metadata = RadosTestFixture::create_metadata(
+    oid, "client", 0.1, this->max_fetch_bytes, 2);
+  ASSERT_EQ(0, this->init_metadata(metadata));
+  ASSERT_EQ(0, metadata->set_active_set(4));
+
+  journal::JournalPlayer *player = this->create_player(oid, metadata);
+  BOOST_SCOPE_EXIT_ALL( (player) ) {
+    C_SaferCond unwatch_ctx;
+    player->shut_down(&unwatch_ctx);
+    ASSERT_EQ(0, unwatch_ctx.wait());
+  };
+
+  for (uint64_t entry_tid = 0; entry_tid < 16; ++entry_tid) {
+    uint64_t object_num = 2 * (entry_tid / 4) + (entry_tid % 2);
+    ASSERT_EQ(0, this->write_entry(oid, object_num, 234, entry_tid));
+  }
+
+  player->prefetch();
+
+  Entries entries;
+  ASSERT_TRUE(this->wait_for_entries(player, 16, &entries));
+  ASSERT_TRUE(this->wait_for_complete(player));
+
+  Entries expected_entries;
+  for (uint64_t tid = 0; tid < 16; ++tid) {
+    expected_entries.push_back(this->create_entry(234, tid));
+  }
+  ASSERT_EQ(expected_entries, entries);
+
+  uint64_t last_tid;
+  ASSERT_TRUE(metadata->get_last_allocated_entry_tid(234, &last_tid));
+  ASSERT_EQ(15U, last_tid);
+}
+
 TYPED_TEST(TestJournalPlayer, ImbalancedJournal) {
   std::string oid = this->get_temp_oid();
 
@@ -362,6 +362,50 @@ TEST_F(TestObjectRecorder, FlushFuture) {
   ASSERT_EQ(0, cond.wait());
 }
 
+TEST_F(TestObjectRecorder, GroupCommit) {
+  std::string oid = get_temp_oid();
+  ASSERT_EQ(0, create(oid));
+  ASSERT_EQ(0, client_register(oid));
+  auto metadata = create_metadata(oid);
+  ASSERT_EQ(0, init_metadata(metadata));
+
+  ceph::mutex lock = ceph::make_mutex("object_recorder_lock");
+  ObjectRecorderFlusher flusher(m_ioctx, m_work_queue, 0, 0, 0, 0);
+  auto object = flusher.create_object(oid, 24, &lock);
+  lock.lock();
+  object->set_group_commit(true);
+  lock.unlock();
+
+  journal::AppendBuffer append_buffer1 = create_append_buffer(234, 123,
+                                                              "payload");
+  journal::AppendBuffers append_buffers;
+  append_buffers = {append_buffer1};
+  lock.lock();
+  ASSERT_FALSE(object->append(std::move(append_buffers)));
+  lock.unlock();
+  ASSERT_EQ(0U, object->get_pending_appends());
+
+  // appends behind the in-flight append are committed together
+  journal::AppendBuffer append_buffer2 = create_append_buffer(234, 124,
+                                                              "payload");
+  journal::AppendBuffer append_buffer3 = create_append_buffer(234, 125,
+                                                              "payload");
+  append_buffers = {append_buffer2, append_buffer3};
+  lock.lock();
+  ASSERT_FALSE(object->append(std::move(append_buffers)));
+  lock.unlock();
+
+  C_SaferCond cond1;
+  append_buffer1.first->wait(&cond1);
+  ASSERT_EQ(0, cond1.wait());
+
+  C_SaferCond cond3;
+  append_buffer3.first->wait(&cond3);
+  ASSERT_EQ(0, cond3.wait());
+  ASSERT_TRUE(append_buffer2.first->is_complete());
+  ASSERT_EQ(0U, object->get_pending_appends());
+}
+
 TEST_F(TestObjectRecorder, FlushDetachedFuture) {
   std::string oid = get_temp_oid();
   ASSERT_EQ(0, create(oid));
@@ -1297,6 +1297,133 @@ TEST(LibCephFS, LlreadvLlwritev) {
   ceph_shutdown(cmount);
 }
 
+TEST(LibCephFS, LlCompletionQueue) {
+  struct ceph_mount_info *cmount;
+  ASSERT_EQ(ceph_create(&cmount, NULL), 0);
+  ASSERT_EQ(ceph_conf_read_file(cmount, NULL), 0);
+  ASSERT_EQ(0, ceph_conf_parse_env(cmount, NULL));
+  ASSERT_EQ(ceph_mount(cmount, NULL), 0);
+
+  char filename[256];
+  sprintf(filename, "test_llcompletionqueue%u", getpid());
+
+  Inode *root, *file;
+  ASSERT_EQ(ceph_ll_lookup_root(cmount, &root), 0);
+
+  Fh *fh;
+  struct ceph_statx stx;
+  UserPerm *perms = ceph_mount_perms(cmount);
+  ASSERT_EQ(ceph_ll_create(cmount, root, filename, 0666,
+		    O_RDWR|O_CREAT|O_TRUNC, &file, &fh, &stx, 0, 0, perms), 0);
+
+  struct ceph_ll_cq *cq;
+  ASSERT_EQ(ceph_ll_cq_create(cmount, 0, &cq), -CEPHFS_EINVAL);
+  ASSERT_EQ(ceph_ll_cq_create(cmount, 2, &cq), 0);
+
+  char out[] = "hello world\n";
+  struct iovec iov_out = {out, sizeof(out)};
+  struct ceph_ll_io wr = {};
+  wr.op = CEPH_LL_IO_WRITE;
+  wr.fh = fh;
+  wr.iov = &iov_out;
+  wr.iovcnt = 1;
+  struct ceph_ll_io *ios[2] = {&wr};
+  ASSERT_EQ(ceph_ll_submit(cq, ios, 1), 1);
+  ASSERT_EQ(ceph_ll_cq_wait(cq, ios, 1, 2, -1), 1);
+  ASSERT_EQ(ios[0], &wr);
+  ASSERT_EQ(wr.result, (int64_t)sizeof(out));
+
+  char in[sizeof(out)];
+  struct iovec iov_in = {in, sizeof(in)};
+  struct ceph_ll_io rd = {};
+  rd.op = CEPH_LL_IO_READ;
+  rd.fh = fh;
+  rd.iov = &iov_in;
+  rd.iovcnt = 1;
+  struct ceph_ll_io ga = {};
+  ga.op = CEPH_LL_IO_GETATTR;
+  ga.in = file;
+  ga.stx = &stx;
+  ga.want = CEPH_STATX_SIZE;
+  ga.perms = perms;
+  ios[0] = &rd;
+  ios[1] = &ga;
+  ASSERT_EQ(ceph_ll_submit(cq, ios, 2), 2);
+  int n = 0;
+  while (n < 2) {
+    int r = ceph_ll_cq_wait(cq, ios + n, 1, 2 - n, -1);
+    ASSERT_GT(r, 0);
+    n += r;
+  }
+  ASSERT_EQ(rd.result, (int64_t)sizeof(out));
+  ASSERT_EQ(0, memcmp(in, out, sizeof(out)));
+  ASSERT_EQ(ga.result, 0);
+  ASSERT_EQ(stx.stx_size, sizeof(out));
+
+  // nothing left to reap
+  ASSERT_EQ(ceph_ll_cq_wait(cq, ios, 0, 2, 0), 0);
+
+  ceph_ll_cq_destroy(cq);
+  ceph_ll_close(cmount, fh);
+  ceph_shutdown(cmount);
+}
+
+TEST(LibCephFS, LlLookupBatch) {
+  struct ceph_mount_info *cmount;
+  ASSERT_EQ(ceph_create(&cmount, NULL), 0);
+  ASSERT_EQ(ceph_conf_read_file(cmount, NULL), 0);
+  ASSERT_EQ(0, ceph_conf_parse_env(cmount, NULL));
+  ASSERT_EQ(ceph_mount(cmount, NULL), 0);
+
+  char dirname[256];
+  sprintf(dirname, "/test_lllookupbatch%u", getpid());
+  ASSERT_EQ(ceph_mkdir(cmount, dirname, 0777), 0);
+
+  char path[512];
+  for (int i = 0; i < 3; ++i) {
+    sprintf(path, "%s/f%d", dirname, i);
+    int fd = ceph_open(cmount, path, O_CREAT|O_RDWR, 0666);
+    ASSERT_GT(fd, 0);
+    ASSERT_EQ(ceph_write(cmount, fd, "x", 1, i), 1);
+    ceph_close(cmount, fd);
+  }
+  ceph_shutdown(cmount);
+
+  // remount so nothing is cached
+  ASSERT_EQ(ceph_create(&cmount, NULL), 0);
+  ASSERT_EQ(ceph_conf_read_file(cmount, NULL), 0);
+  ASSERT_EQ(0, ceph_conf_parse_env(cmount, NULL));
+  ASSERT_EQ(ceph_mount(cmount, NULL), 0);
+
+  UserPerm *perms = ceph_mount_perms(cmount);
+  Inode *diri;
+  struct ceph_statx stx[4];
+  ASSERT_EQ(ceph_ll_walk(cmount, dirname, &diri, &stx[0], 0, 0, perms), 0);
+
+  const char *names[4] = {"f0", "f1", "nonexistent", "f2"};
+  Inode *out[4];
+  int results[4];
+  ASSERT_EQ(ceph_ll_lookup_batch(cmount, diri, 4, names, out, stx, results,
+				 CEPH_STATX_SIZE, 0, perms), 0);
+  ASSERT_EQ(results[0], 0);
+  ASSERT_EQ(stx[0].stx_size, 1u);
+  ASSERT_EQ(results[1], 0);
+  ASSERT_EQ(stx[1].stx_size, 2u);
+  ASSERT_EQ(results[2], -CEPHFS_ENOENT);
+  ASSERT_EQ(out[2], nullptr);
+  ASSERT_EQ(results[3], 0);
+  ASSERT_EQ(stx[3].stx_size, 3u);
+
+  for (int i : {0, 1, 3}) {
+    ceph_ll_put(cmount, out[i]);
+    sprintf(path, "%s/%s", dirname, names[i]);
+    ASSERT_EQ(ceph_unlink(cmount, path), 0);
+  }
+  ceph_ll_put(cmount, diri);
+  ASSERT_EQ(ceph_rmdir(cmount, dirname), 0);
+  ceph_shutdown(cmount);
+}
+
 TEST(LibCephFS, StripeUnitGran) {
   struct ceph_mount_info *cmount;
   ASSERT_EQ(ceph_create(&cmount, NULL), 0);
@@ -305,6 +305,59 @@ TEST(LibRadosAio, RoundTripPP3)
   destroy_one_pool_pp(pool_name, cluster);
 }
 
+TEST(LibRadosAio, OperateBatchPP)
+{
+  Rados cluster;
+  auto pool_prefix = fmt::format("{}_", ::testing::UnitTest::GetInstance()->current_test_info()->name());
+  std::string pool_name = get_temp_pool_name(pool_prefix);
+  ASSERT_EQ("", create_one_pool_pp(pool_name, cluster));
+  IoCtx ioctx;
+  cluster.ioctx_create(pool_name.c_str(), ioctx);
+
+  constexpr int n = 16;
+  std::vector<ObjectWriteOperation> wops(n);
+  std::vector<std::pair<std::string, ObjectWriteOperation*>> writes;
+  for (int i = 0; i < n; ++i) {
+    bufferlist bl;
+    bl.append(stringify(i));
+    wops[i].write_full(bl);
+    writes.emplace_back("obj" + stringify(i), &wops[i]);
+  }
+  std::vector<int> results;
+  auto c1 = std::unique_ptr<AioCompletion>{Rados::aio_create_completion()};
+  ASSERT_EQ(0, ioctx.aio_operate_batch(c1.get(), writes, 0, &results));
+  {
+    TestAlarm alarm;
+    ASSERT_EQ(0, c1->wait_for_complete());
+  }
+  EXPECT_EQ(0, c1->get_return_value());
+  EXPECT_EQ(std::vector<int>(n, 0), results);
+
+  // one object that does not exist fails on its own
+  std::vector<ObjectReadOperation> rops(n + 1);
+  std::vector<bufferlist> bls(n + 1);
+  std::vector<std::pair<std::string, ObjectReadOperation*>> reads;
+  for (int i = 0; i <= n; ++i) {
+    rops[i].read(0, 0, &bls[i], nullptr);
+    reads.emplace_back("obj" + stringify(i), &rops[i]);
+  }
+  auto c2 = std::unique_ptr<AioCompletion>{Rados::aio_create_completion()};
+  ASSERT_EQ(0, ioctx.aio_operate_batch(c2.get(), reads, 0, &results));
+  {
+    TestAlarm alarm;
+    ASSERT_EQ(0, c2->wait_for_complete());
+  }
+  EXPECT_EQ(0, c2->get_return_value());
+  ASSERT_EQ(n + 1, (int)results.size());
+  for (int i = 0; i < n; ++i) {
+    EXPECT_EQ(0, results[i]);
+    EXPECT_EQ(stringify(i), bls[i].to_str());
+  }
+  EXPECT_EQ(-ENOENT, results[n]);
+
+  destroy_one_pool_pp(pool_name, cluster);
+}
+
 TEST(LibRadosAio, RoundTripSparseReadPP) {
   AioTestDataPP test_data;
   ASSERT_EQ("", test_data.init());
@@ -413,6 +413,32 @@ TEST_F(TestMockCryptoCryptoObjectDispatch, AlignedWrite) {
   ASSERT_EQ(0, finished_cond.wait());
 }
 
+TEST_F(TestMockCryptoCryptoObjectDispatch, AlignedWriteOffload) {
+  std::string orig_crypto_threads;
+  ASSERT_EQ(0, _rados.conf_get("rbd_crypto_threads", orig_crypto_threads));
+  ASSERT_EQ(0, _rados.conf_set("rbd_crypto_threads", "2"));
+  auto offload_crypto_object_dispatch = new MockCryptoObjectDispatch(
+          mock_image_ctx, &crypto);
+  ASSERT_EQ(0, _rados.conf_set("rbd_crypto_threads",
+                               orig_crypto_threads.c_str()));
+
+  expect_encrypt();
+  ASSERT_TRUE(offload_crypto_object_dispatch->write(
+        11, 0, std::move(data), mock_image_ctx->get_data_io_context(), 0, 0,
+        std::nullopt, {}, nullptr, nullptr, &dispatch_result, &on_finish,
+        on_dispatched));
+  ASSERT_EQ(0, dispatched_cond.wait());
+  ASSERT_EQ(dispatch_result, io::DISPATCH_RESULT_CONTINUE);
+  ASSERT_EQ(on_finish, &finished_cond); // not modified
+  on_finish->complete(0);
+  ASSERT_EQ(0, finished_cond.wait());
+
+  C_SaferCond cond;
+  offload_crypto_object_dispatch->shut_down(&cond);
+  ASSERT_EQ(0, cond.wait());
+  delete offload_crypto_object_dispatch;
+}
+
 TEST_F(TestMockCryptoCryptoObjectDispatch, UnalignedWrite) {
   ceph::bufferlist write_data;
   uint64_t version = 1234;
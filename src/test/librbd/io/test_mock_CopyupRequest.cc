@@ -884,6 +884,46 @@ TEST_F(TestMockIoCopyupRequest, ZeroedCopyOnRead) {
   flush_async_operations(ictx);
 }
 
+TEST_F(TestMockIoCopyupRequest, PartiallyZeroedCopyOnRead) {
+  REQUIRE_FEATURE(RBD_FEATURE_LAYERING);
+
+  librbd::ImageCtx *ictx;
+  ASSERT_EQ(0, open_image(m_image_name, &ictx));
+
+  MockTestImageCtx mock_parent_image_ctx(*ictx->parent);
+  MockTestImageCtx mock_image_ctx(*ictx, &mock_parent_image_ctx);
+
+  MockExclusiveLock mock_exclusive_lock;
+  MockJournal mock_journal;
+  MockObjectMap mock_object_map;
+  initialize_features(ictx, mock_image_ctx, mock_exclusive_lock, mock_journal,
+                      mock_object_map);
+
+  expect_op_work_queue(mock_image_ctx);
+  expect_is_lock_owner(mock_image_ctx);
+
+  InSequence seq;
+
+  std::string data(4096, '\0');
+  data.append(std::string(4096, '1'));
+  data.append(std::string(4096, '\0'));
+  expect_read_parent(mock_parent_image_ctx, {{0, 12288}}, data, 0);
+  expect_prepare_copyup(mock_image_ctx);
+
+  expect_object_map_at(mock_image_ctx, 0, OBJECT_NONEXISTENT);
+  expect_object_map_update(mock_image_ctx, CEPH_NOSNAP, 0, OBJECT_EXISTS, true,
+                           0);
+
+  expect_sparse_copyup(mock_image_ctx, CEPH_NOSNAP, ictx->get_object_name(0),
+                       {{4096, 4096}}, data.substr(4096, 4096), 0);
+
+  auto req = new MockCopyupRequest(&mock_image_ctx, 0, {{0, 12288}},
+                                   ImageArea::DATA, {});
+  mock_image_ctx.copyup_list[0] = req;
+  req->send();
+  flush_async_operations(ictx);
+}
+
 TEST_F(TestMockIoCopyupRequest, NoOpCopyup) {
   REQUIRE_FEATURE(RBD_FEATURE_LAYERING);
 
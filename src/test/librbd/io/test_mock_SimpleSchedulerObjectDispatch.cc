@@ -10,6 +10,7 @@
 #include "include/rbd/librbd.hpp"
 #include "librbd/io/ObjectDispatchSpec.h"
 #include "librbd/io/SimpleSchedulerObjectDispatch.h"
+#include <thread>
 
 namespace librbd {
 namespace {
@@ -819,5 +820,88 @@ TEST_F(TestMockIoSimpleSchedulerObjectDispatch, Timer) {
   ASSERT_EQ(0, cond2.wait());
 }
 
+TEST_F(TestMockIoSimpleSchedulerObjectDispatch, TimerMultipleObjects) {
+  librbd::ImageCtx *ictx;
+  ASSERT_EQ(0, open_image(m_image_name, &ictx));
+
+  MockTestImageCtx mock_image_ctx(*ictx);
+  MockSimpleSchedulerObjectDispatch
+      mock_simple_scheduler_object_dispatch(&mock_image_ctx);
+
+  expect_get_object_name(mock_image_ctx, 0);
+  expect_get_object_name(mock_image_ctx, 1);
+  expect_op_work_queue(mock_image_ctx);
+
+  InSequence seq;
+
+  // send 2 writes to object 0 and 2 writes to object 1
+
+  ceph::bufferlist data;
+  int object_dispatch_flags = 0;
+  C_SaferCond cond1;
+  Context *on_finish1 = &cond1;
+  ASSERT_FALSE(mock_simple_scheduler_object_dispatch.write(
+      0, 0, std::move(data), mock_image_ctx.get_data_io_context(), 0, 0,
+      std::nullopt, {}, &object_dispatch_flags, nullptr, nullptr, &on_finish1,
+      nullptr));
+
+  Context *timer_task = nullptr;
+  expect_schedule_dispatch_delayed_requests(nullptr, &timer_task);
+
+  data.clear();
+  io::DispatchResult dispatch_result;
+  C_SaferCond cond2;
+  Context *on_finish2 = &cond2;
+  C_SaferCond on_dispatched2;
+  ASSERT_TRUE(mock_simple_scheduler_object_dispatch.write(
+      0, 0, std::move(data), mock_image_ctx.get_data_io_context(), 0, 0,
+      std::nullopt, {}, &object_dispatch_flags, nullptr, &dispatch_result,
+      &on_finish2, &on_dispatched2));
+  ASSERT_NE(timer_task, nullptr);
+
+  data.clear();
+  C_SaferCond cond3;
+  Context *on_finish3 = &cond3;
+  ASSERT_FALSE(mock_simple_scheduler_object_dispatch.write(
+      1, 0, std::move(data), mock_image_ctx.get_data_io_context(), 0, 0,
+      std::nullopt, {}, &object_dispatch_flags, nullptr, nullptr, &on_finish3,
+      nullptr));
+
+  data.clear();
+  C_SaferCond cond4;
+  Context *on_finish4 = &cond4;
+  C_SaferCond on_dispatched4;
+  ASSERT_TRUE(mock_simple_scheduler_object_dispatch.write(
+      1, 0, std::move(data), mock_image_ctx.get_data_io_context(), 0, 0,
+      std::nullopt, {}, &object_dispatch_flags, nullptr, &dispatch_result,
+      &on_finish4, &on_dispatched4));
+
+  // both delays have expired -- a single timer run dispatches both objects
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  Context *timer_task2 = nullptr;
+  expect_dispatch_delayed_requests(mock_image_ctx, 0);
+  expect_add_timer_task(&timer_task2);
+  expect_dispatch_delayed_requests(mock_image_ctx, 0);
+  EXPECT_CALL(m_mock_timer, cancel_event(_))
+    .WillOnce(Invoke([](Context *timer_task) {
+                delete timer_task;
+                return true;
+              }));
+
+  run_timer_task(timer_task);
+  ASSERT_EQ(0, on_dispatched2.wait());
+  ASSERT_EQ(0, on_dispatched4.wait());
+
+  on_finish1->complete(0);
+  ASSERT_EQ(0, cond1.wait());
+  on_finish2->complete(0);
+  ASSERT_EQ(0, cond2.wait());
+  on_finish3->complete(0);
+  ASSERT_EQ(0, cond3.wait());
+  on_finish4->complete(0);
+  ASSERT_EQ(0, cond4.wait());
+}
+
 } // namespace io
 } // namespace librbd
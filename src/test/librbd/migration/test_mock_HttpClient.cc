@@ -738,6 +738,71 @@ TEST_F(TestMockMigrationHttpClient, IssuePipelinedRestart) {
   ASSERT_EQ(0, ctx4.wait());
 }
 
+TEST_F(TestMockMigrationHttpClient, IssueConnectionPool) {
+  boost::asio::ip::tcp::socket socket1(*m_image_ctx->asio_engine);
+  C_SaferCond on_connect_ctx1;
+  client_accept(&socket1, false, &on_connect_ctx1);
+
+  MockTestImageCtx mock_test_image_ctx(*m_image_ctx);
+  ASSERT_EQ(0, mock_test_image_ctx.config.set_val(
+    "rbd_migration_http_connections", "2"));
+  MockHttpClient http_client(&mock_test_image_ctx,
+                             get_local_url(URL_SCHEME_HTTP));
+
+  C_SaferCond ctx1;
+  http_client.open(&ctx1);
+  ASSERT_EQ(0, on_connect_ctx1.wait());
+  ASSERT_EQ(0, ctx1.wait());
+
+  boost::asio::ip::tcp::socket socket2(*m_image_ctx->asio_engine);
+  C_SaferCond on_connect_ctx2;
+  client_accept(&socket2, false, &on_connect_ctx2);
+
+  // issue two concurrent get requests -- second should open a new connection
+  EmptyHttpRequest req1;
+  req1.method(boost::beast::http::verb::get);
+
+  C_SaferCond ctx2;
+  HttpResponse res1;
+  http_client.issue(EmptyHttpRequest{req1},
+    [&ctx2, &res1](int r, HttpResponse&& response) mutable {
+      res1 = std::move(response);
+      ctx2.complete(r);
+    });
+
+  EmptyHttpRequest req2;
+  req2.method(boost::beast::http::verb::get);
+
+  C_SaferCond ctx3;
+  HttpResponse res2;
+  http_client.issue(EmptyHttpRequest{req2},
+    [&ctx3, &res2](int r, HttpResponse&& response) mutable {
+      res2 = std::move(response);
+      ctx3.complete(r);
+    });
+
+  client_read_request(socket1, req1);
+  ASSERT_EQ(0, on_connect_ctx2.wait());
+  client_read_request(socket2, req2);
+
+  // responses can be returned out-of-order across connections
+  HttpResponse expected_res2;
+  expected_res2.body() = "test2";
+  client_write_response(socket2, expected_res2);
+  ASSERT_EQ(0, ctx3.wait());
+  ASSERT_EQ(expected_res2, res2);
+
+  HttpResponse expected_res1;
+  expected_res1.body() = "test1";
+  client_write_response(socket1, expected_res1);
+  ASSERT_EQ(0, ctx2.wait());
+  ASSERT_EQ(expected_res1, res1);
+
+  C_SaferCond ctx4;
+  http_client.close(&ctx4);
+  ASSERT_EQ(0, ctx4.wait());
+}
+
 TEST_F(TestMockMigrationHttpClient, ShutdownInFlight) {
   boost::asio::ip::tcp::socket socket(*m_image_ctx->asio_engine);
   C_SaferCond on_connect_ctx;
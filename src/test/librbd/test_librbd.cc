@@ -10175,6 +10175,74 @@ TEST_F(TestLibRBD, ImagePollIO)
 #endif
 }
 
+TEST_F(TestLibRBD, EventSocketPoll)
+{
+  EventSocket event_sock;
+
+  ASSERT_FALSE(event_sock.is_valid());
+  ASSERT_EQ(-EINVAL, event_sock.init(-1, EVENT_SOCKET_TYPE_PIPE));
+  ASSERT_FALSE(event_sock.is_valid());
+
+  ASSERT_EQ(0, event_sock.init(-1, EVENT_SOCKET_TYPE_POLL));
+  ASSERT_TRUE(event_sock.is_valid());
+  ASSERT_EQ(0, event_sock.notify());
+}
+
+TEST_F(TestLibRBD, ImagePollIONoFd)
+{
+  rados_ioctx_t ioctx;
+  rados_ioctx_create(_cluster, m_pool_name.c_str(), &ioctx);
+
+  rbd_image_t image;
+  int order = 0;
+  std::string name = get_temp_image_name();
+  uint64_t size = 2 << 20;
+
+  ASSERT_EQ(0, create_image(ioctx, name.c_str(), size, &order));
+  ASSERT_EQ(0, rbd_open(ioctx, name.c_str(), &image, NULL));
+
+  ASSERT_EQ(0, rbd_set_image_notification(image, -1, EVENT_TYPE_POLL));
+
+  char test_data[TEST_IO_SIZE];
+  char read_data[TEST_IO_SIZE];
+  for (int i = 0; i < TEST_IO_SIZE; ++i) {
+    test_data[i] = (char) (rand() % (126 - 33) + 33);
+  }
+
+  auto reap = [image]() {
+    rbd_completion_t comps[1];
+    int r;
+    while ((r = rbd_poll_io_events(image, comps, 1)) == 0) {
+      std::this_thread::yield();
+    }
+    EXPECT_EQ(1, r);
+    EXPECT_TRUE(rbd_aio_is_complete(comps[0]));
+    r = rbd_aio_get_return_value(comps[0]);
+    rbd_aio_release(comps[0]);
+    return r;
+  };
+
+  for (int i = 0; i < 10; ++i) {
+    rbd_completion_t comp;
+    ASSERT_EQ(0, rbd_aio_create_completion(NULL, NULL, &comp));
+    ASSERT_EQ(0, rbd_aio_write(image, TEST_IO_SIZE * i, TEST_IO_SIZE,
+                               test_data, comp));
+    ASSERT_EQ(0, reap());
+  }
+
+  for (int i = 0; i < 10; ++i) {
+    rbd_completion_t comp;
+    ASSERT_EQ(0, rbd_aio_create_completion(NULL, NULL, &comp));
+    ASSERT_EQ(0, rbd_aio_read(image, TEST_IO_SIZE * i, TEST_IO_SIZE,
+                              read_data, comp));
+    ASSERT_EQ(TEST_IO_SIZE, reap());
+    ASSERT_EQ(0, memcmp(test_data, read_data, TEST_IO_SIZE));
+  }
+
+  ASSERT_EQ(0, rbd_close(image));
+  rados_ioctx_destroy(ioctx);
+}
+
 namespace librbd {
 
 static bool operator==(const image_spec_t &lhs, const image_spec_t &rhs) {
@@ -12,6 +12,8 @@
  */
 
 #include "mon/PGMap.h"
+#include "osd/OSDMap.h"
+#include "global/global_context.h"
 #include "gtest/gtest.h"
 
 #include "include/stringify.h"
@@ -167,3 +169,64 @@ TEST(pgmap, dump_object_stat_sum_2)
   ASSERT_EQ(percentify(0), tbl.get(0, col++));
   ASSERT_EQ(stringify(byte_u_t(avail/pool.size)), tbl.get(0, col++));
 }
+
+TEST(pgmap, incremental_digest)
+{
+  OSDMap osdmap;
+  uuid_d fsid;
+  osdmap.build_simple(g_ceph_context, 1, fsid, 3);
+  for (int i = 0; i < 3; i++) {
+    stringstream ss;
+    ASSERT_LE(0, osdmap.crush->update_device_class(
+		i, i < 2 ? "hdd" : "ssd", "osd." + stringify(i), &ss));
+  }
+
+  PGMap pg_map;
+  {
+    PGMap::Incremental inc;
+    inc.version = pg_map.version + 1;
+    for (int i = 0; i < 3; i++) {
+      osd_stat_t s;
+      s.statfs.total = 100 * (i + 1);
+      inc.update_stat(i, s);
+    }
+    for (unsigned ps = 0; ps < 4; ps++) {
+      pg_stat_t s;
+      s.state = PG_STATE_ACTIVE;
+      s.purged_snaps.insert(1, 10);
+      inc.pg_stat_updates[pg_t(ps, 1)] = s;
+    }
+    pg_map.apply_incremental(g_ceph_context, inc);
+  }
+  bufferlist bl;
+  ASSERT_TRUE(pg_map.encode_digest(osdmap, bl, CEPH_FEATURES_ALL, 10));
+  ASSERT_EQ(600u, pg_map.osd_sum_by_class["hdd"].statfs.total +
+		  pg_map.osd_sum_by_class["ssd"].statfs.total);
+
+  {
+    PGMap::Incremental inc;
+    inc.version = pg_map.version + 1;
+    osd_stat_t s;
+    s.statfs.total = 1000;
+    inc.update_stat(1, s);
+    pg_stat_t ps;
+    ps.state = PG_STATE_ACTIVE;
+    ps.purged_snaps.insert(1, 5);
+    inc.pg_stat_updates[pg_t(0, 1)] = ps;
+    pg_map.apply_incremental(g_ceph_context, inc);
+  }
+  bl.clear();
+  // same osdmap: the digest is updated from the incremental only
+  ASSERT_FALSE(pg_map.encode_digest(osdmap, bl, CEPH_FEATURES_ALL, 10));
+
+  PGMap full = pg_map;
+  full.calc_osd_sum_by_class(osdmap);
+  full.calc_purged_snaps();
+  ASSERT_EQ(full.purged_snaps, pg_map.purged_snaps);
+  ASSERT_EQ(5u, pg_map.purged_snaps[1].size());
+  ASSERT_EQ(full.osd_sum_by_class.size(), pg_map.osd_sum_by_class.size());
+  for (auto& [c, sum] : full.osd_sum_by_class) {
+    ASSERT_EQ(sum.statfs.total, pg_map.osd_sum_by_class[c].statfs.total);
+  }
+  ASSERT_EQ(1100u, pg_map.osd_sum_by_class["hdd"].statfs.total);
+}
@@ -0,0 +1,164 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+// Small reads of one object, issued with `depth` in flight, through
+// librados aio_operate and through neorados from coroutines.  Both go
+// through the same Objecter, so the difference is the cost of the
+// client API itself.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/asio/use_future.hpp>
+#include <boost/system/system_error.hpp>
+
+#include <fmt/format.h>
+
+#include "include/neorados/RADOS.hpp"
+#include "include/rados/librados.hpp"
+#include "include/scope_guard.h"
+
+#include "common/async/blocked_completion.h"
+#include "common/ceph_argparse.h"
+
+#include "global/global_init.h"
+
+#include "test/neorados/common_tests.h"
+
+namespace ba = boost::asio;
+namespace bs = boost::system;
+namespace ca = ceph::async;
+namespace R = neorados;
+
+constexpr int read_len = 4096;
+
+double librados_reads(librados::IoCtx& ioctx, int count, int depth)
+{
+  auto start = ceph::mono_clock::now();
+  std::vector<librados::AioCompletion*> cs;
+  std::vector<ceph::buffer::list> bls(depth);
+  for (int done = 0; done < count; done += depth) {
+    for (int i = 0; i < depth; ++i) {
+      librados::ObjectReadOperation op;
+      op.read(0, read_len, &bls[i], nullptr);
+      cs.push_back(librados::Rados::aio_create_completion());
+      ioctx.aio_operate("obj", cs.back(), &op, nullptr);
+    }
+    for (auto c : cs) {
+      c->wait_for_complete();
+      c->release();
+    }
+    cs.clear();
+  }
+  std::chrono::duration<double> t = ceph::mono_clock::now() - start;
+  return count / t.count();
+}
+
+ba::awaitable<void> read_loop(R::RADOS& r, const R::IOContext& ioc,
+			      int count)
+{
+  const R::Object obj{"obj"};
+  ceph::buffer::list bl;
+  for (int i = 0; i < count; ++i) {
+    R::ReadOp op;
+    bl.clear();
+    op.read(0, read_len, &bl);
+    co_await r.execute(obj, ioc, std::move(op), nullptr, ba::use_awaitable);
+  }
+}
+
+double neorados_reads(R::RADOS& r, const R::IOContext& ioc,
+		      int count, int depth)
+{
+  auto start = ceph::mono_clock::now();
+  std::vector<std::future<void>> fs;
+  for (int i = 0; i < depth; ++i) {
+    fs.push_back(ba::co_spawn(r.get_executor(),
+			      read_loop(r, ioc, count / depth),
+			      ba::use_future));
+  }
+  for (auto& f : fs) {
+    f.get();
+  }
+  std::chrono::duration<double> t = ceph::mono_clock::now() - start;
+  return count / t.count();
+}
+
+int main(int argc, char** argv)
+{
+  using namespace std::literals;
+
+  auto args = argv_to_vec(argc, argv);
+  env_to_vec(args);
+
+  auto cct = global_init(NULL, args, CEPH_ENTITY_TYPE_CLIENT,
+			 CODE_ENVIRONMENT_UTILITY, 0);
+  common_init_finish(cct.get());
+
+  int count = 100'000;
+  int depth = 16;
+  if (auto e = std::getenv("READ_SPEED_COUNT")) {
+    count = std::atoi(e);
+  }
+  if (auto e = std::getenv("READ_SPEED_DEPTH")) {
+    depth = std::max(1, std::atoi(e));
+  }
+
+  try {
+    librados::Rados rados;
+    rados.init_with_context(cct.get());
+    if (int ret = rados.connect(); ret < 0) {
+      throw bs::system_error(-ret, bs::system_category(), "connect");
+    }
+    auto r = R::RADOS::make_with_librados(rados);
+
+    auto pool_name = get_temp_pool_name("ceph_test_neorados_read_speed"sv);
+    r.create_pool(pool_name, std::nullopt, ca::use_blocked);
+    auto pd = make_scope_guard(
+      [&pool_name, &r]() {
+	r.delete_pool(pool_name, ca::use_blocked);
+      });
+    auto pool = r.lookup_pool(pool_name, ca::use_blocked);
+    R::IOContext ioc(pool);
+    {
+      R::WriteOp op;
+      ceph::buffer::list bl;
+      bl.append_zero(read_len);
+      op.write_full(std::move(bl));
+      r.execute(R::Object{"obj"}, ioc, std::move(op), ca::use_blocked);
+    }
+
+    librados::IoCtx ioctx;
+    if (int ret = rados.ioctx_create2(pool, ioctx); ret < 0) {
+      throw bs::system_error(-ret, bs::system_category(), "ioctx_create2");
+    }
+
+    std::cout << fmt::format("{} reads of {} bytes, {} in flight",
+			     count, read_len, depth) << std::endl;
+    std::cout << fmt::format("librados aio_operate: {:.0f} ops/s",
+			     librados_reads(ioctx, count, depth)) << std::endl;
+    std::cout << fmt::format("neorados coroutines:  {:.0f} ops/s",
+			     neorados_reads(r, ioc, count, depth)) << std::endl;
+  } catch (const bs::system_error& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -4,7 +4,9 @@
  * In memory space allocator benchmarks.
  * Author: Igor Fedotov, ifedotov@suse.com
  */
+#include <deque>
 #include <iostream>
+#include <thread>
 #include <boost/scoped_ptr.hpp>
 #include <gtest/gtest.h>
 
@@ -13,6 +15,7 @@
 #include "include/stringify.h"
 #include "include/Context.h"
 #include "os/bluestore/Allocator.h"
+#include "os/bluestore/CachingAllocator.h"
 
 #include <boost/random/uniform_int.hpp>
 typedef boost::mt11213b gen_type;
@@ -362,6 +365,78 @@ TEST_P(AllocTest, mempoolAccounting)
   ASSERT_EQ(mempool::bluestore_alloc::allocated_items(), items);
 }
 
+// Several threads allocating and releasing small extents at once, the
+// way txcs from many PGs hit the allocator; run with and without the
+// per-CPU CachingAllocator front end.
+static void do_mt_bench(Allocator* alloc, uint64_t capacity,
+			uint64_t alloc_unit, unsigned num_threads)
+{
+  const uint64_t ops_per_thread = 1000000;
+  alloc->init_add_free(0, capacity);
+
+  auto worker = [&](unsigned seed) {
+    gen_type rng(seed);
+    boost::uniform_int<> u1(0, 4); // 4K-64K
+    std::deque<PExtentVector> held;
+    for (uint64_t i = 0; i < ops_per_thread; ++i) {
+      PExtentVector tmp;
+      uint64_t want = alloc_unit << u1(rng);
+      auto r = alloc->allocate(want, alloc_unit, 0, 0, &tmp);
+      ASSERT_EQ(r, (int64_t)want);
+      held.emplace_back(std::move(tmp));
+      // keep a sliding window of allocations, released in random order
+      if (held.size() > 256) {
+	std::swap(held[rng() % held.size()], held.front());
+	alloc->release(held.front());
+	held.pop_front();
+      }
+    }
+    for (auto& e : held) {
+      alloc->release(e);
+    }
+  };
+
+  utime_t start = ceph_clock_now();
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < num_threads; ++t) {
+    threads.emplace_back(worker, t + 1);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  auto dur = ceph_clock_now() - start;
+  std::cout << num_threads << " threads x " << ops_per_thread << " ops"
+	    << " executed in " << dur
+	    << " (" << (uint64_t)(num_threads * ops_per_thread / (double)dur)
+	    << " allocs/s)" << std::endl;
+  EXPECT_EQ(alloc->get_free(), capacity);
+  std::cout << "fragmentation " << alloc->get_fragmentation()
+	    << ", score " << alloc->get_fragmentation_score() << std::endl;
+}
+
+TEST_P(AllocTest, test_alloc_bench_mt)
+{
+  uint64_t capacity = uint64_t(64) * 1024 * 1024 * 1024;
+  uint64_t alloc_unit = 4096;
+  unsigned num_threads = std::max(2u, std::thread::hardware_concurrency());
+  init_alloc(capacity, alloc_unit);
+  do_mt_bench(alloc.get(), capacity, alloc_unit, num_threads);
+}
+
+TEST_P(AllocTest, test_alloc_bench_mt_cached)
+{
+  uint64_t capacity = uint64_t(64) * 1024 * 1024 * 1024;
+  uint64_t alloc_unit = 4096;
+  unsigned num_threads = std::max(2u, std::thread::hardware_concurrency());
+  CachingAllocator cached(
+    g_ceph_context,
+    Allocator::create(g_ceph_context, GetParam(), capacity, alloc_unit),
+    num_threads, _1m, 64 * 1024, _1m, "");
+  do_mt_bench(&cached, capacity, alloc_unit, num_threads);
+  cached.drain();
+  EXPECT_EQ(cached.get_backend()->get_free(), capacity);
+}
+
 INSTANTIATE_TEST_SUITE_P(
   Allocator,
   AllocTest,
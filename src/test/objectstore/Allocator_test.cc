@@ -13,6 +13,7 @@
 #include "include/stringify.h"
 #include "include/Context.h"
 #include "os/bluestore/Allocator.h"
+#include "os/bluestore/CachingAllocator.h"
 
 using namespace std;
 
@@ -561,6 +562,56 @@ TEST_P(AllocTest, test_alloc_50656_first_fit)
   EXPECT_EQ(got, 0x400000);
 }
 
+TEST_P(AllocTest, test_caching_allocator)
+{
+  uint64_t block_size = 0x1000;
+  uint64_t capacity = 0x1000 * block_size;
+  CachingAllocator cached(
+    g_ceph_context,
+    Allocator::create(g_ceph_context, GetParam(), capacity, block_size),
+    4, 0x40000, 0x10000, 0x40000, "");
+  cached.init_add_free(0, capacity);
+  ASSERT_EQ(capacity, cached.get_free());
+
+  // drain the device with small allocations; the last ones can only be
+  // served once the other shards give back their runs
+  interval_set<uint64_t> allocated;
+  PExtentVector extents;
+  while (allocated.size() < capacity) {
+    extents.clear();
+    EXPECT_EQ((int64_t)block_size * 2,
+	      cached.allocate(block_size * 2, block_size, 0, 0, &extents));
+    for (auto& e : extents) {
+      ASSERT_FALSE(allocated.intersects(e.offset, e.length));
+      allocated.insert(e.offset, e.length);
+    }
+  }
+  ASSERT_EQ(0u, cached.get_free());
+  extents.clear();
+  EXPECT_LT(cached.allocate(block_size, block_size, 0, 0, &extents), 0);
+
+  // small releases are queued, large ones go straight through, and
+  // both count as free
+  interval_set<uint64_t> small, large;
+  small.insert(0, block_size);
+  large.insert(capacity / 2, capacity / 2);
+  cached.release(small);
+  cached.release(large);
+  EXPECT_EQ(block_size + capacity / 2, cached.get_free());
+
+  // allocations with a different unit bypass the cache
+  extents.clear();
+  EXPECT_EQ((int64_t)block_size * 16,
+	    cached.allocate(block_size * 16, block_size * 16, 0, 0, &extents));
+  for (auto& e : extents) {
+    EXPECT_EQ(0u, e.offset % (block_size * 16));
+  }
+
+  cached.drain();
+  EXPECT_EQ(cached.get_backend()->get_free(), cached.get_free());
+  cached.shutdown();
+}
+
 INSTANTIATE_TEST_SUITE_P(
   Allocator,
   AllocTest,
@@ -24,7 +24,10 @@ using namespace std;
 #include "common/ceph_argparse.h"
 #include "common/debug.h"
 #include "common/Cycles.h"
+#include "common/Cond.h"
+#include "common/errno.h"
 #include "global/global_init.h"
+#include "include/mempool.h"
 #include "os/ObjectStore.h"
 
 class Transaction {
@@ -32,17 +35,37 @@ class Transaction {
   ObjectStore::Transaction t;
 
  public:
+  // ticks and buffers allocated (net of frees, from the buffer_anon
+  // mempool) per stage
   struct Tick {
     uint64_t ticks;
     uint64_t count;
-    Tick(): ticks(0), count(0) {}
-    void add(uint64_t a) {
+    int64_t buffers;
+    Tick(): ticks(0), count(0), buffers(0) {}
+    void add(uint64_t a, int64_t b = 0) {
       ticks += a;
       count++;
+      buffers += b;
+    }
+    void dump(const char *name) const {
+      cerr << " " << name << " op: " << Cycles::to_microseconds(ticks)
+           << "us count: " << count;
+      if (buffers) {
+        cerr << " buffers: " << buffers;
+      }
+      cerr << std::endl;
     }
   };
-  static Tick write_ticks, setattr_ticks, omap_setkeys_ticks, omap_rmkey_ticks;
-  static Tick encode_ticks, decode_ticks, iterate_ticks;
+  static Tick write_ticks, setattr_ticks, setattrs_ticks, clone_ticks;
+  static Tick omap_setkeys_ticks, omap_rmkey_ticks;
+  static Tick encode_ticks, decode_ticks, iterate_ticks, queue_ticks;
+
+  // if set, apply_queue() submits the transaction here
+  static ObjectStore *store;
+
+  static int64_t buffers() {
+    return mempool::buffer_anon::allocated_items();
+  }
 
   void write(coll_t cid, const ghobject_t& oid, uint64_t off, uint64_t len,
              const bufferlist& data) {
@@ -56,6 +79,17 @@ class Transaction {
     t.setattr(cid, oid, name, val);
     setattr_ticks.add(Cycles::rdtsc() - start_time);
   }
+  void setattrs(coll_t cid, const ghobject_t& oid,
+                const map<string, bufferlist, less<>> &attrset) {
+    uint64_t start_time = Cycles::rdtsc();
+    t.setattrs(cid, oid, attrset);
+    setattrs_ticks.add(Cycles::rdtsc() - start_time);
+  }
+  void clone(coll_t cid, const ghobject_t& oid, const ghobject_t& noid) {
+    uint64_t start_time = Cycles::rdtsc();
+    t.clone(cid, oid, noid);
+    clone_ticks.add(Cycles::rdtsc() - start_time);
+  }
   void omap_setkeys(coll_t cid, const ghobject_t &oid,
                     const map<string, bufferlist> &attrset) {
 
@@ -73,14 +107,30 @@ class Transaction {
   void apply_encode_decode() {
     bufferlist bl;
     ObjectStore::Transaction d;
+    int64_t start_buffers = buffers();
     uint64_t start_time = Cycles::rdtsc();
     t.encode(bl);
-    encode_ticks.add(Cycles::rdtsc() - start_time);
+    encode_ticks.add(Cycles::rdtsc() - start_time, buffers() - start_buffers);
 
     auto bliter = bl.cbegin();
+    start_buffers = buffers();
     start_time = Cycles::rdtsc();
     d.decode(bliter);
-    decode_ticks.add(Cycles::rdtsc() - start_time);
+    decode_ticks.add(Cycles::rdtsc() - start_time, buffers() - start_buffers);
+  }
+
+  // submit to the store and wait for the commit; consumes the transaction
+  void apply_queue(ObjectStore::CollectionHandle& ch) {
+    if (!store) {
+      return;
+    }
+    C_SaferCond c;
+    t.register_on_commit(&c);
+    int64_t start_buffers = buffers();
+    uint64_t start_time = Cycles::rdtsc();
+    store->queue_transaction(ch, std::move(t));
+    c.wait();
+    queue_ticks.add(Cycles::rdtsc() - start_time, buffers() - start_buffers);
   }
 
   void apply_iterate() {
@@ -107,6 +157,19 @@ class Transaction {
           to_set[name] = bufferptr(bl.c_str(), bl.length());
         }
         break;
+      case ObjectStore::Transaction::OP_SETATTRS:
+        {
+          ghobject_t oid = i.get_oid(op->oid);
+          map<string, bufferptr> aset;
+          i.decode_attrset(aset);
+        }
+        break;
+      case ObjectStore::Transaction::OP_CLONE:
+        {
+          ghobject_t oid = i.get_oid(op->oid);
+          ghobject_t noid = i.get_oid(op->dest_oid);
+        }
+        break;
       case ObjectStore::Transaction::OP_OMAP_SETKEYS:
         {
           ghobject_t oid = i.get_oid(op->oid);
@@ -127,13 +190,18 @@ class Transaction {
   }
 
   static void dump_stat() {
-    cerr << " write op: " << Cycles::to_microseconds(write_ticks.ticks) << "us count: " << write_ticks.count << std::endl;
-    cerr << " setattr op: " << Cycles::to_microseconds(setattr_ticks.ticks) << "us count: " << setattr_ticks.count << std::endl;
-    cerr << " omap_setkeys op: " << Cycles::to_microseconds(Transaction::omap_setkeys_ticks.ticks) << "us count: " << Transaction::omap_setkeys_ticks.count << std::endl;
-    cerr << " omap_rmkey op: " << Cycles::to_microseconds(Transaction::omap_rmkey_ticks.ticks) << "us count: " << Transaction::omap_rmkey_ticks.count << std::endl;
-    cerr << " encode op: " << Cycles::to_microseconds(Transaction::encode_ticks.ticks) << "us count: " << Transaction::encode_ticks.count << std::endl;
-    cerr << " decode op: " << Cycles::to_microseconds(Transaction::decode_ticks.ticks) << "us count: " << Transaction::decode_ticks.count << std::endl;
-    cerr << " iterate op: " << Cycles::to_microseconds(Transaction::iterate_ticks.ticks) << "us count: " << Transaction::iterate_ticks.count << std::endl;
+    write_ticks.dump("write");
+    setattr_ticks.dump("setattr");
+    setattrs_ticks.dump("setattrs");
+    clone_ticks.dump("clone");
+    omap_setkeys_ticks.dump("omap_setkeys");
+    omap_rmkey_ticks.dump("omap_rmkey");
+    encode_ticks.dump("encode");
+    decode_ticks.dump("decode");
+    iterate_ticks.dump("iterate");
+    if (store) {
+      queue_ticks.dump("queue_transaction");
+    }
   }
 };
 
@@ -150,6 +218,7 @@ class PerfCase {
   static const ghobject_t pglog_oid;
   static const ghobject_t info_oid;
   map<string, bufferlist> data;
+  ObjectStore::CollectionHandle ch, meta_ch;
 
   ghobject_t create_object() {
     bufferlist bl = generate_random(100, 1);
@@ -185,39 +254,129 @@ class PerfCase {
     data[pglog_attr] = generate_random(128, 1);
     data[info_epoch_attr] = generate_random(4, 1);
     data[info_info_attr] = generate_random(560, 1);
+    data["omap"] = generate_random(128, 1);
+  }
+
+  // create the collections and the pg meta objects the cases expect
+  int open_store(ObjectStore *store) {
+    Transaction::store = store;
+    meta_ch = store->create_new_collection(meta_cid);
+    ch = store->create_new_collection(cid);
+    ObjectStore::Transaction t;
+    t.create_collection(meta_cid, 0);
+    t.create_collection(cid, 0);
+    t.touch(meta_cid, pglog_oid);
+    t.touch(meta_cid, info_oid);
+    return store->queue_transaction(meta_ch, std::move(t));
+  }
+
+  void close_store() {
+    ch.reset();
+    meta_ch.reset();
+    Transaction::store = nullptr;
+  }
+
+  // the pg log and info update that goes with every rados write
+  uint64_t pg_meta_update() {
+    Transaction t;
+    map<string, bufferlist> pglog_attrset;
+    map<string, bufferlist> info_attrset;
+    pglog_attrset[pglog_attr] = data[pglog_attr];
+    info_attrset[info_epoch_attr] = data[info_epoch_attr];
+    info_attrset[info_info_attr] = data[info_info_attr];
+    uint64_t start_time = Cycles::rdtsc();
+    t.omap_setkeys(meta_cid, pglog_oid, pglog_attrset);
+    t.omap_setkeys(meta_cid, info_oid, info_attrset);
+    t.omap_rmkey(meta_cid, pglog_oid, pglog_attr);
+    t.apply_encode_decode();
+    t.apply_iterate();
+    t.apply_queue(meta_ch);
+    return Cycles::rdtsc() - start_time;
   }
 
   uint64_t rados_write_4k(int times) {
     uint64_t ticks = 0;
     uint64_t len = Kib *4;
     for (int i = 0; i < times; i++) {
-      uint64_t start_time = 0;
       {
         Transaction t;
         ghobject_t oid = create_object();
-        start_time = Cycles::rdtsc();
+        uint64_t start_time = Cycles::rdtsc();
         t.write(cid, oid, 0, len, data["4k"]);
         t.setattr(cid, oid, attr, data[attr]);
         t.setattr(cid, oid, snapset_attr, data[snapset_attr]);
         t.apply_encode_decode();
         t.apply_iterate();
+        t.apply_queue(ch);
         ticks += Cycles::rdtsc() - start_time;
       }
+      ticks += pg_meta_update();
+    }
+    return ticks;
+  }
+
+  // overwrite of a snapshotted object: the head is cloned first
+  uint64_t rados_clone_4k(int times) {
+    uint64_t ticks = 0;
+    uint64_t len = Kib *4;
+    for (int i = 0; i < times; i++) {
       {
         Transaction t;
-        map<string, bufferlist> pglog_attrset;
-        map<string, bufferlist> info_attrset;
-        pglog_attrset[pglog_attr] = data[pglog_attr];
-        info_attrset[info_epoch_attr] = data[info_epoch_attr];
-        info_attrset[info_info_attr] = data[info_info_attr];
-        start_time = Cycles::rdtsc();
-        t.omap_setkeys(meta_cid, pglog_oid, pglog_attrset);
-        t.omap_setkeys(meta_cid, info_oid, info_attrset);
-        t.omap_rmkey(meta_cid, pglog_oid, pglog_attr);
+        ghobject_t oid = create_object();
+        oid.hobj.snap = CEPH_NOSNAP;
+        ghobject_t clone_oid = oid;
+        clone_oid.hobj.snap = i + 1;
+        uint64_t start_time = Cycles::rdtsc();
+        t.write(cid, oid, 0, len, data["4k"]);
+        t.clone(cid, oid, clone_oid);
+        t.write(cid, oid, 0, len, data["4k"]);
+        t.setattr(cid, oid, attr, data[attr]);
+        t.setattr(cid, oid, snapset_attr, data[snapset_attr]);
         t.apply_encode_decode();
         t.apply_iterate();
+        t.apply_queue(ch);
         ticks += Cycles::rdtsc() - start_time;
       }
+      ticks += pg_meta_update();
+    }
+    return ticks;
+  }
+
+  // many small keys per transaction, as with pg log entries
+  uint64_t omap_setkeys_32(int times) {
+    uint64_t ticks = 0;
+    for (int i = 0; i < times; i++) {
+      Transaction t;
+      map<string, bufferlist> attrset;
+      for (int k = 0; k < 32; k++) {
+        char key[32];
+        snprintf(key, sizeof(key), "%010d.%02d", i, k);
+        attrset[key] = data["omap"];
+      }
+      uint64_t start_time = Cycles::rdtsc();
+      t.omap_setkeys(meta_cid, pglog_oid, attrset);
+      t.apply_encode_decode();
+      t.apply_iterate();
+      t.apply_queue(meta_ch);
+      ticks += Cycles::rdtsc() - start_time;
+    }
+    return ticks;
+  }
+
+  uint64_t setattrs_8(int times) {
+    uint64_t ticks = 0;
+    map<string, bufferlist, less<>> attrset;
+    for (int k = 0; k < 8; k++) {
+      attrset["attr_" + std::to_string(k)] = data[attr];
+    }
+    for (int i = 0; i < times; i++) {
+      Transaction t;
+      uint64_t start_time = Cycles::rdtsc();
+      t.setattrs(meta_cid, info_oid, attrset);
+      t.apply_encode_decode();
+      t.apply_iterate();
+      t.apply_queue(meta_ch);
+      ticks += Cycles::rdtsc() - start_time;
     }
     return ticks;
   }
@@ -228,14 +387,19 @@ const string PerfCase::attr("_");
 const string PerfCase::snapset_attr("snapset");
 const string PerfCase::pglog_attr("pglog_attr");
 const coll_t PerfCase::meta_cid;
-const coll_t PerfCase::cid;
+const coll_t PerfCase::cid(spg_t(pg_t(0, 0), shard_id_t::NO_SHARD));
 const ghobject_t PerfCase::pglog_oid(hobject_t(sobject_t(object_t("cid_pglog"), 0)));
 const ghobject_t PerfCase::info_oid(hobject_t(sobject_t(object_t("infos"), 0)));
-Transaction::Tick Transaction::write_ticks, Transaction::setattr_ticks, Transaction::omap_setkeys_ticks, Transaction::omap_rmkey_ticks;
-Transaction::Tick Transaction::encode_ticks, Transaction::decode_ticks, Transaction::iterate_ticks;
+Transaction::Tick Transaction::write_ticks, Transaction::setattr_ticks, Transaction::setattrs_ticks, Transaction::clone_ticks;
+Transaction::Tick Transaction::omap_setkeys_ticks, Transaction::omap_rmkey_ticks;
+Transaction::Tick Transaction::encode_ticks, Transaction::decode_ticks, Transaction::iterate_ticks, Transaction::queue_ticks;
+ObjectStore *Transaction::store = nullptr;
 
 void usage(const string &name) {
-  cerr << "Usage: " << name << " [times] "
+  cerr << "Usage: " << name << " times [case [store_type data_dir]]\n"
+       << "  case: write_4k (default), clone_4k, omap, setattrs\n"
+       << "  with store_type (e.g. memstore, bluestore) and an empty data_dir\n"
+       << "  the transactions are also queued to a freshly created store"
        << std::endl;
 }
 
@@ -257,10 +421,51 @@ int main(int argc, char **argv)
   }
 
   uint64_t times = atoi(args[0]);
+  string name = args.size() > 1 ? args[1] : "write_4k";
+  if (name != "write_4k" && name != "clone_4k" && name != "omap" &&
+      name != "setattrs") {
+    usage(argv[0]);
+    return 1;
+  }
   PerfCase c;
-  uint64_t ticks = c.rados_write_4k(times);
+  std::unique_ptr<ObjectStore> store;
+  if (args.size() > 3) {
+    store = ObjectStore::create(g_ceph_context, args[2], args[3],
+                                string(args[3]) + ".journal");
+    if (!store) {
+      cerr << "unknown store type " << args[2] << std::endl;
+      return 1;
+    }
+    int r = store->mkfs();
+    if (r == 0) {
+      r = store->mount();
+    }
+    if (r == 0) {
+      r = c.open_store(store.get());
+    }
+    if (r < 0) {
+      cerr << "failed to set up " << args[2] << " at " << args[3] << ": "
+           << cpp_strerror(r) << std::endl;
+      return 1;
+    }
+  }
+
+  uint64_t ticks;
+  if (name == "write_4k") {
+    ticks = c.rados_write_4k(times);
+  } else if (name == "clone_4k") {
+    ticks = c.rados_clone_4k(times);
+  } else if (name == "omap") {
+    ticks = c.omap_setkeys_32(times);
+  } else {
+    ticks = c.setattrs_8(times);
+  }
   Transaction::dump_stat();
-  cerr << " Total rados op " << times << " run time " << Cycles::to_microseconds(ticks) << "us." << std::endl;
+  cerr << " Total " << name << " op " << times << " run time " << Cycles::to_microseconds(ticks) << "us." << std::endl;
 
+  if (store) {
+    c.close_store();
+    store->umount();
+  }
   return 0;
 }
@@ -1266,6 +1266,87 @@ TEST_P(StoreTest, CompressionTest) {
   doCompressionTest();
 }
 
+TEST_P(StoreTestSpecificAUSize, CompressionSampleTest) {
+  if (string(GetParam()) != "bluestore")
+    return;
+  if (smr) {
+    cout << "SKIP: smr" << std::endl;
+    return;
+  }
+
+  SetVal(g_conf(), "bluestore_compression_algorithm", "snappy");
+  SetVal(g_conf(), "bluestore_compression_mode", "force");
+  SetVal(g_conf(), "bluestore_compression_min_blob_size", "65536");
+  SetVal(g_conf(), "bluestore_compression_sample_size", "4096");
+  g_conf().apply_changes(nullptr);
+  StartDeferred(4096);
+
+  int r;
+  coll_t cid;
+  ghobject_t hoid(hobject_t(sobject_t("Object 1", CEPH_NOSNAP)));
+  const PerfCounters* logger = store->get_perf_counters();
+  auto ch = store->create_new_collection(cid);
+  {
+    ObjectStore::Transaction t;
+    t.create_collection(cid, 0);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+
+  bufferlist noise, text;
+  {
+    gen_type rng(0);
+    boost::uniform_int<> byte(0, 255);
+    string s(0x20000, 0);
+    for (auto& c : s) {
+      c = byte(rng);
+    }
+    noise.append(s);
+    text.append(string(0x20000, 'a'));
+  }
+
+  auto sample_rejected = logger->get(l_bluestore_compress_sample_rejected_count);
+  auto success = logger->get(l_bluestore_compress_success_count);
+  {
+    ObjectStore::Transaction t;
+    t.write(cid, hoid, 0, noise.length(), noise);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  ASSERT_LT(sample_rejected, logger->get(l_bluestore_compress_sample_rejected_count));
+  ASSERT_EQ(success, logger->get(l_bluestore_compress_success_count));
+  {
+    bufferlist in;
+    r = store->read(ch, hoid, 0, noise.length(), in);
+    ASSERT_EQ((int)noise.length(), r);
+    ASSERT_TRUE(bl_eq(noise, in));
+  }
+
+  sample_rejected = logger->get(l_bluestore_compress_sample_rejected_count);
+  {
+    ObjectStore::Transaction t;
+    t.write(cid, hoid, 0, text.length(), text);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  ASSERT_EQ(sample_rejected, logger->get(l_bluestore_compress_sample_rejected_count));
+  ASSERT_LT(success, logger->get(l_bluestore_compress_success_count));
+  {
+    bufferlist in;
+    r = store->read(ch, hoid, 0, text.length(), in);
+    ASSERT_EQ((int)text.length(), r);
+    ASSERT_TRUE(bl_eq(text, in));
+  }
+
+  {
+    ObjectStore::Transaction t;
+    t.remove(cid, hoid);
+    t.remove_collection(cid);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+}
+
 TEST_P(StoreTest, SimpleObjectTest) {
   int r;
   coll_t cid;
@@ -2892,6 +2973,60 @@ TEST_P(StoreTest, ZeroLengthWrite) {
   ASSERT_EQ(0, r);
 }
 
+TEST_P(StoreTest, ReadDigest) {
+  int r;
+  coll_t cid;
+  ghobject_t hoid(hobject_t(sobject_t("foo", CEPH_NOSNAP)));
+  auto ch = store->create_new_collection(cid);
+  {
+    ObjectStore::Transaction t;
+    t.create_collection(cid, 0);
+    t.touch(cid, hoid);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  auto make_data = [](unsigned len) {
+    bufferlist bl;
+    bufferptr bp(len);
+    for (unsigned i = 0; i < len; ++i) {
+      bp[i] = rand();
+    }
+    bl.append(bp);
+    return bl;
+  };
+  {
+    // aligned extent, unaligned overwrite inside it, and a hole before an
+    // unaligned tail
+    ObjectStore::Transaction t;
+    t.write(cid, hoid, 0, 65536, make_data(65536));
+    t.write(cid, hoid, 4000, 100, make_data(100));
+    t.write(cid, hoid, 70001, 3000, make_data(3000));
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+  const std::pair<uint64_t, size_t> ranges[] = {
+    {0, 0}, {0, 4096}, {1, 8191}, {3000, 2000}, {0, 65536},
+    {60000, 12000}, {65536, 8192}, {0, 1048576}, {80000, 100},
+  };
+  for (auto [off, len] : ranges) {
+    bufferlist expected, bl;
+    r = store->read(ch, hoid, off, len, expected);
+    ASSERT_GE(r, 0);
+    uint32_t crc = -1;
+    r = store->read_digest(ch, hoid, off, len, bl, &crc);
+    ASSERT_EQ(r, (int)expected.length());
+    ASSERT_TRUE(bl.contents_equal(expected));
+    ASSERT_EQ(expected.crc32c(-1), crc) << "off " << off << " len " << len;
+  }
+  {
+    ObjectStore::Transaction t;
+    t.remove(cid, hoid);
+    t.remove_collection(cid);
+    r = queue_transaction(store, ch, std::move(t));
+    ASSERT_EQ(r, 0);
+  }
+}
+
 TEST_P(StoreTest, ZeroLengthZero) {
   int r;
   coll_t cid;
@@ -13,6 +13,7 @@
 #include "common/errno.h"
 
 #include "blk/BlockDevice.h"
+#include "blk/kernel/io_uring.h"
 
 using namespace std;
 
@@ -91,6 +92,110 @@ TEST(KernelDevice, Ticket45337) {
   b->close();
 }
 
+static const uint64_t bench_size = 256ull << 20;
+
+// Random aligned reads through the aio path, checked against the data
+// written; prints the achieved IOPS so the libaio, io_uring (optionally
+// with registered buffers) and SPDK backends can be compared.
+static void random_read_bench(const std::string& path,
+			      const std::string& label)
+{
+  const uint64_t size = bench_size;
+  const uint64_t io_size = 4096;
+  const unsigned qd = 32;
+  const unsigned rounds = 512;
+
+  std::unique_ptr<BlockDevice> b(
+    BlockDevice::create(g_ceph_context, path, NULL, NULL,
+      [](void* handle, void* aio) {}, NULL));
+  ASSERT_EQ(b->open(path), 0);
+
+  // stamp every block with its own offset
+  {
+    bufferlist bl;
+    for (uint64_t off = 0; off < size; off += io_size) {
+      bufferptr p = ceph::buffer::create_small_page_aligned(io_size);
+      p.zero();
+      memcpy(p.c_str(), &off, sizeof(off));
+      bl.append(p);
+    }
+    IOContext ioc(g_ceph_context, NULL);
+    ASSERT_EQ(b->aio_write(0, bl, &ioc, false), 0);
+    if (ioc.has_pending_aios()) {
+      b->aio_submit(&ioc);
+      ioc.aio_wait();
+    }
+    b->flush();
+  }
+
+  auto start = mono_clock::now();
+  for (unsigned r = 0; r < rounds; ++r) {
+    IOContext ioc(g_ceph_context, NULL);
+    std::vector<std::pair<uint64_t, bufferlist>> reads(qd);
+    for (auto& [off, bl] : reads) {
+      off = (rand() % (size / io_size)) * io_size;
+      ASSERT_EQ(b->aio_read(off, io_size, &bl, &ioc), 0);
+    }
+    b->aio_submit(&ioc);
+    ioc.aio_wait();
+    for (auto& [off, bl] : reads) {
+      uint64_t stamp;
+      memcpy(&stamp, bl.c_str(), sizeof(stamp));
+      ASSERT_EQ(off, stamp);
+    }
+  }
+  auto dur = ceph::to_seconds<double>(mono_clock::now() - start);
+  std::cout << label << ": " << rounds * qd << " x " << io_size << "B random reads at qd "
+	    << qd << " in " << dur << "s, "
+	    << (uint64_t)(rounds * qd / dur) << " IOPS" << std::endl;
+  b->close();
+}
+
+static void kernel_random_read_bench(const std::string& ioring,
+				     const std::string& registered_buffers)
+{
+  TempBdev bdev{ bench_size };
+
+  g_ceph_context->_conf.set_val_or_die("bdev_ioring", ioring);
+  g_ceph_context->_conf.set_val_or_die("bdev_ioring_registered_buffers",
+				       registered_buffers);
+  g_ceph_context->_conf.apply_changes(nullptr);
+
+  random_read_bench(bdev.path,
+		    "bdev_ioring=" + ioring +
+		    " bdev_ioring_registered_buffers=" + registered_buffers);
+}
+
+TEST(KernelDevice, RandomReadLibaio) {
+  kernel_random_read_bench("false", "0");
+}
+
+TEST(KernelDevice, RandomReadIoring) {
+  if (!ioring_queue_t::supported()) {
+    GTEST_SKIP() << "io_uring is not supported";
+  }
+  kernel_random_read_bench("true", "0");
+}
+
+TEST(KernelDevice, RandomReadIoringRegisteredBuffers) {
+  if (!ioring_queue_t::supported()) {
+    GTEST_SKIP() << "io_uring is not supported";
+  }
+  kernel_random_read_bench("true", "64");
+}
+
+#if defined(HAVE_SPDK)
+// Needs a dedicated NVMe device; CEPH_TEST_SPDK_BDEV names an spdk: block
+// file for it.  The first 256 MB of the device are overwritten.
+TEST(NVMEDevice, RandomRead) {
+  const char *path = getenv("CEPH_TEST_SPDK_BDEV");
+  if (!path) {
+    GTEST_SKIP() << "CEPH_TEST_SPDK_BDEV is not set";
+  }
+  random_read_bench(path, "spdk");
+}
+#endif
+
 int main(int argc, char **argv) {
   auto args = argv_to_vec(argc, argv);
   map<string,string> defaults = {
@@ -1174,6 +1174,20 @@ TEST_F(RocksDBResharding, all_to_shards_and_back_again) {
   db->close();
 }
 
+TEST_F(RocksDBResharding, throttled) {
+  ASSERT_EQ(0, db->create_and_open(cout, ""));
+  generate_data();
+  data_to_db();
+  check_db();
+  db->close();
+  RocksDBStore::resharding_ctrl ctrl;
+  ctrl.bytes_per_sec = 100 << 20;
+  ASSERT_EQ(db->reshard("Evade(4)", &ctrl), 0);
+  ASSERT_EQ(db->open(cout), 0);
+  check_db();
+  db->close();
+}
+
 TEST_F(RocksDBResharding, resume_interrupted_at_batch) {
   ASSERT_EQ(0, db->create_and_open(cout, ""));
   generate_data();
@@ -21,6 +21,316 @@
 
 using namespace std;
 
+namespace {
+/// k=3, m=2 code that is linear over GF(2): p0 = d0^d1^d2, p1 = d0^rot(d1)
+class ErasureCodeLinearTest final : public ceph::ErasureCodeInterface {
+  static constexpr unsigned K = 3, M = 2;
+  ceph::ErasureCodeProfile profile;
+  std::vector<int> mapping;
+public:
+  explicit ErasureCodeLinearTest(ceph::ErasureCodeProfile p = {})
+    : profile(std::move(p)) {}
+  int init(ceph::ErasureCodeProfile &p, std::ostream *ss) override { return 0; }
+  const ceph::ErasureCodeProfile &get_profile() const override { return profile; }
+  int create_rule(const std::string &name, CrushWrapper &crush,
+		  std::ostream *ss) const override { return 0; }
+  unsigned int get_chunk_count() const override { return K + M; }
+  unsigned int get_data_chunk_count() const override { return K; }
+  unsigned int get_coding_chunk_count() const override { return M; }
+  int get_sub_chunk_count() override { return 1; }
+  unsigned int get_chunk_size(unsigned int object_size) const override {
+    return object_size / K;
+  }
+  int minimum_to_decode(const std::set<int> &, const std::set<int> &,
+			std::map<int, std::vector<std::pair<int, int>>> *) override {
+    return -EOPNOTSUPP;
+  }
+  int minimum_to_decode_with_cost(const std::set<int> &,
+				  const std::map<int, int> &,
+				  std::set<int> *) override {
+    return -EOPNOTSUPP;
+  }
+  int encode(const std::set<int> &want, const bufferlist &in,
+	     std::map<int, bufferlist> *encoded) override {
+    const unsigned cs = get_chunk_size(in.length());
+    bufferlist copy(in);
+    const char *d = copy.c_str();
+    for (int shard : want) {
+      bufferptr out(cs);
+      for (unsigned i = 0; i < cs; ++i) {
+	uint8_t d0 = d[i], d1 = d[cs + i], d2 = d[2 * cs + i];
+	switch (shard) {
+	case 3: out[i] = d0 ^ d1 ^ d2; break;
+	case 4: out[i] = d0 ^ (uint8_t)((d1 << 1) | (d1 >> 7)); break;
+	default: out[i] = d[shard * cs + i];
+	}
+      }
+      // write into the buffer the caller provided, if any
+      bufferlist &chunk = (*encoded)[shard];
+      if (chunk.length() == cs && chunk.is_contiguous()) {
+	memcpy(chunk.c_str(), out.c_str(), cs);
+      } else {
+	chunk.append(out);
+      }
+    }
+    return 0;
+  }
+  int encode_chunks(const std::set<int> &, std::map<int, bufferlist> *) override {
+    return -EOPNOTSUPP;
+  }
+  int decode(const std::set<int> &, const std::map<int, bufferlist> &,
+	     std::map<int, bufferlist> *, int) override {
+    return -EOPNOTSUPP;
+  }
+  int decode_chunks(const std::set<int> &, const std::map<int, bufferlist> &,
+		    std::map<int, bufferlist> *) override {
+    return -EOPNOTSUPP;
+  }
+  const std::vector<int> &get_chunk_mapping() const override { return mapping; }
+  int decode_concat(const std::map<int, bufferlist> &, bufferlist *) override {
+    return -EOPNOTSUPP;
+  }
+};
+} // anonymous namespace
+
+TEST(ECUtil, parity_delta)
+{
+  const uint64_t chunk_size = 64;
+  ECUtil::stripe_info_t sinfo(3, 3 * chunk_size);
+  ceph::ErasureCodeInterfaceRef ec(new ErasureCodeLinearTest);
+
+  // two stripes of random data
+  bufferlist data;
+  for (unsigned i = 0; i < 2 * sinfo.get_stripe_width(); ++i) {
+    data.append((char)rand());
+  }
+  const std::set<int> parity_shards = {3, 4};
+  std::map<int, bufferlist> old_parity;
+  ASSERT_EQ(0, ECUtil::encode(sinfo, ec, data, parity_shards, &old_parity));
+
+  // overwrite data chunk 1 of both stripes
+  bufferlist old_chunk, new_chunk;
+  for (unsigned s = 0; s < 2; ++s) {
+    bufferlist bl;
+    bl.substr_of(data, s * sinfo.get_stripe_width() + chunk_size, chunk_size);
+    old_chunk.append(bl);
+  }
+  bufferlist new_data;
+  for (unsigned s = 0; s < 2; ++s) {
+    bufferlist head, tail;
+    head.substr_of(data, s * sinfo.get_stripe_width(), chunk_size);
+    tail.substr_of(data, s * sinfo.get_stripe_width() + 2 * chunk_size,
+		   chunk_size);
+    bufferptr updated(chunk_size);
+    for (unsigned i = 0; i < chunk_size; ++i) {
+      updated[i] = (char)rand();
+    }
+    new_chunk.append(updated);
+    new_data.append(head);
+    new_data.append(updated);
+    new_data.append(tail);
+  }
+
+  std::map<int, bufferlist> delta;
+  ASSERT_EQ(0, ECUtil::encode_parity_delta(
+	      sinfo, ec, 1, old_chunk, new_chunk, &delta));
+  ASSERT_EQ(parity_shards.size(), delta.size());
+
+  std::map<int, bufferlist> expected;
+  ASSERT_EQ(0, ECUtil::encode(sinfo, ec, new_data, parity_shards, &expected));
+  ECUtil::apply_parity_delta(delta, &old_parity);
+  for (int shard : parity_shards) {
+    ASSERT_TRUE(old_parity[shard].contents_equal(expected[shard]))
+      << "shard " << shard;
+  }
+}
+
+TEST(ECUtil, supports_parity_delta)
+{
+  ASSERT_TRUE(ECUtil::supports_parity_delta({{"plugin", "jerasure"}}));
+  ASSERT_TRUE(ECUtil::supports_parity_delta(
+		{{"plugin", "isa"}, {"technique", "cauchy"}}));
+  ASSERT_FALSE(ECUtil::supports_parity_delta(
+		 {{"plugin", "jerasure"}, {"technique", "liberation"}}));
+  ASSERT_FALSE(ECUtil::supports_parity_delta({{"plugin", "clay"}}));
+  ASSERT_FALSE(ECUtil::supports_parity_delta({{"plugin", "lrc"}}));
+}
+
+TEST(ECUtil, encode_workers)
+{
+  const uint64_t chunk_size = 64;
+  ECUtil::stripe_info_t sinfo(3, 3 * chunk_size);
+  // profile of a plugin whose encode may run concurrently
+  ceph::ErasureCodeInterfaceRef ec(
+    new ErasureCodeLinearTest(ceph::ErasureCodeProfile{{"plugin", "jerasure"}}));
+
+  bufferlist data;
+  for (unsigned i = 0; i < 17 * sinfo.get_stripe_width(); ++i) {
+    data.append((char)rand());
+  }
+  const std::set<int> want = {0, 1, 2, 3, 4};
+  std::map<int, bufferlist> inline_out;
+  ASSERT_EQ(1u, ECUtil::EncodeWorkers::instance().get_batches(
+	      data.length(), 17));
+  ASSERT_EQ(0, ECUtil::encode(sinfo, ec, data, want, &inline_out));
+
+  ECUtil::EncodeWorkers::instance().start(3, 4 * sinfo.get_stripe_width());
+  ASSERT_EQ(1u, ECUtil::EncodeWorkers::instance().get_batches(
+	      sinfo.get_stripe_width(), 1));
+  ASSERT_EQ(4u, ECUtil::EncodeWorkers::instance().get_batches(
+	      data.length(), 17));
+  for (unsigned run = 0; run < 10; ++run) {
+    std::map<int, bufferlist> out;
+    ASSERT_EQ(0, ECUtil::encode(sinfo, ec, data, want, &out));
+    ASSERT_EQ(inline_out.size(), out.size());
+    for (auto &&i : inline_out) {
+      ASSERT_TRUE(i.second.contents_equal(out[i.first])) << i.first;
+    }
+  }
+  ECUtil::EncodeWorkers::instance().stop();
+}
+
+TEST(ECUtil, encode_into_provided_buffers)
+{
+  const uint64_t chunk_size = 64;
+  const unsigned stripes = 17;
+  ECUtil::stripe_info_t sinfo(3, 3 * chunk_size);
+  ceph::ErasureCodeInterfaceRef ec(
+    new ErasureCodeLinearTest(ceph::ErasureCodeProfile{{"plugin", "jerasure"}}));
+  ceph::ErasureCodeInterfaceRef unknown(new ErasureCodeLinearTest());
+
+  bufferlist data;
+  for (unsigned i = 0; i < stripes * sinfo.get_stripe_width(); ++i) {
+    data.append((char)rand());
+  }
+  const std::set<int> want = {0, 1, 2, 3, 4};
+  std::map<int, bufferlist> out, expected;
+  ASSERT_EQ(0, ECUtil::encode(sinfo, ec, data, want, &out));
+  ASSERT_EQ(0, ECUtil::encode(sinfo, unknown, data, want, &expected));
+  ASSERT_EQ(expected.size(), out.size());
+  for (auto &&[shard, bl] : expected) {
+    ASSERT_TRUE(bl.contents_equal(out[shard])) << shard;
+  }
+  // every stripe's coding chunk landed in one buffer per shard
+  ASSERT_EQ(1u, out[3].get_num_buffers());
+  ASSERT_EQ(1u, out[4].get_num_buffers());
+  ASSERT_EQ(stripes, expected[3].get_num_buffers());
+}
+
+TEST(ECUtil, HashInfo_append)
+{
+  const unsigned shards = 12;
+  ECUtil::HashInfo batched(shards);
+  std::vector<uint32_t> expected(shards, -1);
+  for (unsigned append = 0; append < 8; ++append) {
+    // give every shard a different buffer layout
+    std::map<int, bufferlist> to_append;
+    const unsigned len = 4096 + append * 3;
+    for (unsigned shard = 0; shard < shards; ++shard) {
+      bufferlist &bl = to_append[shard];
+      for (unsigned off = 0; off < len; ) {
+	unsigned piece = std::min(len - off, 1 + (shard * 97 + off) % 1500);
+	bufferptr p(piece);
+	for (unsigned i = 0; i < piece; ++i) {
+	  p[i] = (char)rand();
+	}
+	bl.append(p);
+	off += piece;
+      }
+      expected[shard] = bl.crc32c(expected[shard]);
+    }
+    batched.append(batched.get_total_chunk_size(), to_append);
+  }
+  for (unsigned shard = 0; shard < shards; ++shard) {
+    ASSERT_EQ(expected[shard], batched.get_chunk_hash(shard)) << shard;
+  }
+
+  ECUtil::HashInfo cleared(shards);
+  cleared.set_total_chunk_size_clear_hash(0);
+  std::map<int, bufferlist> to_append;
+  to_append[0].append_zero(4096);
+  cleared.append(0, to_append);
+  ASSERT_FALSE(cleared.has_chunk_hash());
+  ASSERT_EQ(4096u, cleared.get_total_chunk_size());
+}
+
+TEST(ECUtil, HashInfo_append_perf)
+{
+  // many small appends to a wide profile, as from multipart uploads
+  const unsigned shards = 20;
+  const unsigned chunk_size = 4096;
+  const unsigned appends = 2000;
+  std::map<int, bufferlist> to_append;
+  for (unsigned shard = 0; shard < shards; ++shard) {
+    bufferptr p(chunk_size);
+    for (unsigned i = 0; i < chunk_size; ++i) {
+      p[i] = (char)rand();
+    }
+    to_append[shard].append(p);
+  }
+
+  std::vector<uint32_t> per_shard(shards, -1);
+  auto start = ceph::mono_clock::now();
+  for (unsigned i = 0; i < appends; ++i) {
+    for (auto &&[shard, bl] : to_append) {
+      bl.invalidate_crc();
+      per_shard[shard] = bl.crc32c(per_shard[shard]);
+    }
+  }
+  auto per_shard_time = ceph::mono_clock::now() - start;
+
+  ECUtil::HashInfo hinfo(shards);
+  start = ceph::mono_clock::now();
+  for (unsigned i = 0; i < appends; ++i) {
+    hinfo.append(hinfo.get_total_chunk_size(), to_append);
+  }
+  auto batched_time = ceph::mono_clock::now() - start;
+
+  for (unsigned shard = 0; shard < shards; ++shard) {
+    ASSERT_EQ(per_shard[shard], hinfo.get_chunk_hash(shard));
+  }
+  std::cout << appends << " appends of " << shards << "x" << chunk_size
+	    << ": per shard " << per_shard_time
+	    << ", batched " << batched_time << std::endl;
+}
+
+TEST(ECUtil, concat_data_chunks)
+{
+  const uint64_t chunk_size = 64;
+  ECUtil::stripe_info_t sinfo(3, 3 * chunk_size);
+  ceph::ErasureCodeInterfaceRef ec(new ErasureCodeLinearTest);
+
+  bufferlist data;
+  for (unsigned i = 0; i < 2 * sinfo.get_stripe_width(); ++i) {
+    data.append((char)rand());
+  }
+  std::map<int, bufferlist> chunks;
+  ASSERT_EQ(0, ECUtil::encode(sinfo, ec, data, {0, 1, 2}, &chunks));
+
+  bufferlist all;
+  ECUtil::concat_data_chunks(sinfo, ec, chunks, &all);
+  ASSERT_TRUE(all.contents_equal(data));
+
+  // without chunk 1 the middle of each stripe reads back as zeros
+  chunks.erase(1);
+  bufferlist some;
+  ECUtil::concat_data_chunks(sinfo, ec, chunks, &some);
+  ASSERT_EQ(data.length(), some.length());
+  for (unsigned s = 0; s < 2; ++s) {
+    for (unsigned c = 0; c < 3; ++c) {
+      bufferlist got, expected;
+      uint64_t off = s * sinfo.get_stripe_width() + c * chunk_size;
+      got.substr_of(some, off, chunk_size);
+      if (c == 1) {
+	expected.append_zero(chunk_size);
+      } else {
+	expected.substr_of(data, off, chunk_size);
+      }
+      ASSERT_TRUE(got.contents_equal(expected)) << s << "/" << c;
+    }
+  }
+}
+
 TEST(ECUtil, stripe_info_t)
 {
   const uint64_t swidth = 4096;
@@ -58,5 +368,20 @@ TEST(ECUtil, stripe_info_t)
 
   ASSERT_EQ(s.offset_len_to_stripe_bounds(make_pair(swidth-10, (uint64_t)20)),
             make_pair((uint64_t)0, 2*swidth));
+
+  const uint64_t csize = s.get_chunk_size();
+  ASSERT_EQ(s.offset_len_to_data_chunks(make_pair(swidth, (uint64_t)0)),
+	    set<int>());
+  ASSERT_EQ(s.offset_len_to_data_chunks(make_pair(csize, (uint64_t)1)),
+	    set<int>({1}));
+  ASSERT_EQ(s.offset_len_to_data_chunks(make_pair(swidth + csize - 1,
+						  (uint64_t)2)),
+	    set<int>({0, 1}));
+  ASSERT_EQ(s.offset_len_to_data_chunks(make_pair(swidth - 1, (uint64_t)2)),
+	    set<int>({0, 3}));
+  ASSERT_EQ(s.offset_len_to_data_chunks(make_pair(3*csize, csize + 1)),
+	    set<int>({0, 3}));
+  ASSERT_EQ(s.offset_len_to_data_chunks(make_pair(10, swidth)),
+	    set<int>({0, 1, 2, 3}));
 }
 
@@ -175,3 +175,33 @@ TEST_F(mClockSchedulerTest, TestMultiClientOrderedEnqueueDequeue) {
   }
   ASSERT_TRUE(q.empty());
 }
+
+TEST_F(mClockSchedulerTest, TestManyClientsThroughput) {
+  // Mostly a microbenchmark of the scheduler hot path: every client has
+  // a record in the dmclock heaps while ops are added and pulled.
+  const unsigned CLIENTS = 500;
+  const unsigned PER_CLIENT = 8;
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < PER_CLIENT; ++i) {
+    for (unsigned c = 0; c < CLIENTS; ++c) {
+      q.enqueue(create_item(i, client3 + c));
+    }
+  }
+  auto enqueued = std::chrono::steady_clock::now();
+
+  unsigned dequeued = 0;
+  while (!q.empty()) {
+    auto w = q.dequeue();
+    if (std::holds_alternative<OpSchedulerItem>(w)) {
+      ++dequeued;
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  ASSERT_EQ(CLIENTS * PER_CLIENT, dequeued);
+
+  std::chrono::duration<double> enq = enqueued - start;
+  std::chrono::duration<double> deq = end - enqueued;
+  std::cout << CLIENTS << " clients: enqueue "
+	    << dequeued / enq.count() << " ops/s, dequeue "
+	    << dequeued / deq.count() << " ops/s" << std::endl;
+}
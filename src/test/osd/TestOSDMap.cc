@@ -249,6 +249,137 @@ TEST_F(OSDMapTest, Create) {
   ASSERT_EQ(get_num_osds(), osdmap.get_num_in_osds());
 }
 
+TEST_F(OSDMapTest, ShallowCopyApplyIncremental) {
+  set_up_map();
+
+  pg_t pgid = osdmap.raw_pg_to_pg(pg_t(0, my_rep_pool));
+  vector<int> up_osds, acting_osds;
+  int up_primary, acting_primary;
+  osdmap.pg_to_up_acting_osds(pgid, &up_osds, &up_primary,
+                              &acting_osds, &acting_primary);
+  entity_addrvec_t old_addrs = osdmap.get_addrs(0);
+
+  OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+  vector<int> new_acting(acting_osds.rbegin(), acting_osds.rend());
+  inc.new_pg_temp[pgid] = mempool::osdmap::vector<int>(
+    new_acting.begin(), new_acting.end());
+  entity_addrvec_t new_addrs;
+  new_addrs.v.push_back(entity_addr_t());
+  new_addrs.v[0].nonce = 1000;
+  inc.new_up_client[0] = new_addrs;
+  inc.new_hb_back_up[0] = new_addrs;
+  inc.new_hb_front_up[0] = new_addrs;
+
+  OSDMap shallow;
+  shallow.shallow_copy_from(osdmap);
+  ASSERT_EQ(0, shallow.apply_incremental(inc));
+  OSDMap deep;
+  deep.deepish_copy_from(osdmap);
+  ASSERT_EQ(0, deep.apply_incremental(inc));
+
+  // the source epoch is untouched...
+  vector<int> up, acting;
+  int upp, actp;
+  osdmap.pg_to_up_acting_osds(pgid, &up, &upp, &acting, &actp);
+  EXPECT_EQ(acting_osds, acting);
+  EXPECT_EQ(old_addrs, osdmap.get_addrs(0));
+
+  // ...and the shallow copy ends up identical to the deep one
+  shallow.pg_to_up_acting_osds(pgid, &up, &upp, &acting, &actp);
+  EXPECT_EQ(new_acting, acting);
+  EXPECT_EQ(new_addrs, shallow.get_addrs(0));
+  bufferlist sbl, dbl;
+  shallow.encode(sbl, CEPH_FEATURES_SUPPORTED_DEFAULT | CEPH_FEATURE_RESERVED);
+  deep.encode(dbl, CEPH_FEATURES_SUPPORTED_DEFAULT | CEPH_FEATURE_RESERVED);
+  EXPECT_TRUE(sbl.contents_equal(dbl));
+
+  // decoding over a shallow copy must not scribble on the source either
+  OSDMap redecode;
+  redecode.shallow_copy_from(osdmap);
+  redecode.decode(sbl);
+  osdmap.pg_to_up_acting_osds(pgid, &up, &upp, &acting, &actp);
+  EXPECT_EQ(acting_osds, acting);
+  EXPECT_EQ(old_addrs, osdmap.get_addrs(0));
+}
+
+TEST_F(OSDMapTest, IncrementalMapping) {
+  set_up_map();
+  ThreadPool tp(g_ceph_context, "IncrementalMapping::tp", "inc_map_tp", 2);
+  tp.start();
+  ParallelPGMapper mapper(g_ceph_context, &tp);
+  mapping.start_update(osdmap, mapper, 16)->wait();
+
+  auto check = [&]() {
+    for (auto& [poolid, pool] : osdmap.get_pools()) {
+      for (unsigned ps = 0; ps < pool.get_pg_num(); ++ps) {
+	pg_t pgid(ps, poolid);
+	vector<int> up, acting, up2, acting2;
+	int upp, actp, upp2, actp2;
+	osdmap.pg_to_up_acting_osds(pgid, &up, &upp, &acting, &actp);
+	mapping.get(pgid, &up2, &upp2, &acting2, &actp2);
+	ASSERT_EQ(up, up2) << pgid;
+	ASSERT_EQ(upp, upp2) << pgid;
+	ASSERT_EQ(acting, acting2) << pgid;
+	ASSERT_EQ(actp, actp2) << pgid;
+      }
+    }
+    ASSERT_EQ(osdmap.get_epoch(), mapping.get_epoch());
+  };
+
+  // pg_temp on one pg, then an osd going down
+  std::set<pg_t> pgs;
+  std::set<int64_t> pools;
+  {
+    pg_t pgid = osdmap.raw_pg_to_pg(pg_t(0, my_rep_pool));
+    vector<int> up, acting;
+    int upp, actp;
+    osdmap.pg_to_up_acting_osds(pgid, &up, &upp, &acting, &actp);
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_pg_temp[pgid] = mempool::osdmap::vector<int>(
+      acting.rbegin(), acting.rend());
+    osdmap.apply_incremental(inc);
+    ASSERT_TRUE(mapping.get_affected_pgs(osdmap, inc, &pgs, &pools));
+    ASSERT_EQ(1u, pgs.size());
+  }
+  {
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_state[0] = CEPH_OSD_UP;
+    osdmap.apply_incremental(inc);
+    ASSERT_FALSE(osdmap.is_up(0));
+    ASSERT_TRUE(mapping.get_affected_pgs(osdmap, inc, &pgs, &pools));
+    ASSERT_TRUE(pools.empty());
+  }
+  auto job = mapping.start_update(osdmap, mapper, 16, pgs, pools);
+  job->wait();
+  check();
+
+  // nothing mapping related at all
+  pgs.clear();
+  {
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_up_thru[1] = osdmap.get_epoch();
+    osdmap.apply_incremental(inc);
+    ASSERT_TRUE(mapping.get_affected_pgs(osdmap, inc, &pgs, &pools));
+    ASSERT_TRUE(pgs.empty());
+  }
+  job = mapping.start_update(osdmap, mapper, 16, pgs, pools);
+  ASSERT_TRUE(job->is_done());
+  check();
+
+  // bringing the osd back up needs a full pass
+  {
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    entity_addrvec_t addrs;
+    addrs.v.push_back(entity_addr_t());
+    inc.new_up_client[0] = addrs;
+    inc.new_hb_back_up[0] = addrs;
+    inc.new_hb_front_up[0] = addrs;
+    osdmap.apply_incremental(inc);
+    ASSERT_FALSE(mapping.get_affected_pgs(osdmap, inc, &pgs, &pools));
+  }
+  tp.stop();
+}
+
 TEST_F(OSDMapTest, Features) {
   // with EC pool
   set_up_map();
@@ -1742,6 +1873,31 @@ TEST(PGTempMap, basic)
   ASSERT_EQ(998u, m.size());
 }
 
+TEST_F(OSDMapTest, calc_pg_upmaps_threads) {
+  // candidate pgs are evaluated in parallel, but the plan must be the one
+  // a single thread would compute
+  set_up_map(60);
+  set<int64_t> only_pools = {(int64_t)my_rep_pool};
+  // aggressive mode reseeds its shuffles on every call
+  g_ceph_context->_conf.set_val_or_die("osd_calc_pg_upmaps_aggressively", "false");
+  auto plan = [&](const char *threads) {
+    g_ceph_context->_conf.set_val_or_die("osd_calc_pg_upmaps_threads", threads);
+    OSDMap tmp;
+    tmp.deepish_copy_from(osdmap);
+    OSDMap::Incremental pending_inc(tmp.get_epoch() + 1);
+    int changed = tmp.calc_pg_upmaps(g_ceph_context, 1, 100, only_pools,
+                                     &pending_inc);
+    return std::make_pair(changed, pending_inc.new_pg_upmap_items);
+  };
+  auto serial = plan("1");
+  auto parallel = plan("8");
+  g_ceph_context->_conf.rm_val("osd_calc_pg_upmaps_threads");
+  g_ceph_context->_conf.rm_val("osd_calc_pg_upmaps_aggressively");
+  ASSERT_LT(0, serial.first);
+  ASSERT_EQ(serial.first, parallel.first);
+  ASSERT_EQ(serial.second, parallel.second);
+}
+
 TEST_F(OSDMapTest, BUG_43124) {
   set_up_map(200);
   {
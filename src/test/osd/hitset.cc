@@ -122,6 +122,53 @@ TEST_F(BloomHitSetTest, RejectsNoMatch) {
   EXPECT_LT(matches, 2);
 }
 
+class BlockedBloomHitSetTest : public testing::Test, public HitSetTestStrap {
+public:
+
+  BlockedBloomHitSetTest() : HitSetTestStrap(new HitSet(new BlockedBloomHitSet)) {}
+
+  void rebuild(double fp, uint64_t target, uint64_t seed) {
+    auto *bparams = new BlockedBloomHitSet::Params(fp, target, seed);
+    HitSet::Params param(bparams);
+    HitSet new_set(param);
+    *hitset = new_set;
+  }
+};
+
+TEST_F(BlockedBloomHitSetTest, Rebuild) {
+  rebuild(0.1, 100, 1);
+  ASSERT_EQ(hitset->impl->get_type(), HitSet::TYPE_BLOCKED_BLOOM);
+}
+
+TEST_F(BlockedBloomHitSetTest, RejectsNoMatch) {
+  rebuild(0.001, 100, 1);
+  fill(100);
+  verify_fill(100);
+  EXPECT_TRUE(hitset->is_full());
+
+  char buf[50];
+  int matches = 0;
+  for (int i = 100; i < 200; ++i) {
+    sprintf(buf, "hitsettest_%d", i);
+    hobject_t obj(object_t(buf), "", 0, i, 0, "");
+    if (hitset->contains(obj))
+      ++matches;
+  }
+  EXPECT_LT(matches, 2);
+}
+
+TEST_F(BlockedBloomHitSetTest, EncodeDecode) {
+  rebuild(0.01, 100, 1);
+  fill(50);
+  bufferlist bl;
+  encode(*hitset, bl);
+  HitSet copy;
+  auto p = bl.cbegin();
+  decode(copy, p);
+  ASSERT_EQ(copy.impl->get_type(), HitSet::TYPE_BLOCKED_BLOOM);
+  HitSetTestStrap(&copy).verify_fill(50);
+}
+
 class ExplicitHashHitSetTest : public testing::Test, public HitSetTestStrap {
 public:
 
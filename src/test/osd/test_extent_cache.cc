@@ -280,3 +280,49 @@ TEST(extentcache, write_write_overlap2)
 
   c.release_write_pin(pin3);
 }
+
+TEST(extentcache, retain)
+{
+  hobject_t oid(sobject_t("foo", CEPH_NOSNAP));
+  hobject_t other(sobject_t("bar", CEPH_NOSNAP));
+  const uint64_t base = ExtentCache::get_total_retained_bytes();
+
+  ExtentCache c;
+  bufferlist a, b;
+  a.append(string(10, 'a'));
+  b.append(string(10, 'b'));
+  extent_map first;
+  first.insert(0, 10, a);
+  c.retain(oid, first, 1000);
+  ASSERT_EQ(10u, c.get_retained_bytes());
+  ASSERT_EQ(base + 10, ExtentCache::get_total_retained_bytes());
+
+  // a later write overlays the earlier one
+  extent_map second;
+  second.insert(5, 10, b);
+  c.retain(oid, second, 1000);
+  ASSERT_EQ(15u, c.get_retained_bytes());
+
+  auto got = c.get_retained(oid, iset_from_vector({{2, 6}}));
+  ASSERT_TRUE(got);
+  ASSERT_EQ(iset_from_vector({{2, 6}}), got->get_interval_set());
+  bufferlist expected;
+  expected.append("aaabbb");
+  ASSERT_TRUE(got->begin().get_val().contents_equal(expected));
+
+  // partially retained or unknown ranges are misses
+  ASSERT_FALSE(c.get_retained(oid, iset_from_vector({{10, 10}})));
+  ASSERT_FALSE(c.get_retained(other, iset_from_vector({{0, 1}})));
+
+  // over budget, the least recently written object goes first
+  c.retain(other, first, 20);
+  ASSERT_FALSE(c.get_retained(oid, iset_from_vector({{0, 1}})));
+  ASSERT_TRUE(c.get_retained(other, iset_from_vector({{0, 10}})));
+  ASSERT_EQ(10u, c.get_retained_bytes());
+
+  c.invalidate_retained(other);
+  ASSERT_EQ(0u, c.get_retained_bytes());
+  c.retain(oid, first, 0);
+  ASSERT_EQ(0u, c.get_retained_bytes());
+  ASSERT_EQ(base, ExtentCache::get_total_retained_bytes());
+}
@@ -400,3 +400,29 @@ TEST_F(TestScrubSched, ready_list)
   EXPECT_EQ(4, ripe_jobs.size());
   debug_print_jobs("ready_list", ripe_jobs);
 }
+
+/// the chunk size scale follows the smoothed I/O load
+TEST_F(TestScrubSched, io_load_chunk_scale)
+{
+  auto& conf = g_ceph_context->_conf;
+  conf.set_val_or_die("osd_scrub_io_aware", "false");
+  m_sched->update_io_load(1000);
+  EXPECT_EQ(1.0, m_sched->chunk_size_scale());
+
+  conf.set_val_or_die("osd_scrub_io_aware", "true");
+  conf.set_val_or_die("osd_scrub_io_load_high", "64");
+  EXPECT_EQ(2.0, m_sched->chunk_size_scale());
+
+  for (int i = 0; i < 50; ++i) {
+    m_sched->update_io_load(32);
+  }
+  EXPECT_NEAR(1.0, m_sched->chunk_size_scale(), 0.01);
+
+  for (int i = 0; i < 50; ++i) {
+    m_sched->update_io_load(1000);
+  }
+  EXPECT_EQ(0.0, m_sched->chunk_size_scale());
+
+  conf.set_val_or_die("osd_scrub_io_aware", "false");
+  EXPECT_EQ(1.0, m_sched->chunk_size_scale());
+}
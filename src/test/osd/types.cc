@@ -1368,6 +1368,26 @@ TEST(pg_pool_t_test, get_random_pg_position) {
   }
 }
 
+TEST(pg_pool_t_test, hash_keys) {
+  for (int type : {CEPH_STR_HASH_LINUX, CEPH_STR_HASH_RJENKINS}) {
+    pg_pool_t p;
+    p.object_hash = type;
+    vector<string> keys;
+    for (int i = 0; i < 100; ++i) {
+      // lengths on both sides of the 12-byte rjenkins blocks
+      keys.push_back(string(i % 30, 'x') + stringify(i));
+    }
+    for (const string ns : {"", "ns"}) {
+      vector<uint32_t> hashes;
+      p.hash_keys(keys, ns, &hashes);
+      ASSERT_EQ(keys.size(), hashes.size());
+      for (size_t i = 0; i < keys.size(); ++i) {
+	ASSERT_EQ(p.hash_key(keys[i], ns), hashes[i]);
+      }
+    }
+  }
+}
+
 TEST(shard_id_t, iostream) {
     set<shard_id_t> shards;
     shards.insert(shard_id_t(0));
@@ -2194,6 +2214,31 @@ TEST(chunk_info_test, calc_refs_inc_match) {
     mk_delta({}));
 }
 
+TEST(pg_log_entry_t, extra_reqid_return_codes_encoding) {
+  // the flat in-memory map must stay wire compatible with std::map
+  pg_log_entry_t e;
+  e.extra_reqids.push_back(make_pair(osd_reqid_t(), 1));
+  e.extra_reqids.push_back(make_pair(osd_reqid_t(), 2));
+  e.extra_reqid_return_codes[1] = -ENOENT;
+  e.extra_reqid_return_codes[0] = -EEXIST;
+
+  bufferlist flat_bl, map_bl;
+  encode(e.extra_reqid_return_codes, flat_bl);
+  std::map<uint32_t, int> m(e.extra_reqid_return_codes.begin(),
+			    e.extra_reqid_return_codes.end());
+  encode(m, map_bl);
+  ASSERT_TRUE(flat_bl.contents_equal(map_bl));
+
+  bufferlist bl;
+  encode(e, bl);
+  pg_log_entry_t d;
+  auto p = bl.cbegin();
+  decode(d, p);
+  ASSERT_EQ(2u, d.extra_reqid_return_codes.size());
+  ASSERT_EQ(-EEXIST, d.extra_reqid_return_codes.find(0)->second);
+  ASSERT_EQ(-ENOENT, d.extra_reqid_return_codes.find(1)->second);
+}
+
 /*
  * Local Variables:
  * compile-command: "cd ../.. ;
@@ -255,3 +255,20 @@ TEST(PerfCounters, read_avg) {
   t2.join();
   t1.join();
 }
+
+TEST(PerfCounters, sharded) {
+  g_ceph_context->_conf.set_val_or_die("perf_counters_shards", "4");
+  std::shared_ptr<PerfCounters> fake_pf = setup_test_perfcounter3(g_ceph_context);
+  g_ceph_context->_conf.set_val_or_die("perf_counters_shards", "0");
+
+  std::thread t1(counters_inc_test, fake_pf);
+  std::thread t2(counters_inc_test, fake_pf);
+  std::thread t3(counters_readavg_test, fake_pf);
+  t3.join();
+  t2.join();
+  t1.join();
+
+  std::pair<uint64_t, uint64_t> dat = fake_pf->get_tavg_ns(TEST_PERFCOUNTERS3_ELEMENT_READ);
+  ASSERT_EQ(200000u, dat.first);
+  ASSERT_EQ(200000u, dat.second);
+}
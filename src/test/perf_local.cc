@@ -52,6 +52,8 @@
 #include "common/Thread.h"
 #include "common/Timer.h"
 #include "msg/async/Event.h"
+#include "msg/async/crypto_onwire.h"
+#include "auth/Auth.h"
 #include "global/global_init.h"
 
 #include "test/perf_helper.h"
@@ -561,6 +563,28 @@ double ceph_str_hash_rjenkins()
   return Cycles::to_seconds(stop - start)/count;
 }
 
+// Benchmark batched rjenkins hashing, per key, on cached data.
+template <int key_length>
+double ceph_str_hash_rjenkins_batch()
+{
+  int count = 100000;
+  const int batch = 64;
+  char buf[key_length] = {0};
+  const char *strs[batch];
+  unsigned lens[batch], out[batch];
+  for (int i = 0; i < batch; i++) {
+    strs[i] = buf;
+    lens[i] = sizeof(buf);
+  }
+
+  uint64_t start = Cycles::rdtsc();
+  for (int i = 0; i < count; i += batch)
+    ceph_str_hash_batch(CEPH_STR_HASH_RJENKINS, strs, lens, batch, out);
+  uint64_t stop = Cycles::rdtsc();
+
+  return Cycles::to_seconds(stop - start)/count;
+}
+
 // Measure the cost of reading the fine-grain cycle counter.
 double rdtsc_test()
 {
@@ -915,6 +939,42 @@ double perf_ceph_clock_now()
   return Cycles::to_seconds(stop - start)/count;
 }
 
+// Measure secure-mode (AES-128-GCM) encryption of one frame of frame_len
+// bytes assembled from 64-byte fragments, the way small messages are
+// encoded. coalesce selects ms_crypto_coalesce_size (default) against
+// encrypting every fragment separately.
+template <size_t frame_len, bool coalesce>
+double aes_gcm_frame()
+{
+  int count = 100000;
+  g_ceph_context->_conf.set_val_or_die("ms_crypto_coalesce_size",
+                                       coalesce ? "4096" : "0");
+  AuthConnectionMeta auth_meta;
+  auth_meta.con_mode = CEPH_CON_MODE_SECURE;
+  auth_meta.connection_secret.assign(64, 'k');
+  auto crypto = ceph::crypto::onwire::rxtx_t::create_handler_pair(
+    g_ceph_context, auth_meta, true, false);
+
+  static constexpr size_t fragment_len = 64;
+  char fragment[fragment_len];
+  memset(fragment, 'x', sizeof(fragment));
+  bufferlist frame;
+  for (size_t off = 0; off < frame_len; off += fragment_len) {
+    frame.append(buffer::copy(fragment, std::min(fragment_len, frame_len - off)));
+  }
+
+  uint64_t start = Cycles::rdtsc();
+  for (int i = 0; i < count; i++) {
+    crypto.tx->reset_tx_handler({frame.length()});
+    crypto.tx->authenticated_encrypt_update(frame);
+    auto out = crypto.tx->authenticated_encrypt_final();
+    discard(out.c_str());
+  }
+  uint64_t stop = Cycles::rdtsc();
+  g_ceph_context->_conf.rm_val("ms_crypto_coalesce_size");
+  return Cycles::to_seconds(stop - start)/count;
+}
+
 // The following struct and table define each performance test in terms of
 // a string name and a function that implements the test.
 struct TestInfo {
@@ -973,6 +1033,8 @@ TestInfo tests[] = {
     "rjenkins hash on 16 byte of data"},
   {"ceph_str_hash_rjenkins", ceph_str_hash_rjenkins<256>,
     "rjenkins hash on 256 bytes of data"},
+  {"ceph_str_hash_rjenkins_batch", ceph_str_hash_rjenkins_batch<16>,
+    "batched rjenkins hash on 16 byte of data, per key"},
   {"rdtsc", rdtsc_test,
     "Read the fine-grain cycle counter"},
   {"cycles_to_seconds", perf_cycles_to_seconds,
@@ -1005,6 +1067,18 @@ TestInfo tests[] = {
     "Push and pop a std::vector"},
   {"ceph_clock_now", perf_ceph_clock_now,
    "ceph_clock_now function"},
+  {"aes_gcm_frame", aes_gcm_frame<256, false>,
+    "AES-GCM 256 byte frame, per fragment"},
+  {"aes_gcm_frame", aes_gcm_frame<256, true>,
+    "AES-GCM 256 byte frame, coalesced"},
+  {"aes_gcm_frame", aes_gcm_frame<4096, false>,
+    "AES-GCM 4 KiB frame, per fragment"},
+  {"aes_gcm_frame", aes_gcm_frame<4096, true>,
+    "AES-GCM 4 KiB frame, coalesced"},
+  {"aes_gcm_frame", aes_gcm_frame<65536, false>,
+    "AES-GCM 64 KiB frame, per fragment"},
+  {"aes_gcm_frame", aes_gcm_frame<65536, true>,
+    "AES-GCM 64 KiB frame, coalesced"},
 };
 
 /**
@@ -271,6 +271,48 @@ TEST(TestRGWCrypto, verify_AES_256_CBC_identity_3)
 }
 
 
+TEST(TestRGWCrypto, verify_AES_256_CBC_chunks_independent)
+{
+  const NoDoutPrefix no_dpp(g_ceph_context, dout_subsys);
+  //a run of chunks must encrypt exactly as each chunk does on its own
+  const size_t test_range = 64*1024 + 100;
+  buffer::ptr buf(test_range);
+  char* p = buf.c_str();
+  for(size_t i = 0; i < buf.length(); i++)
+    p[i] = i + i*i + (i >> 2);
+
+  bufferlist input;
+  input.append(buf);
+
+  uint8_t key[32];
+  for(size_t i=0;i<sizeof(key);i++)
+    key[i]=i*3;
+
+  auto aes(AES_256_CBC_create(&no_dpp, g_ceph_context, &key[0], 32));
+  ASSERT_NE(aes.get(), nullptr);
+  size_t block_size = aes->get_block_size();
+
+  const off_t stream_offset = 1000 * block_size;
+  bufferlist encrypted;
+  ASSERT_TRUE(aes->encrypt(input, 0, test_range, encrypted, stream_offset));
+  ASSERT_EQ(encrypted.length(), test_range);
+
+  for (size_t ofs = 0; ofs < test_range; ofs += block_size)
+  {
+    size_t len = std::min(block_size, test_range - ofs);
+    bufferlist chunk;
+    ASSERT_TRUE(aes->encrypt(input, ofs, len, chunk, stream_offset + ofs));
+    ASSERT_EQ(std::string_view(encrypted.c_str() + ofs, len),
+              std::string_view(chunk.c_str(), len));
+  }
+
+  bufferlist decrypted;
+  ASSERT_TRUE(aes->decrypt(encrypted, 0, test_range, decrypted, stream_offset));
+  ASSERT_EQ(std::string_view(input.c_str(), test_range),
+            std::string_view(decrypted.c_str(), test_range));
+}
+
+
 TEST(TestRGWCrypto, verify_AES_256_CBC_size_0_15)
 {
   const NoDoutPrefix no_dpp(g_ceph_context, dout_subsys);
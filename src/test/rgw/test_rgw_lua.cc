@@ -202,6 +202,24 @@ TEST(TestRGWLua, Hello)
   ASSERT_EQ(rc, 0);
 }
 
+TEST(TestRGWLua, CachedScript)
+{
+  const std::string script = R"(
+    if AlreadyRan then
+      error("globals leaked from a previous run")
+    end
+    AlreadyRan = true
+  )";
+
+  DEFINE_REQ_STATE;
+
+  // the second run loads the cached bytecode into a fresh state
+  auto rc = lua::request::execute(nullptr, nullptr, nullptr, &s, nullptr, script);
+  ASSERT_EQ(rc, 0);
+  rc = lua::request::execute(nullptr, nullptr, nullptr, &s, nullptr, script);
+  ASSERT_EQ(rc, 0);
+}
+
 TEST(TestRGWLua, RGWDebugLogNumber)
 {
   const std::string script = R"(
@@ -167,6 +167,63 @@ TEST_F(Aio_Throttle, ThrottleOverMax)
   EXPECT_EQ(window, max_outstanding);
 }
 
+// issue writes that each take 10ms, and return the most that were in flight
+static uint64_t max_outstanding_of(Aio& throttle, const RGWSI_RADOS::Obj& obj,
+                                   uint64_t total)
+{
+  uint64_t max_outstanding = 0;
+  uint64_t outstanding = 0;
+
+  // timer thread
+  boost::asio::io_context context;
+  using Executor = boost::asio::io_context::executor_type;
+  using Work = boost::asio::executor_work_guard<Executor>;
+  std::optional<Work> work(context.get_executor());
+  std::thread worker([&context] { context.run(); });
+  auto g = make_scope_guard([&work, &worker] {
+      work.reset();
+      worker.join();
+    });
+
+  for (uint64_t i = 0; i < total; i++) {
+    using namespace std::chrono_literals;
+    auto c = throttle.get(obj, wait_for(context, 10ms), 1, 0);
+    outstanding++;
+    outstanding -= c.size();
+    if (max_outstanding < outstanding) {
+      max_outstanding = outstanding;
+    }
+  }
+  auto c = throttle.drain();
+  outstanding -= c.size();
+  EXPECT_EQ(0u, outstanding);
+  return max_outstanding;
+}
+
+TEST_F(Aio_Throttle, AdaptiveWindowGrows)
+{
+  constexpr uint64_t min_window = 4;
+  constexpr uint64_t max_window = 16;
+  BlockingAioThrottle throttle(min_window, max_window, 1024);
+
+  auto obj = make_obj(__PRETTY_FUNCTION__);
+  // latency doesn't rise with the number of writes in flight, so the
+  // window grows past its minimum
+  auto max_outstanding = max_outstanding_of(throttle, obj, 128);
+  EXPECT_LT(min_window, max_outstanding);
+  EXPECT_GE(max_window, max_outstanding);
+}
+
+TEST_F(Aio_Throttle, AdaptiveWindowBudget)
+{
+  constexpr uint64_t min_window = 4;
+  BlockingAioThrottle throttle(min_window, 16, 0);
+
+  auto obj = make_obj(__PRETTY_FUNCTION__);
+  // no budget to grow into
+  EXPECT_EQ(min_window, max_outstanding_of(throttle, obj, 64));
+}
+
 TEST_F(Aio_Throttle, YieldCostOverWindow)
 {
   auto obj = make_obj(__PRETTY_FUNCTION__);
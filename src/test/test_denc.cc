@@ -292,6 +292,95 @@ TEST(denc, list)
   }
 }
 
+struct extent_le_t {
+  ceph_le64 offset;
+  ceph_le32 length;
+  ceph_le32 flags;
+
+  DENC(extent_le_t, v, p) {
+    ::denc(v.offset, p);
+    ::denc(v.length, p);
+    ::denc(v.flags, p);
+  }
+
+  friend bool operator==(const extent_le_t& l, const extent_le_t& r) {
+    return l.offset == r.offset && l.length == r.length && l.flags == r.flags;
+  }
+};
+WRITE_CLASS_DENC_BOUNDED(extent_le_t)
+WRITE_CLASS_DENC_MEMCPY(extent_le_t)
+
+TEST(denc, vector_memcpy)
+{
+  static_assert(_denc::is_memcpy_v<extent_le_t>);
+  static_assert(!_denc::is_memcpy_v<denc_counter_bounded_t>);
+  static_assert(!_denc::is_memcpy_v<bool>);
+
+  vector<extent_le_t> v;
+  list<extent_le_t> l;
+  for (unsigned i = 0; i < 1000; ++i) {
+    extent_le_t e;
+    e.offset = ceph_le64(i * 4096ull);
+    e.length = ceph_le32(i);
+    e.flags = ceph_le32(i & 3);
+    v.push_back(e);
+    l.push_back(e);
+  }
+  test_denc(v);
+
+  // the bulk copy must produce the same bytes as the element loop
+  bufferlist vbl, lbl;
+  encode(v, vbl);
+  encode(l, lbl);
+  ASSERT_EQ(vbl.length(), sizeof(uint32_t) + v.size() * sizeof(extent_le_t));
+  ASSERT_TRUE(vbl.contents_equal(lbl));
+
+  // segmented decode
+  bufferlist seg;
+  seg.substr_of(vbl, 0, 100);
+  bufferlist tail;
+  tail.substr_of(vbl, 100, vbl.length() - 100);
+  seg.claim_append(tail);
+  vector<extent_le_t> out;
+  decode(out, seg);
+  ASSERT_EQ(v, out);
+
+  // a truncated buffer fails before the vector is sized off the count
+  bufferlist truncated;
+  truncated.substr_of(vbl, 0, vbl.length() - 1);
+  out.clear();
+  ASSERT_THROW(decode(out, truncated), buffer::end_of_buffer);
+  ASSERT_TRUE(out.empty());
+
+  vector<uint32_t> u(1000);
+  std::iota(u.begin(), u.end(), 0);
+  test_denc(u);
+}
+
+TEST(denc, varint_n)
+{
+  for (unsigned n : {1u, 7u, 8u, 9u, 64u, 100u}) {
+    vector<uint32_t> in(n);
+    for (unsigned i = 0; i < n; ++i) {
+      // mostly single-byte values with an occasional wide one
+      in[i] = (i % 13 == 5) ? (1u << (i % 32)) : (i & 0x7f);
+    }
+    bufferlist bl;
+    {
+      auto a = bl.get_contiguous_appender(n * (sizeof(uint32_t) + 1));
+      for (auto i : in) {
+        denc_varint(i, a);
+      }
+    }
+    bl.rebuild();
+    vector<uint32_t> out(n);
+    auto p = bl.front().begin();
+    denc_varint_n(out.data(), n, p);
+    ASSERT_EQ(in, out);
+    ASSERT_TRUE(p.end());
+  }
+}
+
 template<template<class> class C>
 void test_setlike(const char* c) {
   {
@@ -433,6 +433,31 @@ TEST(mempool, check_shard_select)
   EXPECT_LT(missed, mempool::num_shards / 2);
 }
 
+TEST(mempool, profile)
+{
+  mempool::set_profile_rate(1);
+  {
+    mempool::unittest_2::vector<int> v;
+    v.resize(10);
+    ASSERT_EQ(1u, mempool::profile_live.load());
+
+    ostringstream ostr;
+    Formatter* f = Formatter::create("json-pretty", "json-pretty", "json-pretty");
+    mempool::dump_profile(f);
+    f->flush(ostr);
+    delete f;
+    ASSERT_NE(ostr.str().find("unittest_2"), std::string::npos);
+    ASSERT_NE(ostr.str().find("\"est_bytes\": 40"), std::string::npos);
+  }
+  mempool::set_profile_rate(0);
+  ASSERT_EQ(0u, mempool::profile_live.load());
+
+  // nothing is sampled while disabled
+  mempool::unittest_2::vector<int> v;
+  v.resize(10);
+  ASSERT_EQ(0u, mempool::profile_live.load());
+}
+
 
 int main(int argc, char **argv)
 {
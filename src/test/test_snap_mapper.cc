@@ -360,6 +360,33 @@ public:
       cur = next.first;
     }
   }
+  void get_next_n() {
+    string cur;
+    const unsigned max = 1 + random_num();
+    while (true) {
+      vector<pair<string, bufferlist>> next;
+      int r = cache->get_next_n(cur, max, &next);
+
+      vector<pair<string, bufferlist>> next_truth;
+      for (auto i = truth.upper_bound(cur);
+	   i != truth.end() && next_truth.size() < max;
+	   ++i) {
+	next_truth.push_back(*i);
+      }
+      int r_truth = next_truth.empty() ? -ENOENT : 0;
+
+      ASSERT_EQ(r, r_truth);
+      if (r == -ENOENT)
+	break;
+
+      ASSERT_EQ(next.size(), next_truth.size());
+      for (size_t i = 0; i < next.size(); ++i) {
+	ASSERT_EQ(next[i].first, next_truth[i].first);
+	assert_bl_eq(next[i].second, next_truth[i].second);
+      }
+      cur = next.back().first;
+    }
+  }
   void SetUp() override {
     driver.reset(new PausyAsyncMap());
     cache.reset(new MapCacher::MapCacher<string, bufferlist>(driver.get()));
@@ -431,6 +458,31 @@ TEST_F(MapCacherTest, Random)
   }
 }
 
+TEST_F(MapCacherTest, RandomGetNextN)
+{
+  for (size_t i = 0; i < 5000; ++i) {
+    if (!(i % 50)) {
+      std::cout << "On iteration " << i << std::endl;
+    }
+    switch (rand() % 4) {
+    case 0:
+      driver->pause();
+      get_next_n();
+      driver->resume();
+      break;
+    case 1:
+      do_set();
+      break;
+    case 2:
+      get_next_n();
+      break;
+    case 3:
+      remove();
+      break;
+    }
+  }
+}
+
 class MapperVerifier {
   PausyAsyncMap *driver;
   boost::scoped_ptr< SnapMapper > mapper;
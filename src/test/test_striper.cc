@@ -1,3 +1,6 @@
+#include <limits>
+#include <random>
+
 #include "gtest/gtest.h"
 #include "global/global_context.h"
 
@@ -87,3 +90,41 @@ TEST(Striper, GetFileOffset)
           g_ceph_context, &l, object_no, object_off);
   ASSERT_EQ(26549568u, file_offset);
 }
+
+TEST(Striper, SingleExtentFastPath)
+{
+  // an extent list that already holds an extent goes through the general
+  // loop; the sentinel sorts last and never merges, so the rest of the
+  // list must match what the single-extent path builds from scratch
+  constexpr uint64_t sentinel = std::numeric_limits<uint64_t>::max();
+  std::mt19937_64 rng(42);
+  for (int i = 0; i < 10000; ++i) {
+    file_layout_t l;
+    l.stripe_unit = 4096u << (rng() % 6);
+    l.stripe_count = 1 + rng() % 8;
+    l.object_size = l.stripe_unit << (rng() % 5);
+    uint64_t off = rng() % (1ull << 40);
+    uint64_t len = 1 + rng() % l.stripe_unit;
+    uint64_t trunc_size = rng() % 2 ? off + rng() % (1ull << 30) : 0;
+    uint64_t buffer_offset = rng() % 65536;
+
+    striper::LightweightObjectExtents fast;
+    Striper::file_to_extents(g_ceph_context, &l, off, len, trunc_size,
+                             buffer_offset, &fast);
+    striper::LightweightObjectExtents slow;
+    slow.emplace_back(sentinel, 0, 1, 0);
+    Striper::file_to_extents(g_ceph_context, &l, off, len, trunc_size,
+                             buffer_offset, &slow);
+    ASSERT_EQ(sentinel, slow.back().object_no);
+    slow.pop_back();
+
+    ASSERT_EQ(slow.size(), fast.size());
+    for (size_t j = 0; j < slow.size(); ++j) {
+      ASSERT_EQ(slow[j].object_no, fast[j].object_no);
+      ASSERT_EQ(slow[j].offset, fast[j].offset);
+      ASSERT_EQ(slow[j].length, fast[j].length);
+      ASSERT_EQ(slow[j].truncate_size, fast[j].truncate_size);
+      ASSERT_EQ(slow[j].buffer_extents, fast[j].buffer_extents);
+    }
+  }
+}
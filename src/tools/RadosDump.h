@@ -379,19 +379,24 @@ class RadosDump
       int write_section(sectiontype_t type, const T& obj, int fd) {
         if (dry_run)
           return 0;
-        bufferlist blhdr, bl, blftr;
+        bufferlist bl;
+        write_section(type, obj, &bl);
+        return bl.write_fd(fd);
+      }
+
+    // Same, but append the section to an in-memory stream
+    template <typename T>
+      int write_section(sectiontype_t type, const T& obj, bufferlist *out) {
+        if (dry_run)
+          return 0;
+        bufferlist bl;
         obj.encode(bl);
         header hdr(type, bl.length());
-        hdr.encode(blhdr);
+        hdr.encode(*out);
+        out->claim_append(bl);
         footer ft;
-        ft.encode(blftr);
-
-        int ret = blhdr.write_fd(fd);
-        if (ret) return ret;
-        ret = bl.write_fd(fd);
-        if (ret) return ret;
-        ret = blftr.write_fd(fd);
-        return ret;
+        ft.encode(*out);
+        return 0;
       }
 
     int write_simple(sectiontype_t type, int fd)
@@ -399,10 +404,17 @@ class RadosDump
       if (dry_run)
         return 0;
       bufferlist hbl;
+      write_simple(type, &hbl);
+      return hbl.write_fd(fd);
+    }
 
+    int write_simple(sectiontype_t type, bufferlist *out)
+    {
+      if (dry_run)
+        return 0;
       header hdr(type, 0);
-      hdr.encode(hbl);
-      return hbl.write_fd(fd);
+      hdr.encode(*out);
+      return 0;
     }
 };
 
@@ -33,6 +33,7 @@ TYPE(BitVector<2>)
 #include "common/bloom_filter.hpp"
 TYPE(bloom_filter)
 TYPE(compressible_bloom_filter)
+TYPE(blocked_bloom_filter)
 
 #include "common/DecayCounter.h"
 TYPE(DecayCounter)
@@ -116,6 +117,8 @@ MESSAGE(MClientCapRelease)
 
 #include "messages/MClientCaps.h"
 MESSAGE(MClientCaps)
+#include "messages/MClientCapsBatch.h"
+MESSAGE(MClientCapsBatch)
 
 #include "messages/MClientLease.h"
 MESSAGE(MClientLease)
@@ -360,6 +363,9 @@ MESSAGE(MOSDMap)
 #include "messages/MOSDOp.h"
 MESSAGE(MOSDOp)
 
+#include "messages/MOSDOpBatch.h"
+MESSAGE(MOSDOpBatch)
+
 #include "messages/MOSDOpReply.h"
 MESSAGE(MOSDOpReply)
 
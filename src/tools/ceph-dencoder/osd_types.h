@@ -69,6 +69,7 @@ TYPE(ECSubReadReply)
 TYPE_NONDETERMINISTIC(ExplicitHashHitSet)
 TYPE_NONDETERMINISTIC(ExplicitObjectHitSet)
 TYPE(BloomHitSet)
+TYPE(BlockedBloomHitSet)
 TYPE_NONDETERMINISTIC(HitSet)   // because some subclasses are
 TYPE(HitSet::Params)
 
@@ -53,6 +53,8 @@ TYPE(cls_rgw_lc_entry)
 TYPE(cls_rgw_lc_get_entry_ret)
 TYPE(rgw_cls_obj_prepare_op)
 TYPE(rgw_cls_obj_complete_op)
+TYPE(rgw_cls_obj_prepare_ops)
+TYPE(rgw_cls_obj_complete_ops)
 TYPE(rgw_cls_list_op)
 TYPE(rgw_cls_list_ret)
 TYPE(cls_rgw_gc_defer_entry_op)
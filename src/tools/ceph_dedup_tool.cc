@@ -45,6 +45,7 @@
 #include "tools/RadosDump.h"
 #include "cls/cas/cls_cas_client.h"
 #include "cls/cas/cls_cas_internal.h"
+#include "include/scope_guard.h"
 #include "include/stringify.h"
 #include "global/signal_handler.h"
 #include "common/CDC.h"
@@ -72,34 +73,50 @@ struct EstimateResult {
     : cdc(CDC::create(alg, chunk_size)),
       chunk_size(1ull << chunk_size) {}
 
-  void add_chunk(bufferlist& chunk, const std::string& fp_algo) {
-    string fp;
+  static string fingerprint(bufferlist& chunk, const std::string& fp_algo) {
     if (fp_algo == "sha1") {
       sha1_digest_t sha1_val = crypto::digest<crypto::SHA1>(chunk);
-      fp = sha1_val.to_str();
+      return sha1_val.to_str();
     } else if (fp_algo == "sha256") {
       sha256_digest_t sha256_val = crypto::digest<crypto::SHA256>(chunk);
-      fp = sha256_val.to_str();
+      return sha256_val.to_str();
     } else if (fp_algo == "sha512") {
       sha512_digest_t sha512_val = crypto::digest<crypto::SHA512>(chunk);
-      fp = sha512_val.to_str();
+      return sha512_val.to_str();
     } else {
-      ceph_assert(0 == "no support fingerperint algorithm");
+      ceph_abort_msg("no support fingerperint algorithm");
+    }
+  }
+
+  // fingerprint all chunks of an object, then account them under a
+  // single lock acquisition so estimate threads don't contend per chunk
+  void add_chunks(const bufferlist& bl,
+		  const vector<pair<uint64_t, uint64_t>>& chunks,
+		  const std::string& fp_algo) {
+    vector<string> fps;
+    fps.reserve(chunks.size());
+    for (auto& c : chunks) {
+      bufferlist chunk;
+      chunk.substr_of(bl, c.first, c.second);
+      fps.push_back(fingerprint(chunk, fp_algo));
     }
 
     std::lock_guard l(lock);
-    auto p = chunk_statistics.find(fp);
-    if (p != chunk_statistics.end()) {
-      p->second.first++;
-      if (p->second.second != chunk.length()) {
-	cerr << "warning: hash collision on " << fp
-	     << ": was " << p->second.second
-	     << " now " << chunk.length() << std::endl;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+      uint64_t len = chunks[i].second;
+      auto p = chunk_statistics.find(fps[i]);
+      if (p != chunk_statistics.end()) {
+	p->second.first++;
+	if (p->second.second != len) {
+	  cerr << "warning: hash collision on " << fps[i]
+	       << ": was " << p->second.second
+	       << " now " << len << std::endl;
+	}
+      } else {
+	chunk_statistics[std::move(fps[i])] = make_pair(1, len);
       }
-    } else {
-      chunk_statistics[fp] = make_pair(1, chunk.length());
+      total_bytes += len;
     }
-    total_bytes += chunk.length();
   }
 
   void dump(Formatter *f) const {
@@ -131,6 +148,7 @@ struct EstimateResult {
 map<uint64_t, EstimateResult> dedup_estimates;  // chunk size -> result
 
 using namespace librados;
+using AioCompRef = unique_ptr<AioCompletion>;
 unsigned default_op_size = 1 << 26;
 unsigned default_max_thread = 2;
 int32_t default_report_period = 10;
@@ -379,8 +397,25 @@ void EstimateDedupRatio::estimate_dedup_ratio()
 
     unsigned op_size = max_read_size;
 
-    for (const auto & i : result) {
-      const auto &oid = i.oid;
+    // start the first read of every object in this batch up front, so
+    // the OSDs are working on the next objects while we chunk and
+    // fingerprint the current one
+    vector<AioCompRef> reads;
+    vector<bufferlist> read_bls(result.size());
+    reads.reserve(result.size());
+    for (size_t j = 0; j < result.size(); ++j) {
+      reads.emplace_back(Rados::aio_create_completion());
+      io_ctx.aio_read(result[j].oid, reads.back().get(), &read_bls[j],
+		      op_size, 0);
+    }
+    auto wait_reads = make_scope_guard([&reads] {
+      for (auto& c : reads) {
+	c->wait_for_complete();
+      }
+    });
+
+    for (size_t j = 0; j < result.size(); ++j) {
+      const auto &oid = result[j].oid;
 
       utime_t now = ceph_clock_now();
       if (max_seconds && now > end) {
@@ -400,17 +435,22 @@ void EstimateDedupRatio::estimate_dedup_ratio()
 	next_report += report_period;
       }
 
-      // read entire object
+      // read entire object; the first op_size bytes are already in flight
       bufferlist bl;
-      uint64_t offset = 0;
-      while (true) {
-	bufferlist t;
-	int ret = io_ctx.read(oid, t, op_size, offset);
-	if (ret <= 0) {
-	  break;
+      reads[j]->wait_for_complete();
+      if (reads[j]->get_return_value() > 0) {
+	bl.claim_append(read_bls[j]);
+	uint64_t offset = bl.length();
+	int ret = offset;
+	while (ret == (int)op_size) {
+	  bufferlist t;
+	  ret = io_ctx.read(oid, t, op_size, offset);
+	  if (ret <= 0) {
+	    break;
+	  }
+	  offset += ret;
+	  bl.claim_append(t);
 	}
-	offset += ret;
-	bl.claim_append(t);
       }
       examined_objects++;
       examined_bytes += bl.length();
@@ -419,11 +459,9 @@ void EstimateDedupRatio::estimate_dedup_ratio()
       for (auto& i : dedup_estimates) {
 	vector<pair<uint64_t, uint64_t>> chunks;
 	i.second.cdc->calc_chunks(bl, &chunks);
-	for (auto& p : chunks) {
-	  bufferlist chunk;
-	  chunk.substr_of(bl, p.first, p.second);
-	  i.second.add_chunk(chunk, fp_algo);
-	  if (debug) {
+	i.second.add_chunks(bl, chunks, fp_algo);
+	if (debug) {
+	  for (auto& p : chunks) {
 	    cout << " " << oid <<  " " << p.first << "~" << p.second << std::endl;
 	  }
 	}
@@ -534,7 +572,6 @@ void ChunkScrub::chunk_scrub_common()
   cout << "--done--" << std::endl;
 }
 
-using AioCompRef = unique_ptr<AioCompletion>;
 
 class SampleDedupWorkerThread : public Thread
 {
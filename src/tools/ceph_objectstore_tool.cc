@@ -17,7 +17,9 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/optional.hpp>
+#include <deque>
 #include <fstream>
+#include <future>
 
 #include <stdlib.h>
 
@@ -76,6 +78,11 @@ CompatSet get_test_compat_set() {
 
 const ssize_t max_read = 1024 * 1024;
 const int fd_none = INT_MIN;
+// objects read ahead of the one being written during export
+unsigned export_threads = 4;
+// objects/bytes applied per transaction during import
+const unsigned IMPORT_BATCH_OBJECTS = 64;
+const uint64_t IMPORT_BATCH_BYTES = 64 << 20;
 bool outistty;
 bool dry_run;
 
@@ -823,7 +830,8 @@ void get_omap_batch(ObjectMap::ObjectMapIterator &iter, map<string, bufferlist>
   }
 }
 
-int ObjectStoreTool::export_file(ObjectStore *store, coll_t cid, ghobject_t &obj)
+int ObjectStoreTool::export_file(ObjectStore *store, coll_t cid, ghobject_t &obj,
+				 bufferlist *out)
 {
   struct stat st;
   mysize_t total;
@@ -834,8 +842,6 @@ int ObjectStoreTool::export_file(ObjectStore *store, coll_t cid, ghobject_t &obj
   if (ret < 0)
     return ret;
 
-  cerr << "Read " << obj << std::endl;
-
   total = st.st_size;
   if (debug)
     cerr << "size=" << total << std::endl;
@@ -858,7 +864,7 @@ int ObjectStoreTool::export_file(ObjectStore *store, coll_t cid, ghobject_t &obj
 
   // NOTE: we include whiteouts, lost, etc.
 
-  ret = write_section(TYPE_OBJECT_BEGIN, objb, file_fd);
+  ret = write_section(TYPE_OBJECT_BEGIN, objb, out);
   if (ret < 0)
     return ret;
 
@@ -883,7 +889,7 @@ int ObjectStoreTool::export_file(ObjectStore *store, coll_t cid, ghobject_t &obj
     total -= ret;
     offset += ret;
 
-    ret = write_section(TYPE_DATA, dblock, file_fd);
+    ret = write_section(TYPE_DATA, dblock, out);
     if (ret) return ret;
   }
 
@@ -892,7 +898,7 @@ int ObjectStoreTool::export_file(ObjectStore *store, coll_t cid, ghobject_t &obj
   ret = store->getattrs(ch, obj, aset);
   if (ret) return ret;
   attr_section as(aset);
-  ret = write_section(TYPE_ATTRS, as, file_fd);
+  ret = write_section(TYPE_ATTRS, as, out);
   if (ret)
     return ret;
 
@@ -909,7 +915,7 @@ int ObjectStoreTool::export_file(ObjectStore *store, coll_t cid, ghobject_t &obj
   }
 
   omap_hdr_section ohs(hdrbuf);
-  ret = write_section(TYPE_OMAP_HDR, ohs, file_fd);
+  ret = write_section(TYPE_OMAP_HDR, ohs, out);
   if (ret)
     return ret;
 
@@ -929,14 +935,14 @@ int ObjectStoreTool::export_file(ObjectStore *store, coll_t cid, ghobject_t &obj
 
     mapcount += out.size();
     omap_section oms(out);
-    ret = write_section(TYPE_OMAP, oms, file_fd);
+    ret = write_section(TYPE_OMAP, oms, out);
     if (ret)
       return ret;
   }
   if (debug)
     cerr << "omap map size " << mapcount << std::endl;
 
-  ret = write_simple(TYPE_OBJECT_END, file_fd);
+  ret = write_simple(TYPE_OBJECT_END, out);
   if (ret)
     return ret;
 
@@ -945,6 +951,20 @@ int ObjectStoreTool::export_file(ObjectStore *store, coll_t cid, ghobject_t &obj
 
 int ObjectStoreTool::export_files(ObjectStore *store, coll_t coll)
 {
+  // Objects are read by up to export_threads workers, each into its own
+  // in-memory stream, and written out in listing order as they finish.
+  using result_t = std::pair<int, bufferlist>;
+  std::deque<std::pair<ghobject_t, std::future<result_t>>> inflight;
+  auto write_oldest = [&]() {
+    auto& [obj, f] = inflight.front();
+    auto [r, bl] = f.get();
+    cerr << "Read " << obj << std::endl;
+    inflight.pop_front();
+    if (r < 0)
+      return r;
+    return bl.length() ? bl.write_fd(file_fd) : 0;
+  };
+
   ghobject_t next;
   auto ch = store->open_collection(coll);
   while (!next.is_max()) {
@@ -960,11 +980,25 @@ int ObjectStoreTool::export_files(ObjectStore *store, coll_t coll)
       if (i->is_pgmeta() || i->hobj.is_temp() || !i->is_no_gen()) {
 	continue;
       }
-      r = export_file(store, coll, *i);
-      if (r < 0)
-        return r;
+      if (inflight.size() >= std::max(1u, export_threads)) {
+	r = write_oldest();
+	if (r < 0)
+	  return r;
+      }
+      inflight.emplace_back(
+	*i,
+	std::async(std::launch::async, [this, store, coll, obj = *i]() mutable {
+	  bufferlist bl;
+	  int r = export_file(store, coll, obj, &bl);
+	  return result_t(r, std::move(bl));
+	}));
     }
   }
+  while (!inflight.empty()) {
+    int r = write_oldest();
+    if (r < 0)
+      return r;
+  }
   return 0;
 }
 
@@ -1410,10 +1444,9 @@ int ObjectStoreTool::get_object(ObjectStore *store,
 				SnapMapper& mapper,
 				coll_t coll,
 				bufferlist &bl, OSDMap &origmap,
-				bool *skipped_objects)
+				bool *skipped_objects,
+				ObjectStore::Transaction *t)
 {
-  ObjectStore::Transaction tran;
-  ObjectStore::Transaction *t = &tran;
   auto ebliter = bl.cbegin();
   object_begin ob;
   ob.decode(ebliter);
@@ -1424,7 +1457,6 @@ int ObjectStoreTool::get_object(ObjectStore *store,
   }
   ceph_assert(g_ceph_context);
 
-  auto ch = store->open_collection(coll);
   if (ob.hoid.hobj.nspace != g_ceph_context->_conf->osd_hit_set_namespace) {
     object_t oid = ob.hoid.hobj.oid;
     object_locator_t loc(ob.hoid.hobj);
@@ -1498,12 +1530,6 @@ int ObjectStoreTool::get_object(ObjectStore *store,
       return -EFAULT;
     }
   }
-  if (!dry_run) {
-    wait_until_done(t, [&] {
-      store->queue_transaction(ch, std::move(*t));
-      ch->flush();
-    });
-  }
   return 0;
 }
 
@@ -1885,6 +1911,21 @@ int ObjectStoreTool::do_import(ObjectStore *store, OSDSuperblock& sb,
     OSD::make_snapmapper_oid());
   SnapMapper mapper(g_ceph_context, &driver, 0, 0, 0, pgid.shard);
 
+  // objects are applied IMPORT_BATCH_OBJECTS at a time rather than one
+  // transaction each
+  ObjectStore::Transaction objects_t;
+  unsigned batched_objects = 0;
+  auto flush_objects = [&]() {
+    if (!dry_run && !objects_t.empty()) {
+      wait_until_done(&objects_t, [&] {
+	store->queue_transaction(ch, std::move(objects_t));
+	ch->flush();
+      });
+    }
+    objects_t = ObjectStore::Transaction();
+    batched_objects = 0;
+  };
+
   cout << "Importing pgid " << pgid;
   cout << std::endl;
 
@@ -1907,8 +1948,12 @@ int ObjectStoreTool::do_import(ObjectStore *store, OSDSuperblock& sb,
     case TYPE_OBJECT_BEGIN:
       ceph_assert(found_metadata);
       ret = get_object(store, driver, mapper, coll, ebl, ms.osdmap,
-		       &skipped_objects);
+		       &skipped_objects, &objects_t);
       if (ret) return ret;
+      if (++batched_objects >= IMPORT_BATCH_OBJECTS ||
+	  objects_t.get_num_bytes() >= IMPORT_BATCH_BYTES) {
+	flush_objects();
+      }
       break;
     case TYPE_PG_METADATA:
       ret = get_pg_metadata(store, ebl, ms, sb, pgid);
@@ -1988,6 +2033,7 @@ int ObjectStoreTool::do_import(ObjectStore *store, OSDSuperblock& sb,
       break;
     case TYPE_PG_END:
       ceph_assert(found_metadata);
+      flush_objects();
       done = true;
       break;
     default:
@@ -3465,6 +3511,8 @@ int main(int argc, char **argv)
     ("rmtype", po::value<string>(&rmtypestr), "Specify corrupting object removal 'snapmap' or 'nosnapmap' - TESTING USE ONLY")
     ("slow-omap-threshold", po::value<unsigned>(&slow_threshold),
       "Threshold (in seconds) to consider omap listing slow (for op=list-slow-omap)")
+    ("export-threads", po::value<unsigned>(&export_threads),
+      "Number of objects read in parallel for export and export-remove (default 4)")
     ;
 
   po::options_description positional("Positional options");
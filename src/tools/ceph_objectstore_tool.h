@@ -35,9 +35,10 @@ class ObjectStoreTool : public RadosDump
 				bufferlist &bl);
     int get_object(
       ObjectStore *store, OSDriver& driver, SnapMapper& mapper, coll_t coll,
-      bufferlist &bl, OSDMap &curmap, bool *skipped_objects);
+      bufferlist &bl, OSDMap &curmap, bool *skipped_objects,
+      ObjectStore::Transaction *t);
     int export_file(
-        ObjectStore *store, coll_t cid, ghobject_t &obj);
+        ObjectStore *store, coll_t cid, ghobject_t &obj, bufferlist *out);
     int export_files(ObjectStore *store, coll_t coll);
 };
 
@@ -680,6 +680,188 @@ close_local_fd:
   return r == 0 ? 0 : r;
 }
 
+bool PeerReplayer::can_copy_changed_blocks(const std::string &epath, const FHandles &fh,
+                                           struct ceph_statx *pstx) {
+  // need the previous snapshot locally to compare against...
+  if (fh.p_mnt != m_local_mount) {
+    return false;
+  }
+
+  int r = ceph_statxat(fh.p_mnt, fh.p_fd, epath.c_str(), pstx,
+                       CEPH_STATX_MODE | CEPH_STATX_SIZE | CEPH_STATX_MTIME,
+                       AT_STATX_DONT_SYNC | AT_SYMLINK_NOFOLLOW);
+  if (r < 0 || !S_ISREG(pstx->stx_mode)) {
+    return false;
+  }
+
+  // ...and the remote file must still be the copy synchronized from it
+  // (an interrupted sync leaves it with a different size or mtime).
+  struct ceph_statx rstx;
+  r = ceph_statxat(m_remote_mount, fh.r_fd_dir_root, epath.c_str(), &rstx,
+                   CEPH_STATX_MODE | CEPH_STATX_SIZE | CEPH_STATX_MTIME,
+                   AT_SYMLINK_NOFOLLOW);
+  if (r < 0 || !S_ISREG(rstx.stx_mode)) {
+    return false;
+  }
+
+  dout(10) << ": epath=" << epath << ", prev size=" << pstx->stx_size << ", mtime="
+           << pstx->stx_mtime << ", remote size=" << rstx.stx_size << ", mtime="
+           << rstx.stx_mtime << dendl;
+  return rstx.stx_size == pstx->stx_size && rstx.stx_mtime == pstx->stx_mtime;
+}
+
+#define DIFF_BLOCK_SIZE (64 * 1024) // granularity of changed block detection
+
+int PeerReplayer::copy_changed_blocks(const std::string &dir_root, const std::string &epath,
+                                      const struct ceph_statx &stx,
+                                      const struct ceph_statx &pstx, const FHandles &fh) {
+  dout(10) << ": dir_root=" << dir_root << ", epath=" << epath << dendl;
+  int l_fd;
+  int p_fd;
+  int r_fd;
+  char *cbuf;
+  char *pbuf;
+  uint64_t off = 0;
+  uint64_t copied = 0;
+
+  int r = ceph_openat(m_local_mount, fh.c_fd, epath.c_str(), O_RDONLY | O_NOFOLLOW, 0);
+  if (r < 0) {
+    derr << ": failed to open local file path=" << epath << ": "
+         << cpp_strerror(r) << dendl;
+    return r;
+  }
+
+  l_fd = r;
+  r = ceph_openat(m_local_mount, fh.p_fd, epath.c_str(), O_RDONLY | O_NOFOLLOW, 0);
+  if (r < 0) {
+    derr << ": failed to open previous snapshot file path=" << epath << ": "
+         << cpp_strerror(r) << dendl;
+    goto close_local_fd;
+  }
+
+  p_fd = r;
+  r = ceph_openat(m_remote_mount, fh.r_fd_dir_root, epath.c_str(),
+                  O_WRONLY | O_NOFOLLOW, 0);
+  if (r < 0) {
+    derr << ": failed to open remote file path=" << epath << ": "
+         << cpp_strerror(r) << dendl;
+    goto close_prev_fd;
+  }
+
+  r_fd = r;
+  cbuf = (char *)malloc(2 * IOVEC_SIZE);
+  if (!cbuf) {
+    r = -ENOMEM;
+    derr << ": failed to allocate memory" << dendl;
+    goto close_remote_fd;
+  }
+  pbuf = cbuf + IOVEC_SIZE;
+
+  while (off < stx.stx_size) {
+    if (should_backoff(dir_root, &r)) {
+      dout(0) << ": backing off r=" << r << dendl;
+      break;
+    }
+
+    r = ceph_read(m_local_mount, l_fd, cbuf, IOVEC_SIZE, off);
+    if (r < 0) {
+      derr << ": failed to read local file path=" << epath << ": "
+           << cpp_strerror(r) << dendl;
+      break;
+    }
+    if (r == 0) {
+      break;
+    }
+    uint64_t clen = r;
+
+    uint64_t plen = 0;
+    if (off < pstx.stx_size) {
+      r = ceph_read(m_local_mount, p_fd, pbuf, clen, off);
+      if (r < 0) {
+        derr << ": failed to read previous snapshot file path=" << epath << ": "
+             << cpp_strerror(r) << dendl;
+        break;
+      }
+      plen = r;
+    }
+
+    // write out runs of blocks that differ from the previous snapshot
+    uint64_t start = 0;
+    while (start < clen) {
+      uint64_t len = std::min<uint64_t>(DIFF_BLOCK_SIZE, clen - start);
+      if (start + len <= plen && memcmp(cbuf + start, pbuf + start, len) == 0) {
+        start += len;
+        continue;
+      }
+      uint64_t end = start + len;
+      while (end < clen) {
+        len = std::min<uint64_t>(DIFF_BLOCK_SIZE, clen - end);
+        if (end + len <= plen && memcmp(cbuf + end, pbuf + end, len) == 0) {
+          break;
+        }
+        end += len;
+      }
+      r = ceph_write(m_remote_mount, r_fd, cbuf + start, end - start, off + start);
+      if (r < 0) {
+        derr << ": failed to write remote file path=" << epath << ": "
+             << cpp_strerror(r) << dendl;
+        break;
+      }
+      copied += end - start;
+      start = end;
+    }
+    if (r < 0) {
+      break;
+    }
+
+    off += clen;
+    r = 0;
+  }
+
+  if (r == 0 && stx.stx_size < pstx.stx_size) {
+    r = ceph_ftruncate(m_remote_mount, r_fd, stx.stx_size);
+    if (r < 0) {
+      derr << ": failed to truncate remote file path=" << epath << ": "
+           << cpp_strerror(r) << dendl;
+    }
+  }
+
+  if (r == 0) {
+    r = ceph_fsync(m_remote_mount, r_fd, 0);
+    if (r < 0) {
+      derr << ": failed to sync data for file path=" << epath << ": "
+           << cpp_strerror(r) << dendl;
+    }
+  }
+
+  dout(10) << ": epath=" << epath << ", copied " << copied << " of "
+           << stx.stx_size << " bytes" << dendl;
+  free(cbuf);
+
+close_remote_fd:
+  if (ceph_close(m_remote_mount, r_fd) < 0) {
+    derr << ": failed to close remote fd path=" << epath << ": " << cpp_strerror(r)
+         << dendl;
+    return -EINVAL;
+  }
+
+close_prev_fd:
+  if (ceph_close(m_local_mount, p_fd) < 0) {
+    derr << ": failed to close previous snapshot fd path=" << epath << ": "
+         << cpp_strerror(r) << dendl;
+    return -EINVAL;
+  }
+
+close_local_fd:
+  if (ceph_close(m_local_mount, l_fd) < 0) {
+    derr << ": failed to close local fd path=" << epath << ": " << cpp_strerror(r)
+         << dendl;
+    return -EINVAL;
+  }
+
+  return r == 0 ? 0 : r;
+}
+
 int PeerReplayer::remote_file_op(const std::string &dir_root, const std::string &epath,
                                  const struct ceph_statx &stx, const FHandles &fh,
                                  bool need_data_sync, bool need_attr_sync) {
@@ -689,7 +871,12 @@ int PeerReplayer::remote_file_op(const std::string &dir_root, const std::string
   int r;
   if (need_data_sync) {
     if (S_ISREG(stx.stx_mode)) {
-      r = copy_to_remote(dir_root, epath, stx, fh);
+      struct ceph_statx pstx;
+      if (can_copy_changed_blocks(epath, fh, &pstx)) {
+        r = copy_changed_blocks(dir_root, epath, stx, pstx, fh);
+      } else {
+        r = copy_to_remote(dir_root, epath, stx, fh);
+      }
       if (r < 0) {
         derr << ": failed to copy path=" << epath << ": " << cpp_strerror(r) << dendl;
         return r;
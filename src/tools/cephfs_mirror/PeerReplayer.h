@@ -311,6 +311,11 @@ private:
                      const FHandles &fh, bool need_data_sync, bool need_attr_sync);
   int copy_to_remote(const std::string &dir_root, const std::string &epath, const struct ceph_statx &stx,
                      const FHandles &fh);
+  bool can_copy_changed_blocks(const std::string &epath, const FHandles &fh,
+                               struct ceph_statx *pstx);
+  int copy_changed_blocks(const std::string &dir_root, const std::string &epath,
+                          const struct ceph_statx &stx, const struct ceph_statx &pstx,
+                          const FHandles &fh);
 };
 
 } // namespace mirror
@@ -215,6 +215,7 @@ void usage()
   cout << "      [--min-rep n] [--max-rep n] [--num-rep n]\n";
   cout << "      [--pool-id n]      specifies pool id\n";
   cout << "      [--batches b]      split the CRUSH mapping into b > 1 rounds\n";
+  cout << "      [--threads n]      map the inputs on n threads\n";
   cout << "      [--weight|-w devno weight]\n";
   cout << "                         where weight is 0 to 1.0\n";
   cout << "      [--simulate]       simulate placements using a random\n";
@@ -223,6 +224,9 @@ void usage()
   cout << "   --show-utilization    show OSD usage\n";
   cout << "   --show-utilization-all\n";
   cout << "                         include zero weight items\n";
+  cout << "   --show-utilization-histogram\n";
+  cout << "                         show how many OSDs hold each fraction\n";
+  cout << "                         of their expected usage\n";
   cout << "   --show-statistics     show chi squared statistics\n";
   cout << "   --show-mappings       show mappings\n";
   cout << "   --show-bad-mappings   show bad mappings\n";
@@ -526,6 +530,9 @@ int main(int argc, const char **argv)
     } else if (ceph_argparse_flag(args, i, "--show_utilization_all", (char*)NULL)) {
       display = true;
       tester.set_output_utilization_all(true);
+    } else if (ceph_argparse_flag(args, i, "--show_utilization_histogram", (char*)NULL)) {
+      display = true;
+      tester.set_output_utilization_histogram(true);
     } else if (ceph_argparse_flag(args, i, "--show_statistics", (char*)NULL)) {
       display = true;
       tester.set_output_statistics(true);
@@ -812,6 +819,12 @@ int main(int argc, const char **argv)
 	return EXIT_FAILURE;
       }
       tester.set_batches(x);
+    } else if (ceph_argparse_witharg(args, i, &x, err, "--threads", (char*)NULL)) {
+      if (!err.str().empty()) {
+	cerr << err.str() << std::endl;
+	return EXIT_FAILURE;
+      }
+      tester.set_threads(x);
     } else if (ceph_argparse_witharg(args, i, &y, err, "--mark-down-ratio", (char*)NULL)) {
       if (!err.str().empty()) {
         cerr << err.str() << std::endl;
@@ -59,6 +59,9 @@ ObjectCacheStore::ObjectCacheStore(CephContext *cct)
   uint64_t max_inflight_ops =
     m_cct->_conf.get_val<uint64_t>("immutable_object_cache_max_inflight_ops");
 
+  m_prefetch_objects =
+    m_cct->_conf.get_val<uint64_t>("immutable_object_cache_prefetch_objects");
+
   uint64_t limit = 0;
   if ((limit = m_cct->_conf.get_val<uint64_t>
                    ("immutable_object_cache_qos_iops_limit")) != 0) {
@@ -250,6 +253,10 @@ int ObjectCacheStore::lookup_object(std::string pool_nspace, uint64_t pool_id,
   std::string cache_file_name =
     get_cache_file_name(pool_nspace, pool_id, snap_id, object_name);
 
+  if (m_prefetch_objects > 0) {
+    prefetch_objects(pool_nspace, pool_id, snap_id, object_size, object_name);
+  }
+
   cache_status_t ret = m_policy->lookup_object(cache_file_name);
 
   switch (ret) {
@@ -280,6 +287,83 @@ int ObjectCacheStore::lookup_object(std::string pool_nspace, uint64_t pool_id,
   }
 }
 
+void ObjectCacheStore::promote_if_absent(std::string pool_nspace,
+                                         uint64_t pool_id, uint64_t snap_id,
+                                         uint64_t object_size,
+                                         std::string object_name) {
+  std::string cache_file_name =
+    get_cache_file_name(pool_nspace, pool_id, snap_id, object_name);
+  if (m_policy->lookup_object(cache_file_name) != OBJ_CACHE_NONE) {
+    return;
+  }
+
+  ldout(m_cct, 20) << "prefetching " << object_name << dendl;
+  if (take_token_from_throttle(object_size, 1)) {
+    int r = do_promote(pool_nspace, pool_id, snap_id, object_name);
+    if (r < 0) {
+      lderr(m_cct) << "fail to start prefetch" << dendl;
+    }
+  } else {
+    m_policy->update_status(cache_file_name, OBJ_CACHE_NONE);
+  }
+}
+
+/*
+ * Data objects are named <prefix>.<hex object number>. When an image's
+ * objects are looked up in increasing order (a clone booting, say),
+ * promote the next few objects before they are asked for.
+ */
+void ObjectCacheStore::prefetch_objects(std::string pool_nspace,
+                                        uint64_t pool_id, uint64_t snap_id,
+                                        uint64_t object_size,
+                                        std::string object_name) {
+  auto dot = object_name.rfind('.');
+  if (dot == std::string::npos || dot + 1 == object_name.size()) {
+    return;
+  }
+  std::string prefix = object_name.substr(0, dot + 1);
+  std::string suffix = object_name.substr(dot + 1);
+  char* end = nullptr;
+  uint64_t object_no = strtoull(suffix.c_str(), &end, 16);
+  if (*end != '\0') {
+    return;
+  }
+
+  std::string stream_key =
+    get_cache_file_name(pool_nspace, pool_id, snap_id, prefix);
+  {
+    std::lock_guard locker{m_prefetch_lock};
+    auto it = m_last_object_no.find(stream_key);
+    if (it == m_last_object_no.end()) {
+      if (m_last_object_no.size() >= 1024) {
+        // forget old streams rather than grow without bound
+        m_last_object_no.clear();
+      }
+      m_last_object_no[stream_key] = object_no;
+      return;
+    }
+    uint64_t last_object_no = it->second;
+    if (object_no <= last_object_no) {
+      if (object_no < last_object_no) {
+        it->second = object_no;
+      }
+      return;
+    }
+    it->second = object_no;
+    if (object_no != last_object_no + 1) {
+      return;
+    }
+  }
+
+  for (uint64_t i = 1; i <= m_prefetch_objects; ++i) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%0*llx", static_cast<int>(suffix.size()),
+             static_cast<unsigned long long>(object_no + i));
+    promote_if_absent(pool_nspace, pool_id, snap_id, object_size,
+                      prefix + buf);
+  }
+}
+
 int ObjectCacheStore::promote_object(librados::IoCtx* ioctx,
                                      std::string object_name,
                                      librados::bufferlist* read_buf,
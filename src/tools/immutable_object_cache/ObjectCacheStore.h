@@ -55,6 +55,12 @@ class ObjectCacheStore {
                      Context* on_finish);
   int handle_promote_callback(int, bufferlist*, std::string);
   int do_evict(std::string cache_file);
+  void promote_if_absent(std::string pool_nspace, uint64_t pool_id,
+                         uint64_t snap_id, uint64_t object_size,
+                         std::string object_name);
+  void prefetch_objects(std::string pool_nspace, uint64_t pool_id,
+                        uint64_t snap_id, uint64_t object_size,
+                        std::string object_name);
 
   bool take_token_from_throttle(uint64_t object_size, uint64_t object_num);
   void handle_throttle_ready(uint64_t tokens, uint64_t type);
@@ -78,6 +84,11 @@ class ObjectCacheStore {
     ceph::make_mutex("ceph::cache::ObjectCacheStore::m_throttle_lock");;
   uint64_t m_iops_tokens{0};
   uint64_t m_bps_tokens{0};
+  // sequential read detection: last object number looked up per image
+  uint64_t m_prefetch_objects{0};
+  std::map<std::string, uint64_t> m_last_object_no;
+  ceph::mutex m_prefetch_lock =
+    ceph::make_mutex("ceph::cache::ObjectCacheStore::m_prefetch_lock");
 };
 
 }  // namespace immutable_obj_cache
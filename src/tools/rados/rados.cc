@@ -241,6 +241,9 @@ void usage(ostream& out)
 "        prefix output with date/time\n"
 "   --no-verify\n"
 "        do not verify contents of read objects\n"
+"   --rate=N\n"
+"        issue writes open loop at N per second with random arrivals,\n"
+"        with at most -t outstanding (write bench only)\n"
 "   --write-object\n"
 "        write contents to the objects\n"
 "   --write-omap\n"
@@ -1886,6 +1889,7 @@ static int rados_tool_common(const std::map < std::string, std::string > &opts,
   bool hints = true; // for rados bench
   bool reuse_bench = false;
   bool no_verify = false;
+  uint64_t bench_rate = 0;
   bool use_striper = false;
   bool with_clones = false;
   const char *snapname = NULL;
@@ -2098,6 +2102,12 @@ static int rados_tool_common(const std::map < std::string, std::string > &opts,
   if (i != opts.end()) {
     no_verify = true;
   }
+  i = opts.find("rate");
+  if (i != opts.end()) {
+    if (rados_sistrtoll(i, &bench_rate)) {
+      return -EINVAL;
+    }
+  }
   i = opts.find("output");
   if (i != opts.end()) {
     output = i->second.c_str();
@@ -3292,6 +3302,11 @@ static int rados_tool_common(const std::map < std::string, std::string > &opts,
              << std::endl;
         return 1;
       }
+      if (bench_rate) {
+        cerr << "--rate option can be used only with 'write' bench test"
+             << std::endl;
+        return 1;
+      }
     }
     else if (bench_write_dest == 0) {
       bench_write_dest = OP_WRITE_DEST_OBJ;
@@ -3304,6 +3319,7 @@ static int rados_tool_common(const std::map < std::string, std::string > &opts,
     }
     RadosBencher bencher(g_ceph_context, rados, io_ctx);
     bencher.set_show_time(show_time);
+    bencher.set_target_rate(bench_rate);
     bencher.set_write_destination(static_cast<OpWriteDest>(bench_write_dest));
 
     ostream *outstream = NULL;
@@ -4110,6 +4126,8 @@ int main(int argc, const char **argv)
       opts["reuse-bench"] = "true";
     } else if (ceph_argparse_flag(args, i, "--no-verify", (char*)NULL)) {
       opts["no-verify"] = "true";
+    } else if (ceph_argparse_witharg(args, i, &val, "--rate", (char*)NULL)) {
+      opts["rate"] = val;
     } else if (ceph_argparse_witharg(args, i, &val, "--run-name", (char*)NULL)) {
       opts["run-name"] = val;
     } else if (ceph_argparse_witharg(args, i, &val, "--prefix", (char*)NULL)) {
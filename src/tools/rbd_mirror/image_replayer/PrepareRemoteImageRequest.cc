@@ -139,6 +139,8 @@ void PrepareRemoteImageRequest<I>::get_client() {
   ::journal::Settings journal_settings;
   journal_settings.commit_interval = cct->_conf.get_val<double>(
     "rbd_mirror_journal_commit_age");
+  journal_settings.fetch_ahead_objects = cct->_conf.get_val<uint64_t>(
+    "rbd_mirror_journal_fetch_ahead_objects");
 
   // TODO use Journal thread pool for journal ops until converted to ASIO
   ContextWQ* context_wq;
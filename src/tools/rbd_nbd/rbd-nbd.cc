@@ -46,9 +46,11 @@
 
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <regex>
+#include <vector>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/lexical_cast.hpp>
 
@@ -100,6 +102,7 @@ struct Config {
   int max_part = 255;
   int io_timeout = -1;
   int reattach_timeout = 30;
+  int connections = 1;
 
   bool exclusive = false;
   bool notrim = false;
@@ -167,6 +170,9 @@ static void usage()
             << "  --reattach-timeout <sec>      Set nbd re-attach timeout\n"
             << "                                (default: " << Config().reattach_timeout << ")\n"
             << "  --try-netlink                 Use the nbd netlink interface\n"
+            << "  --connections <count>         Number of nbd connections, each with\n"
+            << "                                its own IO threads (netlink only)\n"
+            << "                                (default: " << Config().connections << ")\n"
             << "  --show-cookie                 Show device cookie\n"
             << "  --cookie                      Specify device cookie\n"
             << "  --snap-id <snap-id>           Specify snapshot by ID instead of by name\n"
@@ -208,19 +214,19 @@ public:
   uint64_t quiesce_watch_handle = 0;
 
 private:
-  int fd;
   librbd::Image &image;
   Config *cfg;
 
 public:
-  NBDServer(int fd, librbd::Image& image, Config *cfg)
-    : fd(fd)
-    , image(image)
+  NBDServer(const std::vector<int> &fds, librbd::Image& image, Config *cfg)
+    : image(image)
     , cfg(cfg)
-    , reader_thread(*this, &NBDServer::reader_entry)
-    , writer_thread(*this, &NBDServer::writer_entry)
-    , quiesce_thread(*this, &NBDServer::quiesce_entry)
+    , quiesce_thread([this] { quiesce_entry(); })
   {
+    for (auto fd : fds) {
+      connections.emplace_back(new Connection(this, fd));
+    }
+
     std::vector<librbd::config_option_t> options;
     image.config_list(&options);
     for (auto &option : options) {
@@ -245,10 +251,29 @@ private:
   std::atomic<bool> terminated = { false };
   std::atomic<bool> allow_internal_flush = { false };
 
+  class ThreadHelper : public Thread
+  {
+  private:
+    std::function<void()> func;
+  public:
+    ThreadHelper(std::function<void()> &&_func)
+      :func(std::move(_func))
+    {}
+  protected:
+    void* entry() override
+    {
+      func();
+      return NULL;
+    }
+  };
+
+  struct Connection;
+
   struct IOContext
   {
     xlist<IOContext*>::item item;
     NBDServer *server = nullptr;
+    Connection *conn = nullptr;
     struct nbd_request request;
     struct nbd_reply reply;
     bufferlist data;
@@ -261,15 +286,31 @@ private:
 
   friend std::ostream &operator<<(std::ostream &os, const IOContext &ctx);
 
+  // each nbd connection (socket) is served by its own reader and writer
+  struct Connection
+  {
+    int fd;
+    xlist<IOContext*> io_pending;
+    xlist<IOContext*> io_finished;
+    ThreadHelper reader_thread;
+    ThreadHelper writer_thread;
+
+    Connection(NBDServer *server, int fd)
+      : fd(fd)
+      , reader_thread([server, this] { server->reader_entry(this); })
+      , writer_thread([server, this] { server->writer_entry(this); })
+    {}
+  };
+
+  std::vector<std::unique_ptr<Connection>> connections;
+
   ceph::mutex lock = ceph::make_mutex("NBDServer::Locker");
   ceph::condition_variable cond;
-  xlist<IOContext*> io_pending;
-  xlist<IOContext*> io_finished;
 
   void io_start(IOContext *ctx)
   {
     std::lock_guard l{lock};
-    io_pending.push_back(&ctx->item);
+    ctx->conn->io_pending.push_back(&ctx->item);
   }
 
   void io_finish(IOContext *ctx)
@@ -277,35 +318,35 @@ private:
     std::lock_guard l{lock};
     ceph_assert(ctx->item.is_on_list());
     ctx->item.remove_myself();
-    io_finished.push_back(&ctx->item);
+    ctx->conn->io_finished.push_back(&ctx->item);
     cond.notify_all();
   }
 
-  IOContext *wait_io_finish()
+  IOContext *wait_io_finish(Connection *conn)
   {
     std::unique_lock l{lock};
-    cond.wait(l, [this] {
-                   return !io_finished.empty() ||
-                          (io_pending.empty() && terminated);
+    cond.wait(l, [this, conn] {
+                   return !conn->io_finished.empty() ||
+                          (conn->io_pending.empty() && terminated);
                  });
 
-    if (io_finished.empty())
+    if (conn->io_finished.empty())
       return NULL;
 
-    IOContext *ret = io_finished.front();
-    io_finished.pop_front();
+    IOContext *ret = conn->io_finished.front();
+    conn->io_finished.pop_front();
 
     return ret;
   }
 
-  void wait_clean()
+  void wait_clean(Connection *conn)
   {
     std::unique_lock l{lock};
-    cond.wait(l, [this] { return io_pending.empty(); });
+    cond.wait(l, [conn] { return conn->io_pending.empty(); });
 
-    while(!io_finished.empty()) {
-      std::unique_ptr<IOContext> free_ctx(io_finished.front());
-      io_finished.pop_front();
+    while(!conn->io_finished.empty()) {
+      std::unique_ptr<IOContext> free_ctx(conn->io_finished.front());
+      conn->io_finished.pop_front();
     }
   }
 
@@ -313,10 +354,12 @@ private:
   {
     std::unique_lock l{lock};
 
-    ceph_assert(!reader_thread.is_started());
-    ceph_assert(!writer_thread.is_started());
-    ceph_assert(io_pending.empty());
-    ceph_assert(io_finished.empty());
+    for (auto &conn : connections) {
+      ceph_assert(!conn->reader_thread.is_started());
+      ceph_assert(!conn->writer_thread.is_started());
+      ceph_assert(conn->io_pending.empty());
+      ceph_assert(conn->io_finished.empty());
+    }
   }
 
   static void aio_callback(librbd::completion_t cb, void *arg)
@@ -354,8 +397,9 @@ private:
     aio_completion->release();
   }
 
-  void reader_entry()
+  void reader_entry(Connection *conn)
   {
+    int fd = conn->fd;
     struct pollfd poll_fds[2];
     memset(poll_fds, 0, sizeof(struct pollfd) * 2);
     poll_fds[0].fd = fd;
@@ -366,6 +410,7 @@ private:
     while (true) {
       std::unique_ptr<IOContext> ctx(new IOContext());
       ctx->server = this;
+      ctx->conn = conn;
 
       dout(20) << __func__ << ": waiting for nbd request" << dendl;
 
@@ -455,7 +500,8 @@ private:
       }
     }
 error:
-    {
+    // a disconnect tears down all connections -- only issue it once
+    if (!terminated) {
       int r = netlink_disconnect(nbd_index);
       if (r == 1) {
         ioctl(nbd, NBD_DISCONNECT);
@@ -472,11 +518,12 @@ signal:
     dout(20) << __func__ << ": terminated" << dendl;
   }
 
-  void writer_entry()
+  void writer_entry(Connection *conn)
   {
+    int fd = conn->fd;
     while (true) {
       dout(20) << __func__ << ": waiting for io request" << dendl;
-      std::unique_ptr<IOContext> ctx(wait_io_finish());
+      std::unique_ptr<IOContext> ctx(wait_io_finish(conn));
       if (!ctx) {
 	dout(20) << __func__ << ": no io requests, terminating" << dendl;
         goto done;
@@ -501,7 +548,7 @@ signal:
       dout(20) << *ctx << ": finish" << dendl;
     }
   error:
-    wait_clean();
+    wait_clean(conn);
   done:
     ::shutdown(fd, SHUT_RDWR);
 
@@ -583,25 +630,7 @@ signal:
     dout(20) << __func__ << ": terminated" << dendl;
   }
 
-  class ThreadHelper : public Thread
-  {
-  public:
-    typedef void (NBDServer::*entry_func)();
-  private:
-    NBDServer &server;
-    entry_func func;
-  public:
-    ThreadHelper(NBDServer &_server, entry_func _func)
-      :server(_server)
-      ,func(_func)
-    {}
-  protected:
-    void* entry() override
-    {
-      (server.*func)();
-      return NULL;
-    }
-  } reader_thread, writer_thread, quiesce_thread;
+  ThreadHelper quiesce_thread;
 
   bool started = false;
   bool quiesce = false;
@@ -620,8 +649,10 @@ public:
                                         EVENT_SOCKET_TYPE_EVENTFD);
       ceph_assert(r >= 0);
 
-      reader_thread.create("rbd_reader");
-      writer_thread.create("rbd_writer");
+      for (auto &conn : connections) {
+        conn->reader_thread.create("rbd_reader");
+        conn->writer_thread.create("rbd_writer");
+      }
       if (cfg->quiesce) {
         quiesce_thread.create("rbd_quiesce");
       }
@@ -666,8 +697,10 @@ public:
 
       terminate_event_sock.notify();
 
-      reader_thread.join();
-      writer_thread.join();
+      for (auto &conn : connections) {
+        conn->reader_thread.join();
+        conn->writer_thread.join();
+      }
       if (cfg->quiesce) {
         quiesce_thread.join();
       }
@@ -1343,8 +1376,9 @@ static int netlink_connect_cb(struct nl_msg *msg, void *arg)
   return NL_OK;
 }
 
-static int netlink_connect(Config *cfg, struct nl_sock *sock, int nl_id, int fd,
-                           uint64_t size, uint64_t flags, bool reconnect)
+static int netlink_connect(Config *cfg, struct nl_sock *sock, int nl_id,
+                           const std::vector<int> &fds, uint64_t size,
+                           uint64_t flags, bool reconnect)
 {
   struct nlattr *sock_attr;
   struct nlattr *sock_opt;
@@ -1399,14 +1433,16 @@ static int netlink_connect(Config *cfg, struct nl_sock *sock, int nl_id, int fd,
     goto free_msg;
   }
 
-  sock_opt = nla_nest_start(msg, NBD_SOCK_ITEM);
-  if (!sock_opt) {
-    cerr << "rbd-nbd: Could not init sock in netlink message." << std::endl;
-    goto free_msg;
-  }
+  for (auto fd : fds) {
+    sock_opt = nla_nest_start(msg, NBD_SOCK_ITEM);
+    if (!sock_opt) {
+      cerr << "rbd-nbd: Could not init sock in netlink message." << std::endl;
+      goto free_msg;
+    }
 
-  NLA_PUT_U32(msg, NBD_SOCK_FD, fd);
-  nla_nest_end(msg, sock_opt);
+    NLA_PUT_U32(msg, NBD_SOCK_FD, fd);
+    nla_nest_end(msg, sock_opt);
+  }
   nla_nest_end(msg, sock_attr);
 
   ret = nl_send_sync(sock, msg);
@@ -1425,8 +1461,8 @@ free_msg:
   return -EIO;
 }
 
-static int try_netlink_setup(Config *cfg, int fd, uint64_t size, uint64_t flags,
-                             bool reconnect)
+static int try_netlink_setup(Config *cfg, const std::vector<int> &fds,
+                             uint64_t size, uint64_t flags, bool reconnect)
 {
   struct nl_sock *sock;
   int nl_id, ret;
@@ -1440,7 +1476,7 @@ static int try_netlink_setup(Config *cfg, int fd, uint64_t size, uint64_t flags,
 
   dout(10) << "netlink interface supported." << dendl;
 
-  ret = netlink_connect(cfg, sock, nl_id, fd, size, flags, reconnect);
+  ret = netlink_connect(cfg, sock, nl_id, fds, size, flags, reconnect);
   netlink_cleanup(sock);
 
   if (ret != 0)
@@ -1496,11 +1532,12 @@ static void handle_signal(int signum)
   terminate_event_sock.notify();
 }
 
-static NBDServer *start_server(int fd, librbd::Image& image, Config *cfg)
+static NBDServer *start_server(const std::vector<int> &fds,
+                               librbd::Image& image, Config *cfg)
 {
   NBDServer *server;
 
-  server = new NBDServer(fd, image, cfg);
+  server = new NBDServer(fds, image, cfg);
   server->start();
 
   init_async_signal_handler();
@@ -1626,7 +1663,9 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
   unsigned long blksize = RBD_NBD_BLKSIZE;
   bool use_netlink;
 
-  int fd[2];
+  // kernel and server ends of the socket pair of each nbd connection
+  std::vector<int> nbd_fds;
+  std::vector<int> server_fds;
 
   librbd::image_info_t info;
 
@@ -1667,9 +1706,14 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
   common_init_finish(g_ceph_context);
   global_init_chdir(g_ceph_context);
 
-  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fd) == -1) {
-    r = -errno;
-    goto close_ret;
+  for (int i = 0; i < cfg->connections; i++) {
+    int fd[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fd) == -1) {
+      r = -errno;
+      goto close_fd;
+    }
+    nbd_fds.push_back(fd[0]);
+    server_fds.push_back(fd[1]);
   }
 
   r = rados.init_with_context(g_ceph_context);
@@ -1799,7 +1843,7 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
   if (r < 0)
     goto close_fd;
 
-  server = start_server(fd[1], image, cfg);
+  server = start_server(server_fds, image, cfg);
 
   use_netlink = cfg->try_netlink || reconnect;
   if (use_netlink) {
@@ -1809,7 +1853,7 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
       uuid_gen.generate_random();
       cfg->cookie = uuid_gen.to_string();
     }
-    r = try_netlink_setup(cfg, fd[0], size, flags, reconnect);
+    r = try_netlink_setup(cfg, nbd_fds, size, flags, reconnect);
     if (r < 0) {
       goto free_server;
     } else if (r == 1) {
@@ -1818,7 +1862,13 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
   }
 
   if (!use_netlink) {
-    r = try_ioctl_setup(cfg, fd[0], size, blksize, flags);
+    if (nbd_fds.size() > 1) {
+      r = -EOPNOTSUPP;
+      cerr << "rbd-nbd: multiple connections require the netlink interface"
+           << std::endl;
+      goto free_server;
+    }
+    r = try_ioctl_setup(cfg, nbd_fds[0], size, blksize, flags);
     if (r < 0)
       goto free_server;
   }
@@ -1887,8 +1937,12 @@ close_nbd:
 free_server:
   delete server;
 close_fd:
-  close(fd[0]);
-  close(fd[1]);
+  for (auto fd : nbd_fds) {
+    close(fd);
+  }
+  for (auto fd : server_fds) {
+    close(fd);
+  }
 close_ret:
   image.close();
   io_ctx.close();
@@ -2159,6 +2213,16 @@ static int parse_args(vector<const char*>& args, std::ostream *err_msg,
       cfg->pretty_format = true;
     } else if (ceph_argparse_flag(args, i, "--try-netlink", (char *)NULL)) {
       cfg->try_netlink = true;
+    } else if (ceph_argparse_witharg(args, i, &cfg->connections, err,
+                                     "--connections", (char *)NULL)) {
+      if (!err.str().empty()) {
+        *err_msg << "rbd-nbd: " << err.str();
+        return -EINVAL;
+      }
+      if (cfg->connections < 1) {
+        *err_msg << "rbd-nbd: Invalid argument for connections!";
+        return -EINVAL;
+      }
     } else if (ceph_argparse_flag(args, i, "--show-cookie", (char *)NULL)) {
       cfg->show_cookie = true;
     } else if (ceph_argparse_witharg(args, i, &cfg->cookie, "--cookie", (char *)NULL)) {
@@ -2206,6 +2270,11 @@ static int parse_args(vector<const char*>& args, std::ostream *err_msg,
     return -EINVAL;
   }
 
+  if (cfg->connections > 1 && !cfg->try_netlink) {
+    *err_msg << "rbd-nbd: --connections requires --try-netlink";
+    return -EINVAL;
+  }
+
   Command cmd = None;
   if (args.begin() != args.end()) {
     if (strcmp(*args.begin(), "map") == 0) {